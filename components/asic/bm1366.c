@@ -152,7 +152,7 @@ void BM1366_send_hash_frequency(float target_freq)
     uint8_t fb_divider, refdiv, postdiv1, postdiv2;
     float new_freq;
     
-    pll_get_parameters(target_freq, 144, 235, &fb_divider, &refdiv, &postdiv1, &postdiv2, &new_freq);
+    pll_lookup_parameters(&PLL_TABLE_BM1366, target_freq, &fb_divider, &refdiv, &postdiv1, &postdiv2, &new_freq);
     
     uint8_t vdo_scale = (fb_divider * FREQ_MULT / refdiv >= 2400) ? 0x50 : 0x40;
     uint8_t postdiv = (((postdiv1 - 1) & 0xf) << 4) | ((postdiv2 - 1) & 0xf);
@@ -154,7 +154,7 @@ void BM1397_send_hash_frequency(float target_freq)
     uint8_t fb_divider, refdiv, postdiv1, postdiv2;
     float frequency;
 
-    pll_get_parameters(target_freq, 60, 200, &fb_divider, &refdiv, &postdiv1, &postdiv2, &frequency);
+    pll_lookup_parameters(&PLL_TABLE_BM1397, target_freq, &fb_divider, &refdiv, &postdiv1, &postdiv2, &frequency);
 
     uint8_t vdo_scale = 0x40;
     uint8_t postdiv = ((postdiv1 & 0x7) << 4) + (postdiv2 & 0x7);
@@ -3,9 +3,10 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include <math.h>
+#include "pll.h"
 
 #define EPSILON 0.0001f
-#define STEP_SIZE 6.25 // MHz step size
+#define STEP_SIZE PLL_TABLE_STEP_MHZ // MHz step size; every ramp point is a PLL table entry
 
 static const char * TAG = "frequency_transition";
 
@@ -6,8 +6,43 @@
 
 #define FREQ_MULT 25.0 // MHz
 
+// PLL tables hold pll_get_parameters() results for every frequency ramp
+// point, so a ramp step is a lookup instead of a search
+#define PLL_TABLE_STEP_MHZ  6.25
+#define PLL_TABLE_FIRST     8       // 50 MHz
+#define PLL_TABLE_LAST      192     // 1200 MHz
+#define PLL_TABLE_ENTRIES   (PLL_TABLE_LAST - PLL_TABLE_FIRST + 1)
+
+typedef struct {
+    float frequency;                // Actual frequency of this setting
+    uint8_t fb_divider;
+    uint8_t refdiv;
+    uint8_t postdiv1;
+    uint8_t postdiv2;
+} pll_setting_t;
+
+typedef struct {
+    uint16_t fb_divider_min;
+    uint16_t fb_divider_max;
+    const pll_setting_t * settings; // PLL_TABLE_ENTRIES, from PLL_TABLE_FIRST * PLL_TABLE_STEP_MHZ up
+} pll_table_t;
+
+// Generated from pll_get_parameters() by tools/host_tests/pll_tables.c
+extern const pll_table_t PLL_TABLE_BM1397;
+extern const pll_table_t PLL_TABLE_BM1366;     // Also BM1368: same fb_divider range
+extern const pll_table_t PLL_TABLE_BM1370;
+
 void pll_get_parameters(float target_freq, uint16_t fb_divider_min, uint16_t fb_divider_max, 
                         uint8_t *fb_divider, uint8_t *refdiv, uint8_t *postdiv1, uint8_t *postdiv2,
                         float *actual_freq);
 
+/**
+ * @brief Same result as pll_get_parameters() for the table's fb_divider range
+ *
+ * Ramp points come from the table; any other frequency falls back to the search.
+ */
+void pll_lookup_parameters(const pll_table_t * table, float target_freq,
+                           uint8_t *fb_divider, uint8_t *refdiv, uint8_t *postdiv1, uint8_t *postdiv2,
+                           float *actual_freq);
+
 #endif /* PLL_H_ */
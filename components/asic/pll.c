@@ -51,7 +51,7 @@ void pll_get_parameters(float target_freq, uint16_t fb_divider_min, uint16_t fb_
         }
     }
 
-    ESP_LOGI(TAG, "Frequency: %g MHz (fb_divider: %d, refdiv: %d, postdiv1: %d, postdiv2: %d)", best_freq, best_fb_divider, best_refdiv, best_postdiv1, best_postdiv2);
+    ESP_LOGD(TAG, "Frequency: %g MHz (fb_divider: %d, refdiv: %d, postdiv1: %d, postdiv2: %d)", best_freq, best_fb_divider, best_refdiv, best_postdiv1, best_postdiv2);
 
     *actual_freq = best_freq;
     *fb_divider = best_fb_divider;
@@ -59,3 +59,23 @@ void pll_get_parameters(float target_freq, uint16_t fb_divider_min, uint16_t fb_
     *postdiv1 = best_postdiv1;
     *postdiv2 = best_postdiv2;
 }
+
+void pll_lookup_parameters(const pll_table_t * table, float target_freq,
+                           uint8_t *fb_divider, uint8_t *refdiv, uint8_t *postdiv1, uint8_t *postdiv2,
+                           float *actual_freq)
+{
+    // Ramp points are exact in a float, so an exact compare finds them
+    long step = lroundf(target_freq / (float) PLL_TABLE_STEP_MHZ);
+    if (step < PLL_TABLE_FIRST || step > PLL_TABLE_LAST || target_freq != step * (float) PLL_TABLE_STEP_MHZ) {
+        pll_get_parameters(target_freq, table->fb_divider_min, table->fb_divider_max,
+                           fb_divider, refdiv, postdiv1, postdiv2, actual_freq);
+        return;
+    }
+
+    const pll_setting_t * setting = &table->settings[step - PLL_TABLE_FIRST];
+    *actual_freq = setting->frequency;
+    *fb_divider = setting->fb_divider;
+    *refdiv = setting->refdiv;
+    *postdiv1 = setting->postdiv1;
+    *postdiv2 = setting->postdiv2;
+}
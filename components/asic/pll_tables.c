@@ -0,0 +1,587 @@
+// Generated by tools/host_tests/pll_tables.c --generate; do not edit.
+// pll_get_parameters() for every frequency ramp point, per fb_divider range.
+// The pll_tables host test fails when this no longer matches the solver.
+
+#include "pll.h"
+
+static const pll_setting_t BM1397_SETTINGS[PLL_TABLE_ENTRIES] = {
+    { 50, 60, 2, 5, 3 }, // 50 MHz
+    { 56.25, 63, 2, 7, 2 }, // 56.25 MHz
+    { 62.5, 60, 2, 6, 2 }, // 62.5 MHz
+    { 68.75, 66, 2, 6, 2 }, // 68.75 MHz
+    { 75, 60, 2, 5, 2 }, // 75 MHz
+    { 81.25, 65, 2, 5, 2 }, // 81.25 MHz
+    { 87.5, 70, 2, 5, 2 }, // 87.5 MHz
+    { 93.75, 60, 2, 4, 2 }, // 93.75 MHz
+    { 100, 64, 2, 4, 2 }, // 100 MHz
+    { 106.25, 68, 2, 4, 2 }, // 106.25 MHz
+    { 112.5, 63, 2, 7, 1 }, // 112.5 MHz
+    { 118.75, 76, 2, 4, 2 }, // 118.75 MHz
+    { 125, 60, 2, 6, 1 }, // 125 MHz
+    { 131.25, 63, 2, 6, 1 }, // 131.25 MHz
+    { 137.5, 66, 2, 6, 1 }, // 137.5 MHz
+    { 143.75, 69, 2, 6, 1 }, // 143.75 MHz
+    { 150, 60, 2, 5, 1 }, // 150 MHz
+    { 156.25, 75, 2, 6, 1 }, // 156.25 MHz
+    { 162.5, 65, 2, 5, 1 }, // 162.5 MHz
+    { 168.75, 81, 2, 6, 1 }, // 168.75 MHz
+    { 175, 70, 2, 5, 1 }, // 175 MHz
+    { 181.25, 87, 2, 6, 1 }, // 181.25 MHz
+    { 187.5, 60, 2, 4, 1 }, // 187.5 MHz
+    { 193.75, 62, 2, 4, 1 }, // 193.75 MHz
+    { 200, 64, 2, 4, 1 }, // 200 MHz
+    { 206.25, 66, 2, 4, 1 }, // 206.25 MHz
+    { 212.5, 68, 2, 4, 1 }, // 212.5 MHz
+    { 218.75, 70, 2, 4, 1 }, // 218.75 MHz
+    { 225, 72, 2, 4, 1 }, // 225 MHz
+    { 231.25, 74, 2, 4, 1 }, // 231.25 MHz
+    { 237.5, 76, 2, 4, 1 }, // 237.5 MHz
+    { 243.75, 78, 2, 4, 1 }, // 243.75 MHz
+    { 250, 60, 2, 3, 1 }, // 250 MHz
+    { 256.25, 82, 2, 4, 1 }, // 256.25 MHz
+    { 262.5, 63, 2, 3, 1 }, // 262.5 MHz
+    { 268.75, 86, 2, 4, 1 }, // 268.75 MHz
+    { 275, 66, 2, 3, 1 }, // 275 MHz
+    { 281.25, 90, 2, 4, 1 }, // 281.25 MHz
+    { 287.5, 69, 2, 3, 1 }, // 287.5 MHz
+    { 293.75, 94, 2, 4, 1 }, // 293.75 MHz
+    { 300, 72, 2, 3, 1 }, // 300 MHz
+    { 306.25, 98, 2, 4, 1 }, // 306.25 MHz
+    { 312.5, 75, 2, 3, 1 }, // 312.5 MHz
+    { 318.75, 102, 2, 4, 1 }, // 318.75 MHz
+    { 325, 78, 2, 3, 1 }, // 325 MHz
+    { 331.25, 106, 2, 4, 1 }, // 331.25 MHz
+    { 337.5, 81, 2, 3, 1 }, // 337.5 MHz
+    { 343.75, 110, 2, 4, 1 }, // 343.75 MHz
+    { 350, 84, 2, 3, 1 }, // 350 MHz
+    { 356.25, 114, 2, 4, 1 }, // 356.25 MHz
+    { 362.5, 87, 2, 3, 1 }, // 362.5 MHz
+    { 368.75, 118, 2, 4, 1 }, // 368.75 MHz
+    { 375, 60, 2, 2, 1 }, // 375 MHz
+    { 381.25, 61, 2, 2, 1 }, // 381.25 MHz
+    { 387.5, 62, 2, 2, 1 }, // 387.5 MHz
+    { 393.75, 63, 2, 2, 1 }, // 393.75 MHz
+    { 400, 64, 2, 2, 1 }, // 400 MHz
+    { 406.25, 65, 2, 2, 1 }, // 406.25 MHz
+    { 412.5, 66, 2, 2, 1 }, // 412.5 MHz
+    { 418.75, 67, 2, 2, 1 }, // 418.75 MHz
+    { 425, 68, 2, 2, 1 }, // 425 MHz
+    { 431.25, 69, 2, 2, 1 }, // 431.25 MHz
+    { 437.5, 70, 2, 2, 1 }, // 437.5 MHz
+    { 443.75, 71, 2, 2, 1 }, // 443.75 MHz
+    { 450, 72, 2, 2, 1 }, // 450 MHz
+    { 456.25, 73, 2, 2, 1 }, // 456.25 MHz
+    { 462.5, 74, 2, 2, 1 }, // 462.5 MHz
+    { 468.75, 75, 2, 2, 1 }, // 468.75 MHz
+    { 475, 76, 2, 2, 1 }, // 475 MHz
+    { 481.25, 77, 2, 2, 1 }, // 481.25 MHz
+    { 487.5, 78, 2, 2, 1 }, // 487.5 MHz
+    { 493.75, 79, 2, 2, 1 }, // 493.75 MHz
+    { 500, 80, 2, 2, 1 }, // 500 MHz
+    { 506.25, 81, 2, 2, 1 }, // 506.25 MHz
+    { 512.5, 82, 2, 2, 1 }, // 512.5 MHz
+    { 518.75, 83, 2, 2, 1 }, // 518.75 MHz
+    { 525, 84, 2, 2, 1 }, // 525 MHz
+    { 531.25, 85, 2, 2, 1 }, // 531.25 MHz
+    { 537.5, 86, 2, 2, 1 }, // 537.5 MHz
+    { 543.75, 87, 2, 2, 1 }, // 543.75 MHz
+    { 550, 88, 2, 2, 1 }, // 550 MHz
+    { 556.25, 89, 2, 2, 1 }, // 556.25 MHz
+    { 562.5, 90, 2, 2, 1 }, // 562.5 MHz
+    { 568.75, 91, 2, 2, 1 }, // 568.75 MHz
+    { 575, 92, 2, 2, 1 }, // 575 MHz
+    { 581.25, 93, 2, 2, 1 }, // 581.25 MHz
+    { 587.5, 94, 2, 2, 1 }, // 587.5 MHz
+    { 593.75, 95, 2, 2, 1 }, // 593.75 MHz
+    { 600, 96, 2, 2, 1 }, // 600 MHz
+    { 606.25, 97, 2, 2, 1 }, // 606.25 MHz
+    { 612.5, 98, 2, 2, 1 }, // 612.5 MHz
+    { 618.75, 99, 2, 2, 1 }, // 618.75 MHz
+    { 625, 100, 2, 2, 1 }, // 625 MHz
+    { 631.25, 101, 2, 2, 1 }, // 631.25 MHz
+    { 637.5, 102, 2, 2, 1 }, // 637.5 MHz
+    { 643.75, 103, 2, 2, 1 }, // 643.75 MHz
+    { 650, 104, 2, 2, 1 }, // 650 MHz
+    { 656.25, 105, 2, 2, 1 }, // 656.25 MHz
+    { 662.5, 106, 2, 2, 1 }, // 662.5 MHz
+    { 668.75, 107, 2, 2, 1 }, // 668.75 MHz
+    { 675, 108, 2, 2, 1 }, // 675 MHz
+    { 681.25, 109, 2, 2, 1 }, // 681.25 MHz
+    { 687.5, 110, 2, 2, 1 }, // 687.5 MHz
+    { 693.75, 111, 2, 2, 1 }, // 693.75 MHz
+    { 700, 112, 2, 2, 1 }, // 700 MHz
+    { 706.25, 113, 2, 2, 1 }, // 706.25 MHz
+    { 712.5, 114, 2, 2, 1 }, // 712.5 MHz
+    { 718.75, 115, 2, 2, 1 }, // 718.75 MHz
+    { 725, 116, 2, 2, 1 }, // 725 MHz
+    { 731.25, 117, 2, 2, 1 }, // 731.25 MHz
+    { 737.5, 118, 2, 2, 1 }, // 737.5 MHz
+    { 743.75, 119, 2, 2, 1 }, // 743.75 MHz
+    { 750, 120, 2, 2, 1 }, // 750 MHz
+    { 756.25, 121, 2, 2, 1 }, // 756.25 MHz
+    { 762.5, 122, 2, 2, 1 }, // 762.5 MHz
+    { 768.75, 123, 2, 2, 1 }, // 768.75 MHz
+    { 775, 124, 2, 2, 1 }, // 775 MHz
+    { 781.25, 125, 2, 2, 1 }, // 781.25 MHz
+    { 787.5, 126, 2, 2, 1 }, // 787.5 MHz
+    { 793.75, 127, 2, 2, 1 }, // 793.75 MHz
+    { 800, 128, 2, 2, 1 }, // 800 MHz
+    { 806.25, 129, 2, 2, 1 }, // 806.25 MHz
+    { 812.5, 130, 2, 2, 1 }, // 812.5 MHz
+    { 818.75, 131, 2, 2, 1 }, // 818.75 MHz
+    { 825, 132, 2, 2, 1 }, // 825 MHz
+    { 831.25, 133, 2, 2, 1 }, // 831.25 MHz
+    { 837.5, 134, 2, 2, 1 }, // 837.5 MHz
+    { 843.75, 135, 2, 2, 1 }, // 843.75 MHz
+    { 850, 136, 2, 2, 1 }, // 850 MHz
+    { 856.25, 137, 2, 2, 1 }, // 856.25 MHz
+    { 862.5, 138, 2, 2, 1 }, // 862.5 MHz
+    { 868.75, 139, 2, 2, 1 }, // 868.75 MHz
+    { 875, 140, 2, 2, 1 }, // 875 MHz
+    { 881.25, 141, 2, 2, 1 }, // 881.25 MHz
+    { 887.5, 142, 2, 2, 1 }, // 887.5 MHz
+    { 893.75, 143, 2, 2, 1 }, // 893.75 MHz
+    { 900, 144, 2, 2, 1 }, // 900 MHz
+    { 906.25, 145, 2, 2, 1 }, // 906.25 MHz
+    { 912.5, 146, 2, 2, 1 }, // 912.5 MHz
+    { 918.75, 147, 2, 2, 1 }, // 918.75 MHz
+    { 925, 148, 2, 2, 1 }, // 925 MHz
+    { 931.25, 149, 2, 2, 1 }, // 931.25 MHz
+    { 937.5, 150, 2, 2, 1 }, // 937.5 MHz
+    { 943.75, 151, 2, 2, 1 }, // 943.75 MHz
+    { 950, 152, 2, 2, 1 }, // 950 MHz
+    { 956.25, 153, 2, 2, 1 }, // 956.25 MHz
+    { 962.5, 154, 2, 2, 1 }, // 962.5 MHz
+    { 968.75, 155, 2, 2, 1 }, // 968.75 MHz
+    { 975, 156, 2, 2, 1 }, // 975 MHz
+    { 981.25, 157, 2, 2, 1 }, // 981.25 MHz
+    { 987.5, 158, 2, 2, 1 }, // 987.5 MHz
+    { 993.75, 159, 2, 2, 1 }, // 993.75 MHz
+    { 1000, 160, 2, 2, 1 }, // 1000 MHz
+    { 1006.25, 161, 2, 2, 1 }, // 1006.25 MHz
+    { 1012.5, 162, 2, 2, 1 }, // 1012.5 MHz
+    { 1018.75, 163, 2, 2, 1 }, // 1018.75 MHz
+    { 1025, 164, 2, 2, 1 }, // 1025 MHz
+    { 1031.25, 165, 2, 2, 1 }, // 1031.25 MHz
+    { 1037.5, 166, 2, 2, 1 }, // 1037.5 MHz
+    { 1043.75, 167, 2, 2, 1 }, // 1043.75 MHz
+    { 1050, 168, 2, 2, 1 }, // 1050 MHz
+    { 1056.25, 169, 2, 2, 1 }, // 1056.25 MHz
+    { 1062.5, 170, 2, 2, 1 }, // 1062.5 MHz
+    { 1068.75, 171, 2, 2, 1 }, // 1068.75 MHz
+    { 1075, 172, 2, 2, 1 }, // 1075 MHz
+    { 1081.25, 173, 2, 2, 1 }, // 1081.25 MHz
+    { 1087.5, 174, 2, 2, 1 }, // 1087.5 MHz
+    { 1093.75, 175, 2, 2, 1 }, // 1093.75 MHz
+    { 1100, 176, 2, 2, 1 }, // 1100 MHz
+    { 1106.25, 177, 2, 2, 1 }, // 1106.25 MHz
+    { 1112.5, 178, 2, 2, 1 }, // 1112.5 MHz
+    { 1118.75, 179, 2, 2, 1 }, // 1118.75 MHz
+    { 1125, 180, 2, 2, 1 }, // 1125 MHz
+    { 1131.25, 181, 2, 2, 1 }, // 1131.25 MHz
+    { 1137.5, 182, 2, 2, 1 }, // 1137.5 MHz
+    { 1143.75, 183, 2, 2, 1 }, // 1143.75 MHz
+    { 1150, 184, 2, 2, 1 }, // 1150 MHz
+    { 1156.25, 185, 2, 2, 1 }, // 1156.25 MHz
+    { 1162.5, 186, 2, 2, 1 }, // 1162.5 MHz
+    { 1168.75, 187, 2, 2, 1 }, // 1168.75 MHz
+    { 1175, 188, 2, 2, 1 }, // 1175 MHz
+    { 1181.25, 189, 2, 2, 1 }, // 1181.25 MHz
+    { 1187.5, 190, 2, 2, 1 }, // 1187.5 MHz
+    { 1193.75, 191, 2, 2, 1 }, // 1193.75 MHz
+    { 1200, 192, 2, 2, 1 }, // 1200 MHz
+};
+
+const pll_table_t PLL_TABLE_BM1397 = {
+    .fb_divider_min = 60,
+    .fb_divider_max = 200,
+    .settings = BM1397_SETTINGS,
+};
+
+static const pll_setting_t BM1366_SETTINGS[PLL_TABLE_ENTRIES] = {
+    { 50, 168, 2, 7, 6 }, // 50 MHz
+    { 56.25, 189, 2, 7, 6 }, // 56.25 MHz
+    { 62.5, 150, 2, 6, 5 }, // 62.5 MHz
+    { 68.75, 154, 2, 7, 4 }, // 68.75 MHz
+    { 75, 144, 2, 6, 4 }, // 75 MHz
+    { 81.25, 156, 2, 6, 4 }, // 81.25 MHz
+    { 87.5, 147, 2, 7, 3 }, // 87.5 MHz
+    { 93.75, 150, 2, 5, 4 }, // 93.75 MHz
+    { 100, 144, 2, 6, 3 }, // 100 MHz
+    { 106.25, 153, 2, 6, 3 }, // 106.25 MHz
+    { 112.5, 162, 2, 6, 3 }, // 112.5 MHz
+    { 118.75, 171, 2, 6, 3 }, // 118.75 MHz
+    { 125, 150, 2, 5, 3 }, // 125 MHz
+    { 131.25, 147, 2, 7, 2 }, // 131.25 MHz
+    { 137.5, 154, 2, 7, 2 }, // 137.5 MHz
+    { 143.75, 161, 2, 7, 2 }, // 143.75 MHz
+    { 150, 144, 2, 6, 2 }, // 150 MHz
+    { 156.25, 150, 2, 6, 2 }, // 156.25 MHz
+    { 162.5, 156, 2, 6, 2 }, // 162.5 MHz
+    { 168.75, 162, 2, 6, 2 }, // 168.75 MHz
+    { 175, 168, 2, 6, 2 }, // 175 MHz
+    { 181.25, 145, 2, 5, 2 }, // 181.25 MHz
+    { 187.5, 150, 2, 5, 2 }, // 187.5 MHz
+    { 193.75, 155, 2, 5, 2 }, // 193.75 MHz
+    { 200, 160, 2, 5, 2 }, // 200 MHz
+    { 206.25, 165, 2, 5, 2 }, // 206.25 MHz
+    { 212.5, 170, 2, 5, 2 }, // 212.5 MHz
+    { 218.75, 175, 2, 5, 2 }, // 218.75 MHz
+    { 225, 144, 2, 4, 2 }, // 225 MHz
+    { 231.25, 148, 2, 4, 2 }, // 231.25 MHz
+    { 237.5, 152, 2, 4, 2 }, // 237.5 MHz
+    { 243.75, 156, 2, 4, 2 }, // 243.75 MHz
+    { 250, 160, 2, 4, 2 }, // 250 MHz
+    { 256.25, 164, 2, 4, 2 }, // 256.25 MHz
+    { 262.5, 147, 2, 7, 1 }, // 262.5 MHz
+    { 268.75, 172, 2, 4, 2 }, // 268.75 MHz
+    { 275, 154, 2, 7, 1 }, // 275 MHz
+    { 281.25, 180, 2, 4, 2 }, // 281.25 MHz
+    { 287.5, 161, 2, 7, 1 }, // 287.5 MHz
+    { 293.75, 188, 2, 4, 2 }, // 293.75 MHz
+    { 300, 144, 2, 6, 1 }, // 300 MHz
+    { 306.25, 147, 2, 6, 1 }, // 306.25 MHz
+    { 312.5, 150, 2, 6, 1 }, // 312.5 MHz
+    { 318.75, 153, 2, 6, 1 }, // 318.75 MHz
+    { 325, 156, 2, 6, 1 }, // 325 MHz
+    { 331.25, 159, 2, 6, 1 }, // 331.25 MHz
+    { 337.5, 162, 2, 6, 1 }, // 337.5 MHz
+    { 343.75, 165, 2, 6, 1 }, // 343.75 MHz
+    { 350, 168, 2, 6, 1 }, // 350 MHz
+    { 356.25, 171, 2, 6, 1 }, // 356.25 MHz
+    { 362.5, 145, 2, 5, 1 }, // 362.5 MHz
+    { 368.75, 177, 2, 6, 1 }, // 368.75 MHz
+    { 375, 150, 2, 5, 1 }, // 375 MHz
+    { 381.25, 183, 2, 6, 1 }, // 381.25 MHz
+    { 387.5, 155, 2, 5, 1 }, // 387.5 MHz
+    { 393.75, 189, 2, 6, 1 }, // 393.75 MHz
+    { 400, 160, 2, 5, 1 }, // 400 MHz
+    { 406.25, 195, 2, 6, 1 }, // 406.25 MHz
+    { 412.5, 165, 2, 5, 1 }, // 412.5 MHz
+    { 418.75, 201, 2, 6, 1 }, // 418.75 MHz
+    { 425, 170, 2, 5, 1 }, // 425 MHz
+    { 431.25, 207, 2, 6, 1 }, // 431.25 MHz
+    { 437.5, 175, 2, 5, 1 }, // 437.5 MHz
+    { 443.75, 213, 2, 6, 1 }, // 443.75 MHz
+    { 450, 144, 2, 4, 1 }, // 450 MHz
+    { 456.25, 146, 2, 4, 1 }, // 456.25 MHz
+    { 462.5, 148, 2, 4, 1 }, // 462.5 MHz
+    { 468.75, 150, 2, 4, 1 }, // 468.75 MHz
+    { 475, 152, 2, 4, 1 }, // 475 MHz
+    { 481.25, 154, 2, 4, 1 }, // 481.25 MHz
+    { 487.5, 156, 2, 4, 1 }, // 487.5 MHz
+    { 493.75, 158, 2, 4, 1 }, // 493.75 MHz
+    { 500, 160, 2, 4, 1 }, // 500 MHz
+    { 506.25, 162, 2, 4, 1 }, // 506.25 MHz
+    { 512.5, 164, 2, 4, 1 }, // 512.5 MHz
+    { 518.75, 166, 2, 4, 1 }, // 518.75 MHz
+    { 525, 168, 2, 4, 1 }, // 525 MHz
+    { 531.25, 170, 2, 4, 1 }, // 531.25 MHz
+    { 537.5, 172, 2, 4, 1 }, // 537.5 MHz
+    { 543.75, 174, 2, 4, 1 }, // 543.75 MHz
+    { 550, 176, 2, 4, 1 }, // 550 MHz
+    { 556.25, 178, 2, 4, 1 }, // 556.25 MHz
+    { 562.5, 180, 2, 4, 1 }, // 562.5 MHz
+    { 568.75, 182, 2, 4, 1 }, // 568.75 MHz
+    { 575, 184, 2, 4, 1 }, // 575 MHz
+    { 581.25, 186, 2, 4, 1 }, // 581.25 MHz
+    { 587.5, 188, 2, 4, 1 }, // 587.5 MHz
+    { 593.75, 190, 2, 4, 1 }, // 593.75 MHz
+    { 600, 144, 2, 3, 1 }, // 600 MHz
+    { 606.25, 194, 2, 4, 1 }, // 606.25 MHz
+    { 612.5, 147, 2, 3, 1 }, // 612.5 MHz
+    { 618.75, 198, 2, 4, 1 }, // 618.75 MHz
+    { 625, 150, 2, 3, 1 }, // 625 MHz
+    { 631.25, 202, 2, 4, 1 }, // 631.25 MHz
+    { 637.5, 153, 2, 3, 1 }, // 637.5 MHz
+    { 643.75, 206, 2, 4, 1 }, // 643.75 MHz
+    { 650, 156, 2, 3, 1 }, // 650 MHz
+    { 656.25, 210, 2, 4, 1 }, // 656.25 MHz
+    { 662.5, 159, 2, 3, 1 }, // 662.5 MHz
+    { 668.75, 214, 2, 4, 1 }, // 668.75 MHz
+    { 675, 162, 2, 3, 1 }, // 675 MHz
+    { 681.25, 218, 2, 4, 1 }, // 681.25 MHz
+    { 687.5, 165, 2, 3, 1 }, // 687.5 MHz
+    { 693.75, 222, 2, 4, 1 }, // 693.75 MHz
+    { 700, 168, 2, 3, 1 }, // 700 MHz
+    { 706.25, 226, 2, 4, 1 }, // 706.25 MHz
+    { 712.5, 171, 2, 3, 1 }, // 712.5 MHz
+    { 718.75, 230, 2, 4, 1 }, // 718.75 MHz
+    { 725, 174, 2, 3, 1 }, // 725 MHz
+    { 731.25, 234, 2, 4, 1 }, // 731.25 MHz
+    { 737.5, 177, 2, 3, 1 }, // 737.5 MHz
+    { 742.857117, 208, 1, 7, 1 }, // 743.75 MHz
+    { 750, 180, 2, 3, 1 }, // 750 MHz
+    { 757.142883, 212, 1, 7, 1 }, // 756.25 MHz
+    { 762.5, 183, 2, 3, 1 }, // 762.5 MHz
+    { 767.857117, 215, 1, 7, 1 }, // 768.75 MHz
+    { 775, 186, 2, 3, 1 }, // 775 MHz
+    { 782.142883, 219, 1, 7, 1 }, // 781.25 MHz
+    { 787.5, 189, 2, 3, 1 }, // 787.5 MHz
+    { 792.857117, 222, 1, 7, 1 }, // 793.75 MHz
+    { 800, 192, 2, 3, 1 }, // 800 MHz
+    { 807.142883, 226, 1, 7, 1 }, // 806.25 MHz
+    { 812.5, 195, 2, 3, 1 }, // 812.5 MHz
+    { 817.857117, 229, 1, 7, 1 }, // 818.75 MHz
+    { 825, 198, 2, 3, 1 }, // 825 MHz
+    { 832.142883, 233, 1, 7, 1 }, // 831.25 MHz
+    { 837.5, 201, 2, 3, 1 }, // 837.5 MHz
+    { 845, 169, 1, 5, 1 }, // 843.75 MHz
+    { 850, 204, 2, 3, 1 }, // 850 MHz
+    { 855, 171, 1, 5, 1 }, // 856.25 MHz
+    { 862.5, 207, 2, 3, 1 }, // 862.5 MHz
+    { 870, 174, 1, 5, 1 }, // 868.75 MHz
+    { 875, 210, 2, 3, 1 }, // 875 MHz
+    { 880, 176, 1, 5, 1 }, // 881.25 MHz
+    { 887.5, 213, 2, 3, 1 }, // 887.5 MHz
+    { 895, 179, 1, 5, 1 }, // 893.75 MHz
+    { 900, 144, 2, 2, 1 }, // 900 MHz
+    { 906.25, 145, 2, 2, 1 }, // 906.25 MHz
+    { 912.5, 146, 2, 2, 1 }, // 912.5 MHz
+    { 918.75, 147, 2, 2, 1 }, // 918.75 MHz
+    { 925, 148, 2, 2, 1 }, // 925 MHz
+    { 931.25, 149, 2, 2, 1 }, // 931.25 MHz
+    { 937.5, 150, 2, 2, 1 }, // 937.5 MHz
+    { 943.75, 151, 2, 2, 1 }, // 943.75 MHz
+    { 950, 152, 2, 2, 1 }, // 950 MHz
+    { 956.25, 153, 2, 2, 1 }, // 956.25 MHz
+    { 962.5, 154, 2, 2, 1 }, // 962.5 MHz
+    { 968.75, 155, 2, 2, 1 }, // 968.75 MHz
+    { 975, 156, 2, 2, 1 }, // 975 MHz
+    { 981.25, 157, 2, 2, 1 }, // 981.25 MHz
+    { 987.5, 158, 2, 2, 1 }, // 987.5 MHz
+    { 993.75, 159, 2, 2, 1 }, // 993.75 MHz
+    { 1000, 160, 2, 2, 1 }, // 1000 MHz
+    { 1006.25, 161, 2, 2, 1 }, // 1006.25 MHz
+    { 1012.5, 162, 2, 2, 1 }, // 1012.5 MHz
+    { 1018.75, 163, 2, 2, 1 }, // 1018.75 MHz
+    { 1025, 164, 2, 2, 1 }, // 1025 MHz
+    { 1031.25, 165, 2, 2, 1 }, // 1031.25 MHz
+    { 1037.5, 166, 2, 2, 1 }, // 1037.5 MHz
+    { 1043.75, 167, 2, 2, 1 }, // 1043.75 MHz
+    { 1050, 168, 2, 2, 1 }, // 1050 MHz
+    { 1056.25, 169, 2, 2, 1 }, // 1056.25 MHz
+    { 1062.5, 170, 2, 2, 1 }, // 1062.5 MHz
+    { 1068.75, 171, 2, 2, 1 }, // 1068.75 MHz
+    { 1075, 172, 2, 2, 1 }, // 1075 MHz
+    { 1081.25, 173, 2, 2, 1 }, // 1081.25 MHz
+    { 1087.5, 174, 2, 2, 1 }, // 1087.5 MHz
+    { 1093.75, 175, 2, 2, 1 }, // 1093.75 MHz
+    { 1100, 176, 2, 2, 1 }, // 1100 MHz
+    { 1106.25, 177, 2, 2, 1 }, // 1106.25 MHz
+    { 1112.5, 178, 2, 2, 1 }, // 1112.5 MHz
+    { 1118.75, 179, 2, 2, 1 }, // 1118.75 MHz
+    { 1125, 180, 2, 2, 1 }, // 1125 MHz
+    { 1131.25, 181, 2, 2, 1 }, // 1131.25 MHz
+    { 1137.5, 182, 2, 2, 1 }, // 1137.5 MHz
+    { 1143.75, 183, 2, 2, 1 }, // 1143.75 MHz
+    { 1150, 184, 2, 2, 1 }, // 1150 MHz
+    { 1156.25, 185, 2, 2, 1 }, // 1156.25 MHz
+    { 1162.5, 186, 2, 2, 1 }, // 1162.5 MHz
+    { 1168.75, 187, 2, 2, 1 }, // 1168.75 MHz
+    { 1175, 188, 2, 2, 1 }, // 1175 MHz
+    { 1181.25, 189, 2, 2, 1 }, // 1181.25 MHz
+    { 1187.5, 190, 2, 2, 1 }, // 1187.5 MHz
+    { 1193.75, 191, 2, 2, 1 }, // 1193.75 MHz
+    { 1200, 192, 2, 2, 1 }, // 1200 MHz
+};
+
+const pll_table_t PLL_TABLE_BM1366 = {
+    .fb_divider_min = 144,
+    .fb_divider_max = 235,
+    .settings = BM1366_SETTINGS,
+};
+
+static const pll_setting_t BM1370_SETTINGS[PLL_TABLE_ENTRIES] = {
+    { 50, 168, 2, 7, 6 }, // 50 MHz
+    { 56.25, 189, 2, 7, 6 }, // 56.25 MHz
+    { 62.5, 175, 2, 7, 5 }, // 62.5 MHz
+    { 68.75, 165, 2, 6, 5 }, // 68.75 MHz
+    { 75, 168, 2, 7, 4 }, // 75 MHz
+    { 81.25, 182, 2, 7, 4 }, // 81.25 MHz
+    { 87.5, 168, 2, 6, 4 }, // 87.5 MHz
+    { 93.75, 180, 2, 6, 4 }, // 93.75 MHz
+    { 100, 160, 2, 5, 4 }, // 100 MHz
+    { 106.25, 170, 2, 5, 4 }, // 106.25 MHz
+    { 112.5, 162, 2, 6, 3 }, // 112.5 MHz
+    { 118.75, 171, 2, 6, 3 }, // 118.75 MHz
+    { 125, 180, 2, 6, 3 }, // 125 MHz
+    { 131.25, 189, 2, 6, 3 }, // 131.25 MHz
+    { 137.5, 165, 2, 5, 3 }, // 137.5 MHz
+    { 143.75, 161, 2, 7, 2 }, // 143.75 MHz
+    { 150, 168, 2, 7, 2 }, // 150 MHz
+    { 156.25, 175, 2, 7, 2 }, // 156.25 MHz
+    { 162.5, 182, 2, 7, 2 }, // 162.5 MHz
+    { 168.75, 162, 2, 6, 2 }, // 168.75 MHz
+    { 175, 168, 2, 6, 2 }, // 175 MHz
+    { 181.25, 174, 2, 6, 2 }, // 181.25 MHz
+    { 187.5, 180, 2, 6, 2 }, // 187.5 MHz
+    { 193.75, 186, 2, 6, 2 }, // 193.75 MHz
+    { 200, 160, 2, 5, 2 }, // 200 MHz
+    { 206.25, 165, 2, 5, 2 }, // 206.25 MHz
+    { 212.5, 170, 2, 5, 2 }, // 212.5 MHz
+    { 218.75, 175, 2, 5, 2 }, // 218.75 MHz
+    { 225, 180, 2, 5, 2 }, // 225 MHz
+    { 231.25, 185, 2, 5, 2 }, // 231.25 MHz
+    { 237.5, 190, 2, 5, 2 }, // 237.5 MHz
+    { 243.75, 195, 2, 5, 2 }, // 243.75 MHz
+    { 250, 160, 2, 4, 2 }, // 250 MHz
+    { 256.25, 164, 2, 4, 2 }, // 256.25 MHz
+    { 262.5, 168, 2, 4, 2 }, // 262.5 MHz
+    { 268.75, 172, 2, 4, 2 }, // 268.75 MHz
+    { 275, 176, 2, 4, 2 }, // 275 MHz
+    { 281.25, 180, 2, 4, 2 }, // 281.25 MHz
+    { 287.5, 161, 2, 7, 1 }, // 287.5 MHz
+    { 293.75, 188, 2, 4, 2 }, // 293.75 MHz
+    { 300, 168, 2, 7, 1 }, // 300 MHz
+    { 306.25, 196, 2, 4, 2 }, // 306.25 MHz
+    { 312.5, 175, 2, 7, 1 }, // 312.5 MHz
+    { 318.75, 204, 2, 4, 2 }, // 318.75 MHz
+    { 325, 182, 2, 7, 1 }, // 325 MHz
+    { 331.25, 212, 2, 4, 2 }, // 331.25 MHz
+    { 337.5, 162, 2, 6, 1 }, // 337.5 MHz
+    { 343.75, 165, 2, 6, 1 }, // 343.75 MHz
+    { 350, 168, 2, 6, 1 }, // 350 MHz
+    { 356.25, 171, 2, 6, 1 }, // 356.25 MHz
+    { 362.5, 174, 2, 6, 1 }, // 362.5 MHz
+    { 368.75, 177, 2, 6, 1 }, // 368.75 MHz
+    { 375, 180, 2, 6, 1 }, // 375 MHz
+    { 381.25, 183, 2, 6, 1 }, // 381.25 MHz
+    { 387.5, 186, 2, 6, 1 }, // 387.5 MHz
+    { 393.75, 189, 2, 6, 1 }, // 393.75 MHz
+    { 400, 160, 2, 5, 1 }, // 400 MHz
+    { 406.25, 195, 2, 6, 1 }, // 406.25 MHz
+    { 412.5, 165, 2, 5, 1 }, // 412.5 MHz
+    { 418.75, 201, 2, 6, 1 }, // 418.75 MHz
+    { 425, 170, 2, 5, 1 }, // 425 MHz
+    { 431.25, 207, 2, 6, 1 }, // 431.25 MHz
+    { 437.5, 175, 2, 5, 1 }, // 437.5 MHz
+    { 443.75, 213, 2, 6, 1 }, // 443.75 MHz
+    { 450, 180, 2, 5, 1 }, // 450 MHz
+    { 456.25, 219, 2, 6, 1 }, // 456.25 MHz
+    { 462.5, 185, 2, 5, 1 }, // 462.5 MHz
+    { 468.75, 225, 2, 6, 1 }, // 468.75 MHz
+    { 475, 190, 2, 5, 1 }, // 475 MHz
+    { 481.25, 231, 2, 6, 1 }, // 481.25 MHz
+    { 487.5, 195, 2, 5, 1 }, // 487.5 MHz
+    { 493.75, 237, 2, 6, 1 }, // 493.75 MHz
+    { 500, 160, 2, 4, 1 }, // 500 MHz
+    { 506.25, 162, 2, 4, 1 }, // 506.25 MHz
+    { 512.5, 164, 2, 4, 1 }, // 512.5 MHz
+    { 518.75, 166, 2, 4, 1 }, // 518.75 MHz
+    { 525, 168, 2, 4, 1 }, // 525 MHz
+    { 531.25, 170, 2, 4, 1 }, // 531.25 MHz
+    { 537.5, 172, 2, 4, 1 }, // 537.5 MHz
+    { 543.75, 174, 2, 4, 1 }, // 543.75 MHz
+    { 550, 176, 2, 4, 1 }, // 550 MHz
+    { 556.25, 178, 2, 4, 1 }, // 556.25 MHz
+    { 562.5, 180, 2, 4, 1 }, // 562.5 MHz
+    { 568.75, 182, 2, 4, 1 }, // 568.75 MHz
+    { 575, 184, 2, 4, 1 }, // 575 MHz
+    { 581.25, 186, 2, 4, 1 }, // 581.25 MHz
+    { 587.5, 188, 2, 4, 1 }, // 587.5 MHz
+    { 593.75, 190, 2, 4, 1 }, // 593.75 MHz
+    { 600, 192, 2, 4, 1 }, // 600 MHz
+    { 606.25, 194, 2, 4, 1 }, // 606.25 MHz
+    { 612.5, 196, 2, 4, 1 }, // 612.5 MHz
+    { 618.75, 198, 2, 4, 1 }, // 618.75 MHz
+    { 625, 200, 2, 4, 1 }, // 625 MHz
+    { 631.25, 202, 2, 4, 1 }, // 631.25 MHz
+    { 637.5, 204, 2, 4, 1 }, // 637.5 MHz
+    { 643.75, 206, 2, 4, 1 }, // 643.75 MHz
+    { 650, 208, 2, 4, 1 }, // 650 MHz
+    { 656.25, 210, 2, 4, 1 }, // 656.25 MHz
+    { 662.5, 212, 2, 4, 1 }, // 662.5 MHz
+    { 668.75, 214, 2, 4, 1 }, // 668.75 MHz
+    { 675, 162, 2, 3, 1 }, // 675 MHz
+    { 681.25, 218, 2, 4, 1 }, // 681.25 MHz
+    { 687.5, 165, 2, 3, 1 }, // 687.5 MHz
+    { 693.75, 222, 2, 4, 1 }, // 693.75 MHz
+    { 700, 168, 2, 3, 1 }, // 700 MHz
+    { 706.25, 226, 2, 4, 1 }, // 706.25 MHz
+    { 712.5, 171, 2, 3, 1 }, // 712.5 MHz
+    { 718.75, 230, 2, 4, 1 }, // 718.75 MHz
+    { 725, 174, 2, 3, 1 }, // 725 MHz
+    { 731.25, 234, 2, 4, 1 }, // 731.25 MHz
+    { 737.5, 177, 2, 3, 1 }, // 737.5 MHz
+    { 743.75, 238, 2, 4, 1 }, // 743.75 MHz
+    { 750, 180, 2, 3, 1 }, // 750 MHz
+    { 757.142883, 212, 1, 7, 1 }, // 756.25 MHz
+    { 762.5, 183, 2, 3, 1 }, // 762.5 MHz
+    { 767.857117, 215, 1, 7, 1 }, // 768.75 MHz
+    { 775, 186, 2, 3, 1 }, // 775 MHz
+    { 782.142883, 219, 1, 7, 1 }, // 781.25 MHz
+    { 787.5, 189, 2, 3, 1 }, // 787.5 MHz
+    { 792.857117, 222, 1, 7, 1 }, // 793.75 MHz
+    { 800, 192, 2, 3, 1 }, // 800 MHz
+    { 807.142883, 226, 1, 7, 1 }, // 806.25 MHz
+    { 812.5, 195, 2, 3, 1 }, // 812.5 MHz
+    { 817.857117, 229, 1, 7, 1 }, // 818.75 MHz
+    { 825, 198, 2, 3, 1 }, // 825 MHz
+    { 832.142883, 233, 1, 7, 1 }, // 831.25 MHz
+    { 837.5, 201, 2, 3, 1 }, // 837.5 MHz
+    { 842.857117, 236, 1, 7, 1 }, // 843.75 MHz
+    { 850, 204, 2, 3, 1 }, // 850 MHz
+    { 855, 171, 1, 5, 1 }, // 856.25 MHz
+    { 862.5, 207, 2, 3, 1 }, // 862.5 MHz
+    { 870, 174, 1, 5, 1 }, // 868.75 MHz
+    { 875, 210, 2, 3, 1 }, // 875 MHz
+    { 880, 176, 1, 5, 1 }, // 881.25 MHz
+    { 887.5, 213, 2, 3, 1 }, // 887.5 MHz
+    { 895, 179, 1, 5, 1 }, // 893.75 MHz
+    { 900, 216, 2, 3, 1 }, // 900 MHz
+    { 905, 181, 1, 5, 1 }, // 906.25 MHz
+    { 912.5, 219, 2, 3, 1 }, // 912.5 MHz
+    { 920, 184, 1, 5, 1 }, // 918.75 MHz
+    { 925, 222, 2, 3, 1 }, // 925 MHz
+    { 930, 186, 1, 5, 1 }, // 931.25 MHz
+    { 937.5, 225, 2, 3, 1 }, // 937.5 MHz
+    { 945, 189, 1, 5, 1 }, // 943.75 MHz
+    { 950, 228, 2, 3, 1 }, // 950 MHz
+    { 955, 191, 1, 5, 1 }, // 956.25 MHz
+    { 962.5, 231, 2, 3, 1 }, // 962.5 MHz
+    { 970, 194, 1, 5, 1 }, // 968.75 MHz
+    { 975, 234, 2, 3, 1 }, // 975 MHz
+    { 980, 196, 1, 5, 1 }, // 981.25 MHz
+    { 987.5, 237, 2, 3, 1 }, // 987.5 MHz
+    { 995, 199, 1, 5, 1 }, // 993.75 MHz
+    { 1000, 160, 2, 2, 1 }, // 1000 MHz
+    { 1006.25, 161, 2, 2, 1 }, // 1006.25 MHz
+    { 1012.5, 162, 2, 2, 1 }, // 1012.5 MHz
+    { 1018.75, 163, 2, 2, 1 }, // 1018.75 MHz
+    { 1025, 164, 2, 2, 1 }, // 1025 MHz
+    { 1031.25, 165, 2, 2, 1 }, // 1031.25 MHz
+    { 1037.5, 166, 2, 2, 1 }, // 1037.5 MHz
+    { 1043.75, 167, 2, 2, 1 }, // 1043.75 MHz
+    { 1050, 168, 2, 2, 1 }, // 1050 MHz
+    { 1056.25, 169, 2, 2, 1 }, // 1056.25 MHz
+    { 1062.5, 170, 2, 2, 1 }, // 1062.5 MHz
+    { 1068.75, 171, 2, 2, 1 }, // 1068.75 MHz
+    { 1075, 172, 2, 2, 1 }, // 1075 MHz
+    { 1081.25, 173, 2, 2, 1 }, // 1081.25 MHz
+    { 1087.5, 174, 2, 2, 1 }, // 1087.5 MHz
+    { 1093.75, 175, 2, 2, 1 }, // 1093.75 MHz
+    { 1100, 176, 2, 2, 1 }, // 1100 MHz
+    { 1106.25, 177, 2, 2, 1 }, // 1106.25 MHz
+    { 1112.5, 178, 2, 2, 1 }, // 1112.5 MHz
+    { 1118.75, 179, 2, 2, 1 }, // 1118.75 MHz
+    { 1125, 180, 2, 2, 1 }, // 1125 MHz
+    { 1131.25, 181, 2, 2, 1 }, // 1131.25 MHz
+    { 1137.5, 182, 2, 2, 1 }, // 1137.5 MHz
+    { 1143.75, 183, 2, 2, 1 }, // 1143.75 MHz
+    { 1150, 184, 2, 2, 1 }, // 1150 MHz
+    { 1156.25, 185, 2, 2, 1 }, // 1156.25 MHz
+    { 1162.5, 186, 2, 2, 1 }, // 1162.5 MHz
+    { 1168.75, 187, 2, 2, 1 }, // 1168.75 MHz
+    { 1175, 188, 2, 2, 1 }, // 1175 MHz
+    { 1181.25, 189, 2, 2, 1 }, // 1181.25 MHz
+    { 1187.5, 190, 2, 2, 1 }, // 1187.5 MHz
+    { 1193.75, 191, 2, 2, 1 }, // 1193.75 MHz
+    { 1200, 192, 2, 2, 1 }, // 1200 MHz
+};
+
+const pll_table_t PLL_TABLE_BM1370 = {
+    .fb_divider_min = 160,
+    .fb_divider_max = 239,
+    .settings = BM1370_SETTINGS,
+};
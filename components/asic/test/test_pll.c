@@ -16,3 +16,33 @@ TEST_CASE("Check PLL frequency calculation", "[pll]")
     TEST_ASSERT_EQUAL_UINT8(1, postdiv2);
     TEST_ASSERT_FLOAT_WITHIN(0.01, 450.0, actual_freq);
 }
+
+TEST_CASE("Check PLL tables match the solver", "[pll]")
+{
+    const pll_table_t * tables[] = { &PLL_TABLE_BM1397, &PLL_TABLE_BM1366, &PLL_TABLE_BM1370 };
+
+    for (size_t t = 0; t < sizeof(tables) / sizeof(tables[0]); t++) {
+        for (int step = PLL_TABLE_FIRST; step <= PLL_TABLE_LAST; step++) {
+            float frequency = step * (float) PLL_TABLE_STEP_MHZ;
+            uint8_t fb_divider, refdiv, postdiv1, postdiv2;
+            float actual_freq;
+            pll_get_parameters(frequency, tables[t]->fb_divider_min, tables[t]->fb_divider_max,
+                               &fb_divider, &refdiv, &postdiv1, &postdiv2, &actual_freq);
+
+            const pll_setting_t * setting = &tables[t]->settings[step - PLL_TABLE_FIRST];
+            TEST_ASSERT_EQUAL_UINT8(fb_divider, setting->fb_divider);
+            TEST_ASSERT_EQUAL_UINT8(refdiv, setting->refdiv);
+            TEST_ASSERT_EQUAL_UINT8(postdiv1, setting->postdiv1);
+            TEST_ASSERT_EQUAL_UINT8(postdiv2, setting->postdiv2);
+            TEST_ASSERT_EQUAL_FLOAT(actual_freq, setting->frequency);
+        }
+    }
+
+    // Off a ramp point the lookup falls back to the solver
+    uint8_t fb_divider, refdiv, postdiv1, postdiv2;
+    float actual_freq;
+    pll_lookup_parameters(&PLL_TABLE_BM1397, 450.0, &fb_divider, &refdiv, &postdiv1, &postdiv2, &actual_freq);
+    TEST_ASSERT_EQUAL_UINT8(72, fb_divider);
+    pll_lookup_parameters(&PLL_TABLE_BM1370, 487.3, &fb_divider, &refdiv, &postdiv1, &postdiv2, &actual_freq);
+    TEST_ASSERT_FLOAT_WITHIN(1.0, 487.3, actual_freq);
+}
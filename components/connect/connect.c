@@ -2,6 +2,7 @@
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "esp_wifi.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
@@ -247,6 +248,12 @@ static void event_handler(void * arg, esp_event_base_t event_base, int32_t event
 
         GLOBAL_STATE->SYSTEM_MODULE.is_connected = true;
 
+        static bool wifi_marked;
+        if (!wifi_marked) {
+            boot_timeline_mark(&GLOBAL_STATE->BOOT_TIMELINE, "wifi connected", esp_timer_get_time());
+            wifi_marked = true;
+        }
+
         ESP_LOGI(TAG, "Connected to SSID: %s", GLOBAL_STATE->SYSTEM_MODULE.ssid);
         strcpy(GLOBAL_STATE->SYSTEM_MODULE.wifi_status, "Connected!");
 
@@ -0,0 +1,95 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include "boot_timeline.h"
+
+static int claim(boot_timeline_t *tl)
+{
+    uint32_t id = atomic_fetch_add(&tl->count, 1);
+    return (id < BOOT_TIMELINE_MAX_PHASES) ? (int) id : -1;
+}
+
+int boot_timeline_begin(boot_timeline_t *tl, const char *name, int64_t now_us)
+{
+    int id = claim(tl);
+    if (id < 0) {
+        return -1;
+    }
+    boot_phase_t *phase = &tl->phases[id];
+    phase->start_us = now_us;
+    phase->end_us = 0;
+    phase->milestone = false;
+    // Name last: readers skip entries without one
+    atomic_thread_fence(memory_order_release);
+    phase->name = name;
+    return id;
+}
+
+void boot_timeline_end(boot_timeline_t *tl, int id, int64_t now_us)
+{
+    if (id < 0 || id >= BOOT_TIMELINE_MAX_PHASES) {
+        return;
+    }
+    // A phase shorter than the clock's resolution still counts as ended
+    tl->phases[id].end_us = (now_us > tl->phases[id].start_us) ? now_us : tl->phases[id].start_us + 1;
+}
+
+void boot_timeline_mark(boot_timeline_t *tl, const char *name, int64_t now_us)
+{
+    int id = claim(tl);
+    if (id < 0) {
+        return;
+    }
+    boot_phase_t *phase = &tl->phases[id];
+    phase->start_us = now_us;
+    phase->end_us = now_us;
+    phase->milestone = true;
+    atomic_thread_fence(memory_order_release);
+    phase->name = name;
+}
+
+uint32_t boot_timeline_count(const boot_timeline_t *tl)
+{
+    uint32_t count = atomic_load(&((boot_timeline_t *) tl)->count);
+    return (count < BOOT_TIMELINE_MAX_PHASES) ? count : BOOT_TIMELINE_MAX_PHASES;
+}
+
+static int compare_start(const void *a, const void *b)
+{
+    const boot_phase_t *pa = *(const boot_phase_t * const *) a;
+    const boot_phase_t *pb = *(const boot_phase_t * const *) b;
+    return (pa->start_us > pb->start_us) - (pa->start_us < pb->start_us);
+}
+
+void boot_timeline_summarize(const boot_timeline_t *tl, boot_timeline_summary_t *summary)
+{
+    summary->elapsed_us = 0;
+    summary->serial_us = 0;
+    summary->running = 0;
+
+    const boot_phase_t *ended[BOOT_TIMELINE_MAX_PHASES];
+    int n = 0;
+    uint32_t count = boot_timeline_count(tl);
+    for (uint32_t i = 0; i < count; i++) {
+        const boot_phase_t *phase = &tl->phases[i];
+        if (phase->name == NULL || phase->milestone) {
+            continue;
+        }
+        if (phase->end_us == 0) {
+            summary->running++;
+            continue;
+        }
+        summary->serial_us += phase->end_us - phase->start_us;
+        ended[n++] = phase;
+    }
+
+    // Union of the intervals: phases on other tasks overlap
+    qsort(ended, n, sizeof(ended[0]), compare_start);
+    int64_t covered_until = INT64_MIN;
+    for (int i = 0; i < n; i++) {
+        int64_t start = (ended[i]->start_us > covered_until) ? ended[i]->start_us : covered_until;
+        if (ended[i]->end_us > start) {
+            summary->elapsed_us += ended[i]->end_us - start;
+            covered_until = ended[i]->end_us;
+        }
+    }
+}
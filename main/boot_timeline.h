@@ -0,0 +1,60 @@
+#ifndef BOOT_TIMELINE_H
+#define BOOT_TIMELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// When each startup phase ran, for /api/system/boot. app_main and the tasks
+// it starts record phases as they begin and end, plus milestones on the way
+// to hashing (WiFi connected, first job from the pool or, on a slave, from
+// the master, first nonce, first accepted share). Phases from different
+// tasks may overlap; the summary compares their elapsed time with the time
+// they would have taken one after another.
+//
+// Slots are claimed with an atomic increment, so any task can record a
+// phase without a lock. Names must be string literals.
+
+#define BOOT_TIMELINE_MAX_PHASES    32
+
+typedef struct {
+    const char  *name;                  // NULL until the phase is fully recorded
+    int64_t     start_us;
+    int64_t     end_us;                 // 0 while running
+    bool        milestone;              // A point in time, not a phase
+} boot_phase_t;
+
+typedef struct {
+    boot_phase_t        phases[BOOT_TIMELINE_MAX_PHASES];
+    _Atomic uint32_t    count;          // Claimed, may exceed the array when full
+} boot_timeline_t;
+
+typedef struct {
+    int64_t     elapsed_us;             // Time covered by at least one phase
+    int64_t     serial_us;              // Sum of phase durations
+    uint32_t    running;                // Phases not ended yet
+} boot_timeline_summary_t;
+
+/**
+ * @brief Start a phase
+ * @return Phase id for boot_timeline_end(), -1 if the timeline is full
+ */
+int boot_timeline_begin(boot_timeline_t *tl, const char *name, int64_t now_us);
+
+void boot_timeline_end(boot_timeline_t *tl, int id, int64_t now_us);
+
+/**
+ * @brief Record a milestone
+ */
+void boot_timeline_mark(boot_timeline_t *tl, const char *name, int64_t now_us);
+
+/**
+ * @brief Recorded phases and milestones, in the order they began
+ */
+uint32_t boot_timeline_count(const boot_timeline_t *tl);
+
+/**
+ * @brief Time covered by the phases that have ended, and their sum
+ */
+void boot_timeline_summarize(const boot_timeline_t *tl, boot_timeline_summary_t *summary);
+
+#endif // BOOT_TIMELINE_H
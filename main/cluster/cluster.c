@@ -13,6 +13,11 @@
 #include "cluster_protocol.h"
 #include "cluster_config.h"
 #include "cluster_integration.h"
+#include "cluster_relay.h"
+#include "cluster_remote_config.h"
+#include "cluster_telemetry.h"
+#include "cluster_trace.h"
+#include "cluster_transport.h"
 #include "esp_log.h"
 #include "esp_mac.h"
 #include "nvs_flash.h"
@@ -31,9 +36,6 @@ static cluster_state_t g_cluster_state = {
 
 #if CLUSTER_ENABLED
 
-// External BAP UART functions (from existing ESP-Miner BAP implementation)
-extern esp_err_t BAP_uart_send_raw(const char *data, size_t len);
-
 // Forward declarations for master/slave init (implemented in cluster_master.c and cluster_slave.c)
 extern esp_err_t cluster_master_init(cluster_master_state_t *state);
 extern void cluster_master_deinit(void);
@@ -90,36 +92,6 @@ static esp_err_t save_mode_to_nvs(cluster_mode_t mode)
     return err;
 }
 
-// ============================================================================
-// BAP UART Send Function
-// ============================================================================
-
-/**
- * @brief Send raw data via BAP (UART or ESP-NOW)
- * This wraps the existing BAP infrastructure
- */
-esp_err_t BAP_uart_send_raw(const char *data, size_t len)
-{
-#if defined(CONFIG_CLUSTER_TRANSPORT_ESPNOW) || defined(CONFIG_CLUSTER_TRANSPORT_BOTH)
-    // Forward declaration
-    extern esp_err_t cluster_espnow_broadcast(const char *data, size_t len);
-    
-    // For now, we broadcast everything. In the future, we could parse the message
-    // to find a destination address, but broadcast works for both master (discovery)
-    // and slave (updates).
-    return cluster_espnow_broadcast(data, len);
-
-#else
-    // This will be implemented to use the existing BAP UART send mechanism
-    // For now, we'll use the external uart_write_bytes function
-    extern int uart_write_bytes(int uart_num, const void *src, size_t size);
-    #define BAP_UART_NUM 2  // UART_NUM_2
-
-    int bytes_sent = uart_write_bytes(BAP_UART_NUM, data, len);
-    return (bytes_sent == len) ? ESP_OK : ESP_FAIL;
-#endif
-}
-
 #endif // CLUSTER_ENABLED
 
 // ============================================================================
@@ -231,9 +203,9 @@ esp_err_t cluster_send_bap_message(const char *msg_type,
     uint8_t checksum = cluster_protocol_calc_checksum(buffer + 1);
     len += snprintf(buffer + len, sizeof(buffer) - len, "*%02X\r\n", checksum);
 
-    // Send via BAP UART
+    // Send on every active transport
     ESP_LOGD(TAG, "Sending cluster message: %s", buffer);
-    return BAP_uart_send_raw(buffer, len);
+    return cluster_transport_broadcast(buffer, len);
 }
 
 /**
@@ -282,6 +254,39 @@ esp_err_t cluster_handle_bap_message(const char *msg_type,
             return ret;
         }
 
+        // Binary telemetry from slave
+        if (strcmp(msg_type, BAP_MSG_TELEMETRY) == 0) {
+            uint16_t node;
+            uint8_t frame[CLUSTER_TLM_MAX_FRAME];
+            size_t frame_len = 0;
+            cluster_clock_stamp_t clock;
+            esp_err_t ret = cluster_protocol_decode_telemetry(payload, &node, frame,
+                                                              sizeof(frame), &frame_len, &clock);
+            if (ret == ESP_OK) {
+                return cluster_master_handle_telemetry(node, frame, frame_len, &clock);
+            }
+            return ret;
+        }
+
+        // Trace records from slave
+        if (strcmp(msg_type, BAP_MSG_TRACE) == 0) {
+            uint16_t node;
+            uint32_t lost = 0;
+            uint8_t records[CLUSTER_TRACE_UPLOAD_RECORDS * CLUSTER_TRACE_WIRE_SIZE];
+            size_t records_len = 0;
+            esp_err_t ret = cluster_protocol_decode_trace(payload, &node, &lost, records,
+                                                          sizeof(records), &records_len);
+            if (ret == ESP_OK) {
+                return cluster_master_handle_trace(node, lost, records, records_len);
+            }
+            return ret;
+        }
+
+        // Settings result from slave
+        if (strcmp(msg_type, BAP_MSG_SETTING_RSP) == 0) {
+            return cluster_master_handle_config_reply(payload, len);
+        }
+
         // Share from slave
         if (strcmp(msg_type, BAP_MSG_SHARE) == 0) {
             cluster_share_t share;
@@ -315,9 +320,15 @@ esp_err_t cluster_handle_bap_message(const char *msg_type,
             return ret;
         }
 
+        // Settings read/write from master
+        if (strcmp(msg_type, BAP_MSG_SETTING_GET) == 0 ||
+            strcmp(msg_type, BAP_MSG_SETTING_SET) == 0) {
+            return cluster_slave_handle_config_message(msg_type, payload, len);
+        }
+
         // Registration acknowledgment
         if (strcmp(msg_type, BAP_MSG_ACK) == 0) {
-            uint8_t slave_id;
+            uint16_t slave_id;
             char status[32];
             esp_err_t ret = cluster_protocol_decode_ack(payload,
                                                          &slave_id,
@@ -329,11 +340,31 @@ esp_err_t cluster_handle_bap_message(const char *msg_type,
             return ret;
         }
 
-        // Heartbeat response (just a keepalive confirmation)
+        // Heartbeat response: keepalive confirmation and clock echo
         if (strcmp(msg_type, BAP_MSG_HEARTBEAT) == 0) {
-            // Master echoed back our heartbeat - connection is alive
-            ESP_LOGD(TAG, "Heartbeat acknowledged");
-            return ESP_OK;
+            uint16_t node;
+            int64_t echo_t1;
+            esp_err_t ret = cluster_protocol_decode_heartbeat_reply(payload, &node, &echo_t1);
+            if (ret == ESP_OK && node == cluster_slave_get_node_addr()) {
+                ESP_LOGD(TAG, "Heartbeat acknowledged");
+                cluster_slave_handle_clock_reply(echo_t1);
+            }
+            return ret;
+        }
+
+        // Telemetry ack/NAK from master (or relay)
+        if (strcmp(msg_type, BAP_MSG_TELEMETRY_ACK) == 0) {
+            uint16_t node;
+            uint8_t seq;
+            bool ok;
+            int64_t echo_t1;
+            esp_err_t ret = cluster_protocol_decode_telemetry_ack(payload, &node, &seq, &ok,
+                                                                  &echo_t1);
+            if (ret == ESP_OK && node == cluster_slave_get_node_addr()) {
+                cluster_slave_handle_telemetry_ack(seq, ok);
+                cluster_slave_handle_clock_reply(echo_t1);
+            }
+            return ret;
         }
 
         // Sync message (difficulty update, etc.)
@@ -406,38 +437,43 @@ void cluster_on_bap_message_received(const char *message)
         payload_len = strlen(payload);
     }
 
+#if CLUSTER_IS_SLAVE
+    // No source address on the cable; any cluster line means the bus is up
+    if (g_cluster_state.mode == CLUSTER_MODE_SLAVE) {
+        cluster_slave_on_uplink_rx();
+    }
+#endif
+
     cluster_handle_bap_message(msg_type, payload, payload_len);
 }
 
 // ============================================================================
-// ESP-NOW Message Handler (with MAC address support)
+// Transport Message Handler (with MAC address support)
 // ============================================================================
 
-#if defined(CONFIG_CLUSTER_TRANSPORT_ESPNOW) || defined(CONFIG_CLUSTER_TRANSPORT_BOTH)
-
 // Forward declare extended registration handler
 extern esp_err_t cluster_master_handle_registration_with_mac(const char *hostname,
                                                               const char *ip_addr,
                                                               const uint8_t *mac_addr);
 
 /**
- * @brief Handle ESP-NOW message with source MAC address
+ * @brief Handle a message from a MAC-addressed transport (ESP-NOW, UDP)
  * This allows the master to track slave MAC addresses for direct communication
  */
-esp_err_t cluster_handle_espnow_message(const char *msg_type,
-                                         const char *payload,
-                                         size_t len,
-                                         const uint8_t *src_mac)
+esp_err_t cluster_handle_transport_message(const char *msg_type,
+                                            const char *payload,
+                                            size_t len,
+                                            const uint8_t *src_mac)
 {
     if (!msg_type || !payload) {
         return ESP_ERR_INVALID_ARG;
     }
 
     if (src_mac) {
-        ESP_LOGD(TAG, "Received ESP-NOW message: type=%s from %02X:%02X:%02X:%02X:%02X:%02X",
+        ESP_LOGD(TAG, "Received transport message: type=%s from %02X:%02X:%02X:%02X:%02X:%02X",
                  msg_type, src_mac[0], src_mac[1], src_mac[2], src_mac[3], src_mac[4], src_mac[5]);
     } else {
-        ESP_LOGD(TAG, "Received ESP-NOW message: type=%s", msg_type);
+        ESP_LOGD(TAG, "Received transport message: type=%s", msg_type);
     }
 
 #if CLUSTER_IS_MASTER
@@ -468,10 +504,10 @@ esp_err_t cluster_handle_espnow_message(const char *msg_type,
             }
 
             if (src_mac) {
-                ESP_LOGI(TAG, "ESP-NOW registration: %s (%s) from %02X:%02X:%02X:%02X:%02X:%02X",
+                ESP_LOGI(TAG, "Transport registration: %s (%s) from %02X:%02X:%02X:%02X:%02X:%02X",
                          hostname, ip_addr, src_mac[0], src_mac[1], src_mac[2], src_mac[3], src_mac[4], src_mac[5]);
             } else {
-                ESP_LOGI(TAG, "ESP-NOW registration: %s (%s)", hostname, ip_addr);
+                ESP_LOGI(TAG, "Transport registration: %s (%s)", hostname, ip_addr);
             }
 
             return cluster_master_handle_registration_with_mac(hostname, ip_addr, src_mac);
@@ -479,12 +515,56 @@ esp_err_t cluster_handle_espnow_message(const char *msg_type,
     }
 #endif
 
+#if CLUSTER_IS_SLAVE
+    // Anything from our uplink shows the link is alive
+    if (g_cluster_state.mode == CLUSTER_MODE_SLAVE && src_mac) {
+        uint8_t uplink_mac[6];
+        if (cluster_transport_get_uplink_mac(uplink_mac) &&
+            memcmp(uplink_mac, src_mac, 6) == 0) {
+            cluster_slave_on_uplink_rx();
+        }
+    }
+#endif
+
+#if CLUSTER_IS_RELAY
+    // Relay: shares and heartbeats from our downstream slaves are handled
+    // here; everything else (work, ACKs, master's echoes) is for us as a slave
+    if (g_cluster_state.mode == CLUSTER_MODE_SLAVE) {
+        if (strcmp(msg_type, BAP_MSG_SHARE) == 0) {
+            cluster_share_t share;
+            if (cluster_protocol_decode_share(payload, &share) == ESP_OK &&
+                cluster_relay_owns_node(share.slave_id)) {
+                return cluster_relay_handle_share(&share);
+            }
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        if (strcmp(msg_type, BAP_MSG_HEARTBEAT) == 0) {
+            cluster_heartbeat_data_t hb_data;
+            if (cluster_protocol_decode_heartbeat_ex(payload, &hb_data) == ESP_OK &&
+                cluster_relay_owns_node(hb_data.slave_id)) {
+                return cluster_relay_handle_heartbeat(&hb_data, src_mac);
+            }
+        }
+
+        if (strcmp(msg_type, BAP_MSG_TELEMETRY) == 0) {
+            uint16_t node;
+            uint8_t frame[CLUSTER_TLM_MAX_FRAME];
+            size_t frame_len = 0;
+            if (cluster_protocol_decode_telemetry(payload, &node, frame, sizeof(frame),
+                                                  &frame_len, NULL) == ESP_OK &&
+                cluster_relay_owns_node(node)) {
+                return cluster_relay_handle_telemetry(node, frame, frame_len, src_mac);
+            }
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+#endif
+
     // Fall back to standard handler for other messages
     return cluster_handle_bap_message(msg_type, payload, len);
 }
 
-#endif // ESP-NOW transport
-
 #else // !CLUSTER_ENABLED
 
 // Stub implementations when cluster is disabled
@@ -569,6 +649,16 @@ void cluster_get_status(char *status_json, size_t max_len)
                  (unsigned long)g_cluster_state.slave.shares_submitted,
                  g_cluster_state.slave.work_valid ? "true" : "false",
                  CLUSTERAXE_VERSION_STRING);
+
+#if CLUSTER_IS_RELAY
+        // Append relay group size before the closing brace
+        size_t used = strlen(status_json);
+        if (used > 0 && used < max_len) {
+            snprintf(status_json + used - 1, max_len - used + 1,
+                     ",\"relay\":true,\"downstream\":%u}",
+                     cluster_relay_get_child_count());
+        }
+#endif
     }
 #else
     snprintf(status_json, max_len,
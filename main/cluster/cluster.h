@@ -32,6 +32,7 @@ extern "C" {
 
 // Forward declaration for protocol types (defined in cluster_protocol.h)
 typedef struct cluster_heartbeat_data cluster_heartbeat_data_t;
+typedef struct cluster_clock_stamp cluster_clock_stamp_t;
 
 // ============================================================================
 // Configuration Constants (using config values)
@@ -42,6 +43,22 @@ typedef struct cluster_heartbeat_data cluster_heartbeat_data_t;
 #define CLUSTER_SHARE_QUEUE_SIZE    CONFIG_CLUSTER_SHARE_QUEUE_SIZE
 #define CLUSTER_HEARTBEAT_MS        CONFIG_CLUSTER_HEARTBEAT_MS
 #define CLUSTER_TIMEOUT_MS          CONFIG_CLUSTER_TIMEOUT_MS
+#define CLUSTER_LINK_TIMEOUT_MS     CONFIG_CLUSTER_LINK_TIMEOUT_MS
+#define CLUSTER_AUTONOMOUS_MAX_MS   CONFIG_CLUSTER_AUTONOMOUS_MAX_MS
+#define CLUSTER_SHARE_REPLAY_SIZE   CONFIG_CLUSTER_SHARE_REPLAY_SIZE
+#define CLUSTER_TELEMETRY_MS        CONFIG_CLUSTER_TELEMETRY_MS
+#define CLUSTER_TELEMETRY_KEYFRAME  CONFIG_CLUSTER_TELEMETRY_KEYFRAME
+#define CLUSTER_TELEMETRY_MAX_ASICS 6           // Per-chip stats carried in telemetry
+#define CLUSTER_SHARE_VERIFY        CONFIG_CLUSTER_SHARE_VERIFY
+#define CLUSTER_TRACE_SIZE          CONFIG_CLUSTER_TRACE_SIZE
+#define CLUSTER_AUTOTUNE_POWER_BUDGET_W CONFIG_CLUSTER_AUTOTUNE_POWER_BUDGET_W
+#define CLUSTER_AUTOTUNE_ONLINE     CONFIG_CLUSTER_AUTOTUNE_ONLINE
+#define CLUSTER_AUTOTUNE_PROFILES   CONFIG_CLUSTER_AUTOTUNE_PROFILES
+#define CLUSTER_PROFILE_BUCKET_C    CONFIG_CLUSTER_PROFILE_BUCKET_C
+#define CLUSTER_PROFILE_RTH         CONFIG_CLUSTER_PROFILE_RTH
+#define CLUSTER_PROXY_MAX_INFLIGHT  CONFIG_CLUSTER_PROXY_MAX_INFLIGHT
+#define CLUSTER_PROXY_CACHE_TTL_MS  CONFIG_CLUSTER_PROXY_CACHE_TTL_MS
+#define CLUSTER_REMOTE_CONFIG_TIMEOUT_MS CONFIG_CLUSTER_REMOTE_CONFIG_TIMEOUT_MS
 #define CLUSTER_NONCE_RANGE_BITS    28
 
 // BAP Message Types (NMEA-style sentence identifiers)
@@ -54,6 +71,12 @@ typedef struct cluster_heartbeat_data cluster_heartbeat_data_t;
 #define BAP_MSG_ACK         "CLACK"     // Acknowledgment
 #define BAP_MSG_REGISTER    "CLREG"     // Slave registration
 #define BAP_MSG_TIMING      "CLTIM"     // Timing sync: master -> slave (auto-timing interval)
+#define BAP_MSG_TELEMETRY   "CLTLM"     // Binary delta telemetry: slave -> master
+#define BAP_MSG_TELEMETRY_ACK "CLTAK"   // Telemetry ack/NAK: master -> slave
+#define BAP_MSG_TRACE       "CLTRC"     // Job/share trace records: slave -> master
+#define BAP_MSG_SETTING_GET "CLGET"     // Read slave settings: master -> slave
+#define BAP_MSG_SETTING_SET "CLSET"     // Write slave settings: master -> slave
+#define BAP_MSG_SETTING_RSP "CLSTR"     // Settings result: slave -> master
 
 // Protocol constants
 #define CLUSTER_MSG_START       '$'
@@ -88,7 +111,7 @@ typedef enum {
  * @brief Mining work unit distributed to slaves
  */
 typedef struct {
-    uint8_t  target_slave_id;           // Which slave this work is for (for broadcast filtering)
+    uint16_t target_slave_id;           // Node address this work is for (for broadcast filtering)
     uint32_t job_id;                    // Unique job identifier
     uint8_t  prev_block_hash[32];       // Previous block hash
     uint8_t  merkle_root[32];           // Merkle root (or coinbase for construction)
@@ -119,8 +142,8 @@ typedef struct {
     uint8_t  extranonce2[8];            // Extranonce2 used
     uint8_t  extranonce2_len;           // Length of extranonce2
     uint32_t ntime;                     // Timestamp (may be rolled)
-    uint32_t version;                   // Version (may be rolled for AsicBoost)
-    uint8_t  slave_id;                  // Which slave found it
+    uint32_t version;                   // Rolled bits only (rolled ^ job version), as stratum submits
+    uint16_t slave_id;                  // Node address that found it (see cluster_topology.h)
     int64_t  timestamp;                 // When share was found
     uint8_t  pool_id;                   // Pool ID: 0=primary, 1=secondary (for dual pool mode)
 } cluster_share_t;
@@ -129,15 +152,16 @@ typedef struct {
  * @brief Slave node information (tracked by master)
  */
 typedef struct {
-    uint8_t         slave_id;           // Slave ID (0-7)
+    uint8_t         slave_id;           // Slave ID (master slot)
     slave_state_t   state;              // Connection state
     char            hostname[32];       // Slave hostname/identifier
     char            ip_addr[16];        // Slave IP address (xxx.xxx.xxx.xxx)
-    uint8_t         mac_addr[6];        // ESP-NOW MAC address
+    uint8_t         mac_addr[6];        // Transport MAC address (ESP-NOW/UDP)
     uint32_t        hashrate;           // Last reported hashrate (GH/s * 100)
     uint32_t        shares_submitted;   // Total shares submitted by slave
     uint32_t        shares_accepted;    // Shares accepted by pool
     uint32_t        shares_rejected;    // Shares rejected by pool
+    uint32_t        shares_invalid;     // Failed master-side verification
     // Per-pool stats for dual pool mode
     uint32_t        shares_accepted_primary;
     uint32_t        shares_rejected_primary;
@@ -154,6 +178,23 @@ typedef struct {
     uint16_t        core_voltage;       // Core voltage (mV)
     float           power;              // Power consumption (W)
     float           voltage_in;         // Input voltage (V)
+    uint16_t        downstream_count;   // Nodes behind this slave if it is a relay
+    // Binary telemetry only (zero for slaves that send text heartbeats)
+    bool            telemetry;          // Slave streams $CLTLM frames
+    float           chip_temp2;         // Second temperature sensor
+    float           vr_temp;            // Voltage regulator temperature
+    uint16_t        fan2_rpm;
+    float           error_percent;      // Whole-board hardware error rate
+    uint8_t         asic_count;
+    float           asic_hashrate[CLUSTER_TELEMETRY_MAX_ASICS]; // GH/s per chip
+    float           asic_error[CLUSTER_TELEMETRY_MAX_ASICS];    // Error % per chip
+    uint8_t         asic_queue;         // Jobs queued for the ASIC
+    uint8_t         share_queue;        // Shares waiting to be sent
+    // Clock estimate (see cluster_clock.h)
+    bool            clock_synced;
+    int64_t         clock_offset_us;    // Slave esp_timer minus master esp_timer
+    int32_t         clock_drift_ppb;    // Slave clock rate error, + = runs fast
+    int32_t         clock_delay_us;     // Quickest heartbeat round trip
 } cluster_slave_t;
 
 /**
@@ -177,6 +218,8 @@ typedef struct {
     uint32_t            total_hashrate;     // Combined cluster hashrate
     uint32_t            total_shares;
     uint32_t            work_distributed;
+    uint32_t            shares_invalid;     // Failed verification (all slaves)
+    uint32_t            shares_unverified;  // Submitted without verification
 
     // Tasks
     TaskHandle_t        coordinator_task;
@@ -189,7 +232,7 @@ typedef struct {
 typedef struct {
     bool                initialized;
     bool                registered;
-    uint8_t             my_id;              // Assigned slave ID
+    uint16_t            my_id;              // Assigned node address
     char                master_hostname[32];
 
     // Current work
@@ -203,8 +246,15 @@ typedef struct {
     // Statistics
     uint32_t            shares_found;
     uint32_t            shares_submitted;
+    uint32_t            shares_replayed;    // Submitted late from the replay ring
+    uint32_t            shares_lost;        // Evicted from a full replay ring
     int64_t             last_work_received;
 
+    // Uplink health
+    int64_t             last_uplink_rx;     // Last message from master/relay (ms)
+    bool                autonomous;         // Mining on rolled work, uplink down
+    int64_t             autonomous_since;   // When the uplink was declared down (ms)
+
     // Tasks
     TaskHandle_t        worker_task;
     TaskHandle_t        heartbeat_task;
@@ -229,6 +279,8 @@ typedef struct {
     uint32_t total_shares;          // Total shares found by cluster
     uint32_t total_shares_accepted; // Total shares accepted by pool
     uint32_t total_shares_rejected; // Total shares rejected by pool
+    uint32_t total_shares_invalid;  // Failed master-side verification
+    uint32_t total_shares_unverified; // Submitted without verification
     // Per-pool stats for dual pool mode
     uint32_t primary_shares_accepted;
     uint32_t primary_shares_rejected;
@@ -308,6 +360,11 @@ void cluster_master_get_stats(cluster_stats_t *stats, uint8_t *active_slaves);
  */
 esp_err_t cluster_master_get_slave(uint8_t slave_id, cluster_slave_t *slave);
 
+/**
+ * @brief Get number of unused slave slots (advertised in discovery beacons)
+ */
+uint8_t cluster_master_get_free_slots(void);
+
 /**
  * @brief Get slave information by slot index (for API enumeration)
  * @param slot_index Slot index (0 to CLUSTER_MAX_SLAVES-1)
@@ -330,6 +387,32 @@ esp_err_t cluster_master_handle_registration(const char *hostname,
  */
 esp_err_t cluster_master_handle_heartbeat_ex(const cluster_heartbeat_data_t *data);
 
+/**
+ * @brief Handle a binary telemetry frame (see cluster_telemetry.h)
+ * @param frame Raw frame decoded from a $CLTLM sentence
+ * @param clock Clock stamps from the sentence (may be NULL)
+ */
+esp_err_t cluster_master_handle_telemetry(uint16_t slave_id, const uint8_t *frame, size_t len,
+                                          const cluster_clock_stamp_t *clock);
+
+/**
+ * @brief Convert a slave's esp_timer timestamp to master time
+ * @param slot Slave slot
+ * @param node_us Timestamp taken on the slave (us)
+ * @param master_us Output: the same instant on the master's esp_timer
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if the slave's clock is not estimated yet
+ */
+esp_err_t cluster_master_to_master_time(uint8_t slot, int64_t node_us, int64_t *master_us);
+
+/**
+ * @brief Handle trace records uploaded by a slave ($CLTRC)
+ * @param node Uploading node
+ * @param lost Records the node dropped before it could upload them
+ * @param records Packed records (see cluster_trace.h)
+ */
+esp_err_t cluster_master_handle_trace(uint16_t node, uint32_t lost,
+                                      const uint8_t *records, size_t len);
+
 /**
  * @brief Handle slave heartbeat (legacy, for backwards compatibility)
  */
@@ -369,6 +452,11 @@ esp_err_t cluster_slave_get_work(cluster_work_t *work);
  */
 esp_err_t cluster_slave_submit_share(const cluster_share_t *share);
 
+/**
+ * @brief Queue a share for the share sender task (used by relays to forward)
+ */
+esp_err_t cluster_slave_queue_share(const cluster_share_t *share);
+
 /**
  * @brief Check if we have valid work
  */
@@ -382,7 +470,19 @@ esp_err_t cluster_slave_receive_work(const cluster_work_t *work);
 /**
  * @brief Handle registration acknowledgment from master
  */
-esp_err_t cluster_slave_handle_ack(uint8_t assigned_id, const char *hostname);
+esp_err_t cluster_slave_handle_ack(uint16_t assigned_id, const char *hostname);
+
+/**
+ * @brief Handle telemetry ack/NAK from the uplink
+ * @param ok false if the uplink could not decode our delta (send a keyframe)
+ */
+void cluster_slave_handle_telemetry_ack(uint8_t seq, bool ok);
+
+/**
+ * @brief Handle a clock echo from the uplink (heartbeat reply or telemetry ack)
+ * @param echo_t1 Stamp the uplink echoed back (0 = none)
+ */
+void cluster_slave_handle_clock_reply(int64_t echo_t1);
 
 /**
  * @brief Called by ASIC driver when a share is found in slave mode
@@ -401,6 +501,21 @@ void cluster_slave_on_share_found(uint32_t nonce, uint32_t job_id, uint32_t vers
  */
 void cluster_slave_get_shares(uint32_t *shares_found, uint32_t *shares_submitted);
 
+/**
+ * @brief Get this node's assigned address (CLUSTER_NODE_ADDR_INVALID if unregistered)
+ */
+uint16_t cluster_slave_get_node_addr(void);
+
+/**
+ * @brief Note that a message arrived from our uplink (called by the message handlers)
+ */
+void cluster_slave_on_uplink_rx(void);
+
+/**
+ * @brief Check whether the uplink has been heard from within CLUSTER_LINK_TIMEOUT_MS
+ */
+bool cluster_slave_uplink_alive(void);
+
 #endif // CLUSTER_ENABLED
 
 // ============================================================================
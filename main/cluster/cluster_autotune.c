@@ -10,23 +10,32 @@
  */
 
 #include "cluster_autotune.h"
+#include "cluster_autotune_coord.h"
+#include "cluster_autotune_online.h"
 #include "cluster_config.h"
 #include "cluster_integration.h"
+#include "cluster_profile_db.h"
+#include "cluster_remote_config.h"
 #include "esp_log.h"
+#include "esp_mac.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "nvs.h"
 #include "nvs_config.h"
 #include "asic.h"
 #include "power/vcore.h"
 #include "global_state.h"
 #include "device_config.h"
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
 
 #if CLUSTER_IS_MASTER
 #include "esp_http_client.h"
+#include "cJSON.h"
 #include "cluster.h"
 #endif
 
@@ -37,7 +46,12 @@ static const char *TAG = "autotune";
 // ============================================================================
 
 #define AUTOTUNE_STABILIZE_TIME_MS    20000   // Wait 20s for hashrate to stabilize
-#define AUTOTUNE_TEST_TIME_MS         45000   // Test each setting for 45s
+#define AUTOTUNE_TEST_TIME_MS         45000   // Test each setting for up to 45s
+#define AUTOTUNE_TEST_MIN_TIME_MS     15000   // ...or 15s once the hashrate is known well enough
+#define AUTOTUNE_CI_REL               0.02f   // 95% interval within 2% of the mean hashrate
+#define AUTOTUNE_ERROR_MAX_PCT        1.0f    // Settings with more hardware errors are unstable
+#define AUTOTUNE_BASE_TIME_MS         30000   // Settle at base settings before the first test
+#define AUTOTUNE_TICK_MS              1000    // Coordinator step
 #define AUTOTUNE_TASK_STACK_SIZE      4096
 #define AUTOTUNE_TASK_PRIORITY        5
 
@@ -46,6 +60,36 @@ static const char *TAG = "autotune";
 #define WATCHDOG_TASK_STACK_SIZE      3072
 #define WATCHDOG_TASK_PRIORITY        6       // Higher priority than autotune
 
+// Online optimizer configuration (after the lock)
+#define ONLINE_TICK_MS                5000    // One reading per tick, like the watchdog
+#define ONLINE_FREQ_STEP_MHZ          10
+#define ONLINE_VOLTAGE_STEP_MV        5
+#define ONLINE_MAX_FREQ_DEV_MHZ       50      // Box around the locked point
+#define ONLINE_MAX_VOLTAGE_DEV_MV     50
+#define ONLINE_FREQ_FLOOR_MHZ         400
+#define ONLINE_VOLTAGE_FLOOR_MV       1000
+#define ONLINE_SETTLE_MS              60000
+#define ONLINE_WINDOW_MS              300000  // 5 min averages
+#define ONLINE_MIN_CHANGE_MS          300000  // At most one move per 5 min (plus its revert)
+#define ONLINE_HOLD_MS                600000  // After a temperature or Vin breach
+#define ONLINE_REFERENCE_EVERY        12      // Probes between lock point references
+#define ONLINE_HYSTERESIS             0.003f
+#define ONLINE_TASK_STACK_SIZE        3072
+#define ONLINE_TASK_PRIORITY          4
+
+// Temperature-indexed profiles
+#define PROFILE_NVS_NAMESPACE         "autoprofile"   // Shared with the named profiles of the web UI
+#define PROFILE_NVS_KEY               "tempdb"
+#define PROFILE_FOLLOW_INTERVAL_MS    60000
+#define PROFILE_WARMUP_MS             300000  // After boot, before the first estimate is trusted
+#define PROFILE_PUSH_DELAY_MS         30000   // A slave's web server is up by then
+#define PROFILE_SENSOR_VALID_MS       600000  // Room sensor reading via the API
+#define PROFILE_EXTRAPOLATE_C         5       // Above the warmest profile
+#define PROFILE_FREQ_STEP_MHZ         5
+#define PROFILE_VOLTAGE_STEP_MV       5
+#define PROFILE_TASK_STACK_SIZE       4096
+#define PROFILE_TASK_PRIORITY         3
+
 // Temperature limits
 #define TEMP_TARGET_C         65       // Target max temperature - reject settings above this
 #define TEMP_CHECK_INTERVAL   5        // Check temp every N seconds during test
@@ -89,21 +133,23 @@ static struct {
     TaskHandle_t task_handle;
     SemaphoreHandle_t mutex;
 
-    // Measurement accumulators
-    float hashrate_sum;
-    float power_sum;
-    float temp_sum;
-    uint32_t sample_count;
     uint32_t test_start_time;
     uint32_t autotune_start_time;
 
+    // Devices tuned in parallel (snapshot of the coordinator, for the API)
+    const autotune_search_ops_t *search;
+    float power_budget_w;
+    bool apply_on_stop;
+    autotune_device_status_t devices[AUTOTUNE_COORD_MAX_NODES];
+    uint8_t device_count;
+
     // Global state reference
     GlobalState *global_state;
 
     // Slave autotune tracking (master only)
     bool include_master;
     uint8_t slave_include_mask;  // Bitmask of slaves to include
-    int8_t current_device;       // -1 = master, 0-7 = slave index
+    int8_t current_device;       // First device still tuning: -1 = master, 0-7 = slave
 
     // Watchdog state
     bool watchdog_enabled;
@@ -111,6 +157,22 @@ static struct {
     TaskHandle_t watchdog_task_handle;
     uint16_t watchdog_last_freq;     // Track for gradual reduction
     uint16_t watchdog_last_voltage;  // Track for gradual reduction
+
+    // Online optimizer state
+    bool online_enabled;
+    bool online_running;
+    TaskHandle_t online_task_handle;
+    autotune_online_t online;        // Snapshot for the API
+
+    // Temperature-indexed profiles
+    profile_db_t *profiles;
+    bool profile_follow;
+    bool profile_task_running;
+    float ambient_sensor;            // Room temperature posted via the API
+    int64_t ambient_sensor_ms;       // When, 0 = never
+    float ambient_sum[AUTOTUNE_COORD_MAX_NODES];     // Estimates during the run, per device slot
+    uint16_t ambient_samples[AUTOTUNE_COORD_MAX_NODES];
+    float followed_ambient[AUTOTUNE_COORD_MAX_NODES]; // At the last profile applied, NAN = none
 } g_autotune = {0};
 
 #if CLUSTER_IS_MASTER
@@ -125,26 +187,31 @@ typedef struct {
 
 static slave_autotune_result_t g_slave_results[CONFIG_CLUSTER_MAX_SLAVES] = {0};
 
-// HTTP response buffer for slave communication
+// HTTP response buffer for slave communication (autotune, watchdog and profile tasks share it)
 static char *http_response_buffer = NULL;
 static int http_response_len = 0;
+static SemaphoreHandle_t http_mutex = NULL;
+
+// Slave details for profiles, read over HTTP once per registration
+static profile_device_t g_slave_devices[CONFIG_CLUSTER_MAX_SLAVES];
+static bool g_slave_device_known[CONFIG_CLUSTER_MAX_SLAVES];
+static int64_t g_profile_push_at[CONFIG_CLUSTER_MAX_SLAVES];    // 0 = nothing to push
 
 static esp_err_t http_event_handler(esp_http_client_event_t *evt)
 {
     switch (evt->event_id) {
         case HTTP_EVENT_ON_DATA:
-            if (!esp_http_client_is_chunked_response(evt->client)) {
-                if (http_response_buffer == NULL) {
-                    http_response_buffer = malloc(evt->data_len + 1);
-                    http_response_len = 0;
-                } else {
-                    http_response_buffer = realloc(http_response_buffer, http_response_len + evt->data_len + 1);
-                }
-                if (http_response_buffer) {
-                    memcpy(http_response_buffer + http_response_len, evt->data, evt->data_len);
-                    http_response_len += evt->data_len;
-                    http_response_buffer[http_response_len] = '\0';
-                }
+            // Chunked too: /api/system/info is streamed, and data arrives de-chunked
+            if (http_response_buffer == NULL) {
+                http_response_buffer = malloc(evt->data_len + 1);
+                http_response_len = 0;
+            } else {
+                http_response_buffer = realloc(http_response_buffer, http_response_len + evt->data_len + 1);
+            }
+            if (http_response_buffer) {
+                memcpy(http_response_buffer + http_response_len, evt->data, evt->data_len);
+                http_response_len += evt->data_len;
+                http_response_buffer[http_response_len] = '\0';
             }
             break;
         default:
@@ -156,7 +223,7 @@ static esp_err_t http_event_handler(esp_http_client_event_t *evt)
 /**
  * @brief Apply frequency/voltage settings to a slave via HTTP PATCH
  */
-static esp_err_t apply_settings_to_slave(const char *ip_addr, uint16_t freq_mhz, uint16_t voltage_mv)
+static esp_err_t apply_settings_to_slave_http(const char *ip_addr, uint16_t freq_mhz, uint16_t voltage_mv)
 {
     if (!ip_addr || strlen(ip_addr) == 0) {
         return ESP_ERR_INVALID_ARG;
@@ -169,7 +236,11 @@ static esp_err_t apply_settings_to_slave(const char *ip_addr, uint16_t freq_mhz,
     snprintf(post_data, sizeof(post_data),
              "{\"frequency\":%d,\"coreVoltage\":%d}", freq_mhz, voltage_mv);
 
-    ESP_LOGI(TAG, "Applying to slave %s: %d MHz, %d mV", ip_addr, freq_mhz, voltage_mv);
+    ESP_LOGI(TAG, "Applying to slave %s over HTTP: %d MHz, %d mV", ip_addr, freq_mhz, voltage_mv);
+
+    if (http_mutex) {
+        xSemaphoreTake(http_mutex, portMAX_DELAY);
+    }
 
     // Free previous response
     if (http_response_buffer) {
@@ -188,6 +259,9 @@ static esp_err_t apply_settings_to_slave(const char *ip_addr, uint16_t freq_mhz,
     esp_http_client_handle_t client = esp_http_client_init(&config);
     if (!client) {
         ESP_LOGE(TAG, "Failed to init HTTP client");
+        if (http_mutex) {
+            xSemaphoreGive(http_mutex);
+        }
         return ESP_FAIL;
     }
 
@@ -213,13 +287,75 @@ static esp_err_t apply_settings_to_slave(const char *ip_addr, uint16_t freq_mhz,
         http_response_buffer = NULL;
     }
 
+    if (http_mutex) {
+        xSemaphoreGive(http_mutex);
+    }
+
     return err;
 }
 
+/**
+ * @brief Read a slave's ASIC model and board version from /api/system/info
+ *
+ * Leaves them unknown (matching any) if the slave does not answer.
+ */
+static void fetch_slave_device(const char *ip_addr, profile_device_t *device)
+{
+    char url[64];
+    snprintf(url, sizeof(url), "http://%s/api/system/info", ip_addr);
+
+    if (http_mutex) {
+        xSemaphoreTake(http_mutex, portMAX_DELAY);
+    }
+    if (http_response_buffer) {
+        free(http_response_buffer);
+        http_response_buffer = NULL;
+    }
+    http_response_len = 0;
+
+    esp_http_client_config_t config = {
+        .url = url,
+        .method = HTTP_METHOD_GET,
+        .timeout_ms = 5000,
+        .event_handler = http_event_handler,
+    };
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    if (client) {
+        if (esp_http_client_perform(client) == ESP_OK && esp_http_client_get_status_code(client) == 200 &&
+            http_response_buffer) {
+            cJSON *root = cJSON_Parse(http_response_buffer);
+            cJSON *model = root ? cJSON_GetObjectItem(root, "ASICModel") : NULL;
+            cJSON *board = root ? cJSON_GetObjectItem(root, "boardVersion") : NULL;
+            if (cJSON_IsString(model) && strncmp(model->valuestring, "BM", 2) == 0) {
+                device->asic_id = (uint16_t)atoi(model->valuestring + 2);
+            }
+            if (cJSON_IsString(board)) {
+                strncpy(device->board, board->valuestring, sizeof(device->board) - 1);
+            }
+            cJSON_Delete(root);
+        }
+        esp_http_client_cleanup(client);
+    }
+    if (http_response_buffer) {
+        free(http_response_buffer);
+        http_response_buffer = NULL;
+    }
+
+    if (http_mutex) {
+        xSemaphoreGive(http_mutex);
+    }
+}
+
 /**
  * @brief Get slave stats from cluster status
+ *
+ * Slaves streaming telemetry report every second; text heartbeats come
+ * less often, so a sample only counts when the report is new.
+ *
+ * @param last_report In/out: timestamp of the report last sampled
  */
-static bool get_slave_stats(int slave_id, float *hashrate, float *power, float *temp)
+static bool get_slave_stats(int slave_id, float *hashrate, float *power, float *temp,
+                            int64_t *last_report)
 {
     cluster_slave_t slave_info;
     if (cluster_master_get_slave_info(slave_id, &slave_info) != ESP_OK) {
@@ -230,6 +366,11 @@ static bool get_slave_stats(int slave_id, float *hashrate, float *power, float *
         return false;
     }
 
+    if (slave_info.last_heartbeat == *last_report) {
+        return false;
+    }
+    *last_report = slave_info.last_heartbeat;
+
     *hashrate = (float)slave_info.hashrate / 100.0f;  // Convert from GH/s * 100
     *power = slave_info.power;
     *temp = slave_info.temperature;
@@ -295,6 +436,30 @@ static const char* get_slave_ip(int slave_id)
     }
     return slave_info.ip_addr;
 }
+
+/**
+ * @brief Apply frequency/voltage settings to a slave
+ *
+ * Over the cluster transport, ramped (cluster_remote_config.h). A slave
+ * that never answers, such as one on older firmware, gets an HTTP PATCH
+ * instead if it has an IP.
+ */
+static esp_err_t apply_settings_to_slave(int slave_id, uint16_t freq_mhz, uint16_t voltage_mv)
+{
+    ESP_LOGI(TAG, "Applying to slave %d: %d MHz, %d mV", slave_id, freq_mhz, voltage_mv);
+
+    esp_err_t err = cluster_master_set_slave_mining((uint8_t)slave_id, freq_mhz, voltage_mv);
+    if (err != ESP_ERR_TIMEOUT) {
+        return err;
+    }
+
+    const char *ip = get_slave_ip(slave_id);
+    if (!ip) {
+        ESP_LOGW(TAG, "Slave %d did not answer and has no IP address", slave_id);
+        return err;
+    }
+    return apply_settings_to_slave_http(ip, freq_mhz, voltage_mv);
+}
 #endif // CLUSTER_IS_MASTER
 
 // ============================================================================
@@ -393,276 +558,524 @@ static int get_voltage_step_count(autotune_mode_t mode)
     return count;
 }
 
-static float calculate_efficiency(float hashrate_gh, float power_w)
+// ============================================================================
+// Coordinator Device Access
+// ============================================================================
+
+static esp_err_t coord_apply(int8_t device, uint16_t freq_mhz, uint16_t voltage_mv, void *ctx)
 {
-    if (hashrate_gh <= 0 || power_w <= 0) {
-        return 999999.0f;  // Invalid - return very high (bad) efficiency
+    (void)ctx;
+    if (device == AUTOTUNE_COORD_DEVICE_MASTER) {
+        return cluster_autotune_apply_settings(freq_mhz, voltage_mv);
     }
-    // J/TH = (Watts * 1000) / (GH/s)
-    return (power_w * 1000.0f) / hashrate_gh;
+#if CLUSTER_IS_MASTER
+    return apply_settings_to_slave(device, freq_mhz, voltage_mv);
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
 }
 
-static void reset_measurements(void)
+static bool coord_sample(int8_t device, autotune_sample_t *sample, void *ctx)
 {
-    g_autotune.hashrate_sum = 0;
-    g_autotune.power_sum = 0;
-    g_autotune.temp_sum = 0;
-    g_autotune.sample_count = 0;
-    g_autotune.test_start_time = esp_timer_get_time() / 1000;
+    if (device == AUTOTUNE_COORD_DEVICE_MASTER) {
+        sample->hashrate_gh = get_current_hashrate();
+        sample->power_w = get_current_power();
+        sample->temp_c = get_current_temp();
+        sample->vin = get_input_voltage();
+        sample->error_pct = g_autotune.global_state ?
+                            g_autotune.global_state->SYSTEM_MODULE.error_percentage : 0;
+        return true;
+    }
+#if CLUSTER_IS_MASTER
+    // Slaves: whatever their last heartbeat or telemetry frame reported
+    int64_t *last_report = ctx;
+    cluster_slave_t slave_info;
+    if (!get_slave_stats(device, &sample->hashrate_gh, &sample->power_w, &sample->temp_c,
+                         &last_report[device]) ||
+        cluster_master_get_slave_info(device, &slave_info) != ESP_OK) {
+        return false;
+    }
+    sample->vin = slave_info.voltage_in;
+    sample->error_pct = slave_info.error_percent;
+    return true;
+#else
+    (void)ctx;
+    return false;
+#endif
 }
 
-static void collect_sample(void)
+/**
+ * @brief Copy the coordinator's progress into the status the API reads
+ */
+static void publish_progress(const autotune_coord_t *coord)
 {
-    g_autotune.hashrate_sum += get_current_hashrate();
-    g_autotune.power_sum += get_current_power();
-    g_autotune.temp_sum += get_current_temp();
-    g_autotune.sample_count++;
+    lock();
+
+    uint16_t done = 0, total = 0;
+    bool testing = false, settling = false;
+    g_autotune.current_device = -1;
+    bool current_set = false;
+
+    for (int i = 0; i < coord->count; i++) {
+        const autotune_node_t *node = &coord->nodes[i];
+        autotune_device_status_t *dev = &g_autotune.devices[i];
+
+        dev->device = node->device;
+        dev->state = cluster_autotune_node_state_name(node->state);
+        dev->current_frequency = node->freq_mhz;
+        dev->current_voltage = node->voltage_mv;
+        dev->best_frequency = node->best_freq;
+        dev->best_voltage = node->best_voltage;
+        dev->best_efficiency = node->best_efficiency;
+        dev->best_hashrate = node->best_hashrate;
+        dev->power = node->power_w;
+        dev->tests_completed = node->tests_done;
+        dev->tests_total = node->tests_total;
+        dev->budget_wait_ms = node->budget_wait_ms;
+
+        done += node->tests_done;
+        total += node->tests_total;
+        testing |= node->state == AUTOTUNE_NODE_TESTING;
+        settling |= node->state == AUTOTUNE_NODE_BASE || node->state == AUTOTUNE_NODE_STABILIZING;
+
+        if (!current_set && node->state != AUTOTUNE_NODE_DONE && node->state != AUTOTUNE_NODE_FAILED) {
+            g_autotune.current_device = node->device;
+            current_set = true;
+        }
+
+        // Headline numbers follow the master, or the first slave without it
+        if (i == 0) {
+            g_autotune.status.current_frequency = node->freq_mhz;
+            g_autotune.status.current_voltage = node->voltage_mv;
+            g_autotune.status.best_frequency = node->best_freq;
+            g_autotune.status.best_voltage = node->best_voltage;
+            g_autotune.status.best_efficiency = node->best_efficiency;
+            g_autotune.status.best_hashrate = node->best_hashrate;
+        }
+
+#if CLUSTER_IS_MASTER
+        if (node->device >= 0 && node->state == AUTOTUNE_NODE_DONE) {
+            g_slave_results[node->device].best_frequency = node->best_freq;
+            g_slave_results[node->device].best_voltage = node->best_voltage;
+            g_slave_results[node->device].best_efficiency = node->best_efficiency;
+            g_slave_results[node->device].best_hashrate = node->best_hashrate;
+            g_slave_results[node->device].valid = node->best_freq > 0;
+        }
+#endif
+    }
+    g_autotune.device_count = coord->count;
+    if (done > total) {
+        total = done;   // Adaptive searches only estimate their points
+    }
+
+    g_autotune.status.state = testing ? AUTOTUNE_STATE_TESTING :
+                              settling ? AUTOTUNE_STATE_STABILIZING : AUTOTUNE_STATE_ADJUSTING;
+    g_autotune.status.tests_completed = done;
+    g_autotune.status.tests_total = total;
+    g_autotune.status.progress_percent = total ? (done * 100) / total : 0;
+    g_autotune.status.power_budget_w = coord->config.power_budget_w;
+    g_autotune.status.power_committed_w = cluster_autotune_coord_committed(coord);
+
+    unlock();
 }
 
-static void get_average_measurements(float *avg_hashrate, float *avg_power, float *avg_temp)
+// ============================================================================
+// Online Optimizer
+// ============================================================================
+
+static esp_err_t online_apply(uint16_t freq_mhz, uint16_t voltage_mv, void *ctx)
 {
-    if (g_autotune.sample_count > 0) {
-        *avg_hashrate = g_autotune.hashrate_sum / g_autotune.sample_count;
-        *avg_power = g_autotune.power_sum / g_autotune.sample_count;
-        *avg_temp = g_autotune.temp_sum / g_autotune.sample_count;
-    } else {
-        *avg_hashrate = 0;
-        *avg_power = 0;
-        *avg_temp = 0;
-    }
+    (void)ctx;
+    return cluster_autotune_apply_settings(freq_mhz, voltage_mv);
 }
 
 /**
- * @brief Check input voltage and apply protection if needed
- * @return true if voltage is OK, false if protection was applied
+ * @brief Settings the board was last given, by us or by the watchdog
+ *
+ * Not the measured core voltage, which never matches the setting exactly.
  */
-static bool check_input_voltage_protection(void)
+static void get_applied_settings(uint16_t *freq_mhz, uint16_t *voltage_mv)
 {
-    float vin = get_input_voltage();
+    GlobalState *GLOBAL_STATE = cluster_get_global_state();
+    *freq_mhz = GLOBAL_STATE ? (uint16_t)(GLOBAL_STATE->POWER_MANAGEMENT_MODULE.frequency_value + 0.5f) : 0;
+    *voltage_mv = nvs_config_get_u16(NVS_CONFIG_ASIC_VOLTAGE);
+}
 
-    if (vin < VIN_MIN_SAFE) {
-        ESP_LOGW(TAG, "INPUT VOLTAGE LOW: %.2fV < %.2fV - Dropping core voltage to %d mV for protection!",
-                 vin, VIN_MIN_SAFE, VOLTAGE_SAFE_MV);
+static void cluster_autotune_online_task(void *pvParameters)
+{
+    (void)pvParameters;
 
-        // Apply safe voltage immediately
-        GlobalState *GLOBAL_STATE = cluster_get_global_state();
-        if (GLOBAL_STATE) {
-            VCORE_set_voltage(GLOBAL_STATE, VOLTAGE_SAFE_MV / 1000.0f);
-            nvs_config_set_u16(NVS_CONFIG_ASIC_VOLTAGE, VOLTAGE_SAFE_MV);
-
-            // Update status
-            lock();
-            g_autotune.status.current_voltage = VOLTAGE_SAFE_MV;
-            strncpy(g_autotune.status.error_msg, "Low input voltage - reduced core voltage",
-                    sizeof(g_autotune.status.error_msg));
-            unlock();
-        }
-        return false;
+    g_autotune.global_state = cluster_get_global_state();
+
+    uint16_t freq_mhz, voltage_mv;
+    get_applied_settings(&freq_mhz, &voltage_mv);
+
+    autotune_mode_t mode = g_autotune.status.mode;
+    autotune_online_config_t config = {
+        .mode = mode,
+        .freq_step_mhz = ONLINE_FREQ_STEP_MHZ,
+        .voltage_step_mv = ONLINE_VOLTAGE_STEP_MV,
+        .max_freq_dev_mhz = ONLINE_MAX_FREQ_DEV_MHZ,
+        .max_voltage_dev_mv = ONLINE_MAX_VOLTAGE_DEV_MV,
+        .freq_min = ONLINE_FREQ_FLOOR_MHZ,
+        .freq_max = get_max_freq_for_mode(mode),
+        .voltage_min = ONLINE_VOLTAGE_FLOOR_MV,
+        .voltage_max = get_max_voltage_for_mode(mode),
+        .settle_ms = ONLINE_SETTLE_MS,
+        .window_ms = ONLINE_WINDOW_MS,
+        .min_change_ms = ONLINE_MIN_CHANGE_MS,
+        .hold_ms = ONLINE_HOLD_MS,
+        .reference_every = ONLINE_REFERENCE_EVERY,
+        .hysteresis = ONLINE_HYSTERESIS,
+        .temp_max_c = TEMP_TARGET_C,
+        .vin_min = VIN_MIN_SAFE,
+        .error_max_pct = AUTOTUNE_ERROR_MAX_PCT,
+    };
+    autotune_online_ops_t ops = {
+        .apply = online_apply,
+        .ctx = NULL,
+    };
+
+    // Ticked on a local copy: apply() takes the autotune mutex itself
+    autotune_online_t online;
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    cluster_autotune_online_init(&online, &config, &ops, freq_mhz, voltage_mv, now_ms);
+
+    ESP_LOGI(TAG, "Online optimizer started at %d MHz, %d mV (box +-%d MHz, +-%d mV)",
+             freq_mhz, voltage_mv, ONLINE_MAX_FREQ_DEV_MHZ, ONLINE_MAX_VOLTAGE_DEV_MV);
+
+    TickType_t last_wake = xTaskGetTickCount();
+    while (g_autotune.online_running) {
+        autotune_sample_t sample;
+        bool have_sample = coord_sample(AUTOTUNE_COORD_DEVICE_MASTER, &sample, NULL);
+        get_applied_settings(&freq_mhz, &voltage_mv);
+        now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        cluster_autotune_online_tick(&online, have_sample ? &sample : NULL, freq_mhz, voltage_mv, now_ms);
+
+        lock();
+        g_autotune.online = online;
+        unlock();
+
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(ONLINE_TICK_MS));
     }
 
-    if (vin < VIN_OK_MIN || vin > VIN_OK_MAX) {
-        ESP_LOGW(TAG, "Input voltage %.2fV outside optimal range (%.1f-%.1fV)",
-                 vin, VIN_OK_MIN, VIN_OK_MAX);
+    ESP_LOGI(TAG, "Online optimizer stopped at %d MHz, %d mV after %lu probes (%lu kept)",
+             online.freq_mhz, online.voltage_mv, (unsigned long)online.probes,
+             (unsigned long)online.kept);
+    g_autotune.online_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+static esp_err_t online_start(void)
+{
+    if (g_autotune.online_running) {
+        return ESP_OK;
     }
+    g_autotune.online_running = true;
+    BaseType_t ret = xTaskCreate(
+        cluster_autotune_online_task,
+        "autotune_online",
+        ONLINE_TASK_STACK_SIZE,
+        NULL,
+        ONLINE_TASK_PRIORITY,
+        &g_autotune.online_task_handle
+    );
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create online optimizer task");
+        g_autotune.online_running = false;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
 
-    return true;
+static void online_stop(void)
+{
+    if (!g_autotune.online_running) {
+        return;
+    }
+    g_autotune.online_running = false;
+
+    // Wait for task to exit, so it cannot apply behind the caller
+    vTaskDelay(pdMS_TO_TICKS(ONLINE_TICK_MS + 100));
 }
 
-#if CLUSTER_IS_MASTER
+// ============================================================================
+// Profile Database
+// ============================================================================
+
 /**
- * @brief Autotune a single slave device via HTTP
- * @param slave_id Slave ID (0-7)
- * @param mode Autotune mode
- * @return ESP_OK on success
+ * @brief Room temperature around a device
+ *
+ * There is no ambient sensor on the boards: a reading posted to the API is
+ * used while fresh, otherwise the chip temperature less its own heating
+ * (power times the chip-to-air thermal resistance).
  */
-static esp_err_t autotune_slave_device(int slave_id, autotune_mode_t mode)
+static float estimate_ambient(const autotune_sample_t *sample)
 {
-    const char *ip_addr = get_slave_ip(slave_id);
-    if (!ip_addr) {
-        ESP_LOGW(TAG, "Slave %d has no IP address - skipping", slave_id);
-        return ESP_ERR_NOT_FOUND;
+    int64_t now_ms = esp_timer_get_time() / 1000;
+    if (g_autotune.ambient_sensor_ms && now_ms - g_autotune.ambient_sensor_ms < PROFILE_SENSOR_VALID_MS) {
+        return g_autotune.ambient_sensor;
     }
+    return sample->temp_c - sample->power_w * CONFIG_CLUSTER_PROFILE_RTH / 100.0f;
+}
 
-    // Get slave info for logging
-    cluster_slave_t slave_info;
-    cluster_master_get_slave_info(slave_id, &slave_info);
+/**
+ * @brief Sample for the coordinator, averaging each device's ambient over the run
+ */
+static bool coord_sample_run(int8_t device, autotune_sample_t *sample, void *ctx)
+{
+    if (!coord_sample(device, sample, ctx)) {
+        return false;
+    }
+    if (sample->power_w > 0) {
+        int slot = device + 1;
+        g_autotune.ambient_sum[slot] += estimate_ambient(sample);
+        g_autotune.ambient_samples[slot]++;
+    }
+    return true;
+}
 
-    ESP_LOGI(TAG, "========================================");
-    ESP_LOGI(TAG, "CLUSTER AUTOTUNE: SLAVE %d (%s @ %s)", slave_id, slave_info.hostname, ip_addr);
-    ESP_LOGI(TAG, "Mode: %s", mode == AUTOTUNE_MODE_EFFICIENCY ? "EFFICIENCY" :
-                              mode == AUTOTUNE_MODE_BALANCED ? "BALANCED" : "MAX_HASHRATE");
-    ESP_LOGI(TAG, "Current: %d MHz, %d mV", slave_info.frequency, slave_info.core_voltage);
-    ESP_LOGI(TAG, "========================================");
+/**
+ * @brief Identify a device for the database
+ * @return false if it cannot be told apart from others (no MAC yet)
+ */
+static bool get_profile_device(int8_t device, profile_device_t *out)
+{
+    memset(out, 0, sizeof(*out));
 
-    uint16_t freq_max = get_max_freq_for_mode(mode);
-    uint16_t voltage_max = get_max_voltage_for_mode(mode);
-
-    ESP_LOGI(TAG, "Slave %d: Testing up to %d MHz, %d mV for %s mode",
-             slave_id, freq_max, voltage_max,
-             mode == AUTOTUNE_MODE_EFFICIENCY ? "efficiency" :
-             mode == AUTOTUNE_MODE_BALANCED ? "balanced" : "hashrate");
-
-    // Best found values for this slave
-    float best_efficiency = 999999.0f;
-    uint16_t best_freq = FREQ_BASE_MHZ;
-    uint16_t best_voltage = VOLTAGE_BASE_MV;
-    float best_hashrate = 0;
-
-    // Apply base settings to slave - this resets any previous profile
-    ESP_LOGI(TAG, "Slave %d: Resetting to base settings (%d MHz, %d mV)",
-             slave_id, FREQ_BASE_MHZ, VOLTAGE_BASE_MV);
-    if (apply_settings_to_slave(ip_addr, FREQ_BASE_MHZ, VOLTAGE_BASE_MV) != ESP_OK) {
-        ESP_LOGE(TAG, "Slave %d: FAILED to apply base settings via HTTP!", slave_id);
-        ESP_LOGE(TAG, "Check that slave is reachable at http://%s", ip_addr);
-        return ESP_FAIL;
+    if (device == AUTOTUNE_COORD_DEVICE_MASTER) {
+        esp_read_mac(out->mac, ESP_MAC_WIFI_STA);
+        GlobalState *GLOBAL_STATE = cluster_get_global_state();
+        if (GLOBAL_STATE) {
+            out->asic_id = GLOBAL_STATE->DEVICE_CONFIG.family.asic.chip_id;
+            if (GLOBAL_STATE->DEVICE_CONFIG.board_version) {
+                strncpy(out->board, GLOBAL_STATE->DEVICE_CONFIG.board_version, sizeof(out->board) - 1);
+            }
+        }
+        return true;
+    }
+
+#if CLUSTER_IS_MASTER
+    if (g_slave_device_known[device]) {
+        *out = g_slave_devices[device];
+        return true;
+    }
+
+    static const uint8_t no_mac[6] = {0};
+    cluster_slave_t slave_info;
+    if (cluster_master_get_slave_info(device, &slave_info) != ESP_OK ||
+        memcmp(slave_info.mac_addr, no_mac, sizeof(no_mac)) == 0) {
+        return false;
     }
+    memcpy(out->mac, slave_info.mac_addr, sizeof(out->mac));
 
-    // Longer stabilization for slaves (network latency + ASIC stabilization + heartbeat update)
-    ESP_LOGI(TAG, "Slave %d: Waiting 30s for initial stabilization...", slave_id);
-    vTaskDelay(pdMS_TO_TICKS(30000));  // 30 seconds for slave initial stabilization
+    const char *ip = get_slave_ip(device);
+    if (ip) {
+        fetch_slave_device(ip, out);
+    }
+    // Asked again next time if the slave did not answer
+    g_slave_devices[device] = *out;
+    g_slave_device_known[device] = out->asic_id != 0;
+    return true;
+#else
+    return false;
+#endif
+}
 
-    // Test frequency/voltage combinations
-    int test_num = 0;
-    int total_tests = get_freq_step_count(mode) * get_voltage_step_count(mode);
+static void profile_save(void)
+{
+    uint8_t *blob = malloc(CLUSTER_PROFILE_DB_BLOB_MAX);
+    if (!blob) {
+        return;
+    }
 
-    // Reset progress for this slave
     lock();
-    g_autotune.status.tests_total = total_tests;
-    g_autotune.status.tests_completed = 0;
-    g_autotune.status.progress_percent = 0;
-    g_autotune.status.current_frequency = FREQ_BASE_MHZ;
-    g_autotune.status.current_voltage = VOLTAGE_BASE_MV;
+    int len = cluster_profile_db_encode(g_autotune.profiles, blob, CLUSTER_PROFILE_DB_BLOB_MAX);
     unlock();
 
-    for (int fi = 0; fi < NUM_FREQ_STEPS && g_autotune.task_running; fi++) {
-        uint16_t test_freq = FREQ_STEPS[fi];
-        if (test_freq > freq_max) continue;
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(PROFILE_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(handle, PROFILE_NVS_KEY, blob, len);
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save profiles: %s", esp_err_to_name(err));
+    }
+    free(blob);
+}
 
-        for (int vi = 0; vi < NUM_VOLTAGE_STEPS && g_autotune.task_running; vi++) {
-            uint16_t test_voltage = VOLTAGE_STEPS[vi];
-            if (test_voltage > voltage_max) continue;
+static void profile_load(void)
+{
+    nvs_handle_t handle;
+    if (nvs_open(PROFILE_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
 
-            test_num++;
+    size_t len = 0;
+    uint8_t *blob = NULL;
+    if (nvs_get_blob(handle, PROFILE_NVS_KEY, NULL, &len) == ESP_OK && len > 0 &&
+        (blob = malloc(len)) != NULL && nvs_get_blob(handle, PROFILE_NVS_KEY, blob, &len) == ESP_OK) {
+        esp_err_t err = cluster_profile_db_decode(g_autotune.profiles, blob, len);
+        if (err == ESP_OK) {
+            ESP_LOGI(TAG, "Loaded %d temperature profiles", g_autotune.profiles->count);
+        } else {
+            ESP_LOGW(TAG, "Ignoring stored profiles: %s", esp_err_to_name(err));
+        }
+    }
+    free(blob);
+    nvs_close(handle);
+}
 
-            // Update status for UI
-            lock();
-            g_autotune.status.current_frequency = test_freq;
-            g_autotune.status.current_voltage = test_voltage;
-            unlock();
+/**
+ * @brief Remember every device that locked, at its mean ambient over the run
+ */
+static void profile_record_run(const autotune_coord_t *coord, autotune_mode_t mode)
+{
+    if (!g_autotune.profiles) {
+        return;
+    }
 
-            ESP_LOGI(TAG, "Slave %d: Testing %d MHz, %d mV (%d/%d)",
-                     slave_id, test_freq, test_voltage, test_num, total_tests);
+    // Before SNTP the clock starts at 1970; insertion order still breaks ties
+    time_t now = time(NULL);
+    uint32_t saved_at = now > 1600000000 ? (uint32_t)now : 0;
 
-            // Apply settings to slave via HTTP
-            esp_err_t apply_result = apply_settings_to_slave(ip_addr, test_freq, test_voltage);
-            if (apply_result != ESP_OK) {
-                ESP_LOGW(TAG, "Slave %d: HTTP request failed - check connectivity", slave_id);
-                continue;
-            }
+    int recorded = 0;
+    for (int i = 0; i < coord->count; i++) {
+        const autotune_node_t *node = &coord->nodes[i];
+        int slot = node->device + 1;
+        if (node->state != AUTOTUNE_NODE_DONE || node->best_freq == 0 || !g_autotune.ambient_samples[slot]) {
+            continue;
+        }
 
-            // Stabilization delay - longer for slaves due to network latency and heartbeat updates
-            // Slaves need time to: receive HTTP, apply settings, stabilize ASIC, send heartbeat
-            vTaskDelay(pdMS_TO_TICKS(AUTOTUNE_STABILIZE_TIME_MS));  // Full stabilization time
-
-            // Collect samples from cluster status
-            float hashrate_sum = 0, power_sum = 0, temp_sum = 0;
-            int sample_count = 0;
-            bool temp_exceeded = false;
-
-            for (int i = 0; i < AUTOTUNE_TEST_TIME_MS / 1000 && g_autotune.task_running; i++) {
-                vTaskDelay(pdMS_TO_TICKS(1000));
-
-                float h, p, t;
-                if (get_slave_stats(slave_id, &h, &p, &t)) {
-                    hashrate_sum += h;
-                    power_sum += p;
-                    temp_sum += t;
-                    sample_count++;
-
-                    if (t > TEMP_TARGET_C) {
-                        ESP_LOGW(TAG, "Slave %d: Temp %.1f°C exceeded target", slave_id, t);
-                        temp_exceeded = true;
-                        break;
-                    }
-                }
-            }
+        profile_device_t device;
+        if (!get_profile_device(node->device, &device)) {
+            continue;
+        }
+        float ambient = g_autotune.ambient_sum[slot] / g_autotune.ambient_samples[slot];
 
-            if (!g_autotune.task_running) break;
-            if (temp_exceeded || sample_count == 0) continue;
+        lock();
+        cluster_profile_db_record(g_autotune.profiles, &device, mode, ambient, node->best_freq,
+                                  node->best_voltage, node->best_efficiency, node->best_hashrate, saved_at);
+        g_autotune.followed_ambient[slot] = ambient;
+        unlock();
 
-            // Calculate results
-            float avg_hashrate = hashrate_sum / sample_count;
-            float avg_power = power_sum / sample_count;
-            float avg_temp = temp_sum / sample_count;
-            float efficiency = calculate_efficiency(avg_hashrate, avg_power);
+        ESP_LOGI(TAG, "Profile: %s %d at %.1f°C -> %d MHz, %d mV",
+                 node->device < 0 ? "master" : "slave", node->device, ambient,
+                 node->best_freq, node->best_voltage);
+        recorded++;
+    }
 
-            ESP_LOGI(TAG, "Slave %d: %.2f GH/s, %.2f W, %.2f J/TH, %.1f°C",
-                     slave_id, avg_hashrate, avg_power, efficiency, avg_temp);
+    if (recorded) {
+        profile_save();
+    }
+}
 
-            // Check if better based on mode
-            bool is_better = false;
-            if (mode == AUTOTUNE_MODE_EFFICIENCY) {
-                is_better = (efficiency < best_efficiency) && (avg_hashrate > 0) && (avg_temp <= TEMP_TARGET_C);
-            } else if (mode == AUTOTUNE_MODE_HASHRATE) {
-                is_better = (avg_hashrate > best_hashrate) && (avg_temp <= TEMP_TARGET_C);
-            } else {
-                float score = (best_efficiency > 0) ? (avg_hashrate / efficiency) : 0;
-                float best_score = (best_efficiency > 0 && best_efficiency < 999999.0f) ?
-                                   (best_hashrate / best_efficiency) : 0;
-                is_better = (score > best_score) && (avg_temp <= TEMP_TARGET_C);
-            }
+/**
+ * @brief Move a device to its profile once the ambient has moved half a bucket
+ */
+static void profile_follow_device(int8_t device, int64_t *last_report)
+{
+    // The optimizer owns this board's point while it runs
+    if (device == AUTOTUNE_COORD_DEVICE_MASTER && g_autotune.online_running) {
+        return;
+    }
 
-            if (is_better) {
-                best_efficiency = efficiency;
-                best_freq = test_freq;
-                best_voltage = test_voltage;
-                best_hashrate = avg_hashrate;
-                ESP_LOGI(TAG, "Slave %d: *** NEW BEST: %d MHz, %d mV ***", slave_id, best_freq, best_voltage);
+    autotune_sample_t sample;
+    profile_device_t id;
+    if (!coord_sample(device, &sample, last_report) || !get_profile_device(device, &id)) {
+        return;
+    }
+    float ambient = estimate_ambient(&sample);
+    int slot = device + 1;
 
-                // Update best values in status for UI
-                lock();
-                g_autotune.status.best_frequency = best_freq;
-                g_autotune.status.best_voltage = best_voltage;
-                g_autotune.status.best_efficiency = best_efficiency;
-                unlock();
-            }
+    lock();
+    const profile_entry_t *latest = cluster_profile_db_latest(g_autotune.profiles, &id);
+    float followed = g_autotune.followed_ambient[slot];
+    bool moved = isnan(followed) || fabsf(ambient - followed) >= g_autotune.profiles->bucket_c / 2.0f;
+    profile_match_t match;
+    esp_err_t err = latest && moved ?
+                    cluster_profile_db_lookup(g_autotune.profiles, &id, latest->mode, ambient, &match) :
+                    ESP_ERR_NOT_FOUND;
+    unlock();
 
-            // Update progress after each test
-            lock();
-            g_autotune.status.tests_completed = test_num;
-            g_autotune.status.progress_percent = (test_num * 100) / total_tests;
-            unlock();
-        }
+    if (err != ESP_OK) {
+        return;
     }
 
-    // Apply best settings to slave
-    if (g_autotune.task_running && best_freq > 0 && best_voltage > 0) {
-        ESP_LOGI(TAG, "========================================");
-        ESP_LOGI(TAG, "SLAVE %d (%s) AUTOTUNE COMPLETE!", slave_id, slave_info.hostname);
-        ESP_LOGI(TAG, "Best Settings: %d MHz, %d mV", best_freq, best_voltage);
-        ESP_LOGI(TAG, "Best Efficiency: %.2f J/TH @ %.2f GH/s", best_efficiency, best_hashrate);
-        ESP_LOGI(TAG, "Applying final settings via HTTP...");
+    ESP_LOGI(TAG, "Profile for %s %d at %.1f°C: %d MHz, %d mV (%d..%d°C%s)",
+             device < 0 ? "master" : "slave", device, ambient, match.freq_mhz, match.voltage_mv,
+             match.lower_c, match.upper_c, match.interpolated ? ", interpolated" : "");
+    if (coord_apply(device, match.freq_mhz, match.voltage_mv, NULL) == ESP_OK) {
+        g_autotune.followed_ambient[slot] = ambient;
+    }
+}
 
-        if (apply_settings_to_slave(ip_addr, best_freq, best_voltage) == ESP_OK) {
-            ESP_LOGI(TAG, "Slave %d: Settings applied successfully!", slave_id);
-        } else {
-            ESP_LOGE(TAG, "Slave %d: FAILED to apply final settings!", slave_id);
-        }
-        ESP_LOGI(TAG, "========================================");
+static void cluster_autotune_profile_task(void *pvParameters)
+{
+    (void)pvParameters;
 
-        // Store results
-        g_slave_results[slave_id].best_frequency = best_freq;
-        g_slave_results[slave_id].best_voltage = best_voltage;
-        g_slave_results[slave_id].best_efficiency = best_efficiency;
-        g_slave_results[slave_id].best_hashrate = best_hashrate;
-        g_slave_results[slave_id].valid = true;
-    } else if (!g_autotune.task_running) {
-        ESP_LOGW(TAG, "Slave %d: Autotune was stopped before completion", slave_id);
+    g_autotune.global_state = cluster_get_global_state();
+#if CLUSTER_IS_MASTER
+    int64_t last_report[CONFIG_CLUSTER_MAX_SLAVES] = {0};
+#else
+    int64_t *last_report = NULL;
+#endif
+
+    // Temperatures settle after boot before the first estimate counts
+    while (g_autotune.profile_task_running && esp_timer_get_time() / 1000 < PROFILE_WARMUP_MS) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
     }
 
+    ESP_LOGI(TAG, "Following temperature profiles");
+
+    TickType_t last_wake = xTaskGetTickCount();
+    while (g_autotune.profile_task_running) {
+        if (!g_autotune.task_running) {
+            profile_follow_device(AUTOTUNE_COORD_DEVICE_MASTER, last_report);
+#if CLUSTER_IS_MASTER
+            // A slave that just registered gets its profile once its web server is up
+            int64_t now_ms = esp_timer_get_time() / 1000;
+            for (int i = 0; i < CONFIG_CLUSTER_MAX_SLAVES; i++) {
+                if (g_profile_push_at[i] && now_ms < g_profile_push_at[i]) {
+                    continue;
+                }
+                g_profile_push_at[i] = 0;
+                profile_follow_device((int8_t)i, last_report);
+            }
+#endif
+        }
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(PROFILE_FOLLOW_INTERVAL_MS));
+    }
+
+    ESP_LOGI(TAG, "Stopped following temperature profiles");
+    vTaskDelete(NULL);
+}
+
+static esp_err_t profile_task_start(void)
+{
+    if (g_autotune.profile_task_running) {
+        return ESP_OK;
+    }
+    g_autotune.profile_task_running = true;
+    BaseType_t ret = xTaskCreate(
+        cluster_autotune_profile_task,
+        "autotune_profile",
+        PROFILE_TASK_STACK_SIZE,
+        NULL,
+        PROFILE_TASK_PRIORITY,
+        NULL
+    );
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create profile task");
+        g_autotune.profile_task_running = false;
+        return ESP_ERR_NO_MEM;
+    }
     return ESP_OK;
 }
-#endif // CLUSTER_IS_MASTER
 
 // ============================================================================
 // API Implementation
@@ -693,15 +1106,34 @@ esp_err_t cluster_autotune_init(void)
     g_autotune.include_master = true;
     g_autotune.slave_include_mask = 0xFF;  // All slaves
     g_autotune.current_device = -1;
+    g_autotune.power_budget_w = CONFIG_CLUSTER_AUTOTUNE_POWER_BUDGET_W;
+    g_autotune.search = &autotune_search_bisect;
+    g_autotune.online_enabled = CONFIG_CLUSTER_AUTOTUNE_ONLINE;
+    g_autotune.profile_follow = CONFIG_CLUSTER_AUTOTUNE_PROFILES;
+    for (int i = 0; i < AUTOTUNE_COORD_MAX_NODES; i++) {
+        g_autotune.followed_ambient[i] = NAN;
+    }
 
 #if CLUSTER_IS_MASTER
     // Clear slave results
     memset(g_slave_results, 0, sizeof(g_slave_results));
+    http_mutex = xSemaphoreCreateMutex();
 #endif
 
+    g_autotune.profiles = malloc(sizeof(profile_db_t));
+    if (g_autotune.profiles) {
+        cluster_profile_db_init(g_autotune.profiles, CONFIG_CLUSTER_PROFILE_BUCKET_C, PROFILE_EXTRAPOLATE_C,
+                                PROFILE_FREQ_STEP_MHZ, PROFILE_VOLTAGE_STEP_MV);
+        profile_load();
+    }
+
     g_autotune.initialized = true;
     ESP_LOGI(TAG, "Autotune module initialized");
 
+    if (g_autotune.profiles && g_autotune.profile_follow) {
+        profile_task_start();
+    }
+
     return ESP_OK;
 }
 
@@ -711,6 +1143,9 @@ esp_err_t cluster_autotune_start(autotune_mode_t mode)
         cluster_autotune_init();
     }
 
+    // A new run replaces the point the optimizer works around
+    online_stop();
+
     lock();
 
     if (g_autotune.task_running) {
@@ -725,11 +1160,20 @@ esp_err_t cluster_autotune_start(autotune_mode_t mode)
     g_autotune.status.tests_completed = 0;
     g_autotune.status.error_msg[0] = '\0';
     g_autotune.autotune_start_time = esp_timer_get_time() / 1000;
+    g_autotune.apply_on_stop = true;
+    g_autotune.device_count = 0;
 
-    // Calculate total tests based on mode limits
+    // Estimate total tests from the mode limits and the search
     int freq_count = get_freq_step_count(mode);
     int voltage_count = get_voltage_step_count(mode);
-    g_autotune.status.tests_total = freq_count * voltage_count;
+    autotune_search_grid_t grid = {
+        .mode = mode,
+        .freq_steps = FREQ_STEPS,
+        .freq_count = freq_count,
+        .voltage_steps = VOLTAGE_STEPS,
+        .voltage_count = voltage_count,
+    };
+    g_autotune.status.tests_total = g_autotune.search->estimate(&grid);
 
     // Get current settings
     g_autotune.status.current_frequency = cluster_get_asic_frequency();
@@ -755,8 +1199,8 @@ esp_err_t cluster_autotune_start(autotune_mode_t mode)
     g_autotune.task_running = true;
     unlock();
 
-    ESP_LOGI(TAG, "Autotune started in mode %d (%d freq x %d voltage = %d tests)",
-             mode, freq_count, voltage_count, g_autotune.status.tests_total);
+    ESP_LOGI(TAG, "Autotune started in mode %d (%d freq x %d voltage, %s search, ~%d tests)",
+             mode, freq_count, voltage_count, g_autotune.search->name, g_autotune.status.tests_total);
     return ESP_OK;
 }
 
@@ -769,7 +1213,8 @@ esp_err_t cluster_autotune_stop(bool apply_best)
         return ESP_OK;
     }
 
-    // Signal task to stop
+    // Signal task to stop; it applies each device's best point on the way out
+    g_autotune.apply_on_stop = apply_best;
     g_autotune.task_running = false;
 
     // Wait for task to finish
@@ -779,13 +1224,6 @@ esp_err_t cluster_autotune_stop(bool apply_best)
         lock();
     }
 
-    if (apply_best && g_autotune.status.best_frequency > 0 && g_autotune.status.best_voltage > 0) {
-        ESP_LOGI(TAG, "Applying best settings: %d MHz, %d mV",
-                 g_autotune.status.best_frequency, g_autotune.status.best_voltage);
-        cluster_autotune_apply_settings(g_autotune.status.best_frequency,
-                                         g_autotune.status.best_voltage);
-    }
-
     g_autotune.status.state = AUTOTUNE_STATE_IDLE;
     unlock();
 
@@ -896,302 +1334,149 @@ void cluster_autotune_task(void *pvParameters)
 
     g_autotune.global_state = cluster_get_global_state();
 
-    // Get mode limits
-    uint16_t freq_max = get_max_freq_for_mode(g_autotune.status.mode);
-    uint16_t voltage_max = get_max_voltage_for_mode(g_autotune.status.mode);
-
-    ESP_LOGI(TAG, "Mode %d: max %d MHz, %d mV | Temp target: %d°C",
-             g_autotune.status.mode, freq_max, voltage_max, TEMP_TARGET_C);
-
-    // Best found values - start with base settings
-    float best_efficiency = 999999.0f;
-    uint16_t best_freq = FREQ_BASE_MHZ;
-    uint16_t best_voltage = VOLTAGE_BASE_MV;
-    float best_hashrate = 0;
-    float best_temp = 0;
-
-    // First, apply base settings and stabilize
-    lock();
-    g_autotune.status.state = AUTOTUNE_STATE_STABILIZING;
-    unlock();
-
-    ESP_LOGI(TAG, "Applying base settings: %d MHz, %d mV", FREQ_BASE_MHZ, VOLTAGE_BASE_MV);
-    cluster_autotune_apply_settings(FREQ_BASE_MHZ, VOLTAGE_BASE_MV);
-
-    // Initial stabilization period
-    ESP_LOGI(TAG, "Waiting for initial stabilization (%d seconds)...", AUTOTUNE_STABILIZE_TIME_MS / 1000);
-    reset_measurements();
-
-    for (int i = 0; i < AUTOTUNE_STABILIZE_TIME_MS / 1000 && g_autotune.task_running; i++) {
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        collect_sample();
-
-        // Check input voltage periodically during stabilization
-        if (i % TEMP_CHECK_INTERVAL == 0) {
-            if (!check_input_voltage_protection()) {
-                ESP_LOGW(TAG, "Input voltage protection triggered during stabilization");
-            }
-        }
-    }
-
-    if (!g_autotune.task_running) {
-        ESP_LOGI(TAG, "Autotune stopped during stabilization");
+    autotune_coord_t *coord = calloc(1, sizeof(autotune_coord_t));
+#if CLUSTER_IS_MASTER
+    int64_t *last_report = calloc(CONFIG_CLUSTER_MAX_SLAVES, sizeof(int64_t));
+#else
+    int64_t *last_report = NULL;
+#endif
+    if (!coord || (CLUSTER_IS_MASTER && !last_report)) {
+        ESP_LOGE(TAG, "No memory for the autotune coordinator");
+        free(coord);
+        free(last_report);
+        lock();
+        g_autotune.status.state = AUTOTUNE_STATE_ERROR;
+        strncpy(g_autotune.status.error_msg, "Out of memory", sizeof(g_autotune.status.error_msg));
+        unlock();
+        g_autotune.task_running = false;
+        g_autotune.task_handle = NULL;
         vTaskDelete(NULL);
         return;
     }
 
-    // Main autotune loop - test frequency/voltage combinations
-    // Iterate through frequency steps
-    for (int fi = 0; fi < NUM_FREQ_STEPS && g_autotune.task_running; fi++) {
-        uint16_t test_freq = FREQ_STEPS[fi];
-
-        // Skip frequencies above mode limit
-        if (test_freq > freq_max) {
-            continue;
-        }
-
-        // Iterate through voltage steps
-        for (int vi = 0; vi < NUM_VOLTAGE_STEPS && g_autotune.task_running; vi++) {
-            uint16_t test_voltage = VOLTAGE_STEPS[vi];
-
-            // Skip voltages above mode limit
-            if (test_voltage > voltage_max) {
-                continue;
-            }
-
-            // Check input voltage before each test
-            if (!check_input_voltage_protection()) {
-                ESP_LOGW(TAG, "Skipping test due to low input voltage");
-                lock();
-                g_autotune.status.tests_completed++;
-                g_autotune.status.progress_percent =
-                    (g_autotune.status.tests_completed * 100) / g_autotune.status.tests_total;
-                unlock();
-                continue;
-            }
-
-            lock();
-            g_autotune.status.state = AUTOTUNE_STATE_ADJUSTING;
-            g_autotune.status.current_frequency = test_freq;
-            g_autotune.status.current_voltage = test_voltage;
-            unlock();
-
-            ESP_LOGI(TAG, "Testing: %d MHz, %d mV (test %d/%d)",
-                     test_freq, test_voltage,
-                     g_autotune.status.tests_completed + 1,
-                     g_autotune.status.tests_total);
-
-            // Apply settings
-            cluster_autotune_apply_settings(test_freq, test_voltage);
-
-            // Wait for stabilization
-            lock();
-            g_autotune.status.state = AUTOTUNE_STATE_STABILIZING;
-            unlock();
-
-            vTaskDelay(pdMS_TO_TICKS(AUTOTUNE_STABILIZE_TIME_MS / 2));
-
-            // Check temperature after stabilization - skip if already too hot
-            float temp = get_current_temp();
-            if (temp > TEMP_TARGET_C) {
-                ESP_LOGW(TAG, "Temperature %.1f°C exceeds target %d°C after stabilization - skipping",
-                         temp, TEMP_TARGET_C);
-                lock();
-                g_autotune.status.tests_completed++;
-                g_autotune.status.progress_percent =
-                    (g_autotune.status.tests_completed * 100) / g_autotune.status.tests_total;
-                unlock();
-                continue;
-            }
-
-            // Test phase - collect measurements with temperature monitoring
-            lock();
-            g_autotune.status.state = AUTOTUNE_STATE_TESTING;
-            unlock();
-
-            reset_measurements();
-            bool temp_exceeded = false;
-            float max_temp_seen = 0;
-
-            for (int i = 0; i < AUTOTUNE_TEST_TIME_MS / 1000 && g_autotune.task_running; i++) {
-                vTaskDelay(pdMS_TO_TICKS(1000));
-                collect_sample();
-
-                // Check temperature every TEMP_CHECK_INTERVAL seconds
-                if (i % TEMP_CHECK_INTERVAL == 0) {
-                    temp = get_current_temp();
-                    if (temp > max_temp_seen) max_temp_seen = temp;
-
-                    // Check if temperature exceeds target
-                    if (temp > TEMP_TARGET_C) {
-                        ESP_LOGW(TAG, "Temperature %.1f°C exceeded target %d°C during test",
-                                 temp, TEMP_TARGET_C);
-                        temp_exceeded = true;
-                        break;
-                    }
-
-                    // Also check input voltage during test
-                    if (!check_input_voltage_protection()) {
-                        ESP_LOGW(TAG, "Input voltage protection triggered during test");
-                        temp_exceeded = true;  // Use this flag to skip result
-                        break;
-                    }
-                }
-
-                // Update progress
-                lock();
-                g_autotune.status.test_duration_ms = (esp_timer_get_time() / 1000) - g_autotune.test_start_time;
-                unlock();
-            }
-
-            if (!g_autotune.task_running) break;
-
-            // Skip this result if temperature exceeded or voltage protection triggered
-            if (temp_exceeded) {
-                ESP_LOGW(TAG, "Skipping result (max temp: %.1f°C)", max_temp_seen);
-                lock();
-                g_autotune.status.tests_completed++;
-                g_autotune.status.progress_percent =
-                    (g_autotune.status.tests_completed * 100) / g_autotune.status.tests_total;
-                unlock();
-                continue;
-            }
-
-            // Calculate results
-            float avg_hashrate, avg_power, avg_temp;
-            get_average_measurements(&avg_hashrate, &avg_power, &avg_temp);
-            float efficiency = calculate_efficiency(avg_hashrate, avg_power);
-
-            ESP_LOGI(TAG, "Results: %.2f GH/s, %.2f W, %.2f J/TH, avg temp %.1f°C (max %.1f°C)",
-                     avg_hashrate, avg_power, efficiency, avg_temp, max_temp_seen);
-
-            // Check if this is better based on mode
-            bool is_better = false;
-
-            if (g_autotune.status.mode == AUTOTUNE_MODE_EFFICIENCY) {
-                // Best efficiency (lowest J/TH) while temp <= 65°C
-                is_better = (efficiency < best_efficiency) && (avg_hashrate > 0) && (avg_temp <= TEMP_TARGET_C);
-            }
-            else if (g_autotune.status.mode == AUTOTUNE_MODE_HASHRATE) {
-                // Highest hashrate while temp <= 65°C
-                // For hashrate mode, we push closer to temp limit
-                is_better = (avg_hashrate > best_hashrate) && (avg_temp <= TEMP_TARGET_C);
-            }
-            else {
-                // Balanced: best hashrate/efficiency score while temp <= 65°C
-                float score = (best_efficiency > 0) ? (avg_hashrate / efficiency) : 0;
-                float best_score = (best_efficiency > 0 && best_efficiency < 999999.0f) ?
-                                   (best_hashrate / best_efficiency) : 0;
-                is_better = (score > best_score) && (avg_temp <= TEMP_TARGET_C);
-            }
+    autotune_mode_t mode = g_autotune.status.mode;
+    autotune_coord_config_t config = {
+        .mode = mode,
+        .search = g_autotune.search->type,
+        .freq_steps = FREQ_STEPS,
+        .freq_count = NUM_FREQ_STEPS,
+        .freq_max = get_max_freq_for_mode(mode),
+        .voltage_steps = VOLTAGE_STEPS,
+        .voltage_count = NUM_VOLTAGE_STEPS,
+        .voltage_max = get_max_voltage_for_mode(mode),
+        .base_freq = FREQ_BASE_MHZ,
+        .base_voltage = VOLTAGE_BASE_MV,
+        .base_ms = AUTOTUNE_BASE_TIME_MS,
+        .stabilize_ms = AUTOTUNE_STABILIZE_TIME_MS,
+        .test_ms = AUTOTUNE_TEST_TIME_MS,
+        .test_min_ms = AUTOTUNE_TEST_MIN_TIME_MS,
+        .ci_rel = AUTOTUNE_CI_REL,
+        .error_max_pct = AUTOTUNE_ERROR_MAX_PCT,
+        .temp_max_c = TEMP_TARGET_C,
+        .vin_min = VIN_MIN_SAFE,
+        .power_budget_w = g_autotune.power_budget_w,
+    };
+    autotune_coord_ops_t ops = {
+        .apply = coord_apply,
+        .sample = coord_sample_run,
+        .ctx = last_report,
+    };
+    memset(g_autotune.ambient_sum, 0, sizeof(g_autotune.ambient_sum));
+    memset(g_autotune.ambient_samples, 0, sizeof(g_autotune.ambient_samples));
+    cluster_autotune_coord_init(coord, &config, &ops);
 
-            if (is_better) {
-                best_efficiency = efficiency;
-                best_freq = test_freq;
-                best_voltage = test_voltage;
-                best_hashrate = avg_hashrate;
-                best_temp = avg_temp;
+    ESP_LOGI(TAG, "Mode %d: max %d MHz, %d mV | Temp target: %d°C | Power budget: %.0f W | Search: %s",
+             mode, config.freq_max, config.voltage_max, TEMP_TARGET_C, config.power_budget_w,
+             g_autotune.search->name);
 
-                lock();
-                g_autotune.status.best_frequency = best_freq;
-                g_autotune.status.best_voltage = best_voltage;
-                g_autotune.status.best_efficiency = best_efficiency;
-                g_autotune.status.best_hashrate = best_hashrate;
-                unlock();
+#if CLUSTER_IS_MASTER
+    if (g_autotune.include_master) {
+        cluster_autotune_coord_add(coord, AUTOTUNE_COORD_DEVICE_MASTER);
+    }
 
-                ESP_LOGI(TAG, "*** NEW BEST: %d MHz, %d mV, %.2f J/TH, %.2f GH/s @ %.1f°C ***",
-                         best_freq, best_voltage, best_efficiency, best_hashrate, best_temp);
-            }
+    int slaves_skipped = 0;
+    for (int i = 0; i < CONFIG_CLUSTER_MAX_SLAVES && i < 8; i++) {
+        if (!(g_autotune.slave_include_mask & (1 << i))) {
+            continue;
+        }
 
-            // Update progress
-            lock();
-            g_autotune.status.tests_completed++;
-            g_autotune.status.progress_percent =
-                (g_autotune.status.tests_completed * 100) / g_autotune.status.tests_total;
-            unlock();
+        // Settings go over the cluster transport, so any registered slave will do
+        cluster_slave_t slave_info;
+        if (cluster_master_get_slave_info(i, &slave_info) != ESP_OK) {
+            continue;
         }
+        if (slave_info.state != SLAVE_STATE_ACTIVE) {
+            ESP_LOGW(TAG, "Slave %d (%s): not active, skipping autotune", i, slave_info.hostname);
+            slaves_skipped++;
+            continue;
+        }
+        ESP_LOGI(TAG, "Slave %d (%s): included", i, slave_info.hostname);
+        cluster_autotune_coord_add(coord, (int8_t)i);
     }
-
-    // Apply best settings found for master
-    if (g_autotune.task_running && g_autotune.include_master && best_freq > 0 && best_voltage > 0) {
-        ESP_LOGI(TAG, "========================================");
-        ESP_LOGI(TAG, "MASTER AUTOTUNE COMPLETE!");
-        ESP_LOGI(TAG, "Best settings: %d MHz, %d mV", best_freq, best_voltage);
-        ESP_LOGI(TAG, "Performance: %.2f GH/s, %.2f J/TH @ %.1f°C",
-                 best_hashrate, best_efficiency, best_temp);
-        ESP_LOGI(TAG, "========================================");
-
-        cluster_autotune_apply_settings(best_freq, best_voltage);
+    if (slaves_skipped > 0) {
+        ESP_LOGW(TAG, "%d slaves skipped - not reporting", slaves_skipped);
     }
+#else
+    cluster_autotune_coord_add(coord, AUTOTUNE_COORD_DEVICE_MASTER);
+#endif
 
-#if CLUSTER_IS_MASTER
-    // Now autotune slaves with IP addresses
-    if (g_autotune.task_running && g_autotune.slave_include_mask != 0) {
-        ESP_LOGI(TAG, "========================================");
-        ESP_LOGI(TAG, "Starting SLAVE autotune (mask: 0x%02X)", g_autotune.slave_include_mask);
-        ESP_LOGI(TAG, "Slaves must have valid IP addresses for HTTP-based autotune");
-        ESP_LOGI(TAG, "========================================");
-
-        int slaves_tuned = 0;
-        int slaves_skipped = 0;
-
-        for (int i = 0; i < CONFIG_CLUSTER_MAX_SLAVES && g_autotune.task_running; i++) {
-            // Check if this slave is included in the mask
-            if (!(g_autotune.slave_include_mask & (1 << i))) {
-                continue;
-            }
-
-            // Check if slave exists and has valid IP for HTTP communication
-            cluster_slave_t slave_info;
-            if (cluster_master_get_slave_info(i, &slave_info) != ESP_OK) {
-                ESP_LOGW(TAG, "Slave %d: Not registered, skipping autotune", i);
-                slaves_skipped++;
-                continue;
-            }
-
-            const char *ip = get_slave_ip(i);
-            if (!ip) {
-                ESP_LOGW(TAG, "Slave %d (%s): No valid IP address ('%s'), skipping autotune",
-                         i, slave_info.hostname,
-                         slave_info.ip_addr[0] ? slave_info.ip_addr : "empty");
-                ESP_LOGW(TAG, "  -> Ensure slave is connected to WiFi network for HTTP-based autotune");
-                slaves_skipped++;
-                continue;
-            }
+    ESP_LOGI(TAG, "Tuning %d devices in parallel", coord->count);
 
-            lock();
-            g_autotune.current_device = i;
-            unlock();
+    // Every device steps through its own points; one tick serves them all
+    bool finished = coord->count == 0;
+    TickType_t last_wake = xTaskGetTickCount();
+    while (!finished && g_autotune.task_running) {
+        uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        finished = cluster_autotune_coord_tick(coord, now_ms);
+        publish_progress(coord);
 
-            ESP_LOGI(TAG, "Slave %d (%s @ %s): Starting autotune", i, slave_info.hostname, ip);
-            slaves_tuned++;
+        lock();
+        g_autotune.test_start_time = coord->count ? coord->nodes[0].phase_start_ms : now_ms;
+        unlock();
 
-            // Autotune this slave
-            autotune_slave_device(i, g_autotune.status.mode);
+        if (!finished) {
+            vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(AUTOTUNE_TICK_MS));
         }
+    }
 
-        ESP_LOGI(TAG, "========================================");
-        ESP_LOGI(TAG, "SLAVE AUTOTUNE COMPLETE!");
-        ESP_LOGI(TAG, "Slaves tuned: %d, Skipped: %d", slaves_tuned, slaves_skipped);
-        if (slaves_skipped > 0) {
-            ESP_LOGW(TAG, "Some slaves were skipped - ensure they have valid WiFi IPs");
-        }
-        ESP_LOGI(TAG, "========================================");
-    } else if (g_autotune.task_running) {
-        ESP_LOGI(TAG, "No slaves selected for autotune (mask: 0x%02X)", g_autotune.slave_include_mask);
+    if (!finished && g_autotune.apply_on_stop) {
+        ESP_LOGI(TAG, "Autotune stopped - applying best settings found so far");
+        cluster_autotune_coord_finish_all(coord);
+        publish_progress(coord);
     }
-#endif // CLUSTER_IS_MASTER
+
+    ESP_LOGI(TAG, "========================================");
+    ESP_LOGI(TAG, "CLUSTER AUTOTUNE %s", finished ? "COMPLETE" : "STOPPED");
+    for (int i = 0; i < coord->count; i++) {
+        const autotune_node_t *node = &coord->nodes[i];
+        ESP_LOGI(TAG, "  %s %d: %s, %d MHz, %d mV, %.2f J/TH @ %.2f GH/s",
+                 node->device < 0 ? "master" : "slave", node->device,
+                 cluster_autotune_node_state_name(node->state),
+                 node->best_freq, node->best_voltage, node->best_efficiency, node->best_hashrate);
+    }
+    ESP_LOGI(TAG, "Peak committed power %.1f W, %lu overshoots corrected",
+             coord->peak_committed_w, (unsigned long)coord->step_backs);
+    ESP_LOGI(TAG, "========================================");
 
     // Final state
     lock();
-    if (g_autotune.task_running) {
-        g_autotune.status.state = AUTOTUNE_STATE_LOCKED;
-    } else {
-        g_autotune.status.state = AUTOTUNE_STATE_IDLE;
-    }
+    bool locked = finished && g_autotune.task_running;
+    g_autotune.status.state = locked ? AUTOTUNE_STATE_LOCKED : AUTOTUNE_STATE_IDLE;
     g_autotune.current_device = -1;
     unlock();
 
+    if (locked) {
+        profile_record_run(coord, mode);
+    }
+
+    // This board keeps following its best point, if it was tuned
+    if (locked && g_autotune.online_enabled && (!CLUSTER_IS_MASTER || g_autotune.include_master)) {
+        online_start();
+    }
+
+    free(coord);
+    free(last_report);
+
     g_autotune.task_running = false;
     g_autotune.task_handle = NULL;
 
@@ -1245,6 +1530,212 @@ int8_t cluster_autotune_get_current_device(void)
     return g_autotune.current_device;
 }
 
+/**
+ * @brief Set the cluster-wide power cap for the next run (0 = none)
+ */
+esp_err_t cluster_autotune_set_power_budget(float watts)
+{
+    if (watts < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    lock();
+    g_autotune.power_budget_w = watts;
+    unlock();
+    ESP_LOGI(TAG, "Autotune power budget set to %.0f W", watts);
+    return ESP_OK;
+}
+
+float cluster_autotune_get_power_budget(void)
+{
+    return g_autotune.power_budget_w;
+}
+
+esp_err_t cluster_autotune_set_search(const char *name)
+{
+    const autotune_search_ops_t *search = cluster_autotune_search_from_name(name);
+    if (!search) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    lock();
+    g_autotune.search = search;
+    unlock();
+    ESP_LOGI(TAG, "Autotune search set to %s", search->name);
+    return ESP_OK;
+}
+
+const char *cluster_autotune_get_search(void)
+{
+    return g_autotune.search ? g_autotune.search->name : autotune_search_bisect.name;
+}
+
+esp_err_t cluster_autotune_set_online(bool enable)
+{
+    if (!g_autotune.initialized) {
+        cluster_autotune_init();
+    }
+
+    g_autotune.online_enabled = enable;
+    ESP_LOGI(TAG, "Online optimizer %s", enable ? "enabled" : "disabled");
+    if (!enable) {
+        online_stop();
+        return ESP_OK;
+    }
+    if (g_autotune.status.state == AUTOTUNE_STATE_LOCKED && !g_autotune.task_running) {
+        return online_start();
+    }
+    return ESP_OK;
+}
+
+esp_err_t cluster_autotune_get_online_status(autotune_online_status_t *status)
+{
+    if (!status) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    lock();
+    const autotune_online_t *o = &g_autotune.online;
+    *status = (autotune_online_status_t){
+        .enabled = g_autotune.online_enabled,
+        .running = g_autotune.online_running,
+        .state = cluster_autotune_online_state_name(o->state),
+        .frequency = o->freq_mhz,
+        .voltage = o->voltage_mv,
+        .lock_frequency = o->lock_freq,
+        .lock_voltage = o->lock_voltage,
+        .gain_pct = o->gain_pct,
+        .have_gain = o->have_gain,
+        .probes = o->probes,
+        .kept = o->kept,
+        .reverted = o->reverted,
+        .unstable = o->unstable,
+        .breaches = o->breaches,
+        .rebases = o->rebases,
+    };
+    unlock();
+
+    return ESP_OK;
+}
+
+esp_err_t cluster_autotune_set_ambient(float celsius)
+{
+    if (celsius < -40.0f || celsius > 80.0f) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    g_autotune.ambient_sensor = celsius;
+    g_autotune.ambient_sensor_ms = esp_timer_get_time() / 1000;
+    return ESP_OK;
+}
+
+float cluster_autotune_get_ambient(bool *measured)
+{
+    int64_t now_ms = esp_timer_get_time() / 1000;
+    if (measured) {
+        *measured = g_autotune.ambient_sensor_ms && now_ms - g_autotune.ambient_sensor_ms < PROFILE_SENSOR_VALID_MS;
+    }
+    autotune_sample_t sample;
+    coord_sample(AUTOTUNE_COORD_DEVICE_MASTER, &sample, NULL);
+    return estimate_ambient(&sample);
+}
+
+esp_err_t cluster_autotune_set_profile_follow(bool enable)
+{
+    if (!g_autotune.initialized) {
+        cluster_autotune_init();
+    }
+
+    g_autotune.profile_follow = enable;
+    ESP_LOGI(TAG, "Temperature profiles %s", enable ? "followed" : "not followed");
+    if (!enable) {
+        g_autotune.profile_task_running = false;
+        return ESP_OK;
+    }
+    return g_autotune.profiles ? profile_task_start() : ESP_ERR_NO_MEM;
+}
+
+bool cluster_autotune_get_profile_follow(void)
+{
+    return g_autotune.profile_follow;
+}
+
+int cluster_autotune_get_profiles(autotune_profile_info_t *profiles, int max)
+{
+    if (!profiles || max <= 0 || !g_autotune.profiles) {
+        return 0;
+    }
+
+    lock();
+    int count = g_autotune.profiles->count < max ? g_autotune.profiles->count : max;
+    for (int i = 0; i < count; i++) {
+        const profile_entry_t *e = &g_autotune.profiles->entries[i];
+        autotune_profile_info_t *p = &profiles[i];
+        memcpy(p->mac, e->device.mac, sizeof(p->mac));
+        p->asic_id = e->device.asic_id;
+        memcpy(p->board, e->device.board, sizeof(p->board));
+        p->mode = e->mode;
+        p->temp_c = e->temp_c;
+        p->frequency = e->freq_mhz;
+        p->voltage = e->voltage_mv;
+        p->efficiency = e->efficiency;
+        p->hashrate = e->hashrate;
+        p->saved_at = e->saved_at;
+    }
+    unlock();
+    return count;
+}
+
+int cluster_autotune_get_profile_count(void)
+{
+    return g_autotune.profiles ? g_autotune.profiles->count : 0;
+}
+
+esp_err_t cluster_autotune_clear_profiles(void)
+{
+    if (!g_autotune.profiles) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    lock();
+    int removed = cluster_profile_db_forget(g_autotune.profiles, NULL);
+    for (int i = 0; i < AUTOTUNE_COORD_MAX_NODES; i++) {
+        g_autotune.followed_ambient[i] = NAN;
+    }
+    unlock();
+
+    ESP_LOGI(TAG, "Cleared %d temperature profiles", removed);
+    profile_save();
+    return ESP_OK;
+}
+
+void cluster_autotune_profile_slave_joined(uint8_t slave_id)
+{
+#if CLUSTER_IS_MASTER
+    if (slave_id >= CONFIG_CLUSTER_MAX_SLAVES) {
+        return;
+    }
+    // It may be another board in the same slot, or one that rebooted to its NVS settings
+    g_slave_device_known[slave_id] = false;
+    g_autotune.followed_ambient[slave_id + 1] = NAN;
+    g_profile_push_at[slave_id] = esp_timer_get_time() / 1000 + PROFILE_PUSH_DELAY_MS;
+#else
+    (void)slave_id;
+#endif
+}
+
+/**
+ * @brief Per-device progress of the current or last run
+ */
+int cluster_autotune_get_devices(autotune_device_status_t *devices, int max)
+{
+    if (!devices || max <= 0) {
+        return 0;
+    }
+    lock();
+    int count = g_autotune.device_count < max ? g_autotune.device_count : max;
+    memcpy(devices, g_autotune.devices, count * sizeof(autotune_device_status_t));
+    unlock();
+    return count;
+}
+
 // ============================================================================
 // Master Remote Autotune
 // ============================================================================
@@ -1435,11 +1926,6 @@ static void cluster_watchdog_task(void *pvParameters)
                 continue;  // Slave not active
             }
 
-            const char *ip = get_slave_ip(i);
-            if (!ip) {
-                continue;  // No valid IP for HTTP commands
-            }
-
             cluster_slave_t slave_info;
             if (cluster_master_get_slave_info(i, &slave_info) != ESP_OK) {
                 continue;
@@ -1496,7 +1982,7 @@ static void cluster_watchdog_task(void *pvParameters)
                     unlock();
                 }
 
-                apply_settings_to_slave(ip, new_slave_freq, new_slave_voltage);
+                apply_settings_to_slave(i, new_slave_freq, new_slave_voltage);
 
                 // Update cooldown timestamp for this slave
                 watchdog_slave_last_action[i] = now;
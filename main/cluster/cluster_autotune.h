@@ -3,7 +3,11 @@
  * @brief ClusterAxe Auto-Tuning Module
  *
  * Provides automatic frequency and voltage optimization for maximum efficiency.
- * Supports both local (master) and remote (slave) auto-tuning.
+ * Supports both local (master) and remote (slave) auto-tuning; all included
+ * devices are tuned at once under a shared power budget (see
+ * cluster_autotune_coord.h), each picking the points it tests with a search
+ * strategy (cluster_autotune_search.h). After the lock, an optional online
+ * optimizer keeps following the best point (cluster_autotune_online.h).
  *
  * @author ClusterAxe Project
  * @license GPL-3.0
@@ -63,14 +67,36 @@ typedef struct {
     uint32_t test_duration_ms;      // How long current test has run
     uint32_t total_duration_ms;     // Total autotune duration
 
-    // Stats
+    // Stats (summed over all devices being tuned)
     uint16_t tests_completed;
     uint16_t tests_total;
 
+    // Power budget
+    float power_budget_w;           // Cluster-wide cap, 0 = none
+    float power_committed_w;        // Measured draw plus reservations for points under test
+
     // Error info
     char error_msg[64];
 } autotune_status_t;
 
+/**
+ * @brief Progress of one device in a cluster autotune run
+ */
+typedef struct {
+    int8_t device;                  // -1 = master, 0-7 = slave
+    const char *state;              // base, waiting, stabilizing, testing, done, failed
+    uint16_t current_frequency;     // MHz
+    uint16_t current_voltage;       // mV
+    uint16_t best_frequency;
+    uint16_t best_voltage;
+    float best_efficiency;          // J/TH
+    float best_hashrate;            // GH/s
+    float power;                    // W, last reading
+    uint16_t tests_completed;
+    uint16_t tests_total;
+    uint32_t budget_wait_ms;        // Time held back by the power budget
+} autotune_device_status_t;
+
 // ============================================================================
 // API Functions
 // ============================================================================
@@ -154,10 +180,146 @@ void cluster_autotune_set_slave_include(uint8_t slave_id, bool include);
 
 /**
  * @brief Get current device being autotuned
+ *
+ * Devices are tuned in parallel; this is the first one not yet finished.
+ *
  * @return -1 for master, 0-7 for slaves, -1 if not running
  */
 int8_t cluster_autotune_get_current_device(void);
 
+/**
+ * @brief Set the cluster-wide power cap used by the next run
+ * @param watts Cap in watts, 0 for none
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if negative
+ */
+esp_err_t cluster_autotune_set_power_budget(float watts);
+
+/**
+ * @brief Get the cluster-wide power cap (0 = none)
+ */
+float cluster_autotune_get_power_budget(void);
+
+/**
+ * @brief Set how the next run picks points to test
+ * @param name "grid" (every point), "bisect" (lowest stable voltage per
+ *             frequency, the default) or "climb" (hill climb on the mode's score)
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if unknown
+ */
+esp_err_t cluster_autotune_set_search(const char *name);
+
+/**
+ * @brief Get the search strategy name
+ */
+const char *cluster_autotune_get_search(void);
+
+/**
+ * @brief Online optimizer on this board, after autotune locks
+ */
+typedef struct {
+    bool enabled;
+    bool running;
+    const char *state;              // baseline, probe, reference, hold
+    uint16_t frequency;             // Kept point, MHz
+    uint16_t voltage;               // mV
+    uint16_t lock_frequency;        // Point autotune locked
+    uint16_t lock_voltage;
+    float gain_pct;                 // J/TH saved over the lock point, from the last reference
+    bool have_gain;
+    uint32_t probes;
+    uint32_t kept;
+    uint32_t reverted;
+    uint32_t unstable;
+    uint32_t breaches;
+    uint32_t rebases;
+} autotune_online_status_t;
+
+/**
+ * @brief Enable/disable the online optimizer
+ *
+ * Once autotune locks, it keeps nudging this board's frequency and voltage
+ * around the locked point towards the mode's best score as the room warms
+ * and cools (see cluster_autotune_online.h). Starts right away if autotune
+ * is already locked, otherwise after the next run.
+ *
+ * @param enable true to enable
+ * @return ESP_OK, or ESP_ERR_NO_MEM if the task could not start
+ */
+esp_err_t cluster_autotune_set_online(bool enable);
+
+/**
+ * @brief Get the online optimizer's state and counters
+ */
+esp_err_t cluster_autotune_get_online_status(autotune_online_status_t *status);
+
+/**
+ * @brief A remembered lock (see cluster_profile_db.h)
+ */
+typedef struct {
+    uint8_t mac[6];
+    uint16_t asic_id;               // 0 = unknown
+    char board[6];                  // Empty = unknown
+    autotune_mode_t mode;
+    int8_t temp_c;                  // Ambient bucket
+    uint16_t frequency;
+    uint16_t voltage;
+    float efficiency;
+    float hashrate;
+    uint32_t saved_at;              // Unix time, 0 if the clock was not set
+} autotune_profile_info_t;
+
+/**
+ * @brief Report the room temperature from an external sensor
+ *
+ * Used instead of the estimate from chip temperature and power for
+ * the next 10 minutes.
+ *
+ * @param celsius -40 to 80
+ */
+esp_err_t cluster_autotune_set_ambient(float celsius);
+
+/**
+ * @brief Ambient temperature around this board
+ * @param measured Set true if it came from cluster_autotune_set_ambient (may be NULL)
+ */
+float cluster_autotune_get_ambient(bool *measured);
+
+/**
+ * @brief Enable/disable following the temperature profiles
+ *
+ * Every finished run is remembered per board, mode and ambient; when
+ * following, each board is moved to the point for the current ambient as
+ * the room warms or cools. Recording continues either way.
+ */
+esp_err_t cluster_autotune_set_profile_follow(bool enable);
+
+bool cluster_autotune_get_profile_follow(void);
+
+/**
+ * @brief Get the remembered locks
+ * @return Entries written
+ */
+int cluster_autotune_get_profiles(autotune_profile_info_t *profiles, int max);
+
+int cluster_autotune_get_profile_count(void);
+
+/**
+ * @brief Forget every remembered lock
+ */
+esp_err_t cluster_autotune_clear_profiles(void);
+
+/**
+ * @brief A slave registered: push its profile once it is reachable
+ */
+void cluster_autotune_profile_slave_joined(uint8_t slave_id);
+
+/**
+ * @brief Get per-device progress of the current or last run
+ * @param devices Output array
+ * @param max Entries in devices
+ * @return Devices written
+ */
+int cluster_autotune_get_devices(autotune_device_status_t *devices, int max);
+
 // ============================================================================
 // Master Remote Autotune (for controlling slaves)
 // ============================================================================
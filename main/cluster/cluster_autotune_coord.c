@@ -0,0 +1,564 @@
+/**
+ * @file cluster_autotune_coord.c
+ * @brief ClusterAxe parallel autotune coordinator
+ *
+ * Per-device state machines and the shared power budget. See
+ * cluster_autotune_coord.h for the flow; cluster_autotune.c supplies the
+ * device access and runs the tick.
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#include "cluster_autotune_coord.h"
+#include "esp_log.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "autotune_coord";
+
+static const char *s_node_state_names[] = {
+    [AUTOTUNE_NODE_IDLE]        = "idle",
+    [AUTOTUNE_NODE_BASE]        = "base",
+    [AUTOTUNE_NODE_WAITING]     = "waiting",
+    [AUTOTUNE_NODE_STABILIZING] = "stabilizing",
+    [AUTOTUNE_NODE_TESTING]     = "testing",
+    [AUTOTUNE_NODE_DONE]        = "done",
+    [AUTOTUNE_NODE_FAILED]      = "failed",
+};
+
+const char *cluster_autotune_node_state_name(autotune_node_state_t state)
+{
+    return state <= AUTOTUNE_NODE_FAILED ? s_node_state_names[state] : "unknown";
+}
+
+float cluster_autotune_score(autotune_mode_t mode, float hashrate_gh, float power_w)
+{
+    if (hashrate_gh <= 0 || power_w <= 0) {
+        return -1e9f;
+    }
+    float jth = (power_w * 1000.0f) / hashrate_gh;
+
+    switch (mode) {
+        case AUTOTUNE_MODE_HASHRATE:
+            return hashrate_gh;
+        case AUTOTUNE_MODE_BALANCED:
+            return hashrate_gh / jth;
+        case AUTOTUNE_MODE_EFFICIENCY:
+        default:
+            return -jth;
+    }
+}
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static const char *device_name(const autotune_node_t *node, char *buf, size_t len)
+{
+    if (node->device == AUTOTUNE_COORD_DEVICE_MASTER) {
+        return "master";
+    }
+    snprintf(buf, len, "slave %d", node->device);
+    return buf;
+}
+
+static bool is_mid_test(const autotune_node_t *node)
+{
+    return node->state == AUTOTUNE_NODE_STABILIZING || node->state == AUTOTUNE_NODE_TESTING;
+}
+
+static float node_committed(const autotune_node_t *node)
+{
+    if (is_mid_test(node) && node->reserved_w > node->power_w) {
+        return node->reserved_w;
+    }
+    return node->power_w;
+}
+
+static float others_committed(const autotune_coord_t *coord, const autotune_node_t *self)
+{
+    float sum = 0;
+    for (int i = 0; i < coord->count; i++) {
+        if (&coord->nodes[i] != self) {
+            sum += node_committed(&coord->nodes[i]);
+        }
+    }
+    return sum;
+}
+
+static void reset_accumulators(autotune_node_t *node, uint32_t now_ms)
+{
+    node->sum_hashrate = 0;
+    node->sum_power = 0;
+    node->sum_temp = 0;
+    node->sum_error = 0;
+    node->hashrate_mean = 0;
+    node->hashrate_m2 = 0;
+    node->samples = 0;
+    node->phase_start_ms = now_ms;
+}
+
+static void accumulate(autotune_node_t *node, const autotune_sample_t *s)
+{
+    node->sum_hashrate += s->hashrate_gh;
+    node->sum_power += s->power_w;
+    node->sum_temp += s->temp_c;
+    node->sum_error += s->error_pct;
+    node->samples++;
+
+    float delta = s->hashrate_gh - node->hashrate_mean;
+    node->hashrate_mean += delta / node->samples;
+    node->hashrate_m2 += delta * (s->hashrate_gh - node->hashrate_mean);
+}
+
+/**
+ * @brief Sequential test: is the mean hashrate known well enough to stop?
+ */
+static bool mean_is_tight(const autotune_coord_config_t *cfg, const autotune_node_t *node,
+                          uint32_t measured_ms)
+{
+    if (cfg->ci_rel <= 0 || measured_ms < cfg->test_min_ms ||
+        node->samples < AUTOTUNE_COORD_MIN_SAMPLES || node->hashrate_mean <= 0) {
+        return false;
+    }
+    // Student's t for a 95% interval, Cornish-Fisher expansion in the degrees of freedom
+    float df = node->samples - 1;
+    float t = 1.96f + 2.37f / df + 2.82f / (df * df);
+    float half_width = t * sqrtf(node->hashrate_m2 / df / node->samples);
+    return half_width <= cfg->ci_rel * node->hashrate_mean;
+}
+
+static bool apply(autotune_coord_t *coord, autotune_node_t *node, uint16_t freq, uint16_t voltage)
+{
+    if (coord->ops.apply(node->device, freq, voltage, coord->ops.ctx) != ESP_OK) {
+        return false;
+    }
+    node->freq_mhz = freq;
+    node->voltage_mv = voltage;
+    return true;
+}
+
+float cluster_autotune_coord_predict(const autotune_node_t *node, uint16_t freq_mhz,
+                                     uint16_t voltage_mv)
+{
+    if (node->ref_power_w <= 0 || node->ref_freq == 0 || node->ref_voltage == 0) {
+        return 0;
+    }
+    // Dynamic CMOS power: proportional to f and V squared
+    float v_ratio = (float)voltage_mv / node->ref_voltage;
+    float predicted = node->ref_power_w * ((float)freq_mhz / node->ref_freq) * v_ratio * v_ratio;
+    return predicted * AUTOTUNE_COORD_PREDICT_MARGIN;
+}
+
+float cluster_autotune_coord_committed(const autotune_coord_t *coord)
+{
+    return others_committed(coord, NULL);
+}
+
+// ============================================================================
+// Point Handling
+// ============================================================================
+
+/**
+ * @brief Give up on the point under test and fall back to the last good one
+ */
+static void abort_point(autotune_coord_t *coord, autotune_node_t *node,
+                        autotune_point_outcome_t outcome, const char *why)
+{
+    char name[16];
+    ESP_LOGW(TAG, "%s: %d MHz, %d mV aborted (%s)", device_name(node, name, sizeof(name)),
+             node->freq_mhz, node->voltage_mv, why);
+
+    node->search.ops->report(&node->search, node->freq_idx, node->voltage_idx, outcome, 0);
+    node->tests_done++;
+    node->tests_skipped++;
+    node->reserved_w = 0;
+    node->state = AUTOTUNE_NODE_WAITING;
+    apply(coord, node, node->ref_freq, node->ref_voltage);
+}
+
+static void record_result(const autotune_coord_t *coord, autotune_node_t *node)
+{
+    float hashrate = node->sum_hashrate / node->samples;
+    float power = node->sum_power / node->samples;
+    float temp = node->sum_temp / node->samples;
+
+    char name[16];
+    float jth = hashrate > 0 ? power * 1000.0f / hashrate : 0;
+    ESP_LOGI(TAG, "%s: %d MHz, %d mV: %.2f GH/s, %.2f W, %.2f J/TH, %.1f°C",
+             device_name(node, name, sizeof(name)), node->freq_mhz, node->voltage_mv,
+             hashrate, power, jth, temp);
+
+    if (node->result_count < AUTOTUNE_COORD_MAX_POINTS) {
+        node->results[node->result_count++] = (autotune_point_result_t){
+            .freq_mhz = node->freq_mhz,
+            .voltage_mv = node->voltage_mv,
+            .hashrate_gh = hashrate,
+            .power_w = power,
+        };
+    }
+
+    float score = cluster_autotune_score(coord->config.mode, hashrate, power);
+    node->search.ops->report(&node->search, node->freq_idx, node->voltage_idx,
+                             AUTOTUNE_POINT_OK, score);
+    float best = node->best_freq ?
+        cluster_autotune_score(coord->config.mode, node->best_hashrate,
+                               node->best_efficiency * node->best_hashrate / 1000.0f) : -1e9f;
+    if (hashrate > 0 && score > best) {
+        node->best_freq = node->freq_mhz;
+        node->best_voltage = node->voltage_mv;
+        node->best_efficiency = jth;
+        node->best_hashrate = hashrate;
+    }
+
+    // Predictions for the next points scale from the nearest measurement
+    node->ref_freq = node->freq_mhz;
+    node->ref_voltage = node->voltage_mv;
+    node->ref_power_w = power;
+    node->tests_done++;
+}
+
+/**
+ * @brief Apply the best measured point that fits what the others draw
+ */
+static void finish_node(autotune_coord_t *coord, autotune_node_t *node)
+{
+    const autotune_coord_config_t *cfg = &coord->config;
+    float cap = cfg->power_budget_w > 0 ? cfg->power_budget_w - others_committed(coord, node) : 0;
+
+    const autotune_point_result_t *pick = NULL;
+    float pick_score = 0;
+    for (int i = 0; i < node->result_count; i++) {
+        const autotune_point_result_t *r = &node->results[i];
+        if (r->hashrate_gh <= 0 || (cfg->power_budget_w > 0 && r->power_w > cap)) {
+            continue;
+        }
+        float score = cluster_autotune_score(cfg->mode, r->hashrate_gh, r->power_w);
+        if (!pick || score > pick_score) {
+            pick = r;
+            pick_score = score;
+        }
+    }
+
+    uint16_t freq = pick ? pick->freq_mhz : cfg->base_freq;
+    uint16_t voltage = pick ? pick->voltage_mv : cfg->base_voltage;
+
+    char name[16];
+    if (pick && (freq != node->best_freq || voltage != node->best_voltage)) {
+        ESP_LOGW(TAG, "%s: best %d MHz, %d mV does not fit the power budget, using %d MHz, %d mV",
+                 device_name(node, name, sizeof(name)), node->best_freq, node->best_voltage,
+                 freq, voltage);
+    }
+    if (pick) {
+        node->best_freq = freq;
+        node->best_voltage = voltage;
+        node->best_hashrate = pick->hashrate_gh;
+        node->best_efficiency = pick->power_w * 1000.0f / pick->hashrate_gh;
+    }
+
+    node->reserved_w = 0;
+    if (!apply(coord, node, freq, voltage)) {
+        ESP_LOGE(TAG, "%s: failed to apply final settings", device_name(node, name, sizeof(name)));
+        node->state = AUTOTUNE_NODE_FAILED;
+        return;
+    }
+    if (pick) {
+        node->power_w = pick->power_w;
+    }
+    node->state = AUTOTUNE_NODE_DONE;
+    node->tests_total = node->tests_done;
+    ESP_LOGI(TAG, "%s: done at %d MHz, %d mV (%d tested, %d skipped, %lu s waiting for budget)",
+             device_name(node, name, sizeof(name)), freq, voltage,
+             node->tests_done - node->tests_skipped, node->tests_skipped,
+             (unsigned long)(node->budget_wait_ms / 1000));
+}
+
+/**
+ * @brief Move a waiting node to its next point if the budget allows
+ */
+static void start_next_point(autotune_coord_t *coord, autotune_node_t *node, uint32_t now_ms,
+                             uint32_t elapsed_ms)
+{
+    const autotune_coord_config_t *cfg = &coord->config;
+    autotune_search_t *search = &node->search;
+
+    while (node->has_pending ||
+           search->ops->next(search, &node->pending_freq_idx, &node->pending_voltage_idx)) {
+        node->has_pending = true;
+        uint8_t fi = node->pending_freq_idx;
+        uint8_t vi = node->pending_voltage_idx;
+        uint16_t freq = coord->grid.freq_steps[fi];
+        uint16_t voltage = coord->grid.voltage_steps[vi];
+
+        float predicted = cluster_autotune_coord_predict(node, freq, voltage);
+        if (cfg->power_budget_w > 0 && predicted > node->power_w &&
+            others_committed(coord, node) + predicted > cfg->power_budget_w) {
+            bool others_testing = false;
+            for (int i = 0; i < coord->count; i++) {
+                if (&coord->nodes[i] != node && is_mid_test(&coord->nodes[i])) {
+                    others_testing = true;
+                }
+            }
+            if (others_testing) {
+                node->budget_wait_ms += elapsed_ms;     // Someone will free budget
+                return;
+            }
+            // Nothing will free budget: this point can't fit
+            char name[16];
+            ESP_LOGW(TAG, "%s: %d MHz, %d mV needs ~%.1f W, over the %.1f W budget - skipped",
+                     device_name(node, name, sizeof(name)), freq, voltage, predicted,
+                     cfg->power_budget_w);
+            node->has_pending = false;
+            search->ops->report(search, fi, vi, AUTOTUNE_POINT_LIMIT, 0);
+            node->tests_done++;
+            node->tests_skipped++;
+            continue;
+        }
+
+        node->has_pending = false;
+        if (!apply(coord, node, freq, voltage)) {
+            search->ops->report(search, fi, vi, AUTOTUNE_POINT_FAILED, 0);
+            node->tests_done++;
+            node->tests_skipped++;
+            continue;
+        }
+        node->freq_idx = fi;
+        node->voltage_idx = vi;
+        node->reserved_w = predicted;
+        node->state = AUTOTUNE_NODE_STABILIZING;
+        reset_accumulators(node, now_ms);
+
+        float committed = cluster_autotune_coord_committed(coord);
+        if (committed > coord->peak_committed_w) {
+            coord->peak_committed_w = committed;
+        }
+        return;
+    }
+
+    finish_node(coord, node);
+}
+
+// Temperature or input voltage out of limits
+static const char *limit_breached(const autotune_coord_config_t *cfg, const autotune_sample_t *s)
+{
+    if (s->temp_c > cfg->temp_max_c) {
+        return "temperature";
+    }
+    if (s->vin > 0 && s->vin < cfg->vin_min) {
+        return "input voltage";
+    }
+    return NULL;
+}
+
+static void step_node(autotune_coord_t *coord, autotune_node_t *node, uint32_t now_ms,
+                      uint32_t elapsed_ms)
+{
+    const autotune_coord_config_t *cfg = &coord->config;
+    autotune_sample_t s;
+    bool fresh = coord->ops.sample(node->device, &s, coord->ops.ctx);
+    if (fresh) {
+        node->power_w = s.power_w;
+    }
+    char name[16];
+
+    switch (node->state) {
+        case AUTOTUNE_NODE_IDLE:
+            if (!apply(coord, node, cfg->base_freq, cfg->base_voltage)) {
+                ESP_LOGE(TAG, "%s: failed to apply base settings", device_name(node, name, sizeof(name)));
+                node->state = AUTOTUNE_NODE_FAILED;
+                break;
+            }
+            node->state = AUTOTUNE_NODE_BASE;
+            reset_accumulators(node, now_ms);
+            break;
+
+        case AUTOTUNE_NODE_BASE:
+            if (fresh) {
+                accumulate(node, &s);
+            }
+            if (now_ms - node->phase_start_ms < cfg->base_ms) {
+                break;
+            }
+            if (node->samples == 0) {
+                ESP_LOGE(TAG, "%s: no telemetry at base settings", device_name(node, name, sizeof(name)));
+                node->state = AUTOTUNE_NODE_FAILED;
+                break;
+            }
+            node->ref_freq = cfg->base_freq;
+            node->ref_voltage = cfg->base_voltage;
+            node->ref_power_w = node->sum_power / node->samples;
+            node->state = AUTOTUNE_NODE_WAITING;
+            start_next_point(coord, node, now_ms, 0);
+            break;
+
+        case AUTOTUNE_NODE_WAITING:
+            start_next_point(coord, node, now_ms, elapsed_ms);
+            break;
+
+        case AUTOTUNE_NODE_STABILIZING:
+            if (fresh && limit_breached(cfg, &s)) {
+                abort_point(coord, node, AUTOTUNE_POINT_LIMIT, limit_breached(cfg, &s));
+                break;
+            }
+            if (now_ms - node->phase_start_ms >= cfg->stabilize_ms) {
+                node->state = AUTOTUNE_NODE_TESTING;
+                reset_accumulators(node, now_ms);
+            }
+            break;
+
+        case AUTOTUNE_NODE_TESTING:
+            if (fresh) {
+                if (limit_breached(cfg, &s)) {
+                    abort_point(coord, node, AUTOTUNE_POINT_LIMIT, limit_breached(cfg, &s));
+                    break;
+                }
+                accumulate(node, &s);
+                if (cfg->error_max_pct > 0 && node->samples >= AUTOTUNE_COORD_ERROR_SAMPLES &&
+                    node->sum_error / node->samples > cfg->error_max_pct) {
+                    abort_point(coord, node, AUTOTUNE_POINT_UNSTABLE, "error rate");
+                    break;
+                }
+            }
+            if (now_ms - node->phase_start_ms < cfg->test_ms) {
+                if (!mean_is_tight(cfg, node, now_ms - node->phase_start_ms)) {
+                    break;
+                }
+                node->tests_early++;
+            }
+            if (node->samples == 0) {
+                abort_point(coord, node, AUTOTUNE_POINT_FAILED, "no telemetry");
+                break;
+            }
+            record_result(coord, node);
+            node->reserved_w = 0;
+            node->state = AUTOTUNE_NODE_WAITING;
+            start_next_point(coord, node, now_ms, 0);
+            break;
+
+        case AUTOTUNE_NODE_DONE:
+        case AUTOTUNE_NODE_FAILED:
+            break;
+    }
+}
+
+/**
+ * @brief Step back the largest pending point if measured draw overshoots
+ */
+static void check_overshoot(autotune_coord_t *coord)
+{
+    float budget = coord->config.power_budget_w;
+    if (budget <= 0) {
+        return;
+    }
+
+    float measured = 0;
+    for (int i = 0; i < coord->count; i++) {
+        measured += coord->nodes[i].power_w;
+    }
+    if (measured <= budget * AUTOTUNE_COORD_OVERSHOOT) {
+        return;
+    }
+
+    autotune_node_t *worst = NULL;
+    for (int i = 0; i < coord->count; i++) {
+        autotune_node_t *node = &coord->nodes[i];
+        if (is_mid_test(node) && (!worst || node->power_w - node->ref_power_w >
+                                            worst->power_w - worst->ref_power_w)) {
+            worst = node;
+        }
+    }
+    if (worst) {
+        ESP_LOGW(TAG, "Cluster draws %.1f W over the %.1f W budget - stepping back", measured, budget);
+        coord->step_backs++;
+        worst->power_w = worst->ref_power_w;     // Until its next reading
+        abort_point(coord, worst, AUTOTUNE_POINT_LIMIT, "power budget");
+    }
+}
+
+// ============================================================================
+// API
+// ============================================================================
+
+void cluster_autotune_coord_init(autotune_coord_t *coord, const autotune_coord_config_t *config,
+                                 const autotune_coord_ops_t *ops)
+{
+    memset(coord, 0, sizeof(*coord));
+    coord->config = *config;
+    coord->ops = *ops;
+
+    // Both tables ascend, so the mode's limits cut them to a prefix
+    coord->grid.mode = config->mode;
+    coord->grid.freq_steps = config->freq_steps;
+    coord->grid.voltage_steps = config->voltage_steps;
+    while (coord->grid.freq_count < config->freq_count &&
+           config->freq_steps[coord->grid.freq_count] <= config->freq_max) {
+        coord->grid.freq_count++;
+    }
+    while (coord->grid.voltage_count < config->voltage_count &&
+           config->voltage_steps[coord->grid.voltage_count] <= config->voltage_max) {
+        coord->grid.voltage_count++;
+    }
+}
+
+esp_err_t cluster_autotune_coord_add(autotune_coord_t *coord, int8_t device)
+{
+    if (coord->count >= AUTOTUNE_COORD_MAX_NODES) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    autotune_node_t *node = &coord->nodes[coord->count++];
+    memset(node, 0, sizeof(*node));
+    node->device = device;
+    node->state = AUTOTUNE_NODE_IDLE;
+
+    const autotune_search_ops_t *search = cluster_autotune_search_find(coord->config.search);
+    if (!search) {
+        search = &autotune_search_grid;
+    }
+    cluster_autotune_search_init(&node->search, search, &coord->grid);
+    node->tests_total = search->estimate(&coord->grid);
+    return ESP_OK;
+}
+
+bool cluster_autotune_coord_tick(autotune_coord_t *coord, uint32_t now_ms)
+{
+    uint32_t elapsed = coord->last_tick_ms ? now_ms - coord->last_tick_ms : 0;
+    coord->last_tick_ms = now_ms;
+
+    // Rotate who is served first, so one device doesn't always win the budget
+    bool all_done = true;
+    for (int k = 0; k < coord->count; k++) {
+        autotune_node_t *node = &coord->nodes[(coord->rr + k) % coord->count];
+        step_node(coord, node, now_ms, elapsed);
+        if (node->state != AUTOTUNE_NODE_DONE && node->state != AUTOTUNE_NODE_FAILED) {
+            all_done = false;
+        }
+    }
+    if (coord->count) {
+        coord->rr = (coord->rr + 1) % coord->count;
+    }
+
+    check_overshoot(coord);
+    return all_done;
+}
+
+void cluster_autotune_coord_finish_all(autotune_coord_t *coord)
+{
+    // Drop everyone off their test points first, so the budget is free to share
+    for (int i = 0; i < coord->count; i++) {
+        autotune_node_t *node = &coord->nodes[i];
+        if (is_mid_test(node)) {
+            node->reserved_w = 0;
+            node->power_w = node->ref_power_w;
+        }
+    }
+    for (int i = 0; i < coord->count; i++) {
+        autotune_node_t *node = &coord->nodes[i];
+        if (node->state != AUTOTUNE_NODE_DONE && node->state != AUTOTUNE_NODE_FAILED &&
+            node->state != AUTOTUNE_NODE_IDLE) {
+            finish_node(coord, node);
+        }
+    }
+}
@@ -0,0 +1,223 @@
+/**
+ * @file cluster_autotune_coord.h
+ * @brief ClusterAxe parallel autotune coordinator
+ *
+ * Tunes every included device at once. Each device runs its own state
+ * machine over the frequency x voltage points its search strategy picks
+ * (cluster_autotune_search.h):
+ *
+ *   BASE -> WAITING -> STABILIZING -> TESTING -> WAITING -> ... -> DONE
+ *
+ * so a cluster takes about as long as one board instead of one board per
+ * device. Telemetry comes from what the devices already report (slave
+ * heartbeats / telemetry frames on the master), sampled each tick.
+ *
+ * A shared power cap (PSU or circuit) is respected: before a device moves
+ * to a new point, the coordinator predicts its draw there from the last
+ * point it measured (P ~ f * V^2) and only admits the step if the cluster
+ * stays within the budget; otherwise the device waits its turn, which
+ * staggers the high-power points. A point that cannot fit even with no
+ * other device mid-test is skipped. If measured draw still overshoots, the
+ * device with the largest pending point is stepped back.
+ *
+ * A point is measured for test_ms, or less with sequential testing: once
+ * test_min_ms has passed, measuring stops as soon as the 95% confidence
+ * interval of the mean hashrate is within ci_rel of it. A point whose error
+ * rate averages over error_max_pct is abandoned as unstable.
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#ifndef CLUSTER_AUTOTUNE_COORD_H
+#define CLUSTER_AUTOTUNE_COORD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "cluster_config.h"
+#include "cluster_autotune.h"
+#include "cluster_autotune_search.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUTOTUNE_COORD_MAX_NODES        (CONFIG_CLUSTER_MAX_SLAVES + 1)
+#define AUTOTUNE_COORD_MAX_POINTS       AUTOTUNE_SEARCH_MAX_POINTS
+#define AUTOTUNE_COORD_DEVICE_MASTER    (-1)
+#define AUTOTUNE_COORD_PREDICT_MARGIN   1.05f       // Headroom on predicted draw
+#define AUTOTUNE_COORD_OVERSHOOT        1.05f       // Measured draw over budget that forces a step back
+#define AUTOTUNE_COORD_MIN_SAMPLES      5           // Before a confidence interval is trusted
+#define AUTOTUNE_COORD_ERROR_SAMPLES    3           // Before the error rate is judged
+
+/**
+ * @brief One telemetry reading from a device
+ */
+typedef struct {
+    float   hashrate_gh;
+    float   power_w;
+    float   temp_c;
+    float   vin;                // 0 = not reported
+    float   error_pct;          // Hardware error rate
+} autotune_sample_t;
+
+/**
+ * @brief How the coordinator reaches devices
+ */
+typedef struct {
+    /** Apply settings to a device */
+    esp_err_t (*apply)(int8_t device, uint16_t freq_mhz, uint16_t voltage_mv, void *ctx);
+    /** Newest reading; false if the device has nothing new since the last call */
+    bool (*sample)(int8_t device, autotune_sample_t *sample, void *ctx);
+    void *ctx;
+} autotune_coord_ops_t;
+
+typedef struct {
+    autotune_mode_t mode;
+    autotune_search_type_t search;
+    const uint16_t  *freq_steps;
+    uint8_t         freq_count;
+    uint16_t        freq_max;           // Mode limit
+    const uint16_t  *voltage_steps;
+    uint8_t         voltage_count;
+    uint16_t        voltage_max;        // Mode limit
+    uint16_t        base_freq;
+    uint16_t        base_voltage;
+    uint32_t        base_ms;            // Settle at base before the first point
+    uint32_t        stabilize_ms;       // After each step, before measuring
+    uint32_t        test_ms;            // Measurement per point (longest)
+    uint32_t        test_min_ms;        // Shortest measurement with sequential testing
+    float           ci_rel;             // Stop once the CI is within this share of the mean, 0 = off
+    float           error_max_pct;      // Abandon the point above this error rate, 0 = off
+    float           temp_max_c;         // Abort the point above this
+    float           vin_min;            // Abort the point below this input voltage
+    float           power_budget_w;     // Cluster-wide cap, 0 = none
+} autotune_coord_config_t;
+
+typedef enum {
+    AUTOTUNE_NODE_IDLE = 0,
+    AUTOTUNE_NODE_BASE,                 // Settling at base settings
+    AUTOTUNE_NODE_WAITING,              // Next point waits for power budget
+    AUTOTUNE_NODE_STABILIZING,
+    AUTOTUNE_NODE_TESTING,
+    AUTOTUNE_NODE_DONE,                 // Best point that fits applied
+    AUTOTUNE_NODE_FAILED                // No telemetry or settings not applied
+} autotune_node_state_t;
+
+/**
+ * @brief Measured point
+ */
+typedef struct {
+    uint16_t    freq_mhz;
+    uint16_t    voltage_mv;
+    float       hashrate_gh;
+    float       power_w;
+} autotune_point_result_t;
+
+/**
+ * @brief One device being tuned
+ */
+typedef struct {
+    int8_t                  device;         // AUTOTUNE_COORD_DEVICE_MASTER or slave slot
+    autotune_node_state_t   state;
+    autotune_search_t       search;
+    bool                    has_pending;    // Point taken from the search, not started yet
+    uint8_t                 pending_freq_idx;
+    uint8_t                 pending_voltage_idx;
+    uint8_t                 freq_idx;       // Point under test
+    uint8_t                 voltage_idx;
+    uint16_t                freq_mhz;       // Applied now
+    uint16_t                voltage_mv;
+    uint32_t                phase_start_ms;
+
+    float                   sum_hashrate;
+    float                   sum_power;
+    float                   sum_temp;
+    float                   sum_error;
+    float                   hashrate_mean;  // Running variance (Welford)
+    float                   hashrate_m2;
+    uint16_t                samples;
+
+    float                   power_w;        // Latest measured draw
+    float                   reserved_w;     // Predicted draw of the point under test
+    uint16_t                ref_freq;       // Last measured point, predictions scale from it
+    uint16_t                ref_voltage;
+    float                   ref_power_w;
+
+    uint16_t                tests_done;
+    uint16_t                tests_total;
+    uint16_t                tests_skipped;
+    uint16_t                tests_early;    // Stopped early by sequential testing
+    uint32_t                budget_wait_ms; // Time spent waiting for budget
+
+    uint16_t                best_freq;
+    uint16_t                best_voltage;
+    float                   best_efficiency;    // J/TH
+    float                   best_hashrate;
+
+    uint8_t                 result_count;
+    autotune_point_result_t results[AUTOTUNE_COORD_MAX_POINTS];
+} autotune_node_t;
+
+typedef struct {
+    autotune_coord_config_t config;
+    autotune_coord_ops_t    ops;
+    autotune_search_grid_t  grid;           // Mode's points, shared by every node's search
+    autotune_node_t         nodes[AUTOTUNE_COORD_MAX_NODES];
+    uint8_t                 count;
+    uint8_t                 rr;             // Node served first next tick
+    uint32_t                last_tick_ms;
+    uint32_t                step_backs;     // Overshoots corrected
+    float                   peak_committed_w;
+} autotune_coord_t;
+
+/**
+ * @brief Start a run with no devices
+ */
+void cluster_autotune_coord_init(autotune_coord_t *coord, const autotune_coord_config_t *config,
+                                 const autotune_coord_ops_t *ops);
+
+/**
+ * @brief Add a device; it starts at base settings on the next tick
+ * @return ESP_ERR_NO_MEM when full
+ */
+esp_err_t cluster_autotune_coord_add(autotune_coord_t *coord, int8_t device);
+
+/**
+ * @brief Advance every device (call about once a second)
+ * @return true once every device is done or failed
+ */
+bool cluster_autotune_coord_tick(autotune_coord_t *coord, uint32_t now_ms);
+
+/**
+ * @brief End the run early: each device gets its best point that fits
+ */
+void cluster_autotune_coord_finish_all(autotune_coord_t *coord);
+
+/**
+ * @brief Draw the cluster is committed to (measured, or predicted for points under test)
+ */
+float cluster_autotune_coord_committed(const autotune_coord_t *coord);
+
+/**
+ * @brief Predicted draw of a node at a point, from its last measured point
+ */
+float cluster_autotune_coord_predict(const autotune_node_t *node, uint16_t freq_mhz,
+                                     uint16_t voltage_mv);
+
+/**
+ * @brief Mode score of a measured point, higher is better
+ */
+float cluster_autotune_score(autotune_mode_t mode, float hashrate_gh, float power_w);
+
+/**
+ * @brief Node state name for logs and the API
+ */
+const char *cluster_autotune_node_state_name(autotune_node_state_t state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLUSTER_AUTOTUNE_COORD_H
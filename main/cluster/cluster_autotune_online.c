@@ -0,0 +1,384 @@
+/**
+ * @file cluster_autotune_online.c
+ * @brief ClusterAxe online efficiency optimizer (perturb and observe)
+ *
+ * See cluster_autotune_online.h for the flow; cluster_autotune.c feeds it
+ * the board's readings after autotune locks.
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#include "cluster_autotune_online.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "autotune_online";
+
+static const char *s_state_names[] = {
+    [AUTOTUNE_ONLINE_BASELINE]  = "baseline",
+    [AUTOTUNE_ONLINE_PROBE]     = "probe",
+    [AUTOTUNE_ONLINE_REFERENCE] = "reference",
+    [AUTOTUNE_ONLINE_HOLD]      = "hold",
+};
+
+const char *cluster_autotune_online_state_name(autotune_online_state_t state)
+{
+    return state <= AUTOTUNE_ONLINE_HOLD ? s_state_names[state] : "unknown";
+}
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static void start_phase(autotune_online_t *o, autotune_online_state_t state, uint32_t now_ms)
+{
+    o->state = state;
+    o->phase_start_ms = now_ms;
+    memset(&o->window, 0, sizeof(o->window));
+}
+
+// Keep measuring where we are, without settling again
+static void continue_baseline(autotune_online_t *o, uint32_t now_ms)
+{
+    start_phase(o, AUTOTUNE_ONLINE_BASELINE, now_ms - o->config.settle_ms);
+}
+
+static bool apply(autotune_online_t *o, uint16_t freq, uint16_t voltage, uint32_t now_ms)
+{
+    if (o->ops.apply(freq, voltage, o->ops.ctx) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to apply %d MHz, %d mV", freq, voltage);
+        return false;
+    }
+    o->last_change_ms = now_ms;
+    o->changed = true;
+    return true;
+}
+
+static bool can_change(const autotune_online_t *o, uint32_t now_ms)
+{
+    return !o->changed || now_ms - o->last_change_ms >= o->config.min_change_ms;
+}
+
+// Inside the box around the lock point and the mode's limits
+static bool in_bounds(const autotune_online_t *o, int freq, int voltage)
+{
+    const autotune_online_config_t *cfg = &o->config;
+    return freq >= cfg->freq_min && freq <= cfg->freq_max &&
+           voltage >= cfg->voltage_min && voltage <= cfg->voltage_max &&
+           freq >= o->lock_freq - cfg->max_freq_dev_mhz && freq <= o->lock_freq + cfg->max_freq_dev_mhz &&
+           voltage >= o->lock_voltage - cfg->max_voltage_dev_mv &&
+           voltage <= o->lock_voltage + cfg->max_voltage_dev_mv;
+}
+
+static void expected_settings(const autotune_online_t *o, uint16_t *freq, uint16_t *voltage)
+{
+    bool away = o->state == AUTOTUNE_ONLINE_PROBE || o->state == AUTOTUNE_ONLINE_REFERENCE;
+    *freq = away ? o->probe_freq : o->freq_mhz;
+    *voltage = away ? o->probe_voltage : o->voltage_mv;
+}
+
+static float window_jth(const autotune_online_window_t *w)
+{
+    float hashrate = w->sum_hashrate / w->samples;
+    return hashrate > 0 ? (w->sum_power / w->samples) * 1000.0f / hashrate : 0;
+}
+
+static float window_score(const autotune_online_t *o)
+{
+    return cluster_autotune_score(o->config.mode, o->window.sum_hashrate / o->window.samples,
+                                  o->window.sum_power / o->window.samples);
+}
+
+static float window_error(const autotune_online_window_t *w)
+{
+    return w->samples ? w->sum_error / w->samples : 0;
+}
+
+/**
+ * @brief Probe rejected: try the other direction, then the other axis
+ */
+static void next_direction(autotune_online_t *o)
+{
+    o->direction = -o->direction;
+    if (++o->failures >= 2) {
+        o->axis ^= 1;
+        o->failures = 0;
+    }
+}
+
+static void revert(autotune_online_t *o, uint32_t now_ms)
+{
+    apply(o, o->freq_mhz, o->voltage_mv, now_ms);
+}
+
+// ============================================================================
+// Phases
+// ============================================================================
+
+/**
+ * @brief Move to a neighbour, or to the lock point when a reference is due
+ */
+static void start_probe(autotune_online_t *o, uint32_t now_ms)
+{
+    const autotune_online_config_t *cfg = &o->config;
+
+    if (cfg->reference_every && o->probes_since_reference >= cfg->reference_every) {
+        o->probes_since_reference = 0;
+        if (o->freq_mhz != o->lock_freq || o->voltage_mv != o->lock_voltage) {
+            if (apply(o, o->lock_freq, o->lock_voltage, now_ms)) {
+                o->probe_freq = o->lock_freq;
+                o->probe_voltage = o->lock_voltage;
+                start_phase(o, AUTOTUNE_ONLINE_REFERENCE, now_ms);
+                return;
+            }
+        }
+    }
+
+    // Every axis and direction, until one stays in bounds
+    for (int tries = 0; tries < 4; tries++) {
+        int freq = o->freq_mhz;
+        int voltage = o->voltage_mv;
+        if (o->axis == 0) {
+            freq += o->direction * cfg->freq_step_mhz;
+        } else {
+            voltage += o->direction * cfg->voltage_step_mv;
+        }
+        if (!in_bounds(o, freq, voltage)) {
+            next_direction(o);
+            continue;
+        }
+        if (!apply(o, freq, voltage, now_ms)) {
+            break;
+        }
+        o->probe_freq = freq;
+        o->probe_voltage = voltage;
+        o->probes++;
+        o->probes_since_reference++;
+        start_phase(o, AUTOTUNE_ONLINE_PROBE, now_ms);
+        return;
+    }
+    continue_baseline(o, now_ms);
+}
+
+/**
+ * @brief Move the kept point itself, when it no longer holds
+ */
+static void move_kept(autotune_online_t *o, int freq, int voltage, const char *why, uint32_t now_ms)
+{
+    if (!in_bounds(o, freq, voltage)) {
+        ESP_LOGW(TAG, "%s at %d MHz, %d mV and no room to back off", why, o->freq_mhz, o->voltage_mv);
+        return;
+    }
+    ESP_LOGW(TAG, "%s at %d MHz, %d mV - moving to %d MHz, %d mV", why, o->freq_mhz, o->voltage_mv,
+             freq, voltage);
+    if (apply(o, freq, voltage, now_ms)) {
+        o->freq_mhz = freq;
+        o->voltage_mv = voltage;
+        o->have_baseline = false;
+    }
+}
+
+/**
+ * @brief The kept point errors too much (it got warmer): give it voltage, else less frequency
+ */
+static void recover(autotune_online_t *o, uint32_t now_ms)
+{
+    const autotune_online_config_t *cfg = &o->config;
+    if (in_bounds(o, o->freq_mhz, o->voltage_mv + cfg->voltage_step_mv)) {
+        move_kept(o, o->freq_mhz, o->voltage_mv + cfg->voltage_step_mv, "Errors", now_ms);
+    } else {
+        move_kept(o, o->freq_mhz - cfg->freq_step_mhz, o->voltage_mv, "Errors", now_ms);
+    }
+    start_phase(o, AUTOTUNE_ONLINE_BASELINE, now_ms);
+}
+
+/**
+ * @brief The kept point runs over a limit: draw less, frequency first
+ */
+static void back_off(autotune_online_t *o, uint32_t now_ms)
+{
+    const autotune_online_config_t *cfg = &o->config;
+    if (in_bounds(o, o->freq_mhz - cfg->freq_step_mhz, o->voltage_mv)) {
+        move_kept(o, o->freq_mhz - cfg->freq_step_mhz, o->voltage_mv, "Limit", now_ms);
+    } else {
+        move_kept(o, o->freq_mhz, o->voltage_mv - cfg->voltage_step_mv, "Limit", now_ms);
+    }
+}
+
+static void end_baseline(autotune_online_t *o, uint32_t now_ms)
+{
+    if (o->config.error_max_pct > 0 && window_error(&o->window) > o->config.error_max_pct) {
+        recover(o, now_ms);
+        return;
+    }
+    o->baseline_score = window_score(o);
+    o->baseline_jth = window_jth(&o->window);
+    o->have_baseline = true;
+
+    if (can_change(o, now_ms)) {
+        start_probe(o, now_ms);
+    } else {
+        continue_baseline(o, now_ms);
+    }
+}
+
+static void end_probe(autotune_online_t *o, uint32_t now_ms)
+{
+    float score = window_score(o);
+    float margin = o->config.hysteresis * (o->baseline_score < 0 ? -o->baseline_score : o->baseline_score);
+
+    if (score > o->baseline_score + margin) {
+        ESP_LOGI(TAG, "Kept %d MHz, %d mV: %.2f J/TH (was %.2f at %d MHz, %d mV)",
+                 o->probe_freq, o->probe_voltage, window_jth(&o->window), o->baseline_jth,
+                 o->freq_mhz, o->voltage_mv);
+        o->freq_mhz = o->probe_freq;
+        o->voltage_mv = o->probe_voltage;
+        o->baseline_score = score;
+        o->baseline_jth = window_jth(&o->window);
+        o->failures = 0;
+        o->kept++;
+        // Same direction again once the change rate allows
+        if (can_change(o, now_ms)) {
+            start_probe(o, now_ms);
+        } else {
+            continue_baseline(o, now_ms);
+        }
+        return;
+    }
+
+    ESP_LOGD(TAG, "Reverted %d MHz, %d mV: %.2f J/TH vs %.2f", o->probe_freq, o->probe_voltage,
+             window_jth(&o->window), o->baseline_jth);
+    o->reverted++;
+    next_direction(o);
+    revert(o, now_ms);
+    start_phase(o, AUTOTUNE_ONLINE_BASELINE, now_ms);
+}
+
+static void end_reference(autotune_online_t *o, uint32_t now_ms)
+{
+    o->reference_jth = window_jth(&o->window);
+    o->current_jth = o->baseline_jth;
+    if (o->reference_jth > 0 && o->current_jth > 0) {
+        o->gain_pct = (o->reference_jth - o->current_jth) * 100.0f / o->reference_jth;
+        o->have_gain = true;
+        ESP_LOGI(TAG, "%d MHz, %d mV: %.2f J/TH vs %.2f J/TH at the lock point (%d MHz, %d mV): %+.1f%%",
+                 o->freq_mhz, o->voltage_mv, o->current_jth, o->reference_jth,
+                 o->lock_freq, o->lock_voltage, o->gain_pct);
+    }
+    revert(o, now_ms);
+    start_phase(o, AUTOTUNE_ONLINE_BASELINE, now_ms);
+}
+
+// ============================================================================
+// API
+// ============================================================================
+
+void cluster_autotune_online_init(autotune_online_t *online, const autotune_online_config_t *config,
+                                  const autotune_online_ops_t *ops, uint16_t lock_freq,
+                                  uint16_t lock_voltage, uint32_t now_ms)
+{
+    memset(online, 0, sizeof(*online));
+    online->config = *config;
+    online->ops = *ops;
+    online->lock_freq = lock_freq;
+    online->lock_voltage = lock_voltage;
+    online->freq_mhz = lock_freq;
+    online->voltage_mv = lock_voltage;
+    online->axis = 1;               // Voltage first: the cheapest win after a coarse grid
+    online->direction = -1;
+    start_phase(online, AUTOTUNE_ONLINE_BASELINE, now_ms);
+}
+
+void cluster_autotune_online_tick(autotune_online_t *o, const autotune_sample_t *sample,
+                                  uint16_t freq_mhz, uint16_t voltage_mv, uint32_t now_ms)
+{
+    const autotune_online_config_t *cfg = &o->config;
+
+    // Someone else (the watchdog) changed the settings: start over from them
+    uint16_t expect_freq, expect_voltage;
+    expected_settings(o, &expect_freq, &expect_voltage);
+    if (freq_mhz != expect_freq || voltage_mv != expect_voltage) {
+        ESP_LOGW(TAG, "Settings changed to %d MHz, %d mV outside the optimizer - holding",
+                 freq_mhz, voltage_mv);
+        o->freq_mhz = freq_mhz;
+        o->voltage_mv = voltage_mv;
+        o->have_baseline = false;
+        o->rebases++;
+        start_phase(o, AUTOTUNE_ONLINE_HOLD, now_ms);
+        return;
+    }
+
+    if (o->state == AUTOTUNE_ONLINE_HOLD) {
+        if (now_ms - o->phase_start_ms >= cfg->hold_ms) {
+            start_phase(o, AUTOTUNE_ONLINE_BASELINE, now_ms);
+        }
+        return;
+    }
+
+    if (!sample) {
+        return;
+    }
+
+    // Safety limits: back to the kept point at once
+    if (sample->temp_c > cfg->temp_max_c || (sample->vin > 0 && sample->vin < cfg->vin_min)) {
+        ESP_LOGW(TAG, "%.1f°C, %.2f V in at %d MHz, %d mV - backing off", sample->temp_c,
+                 sample->vin, expect_freq, expect_voltage);
+        o->breaches++;
+        if (o->state == AUTOTUNE_ONLINE_PROBE) {
+            next_direction(o);
+        }
+        if (o->state == AUTOTUNE_ONLINE_BASELINE) {
+            back_off(o, now_ms);
+        } else {
+            revert(o, now_ms);
+        }
+        start_phase(o, AUTOTUNE_ONLINE_HOLD, now_ms);
+        return;
+    }
+
+    uint32_t elapsed = now_ms - o->phase_start_ms;
+    if (elapsed < cfg->settle_ms) {
+        return;
+    }
+    o->window.sum_hashrate += sample->hashrate_gh;
+    o->window.sum_power += sample->power_w;
+    o->window.sum_error += sample->error_pct;
+    o->window.samples++;
+
+    // Probes that error are reverted without waiting for the window
+    if (o->state == AUTOTUNE_ONLINE_PROBE && cfg->error_max_pct > 0 &&
+        o->window.samples >= AUTOTUNE_ONLINE_ERROR_SAMPLES &&
+        window_error(&o->window) > cfg->error_max_pct) {
+        ESP_LOGI(TAG, "%d MHz, %d mV unstable (%.2f%% errors) - reverted", o->probe_freq,
+                 o->probe_voltage, window_error(&o->window));
+        o->unstable++;
+        next_direction(o);
+        revert(o, now_ms);
+        start_phase(o, AUTOTUNE_ONLINE_BASELINE, now_ms);
+        return;
+    }
+
+    if (elapsed < cfg->settle_ms + cfg->window_ms || o->window.samples == 0) {
+        return;
+    }
+
+    switch (o->state) {
+        case AUTOTUNE_ONLINE_BASELINE:
+            end_baseline(o, now_ms);
+            break;
+        case AUTOTUNE_ONLINE_PROBE:
+            if (!o->have_baseline) {
+                revert(o, now_ms);
+                start_phase(o, AUTOTUNE_ONLINE_BASELINE, now_ms);
+                break;
+            }
+            end_probe(o, now_ms);
+            break;
+        case AUTOTUNE_ONLINE_REFERENCE:
+            end_reference(o, now_ms);
+            break;
+        case AUTOTUNE_ONLINE_HOLD:
+            break;
+    }
+}
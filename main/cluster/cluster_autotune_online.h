@@ -0,0 +1,160 @@
+/**
+ * @file cluster_autotune_online.h
+ * @brief ClusterAxe online efficiency optimizer (perturb and observe)
+ *
+ * After autotune locks, the best point drifts with ambient temperature: a
+ * cool night lowers the voltage the chip needs, a hot day raises it and
+ * the leakage. The optimizer keeps walking towards the best point around
+ * the lock with small, bounded steps:
+ *
+ *   BASELINE -> PROBE -> (keep | revert) -> BASELINE -> ...
+ *
+ * Each phase settles, then averages the board's readings over a window. A
+ * probe moves one axis (frequency or voltage) by one step. It is kept if
+ * its window scores better than the baseline's by the hysteresis, else
+ * reverted; the next probe goes the other way, and after both ways fail
+ * the other axis. Probes never leave the box of max_*_dev around the lock
+ * point or the mode's limits, and at most one change is made per
+ * min_change_ms.
+ *
+ * A reading over the temperature or under the input voltage limit reverts
+ * the probe at once, or steps the kept point down if it was measuring that,
+ * and holds for hold_ms; a window error rate over error_max_pct reverts a
+ * probe as unstable, or gives the kept point more voltage. If the settings
+ * change under it (the safety watchdog), the optimizer starts again from
+ * them.
+ *
+ * Every reference_every probes it measures the lock point itself, so the
+ * efficiency gained over the static lock is measured under the same
+ * conditions, and logs it.
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#ifndef CLUSTER_AUTOTUNE_ONLINE_H
+#define CLUSTER_AUTOTUNE_ONLINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "cluster_autotune.h"
+#include "cluster_autotune_coord.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUTOTUNE_ONLINE_ERROR_SAMPLES   3           // Before a window's error rate is judged
+
+typedef struct {
+    autotune_mode_t mode;               // Score to climb
+    uint16_t        freq_step_mhz;
+    uint16_t        voltage_step_mv;
+    uint16_t        max_freq_dev_mhz;   // From the lock point
+    uint16_t        max_voltage_dev_mv;
+    uint16_t        freq_min;           // Absolute limits (mode)
+    uint16_t        freq_max;
+    uint16_t        voltage_min;
+    uint16_t        voltage_max;
+    uint32_t        settle_ms;          // After a change, before the window
+    uint32_t        window_ms;          // Averaging window
+    uint32_t        min_change_ms;      // Between setting changes (not safety reverts)
+    uint32_t        hold_ms;            // After a limit breach
+    uint8_t         reference_every;    // Probes between lock point references, 0 = never
+    float           hysteresis;         // Score gain a probe needs to be kept (fraction)
+    float           temp_max_c;
+    float           vin_min;
+    float           error_max_pct;
+} autotune_online_config_t;
+
+typedef struct {
+    /** Apply settings to the board */
+    esp_err_t (*apply)(uint16_t freq_mhz, uint16_t voltage_mv, void *ctx);
+    void *ctx;
+} autotune_online_ops_t;
+
+typedef enum {
+    AUTOTUNE_ONLINE_BASELINE = 0,       // Measuring the current point
+    AUTOTUNE_ONLINE_PROBE,              // Measuring a neighbour
+    AUTOTUNE_ONLINE_REFERENCE,          // Measuring the lock point
+    AUTOTUNE_ONLINE_HOLD                // Backing off after a limit breach
+} autotune_online_state_t;
+
+/**
+ * @brief Window average
+ */
+typedef struct {
+    float   sum_hashrate;
+    float   sum_power;
+    float   sum_error;
+    uint16_t samples;
+} autotune_online_window_t;
+
+typedef struct {
+    autotune_online_config_t config;
+    autotune_online_ops_t   ops;
+    autotune_online_state_t state;
+
+    uint16_t    lock_freq;              // Point autotune locked
+    uint16_t    lock_voltage;
+    uint16_t    freq_mhz;               // Current (kept) point
+    uint16_t    voltage_mv;
+    uint16_t    probe_freq;             // Applied during a probe or reference
+    uint16_t    probe_voltage;
+
+    uint8_t     axis;                   // 0 = frequency, 1 = voltage
+    int8_t      direction;              // +1 / -1
+    uint8_t     failures;               // Consecutive rejected probes on the axis
+
+    uint32_t    phase_start_ms;
+    uint32_t    last_change_ms;
+    bool        changed;                // At least one change made
+    autotune_online_window_t window;
+
+    float       baseline_score;
+    float       baseline_jth;
+    bool        have_baseline;
+
+    // Counters
+    uint32_t    probes;
+    uint32_t    kept;
+    uint32_t    reverted;               // Scored worse
+    uint32_t    unstable;               // Error rate over the limit
+    uint32_t    breaches;               // Temperature or input voltage
+    uint32_t    rebases;                // Settings changed under it
+    uint8_t     probes_since_reference;
+
+    // Efficiency against the lock point, from the last reference
+    float       reference_jth;          // Lock point
+    float       current_jth;            // Current point, measured just before it
+    float       gain_pct;               // J/TH saved over the lock, %
+    bool        have_gain;
+} autotune_online_t;
+
+/**
+ * @brief Start from the locked point (already applied)
+ */
+void cluster_autotune_online_init(autotune_online_t *online, const autotune_online_config_t *config,
+                                  const autotune_online_ops_t *ops, uint16_t lock_freq,
+                                  uint16_t lock_voltage, uint32_t now_ms);
+
+/**
+ * @brief Advance with the newest reading
+ * @param sample Reading, or NULL if none since the last call
+ * @param freq_mhz Settings the board runs now (to notice outside changes)
+ * @param voltage_mv
+ */
+void cluster_autotune_online_tick(autotune_online_t *online, const autotune_sample_t *sample,
+                                  uint16_t freq_mhz, uint16_t voltage_mv, uint32_t now_ms);
+
+/**
+ * @brief State name for logs and the API
+ */
+const char *cluster_autotune_online_state_name(autotune_online_state_t state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLUSTER_AUTOTUNE_ONLINE_H
@@ -0,0 +1,311 @@
+/**
+ * @file cluster_autotune_search.c
+ * @brief ClusterAxe autotune search strategies
+ *
+ * See cluster_autotune_search.h for the strategies and what they assume
+ * about the chip.
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#include "cluster_autotune_search.h"
+#include <string.h>
+
+// Climb only counts a gain above measurement noise
+#define CLIMB_MIN_GAIN      0.002f
+// Steps up in frequency it takes without a gain, to get past a voltage step
+#define CLIMB_PATIENCE      2
+
+static const autotune_search_ops_t *const s_searches[] = {
+    &autotune_search_grid,
+    &autotune_search_bisect,
+    &autotune_search_climb,
+};
+
+#define SEARCH_COUNT    (sizeof(s_searches) / sizeof(s_searches[0]))
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static int point_index(const autotune_search_t *s, int f, int v)
+{
+    return f * s->grid.voltage_count + v;
+}
+
+static bool in_grid(const autotune_search_t *s, int f, int v)
+{
+    return f >= 0 && f < s->grid.freq_count && v >= 0 && v < s->grid.voltage_count &&
+           point_index(s, f, v) < AUTOTUNE_SEARCH_MAX_POINTS;
+}
+
+static bool is_tested(const autotune_search_t *s, int f, int v)
+{
+    int p = point_index(s, f, v);
+    return s->tested[p / 8] & (1u << (p % 8));
+}
+
+static void mark(autotune_search_t *s, int f, int v)
+{
+    if (in_grid(s, f, v)) {
+        int p = point_index(s, f, v);
+        s->tested[p / 8] |= 1u << (p % 8);
+    }
+}
+
+/**
+ * @brief Mark a point tested, and the points its outcome rules out
+ */
+static void rule_out(autotune_search_t *s, int f, int v, autotune_point_outcome_t outcome)
+{
+    mark(s, f, v);
+    for (int ff = f; ff < s->grid.freq_count; ff++) {
+        if (outcome == AUTOTUNE_POINT_UNSTABLE) {
+            for (int vv = 0; vv <= v; vv++) {
+                mark(s, ff, vv);
+            }
+        } else if (outcome == AUTOTUNE_POINT_LIMIT) {
+            for (int vv = v; vv < s->grid.voltage_count; vv++) {
+                mark(s, ff, vv);
+            }
+        }
+    }
+}
+
+void cluster_autotune_search_init(autotune_search_t *search, const autotune_search_ops_t *ops,
+                                  const autotune_search_grid_t *grid)
+{
+    memset(search, 0, sizeof(*search));
+    search->ops = ops;
+    search->grid = *grid;
+    ops->begin(search);
+}
+
+const autotune_search_ops_t *cluster_autotune_search_find(autotune_search_type_t type)
+{
+    for (size_t i = 0; i < SEARCH_COUNT; i++) {
+        if (s_searches[i]->type == type) {
+            return s_searches[i];
+        }
+    }
+    return NULL;
+}
+
+const autotune_search_ops_t *cluster_autotune_search_from_name(const char *name)
+{
+    for (size_t i = 0; name && i < SEARCH_COUNT; i++) {
+        if (strcmp(s_searches[i]->name, name) == 0) {
+            return s_searches[i];
+        }
+    }
+    return NULL;
+}
+
+// ============================================================================
+// Grid
+// ============================================================================
+
+static void grid_begin(autotune_search_t *s)
+{
+    s->u.grid.next = 0;
+}
+
+static bool grid_next(autotune_search_t *s, uint8_t *freq_idx, uint8_t *voltage_idx)
+{
+    int f = s->u.grid.next / s->grid.voltage_count;
+    int v = s->u.grid.next % s->grid.voltage_count;
+    if (!in_grid(s, f, v)) {
+        return false;
+    }
+    *freq_idx = f;
+    *voltage_idx = v;
+    return true;
+}
+
+static void grid_report(autotune_search_t *s, uint8_t freq_idx, uint8_t voltage_idx,
+                        autotune_point_outcome_t outcome, float score)
+{
+    mark(s, freq_idx, voltage_idx);
+    s->u.grid.next++;
+}
+
+static uint16_t grid_estimate(const autotune_search_grid_t *grid)
+{
+    int size = grid->freq_count * grid->voltage_count;
+    return size > AUTOTUNE_SEARCH_MAX_POINTS ? AUTOTUNE_SEARCH_MAX_POINTS : size;
+}
+
+const autotune_search_ops_t autotune_search_grid = {
+    .type = AUTOTUNE_SEARCH_GRID,
+    .name = "grid",
+    .begin = grid_begin,
+    .next = grid_next,
+    .report = grid_report,
+    .estimate = grid_estimate,
+};
+
+// ============================================================================
+// Bisect: lowest stable voltage per frequency
+// ============================================================================
+
+static void bisect_begin(autotune_search_t *s)
+{
+    s->u.bisect.freq_idx = 0;
+    s->u.bisect.lo = 0;
+    s->u.bisect.hi = s->grid.voltage_count - 1;
+    s->u.bisect.found = -1;
+    s->u.bisect.cap = s->grid.voltage_count - 1;
+}
+
+static bool bisect_next(autotune_search_t *s, uint8_t *freq_idx, uint8_t *voltage_idx)
+{
+    while (s->u.bisect.freq_idx < s->grid.freq_count) {
+        if (s->u.bisect.lo <= s->u.bisect.hi) {
+            int mid = (s->u.bisect.lo + s->u.bisect.hi) / 2;
+            if (!in_grid(s, s->u.bisect.freq_idx, mid)) {
+                return false;
+            }
+            *freq_idx = s->u.bisect.freq_idx;
+            *voltage_idx = mid;
+            return true;
+        }
+
+        // This frequency is settled. None stable: higher ones won't be either
+        if (s->u.bisect.found < 0) {
+            return false;
+        }
+        // The next frequency needs at least this voltage
+        s->u.bisect.freq_idx++;
+        s->u.bisect.lo = s->u.bisect.found;
+        s->u.bisect.hi = s->u.bisect.cap;
+        s->u.bisect.found = -1;
+    }
+    return false;
+}
+
+static void bisect_report(autotune_search_t *s, uint8_t freq_idx, uint8_t voltage_idx,
+                          autotune_point_outcome_t outcome, float score)
+{
+    rule_out(s, freq_idx, voltage_idx, outcome);
+    if (freq_idx != s->u.bisect.freq_idx) {
+        return;
+    }
+
+    switch (outcome) {
+        case AUTOTUNE_POINT_OK:
+            s->u.bisect.found = voltage_idx;
+            s->u.bisect.hi = voltage_idx - 1;
+            break;
+        case AUTOTUNE_POINT_LIMIT:
+            // Higher voltage here, and this voltage at higher frequencies, only get worse
+            s->u.bisect.hi = voltage_idx - 1;
+            s->u.bisect.cap = voltage_idx - 1;
+            break;
+        case AUTOTUNE_POINT_UNSTABLE:
+        case AUTOTUNE_POINT_FAILED:
+        default:
+            s->u.bisect.lo = voltage_idx + 1;
+            break;
+    }
+}
+
+static uint16_t bisect_estimate(const autotune_search_grid_t *grid)
+{
+    int probes = 0;
+    while ((1 << probes) <= grid->voltage_count) {
+        probes++;
+    }
+    return grid->freq_count * probes;
+}
+
+const autotune_search_ops_t autotune_search_bisect = {
+    .type = AUTOTUNE_SEARCH_BISECT,
+    .name = "bisect",
+    .begin = bisect_begin,
+    .next = bisect_next,
+    .report = bisect_report,
+    .estimate = bisect_estimate,
+};
+
+// ============================================================================
+// Climb: first-improvement hill climb on the mode's score
+// ============================================================================
+//
+// A frequency step that needs the next voltage step often scores worse than
+// the point below it even though the frequencies above score better, so
+// the climb keeps going up for CLIMB_PATIENCE steps without a gain.
+
+// Up in frequency first (with the voltage it may need), then cheaper points
+static const int8_t CLIMB_MOVES[][2] = {
+    {+1, 0}, {+1, +1}, {+1, +2}, {0, -1}, {-1, 0}, {0, +1},
+};
+
+static void climb_begin(autotune_search_t *s)
+{
+    s->u.climb.have_best = false;
+}
+
+static bool climb_next(autotune_search_t *s, uint8_t *freq_idx, uint8_t *voltage_idx)
+{
+    if (!s->u.climb.have_best) {
+        // Lowest point not ruled out yet: the lowest stable voltage at the lowest frequency
+        for (int f = 0; f < s->grid.freq_count; f++) {
+            for (int v = 0; v < s->grid.voltage_count; v++) {
+                if (in_grid(s, f, v) && !is_tested(s, f, v)) {
+                    *freq_idx = f;
+                    *voltage_idx = v;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    for (size_t m = 0; m < sizeof(CLIMB_MOVES) / sizeof(CLIMB_MOVES[0]); m++) {
+        int f = s->u.climb.freq_idx + CLIMB_MOVES[m][0];
+        int v = s->u.climb.voltage_idx + CLIMB_MOVES[m][1];
+        if (in_grid(s, f, v) && !is_tested(s, f, v)) {
+            *freq_idx = f;
+            *voltage_idx = v;
+            return true;
+        }
+    }
+    return false;   // Local optimum
+}
+
+static void climb_report(autotune_search_t *s, uint8_t freq_idx, uint8_t voltage_idx,
+                         autotune_point_outcome_t outcome, float score)
+{
+    rule_out(s, freq_idx, voltage_idx, outcome);
+    if (outcome != AUTOTUNE_POINT_OK) {
+        return;
+    }
+
+    float margin = CLIMB_MIN_GAIN * (s->u.climb.score < 0 ? -s->u.climb.score : s->u.climb.score);
+    if (!s->u.climb.have_best || score > s->u.climb.score + margin) {
+        s->u.climb.freq_idx = freq_idx;
+        s->u.climb.voltage_idx = voltage_idx;
+        s->u.climb.score = score;
+        s->u.climb.have_best = true;
+        s->u.climb.stalled = 0;
+    } else if (freq_idx > s->u.climb.freq_idx && s->u.climb.stalled < CLIMB_PATIENCE) {
+        s->u.climb.freq_idx = freq_idx;
+        s->u.climb.voltage_idx = voltage_idx;
+        s->u.climb.stalled++;
+    }
+}
+
+static uint16_t climb_estimate(const autotune_search_grid_t *grid)
+{
+    return grid->freq_count + grid->voltage_count;
+}
+
+const autotune_search_ops_t autotune_search_climb = {
+    .type = AUTOTUNE_SEARCH_CLIMB,
+    .name = "climb",
+    .begin = climb_begin,
+    .next = climb_next,
+    .report = climb_report,
+    .estimate = climb_estimate,
+};
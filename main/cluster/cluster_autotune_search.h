@@ -0,0 +1,144 @@
+/**
+ * @file cluster_autotune_search.h
+ * @brief ClusterAxe autotune search strategies
+ *
+ * A strategy decides which frequency x voltage point a device tests next,
+ * from the outcomes of the points it already tested. The coordinator
+ * (cluster_autotune_coord.c) owns measuring, limits and the power budget
+ * and only asks the strategy for points:
+ *
+ *   grid    every point of the mode, lowest frequency first (exhaustive)
+ *   bisect  lowest stable voltage per frequency by bisection, frequencies
+ *           in ascending order; stops at the first frequency with none
+ *   climb   hill climb on the mode's score from the lowest point, moving
+ *           to the first neighbour that improves it (and a couple of steps
+ *           up in frequency that don't, to get past voltage steps)
+ *
+ * Stability is monotonic in voltage and limits are monotonic in both axes,
+ * which bisect and climb rely on: an unstable point makes every lower
+ * voltage at that or a higher frequency unstable, and a point over the
+ * temperature / input voltage / power limits puts every higher point over
+ * them too.
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#ifndef CLUSTER_AUTOTUNE_SEARCH_H
+#define CLUSTER_AUTOTUNE_SEARCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cluster_autotune.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUTOTUNE_SEARCH_MAX_POINTS      80          // Largest frequency x voltage grid
+
+typedef enum {
+    AUTOTUNE_SEARCH_GRID = 0,
+    AUTOTUNE_SEARCH_BISECT,
+    AUTOTUNE_SEARCH_CLIMB,
+    AUTOTUNE_SEARCH_COUNT
+} autotune_search_type_t;
+
+/**
+ * @brief How a tested point ended
+ */
+typedef enum {
+    AUTOTUNE_POINT_OK = 0,          // Measured; score is valid
+    AUTOTUNE_POINT_UNSTABLE,        // Error rate over the limit
+    AUTOTUNE_POINT_LIMIT,           // Temperature, input voltage or power budget
+    AUTOTUNE_POINT_FAILED           // Not applied or no telemetry; says nothing about the chip
+} autotune_point_outcome_t;
+
+/**
+ * @brief The points a device may test, already cut to the mode's limits
+ *
+ * Both tables ascend. Points are addressed by (frequency index, voltage index).
+ */
+typedef struct {
+    autotune_mode_t mode;
+    const uint16_t  *freq_steps;
+    uint8_t         freq_count;
+    const uint16_t  *voltage_steps;
+    uint8_t         voltage_count;
+} autotune_search_grid_t;
+
+typedef struct autotune_search autotune_search_t;
+
+/**
+ * @brief Search strategy operations
+ *
+ * next() may return the same point again until report() is called for it
+ * (the coordinator holds a point while it waits for power budget).
+ */
+typedef struct {
+    autotune_search_type_t type;
+    const char *name;
+
+    void (*begin)(autotune_search_t *search);
+    /** Next point to test; false once the search is over */
+    bool (*next)(autotune_search_t *search, uint8_t *freq_idx, uint8_t *voltage_idx);
+    void (*report)(autotune_search_t *search, uint8_t freq_idx, uint8_t voltage_idx,
+                   autotune_point_outcome_t outcome, float score);
+    /** Rough number of points it tests, for progress */
+    uint16_t (*estimate)(const autotune_search_grid_t *grid);
+} autotune_search_ops_t;
+
+extern const autotune_search_ops_t autotune_search_grid;
+extern const autotune_search_ops_t autotune_search_bisect;
+extern const autotune_search_ops_t autotune_search_climb;
+
+/**
+ * @brief Per-device search state
+ */
+struct autotune_search {
+    const autotune_search_ops_t *ops;
+    autotune_search_grid_t      grid;
+    uint8_t                     tested[AUTOTUNE_SEARCH_MAX_POINTS / 8];    // Tested or ruled out
+
+    union {
+        struct {
+            uint8_t next;
+        } grid;
+        struct {
+            uint8_t freq_idx;
+            int8_t  lo;                 // Voltage range still open at this frequency
+            int8_t  hi;
+            int8_t  found;              // Lowest stable voltage so far, -1 = none
+            int8_t  cap;                // Highest voltage within limits
+        } bisect;
+        struct {
+            uint8_t freq_idx;           // Point whose neighbours are tried
+            uint8_t voltage_idx;
+            float   score;              // Best so far
+            bool    have_best;
+            uint8_t stalled;            // Steps up taken without a gain
+        } climb;
+    } u;
+};
+
+/**
+ * @brief Start a search over a grid
+ */
+void cluster_autotune_search_init(autotune_search_t *search, const autotune_search_ops_t *ops,
+                                  const autotune_search_grid_t *grid);
+
+/**
+ * @brief Strategy by type; NULL if unknown
+ */
+const autotune_search_ops_t *cluster_autotune_search_find(autotune_search_type_t type);
+
+/**
+ * @brief Strategy by name ("grid", "bisect", "climb"); NULL if unknown
+ */
+const autotune_search_ops_t *cluster_autotune_search_from_name(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLUSTER_AUTOTUNE_SEARCH_H
@@ -0,0 +1,66 @@
+/**
+ * @file cluster_bap.c
+ * @brief BAP (UART cable) transport backend for ClusterAxe
+ *
+ * The cable is a shared bus: every send reaches every node on it, so
+ * unicast and broadcast are the same write. Received lines arrive through
+ * the BAP parser (bap_handlers.c -> cluster_on_bap_message_received()),
+ * not through this backend, and carry no MAC.
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#include "cluster_transport.h"
+#include "cluster_config.h"
+
+#if CLUSTER_ENABLED && CLUSTER_HAS_BAP
+
+#include "cluster.h"
+
+// Same port as bap_uart.c
+#define BAP_UART_NUM            2       // UART_NUM_2
+
+extern int uart_write_bytes(int uart_num, const void *src, size_t size);
+
+static esp_err_t bap_init(void)
+{
+    // The UART itself is owned and started by BAP_init()
+    return ESP_OK;
+}
+
+static void bap_deinit(void)
+{
+}
+
+static bool bap_is_ready(void)
+{
+    return true;
+}
+
+static esp_err_t bap_broadcast(const char *data, size_t len)
+{
+    int bytes_sent = uart_write_bytes(BAP_UART_NUM, data, len);
+    return (bytes_sent == (int)len) ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t bap_send(const uint8_t *dest_mac, const char *data, size_t len)
+{
+    (void)dest_mac;
+    return bap_broadcast(data, len);
+}
+
+const cluster_transport_ops_t cluster_transport_bap = {
+    .type = CLUSTER_TRANSPORT_BAP,
+    .name = "bap",
+    .max_msg_size = CLUSTER_MSG_MAX_LEN,
+    .work_sends = 1,
+    .discovery = false,
+    .init = bap_init,
+    .deinit = bap_deinit,
+    .is_ready = bap_is_ready,
+    .send = bap_send,
+    .broadcast = bap_broadcast,
+};
+
+#endif // CLUSTER_ENABLED && CLUSTER_HAS_BAP
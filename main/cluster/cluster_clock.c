@@ -0,0 +1,146 @@
+/**
+ * @file cluster_clock.c
+ * @brief Clusteraxe per-node clock offset and drift estimation
+ *
+ * See cluster_clock.h for the exchange and the filtering rules.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include "cluster_clock.h"
+#include "cluster.h"
+#include <string.h>
+
+#if CLUSTER_ENABLED
+
+void cluster_clock_reset(cluster_clock_t *clk)
+{
+    if (clk) {
+        memset(clk, 0, sizeof(*clk));
+    }
+}
+
+/**
+ * @brief Re-estimate offset (and drift, against the anchor) from the window
+ */
+static void refit(cluster_clock_t *clk)
+{
+    // Quickest exchanges first (insertion sort, the window is small)
+    uint8_t order[CLUSTER_CLOCK_SAMPLES];
+    for (int i = 0; i < clk->count; i++) {
+        int j = i;
+        while (j > 0 && clk->samples[order[j - 1]].delay_us > clk->samples[i].delay_us) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = (uint8_t)i;
+    }
+
+    // Their centroid lies on the offset line whatever the drift; relative
+    // to the newest sample so doubles keep microsecond precision
+    const cluster_clock_sample_t *newest =
+        &clk->samples[(clk->next + CLUSTER_CLOCK_SAMPLES - 1) % CLUSTER_CLOCK_SAMPLES];
+    int best = clk->count < CLUSTER_CLOCK_BEST ? clk->count : CLUSTER_CLOCK_BEST;
+    double dm = 0, doff = 0;
+    for (int i = 0; i < best; i++) {
+        const cluster_clock_sample_t *s = &clk->samples[order[i]];
+        dm += (double)(s->master_us - newest->master_us);
+        doff += (double)(s->offset_us - newest->offset_us);
+    }
+    int64_t centroid_us = newest->master_us + (int64_t)(dm / best);
+    int64_t centroid_offset = newest->offset_us + (int64_t)(doff / best);
+
+    // Drift from the offset's movement since an earlier full window
+    if (clk->count == CLUSTER_CLOCK_SAMPLES) {
+        if (!clk->anchor_valid) {
+            clk->anchor_valid = true;
+            clk->anchor_us = centroid_us;
+            clk->anchor_offset_us = centroid_offset;
+        }
+
+        int64_t span = centroid_us - clk->anchor_us;
+        if (span >= CLUSTER_CLOCK_DRIFT_MIN_SPAN_US) {
+            double ppb = (double)(centroid_offset - clk->anchor_offset_us) * 1e9 / (double)span;
+            if (ppb <= CLUSTER_CLOCK_DRIFT_MAX_PPB && ppb >= -CLUSTER_CLOCK_DRIFT_MAX_PPB) {
+                clk->drift_ppb = (int32_t)ppb;
+                clk->drift_valid = true;
+            }
+        }
+        // Follow temperature-driven changes; drift holds until the new
+        // baseline is long enough
+        if (span >= CLUSTER_CLOCK_DRIFT_MAX_SPAN_US) {
+            clk->anchor_us = centroid_us;
+            clk->anchor_offset_us = centroid_offset;
+        }
+    }
+
+    clk->ref_us = newest->master_us;
+    clk->offset_us = centroid_offset +
+                     (int64_t)((double)(clk->ref_us - centroid_us) * clk->drift_ppb / 1e9);
+    clk->delay_us = clk->samples[order[0]].delay_us;
+    clk->synced = true;
+}
+
+esp_err_t cluster_clock_add_sample(cluster_clock_t *clk, int64_t t1, int64_t t2,
+                                   int64_t t3, int64_t t4)
+{
+    if (!clk || t4 < t1 || t3 < t2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t delay = (t4 - t1) - (t3 - t2);
+    if (delay < 0 || delay > INT32_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    cluster_clock_sample_t sample = {
+        .master_us = t2 + (t3 - t2) / 2,
+        .offset_us = ((t1 - t2) + (t4 - t3)) / 2,
+        .delay_us = (int32_t)delay,
+    };
+
+    // A node that rebooted without re-registering starts its clock over;
+    // the crystal, and so the drift, stays the same
+    if (clk->synced) {
+        int64_t predicted = cluster_clock_to_node(clk, sample.master_us) - sample.master_us;
+        int64_t jump = sample.offset_us - predicted;
+        if (jump > CLUSTER_CLOCK_STEP_US || jump < -CLUSTER_CLOCK_STEP_US) {
+            int32_t drift_ppb = clk->drift_ppb;
+            bool drift_valid = clk->drift_valid;
+            cluster_clock_reset(clk);
+            clk->drift_ppb = drift_ppb;
+            clk->drift_valid = drift_valid;
+        }
+    }
+
+    clk->samples[clk->next] = sample;
+    clk->next = (clk->next + 1) % CLUSTER_CLOCK_SAMPLES;
+    if (clk->count < CLUSTER_CLOCK_SAMPLES) {
+        clk->count++;
+    }
+
+    refit(clk);
+    return ESP_OK;
+}
+
+int64_t cluster_clock_to_node(const cluster_clock_t *clk, int64_t master_us)
+{
+    if (!clk || !clk->synced) {
+        return master_us;
+    }
+    return master_us + clk->offset_us +
+           (int64_t)((double)(master_us - clk->ref_us) * clk->drift_ppb / 1e9);
+}
+
+int64_t cluster_clock_to_master(const cluster_clock_t *clk, int64_t node_us)
+{
+    if (!clk || !clk->synced) {
+        return node_us;
+    }
+    // Inverse of cluster_clock_to_node()
+    double rate = 1.0 + clk->drift_ppb / 1e9;
+    return clk->ref_us + (int64_t)((double)(node_us - clk->offset_us - clk->ref_us) / rate);
+}
+
+#endif // CLUSTER_ENABLED
@@ -0,0 +1,110 @@
+/**
+ * @file cluster_clock.h
+ * @brief Clusteraxe per-node clock offset and drift estimation
+ *
+ * Every node timestamps with its own esp_timer, which starts at boot and
+ * runs off its own crystal. To line up events from different nodes the
+ * master estimates, per slave, the offset and rate error of the slave's
+ * clock against its own with an NTP-style exchange carried on the
+ * heartbeat traffic:
+ *
+ *   t1  slave sends a heartbeat/telemetry frame     (slave clock)
+ *   t2  master receives it                          (master clock)
+ *   t3  master sends the reply echoing t1           (master clock)
+ *   t4  slave receives the reply                    (slave clock)
+ *
+ * The slave returns t1/t4 of the last completed exchange on its next
+ * frame, so the master holds all four stamps:
+ *
+ *   offset = ((t1 - t2) + (t4 - t3)) / 2    (slave clock - master clock)
+ *   delay  = (t4 - t1) - (t3 - t2)          (round trip on the air)
+ *
+ * A sample's offset is only wrong by up to half the asymmetry of its
+ * delay, so the offset is taken from the quickest few exchanges in the
+ * window. Drift is how that offset moves against an earlier window, at
+ * least a minute and at most a quarter hour back: over one window it is
+ * lost in the delay noise.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#ifndef CLUSTER_CLOCK_H
+#define CLUSTER_CLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CLUSTER_CLOCK_SAMPLES           16          // Exchanges kept per node
+#define CLUSTER_CLOCK_BEST              4           // Quickest exchanges the offset is taken from
+#define CLUSTER_CLOCK_DRIFT_MIN_SPAN_US 60000000LL  // Baseline before drift is measured
+#define CLUSTER_CLOCK_DRIFT_MAX_SPAN_US 900000000LL // Baseline after which the anchor moves up
+#define CLUSTER_CLOCK_DRIFT_MAX_PPB     1000000     // Beyond any crystal: treat as noise
+#define CLUSTER_CLOCK_STEP_US           500000      // Offset jump that means the node restarted
+
+/**
+ * @brief One completed exchange
+ */
+typedef struct {
+    int64_t     master_us;      // Master time of the exchange, (t2 + t3) / 2
+    int64_t     offset_us;      // Node clock minus master clock
+    int32_t     delay_us;       // Round trip minus master turnaround
+} cluster_clock_sample_t;
+
+/**
+ * @brief Estimate for one node
+ *
+ * node_us = master_us + offset_us + drift_ppb * (master_us - ref_us) / 1e9
+ */
+typedef struct {
+    cluster_clock_sample_t  samples[CLUSTER_CLOCK_SAMPLES];
+    uint8_t                 count;
+    uint8_t                 next;
+    bool                    synced;         // At least one sample taken
+    int64_t                 ref_us;         // Master time the offset applies at
+    int64_t                 offset_us;
+    int32_t                 drift_ppb;      // Node clock rate error, + = node runs fast
+    bool                    drift_valid;    // drift_ppb has been measured
+    int32_t                 delay_us;       // Quickest round trip in the window
+    bool                    anchor_valid;
+    int64_t                 anchor_us;      // Earlier window's offset, for drift
+    int64_t                 anchor_offset_us;
+} cluster_clock_t;
+
+/**
+ * @brief Forget everything (node re-registered)
+ */
+void cluster_clock_reset(cluster_clock_t *clk);
+
+/**
+ * @brief Add a completed exchange and refit
+ *
+ * @param t1 Node send time (node clock)
+ * @param t2 Master receive time (master clock)
+ * @param t3 Master reply time (master clock)
+ * @param t4 Node receive time (node clock)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG if the stamps are out of order
+ */
+esp_err_t cluster_clock_add_sample(cluster_clock_t *clk, int64_t t1, int64_t t2,
+                                   int64_t t3, int64_t t4);
+
+/**
+ * @brief Node timestamp -> master timestamp (unchanged until synced)
+ */
+int64_t cluster_clock_to_master(const cluster_clock_t *clk, int64_t node_us);
+
+/**
+ * @brief Master timestamp -> node timestamp (unchanged until synced)
+ */
+int64_t cluster_clock_to_node(const cluster_clock_t *clk, int64_t master_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLUSTER_CLOCK_H
@@ -75,6 +75,86 @@
     #define CONFIG_CLUSTER_TIMEOUT_MS       10000
 #endif
 
+// Time without any frame from the uplink before a slave mines on its own (ms)
+#ifndef CONFIG_CLUSTER_LINK_TIMEOUT_MS
+    #define CONFIG_CLUSTER_LINK_TIMEOUT_MS      7000
+#endif
+
+// Longest a slave keeps rolling its last work while the uplink is down (ms, 0 = never)
+#ifndef CONFIG_CLUSTER_AUTONOMOUS_MAX_MS
+    #define CONFIG_CLUSTER_AUTONOMOUS_MAX_MS    120000
+#endif
+
+// Shares a slave holds for replay while the uplink is down
+#ifndef CONFIG_CLUSTER_SHARE_REPLAY_SIZE
+    #define CONFIG_CLUSTER_SHARE_REPLAY_SIZE    32
+#endif
+
+// Telemetry frame interval once the master has acknowledged telemetry
+#ifndef CONFIG_CLUSTER_TELEMETRY_MS
+    #define CONFIG_CLUSTER_TELEMETRY_MS         1000
+#endif
+
+// Telemetry frames between forced keyframes
+#ifndef CONFIG_CLUSTER_TELEMETRY_KEYFRAME
+    #define CONFIG_CLUSTER_TELEMETRY_KEYFRAME   30
+#endif
+
+// Master share verification: 0 = off, 1 = count invalid shares, 2 = also drop them
+#ifndef CONFIG_CLUSTER_SHARE_VERIFY
+    #define CONFIG_CLUSTER_SHARE_VERIFY         2
+#endif
+
+// Job/share trace records kept per node (0 = tracing off)
+#ifndef CONFIG_CLUSTER_TRACE_SIZE
+    #define CONFIG_CLUSTER_TRACE_SIZE           256
+#endif
+
+// Cluster-wide power cap for parallel autotune, in watts (0 = no cap)
+#ifndef CONFIG_CLUSTER_AUTOTUNE_POWER_BUDGET_W
+    #define CONFIG_CLUSTER_AUTOTUNE_POWER_BUDGET_W  0
+#endif
+
+// Keep optimizing frequency/voltage around the autotune lock point (0 = off)
+#ifndef CONFIG_CLUSTER_AUTOTUNE_ONLINE
+    #define CONFIG_CLUSTER_AUTOTUNE_ONLINE      0
+#endif
+
+// Move boards to their remembered lock for the room temperature (0 = off)
+#ifndef CONFIG_CLUSTER_AUTOTUNE_PROFILES
+    #define CONFIG_CLUSTER_AUTOTUNE_PROFILES    1
+#endif
+
+// Width of a profile temperature bucket, in °C
+#ifndef CONFIG_CLUSTER_PROFILE_BUCKET_C
+    #define CONFIG_CLUSTER_PROFILE_BUCKET_C     5
+#endif
+
+// Chip-to-air thermal resistance for the ambient estimate, in 0.01 °C/W
+#ifndef CONFIG_CLUSTER_PROFILE_RTH
+    #define CONFIG_CLUSTER_PROFILE_RTH          150
+#endif
+
+// Requests the master proxies to slave web servers at once
+#ifndef CONFIG_CLUSTER_PROXY_MAX_INFLIGHT
+    #define CONFIG_CLUSTER_PROXY_MAX_INFLIGHT   4
+#endif
+
+// How long proxied slave GET responses are reused, in ms (0 = never)
+#ifndef CONFIG_CLUSTER_PROXY_CACHE_TTL_MS
+    #define CONFIG_CLUSTER_PROXY_CACHE_TTL_MS   2000
+#endif
+
+// How long a settings request to a slave is resent before giving up, in ms
+#ifndef CONFIG_CLUSTER_REMOTE_CONFIG_TIMEOUT_MS
+    #define CONFIG_CLUSTER_REMOTE_CONFIG_TIMEOUT_MS 1500
+#endif
+
+// Downstream slaves a relay can coordinate (relay builds only)
+#ifndef CONFIG_CLUSTER_RELAY_MAX_CHILDREN
+    #define CONFIG_CLUSTER_RELAY_MAX_CHILDREN   8
+#endif
+
 // ============================================================================
 // Feature Flags
 // ============================================================================
@@ -120,6 +200,14 @@
 // Helper to check if we should run the coordinator task
 #define CLUSTER_RUN_COORDINATOR     (CLUSTER_ENABLED && CLUSTER_IS_MASTER)
 
+// Slave that also acts as a sub-master for downstream slaves (ESP-NOW only)
+#if CLUSTER_IS_SLAVE && defined(CONFIG_CLUSTER_RELAY) && \
+    (defined(CONFIG_CLUSTER_TRANSPORT_ESPNOW) || defined(CONFIG_CLUSTER_TRANSPORT_BOTH))
+    #define CLUSTER_IS_RELAY        1
+#else
+    #define CLUSTER_IS_RELAY        0
+#endif
+
 // ============================================================================
 // Version Information
 // ============================================================================
@@ -130,6 +218,8 @@
 
 #if CLUSTER_IS_MASTER
     #define CLUSTERAXE_VERSION_STRING   "Clusteraxe-1.0.0-master"
+#elif CLUSTER_IS_RELAY
+    #define CLUSTERAXE_VERSION_STRING   "Clusteraxe-1.0.0-relay"
 #elif CLUSTER_IS_SLAVE
     #define CLUSTERAXE_VERSION_STRING   "Clusteraxe-1.0.0-slave"
 #else
@@ -5,11 +5,15 @@
  * Uses the native ESP-IDF ESP-NOW API for wireless communication.
  * Compatible with ESP-IDF 5.5.x
  *
+ * Frame backend only: received frames go to cluster_transport_receive(),
+ * which handles beacons, registration and dispatch for all transports.
+ *
  * @author ClusterAxe Project
  * @license GPL-3.0
  */
 
 #include "cluster_espnow.h"
+#include "cluster_transport.h"
 #include "cluster_config.h"
 
 #if CLUSTER_ENABLED && (defined(CONFIG_CLUSTER_TRANSPORT_ESPNOW) || defined(CONFIG_CLUSTER_TRANSPORT_BOTH))
@@ -19,8 +23,6 @@
 #include "esp_wifi.h"
 #include "esp_mac.h"
 #include "esp_now.h"
-#include "esp_timer.h"
-#include "esp_random.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
@@ -41,7 +43,7 @@ static const char *TAG = "cluster_espnow";
 
 typedef struct {
     uint8_t src_mac[6];
-    uint8_t data[ESPNOW_MAX_DATA_LEN];
+    char data[ESPNOW_MAX_DATA_LEN + 1];     // +1 for the terminator added on receive
     size_t len;
 } espnow_rx_event_t;
 
@@ -49,25 +51,16 @@ static struct {
     bool initialized;
     uint8_t self_mac[6];
     uint8_t channel;
-    cluster_transport_rx_cb_t rx_callback;
-    void *rx_callback_ctx;
     TaskHandle_t rx_task;
-    TaskHandle_t discovery_task;
     QueueHandle_t rx_queue;
     SemaphoreHandle_t send_sem;
     SemaphoreHandle_t send_mutex;
-    bool discovery_active;
     esp_now_send_status_t last_send_status;
-    bool registration_sent;           // Track if we've sent registration to master
-    uint8_t master_mac[6];            // MAC of the master we registered with
 } g_espnow = {0};
 
-// Broadcast MAC for discovery
+// Broadcast MAC
 static const uint8_t BROADCAST_MAC[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 
-// Discovery beacon magic header
-static const char BEACON_MAGIC[] = "CLAXE";
-
 // ============================================================================
 // Callbacks (called from WiFi task context)
 // ============================================================================
@@ -125,218 +118,10 @@ static void espnow_rx_task(void *pvParameters)
         if (xQueueReceive(g_espnow.rx_queue, &evt, portMAX_DELAY) == pdTRUE) {
             ESP_LOGD(TAG, "Received %d bytes from " MACSTR,
                      (int)evt.len, MAC2STR(evt.src_mac));
-
-            // Check if it's a discovery beacon
-            if (evt.len >= sizeof(BEACON_MAGIC) - 1 &&
-                memcmp(evt.data, BEACON_MAGIC, sizeof(BEACON_MAGIC) - 1) == 0) {
-
-                // Check if this is the same master we already registered with
-                bool same_master = (g_espnow.registration_sent &&
-                                   memcmp(g_espnow.master_mac, evt.src_mac, 6) == 0);
-
-                if (same_master) {
-                    // Already registered with this master, ignore beacon
-                    ESP_LOGD(TAG, "Ignoring beacon from known master " MACSTR, MAC2STR(evt.src_mac));
-                    continue;
-                }
-
-                // New master or first beacon - process it
-                ESP_LOGI(TAG, "Discovery beacon from " MACSTR, MAC2STR(evt.src_mac));
-
-                // Add Master as peer
-                esp_now_peer_info_t peer = {0};
-                memcpy(peer.peer_addr, evt.src_mac, 6);
-                peer.channel = g_espnow.channel;
-                peer.ifidx = WIFI_IF_STA;
-                peer.encrypt = false;
-
-                if (!esp_now_is_peer_exist(evt.src_mac)) {
-                    esp_now_add_peer(&peer);
-                    ESP_LOGI(TAG, "Added Master " MACSTR " to peers", MAC2STR(evt.src_mac));
-                }
-
-                // Send Registration Message (only once per master)
-                extern const char* cluster_get_hostname(void);
-                extern const char* cluster_get_ip_addr(void);
-
-                const char *ip_addr = cluster_get_ip_addr();
-
-                // IP is optional for ESP-NOW (direct MAC-to-MAC communication)
-                // Use "N/A" if no valid IP - it's only for display purposes
-                const char *ip_to_send = ip_addr;
-                if (!ip_addr || ip_addr[0] == '\0' || strcmp(ip_addr, "0.0.0.0") == 0) {
-                    ip_to_send = "N/A";
-                    ESP_LOGI(TAG, "No IP assigned yet - registering with IP=N/A");
-                }
-
-                char payload[64];
-                snprintf(payload, sizeof(payload), "%s,%s",
-                         cluster_get_hostname(),
-                         ip_to_send);
-
-                char msg_buf[128];
-                int msg_len = snprintf(msg_buf, sizeof(msg_buf), "$REGISTER,%s", payload);
-
-                // Calc checksum (XOR of chars between $ and *)
-                uint8_t checksum = 0;
-                for(int i = 1; i < msg_len; i++) {
-                     checksum ^= msg_buf[i];
-                }
-
-                // Append checksum
-                int final_len = snprintf(msg_buf + msg_len, sizeof(msg_buf) - msg_len, "*%02X\r\n", checksum);
-
-                // Send directly to Master MAC
-                esp_err_t send_ret = cluster_espnow_send(evt.src_mac, msg_buf, msg_len + final_len);
-                if (send_ret == ESP_OK) {
-                    // Mark registration as sent and remember master MAC
-                    g_espnow.registration_sent = true;
-                    memcpy(g_espnow.master_mac, evt.src_mac, 6);
-                    ESP_LOGI(TAG, "Sent registration to Master");
-                } else {
-                    ESP_LOGW(TAG, "Failed to send registration: %s", esp_err_to_name(send_ret));
-                }
-
-                continue;
-            }
-
-            // The data should be a null-terminated cluster message
-            char *msg = (char *)evt.data;
-            if (evt.len < ESPNOW_MAX_DATA_LEN) {
-                msg[evt.len] = '\0';  // Ensure null termination
-            }
-
-            ESP_LOGI(TAG, "Processing message: %.20s... (len=%d)", msg, (int)evt.len);
-
-            // Parse message type (format: $MSGTYPE,...)
-            if (msg[0] != '$') {
-                ESP_LOGW(TAG, "Message doesn't start with $: 0x%02X", msg[0]);
-                continue;
-            }
-
-            char *comma = strchr(msg, ',');
-            if (!comma) {
-                ESP_LOGW(TAG, "Message has no comma separator");
-                continue;
-            }
-
-            size_t type_len = comma - msg - 1;
-            char msg_type[16] = {0};
-            if (type_len >= sizeof(msg_type)) {
-                ESP_LOGW(TAG, "Message type too long: %d", (int)type_len);
-                continue;
-            }
-            strncpy(msg_type, msg + 1, type_len);
-
-#if CLUSTER_IS_MASTER
-            // Master: Update slave MAC from heartbeats (fixes stale/wrong MAC from old registration)
-            if (strcmp(msg_type, "CLHBT") == 0) {
-                const char *payload = comma + 1;
-                int slave_id = atoi(payload);
-                if (slave_id >= 0 && slave_id < 8) {
-                    extern void cluster_master_update_slave_mac(uint8_t slave_id, const uint8_t *mac);
-                    cluster_master_update_slave_mac(slave_id, evt.src_mac);
-                }
-            }
-
-            // Master: Handle REGISTER messages specially to capture MAC address
-            if (strcmp(msg_type, "REGISTER") == 0) {
-                // Parse hostname,ip from payload
-                const char *payload = comma + 1;
-                char hostname[32] = {0};
-                char ip_addr[16] = {0};
-
-                // Find next comma for IP
-                const char *ip_comma = strchr(payload, ',');
-                if (ip_comma) {
-                    size_t hostname_len = ip_comma - payload;
-                    if (hostname_len < sizeof(hostname)) {
-                        strncpy(hostname, payload, hostname_len);
-                    }
-                    // Copy IP (up to * or end)
-                    const char *ip_start = ip_comma + 1;
-                    const char *ip_end = strchr(ip_start, '*');
-                    size_t ip_len = ip_end ? (size_t)(ip_end - ip_start) : strlen(ip_start);
-                    if (ip_len < sizeof(ip_addr)) {
-                        strncpy(ip_addr, ip_start, ip_len);
-                    }
-                } else {
-                    // No IP, just hostname
-                    const char *end = strchr(payload, '*');
-                    size_t len = end ? (size_t)(end - payload) : strlen(payload);
-                    if (len < sizeof(hostname)) {
-                        strncpy(hostname, payload, len);
-                    }
-                }
-
-                ESP_LOGI(TAG, "Registration from " MACSTR ": hostname='%s', ip='%s'",
-                         MAC2STR(evt.src_mac), hostname, ip_addr);
-
-                // Call registration handler with MAC address
-                extern esp_err_t cluster_master_handle_registration_with_mac(
-                    const char *hostname, const char *ip_addr, const uint8_t *mac_addr);
-                cluster_master_handle_registration_with_mac(hostname, ip_addr, evt.src_mac);
-                continue;
-            }
-#endif
-
-            // Forward to cluster message handler
-            if (g_espnow.rx_callback) {
-                // Use LOGW for share messages to ensure visibility
-                if (strcmp(msg_type, "CLSHR") == 0) {
-                    ESP_LOGD(TAG, "SHARE: Forwarding CLSHR to callback from " MACSTR,
-                             MAC2STR(evt.src_mac));
-                } else {
-                    ESP_LOGI(TAG, "Forwarding to callback: type=%s", msg_type);
-                }
-                g_espnow.rx_callback(msg_type, comma + 1,
-                                     evt.len - (comma - msg) - 1,
-                                     evt.src_mac,
-                                     g_espnow.rx_callback_ctx);
-            } else {
-                ESP_LOGW(TAG, "No rx_callback set!");
-            }
-        }
-    }
-}
-
-// ============================================================================
-// Discovery Task (Master only)
-// ============================================================================
-
-#if CLUSTER_IS_MASTER
-static void discovery_task(void *pvParameters)
-{
-    ESP_LOGI(TAG, "Discovery task started");
-
-    // Discovery beacon payload
-    char beacon[32];
-    snprintf(beacon, sizeof(beacon), "%s,MASTER", BEACON_MAGIC);
-
-    while (g_espnow.discovery_active) {
-        // Broadcast discovery beacon
-        esp_err_t ret = esp_now_send(BROADCAST_MAC, (uint8_t *)beacon, strlen(beacon));
-
-        if (ret != ESP_OK) {
-            // Only log errors occasionally to prevent spamming logs during heavy traffic
-            static int64_t last_log = 0;
-            if (esp_timer_get_time() - last_log > 5000000) { // 5 seconds
-                ESP_LOGW(TAG, "Failed to send discovery beacon: %s", esp_err_to_name(ret));
-                last_log = esp_timer_get_time();
-            }
-        } else {
-            ESP_LOGD(TAG, "Discovery beacon sent");
+            cluster_transport_receive(&cluster_transport_espnow, evt.src_mac, evt.data, evt.len);
         }
-
-        // Add random jitter to avoid collisions and yield
-        int jitter = esp_random() % 200;
-        vTaskDelay(pdMS_TO_TICKS(CONFIG_CLUSTER_ESPNOW_DISCOVERY_INTERVAL_MS + jitter));
     }
-
-    ESP_LOGI(TAG, "Discovery task stopped");
-    vTaskDelete(NULL);
 }
-#endif
 
 // ============================================================================
 // Peer Management
@@ -479,8 +264,6 @@ void cluster_espnow_deinit(void)
         return;
     }
 
-    cluster_espnow_stop_discovery();
-
     // Delete RX task
     if (g_espnow.rx_task) {
         vTaskDelete(g_espnow.rx_task);
@@ -582,62 +365,6 @@ esp_err_t cluster_espnow_broadcast(const char *data, size_t len)
     return cluster_espnow_send(NULL, data, len);
 }
 
-void cluster_espnow_set_rx_callback(cluster_transport_rx_cb_t callback, void *ctx)
-{
-    g_espnow.rx_callback = callback;
-    g_espnow.rx_callback_ctx = ctx;
-}
-
-esp_err_t cluster_espnow_start_discovery(void)
-{
-#if CLUSTER_IS_MASTER
-    if (g_espnow.discovery_active) {
-        return ESP_OK;
-    }
-
-    g_espnow.discovery_active = true;
-
-    BaseType_t ret = xTaskCreate(discovery_task,
-                                  "espnow_disc",
-                                  8192,
-                                  NULL,
-                                  4,
-                                  &g_espnow.discovery_task);
-
-    if (ret != pdPASS) {
-        g_espnow.discovery_active = false;
-        ESP_LOGE(TAG, "Failed to create discovery task");
-        return ESP_ERR_NO_MEM;
-    }
-
-    ESP_LOGI(TAG, "Discovery started");
-    return ESP_OK;
-#else
-    ESP_LOGW(TAG, "Discovery only available on master");
-    return ESP_ERR_NOT_SUPPORTED;
-#endif
-}
-
-void cluster_espnow_stop_discovery(void)
-{
-#if CLUSTER_IS_MASTER
-    if (!g_espnow.discovery_active) {
-        return;
-    }
-
-    g_espnow.discovery_active = false;
-
-    // Task will delete itself
-    if (g_espnow.discovery_task) {
-        // Give task time to exit
-        vTaskDelay(pdMS_TO_TICKS(200));
-        g_espnow.discovery_task = NULL;
-    }
-
-    ESP_LOGI(TAG, "Discovery stopped");
-#endif
-}
-
 bool cluster_espnow_is_initialized(void)
 {
     return g_espnow.initialized;
@@ -650,28 +377,6 @@ void cluster_espnow_get_self_mac(uint8_t *mac)
     }
 }
 
-bool cluster_espnow_get_master_mac(uint8_t *mac)
-{
-    if (!mac || !g_espnow.initialized) {
-        return false;
-    }
-
-    // Check if we have a valid master MAC (not all zeros)
-    bool has_master = false;
-    for (int i = 0; i < 6; i++) {
-        if (g_espnow.master_mac[i] != 0) {
-            has_master = true;
-            break;
-        }
-    }
-
-    if (has_master) {
-        memcpy(mac, g_espnow.master_mac, 6);
-        return true;
-    }
-    return false;
-}
-
 uint8_t cluster_espnow_get_channel(void)
 {
     return g_espnow.channel;
@@ -728,24 +433,32 @@ void cluster_espnow_on_wifi_reconnect(void)
         // New peers will be added with the updated channel
     }
 
-    // Reset registration state so slave will re-register with master
-    // This handles the case where master or slave rebooted
-    cluster_espnow_reset_registration();
-
     ESP_LOGI(TAG, "ESP-NOW updated after WiFi reconnect (channel %d)", g_espnow.channel);
 }
 
-void cluster_espnow_reset_registration(void)
+static bool espnow_is_ready(void)
 {
-    if (!g_espnow.initialized) {
-        return;
-    }
+    return g_espnow.initialized;
+}
 
-    // Clear registration state
-    g_espnow.registration_sent = false;
-    memset(g_espnow.master_mac, 0, 6);
+// ============================================================================
+// Transport Backend
+// ============================================================================
 
-    ESP_LOGI(TAG, "Registration state reset - will re-register on next beacon");
-}
+const cluster_transport_ops_t cluster_transport_espnow = {
+    .type = CLUSTER_TRANSPORT_ESPNOW,
+    .name = "espnow",
+    .max_msg_size = ESPNOW_MAX_DATA_LEN,
+    .work_sends = 3,                // Broadcast has no ACK
+    .discovery = true,
+    .init = cluster_espnow_init,
+    .deinit = cluster_espnow_deinit,
+    .is_ready = espnow_is_ready,
+    .send = cluster_espnow_send,
+    .broadcast = cluster_espnow_broadcast,
+    .add_peer = cluster_espnow_add_peer,
+    .remove_peer = cluster_espnow_remove_peer,
+    .on_wifi_reconnect = cluster_espnow_on_wifi_reconnect,
+};
 
 #endif // CLUSTER_ENABLED && ESP-NOW transport
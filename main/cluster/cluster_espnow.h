@@ -5,6 +5,9 @@
  * Enables wireless cluster communication using Espressif's ESP-NOW protocol.
  * Uses native ESP-IDF ESP-NOW API for ESP-IDF 5.5.x compatibility.
  *
+ * This is the ESP-NOW frame backend (cluster_transport_espnow); discovery,
+ * registration and routing are in cluster_transport.h.
+ *
  * @author ClusterAxe Project
  * @license GPL-3.0
  */
@@ -33,24 +36,6 @@ extern "C" {
 #define CONFIG_CLUSTER_ESPNOW_DISCOVERY_INTERVAL_MS   1000
 #endif
 
-// ============================================================================
-// Transport Callback Type
-// ============================================================================
-
-/**
- * @brief Receive callback function type
- * @param msg_type Message type string
- * @param payload Message payload
- * @param len Payload length
- * @param src_mac Source MAC address (6 bytes, may be NULL for non-ESP-NOW)
- * @param ctx User context
- */
-typedef void (*cluster_transport_rx_cb_t)(const char *msg_type,
-                                          const char *payload,
-                                          size_t len,
-                                          const uint8_t *src_mac,
-                                          void *ctx);
-
 // ============================================================================
 // Initialization API
 // ============================================================================
@@ -93,28 +78,6 @@ esp_err_t cluster_espnow_send(const uint8_t *dest_mac, const char *data, size_t
  */
 esp_err_t cluster_espnow_broadcast(const char *data, size_t len);
 
-/**
- * @brief Set receive callback
- * @param callback Callback function
- * @param ctx User context
- */
-void cluster_espnow_set_rx_callback(cluster_transport_rx_cb_t callback, void *ctx);
-
-// ============================================================================
-// Discovery API (Master only)
-// ============================================================================
-
-/**
- * @brief Start broadcasting discovery beacons (master)
- * @return ESP_OK on success
- */
-esp_err_t cluster_espnow_start_discovery(void);
-
-/**
- * @brief Stop discovery broadcasting
- */
-void cluster_espnow_stop_discovery(void);
-
 // ============================================================================
 // Peer Management API
 // ============================================================================
@@ -143,13 +106,6 @@ esp_err_t cluster_espnow_remove_peer(const uint8_t *mac);
  */
 void cluster_espnow_get_self_mac(uint8_t *mac);
 
-/**
- * @brief Get master MAC address (slaves only)
- * @param mac Output: Master MAC address (6 bytes)
- * @return true if master MAC is known, false otherwise
- */
-bool cluster_espnow_get_master_mac(uint8_t *mac);
-
 /**
  * @brief Get WiFi channel
  * @return Channel number
@@ -157,20 +113,13 @@ bool cluster_espnow_get_master_mac(uint8_t *mac);
 uint8_t cluster_espnow_get_channel(void);
 
 /**
- * @brief Handle WiFi reconnection - update channel and reset registration
+ * @brief Handle WiFi reconnection - update channel
  *
- * Call this when WiFi reconnects to ensure ESP-NOW uses the correct channel
- * and slaves can re-register with the master.
+ * Called through cluster_transport_on_wifi_reconnect(), which also resets
+ * the uplink so slaves re-register with the master.
  */
 void cluster_espnow_on_wifi_reconnect(void);
 
-/**
- * @brief Reset registration state (for slaves)
- *
- * Forces re-registration with master on next beacon.
- */
-void cluster_espnow_reset_registration(void);
-
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,581 @@
+/**
+ * @file cluster_index.c
+ * @brief Clusteraxe Master Lookup Indexes
+ *
+ * Ring + open-addressing hash tables for job mappings, share dedup,
+ * pending pool submissions and work assignments. See cluster_index.h for the overview.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include "cluster_index.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "string.h"
+
+#if CLUSTER_ENABLED && CLUSTER_IS_MASTER
+
+static const char *TAG = "cluster_index";
+
+// Hash tables are at least twice the ring size (load factor <= 0.5) so
+// probe sequences stay short and there is always an empty bucket.
+#define INDEX_TABLE_SIZE(cap)  ((2 * (cap)) <= 64   ? 64   : \
+                                (2 * (cap)) <= 128  ? 128  : \
+                                (2 * (cap)) <= 256  ? 256  : \
+                                (2 * (cap)) <= 512  ? 512  : \
+                                (2 * (cap)) <= 1024 ? 1024 : \
+                                (2 * (cap)) <= 2048 ? 2048 : 4096)
+
+_Static_assert(CLUSTER_JOB_INDEX_SIZE > 0 && CLUSTER_JOB_INDEX_SIZE <= 2048,
+               "CLUSTER_JOB_INDEX_SIZE out of range");
+_Static_assert(CLUSTER_SHARE_DEDUP_SIZE > 0 && CLUSTER_SHARE_DEDUP_SIZE <= 2048,
+               "CLUSTER_SHARE_DEDUP_SIZE out of range");
+_Static_assert(CLUSTER_PENDING_SHARES_SIZE > 0 && CLUSTER_PENDING_SHARES_SIZE <= 2048,
+               "CLUSTER_PENDING_SHARES_SIZE out of range");
+_Static_assert(CLUSTER_WORK_INDEX_SIZE > 0 && CLUSTER_WORK_INDEX_SIZE <= 2048,
+               "CLUSTER_WORK_INDEX_SIZE out of range");
+
+// ============================================================================
+// Generic Ring + Hash Index
+// ============================================================================
+
+typedef struct {
+    uint32_t w[3];
+} index_key_t;
+
+typedef struct {
+    index_key_t *keys;          // Ring of keys, insertion order
+    int64_t *stamps;            // Insert/refresh time (us) per ring slot
+    bool *used;                 // Ring slot occupied
+    uint16_t *table;            // Hash buckets: ring slot + 1, 0 = empty
+    uint16_t capacity;          // Ring size
+    uint16_t mask;              // Table size - 1
+    uint16_t head;              // Next ring slot to write
+    uint16_t count;
+    uint16_t max_probe;
+    SemaphoreHandle_t mutex;
+} index_t;
+
+static uint32_t index_hash(const index_key_t *key)
+{
+    // Murmur3 finalizer applied across the key words
+    uint32_t h = 0x9E3779B9u;
+    for (int i = 0; i < 3; i++) {
+        h ^= key->w[i];
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35u;
+        h ^= h >> 16;
+    }
+    return h;
+}
+
+static inline bool index_key_eq(const index_key_t *a, const index_key_t *b)
+{
+    return a->w[0] == b->w[0] && a->w[1] == b->w[1] && a->w[2] == b->w[2];
+}
+
+/**
+ * @brief Find the hash bucket holding key
+ * @return Bucket position, or -1 if not present
+ */
+static int index_find_pos(index_t *ix, const index_key_t *key)
+{
+    uint32_t pos = index_hash(key) & ix->mask;
+
+    for (uint32_t probe = 0; probe <= ix->mask; probe++) {
+        uint16_t ref = ix->table[pos];
+        if (ref == 0) {
+            return -1;
+        }
+        if (index_key_eq(&ix->keys[ref - 1], key)) {
+            if (probe > ix->max_probe) {
+                ix->max_probe = probe;
+            }
+            return (int)pos;
+        }
+        pos = (pos + 1) & ix->mask;
+    }
+    return -1;
+}
+
+/**
+ * @brief Remove the entry at a bucket (backward-shift deletion, no tombstones)
+ */
+static void index_remove_pos(index_t *ix, uint32_t pos)
+{
+    uint16_t slot = ix->table[pos] - 1;
+    ix->used[slot] = false;
+    ix->count--;
+
+    uint32_t hole = pos;
+    uint32_t i = (pos + 1) & ix->mask;
+    while (ix->table[i] != 0) {
+        uint32_t home = index_hash(&ix->keys[ix->table[i] - 1]) & ix->mask;
+        // Shift back if the entry's home bucket is at or before the hole
+        if (((i - home) & ix->mask) >= ((i - hole) & ix->mask)) {
+            ix->table[hole] = ix->table[i];
+            hole = i;
+        }
+        i = (i + 1) & ix->mask;
+    }
+    ix->table[hole] = 0;
+}
+
+/**
+ * @brief Insert key, or refresh its timestamp if already present
+ *
+ * When the ring is full the oldest entry is evicted.
+ *
+ * @return Ring slot holding the key (for the caller's payload array)
+ */
+static uint16_t index_insert(index_t *ix, const index_key_t *key, int64_t now_us)
+{
+    int pos = index_find_pos(ix, key);
+    if (pos >= 0) {
+        uint16_t slot = ix->table[pos] - 1;
+        ix->stamps[slot] = now_us;
+        return slot;
+    }
+
+    uint16_t slot = ix->head;
+    if (ix->used[slot]) {
+        int old = index_find_pos(ix, &ix->keys[slot]);
+        if (old >= 0) {
+            index_remove_pos(ix, (uint32_t)old);
+        }
+    }
+
+    ix->keys[slot] = *key;
+    ix->stamps[slot] = now_us;
+    ix->used[slot] = true;
+    ix->count++;
+
+    uint32_t p = index_hash(key) & ix->mask;
+    uint16_t probe = 0;
+    while (ix->table[p] != 0) {
+        p = (p + 1) & ix->mask;
+        probe++;
+    }
+    ix->table[p] = slot + 1;
+    if (probe > ix->max_probe) {
+        ix->max_probe = probe;
+    }
+
+    ix->head = (ix->head + 1) % ix->capacity;
+    return slot;
+}
+
+static void index_clear(index_t *ix)
+{
+    memset(ix->used, 0, ix->capacity * sizeof(bool));
+    memset(ix->table, 0, ((size_t)ix->mask + 1) * sizeof(uint16_t));
+    ix->head = 0;
+    ix->count = 0;
+    ix->max_probe = 0;
+}
+
+static inline bool index_lock(index_t *ix)
+{
+    return ix->mutex && xSemaphoreTake(ix->mutex, portMAX_DELAY) == pdTRUE;
+}
+
+static inline void index_unlock(index_t *ix)
+{
+    xSemaphoreGive(ix->mutex);
+}
+
+// ============================================================================
+// Storage
+// ============================================================================
+
+#define DEFINE_INDEX(name, cap)                                             \
+    static index_key_t name##_keys[cap];                                    \
+    static int64_t name##_stamps[cap];                                      \
+    static bool name##_used[cap];                                           \
+    static uint16_t name##_table[INDEX_TABLE_SIZE(cap)];                    \
+    static index_t name = {                                                 \
+        .keys = name##_keys, .stamps = name##_stamps, .used = name##_used,  \
+        .table = name##_table, .capacity = (cap),                           \
+        .mask = INDEX_TABLE_SIZE(cap) - 1,                                  \
+    }
+
+DEFINE_INDEX(g_job_index, CLUSTER_JOB_INDEX_SIZE);
+DEFINE_INDEX(g_dedup_index, CLUSTER_SHARE_DEDUP_SIZE);
+DEFINE_INDEX(g_pending_index, CLUSTER_PENDING_SHARES_SIZE);
+DEFINE_INDEX(g_work_index, CLUSTER_WORK_INDEX_SIZE);
+
+// Per-slot payloads, parallel to each index's key ring
+static cluster_job_mapping_t g_job_data[CLUSTER_JOB_INDEX_SIZE];
+static struct {
+    uint32_t job_id;
+    uint32_t nonce;
+    uint8_t slave_id;
+    uint8_t pool_id;
+} g_pending_data[CLUSTER_PENDING_SHARES_SIZE];
+static cluster_work_header_t g_work_data[CLUSTER_WORK_INDEX_SIZE];
+
+static uint32_t g_job_lookups = 0;
+static uint32_t g_job_misses = 0;
+static uint32_t g_duplicates_dropped = 0;
+static uint32_t g_stale_dropped = 0;
+static uint32_t g_pending_expired = 0;
+static uint32_t g_work_misses = 0;
+
+// Block counter per pool, bumped on every previous-block-hash change
+static uint32_t g_pool_block[2] = {0};
+
+// ============================================================================
+// Lifecycle
+// ============================================================================
+
+esp_err_t cluster_index_init(void)
+{
+    index_t *all[] = { &g_job_index, &g_dedup_index, &g_pending_index, &g_work_index };
+
+    for (size_t i = 0; i < sizeof(all) / sizeof(all[0]); i++) {
+        if (!all[i]->mutex) {
+            all[i]->mutex = xSemaphoreCreateMutex();
+            if (!all[i]->mutex) {
+                ESP_LOGE(TAG, "Failed to create index mutex");
+                return ESP_ERR_NO_MEM;
+            }
+        }
+        xSemaphoreTake(all[i]->mutex, portMAX_DELAY);
+        index_clear(all[i]);
+        xSemaphoreGive(all[i]->mutex);
+    }
+
+    g_job_lookups = 0;
+    g_job_misses = 0;
+    g_duplicates_dropped = 0;
+    g_stale_dropped = 0;
+    g_pending_expired = 0;
+    g_work_misses = 0;
+    g_pool_block[0] = 0;
+    g_pool_block[1] = 0;
+
+    ESP_LOGI(TAG, "Indexes ready (jobs=%d, dedup=%d/%dms, pending=%d, work=%d)",
+             CLUSTER_JOB_INDEX_SIZE, CLUSTER_SHARE_DEDUP_SIZE,
+             CLUSTER_SHARE_DEDUP_WINDOW_MS, CLUSTER_PENDING_SHARES_SIZE,
+             CLUSTER_WORK_INDEX_SIZE);
+
+    return ESP_OK;
+}
+
+void cluster_index_deinit(void)
+{
+    index_t *all[] = { &g_job_index, &g_dedup_index, &g_pending_index, &g_work_index };
+
+    for (size_t i = 0; i < sizeof(all) / sizeof(all[0]); i++) {
+        if (all[i]->mutex) {
+            vSemaphoreDelete(all[i]->mutex);
+            all[i]->mutex = NULL;
+        }
+    }
+}
+
+// ============================================================================
+// Job Index
+// ============================================================================
+
+void cluster_job_index_put(const cluster_job_mapping_t *mapping)
+{
+    if (!mapping || !index_lock(&g_job_index)) {
+        return;
+    }
+
+    index_key_t key = { .w = { mapping->numeric_id, mapping->pool_id, 0 } };
+    uint16_t slot = index_insert(&g_job_index, &key, esp_timer_get_time());
+    g_job_data[slot] = *mapping;
+    g_job_data[slot].block = g_pool_block[mapping->pool_id & 1];
+    g_job_data[slot].job_id_str[sizeof(g_job_data[slot].job_id_str) - 1] = '\0';
+    g_job_data[slot].extranonce2_str[sizeof(g_job_data[slot].extranonce2_str) - 1] = '\0';
+
+    index_unlock(&g_job_index);
+}
+
+bool cluster_job_index_get(uint32_t numeric_id, uint8_t pool_id,
+                           cluster_job_mapping_t *out, bool *pool_mismatch)
+{
+    if (pool_mismatch) {
+        *pool_mismatch = false;
+    }
+    if (!out || !index_lock(&g_job_index)) {
+        return false;
+    }
+
+    g_job_lookups++;
+
+    index_key_t key = { .w = { numeric_id, pool_id, 0 } };
+    int pos = index_find_pos(&g_job_index, &key);
+    if (pos < 0) {
+        // Dual pool: pool ids are 0/1, so the fallback is a single probe
+        key.w[1] = pool_id ^ 1;
+        pos = index_find_pos(&g_job_index, &key);
+        if (pos >= 0 && pool_mismatch) {
+            *pool_mismatch = true;
+        }
+    }
+
+    if (pos >= 0) {
+        *out = g_job_data[g_job_index.table[pos] - 1];
+    } else {
+        g_job_misses++;
+    }
+
+    index_unlock(&g_job_index);
+    return pos >= 0;
+}
+
+void cluster_job_index_new_block(uint8_t pool_id)
+{
+    if (!index_lock(&g_job_index)) {
+        return;
+    }
+    g_pool_block[pool_id & 1]++;
+    index_unlock(&g_job_index);
+}
+
+cluster_share_status_t cluster_job_index_check_share(uint32_t numeric_id, uint8_t pool_id,
+                                                     uint32_t ntime)
+{
+    if (!index_lock(&g_job_index)) {
+        return CLUSTER_SHARE_CURRENT;
+    }
+
+    // Same pool fallback as cluster_job_index_get(), without its counters
+    index_key_t key = { .w = { numeric_id, pool_id, 0 } };
+    int pos = index_find_pos(&g_job_index, &key);
+    if (pos < 0) {
+        key.w[1] = pool_id ^ 1;
+        pos = index_find_pos(&g_job_index, &key);
+    }
+
+    cluster_share_status_t status = CLUSTER_SHARE_CURRENT;
+    if (pos < 0) {
+        status = CLUSTER_SHARE_UNKNOWN_JOB;
+    } else {
+        const cluster_job_mapping_t *job = &g_job_data[g_job_index.table[pos] - 1];
+        if (job->block != g_pool_block[job->pool_id & 1]) {
+            status = CLUSTER_SHARE_OLD_BLOCK;
+        } else if ((uint32_t)(ntime - job->ntime) > CLUSTER_SHARE_MAX_NTIME_ROLL_S) {
+            // Unsigned difference also rejects ntime before the job's
+            status = CLUSTER_SHARE_BAD_NTIME;
+        }
+    }
+
+    if (status != CLUSTER_SHARE_CURRENT) {
+        g_stale_dropped++;
+    }
+
+    index_unlock(&g_job_index);
+    return status;
+}
+
+const char *cluster_share_status_name(cluster_share_status_t status)
+{
+    switch (status) {
+        case CLUSTER_SHARE_CURRENT:     return "current";
+        case CLUSTER_SHARE_UNKNOWN_JOB: return "unknown job";
+        case CLUSTER_SHARE_OLD_BLOCK:   return "old block";
+        case CLUSTER_SHARE_BAD_NTIME:   return "ntime out of range";
+        default:                        return "?";
+    }
+}
+
+// ============================================================================
+// Share Dedup
+// ============================================================================
+
+bool cluster_share_dedup_check_and_record(uint16_t node_addr, uint8_t pool_id,
+                                          uint32_t job_id, uint32_t nonce)
+{
+    if (!index_lock(&g_dedup_index)) {
+        return false;
+    }
+
+    int64_t now = esp_timer_get_time();
+    index_key_t key = { .w = { job_id, nonce, (uint32_t)node_addr | ((uint32_t)pool_id << 16) } };
+    bool duplicate = false;
+
+    int pos = index_find_pos(&g_dedup_index, &key);
+    if (pos >= 0) {
+        uint16_t slot = g_dedup_index.table[pos] - 1;
+        duplicate = (now - g_dedup_index.stamps[slot]) <=
+                    (int64_t)CLUSTER_SHARE_DEDUP_WINDOW_MS * 1000;
+    }
+
+    if (duplicate) {
+        g_duplicates_dropped++;
+    } else {
+        index_insert(&g_dedup_index, &key, now);
+    }
+
+    index_unlock(&g_dedup_index);
+    return duplicate;
+}
+
+// ============================================================================
+// Pending Pool Submissions
+// ============================================================================
+
+void cluster_pending_share_put(int message_id, uint8_t slave_id, uint8_t pool_id,
+                               uint32_t job_id, uint32_t nonce)
+{
+    if (!index_lock(&g_pending_index)) {
+        return;
+    }
+
+    index_key_t key = { .w = { (uint32_t)message_id, 0, 0 } };
+    uint16_t slot = index_insert(&g_pending_index, &key, esp_timer_get_time());
+    g_pending_data[slot].slave_id = slave_id;
+    g_pending_data[slot].pool_id = pool_id;
+    g_pending_data[slot].job_id = job_id;
+    g_pending_data[slot].nonce = nonce;
+
+    index_unlock(&g_pending_index);
+}
+
+bool cluster_pending_share_take(int message_id, uint8_t *slave_id, uint8_t *pool_id,
+                                uint32_t *job_id, uint32_t *nonce)
+{
+    if (!index_lock(&g_pending_index)) {
+        return false;
+    }
+
+    index_key_t key = { .w = { (uint32_t)message_id, 0, 0 } };
+    bool found = false;
+
+    int pos = index_find_pos(&g_pending_index, &key);
+    if (pos >= 0) {
+        uint16_t slot = g_pending_index.table[pos] - 1;
+        int64_t age_us = esp_timer_get_time() - g_pending_index.stamps[slot];
+
+        if (age_us <= (int64_t)CLUSTER_PENDING_SHARE_TIMEOUT_MS * 1000) {
+            if (slave_id) *slave_id = g_pending_data[slot].slave_id;
+            if (pool_id) *pool_id = g_pending_data[slot].pool_id;
+            if (job_id) *job_id = g_pending_data[slot].job_id;
+            if (nonce) *nonce = g_pending_data[slot].nonce;
+            found = true;
+        } else {
+            g_pending_expired++;
+        }
+        index_remove_pos(&g_pending_index, (uint32_t)pos);
+    }
+
+    index_unlock(&g_pending_index);
+    return found;
+}
+
+// ============================================================================
+// Work Index
+// ============================================================================
+
+static index_key_t work_key(uint32_t job_id, uint8_t pool_id,
+                            const uint8_t *extranonce2, uint8_t extranonce2_len)
+{
+    // Extranonce2 is at most 8 bytes; pool and length share the last word
+    uint8_t en2[8] = {0};
+    memcpy(en2, extranonce2, extranonce2_len > 8 ? 8 : extranonce2_len);
+
+    index_key_t key = { .w = { job_id, 0, 0 } };
+    key.w[1] = en2[0] | (en2[1] << 8) | (en2[2] << 16) | ((uint32_t)en2[3] << 24);
+    key.w[2] = en2[4] | (en2[5] << 8) | (en2[6] << 16) | ((uint32_t)en2[7] << 24);
+    key.w[2] ^= ((uint32_t)pool_id << 4 | extranonce2_len) * 0x9E3779B1u;
+    return key;
+}
+
+void cluster_work_index_put(const cluster_work_header_t *header)
+{
+    if (!header || !index_lock(&g_work_index)) {
+        return;
+    }
+
+    index_key_t key = work_key(header->job_id, header->pool_id,
+                               header->extranonce2, header->extranonce2_len);
+    uint16_t slot = index_insert(&g_work_index, &key, esp_timer_get_time());
+    g_work_data[slot] = *header;
+
+    index_unlock(&g_work_index);
+}
+
+bool cluster_work_index_get(uint32_t job_id, uint8_t pool_id,
+                            const uint8_t *extranonce2, uint8_t extranonce2_len,
+                            cluster_work_header_t *out)
+{
+    if (!extranonce2 || !out || extranonce2_len > 8 || !index_lock(&g_work_index)) {
+        return false;
+    }
+
+    index_key_t key = work_key(job_id, pool_id, extranonce2, extranonce2_len);
+    bool found = false;
+
+    int pos = index_find_pos(&g_work_index, &key);
+    if (pos >= 0) {
+        // The key folds pool and length into one word; confirm on the payload
+        const cluster_work_header_t *entry = &g_work_data[g_work_index.table[pos] - 1];
+        if (entry->pool_id == pool_id && entry->extranonce2_len == extranonce2_len &&
+            memcmp(entry->extranonce2, extranonce2, extranonce2_len) == 0) {
+            *out = *entry;
+            found = true;
+        }
+    }
+    if (!found) {
+        g_work_misses++;
+    }
+
+    index_unlock(&g_work_index);
+    return found;
+}
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+void cluster_index_get_stats(cluster_index_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    if (index_lock(&g_job_index)) {
+        stats->job_entries = g_job_index.count;
+        stats->job_lookups = g_job_lookups;
+        stats->job_misses = g_job_misses;
+        stats->stale_dropped = g_stale_dropped;
+        stats->max_probe = g_job_index.max_probe;
+        index_unlock(&g_job_index);
+    }
+    if (index_lock(&g_dedup_index)) {
+        stats->dedup_entries = g_dedup_index.count;
+        stats->duplicates_dropped = g_duplicates_dropped;
+        if (g_dedup_index.max_probe > stats->max_probe) {
+            stats->max_probe = g_dedup_index.max_probe;
+        }
+        index_unlock(&g_dedup_index);
+    }
+    if (index_lock(&g_pending_index)) {
+        stats->pending_entries = g_pending_index.count;
+        stats->pending_expired = g_pending_expired;
+        if (g_pending_index.max_probe > stats->max_probe) {
+            stats->max_probe = g_pending_index.max_probe;
+        }
+        index_unlock(&g_pending_index);
+    }
+    if (index_lock(&g_work_index)) {
+        stats->work_entries = g_work_index.count;
+        stats->work_misses = g_work_misses;
+        if (g_work_index.max_probe > stats->max_probe) {
+            stats->max_probe = g_work_index.max_probe;
+        }
+        index_unlock(&g_work_index);
+    }
+}
+
+#endif // CLUSTER_ENABLED && CLUSTER_IS_MASTER
@@ -0,0 +1,246 @@
+/**
+ * @file cluster_index.h
+ * @brief Clusteraxe Master Lookup Indexes
+ *
+ * Constant-time lookup tables used on the master's share path:
+ *   - Job index:     (numeric job id, pool id) -> original stratum job data,
+ *                    also used to drop shares that went stale on the way
+ *   - Share dedup:   (node, pool, job, nonce) seen within a time window
+ *   - Pending map:   stratum message id -> (slave, pool) awaiting pool result
+ *   - Work index:    (job, pool, extranonce2) -> block header fields of the
+ *                    work sent to a slave, for re-hashing its shares
+ *
+ * Each index is a fixed-size insertion-order ring of entries plus an
+ * open-addressing (linear probing) hash table pointing into the ring.
+ * The oldest entry is evicted when the ring is full, so memory is bounded
+ * at compile time. Each index has its own mutex; all functions are safe to
+ * call from the stratum, share submitter and transport RX tasks.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#ifndef CLUSTER_INDEX_H
+#define CLUSTER_INDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "cluster_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Capacities
+// ============================================================================
+
+// Job mappings retained (ring). Hash table is sized at 2x this.
+#ifndef CLUSTER_JOB_INDEX_SIZE
+    #define CLUSTER_JOB_INDEX_SIZE          256
+#endif
+
+// Shares remembered for duplicate detection
+#ifndef CLUSTER_SHARE_DEDUP_SIZE
+    #define CLUSTER_SHARE_DEDUP_SIZE        256
+#endif
+
+// Shares older than this are no longer considered duplicates (ms)
+#ifndef CLUSTER_SHARE_DEDUP_WINDOW_MS
+    #define CLUSTER_SHARE_DEDUP_WINDOW_MS   120000
+#endif
+
+// Share submissions awaiting a pool response
+#ifndef CLUSTER_PENDING_SHARES_SIZE
+    #define CLUSTER_PENDING_SHARES_SIZE     128
+#endif
+
+// Pending submissions without a pool response after this are dropped (ms)
+#ifndef CLUSTER_PENDING_SHARE_TIMEOUT_MS
+    #define CLUSTER_PENDING_SHARE_TIMEOUT_MS 60000
+#endif
+
+// Furthest a share's ntime may be rolled past its job's ntime (s).
+// Slaves roll at most CLUSTER_AUTONOMOUS_MAX_MS while their uplink is down.
+#ifndef CLUSTER_SHARE_MAX_NTIME_ROLL_S
+    #define CLUSTER_SHARE_MAX_NTIME_ROLL_S  600
+#endif
+
+// Work assignments (one per slave per work message) kept for share verification
+#ifndef CLUSTER_WORK_INDEX_SIZE
+    #define CLUSTER_WORK_INDEX_SIZE         256
+#endif
+
+// ============================================================================
+// Types
+// ============================================================================
+
+typedef struct {
+    uint32_t numeric_id;
+    uint8_t pool_id;                // 0=primary, 1=secondary
+    char job_id_str[32];
+    char extranonce2_str[32];
+    uint32_t ntime;
+    uint32_t version;
+    uint32_t block;                 // Pool's block counter when stored (set by put)
+} cluster_job_mapping_t;
+
+/**
+ * @brief Block header fields of one work assignment (see cluster_verify.h)
+ */
+typedef struct {
+    uint32_t job_id;
+    uint8_t pool_id;
+    uint8_t extranonce2_len;
+    uint8_t extranonce2[8];
+    uint32_t version;               // Job version before rolling
+    uint32_t version_mask;          // Bits the slave may roll
+    uint32_t nbits;
+    uint32_t pool_diff;
+    uint8_t prev_block_hash[32];    // Block header byte order
+    uint8_t merkle_root[32];        // Block header byte order
+} cluster_work_header_t;
+
+/**
+ * @brief Whether a share can still be submitted
+ */
+typedef enum {
+    CLUSTER_SHARE_CURRENT = 0,
+    CLUSTER_SHARE_UNKNOWN_JOB,      // No mapping (never issued, or evicted)
+    CLUSTER_SHARE_OLD_BLOCK,        // Job belongs to a block the pool has moved past
+    CLUSTER_SHARE_BAD_NTIME,        // ntime outside the job's roll window
+} cluster_share_status_t;
+
+typedef struct {
+    uint16_t job_entries;
+    uint16_t dedup_entries;
+    uint16_t pending_entries;
+    uint16_t work_entries;
+    uint32_t job_lookups;
+    uint32_t job_misses;
+    uint32_t duplicates_dropped;
+    uint32_t stale_dropped;         // Shares failing cluster_job_index_check_share()
+    uint32_t pending_expired;
+    uint32_t work_misses;           // Shares with no work assignment to verify against
+    uint16_t max_probe;             // Longest probe sequence seen on any table
+} cluster_index_stats_t;
+
+// ============================================================================
+// API
+// ============================================================================
+
+#if CLUSTER_ENABLED && CLUSTER_IS_MASTER
+
+/**
+ * @brief Create index locks and clear all indexes
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if a mutex could not be created
+ */
+esp_err_t cluster_index_init(void);
+
+/**
+ * @brief Release index locks
+ */
+void cluster_index_deinit(void);
+
+/**
+ * @brief Store or replace a job mapping
+ * @param mapping Mapping to store, keyed by (numeric_id, pool_id)
+ */
+void cluster_job_index_put(const cluster_job_mapping_t *mapping);
+
+/**
+ * @brief Look up a job mapping
+ *
+ * Tries the exact (numeric_id, pool_id) key first, then the other pool's
+ * key for backwards compatibility with slaves that report the wrong pool.
+ *
+ * @param numeric_id Numeric job ID sent to slaves
+ * @param pool_id Pool ID reported with the share
+ * @param out Output: mapping copy
+ * @param pool_mismatch Output (optional): true if only the other pool matched
+ * @return true if a mapping was found
+ */
+bool cluster_job_index_get(uint32_t numeric_id, uint8_t pool_id,
+                           cluster_job_mapping_t *out, bool *pool_mismatch);
+
+/**
+ * @brief Note that a pool moved to a new block (previous block hash changed)
+ *
+ * Jobs stored before this are stale for that pool. Call before storing the
+ * new block's first job mapping.
+ */
+void cluster_job_index_new_block(uint8_t pool_id);
+
+/**
+ * @brief Reconcile a share against the job it claims before submitting it
+ *
+ * Shares buffered on a slave through an uplink outage can arrive long after
+ * they were found. A share is current if its job is still indexed, the
+ * pool has not moved to a new block since, and its ntime lies within
+ * CLUSTER_SHARE_MAX_NTIME_ROLL_S after the job's. Anything else is counted
+ * in stale_dropped.
+ */
+cluster_share_status_t cluster_job_index_check_share(uint32_t numeric_id, uint8_t pool_id,
+                                                     uint32_t ntime);
+
+/**
+ * @brief Short name of a share status for logs
+ */
+const char *cluster_share_status_name(cluster_share_status_t status);
+
+/**
+ * @brief Check a share against the dedup window and record it
+ * @param node_addr Node that found the share (16-bit, see cluster_topology.h)
+ * @return true if the share was already seen within the window
+ */
+bool cluster_share_dedup_check_and_record(uint16_t node_addr, uint8_t pool_id,
+                                          uint32_t job_id, uint32_t nonce);
+
+/**
+ * @brief Remember which slave (and share) a stratum submission belongs to
+ * @param message_id Stratum request id used for mining.submit
+ * @param job_id Numeric job id and nonce, to trace the pool's answer
+ */
+void cluster_pending_share_put(int message_id, uint8_t slave_id, uint8_t pool_id,
+                               uint32_t job_id, uint32_t nonce);
+
+/**
+ * @brief Remove and return the pending entry for a stratum response
+ *
+ * Output pointers may be NULL.
+ *
+ * @return true if the message id belonged to a cluster share
+ */
+bool cluster_pending_share_take(int message_id, uint8_t *slave_id, uint8_t *pool_id,
+                                uint32_t *job_id, uint32_t *nonce);
+
+/**
+ * @brief Remember the header fields of work sent to a slave
+ *
+ * Keyed by (job_id, pool_id, extranonce2); resending the same assignment
+ * replaces the entry.
+ */
+void cluster_work_index_put(const cluster_work_header_t *header);
+
+/**
+ * @brief Find the work assignment a share was mined on
+ * @return true if found; misses are counted in work_misses
+ */
+bool cluster_work_index_get(uint32_t job_id, uint8_t pool_id,
+                            const uint8_t *extranonce2, uint8_t extranonce2_len,
+                            cluster_work_header_t *out);
+
+/**
+ * @brief Snapshot index occupancy and counters
+ */
+void cluster_index_get_stats(cluster_index_stats_t *stats);
+
+#endif // CLUSTER_ENABLED && CLUSTER_IS_MASTER
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLUSTER_INDEX_H
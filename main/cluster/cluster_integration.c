@@ -10,12 +10,17 @@
 
 #include "cluster_integration.h"
 #include "cluster.h"
+#include "cluster_autotune.h"
 #include "cluster_protocol.h"
 #include "cluster_config.h"
-#include "cluster_espnow.h"
+#include "cluster_transport.h"
+#include "cluster_index.h"
+#include "cluster_trace.h"
+#include "metrics.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "string.h"
+#include "asic.h"
 #include "mining.h"
 #include "nvs_config.h"
 #include "power/power.h"
@@ -29,22 +34,24 @@ static const char *TAG = "cluster_integ";
 // Global state reference for integration functions
 static GlobalState *g_global_state = NULL;
 
+#if CLUSTER_IS_MASTER
+static void collect_cluster_metrics(metrics_writer_t *w, void *ctx);
+#endif
+
 // ============================================================================
 // Common Integration Functions
 // ============================================================================
 
-#if defined(CONFIG_CLUSTER_TRANSPORT_ESPNOW) || defined(CONFIG_CLUSTER_TRANSPORT_BOTH)
 /**
- * @brief Wrapper to adapt ESP-NOW callback to cluster message handler
+ * @brief Wrapper to adapt transport callback to cluster message handler
  */
-static void espnow_rx_wrapper(const char *msg_type, const char *payload, size_t len, const uint8_t *src_mac, void *ctx)
+static void transport_rx_wrapper(const char *msg_type, const char *payload, size_t len, const uint8_t *src_mac, void *ctx)
 {
     (void)ctx;
-    // Pass MAC to enhanced handler that can route ESP-NOW specific data
-    extern esp_err_t cluster_handle_espnow_message(const char *msg_type, const char *payload, size_t len, const uint8_t *src_mac);
-    cluster_handle_espnow_message(msg_type, payload, len, src_mac);
+    // Pass MAC to enhanced handler that can route per-node data
+    extern esp_err_t cluster_handle_transport_message(const char *msg_type, const char *payload, size_t len, const uint8_t *src_mac);
+    cluster_handle_transport_message(msg_type, payload, len, src_mac);
 }
-#endif
 
 esp_err_t cluster_integration_init(GlobalState *GLOBAL_STATE)
 {
@@ -58,25 +65,39 @@ esp_err_t cluster_integration_init(GlobalState *GLOBAL_STATE)
     // Initialize cluster subsystem with compile-time default mode
     esp_err_t ret = cluster_init(CLUSTER_MODE_DEFAULT);
 
-#if defined(CONFIG_CLUSTER_TRANSPORT_ESPNOW) || defined(CONFIG_CLUSTER_TRANSPORT_BOTH)
     if (ret == ESP_OK && cluster_is_active()) {
-        if (cluster_espnow_init() == ESP_OK) {
-            cluster_espnow_set_rx_callback(espnow_rx_wrapper, NULL);
-            ESP_LOGI(TAG, "ESP-NOW transport initialized");
-            
-            // Start discovery if we are master
-            #if CLUSTER_IS_MASTER
-            cluster_espnow_start_discovery();
+        // Master listens on every transport; a slave uses the one it was
+        // configured for
+#if CLUSTER_IS_MASTER
+        cluster_transport_type_t transport = CLUSTER_TRANSPORT_NONE;
+#else
+        cluster_transport_type_t transport = cluster_transport_get_preferred();
+#endif
+        cluster_transport_register_rx_callback(transport_rx_wrapper, NULL);
+        if (cluster_transport_init(transport) == ESP_OK) {
+            ESP_LOGI(TAG, "Cluster transport initialized (%s)",
+                     cluster_transport_type_name(cluster_transport_get_type()));
+
+            // Start discovery if we are master (or a relay accepting downstream slaves)
+            #if CLUSTER_IS_MASTER || CLUSTER_IS_RELAY
+            cluster_transport_start_discovery();
             #endif
         } else {
-            ESP_LOGE(TAG, "Failed to initialize ESP-NOW transport");
+            ESP_LOGE(TAG, "Failed to initialize cluster transport");
         }
     }
-#endif
 
     if (ret == ESP_OK) {
+        // Loads the temperature profiles, which are followed from boot
+        cluster_autotune_init();
+
+#if CLUSTER_IS_MASTER
+        metrics_register_collector(collect_cluster_metrics, NULL);
+#endif
+
         ESP_LOGI(TAG, "Cluster integration initialized: %s",
-                 CLUSTER_IS_MASTER ? "MASTER" : (CLUSTER_IS_SLAVE ? "SLAVE" : "DISABLED"));
+                 CLUSTER_IS_MASTER ? "MASTER" :
+                 (CLUSTER_IS_RELAY ? "RELAY" : (CLUSTER_IS_SLAVE ? "SLAVE" : "DISABLED")));
     }
 
     return ret;
@@ -169,6 +190,36 @@ float cluster_get_voltage_in(void)
     return Power_get_input_voltage(g_global_state) / 1000.0f;
 }
 
+void cluster_get_board_telemetry(cluster_board_telemetry_t *board)
+{
+    memset(board, 0, sizeof(*board));
+    if (!g_global_state) {
+        return;
+    }
+
+    board->chip_temp2 = g_global_state->POWER_MANAGEMENT_MODULE.chip_temp2_avg;
+    board->vr_temp = g_global_state->POWER_MANAGEMENT_MODULE.vr_temp;
+    board->fan2_rpm = g_global_state->POWER_MANAGEMENT_MODULE.fan2_rpm;
+    board->error_percent = g_global_state->SYSTEM_MODULE.error_percentage;
+    board->asic_queue = (uint8_t)g_global_state->ASIC_jobs_queue.count;
+
+    HashrateMonitorModule *monitor = &g_global_state->HASHRATE_MONITOR_MODULE;
+    if (!monitor->is_initialized) {
+        return;
+    }
+
+    int count = g_global_state->DEVICE_CONFIG.family.asic_count;
+    if (count > CLUSTER_TELEMETRY_MAX_ASICS) {
+        count = CLUSTER_TELEMETRY_MAX_ASICS;
+    }
+    board->asic_count = count;
+    for (int i = 0; i < count; i++) {
+        float total = monitor->total_measurement[i].hashrate;
+        board->asic_hashrate[i] = total;
+        board->asic_error[i] = total > 0 ? monitor->error_measurement[i].hashrate / total * 100.f : 0;
+    }
+}
+
 // ============================================================================
 // Master Integration Functions
 // ============================================================================
@@ -188,6 +239,7 @@ typedef struct {
     int extranonce_2_len;
     uint8_t (*merkle_branches)[32];
     int n_merkle_branches;
+    char prev_block_hash[65];   // Last block seen, to spot new blocks
     bool valid;
 } stored_notify_t;
 
@@ -219,6 +271,15 @@ static void store_notify_data(const mining_notify *notification,
     if (pool_id > 1) pool_id = 0;  // Safety check
     stored_notify_t *notify = &g_stored_notify[pool_id];
 
+    // A new previous block hash makes every earlier job from this pool stale
+    if (notification->prev_block_hash &&
+        strncmp(notify->prev_block_hash, notification->prev_block_hash,
+                sizeof(notify->prev_block_hash) - 1) != 0) {
+        strncpy(notify->prev_block_hash, notification->prev_block_hash,
+                sizeof(notify->prev_block_hash) - 1);
+        cluster_job_index_new_block(pool_id);
+    }
+
     // Free old data
     if (notify->coinbase_1) free(notify->coinbase_1);
     if (notify->coinbase_2) free(notify->coinbase_2);
@@ -324,6 +385,7 @@ void cluster_master_on_mining_notify(GlobalState *GLOBAL_STATE,
                                       "", notification->ntime, notification->version, pool_id);
     ESP_LOGD(TAG, "Stored job mapping: %08lx -> %s (pool=%d)",
              (unsigned long)work.job_id, notification->job_id, pool_id);
+    cluster_trace_record(CLUSTER_TRACE_NOTIFY, CLUSTER_TRACE_NODE_MASTER, work.job_id, 0);
 
     // Convert prev_block_hash from hex string
     if (notification->prev_block_hash) {
@@ -373,43 +435,19 @@ void cluster_master_on_mining_notify(GlobalState *GLOBAL_STATE,
     cluster_master_distribute_work(&work);
 }
 
-// Store mapping of job_id to job string for share submission
-// Increased from 128 to 256 to prevent job mapping loss with multiple slaves
-#define MAX_JOB_MAPPINGS 256
-static struct {
-    uint32_t numeric_id;
-    char job_id_str[32];
-    char extranonce2_str[32];
-    uint32_t ntime;
-    uint32_t version;
-    uint8_t pool_id;  // 0=primary, 1=secondary for dual pool mode
-    bool valid;
-} job_mappings[MAX_JOB_MAPPINGS];
-static int job_mapping_index = 0;
-
-// Track pending cluster shares to update slave counters when pool responds
-#define MAX_PENDING_SHARES 64
-static struct {
-    int send_uid;       // Stratum message ID
-    uint8_t slave_id;   // Which slave sent this share
-    uint8_t pool_id;    // Which pool this share was submitted to (0=primary, 1=secondary)
-    bool valid;
-} pending_cluster_shares[MAX_PENDING_SHARES];
-static int pending_share_index = 0;
-
 void cluster_master_store_job_mapping(uint32_t numeric_id, const char *job_id_str,
                                        const char *extranonce2, uint32_t ntime, uint32_t version,
                                        uint8_t pool_id)
 {
-    int idx = job_mapping_index % MAX_JOB_MAPPINGS;
-    job_mappings[idx].numeric_id = numeric_id;
-    strncpy(job_mappings[idx].job_id_str, job_id_str, sizeof(job_mappings[idx].job_id_str) - 1);
-    strncpy(job_mappings[idx].extranonce2_str, extranonce2, sizeof(job_mappings[idx].extranonce2_str) - 1);
-    job_mappings[idx].ntime = ntime;
-    job_mappings[idx].version = version;
-    job_mappings[idx].pool_id = pool_id;
-    job_mappings[idx].valid = true;
-    job_mapping_index++;
+    cluster_job_mapping_t mapping = {
+        .numeric_id = numeric_id,
+        .pool_id = pool_id,
+        .ntime = ntime,
+        .version = version,
+    };
+    strncpy(mapping.job_id_str, job_id_str, sizeof(mapping.job_id_str) - 1);
+    strncpy(mapping.extranonce2_str, extranonce2, sizeof(mapping.extranonce2_str) - 1);
+    cluster_job_index_put(&mapping);
 }
 
 /**
@@ -422,25 +460,20 @@ void cluster_master_store_job_mapping(uint32_t numeric_id, const char *job_id_st
  */
 static bool cluster_master_find_job_mapping(uint32_t numeric_id, uint8_t pool_id, char *job_id_str, size_t max_len)
 {
-    // First try to find exact match (same numeric_id AND pool_id)
-    for (int i = 0; i < MAX_JOB_MAPPINGS; i++) {
-        if (job_mappings[i].valid &&
-            job_mappings[i].numeric_id == numeric_id &&
-            job_mappings[i].pool_id == pool_id) {
-            strncpy(job_id_str, job_mappings[i].job_id_str, max_len - 1);
-            return true;
-        }
+    cluster_job_mapping_t mapping;
+    bool pool_mismatch;
+
+    if (!cluster_job_index_get(numeric_id, pool_id, &mapping, &pool_mismatch)) {
+        return false;
     }
-    // Fallback: try to find by numeric_id only (for backwards compatibility)
-    for (int i = 0; i < MAX_JOB_MAPPINGS; i++) {
-        if (job_mappings[i].valid && job_mappings[i].numeric_id == numeric_id) {
-            ESP_LOGW(TAG, "Job mapping found by numeric_id only (pool mismatch: stored=%d, requested=%d)",
-                     job_mappings[i].pool_id, pool_id);
-            strncpy(job_id_str, job_mappings[i].job_id_str, max_len - 1);
-            return true;
-        }
+    if (pool_mismatch) {
+        // Fallback match on the other pool (for backwards compatibility)
+        ESP_LOGW(TAG, "Job mapping found by numeric_id only (pool mismatch: stored=%d, requested=%d)",
+                 mapping.pool_id, pool_id);
     }
-    return false;
+    strncpy(job_id_str, mapping.job_id_str, max_len - 1);
+    job_id_str[max_len - 1] = '\0';
+    return true;
 }
 
 void stratum_submit_share_from_cluster(uint32_t job_id, uint32_t nonce,
@@ -501,12 +534,7 @@ void stratum_submit_share_from_cluster(uint32_t job_id, uint32_t nonce,
     }
 
     // Track this pending share so we can update slave stats when pool responds
-    int idx = pending_share_index % MAX_PENDING_SHARES;
-    pending_cluster_shares[idx].send_uid = send_uid;
-    pending_cluster_shares[idx].slave_id = slave_id;
-    pending_cluster_shares[idx].pool_id = pool_id;
-    pending_cluster_shares[idx].valid = true;
-    pending_share_index++;
+    cluster_pending_share_put(send_uid, slave_id, pool_id, job_id, nonce);
 
     // Version bits come from slave already in correct format (rolled_version ^ base_version)
     // Do NOT XOR again - pass directly to stratum
@@ -547,26 +575,124 @@ void cluster_master_get_local_nonce_range(uint32_t *nonce_start, uint32_t *nonce
 void cluster_notify_share_result(int message_id, bool accepted)
 {
     // Look up which slave this share belongs to
-    for (int i = 0; i < MAX_PENDING_SHARES; i++) {
-        if (pending_cluster_shares[i].valid && pending_cluster_shares[i].send_uid == message_id) {
-            uint8_t slave_id = pending_cluster_shares[i].slave_id;
-            uint8_t pool_id = pending_cluster_shares[i].pool_id;
-            pending_cluster_shares[i].valid = false;  // Clear this entry
-
-            // Update slave counters (including per-pool stats)
-            cluster_slave_t slave;
-            if (cluster_master_get_slave(slave_id, &slave) == ESP_OK) {
-                // Update the slave's counter in master state
-                extern void cluster_master_update_slave_share_count(uint8_t slave_id, bool accepted, uint8_t pool_id);
-                cluster_master_update_slave_share_count(slave_id, accepted, pool_id);
-
-                ESP_LOGI(TAG, "Cluster share from slave %d %s (pool %d)", slave_id,
-                         accepted ? "ACCEPTED" : "REJECTED", pool_id);
-            }
-            return;
+    uint8_t slave_id;
+    uint8_t pool_id;
+    uint32_t job_id;
+    uint32_t nonce;
+    if (!cluster_pending_share_take(message_id, &slave_id, &pool_id, &job_id, &nonce)) {
+        // Not a cluster share, or already processed - that's fine
+        return;
+    }
+
+    cluster_trace_record(accepted ? CLUSTER_TRACE_ACCEPTED : CLUSTER_TRACE_REJECTED,
+                         slave_id, job_id, nonce);
+
+    // Update slave counters (including per-pool stats)
+    cluster_slave_t slave;
+    if (cluster_master_get_slave(slave_id, &slave) == ESP_OK) {
+        // Update the slave's counter in master state
+        extern void cluster_master_update_slave_share_count(uint8_t slave_id, bool accepted, uint8_t pool_id);
+        cluster_master_update_slave_share_count(slave_id, accepted, pool_id);
+
+        ESP_LOGI(TAG, "Cluster share from slave %d %s (pool %d)", slave_id,
+                 accepted ? "ACCEPTED" : "REJECTED", pool_id);
+    }
+}
+
+// ============================================================================
+// Metrics
+// ============================================================================
+
+// What /metrics reports per slave; copied out of the slave table in one pass
+typedef struct {
+    char        labels[METRICS_LABELS_SIZE + 32];
+    bool        up;
+    float       hashrate;
+    float       temperature;
+    float       vr_temp;
+    float       power;
+    uint16_t    fan_rpm;
+    uint16_t    frequency;
+    uint32_t    shares_accepted;
+    uint32_t    shares_rejected;
+    uint32_t    shares_invalid;
+} slave_metrics_t;
+
+/**
+ * @brief Write the cluster totals and one series per connected slave
+ */
+static void collect_cluster_metrics(metrics_writer_t *w, void *ctx)
+{
+    (void)ctx;
+
+    cluster_stats_t stats;
+    uint8_t active = 0;
+    cluster_master_get_stats(&stats, &active);
+
+    metrics_write_family(w, "bitaxe_cluster_hashrate_ghs", METRICS_GAUGE, "Combined hashrate of the cluster");
+    metrics_write_sample(w, "bitaxe_cluster_hashrate_ghs", NULL, stats.total_hashrate / 100.0);
+    metrics_write_family(w, "bitaxe_cluster_active_slaves", METRICS_GAUGE, "Slaves sending heartbeats");
+    metrics_write_sample(w, "bitaxe_cluster_active_slaves", NULL, active);
+
+    slave_metrics_t slaves[CLUSTER_MAX_SLAVES];
+    int count = 0;
+    cluster_slave_t info;
+    for (int i = 0; i < CLUSTER_MAX_SLAVES; i++) {
+        if (cluster_master_get_slave_info(i, &info) != ESP_OK || info.state == SLAVE_STATE_DISCONNECTED) {
+            continue;
+        }
+        slave_metrics_t *m = &slaves[count++];
+        char hostname[sizeof(info.hostname) * 2];
+        metrics_escape_label(hostname, sizeof(hostname), info.hostname);
+        snprintf(m->labels, sizeof(m->labels), "slot=\"%d\",hostname=\"%s\"", i, hostname);
+        m->up = info.state == SLAVE_STATE_ACTIVE;
+        m->hashrate = info.hashrate / 100.0f;
+        m->temperature = info.temperature;
+        m->vr_temp = info.vr_temp;
+        m->power = info.power;
+        m->fan_rpm = info.fan_rpm;
+        m->frequency = info.frequency;
+        m->shares_accepted = info.shares_accepted;
+        m->shares_rejected = info.shares_rejected;
+        m->shares_invalid = info.shares_invalid;
+    }
+    if (count == 0) {
+        return;
+    }
+
+#define WRITE_SLAVE_FAMILY(name, type, help, expr)              \
+    do {                                                        \
+        metrics_write_family(w, name, type, help);              \
+        for (int i = 0; i < count; i++) {                       \
+            const slave_metrics_t *m = &slaves[i];              \
+            metrics_write_sample(w, name, m->labels, (expr));   \
+        }                                                       \
+    } while (0)
+
+    WRITE_SLAVE_FAMILY("bitaxe_cluster_slave_up", METRICS_GAUGE, "1 if the slave is active, 0 if stale", m->up);
+    WRITE_SLAVE_FAMILY("bitaxe_cluster_slave_hashrate_ghs", METRICS_GAUGE, "Reported slave hashrate", m->hashrate);
+    WRITE_SLAVE_FAMILY("bitaxe_cluster_slave_temperature_celsius", METRICS_GAUGE, "Slave ASIC temperature", m->temperature);
+    WRITE_SLAVE_FAMILY("bitaxe_cluster_slave_vr_temperature_celsius", METRICS_GAUGE, "Slave regulator temperature", m->vr_temp);
+    WRITE_SLAVE_FAMILY("bitaxe_cluster_slave_power_watts", METRICS_GAUGE, "Slave power draw", m->power);
+    WRITE_SLAVE_FAMILY("bitaxe_cluster_slave_fan_rpm", METRICS_GAUGE, "Slave fan speed", m->fan_rpm);
+    WRITE_SLAVE_FAMILY("bitaxe_cluster_slave_frequency_mhz", METRICS_GAUGE, "Slave ASIC frequency", m->frequency);
+
+    // Three results of one family, so they share a header
+    metrics_write_family(w, "bitaxe_cluster_slave_shares_total", METRICS_COUNTER, "Slave shares by result");
+    for (int i = 0; i < count; i++) {
+        const struct { const char *result; uint32_t value; } results[] = {
+            { "accepted", slaves[i].shares_accepted },
+            { "rejected", slaves[i].shares_rejected },
+            { "invalid",  slaves[i].shares_invalid },
+        };
+        for (int r = 0; r < 3; r++) {
+            char labels[sizeof(slaves[i].labels) + 24];
+            snprintf(labels, sizeof(labels), "%s,result=\"%s\"", slaves[i].labels, results[r].result);
+            metrics_write_sample(w, "bitaxe_cluster_slave_shares_total", labels, results[r].value);
         }
     }
-    // Not a cluster share, or already processed - that's fine
+
+#undef WRITE_SLAVE_FAMILY
 }
 
 #endif // CLUSTER_IS_MASTER
@@ -584,6 +710,13 @@ void cluster_slave_submit_to_asic(GlobalState *GLOBAL_STATE,
         return;
     }
 
+    // Slaves skip the stratum task, so their first job is the master's first work
+    static bool first_job_marked;
+    if (!first_job_marked) {
+        boot_timeline_mark(&GLOBAL_STATE->BOOT_TIMELINE, "first job", esp_timer_get_time());
+        first_job_marked = true;
+    }
+
     ESP_LOGI(TAG, "Converting cluster work to ASIC job: job=%lu, nonce=0x%08lX-0x%08lX",
              (unsigned long)work->job_id,
              (unsigned long)work->nonce_start,
@@ -759,6 +892,46 @@ void cluster_submit_work_to_asic(const cluster_work_t *work)
     cluster_slave_submit_to_asic(g_global_state, work);
 }
 
+// ============================================================================
+// Remote Settings (cluster_remote_config.c)
+// ============================================================================
+
+void cluster_get_asic_settings(uint16_t *freq_mhz, uint16_t *voltage_mv)
+{
+    *freq_mhz = (uint16_t)(nvs_config_get_float(NVS_CONFIG_ASIC_FREQUENCY) + 0.5f);
+    *voltage_mv = nvs_config_get_u16(NVS_CONFIG_ASIC_VOLTAGE);
+}
+
+esp_err_t cluster_set_asic_settings(uint16_t freq_mhz, uint16_t voltage_mv, bool persist)
+{
+    if (!g_global_state) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (persist) {
+        return cluster_autotune_apply_settings(freq_mhz, voltage_mv);
+    }
+
+    // Ramp step: straight to the hardware, voltage before frequency
+    VCORE_set_voltage(g_global_state, voltage_mv / 1000.0f);
+    ASIC_set_frequency(g_global_state, (float)freq_mhz);
+    return ESP_OK;
+}
+
+void cluster_get_fan_settings(bool *auto_fan, uint8_t *manual_percent, uint8_t *target_temp)
+{
+    *auto_fan = nvs_config_get_bool(NVS_CONFIG_AUTO_FAN_SPEED);
+    *manual_percent = (uint8_t)nvs_config_get_u16(NVS_CONFIG_MANUAL_FAN_SPEED);
+    *target_temp = (uint8_t)nvs_config_get_u16(NVS_CONFIG_TEMP_TARGET);
+}
+
+esp_err_t cluster_set_fan_settings(bool auto_fan, uint8_t manual_percent, uint8_t target_temp)
+{
+    nvs_config_set_u16(NVS_CONFIG_MANUAL_FAN_SPEED, manual_percent);
+    nvs_config_set_u16(NVS_CONFIG_TEMP_TARGET, target_temp);
+    nvs_config_set_bool(NVS_CONFIG_AUTO_FAN_SPEED, auto_fan);
+    return ESP_OK;
+}
+
 #endif // CLUSTER_IS_SLAVE
 
 // ============================================================================
@@ -767,12 +940,10 @@ void cluster_submit_work_to_asic(const cluster_work_t *work)
 
 void cluster_on_wifi_reconnect(void)
 {
-#if defined(CONFIG_CLUSTER_TRANSPORT_ESPNOW) || defined(CONFIG_CLUSTER_TRANSPORT_BOTH)
-    if (cluster_espnow_is_initialized()) {
-        cluster_espnow_on_wifi_reconnect();
+    if (cluster_transport_get_type() != CLUSTER_TRANSPORT_NONE) {
+        cluster_transport_on_wifi_reconnect();
         ESP_LOGI(TAG, "Cluster notified of WiFi reconnection");
     }
-#endif
 }
 
 GlobalState* cluster_get_global_state(void)
@@ -14,6 +14,7 @@
 
 #include "cluster.h"
 #include "cluster_config.h"
+#include "cluster_telemetry.h"
 #include "global_state.h"
 #include "stratum_api.h"
 
@@ -201,6 +202,38 @@ float cluster_get_power(void);
  */
 float cluster_get_voltage_in(void);
 
+/**
+ * @brief Get board stats beyond the heartbeat for binary telemetry
+ * (second sensor, VR temp, error rates, per-ASIC hashrate, queue depth)
+ */
+void cluster_get_board_telemetry(cluster_board_telemetry_t *board);
+
+/**
+ * @brief Get the frequency and core voltage the board is set to
+ *
+ * The set points, not the measured voltage of cluster_get_core_voltage().
+ */
+void cluster_get_asic_settings(uint16_t *freq_mhz, uint16_t *voltage_mv);
+
+/**
+ * @brief Set ASIC frequency and core voltage for a remote settings request
+ * @param persist Save as the board's settings; false for a ramp's
+ *                intermediate steps
+ */
+esp_err_t cluster_set_asic_settings(uint16_t freq_mhz, uint16_t voltage_mv, bool persist);
+
+/**
+ * @brief Get fan control settings
+ * @param manual_percent Fan speed used when auto_fan is off
+ * @param target_temp Chip temperature auto fan control holds
+ */
+void cluster_get_fan_settings(bool *auto_fan, uint8_t *manual_percent, uint8_t *target_temp);
+
+/**
+ * @brief Set fan control settings; the power management task picks them up
+ */
+esp_err_t cluster_set_fan_settings(bool auto_fan, uint8_t manual_percent, uint8_t target_temp);
+
 /**
  * @brief Submit work to ASIC (for slave mode)
  */
@@ -10,8 +10,17 @@
  */
 
 #include "cluster.h"
+#include "cluster_autotune.h"
+#include "cluster_clock.h"
 #include "cluster_protocol.h"
+#include "cluster_remote_config.h"
 #include "cluster_config.h"
+#include "cluster_index.h"
+#include "cluster_telemetry.h"
+#include "cluster_topology.h"
+#include "cluster_trace.h"
+#include "cluster_transport.h"
+#include "cluster_verify.h"
 #include "auto_timing.h"
 #include "esp_log.h"
 #include "esp_timer.h"
@@ -39,6 +48,20 @@ extern void stratum_submit_share_from_cluster(uint32_t job_id, uint32_t nonce,
 
 static cluster_master_state_t *g_master = NULL;
 
+// Telemetry decoder per slot (guarded by slaves_mutex)
+static cluster_telemetry_rx_t g_tlm_rx[CLUSTER_MAX_SLAVES];
+
+// Clock estimate per slot and the exchange waiting for the slave's t4
+// (guarded by slaves_mutex)
+typedef struct {
+    cluster_clock_t est;
+    int64_t         pending_t1;     // Slave stamp the last reply echoed
+    int64_t         pending_t2;     // When that frame arrived
+    int64_t         pending_t3;     // When the reply went out (0 = not yet)
+} clock_rx_t;
+
+static clock_rx_t g_clock_rx[CLUSTER_MAX_SLAVES];
+
 // ============================================================================
 // Nonce Range Management
 // ============================================================================
@@ -159,8 +182,16 @@ static esp_err_t send_work_to_slave(uint8_t slave_id, const cluster_work_t *work
         ESP_LOGW(TAG, "Failed to compute merkle root for slave %d pool %d - work may be invalid",
                  slave_id, slave_work.pool_id);
     }
+#if CLUSTER_SHARE_VERIFY
+    else {
+        // Keep the header so this slave's shares can be re-hashed before submission
+        cluster_work_header_t header;
+        cluster_verify_header_from_work(&slave_work, &header);
+        cluster_work_index_put(&header);
+    }
+#endif
 
-    // Use compact 250-byte buffer for ESP-NOW (skips optional display fields)
+    // Compact 250-byte buffer fits every transport (skips optional display fields)
     char payload[250];
     int len = cluster_protocol_encode_work(&slave_work, payload, sizeof(payload));
 
@@ -169,40 +200,12 @@ static esp_err_t send_work_to_slave(uint8_t slave_id, const cluster_work_t *work
         return ESP_FAIL;
     }
 
-    esp_err_t ret;
-
-#if defined(CONFIG_CLUSTER_TRANSPORT_ESPNOW) || defined(CONFIG_CLUSTER_TRANSPORT_BOTH)
-    // Always use ESP-NOW broadcast - unicast was unreliable
-    // Slaves filter by target_slave_id in the message
-    extern esp_err_t cluster_espnow_broadcast(const char *data, size_t len);
+    // Work is broadcast on the slave's transport (repeated on lossy ones);
+    // slaves filter by target_slave_id in the message
     ESP_LOGI(TAG, "Broadcasting work for slave %d (%d bytes, job %lu)",
              slave_id, len, (unsigned long)work->job_id);
-
-    // Send multiple times to improve reliability for larger messages
-    // ESP-NOW broadcast has no ACK, so we retry to increase delivery probability
-    ret = ESP_FAIL;
-    for (int attempt = 0; attempt < 3; attempt++) {
-        ret = cluster_espnow_broadcast(payload, len);
-        if (ret == ESP_OK) {
-            if (attempt == 0) {
-                ESP_LOGI(TAG, "ESP-NOW broadcast SUCCESS for slave %d", slave_id);
-            } else {
-                ESP_LOGI(TAG, "ESP-NOW broadcast SUCCESS for slave %d (attempt %d)", slave_id, attempt + 1);
-            }
-        } else {
-            ESP_LOGW(TAG, "ESP-NOW broadcast attempt %d FAILED for slave %d: %s",
-                     attempt + 1, slave_id, esp_err_to_name(ret));
-        }
-        // Small delay between retries
-        vTaskDelay(pdMS_TO_TICKS(20));
-    }
-#else
-    // Fall back to BAP UART broadcast
-    extern esp_err_t BAP_uart_send_raw(const char *data, size_t len);
-    ret = BAP_uart_send_raw(payload, len);
-    ESP_LOGI(TAG, "Sent work via UART broadcast to slave %d (job %lu)",
-             slave_id, (unsigned long)work->job_id);
-#endif
+    cluster_trace_record(CLUSTER_TRACE_DISTRIBUTE, slave_id, work->job_id, 0);
+    esp_err_t ret = cluster_transport_send_work(slave->mac_addr, payload, len);
 
     if (ret == ESP_OK) {
         slave->last_work_sent = esp_timer_get_time() / 1000;
@@ -266,40 +269,6 @@ esp_err_t cluster_master_distribute_work(const cluster_work_t *work)
 // Share Handling
 // ============================================================================
 
-/**
- * @brief Simple deduplication buffer for recent shares
- */
-#define RECENT_SHARES_SIZE 32
-static struct {
-    uint32_t nonce;
-    uint32_t job_id;
-    uint8_t slave_id;
-    bool valid;
-} recent_shares[RECENT_SHARES_SIZE];
-static int recent_shares_idx = 0;
-
-static bool is_duplicate_share(const cluster_share_t *share)
-{
-    for (int i = 0; i < RECENT_SHARES_SIZE; i++) {
-        if (recent_shares[i].valid &&
-            recent_shares[i].nonce == share->nonce &&
-            recent_shares[i].job_id == share->job_id &&
-            recent_shares[i].slave_id == share->slave_id) {
-            return true;
-        }
-    }
-    return false;
-}
-
-static void record_share(const cluster_share_t *share)
-{
-    recent_shares[recent_shares_idx].nonce = share->nonce;
-    recent_shares[recent_shares_idx].job_id = share->job_id;
-    recent_shares[recent_shares_idx].slave_id = share->slave_id;
-    recent_shares[recent_shares_idx].valid = true;
-    recent_shares_idx = (recent_shares_idx + 1) % RECENT_SHARES_SIZE;
-}
-
 /**
  * @brief Receive and queue share from slave
  */
@@ -309,26 +278,29 @@ esp_err_t cluster_master_receive_share(const cluster_share_t *share)
         return ESP_ERR_INVALID_ARG;
     }
 
-    // Validate slave ID
-    if (share->slave_id >= CLUSTER_MAX_SLAVES) {
+    // Validate node address (shares from behind a relay count against the relay's slot)
+    uint16_t slot = CLUSTER_NODE_SLOT(share->slave_id);
+    if (slot >= CLUSTER_MAX_SLAVES) {
         ESP_LOGW(TAG, "Share from invalid slave ID: %d", share->slave_id);
         return ESP_ERR_INVALID_ARG;
     }
 
-    // Check for duplicate share
-    if (is_duplicate_share(share)) {
+    cluster_trace_record(CLUSTER_TRACE_SHARE_RX, share->slave_id, share->job_id, share->nonce);
+
+    // Check for duplicate share (also records it for future checks)
+    if (cluster_share_dedup_check_and_record(share->slave_id, share->pool_id,
+                                             share->job_id, share->nonce)) {
+        cluster_trace_record(CLUSTER_TRACE_DROP_DUPLICATE, share->slave_id,
+                             share->job_id, share->nonce);
         ESP_LOGD(TAG, "Ignoring duplicate share from slave %d (nonce 0x%08lX)",
                  share->slave_id, (unsigned long)share->nonce);
         return ESP_OK;  // Not an error, just ignore
     }
 
-    // Record this share to prevent future duplicates
-    record_share(share);
-
     // Update slave stats
     xSemaphoreTake(g_master->slaves_mutex, portMAX_DELAY);
-    g_master->slaves[share->slave_id].shares_submitted++;
-    g_master->slaves[share->slave_id].last_seen = esp_timer_get_time() / 1000;
+    g_master->slaves[slot].shares_submitted++;
+    g_master->slaves[slot].last_seen = esp_timer_get_time() / 1000;
     xSemaphoreGive(g_master->slaves_mutex);
 
     // Queue for submission to pool
@@ -348,6 +320,53 @@ esp_err_t cluster_master_receive_share(const cluster_share_t *share)
     return ESP_OK;
 }
 
+/**
+ * @brief Re-hash a share against the work its slave was given
+ *
+ * Counts failures against the slave's slot. Shares whose work is no longer
+ * indexed, or that arrive while the submit queue is backed up, pass
+ * unverified.
+ *
+ * @return false if the share should be dropped
+ */
+static bool verify_share(const cluster_share_t *share)
+{
+#if CLUSTER_SHARE_VERIFY
+    cluster_work_header_t header;
+    bool verify = uxQueueMessagesWaiting(g_master->share_queue) <= CLUSTER_SHARE_VERIFY_MAX_BACKLOG &&
+                  cluster_work_index_get(share->job_id, share->pool_id, share->extranonce2,
+                                         share->extranonce2_len, &header);
+    if (!verify) {
+        g_master->shares_unverified++;
+        return true;
+    }
+
+    double difficulty = 0;
+    cluster_verify_result_t result = cluster_verify_share(&header, share, &difficulty);
+    if (result == CLUSTER_VERIFY_OK) {
+        return true;
+    }
+
+    xSemaphoreTake(g_master->slaves_mutex, portMAX_DELAY);
+    g_master->slaves[CLUSTER_NODE_SLOT(share->slave_id)].shares_invalid++;
+    g_master->shares_invalid++;
+    xSemaphoreGive(g_master->slaves_mutex);
+
+    ESP_LOGW(TAG, "Invalid share from node 0x%04X (job %lu, nonce 0x%08lX): %s, diff %.1f of %lu%s",
+             share->slave_id, (unsigned long)share->job_id, (unsigned long)share->nonce,
+             cluster_verify_result_name(result), difficulty, (unsigned long)header.pool_diff,
+             CLUSTER_SHARE_VERIFY == CLUSTER_SHARE_VERIFY_DROP ? ", dropped" : "");
+
+    if (CLUSTER_SHARE_VERIFY != CLUSTER_SHARE_VERIFY_DROP) {
+        return true;
+    }
+    cluster_trace_record(CLUSTER_TRACE_DROP_INVALID, share->slave_id, share->job_id, share->nonce);
+    return false;
+#else
+    return true;
+#endif
+}
+
 /**
  * @brief Task: Submit queued shares to stratum pool
  */
@@ -359,8 +378,29 @@ static void share_submitter_task(void *pvParameters)
 
     while (1) {
         if (xQueueReceive(g_master->share_queue, &share, portMAX_DELAY) == pdTRUE) {
+            // Shares replayed after an uplink outage may be for jobs the
+            // pool has already moved past; don't spend a submit on them
+            cluster_share_status_t status = cluster_job_index_check_share(share.job_id,
+                                                                          share.pool_id,
+                                                                          share.ntime);
+            if (status != CLUSTER_SHARE_CURRENT) {
+                ESP_LOGW(TAG, "Dropping stale share from node 0x%04X (job %lu, ntime %lu): %s",
+                         share.slave_id, (unsigned long)share.job_id,
+                         (unsigned long)share.ntime, cluster_share_status_name(status));
+                cluster_trace_record(CLUSTER_TRACE_DROP_STALE, share.slave_id,
+                                     share.job_id, share.nonce);
+                continue;
+            }
+
+            if (!verify_share(&share)) {
+                continue;
+            }
+
+            cluster_trace_record(CLUSTER_TRACE_SUBMIT, share.slave_id, share.job_id, share.nonce);
+
             // Submit to pool via existing stratum infrastructure
-            // Pass slave_id so we can update the correct slave's counter when pool responds
+            // Pass the slot so we can update the correct slave's counter when pool responds
+            // (relayed shares are credited to the relay's slot)
             // Pass pool_id so share is routed to correct pool in dual pool mode
             stratum_submit_share_from_cluster(share.job_id,
                                                share.nonce,
@@ -368,7 +408,7 @@ static void share_submitter_task(void *pvParameters)
                                                share.extranonce2_len,
                                                share.ntime,
                                                share.version,
-                                               share.slave_id,
+                                               (uint8_t)CLUSTER_NODE_SLOT(share.slave_id),
                                                share.pool_id);
 
             ESP_LOGD(TAG, "Submitted share from slave %d to pool %d", share.slave_id, share.pool_id);
@@ -451,9 +491,18 @@ static esp_err_t handle_registration_internal(const char *hostname,
 
     slave->last_heartbeat = esp_timer_get_time() / 1000;
     slave->last_seen = slave->last_heartbeat;
+    slave->telemetry = false;
+    cluster_telemetry_rx_reset(&g_tlm_rx[slot]);
+    // Possibly rebooted: its clock starts over
+    memset(&g_clock_rx[slot], 0, sizeof(g_clock_rx[slot]));
+    slave->clock_synced = false;
+    slave->clock_offset_us = 0;
+    slave->clock_drift_ppb = 0;
+    slave->clock_delay_us = 0;
     slave->shares_submitted = 0;
     slave->shares_accepted = 0;
     slave->shares_rejected = 0;
+    slave->shares_invalid = 0;
     // Initialize per-pool counters
     slave->shares_accepted_primary = 0;
     slave->shares_rejected_primary = 0;
@@ -469,16 +518,9 @@ static esp_err_t handle_registration_internal(const char *hostname,
     int len = cluster_protocol_encode_ack(slot, hostname, ack_payload, sizeof(ack_payload));
 
     if (len > 0) {
-        // Send ACK directly to this slave via ESP-NOW if we have their MAC
-#if defined(CONFIG_CLUSTER_TRANSPORT_ESPNOW) || defined(CONFIG_CLUSTER_TRANSPORT_BOTH)
-        if (mac_addr) {
-            extern esp_err_t cluster_espnow_send(const uint8_t *dest_mac, const char *data, size_t len);
-            cluster_espnow_send(mac_addr, ack_payload, len);
-        } else
-#endif
-        {
-            extern esp_err_t BAP_uart_send_raw(const char *data, size_t len);
-            BAP_uart_send_raw(ack_payload, len);
+        // Send ACK directly to this slave if we have their MAC
+        if (!mac_addr || cluster_transport_send(mac_addr, ack_payload, len) != ESP_OK) {
+            cluster_transport_broadcast(ack_payload, len);
         }
     }
 
@@ -492,6 +534,9 @@ static esp_err_t handle_registration_internal(const char *hostname,
         send_work_to_slave(slot, &g_master->current_work);
     }
 
+    // It boots with whatever its NVS holds: move it to its profile for the room
+    cluster_autotune_profile_slave_joined(slot);
+
     return ESP_OK;
 }
 
@@ -515,23 +560,10 @@ esp_err_t cluster_master_handle_registration_with_mac(const char *hostname,
 }
 
 /**
- * @brief Handle slave heartbeat with extended data
+ * @brief Apply reported stats to a slave entry (slaves_mutex held)
  */
-esp_err_t cluster_master_handle_heartbeat_ex(const cluster_heartbeat_data_t *data)
+static void update_slave_stats(cluster_slave_t *slave, const cluster_heartbeat_data_t *data)
 {
-    if (!g_master || !data || data->slave_id >= CLUSTER_MAX_SLAVES) {
-        ESP_LOGW(TAG, "Invalid heartbeat: g_master=%p, data=%p, slave_id=%d",
-                 g_master, data, data ? data->slave_id : -1);
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    ESP_LOGI(TAG, "Received heartbeat from slave %d: hashrate=%lu, temp=%.1f",
-             data->slave_id, (unsigned long)data->hashrate, data->temp);
-
-    xSemaphoreTake(g_master->slaves_mutex, portMAX_DELAY);
-
-    cluster_slave_t *slave = &g_master->slaves[data->slave_id];
-
     if (slave->state == SLAVE_STATE_DISCONNECTED) {
         // Slave was disconnected but is sending heartbeats again - recover it
         ESP_LOGI(TAG, "Recovering disconnected slave %d via heartbeat", data->slave_id);
@@ -554,19 +586,245 @@ esp_err_t cluster_master_handle_heartbeat_ex(const cluster_heartbeat_data_t *dat
     slave->power = data->power;
     slave->voltage_in = data->voltage_in;
 
+    // Relays report the nodes behind them (hashrate/power above are aggregated)
+    slave->downstream_count = data->nodes;
+
     if (slave->state == SLAVE_STATE_STALE) {
         slave->state = SLAVE_STATE_ACTIVE;
         ESP_LOGI(TAG, "Slave %d recovered from stale state", data->slave_id);
     }
+}
 
-    xSemaphoreGive(g_master->slaves_mutex);
+/**
+ * @brief Take the clock stamps of a slave frame (slaves_mutex held)
+ *
+ * Completes the previous exchange if the slave echoes our last reply, and
+ * opens a new one if the frame carries a t1; its t3 is set by
+ * clock_reply_sent() once the reply is built.
+ *
+ * @param rx_us When the frame arrived (t2)
+ * @return Stamp to echo in the reply, 0 for none
+ */
+static int64_t clock_on_rx(cluster_slave_t *slave, uint8_t slot,
+                           const cluster_clock_stamp_t *stamp, int64_t rx_us)
+{
+    if (!stamp) {
+        return 0;
+    }
+
+    clock_rx_t *c = &g_clock_rx[slot];
+
+    if (stamp->echo_t1 != 0 && stamp->echo_t1 == c->pending_t1 && c->pending_t3 != 0) {
+        if (cluster_clock_add_sample(&c->est, c->pending_t1, c->pending_t2,
+                                     c->pending_t3, stamp->echo_t4) == ESP_OK) {
+            slave->clock_synced = c->est.synced;
+            slave->clock_offset_us = cluster_clock_to_node(&c->est, rx_us) - rx_us;
+            slave->clock_drift_ppb = c->est.drift_ppb;
+            slave->clock_delay_us = c->est.delay_us;
+        }
+    }
+
+    // Unstamped frames leave the open exchange alone
+    if (stamp->t1 == 0) {
+        return 0;
+    }
+
+    c->pending_t1 = stamp->t1;
+    c->pending_t2 = rx_us;
+    c->pending_t3 = 0;
+    return stamp->t1;
+}
+
+/**
+ * @brief Record t3 for the reply about to be sent (slaves_mutex held)
+ */
+static void clock_reply_sent(uint8_t slot, int64_t echo_t1)
+{
+    if (echo_t1 != 0 && g_clock_rx[slot].pending_t1 == echo_t1) {
+        g_clock_rx[slot].pending_t3 = esp_timer_get_time();
+    }
+}
+
+/**
+ * @brief Handle slave heartbeat with extended data
+ */
+esp_err_t cluster_master_handle_heartbeat_ex(const cluster_heartbeat_data_t *data)
+{
+    int64_t rx_us = esp_timer_get_time();
+
+    if (!g_master || !data || data->slave_id >= CLUSTER_MAX_SLAVES) {
+        ESP_LOGW(TAG, "Invalid heartbeat: g_master=%p, data=%p, slave_id=%d",
+                 g_master, data, data ? data->slave_id : -1);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ESP_LOGI(TAG, "Received heartbeat from slave %d: hashrate=%lu, temp=%.1f",
+             data->slave_id, (unsigned long)data->hashrate, data->temp);
+
+    xSemaphoreTake(g_master->slaves_mutex, portMAX_DELAY);
+
+    cluster_slave_t *slave = &g_master->slaves[data->slave_id];
+    uint8_t slave_mac[6];
+    memcpy(slave_mac, slave->mac_addr, sizeof(slave_mac));
+
+    update_slave_stats(slave, data);
+    int64_t echo_t1 = clock_on_rx(slave, data->slave_id, &data->clock, rx_us);
 
-    // Send heartbeat response
+    // Send heartbeat response; it carries the clock echo, so t3 is taken
+    // just before it goes out
     char response[64];
-    int len = cluster_protocol_encode_heartbeat(data->slave_id, 0, 0, 0, 0, response, sizeof(response));
+    int len = cluster_protocol_encode_heartbeat_reply(data->slave_id, echo_t1, response, sizeof(response));
+    clock_reply_sent(data->slave_id, echo_t1);
+
+    xSemaphoreGive(g_master->slaves_mutex);
+
     if (len > 0) {
-        extern esp_err_t BAP_uart_send_raw(const char *data, size_t len);
-        BAP_uart_send_raw(response, len);
+        cluster_transport_broadcast_to(slave_mac, response, len);
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Handle a binary telemetry frame from a slave
+ *
+ * Decodes against the slot's acknowledged references, applies the stats
+ * like a heartbeat and answers with $CLTAK - a positive ack for keyframes
+ * and for frames with a clock stamp, at most once per heartbeat interval
+ * otherwise (it doubles as the heartbeat reply), or a NAK when the delta's
+ * reference is unknown.
+ */
+esp_err_t cluster_master_handle_telemetry(uint16_t slave_id, const uint8_t *frame, size_t len,
+                                          const cluster_clock_stamp_t *clock)
+{
+    int64_t rx_us = esp_timer_get_time();
+
+    if (!g_master || !frame || slave_id >= CLUSTER_MAX_SLAVES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(g_master->slaves_mutex, portMAX_DELAY);
+
+    cluster_slave_t *slave = &g_master->slaves[slave_id];
+    cluster_telemetry_rx_t *rx = &g_tlm_rx[slave_id];
+    uint8_t slave_mac[6];
+    memcpy(slave_mac, slave->mac_addr, sizeof(slave_mac));
+
+    uint8_t seq = 0;
+    bool keyframe = false;
+    esp_err_t ret = cluster_telemetry_decode(rx, frame, len, &seq, &keyframe);
+    bool ack = false;
+    int64_t echo_t1 = 0;
+
+    if (ret == ESP_OK) {
+        const cluster_telemetry_t *tlm = &rx->current;
+        cluster_heartbeat_data_t hb;
+        cluster_telemetry_to_heartbeat(tlm, slave_id, &hb);
+        update_slave_stats(slave, &hb);
+
+        slave->telemetry = true;
+        slave->chip_temp2 = tlm->v[CLUSTER_TLM_TEMP2] / 10.0f;
+        slave->vr_temp = tlm->v[CLUSTER_TLM_VR_TEMP] / 10.0f;
+        slave->fan2_rpm = (uint16_t)(tlm->v[CLUSTER_TLM_FAN2] * 10);
+        slave->error_percent = tlm->v[CLUSTER_TLM_ERROR] / 100.0f;
+        slave->asic_queue = (uint8_t)tlm->v[CLUSTER_TLM_ASIC_QUEUE];
+        slave->share_queue = (uint8_t)tlm->v[CLUSTER_TLM_SHARE_QUEUE];
+        slave->asic_count = (uint8_t)tlm->v[CLUSTER_TLM_ASIC_COUNT];
+        if (slave->asic_count > CLUSTER_TELEMETRY_MAX_ASICS) {
+            slave->asic_count = CLUSTER_TELEMETRY_MAX_ASICS;
+        }
+        for (int i = 0; i < CLUSTER_TELEMETRY_MAX_ASICS; i++) {
+            slave->asic_hashrate[i] = (float)tlm->v[CLUSTER_TLM_ASIC_HASHRATE + i];
+            slave->asic_error[i] = tlm->v[CLUSTER_TLM_ASIC_ERROR + i] / 100.0f;
+        }
+
+        // The slave waits for the echo of a clock stamp: always answer those
+        echo_t1 = clock_on_rx(slave, (uint8_t)slave_id, clock, rx_us);
+        ack = cluster_telemetry_rx_ack_due(rx, keyframe || echo_t1 != 0, slave->last_heartbeat,
+                                           CLUSTER_HEARTBEAT_MS);
+    }
+
+    char response[64];
+    int rlen = -1;
+    if (ack || ret == ESP_ERR_NOT_FOUND) {
+        rlen = cluster_protocol_encode_telemetry_ack(slave_id, seq, ret == ESP_OK, echo_t1,
+                                                     response, sizeof(response));
+        clock_reply_sent((uint8_t)slave_id, echo_t1);
+    }
+
+    xSemaphoreGive(g_master->slaves_mutex);
+
+    if (ret != ESP_OK && ret != ESP_ERR_NOT_FOUND) {
+        ESP_LOGW(TAG, "Bad telemetry frame from slave %d: %s", slave_id, esp_err_to_name(ret));
+        return ret;
+    }
+
+    if (ret == ESP_ERR_NOT_FOUND) {
+        ESP_LOGD(TAG, "Telemetry from slave %d references an unknown frame, requesting keyframe",
+                 slave_id);
+    }
+
+    if (rlen > 0) {
+        cluster_transport_broadcast_to(slave_mac, response, rlen);
+    }
+
+    return ret;
+}
+
+esp_err_t cluster_master_to_master_time(uint8_t slot, int64_t node_us, int64_t *master_us)
+{
+    if (!g_master || !master_us || slot >= CLUSTER_MAX_SLAVES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(g_master->slaves_mutex, portMAX_DELAY);
+    bool synced = g_clock_rx[slot].est.synced;
+    if (synced) {
+        *master_us = cluster_clock_to_master(&g_clock_rx[slot].est, node_us);
+    }
+    xSemaphoreGive(g_master->slaves_mutex);
+
+    return synced ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+/**
+ * @brief Store trace records uploaded by a slave, on the master's clock
+ *
+ * Records from a slave whose clock is not mapped yet keep the slave's
+ * timestamps and are flagged so timelines and latencies can skip them.
+ */
+esp_err_t cluster_master_handle_trace(uint16_t node, uint32_t lost,
+                                      const uint8_t *records, size_t len)
+{
+    uint16_t slot = CLUSTER_NODE_SLOT(node);
+    if (!g_master || !records || slot >= CLUSTER_MAX_SLAVES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    cluster_trace_record_t recs[CLUSTER_TRACE_UPLOAD_RECORDS];
+    int count = cluster_trace_unpack(records, len, recs, CLUSTER_TRACE_UPLOAD_RECORDS);
+    if (count < 0) {
+        ESP_LOGW(TAG, "Bad trace records from node 0x%04X", node);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    xSemaphoreTake(g_master->slaves_mutex, portMAX_DELAY);
+    const cluster_clock_t *clk = &g_clock_rx[slot].est;
+    for (int i = 0; i < count; i++) {
+        if (clk->synced) {
+            recs[i].ts_us = cluster_clock_to_master(clk, recs[i].ts_us);
+        } else {
+            recs[i].flags |= CLUSTER_TRACE_F_UNSYNCED;
+        }
+    }
+    xSemaphoreGive(g_master->slaves_mutex);
+
+    for (int i = 0; i < count; i++) {
+        cluster_trace_put(&recs[i]);
+    }
+    if (lost) {
+        cluster_trace_add_lost(lost);
+        ESP_LOGD(TAG, "Node 0x%04X dropped %lu trace records", node, (unsigned long)lost);
     }
 
     return ESP_OK;
@@ -745,6 +1003,8 @@ void cluster_master_get_stats(cluster_stats_t *stats, uint8_t *active_slaves)
     if (stats) {
         stats->total_hashrate = g_master->total_hashrate;
         stats->total_shares = g_master->total_shares;
+        stats->total_shares_invalid = g_master->shares_invalid;
+        stats->total_shares_unverified = g_master->shares_unverified;
 
         // Calculate accepted/rejected from all slaves (total and per-pool)
         stats->total_shares_accepted = 0;
@@ -776,6 +1036,27 @@ void cluster_master_get_stats(cluster_stats_t *stats, uint8_t *active_slaves)
     xSemaphoreGive(g_master->slaves_mutex);
 }
 
+uint8_t cluster_master_get_free_slots(void)
+{
+    if (!g_master) {
+        return 0;
+    }
+
+    if (xSemaphoreTake(g_master->slaves_mutex, pdMS_TO_TICKS(50)) != pdTRUE) {
+        return CLUSTER_BEACON_FREE_UNKNOWN;
+    }
+
+    uint8_t free_slots = 0;
+    for (int i = 0; i < CLUSTER_MAX_SLAVES; i++) {
+        if (g_master->slaves[i].state == SLAVE_STATE_DISCONNECTED) {
+            free_slots++;
+        }
+    }
+
+    xSemaphoreGive(g_master->slaves_mutex);
+    return free_slots;
+}
+
 esp_err_t cluster_master_get_slave(uint8_t slave_id, cluster_slave_t *slave)
 {
     if (!g_master || !slave || slave_id >= CLUSTER_MAX_SLAVES) {
@@ -861,9 +1142,8 @@ void cluster_master_broadcast_timing(uint16_t interval_ms)
         return;
     }
 
-    // Send via ESP-NOW broadcast to all slaves
-    extern esp_err_t cluster_espnow_broadcast(const char *data, size_t len);
-    esp_err_t ret = cluster_espnow_broadcast(buffer, len);
+    // Broadcast to all slaves on every transport
+    esp_err_t ret = cluster_transport_broadcast(buffer, len);
     if (ret == ESP_OK) {
         ESP_LOGI(TAG, "Broadcast timing interval: %u ms to all slaves", interval_ms);
     } else {
@@ -895,6 +1175,18 @@ esp_err_t cluster_master_init(cluster_master_state_t *state)
         return ESP_ERR_NO_MEM;
     }
 
+    // Job mapping, share dedup and pending-submit indexes
+    esp_err_t ret = cluster_index_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // Settings requests to slaves
+    ret = cluster_remote_config_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
     // Clear slave array
     memset(g_master->slaves, 0, sizeof(g_master->slaves));
     g_master->slave_count = 0;
@@ -939,6 +1231,9 @@ void cluster_master_deinit(void)
         vQueueDelete(g_master->share_queue);
     }
 
+    cluster_index_deinit();
+    cluster_remote_config_deinit();
+
     g_master->initialized = false;
     g_master = NULL;
 
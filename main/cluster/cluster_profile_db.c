@@ -0,0 +1,271 @@
+/**
+ * @file cluster_profile_db.c
+ * @brief ClusterAxe temperature-indexed autotune profile database
+ *
+ * Blob layout (little-endian):
+ *
+ *   header  'P' version count bucket_c
+ *   entry   mac[6] asic_id:2 board[6] mode:1 temp_c:1 freq:2 voltage:2
+ *           efficiency:2 (0.01 J/TH) hashrate:2 (GH/s) saved_at:4
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#include "cluster_profile_db.h"
+#include <math.h>
+#include <string.h>
+
+#define PROFILE_DB_MAGIC    'P'
+#define PROFILE_DB_VERSION  1
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static void put_le(uint8_t *p, uint32_t v, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static uint32_t get_le(const uint8_t *p, int bytes)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < bytes; i++) {
+        v |= (uint32_t)p[i] << (8 * i);
+    }
+    return v;
+}
+
+static int8_t bucket_of(const profile_db_t *db, float ambient_c)
+{
+    float b = roundf(ambient_c / db->bucket_c) * db->bucket_c;
+    return (int8_t)(b < -120 ? -120 : b > 120 ? 120 : b);
+}
+
+static bool matches(const profile_entry_t *e, const profile_device_t *device, autotune_mode_t mode)
+{
+    return e->mode == mode && cluster_profile_db_same_device(&e->device, device);
+}
+
+static uint16_t round_down(float v, uint8_t step)
+{
+    return step ? (uint16_t)(floorf(v / step + 1e-3f) * step) : (uint16_t)v;
+}
+
+static uint16_t round_up(float v, uint8_t step)
+{
+    return step ? (uint16_t)(ceilf(v / step - 1e-3f) * step) : (uint16_t)ceilf(v);
+}
+
+// ============================================================================
+// API
+// ============================================================================
+
+void cluster_profile_db_init(profile_db_t *db, uint8_t bucket_c, uint8_t max_extrapolate_c,
+                             uint8_t freq_step_mhz, uint8_t voltage_step_mv)
+{
+    memset(db, 0, sizeof(*db));
+    db->bucket_c = bucket_c ? bucket_c : 1;
+    db->max_extrapolate_c = max_extrapolate_c;
+    db->freq_step_mhz = freq_step_mhz;
+    db->voltage_step_mv = voltage_step_mv;
+}
+
+bool cluster_profile_db_same_device(const profile_device_t *a, const profile_device_t *b)
+{
+    if (memcmp(a->mac, b->mac, sizeof(a->mac)) != 0) {
+        return false;
+    }
+    if (a->asic_id && b->asic_id && a->asic_id != b->asic_id) {
+        return false;
+    }
+    if (a->board[0] && b->board[0] && strncmp(a->board, b->board, sizeof(a->board)) != 0) {
+        return false;
+    }
+    return true;
+}
+
+int cluster_profile_db_record(profile_db_t *db, const profile_device_t *device, autotune_mode_t mode,
+                              float ambient_c, uint16_t freq_mhz, uint16_t voltage_mv,
+                              float efficiency, float hashrate, uint32_t saved_at)
+{
+    int8_t bucket = bucket_of(db, ambient_c);
+
+    int slot = -1;
+    for (int i = 0; i < db->count; i++) {
+        if (matches(&db->entries[i], device, mode) && db->entries[i].temp_c == bucket) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0 && db->count < CLUSTER_PROFILE_DB_MAX_ENTRIES) {
+        slot = db->count++;
+    }
+    if (slot < 0) {
+        // Full: the oldest lock makes room
+        slot = 0;
+        for (int i = 1; i < db->count; i++) {
+            if (db->entries[i].saved_at < db->entries[slot].saved_at) {
+                slot = i;
+            }
+        }
+    }
+
+    profile_entry_t *e = &db->entries[slot];
+    *e = (profile_entry_t){
+        .device = *device,
+        .mode = mode,
+        .temp_c = bucket,
+        .freq_mhz = freq_mhz,
+        .voltage_mv = voltage_mv,
+        .efficiency = efficiency,
+        .hashrate = hashrate,
+        .saved_at = saved_at,
+    };
+    return slot;
+}
+
+esp_err_t cluster_profile_db_lookup(const profile_db_t *db, const profile_device_t *device,
+                                    autotune_mode_t mode, float ambient_c, profile_match_t *match)
+{
+    // Nearest bucket at or below, and at or above
+    const profile_entry_t *lower = NULL, *upper = NULL;
+    for (int i = 0; i < db->count; i++) {
+        const profile_entry_t *e = &db->entries[i];
+        if (!matches(e, device, mode)) {
+            continue;
+        }
+        if (e->temp_c <= ambient_c && (!lower || e->temp_c > lower->temp_c)) {
+            lower = e;
+        }
+        if (e->temp_c >= ambient_c && (!upper || e->temp_c < upper->temp_c)) {
+            upper = e;
+        }
+    }
+
+    if (lower && upper && lower != upper && upper->temp_c != lower->temp_c) {
+        float t = (ambient_c - lower->temp_c) / (float)(upper->temp_c - lower->temp_c);
+        float freq = lower->freq_mhz + t * (upper->freq_mhz - lower->freq_mhz);
+        float voltage = lower->voltage_mv + t * (upper->voltage_mv - lower->voltage_mv);
+        // Never below the line between the two in voltage, nor above it in frequency
+        *match = (profile_match_t){
+            .freq_mhz = round_down(freq, db->freq_step_mhz),
+            .voltage_mv = round_up(voltage, db->voltage_step_mv),
+            .lower_c = lower->temp_c,
+            .upper_c = upper->temp_c,
+            .interpolated = true,
+        };
+        return ESP_OK;
+    }
+
+    const profile_entry_t *only = upper ? upper : lower;
+    if (!only) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    // Warmer than every bucket: the chip needs more than it was tuned for
+    if (!upper && ambient_c - lower->temp_c > db->max_extrapolate_c) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *match = (profile_match_t){
+        .freq_mhz = only->freq_mhz,
+        .voltage_mv = only->voltage_mv,
+        .lower_c = only->temp_c,
+        .upper_c = only->temp_c,
+        .interpolated = false,
+    };
+    return ESP_OK;
+}
+
+const profile_entry_t *cluster_profile_db_latest(const profile_db_t *db, const profile_device_t *device)
+{
+    // Later entries win ties (locks made before the clock was set)
+    const profile_entry_t *latest = NULL;
+    for (int i = 0; i < db->count; i++) {
+        const profile_entry_t *e = &db->entries[i];
+        if (cluster_profile_db_same_device(&e->device, device) && (!latest || e->saved_at >= latest->saved_at)) {
+            latest = e;
+        }
+    }
+    return latest;
+}
+
+int cluster_profile_db_forget(profile_db_t *db, const profile_device_t *device)
+{
+    int kept = 0;
+    for (int i = 0; i < db->count; i++) {
+        if (device && !cluster_profile_db_same_device(&db->entries[i].device, device)) {
+            db->entries[kept++] = db->entries[i];
+        }
+    }
+    int removed = db->count - kept;
+    db->count = kept;
+    return removed;
+}
+
+int cluster_profile_db_encode(const profile_db_t *db, uint8_t *buf, size_t len)
+{
+    size_t need = CLUSTER_PROFILE_DB_HEADER_SIZE + (size_t)db->count * CLUSTER_PROFILE_DB_ENTRY_SIZE;
+    if (len < need) {
+        return -1;
+    }
+
+    buf[0] = PROFILE_DB_MAGIC;
+    buf[1] = PROFILE_DB_VERSION;
+    buf[2] = db->count;
+    buf[3] = db->bucket_c;
+
+    uint8_t *p = buf + CLUSTER_PROFILE_DB_HEADER_SIZE;
+    for (int i = 0; i < db->count; i++, p += CLUSTER_PROFILE_DB_ENTRY_SIZE) {
+        const profile_entry_t *e = &db->entries[i];
+        float efficiency = e->efficiency * 100.0f + 0.5f;
+        float hashrate = e->hashrate + 0.5f;
+        memcpy(p, e->device.mac, 6);
+        put_le(p + 6, e->device.asic_id, 2);
+        memcpy(p + 8, e->device.board, CLUSTER_PROFILE_DB_BOARD_LEN);
+        p[14] = (uint8_t)e->mode;
+        p[15] = (uint8_t)e->temp_c;
+        put_le(p + 16, e->freq_mhz, 2);
+        put_le(p + 18, e->voltage_mv, 2);
+        put_le(p + 20, efficiency < 0 ? 0 : efficiency > 65535 ? 65535 : (uint32_t)efficiency, 2);
+        put_le(p + 22, hashrate < 0 ? 0 : hashrate > 65535 ? 65535 : (uint32_t)hashrate, 2);
+        put_le(p + 24, e->saved_at, 4);
+    }
+    return (int)need;
+}
+
+esp_err_t cluster_profile_db_decode(profile_db_t *db, const uint8_t *buf, size_t len)
+{
+    if (len < CLUSTER_PROFILE_DB_HEADER_SIZE || buf[0] != PROFILE_DB_MAGIC) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (buf[1] != PROFILE_DB_VERSION) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    uint8_t count = buf[2];
+    if (count > CLUSTER_PROFILE_DB_MAX_ENTRIES ||
+        len < CLUSTER_PROFILE_DB_HEADER_SIZE + (size_t)count * CLUSTER_PROFILE_DB_ENTRY_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const uint8_t *p = buf + CLUSTER_PROFILE_DB_HEADER_SIZE;
+    for (int i = 0; i < count; i++, p += CLUSTER_PROFILE_DB_ENTRY_SIZE) {
+        profile_entry_t *e = &db->entries[i];
+        memset(e, 0, sizeof(*e));
+        memcpy(e->device.mac, p, 6);
+        e->device.asic_id = (uint16_t)get_le(p + 6, 2);
+        memcpy(e->device.board, p + 8, CLUSTER_PROFILE_DB_BOARD_LEN);
+        e->device.board[CLUSTER_PROFILE_DB_BOARD_LEN - 1] = '\0';
+        e->mode = (autotune_mode_t)p[14];
+        e->temp_c = (int8_t)p[15];
+        e->freq_mhz = (uint16_t)get_le(p + 16, 2);
+        e->voltage_mv = (uint16_t)get_le(p + 18, 2);
+        e->efficiency = get_le(p + 20, 2) / 100.0f;
+        e->hashrate = (float)get_le(p + 22, 2);
+        e->saved_at = get_le(p + 24, 4);
+    }
+    db->count = count;
+    return ESP_OK;
+}
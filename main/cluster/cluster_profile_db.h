@@ -0,0 +1,142 @@
+/**
+ * @file cluster_profile_db.h
+ * @brief ClusterAxe temperature-indexed autotune profile database
+ *
+ * Every autotune lock is remembered per device, mode and ambient
+ * temperature bucket:
+ *
+ *   device (MAC, ASIC chip id, board version) x mode x bucket -> point
+ *
+ * When the room warms or cools, the point for the new temperature is
+ * interpolated between the two nearest buckets instead of tuning again.
+ * Voltage is rounded up and frequency down, so an interpolated point keeps
+ * at least the margin of the line between its neighbours. Colder than every
+ * bucket, the coldest point is used (it only has more margin); warmer than
+ * every bucket, the warmest only within max_extrapolate_c.
+ *
+ * The database is kept as one compact little-endian blob (a 4-byte header
+ * and CLUSTER_PROFILE_DB_ENTRY_SIZE bytes per entry), stored in NVS by
+ * cluster_autotune.c. When full, the oldest entry makes room.
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#ifndef CLUSTER_PROFILE_DB_H
+#define CLUSTER_PROFILE_DB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "cluster_autotune.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CLUSTER_PROFILE_DB_MAX_ENTRIES  48
+#define CLUSTER_PROFILE_DB_BOARD_LEN    6           // Board version, e.g. "601", "0.11"
+#define CLUSTER_PROFILE_DB_ENTRY_SIZE   28
+#define CLUSTER_PROFILE_DB_HEADER_SIZE  4
+#define CLUSTER_PROFILE_DB_BLOB_MAX     (CLUSTER_PROFILE_DB_HEADER_SIZE + \
+                                         CLUSTER_PROFILE_DB_MAX_ENTRIES * CLUSTER_PROFILE_DB_ENTRY_SIZE)
+
+/**
+ * @brief Which board a profile belongs to
+ *
+ * asic_id 0 or an empty board version means unknown, and matches anything
+ * (slaves whose details could not be read).
+ */
+typedef struct {
+    uint8_t     mac[6];
+    uint16_t    asic_id;                // AsicConfig.chip_id, e.g. 1370
+    char        board[CLUSTER_PROFILE_DB_BOARD_LEN];
+} profile_device_t;
+
+typedef struct {
+    profile_device_t device;
+    autotune_mode_t mode;
+    int8_t      temp_c;                 // Bucket: ambient rounded to bucket_c
+    uint16_t    freq_mhz;
+    uint16_t    voltage_mv;
+    float       efficiency;             // J/TH when locked
+    float       hashrate;               // GH/s when locked
+    uint32_t    saved_at;               // Unix time, or 0 if the clock was not set
+} profile_entry_t;
+
+typedef struct {
+    uint8_t     bucket_c;               // Bucket width, °C
+    uint8_t     max_extrapolate_c;      // Above the warmest bucket
+    uint8_t     freq_step_mhz;          // Interpolated points are rounded to these
+    uint8_t     voltage_step_mv;
+    profile_entry_t entries[CLUSTER_PROFILE_DB_MAX_ENTRIES];
+    uint8_t     count;
+} profile_db_t;
+
+/**
+ * @brief Point for a device, mode and temperature
+ */
+typedef struct {
+    uint16_t    freq_mhz;
+    uint16_t    voltage_mv;
+    int8_t      lower_c;                // Buckets it came from (equal if one)
+    int8_t      upper_c;
+    bool        interpolated;
+} profile_match_t;
+
+/**
+ * @brief Empty database
+ */
+void cluster_profile_db_init(profile_db_t *db, uint8_t bucket_c, uint8_t max_extrapolate_c,
+                             uint8_t freq_step_mhz, uint8_t voltage_step_mv);
+
+/**
+ * @brief Remember a lock, replacing the one in the same device/mode/bucket
+ * @return Index of the entry
+ */
+int cluster_profile_db_record(profile_db_t *db, const profile_device_t *device, autotune_mode_t mode,
+                              float ambient_c, uint16_t freq_mhz, uint16_t voltage_mv,
+                              float efficiency, float hashrate, uint32_t saved_at);
+
+/**
+ * @brief Point for a device and mode at an ambient temperature
+ * @return ESP_OK, or ESP_ERR_NOT_FOUND if no bucket covers it
+ */
+esp_err_t cluster_profile_db_lookup(const profile_db_t *db, const profile_device_t *device,
+                                    autotune_mode_t mode, float ambient_c, profile_match_t *match);
+
+/**
+ * @brief A device's most recent lock, whose mode it follows
+ * @return Entry, or NULL if the device has none
+ */
+const profile_entry_t *cluster_profile_db_latest(const profile_db_t *db, const profile_device_t *device);
+
+/**
+ * @brief Forget every entry of a device (NULL = all)
+ * @return Entries removed
+ */
+int cluster_profile_db_forget(profile_db_t *db, const profile_device_t *device);
+
+/**
+ * @brief Same board: MAC equal, chip id and board version equal where both are known
+ */
+bool cluster_profile_db_same_device(const profile_device_t *a, const profile_device_t *b);
+
+/**
+ * @brief Serialize to a blob
+ * @return Bytes written, or -1 if len is too small
+ */
+int cluster_profile_db_encode(const profile_db_t *db, uint8_t *buf, size_t len);
+
+/**
+ * @brief Load entries from a blob (settings of db are kept)
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG / ESP_ERR_INVALID_VERSION / ESP_ERR_INVALID_SIZE
+ */
+esp_err_t cluster_profile_db_decode(profile_db_t *db, const uint8_t *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLUSTER_PROFILE_DB_H
@@ -147,6 +147,17 @@ static int finalize_message(char *buffer, size_t buffer_len, size_t payload_len)
     return payload_len + added;
 }
 
+/**
+ * @brief Append ",t1,echo_t1,echo_t4" (see cluster_clock.h)
+ */
+static int append_clock_stamp(char *buffer, size_t buffer_len, const cluster_clock_stamp_t *clock)
+{
+    return snprintf(buffer, buffer_len, ",%lld,%lld,%lld",
+                    (long long)clock->t1,
+                    (long long)clock->echo_t1,
+                    (long long)clock->echo_t4);
+}
+
 // ============================================================================
 // Encoding Functions
 // ============================================================================
@@ -231,7 +242,7 @@ int cluster_protocol_encode_share(const cluster_share_t *share,
     return finalize_message(buffer, buffer_len, len);
 }
 
-int cluster_protocol_encode_heartbeat(uint8_t slave_id,
+int cluster_protocol_encode_heartbeat(uint16_t slave_id,
                                        uint32_t hashrate,
                                        float temp,
                                        uint16_t fan_rpm,
@@ -286,6 +297,50 @@ int cluster_protocol_encode_heartbeat_ex(const cluster_heartbeat_data_t *data,
         return -1;
     }
 
+    // Relays append their downstream node count (omitted otherwise for
+    // compatibility); clock stamps come after it
+    if (data->nodes > 0 || data->clock.t1 != 0) {
+        int added = snprintf(buffer + len, buffer_len - len, ",%u", data->nodes);
+        if (added < 0 || (size_t)(len + added) >= buffer_len - 10) {
+            return -1;
+        }
+        len += added;
+    }
+
+    if (data->clock.t1 != 0) {
+        int added = append_clock_stamp(buffer + len, buffer_len - len, &data->clock);
+        if (added < 0 || (size_t)(len + added) >= buffer_len - 10) {
+            return -1;
+        }
+        len += added;
+    }
+
+    return finalize_message(buffer, buffer_len, len);
+}
+
+int cluster_protocol_encode_heartbeat_reply(uint16_t slave_id,
+                                             int64_t echo_t1,
+                                             char *buffer,
+                                             size_t buffer_len)
+{
+    if (!buffer || buffer_len < 64) {
+        return -1;
+    }
+
+    // Format: $CLHBT,slave_id,0,0.0,0,0[,echo_t1] - the legacy reply plus the echo
+    int len = snprintf(buffer, buffer_len, "$%s,%u,0,0.0,0,0", BAP_MSG_HEARTBEAT, slave_id);
+    if (len < 0 || (size_t)len >= buffer_len - 10) {
+        return -1;
+    }
+
+    if (echo_t1 != 0) {
+        int added = snprintf(buffer + len, buffer_len - len, ",%lld", (long long)echo_t1);
+        if (added < 0 || (size_t)(len + added) >= buffer_len - 10) {
+            return -1;
+        }
+        len += added;
+    }
+
     return finalize_message(buffer, buffer_len, len);
 }
 
@@ -333,7 +388,7 @@ int cluster_protocol_encode_register_ex(const char *hostname,
     return finalize_message(buffer, buffer_len, len);
 }
 
-int cluster_protocol_encode_ack(uint8_t slave_id,
+int cluster_protocol_encode_ack(uint16_t slave_id,
                                  const char *status,
                                  char *buffer,
                                  size_t buffer_len)
@@ -382,6 +437,245 @@ int cluster_protocol_encode_timing(uint16_t interval_ms,
     return finalize_message(buffer, buffer_len, len);
 }
 
+// Binary telemetry travels base64 encoded (no padding) so the sentence stays
+// printable and checksummable on every transport
+static const char BASE64_CHARS[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static int bytes_to_base64(const uint8_t *bytes, size_t len, char *out, size_t out_len)
+{
+    size_t needed = (len * 4 + 2) / 3;
+    if (needed + 1 > out_len) {
+        return -1;
+    }
+
+    size_t o = 0;
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t chunk = (uint32_t)bytes[i] << 16;
+        if (i + 1 < len) chunk |= (uint32_t)bytes[i + 1] << 8;
+        if (i + 2 < len) chunk |= bytes[i + 2];
+
+        out[o++] = BASE64_CHARS[(chunk >> 18) & 0x3F];
+        out[o++] = BASE64_CHARS[(chunk >> 12) & 0x3F];
+        if (i + 1 < len) out[o++] = BASE64_CHARS[(chunk >> 6) & 0x3F];
+        if (i + 2 < len) out[o++] = BASE64_CHARS[chunk & 0x3F];
+    }
+    out[o] = '\0';
+    return (int)o;
+}
+
+static int base64_value(char c)
+{
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+static int base64_to_bytes(const char *str, uint8_t *bytes, size_t max_len)
+{
+    uint32_t acc = 0;
+    int bits = 0;
+    size_t o = 0;
+
+    for (; *str && *str != ',' && *str != '*'; str++) {
+        int v = base64_value(*str);
+        if (v < 0) {
+            return -1;
+        }
+        acc = (acc << 6) | (uint32_t)v;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            if (o >= max_len) {
+                return -1;
+            }
+            bytes[o++] = (uint8_t)(acc >> bits);
+        }
+    }
+    return (int)o;
+}
+
+int cluster_protocol_encode_telemetry(uint16_t node,
+                                      const uint8_t *frame,
+                                      size_t frame_len,
+                                      const cluster_clock_stamp_t *clock,
+                                      char *buffer,
+                                      size_t buffer_len)
+{
+    if (!frame || !buffer || buffer_len < 30) {
+        return -1;
+    }
+
+    // Format: $CLTLM,node,base64[,t1,echo_t1,echo_t4]
+    int len = snprintf(buffer, buffer_len, "$%s,%u,", BAP_MSG_TELEMETRY, node);
+    if (len < 0 || (size_t)len >= buffer_len - 10) {
+        return -1;
+    }
+
+    int b64 = bytes_to_base64(frame, frame_len, buffer + len, buffer_len - len - 10);
+    if (b64 < 0) {
+        return -1;
+    }
+    len += b64;
+
+    if (clock && clock->t1 != 0) {
+        int added = append_clock_stamp(buffer + len, buffer_len - len, clock);
+        if (added < 0 || (size_t)(len + added) >= buffer_len - 10) {
+            return -1;
+        }
+        len += added;
+    }
+
+    return finalize_message(buffer, buffer_len, len);
+}
+
+int cluster_protocol_encode_telemetry_ack(uint16_t node,
+                                          uint8_t seq,
+                                          bool ok,
+                                          int64_t echo_t1,
+                                          char *buffer,
+                                          size_t buffer_len)
+{
+    if (!buffer || buffer_len < 30) {
+        return -1;
+    }
+
+    // Format: $CLTAK,node,seq,ok[,echo_t1]
+    int len = snprintf(buffer, buffer_len,
+                       "$%s,%u,%u,%d",
+                       BAP_MSG_TELEMETRY_ACK,
+                       node, seq, ok ? 1 : 0);
+
+    if (len < 0 || (size_t)len >= buffer_len - 10) {
+        return -1;
+    }
+
+    if (echo_t1 != 0) {
+        int added = snprintf(buffer + len, buffer_len - len, ",%lld", (long long)echo_t1);
+        if (added < 0 || (size_t)(len + added) >= buffer_len - 10) {
+            return -1;
+        }
+        len += added;
+    }
+
+    return finalize_message(buffer, buffer_len, len);
+}
+
+int cluster_protocol_encode_trace(uint16_t node,
+                                  uint32_t lost,
+                                  const uint8_t *records,
+                                  size_t records_len,
+                                  char *buffer,
+                                  size_t buffer_len)
+{
+    if (!records || records_len == 0 || !buffer || buffer_len < 30) {
+        return -1;
+    }
+
+    // Format: $CLTRC,node,lost,base64
+    int len = snprintf(buffer, buffer_len, "$%s,%u,%lu,", BAP_MSG_TRACE, node,
+                       (unsigned long)lost);
+    if (len < 0 || (size_t)len >= buffer_len - 10) {
+        return -1;
+    }
+
+    int b64 = bytes_to_base64(records, records_len, buffer + len, buffer_len - len - 10);
+    if (b64 < 0) {
+        return -1;
+    }
+    len += b64;
+
+    return finalize_message(buffer, buffer_len, len);
+}
+
+int cluster_protocol_encode_setting_get(uint16_t node,
+                                        uint16_t req_id,
+                                        const uint8_t *ids,
+                                        size_t count,
+                                        char *buffer,
+                                        size_t buffer_len)
+{
+    if (!ids || count == 0 || !buffer || buffer_len < 30) {
+        return -1;
+    }
+
+    // Format: $CLGET,node,req,base64
+    int len = snprintf(buffer, buffer_len, "$%s,%u,%u,", BAP_MSG_SETTING_GET, node, req_id);
+    if (len < 0 || (size_t)len >= buffer_len - 10) {
+        return -1;
+    }
+
+    int b64 = bytes_to_base64(ids, count, buffer + len, buffer_len - len - 10);
+    if (b64 < 0) {
+        return -1;
+    }
+    len += b64;
+
+    return finalize_message(buffer, buffer_len, len);
+}
+
+int cluster_protocol_encode_setting_set(uint16_t node,
+                                        uint16_t req_id,
+                                        uint8_t flags,
+                                        const uint8_t *records,
+                                        size_t records_len,
+                                        char *buffer,
+                                        size_t buffer_len)
+{
+    if (!records || records_len == 0 || !buffer || buffer_len < 30) {
+        return -1;
+    }
+
+    // Format: $CLSET,node,req,flags,base64
+    int len = snprintf(buffer, buffer_len, "$%s,%u,%u,%u,", BAP_MSG_SETTING_SET, node, req_id,
+                       flags);
+    if (len < 0 || (size_t)len >= buffer_len - 10) {
+        return -1;
+    }
+
+    int b64 = bytes_to_base64(records, records_len, buffer + len, buffer_len - len - 10);
+    if (b64 < 0) {
+        return -1;
+    }
+    len += b64;
+
+    return finalize_message(buffer, buffer_len, len);
+}
+
+int cluster_protocol_encode_setting_reply(uint16_t node,
+                                          uint16_t req_id,
+                                          uint8_t status,
+                                          uint8_t index,
+                                          const uint8_t *records,
+                                          size_t records_len,
+                                          char *buffer,
+                                          size_t buffer_len)
+{
+    if ((!records && records_len > 0) || !buffer || buffer_len < 30) {
+        return -1;
+    }
+
+    // Format: $CLSTR,node,req,status,index,[base64]
+    int len = snprintf(buffer, buffer_len, "$%s,%u,%u,%u,%u,", BAP_MSG_SETTING_RSP, node, req_id,
+                       status, index);
+    if (len < 0 || (size_t)len >= buffer_len - 10) {
+        return -1;
+    }
+
+    if (records_len > 0) {
+        int b64 = bytes_to_base64(records, records_len, buffer + len, buffer_len - len - 10);
+        if (b64 < 0) {
+            return -1;
+        }
+        len += b64;
+    }
+
+    return finalize_message(buffer, buffer_len, len);
+}
+
 // ============================================================================
 // Decoding Functions
 // ============================================================================
@@ -405,6 +699,21 @@ static const char *get_next_field(const char *str, char *field, size_t max_len)
     return (*str && *str != '*') ? str : NULL;
 }
 
+/**
+ * @brief Parse "t1,echo_t1,echo_t4" (missing fields stay zero)
+ */
+static void decode_clock_stamp(const char *p, cluster_clock_stamp_t *clock)
+{
+    char field[32];
+    int64_t *out[] = { &clock->t1, &clock->echo_t1, &clock->echo_t4 };
+
+    memset(clock, 0, sizeof(*clock));
+    for (int i = 0; i < 3 && p; i++) {
+        p = get_next_field(p, field, sizeof(field));
+        *out[i] = strtoll(field, NULL, 10);
+    }
+}
+
 esp_err_t cluster_protocol_decode_work(const char *payload,
                                         cluster_work_t *work)
 {
@@ -420,7 +729,7 @@ esp_err_t cluster_protocol_decode_work(const char *payload,
     // target_slave_id (first field for quick filtering)
     p = get_next_field(p, field, sizeof(field));
     if (!p && strlen(field) == 0) return ESP_ERR_INVALID_ARG;
-    work->target_slave_id = (uint8_t)strtoul(field, NULL, 10);
+    work->target_slave_id = (uint16_t)strtoul(field, NULL, 10);
 
     // job_id
     if (!p) return ESP_ERR_INVALID_ARG;
@@ -546,7 +855,7 @@ esp_err_t cluster_protocol_decode_share(const char *payload,
 
     // slave_id
     p = get_next_field(p, field, sizeof(field));
-    share->slave_id = (uint8_t)strtoul(field, NULL, 10);
+    share->slave_id = (uint16_t)strtoul(field, NULL, 10);
 
     // job_id
     if (!p) return ESP_ERR_INVALID_ARG;
@@ -592,7 +901,7 @@ esp_err_t cluster_protocol_decode_share(const char *payload,
 }
 
 esp_err_t cluster_protocol_decode_heartbeat(const char *payload,
-                                             uint8_t *slave_id,
+                                             uint16_t *slave_id,
                                              uint32_t *hashrate,
                                              float *temp,
                                              uint16_t *fan_rpm,
@@ -607,7 +916,7 @@ esp_err_t cluster_protocol_decode_heartbeat(const char *payload,
 
     // slave_id
     p = get_next_field(p, field, sizeof(field));
-    if (slave_id) *slave_id = (uint8_t)strtoul(field, NULL, 10);
+    if (slave_id) *slave_id = (uint16_t)strtoul(field, NULL, 10);
 
     // hashrate
     if (!p) return ESP_ERR_INVALID_ARG;
@@ -695,7 +1004,7 @@ esp_err_t cluster_protocol_decode_heartbeat_ex(const char *payload,
 
     // slave_id
     p = get_next_field(p, field, sizeof(field));
-    data->slave_id = (uint8_t)strtoul(field, NULL, 10);
+    data->slave_id = (uint16_t)strtoul(field, NULL, 10);
 
     // hashrate
     if (!p) return ESP_ERR_INVALID_ARG;
@@ -738,15 +1047,52 @@ esp_err_t cluster_protocol_decode_heartbeat_ex(const char *payload,
 
     // voltage_in
     if (p) {
-        get_next_field(p, field, sizeof(field));
+        p = get_next_field(p, field, sizeof(field));
         data->voltage_in = strtof(field, NULL);
     }
 
+    // nodes (relays only)
+    if (p) {
+        p = get_next_field(p, field, sizeof(field));
+        data->nodes = (uint16_t)strtoul(field, NULL, 10);
+    }
+
+    // clock stamps
+    if (p) {
+        decode_clock_stamp(p, &data->clock);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t cluster_protocol_decode_heartbeat_reply(const char *payload,
+                                                   uint16_t *slave_id,
+                                                   int64_t *echo_t1)
+{
+    if (!payload) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char field[32];
+    const char *p = get_next_field(payload, field, sizeof(field));
+    if (slave_id) *slave_id = (uint16_t)strtoul(field, NULL, 10);
+    if (echo_t1) *echo_t1 = 0;
+
+    // Skip the zeroed hashrate, temp, fan_rpm and shares
+    for (int i = 0; i < 4 && p; i++) {
+        p = get_next_field(p, field, sizeof(field));
+    }
+
+    if (p && echo_t1) {
+        get_next_field(p, field, sizeof(field));
+        *echo_t1 = strtoll(field, NULL, 10);
+    }
+
     return ESP_OK;
 }
 
 esp_err_t cluster_protocol_decode_ack(const char *payload,
-                                       uint8_t *slave_id,
+                                       uint16_t *slave_id,
                                        char *status,
                                        size_t status_len)
 {
@@ -759,7 +1105,7 @@ esp_err_t cluster_protocol_decode_ack(const char *payload,
 
     // slave_id
     p = get_next_field(p, field, sizeof(field));
-    if (slave_id) *slave_id = (uint8_t)strtoul(field, NULL, 10);
+    if (slave_id) *slave_id = (uint16_t)strtoul(field, NULL, 10);
 
     // status
     if (status && status_len > 0) {
@@ -791,4 +1137,236 @@ esp_err_t cluster_protocol_decode_timing(const char *payload,
     return ESP_OK;
 }
 
+
+esp_err_t cluster_protocol_decode_telemetry(const char *payload,
+                                             uint16_t *node,
+                                             uint8_t *frame,
+                                             size_t frame_max,
+                                             size_t *frame_len,
+                                             cluster_clock_stamp_t *clock)
+{
+    if (!payload || !frame || !frame_len) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (clock) {
+        memset(clock, 0, sizeof(*clock));
+    }
+
+    char field[16];
+    const char *p = get_next_field(payload, field, sizeof(field));
+    if (!p) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (node) *node = (uint16_t)strtoul(field, NULL, 10);
+
+    int len = base64_to_bytes(p, frame, frame_max);
+    if (len <= 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    *frame_len = (size_t)len;
+
+    // Clock stamps after the base64
+    const char *stamp = strchr(p, ',');
+    if (clock && stamp) {
+        decode_clock_stamp(stamp + 1, clock);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t cluster_protocol_decode_telemetry_ack(const char *payload,
+                                                 uint16_t *node,
+                                                 uint8_t *seq,
+                                                 bool *ok,
+                                                 int64_t *echo_t1)
+{
+    if (!payload || !seq || !ok) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (echo_t1) {
+        *echo_t1 = 0;
+    }
+
+    char field[16];
+    const char *p = payload;
+
+    // node
+    p = get_next_field(p, field, sizeof(field));
+    if (node) *node = (uint16_t)strtoul(field, NULL, 10);
+    if (!p) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // seq
+    p = get_next_field(p, field, sizeof(field));
+    *seq = (uint8_t)strtoul(field, NULL, 10);
+    if (!p) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // ok
+    p = get_next_field(p, field, sizeof(field));
+    *ok = strtoul(field, NULL, 10) != 0;
+
+    // echo_t1 (optional)
+    if (p && echo_t1) {
+        char stamp[32];
+        get_next_field(p, stamp, sizeof(stamp));
+        *echo_t1 = strtoll(stamp, NULL, 10);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t cluster_protocol_decode_trace(const char *payload,
+                                        uint16_t *node,
+                                        uint32_t *lost,
+                                        uint8_t *records,
+                                        size_t records_max,
+                                        size_t *records_len)
+{
+    if (!payload || !records || !records_len) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char field[16];
+    const char *p = get_next_field(payload, field, sizeof(field));
+    if (!p) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (node) *node = (uint16_t)strtoul(field, NULL, 10);
+
+    p = get_next_field(p, field, sizeof(field));
+    if (!p) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (lost) *lost = strtoul(field, NULL, 10);
+
+    int len = base64_to_bytes(p, records, records_max);
+    if (len <= 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    *records_len = (size_t)len;
+    return ESP_OK;
+}
+
+/**
+ * @brief Parse the leading "node,req" of a settings sentence
+ */
+static const char *decode_setting_header(const char *payload, uint16_t *node, uint16_t *req_id)
+{
+    char field[16];
+    const char *p = get_next_field(payload, field, sizeof(field));
+    if (!p) {
+        return NULL;
+    }
+    if (node) *node = (uint16_t)strtoul(field, NULL, 10);
+
+    p = get_next_field(p, field, sizeof(field));
+    if (req_id) *req_id = (uint16_t)strtoul(field, NULL, 10);
+    return p;
+}
+
+esp_err_t cluster_protocol_decode_setting_get(const char *payload,
+                                              uint16_t *node,
+                                              uint16_t *req_id,
+                                              uint8_t *ids,
+                                              size_t ids_max,
+                                              size_t *count)
+{
+    if (!payload || !ids || !count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const char *p = decode_setting_header(payload, node, req_id);
+    if (!p) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    int len = base64_to_bytes(p, ids, ids_max);
+    if (len <= 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    *count = (size_t)len;
+    return ESP_OK;
+}
+
+esp_err_t cluster_protocol_decode_setting_set(const char *payload,
+                                              uint16_t *node,
+                                              uint16_t *req_id,
+                                              uint8_t *flags,
+                                              uint8_t *records,
+                                              size_t records_max,
+                                              size_t *records_len)
+{
+    if (!payload || !records || !records_len) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const char *p = decode_setting_header(payload, node, req_id);
+    if (!p) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    char field[16];
+    p = get_next_field(p, field, sizeof(field));
+    if (!p) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (flags) *flags = (uint8_t)strtoul(field, NULL, 10);
+
+    int len = base64_to_bytes(p, records, records_max);
+    if (len <= 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    *records_len = (size_t)len;
+    return ESP_OK;
+}
+
+esp_err_t cluster_protocol_decode_setting_reply(const char *payload,
+                                                uint16_t *node,
+                                                uint16_t *req_id,
+                                                uint8_t *status,
+                                                uint8_t *index,
+                                                uint8_t *records,
+                                                size_t records_max,
+                                                size_t *records_len)
+{
+    if (!payload || !status || !records || !records_len) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *records_len = 0;
+
+    const char *p = decode_setting_header(payload, node, req_id);
+    if (!p) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    char field[16];
+    p = get_next_field(p, field, sizeof(field));
+    *status = (uint8_t)strtoul(field, NULL, 10);
+    if (!p) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // index, then the records unless there are none
+    p = get_next_field(p, field, sizeof(field));
+    if (index) *index = (uint8_t)strtoul(field, NULL, 10);
+    if (!p) {
+        return ESP_OK;
+    }
+
+    int len = base64_to_bytes(p, records, records_max);
+    if (len < 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    *records_len = (size_t)len;
+    return ESP_OK;
+}
+
 #endif // CLUSTER_ENABLED
@@ -54,11 +54,20 @@ int cluster_protocol_encode_share(const cluster_share_t *share,
                                    char *buffer,
                                    size_t buffer_len);
 
+/**
+ * @brief Clock exchange stamps a node attaches to its uplink (see cluster_clock.h)
+ */
+struct cluster_clock_stamp {
+    int64_t     t1;             // Sender's clock as the frame left (0 = no stamp)
+    int64_t     echo_t1;        // t1 the last reply echoed (0 = none yet)
+    int64_t     echo_t4;        // When that reply arrived (sender's clock)
+};
+
 /**
  * @brief Extended slave stats for heartbeat
  */
 struct cluster_heartbeat_data {
-    uint8_t     slave_id;
+    uint16_t    slave_id;       // Node address
     uint32_t    hashrate;       // GH/s * 100
     float       temp;           // Celsius
     uint16_t    fan_rpm;
@@ -67,12 +76,16 @@ struct cluster_heartbeat_data {
     uint16_t    core_voltage;   // mV
     float       power;          // Watts
     float       voltage_in;     // Input voltage
+    uint16_t    nodes;          // Downstream nodes aggregated in (relays only)
+    cluster_clock_stamp_t clock;
 };
 
 /**
  * @brief Encode heartbeat message with extended stats
  *
- * Format: $CLHBT,slave_id,hashrate,temp,fan_rpm,shares,freq,voltage,power,vin*XX
+ * Format: $CLHBT,slave_id,hashrate,temp,fan_rpm,shares,freq,voltage,power,vin[,nodes[,t1,echo_t1,echo_t4]]*XX
+ *
+ * nodes is sent (as 0 if need be) whenever clock stamps follow it.
  *
  * @param data Heartbeat data structure
  * @param buffer Output buffer
@@ -88,7 +101,7 @@ int cluster_protocol_encode_heartbeat_ex(const cluster_heartbeat_data_t *data,
  *
  * Format: $CLHBT,slave_id,hashrate,temp,fan_rpm,shares*XX
  */
-int cluster_protocol_encode_heartbeat(uint8_t slave_id,
+int cluster_protocol_encode_heartbeat(uint16_t slave_id,
                                        uint32_t hashrate,
                                        float temp,
                                        uint16_t fan_rpm,
@@ -96,6 +109,18 @@ int cluster_protocol_encode_heartbeat(uint8_t slave_id,
                                        char *buffer,
                                        size_t buffer_len);
 
+/**
+ * @brief Encode the master's heartbeat reply
+ *
+ * Format: $CLHBT,slave_id,0,0.0,0,0[,echo_t1]*XX
+ *
+ * @param echo_t1 Clock stamp from the heartbeat being answered (0 = none)
+ */
+int cluster_protocol_encode_heartbeat_reply(uint16_t slave_id,
+                                             int64_t echo_t1,
+                                             char *buffer,
+                                             size_t buffer_len);
+
 /**
  * @brief Encode registration message with IP address
  *
@@ -120,7 +145,7 @@ int cluster_protocol_encode_register(const char *hostname,
  *
  * Format: $CLACK,slave_id,status*XX
  */
-int cluster_protocol_encode_ack(uint8_t slave_id,
+int cluster_protocol_encode_ack(uint16_t slave_id,
                                  const char *status,
                                  char *buffer,
                                  size_t buffer_len);
@@ -139,6 +164,98 @@ int cluster_protocol_encode_timing(uint16_t interval_ms,
                                     char *buffer,
                                     size_t buffer_len);
 
+/**
+ * @brief Encode a binary telemetry frame (see cluster_telemetry.h)
+ *
+ * Format: $CLTLM,node,frame_base64[,t1,echo_t1,echo_t4]*XX
+ *
+ * @param clock Clock stamps, or NULL
+ * @return Length of encoded message, or -1 on error
+ */
+int cluster_protocol_encode_telemetry(uint16_t node,
+                                      const uint8_t *frame,
+                                      size_t frame_len,
+                                      const cluster_clock_stamp_t *clock,
+                                      char *buffer,
+                                      size_t buffer_len);
+
+/**
+ * @brief Encode telemetry acknowledgment
+ *
+ * Format: $CLTAK,node,seq,ok[,echo_t1]*XX (ok=0 asks for a keyframe)
+ *
+ * @param echo_t1 Clock stamp from the frame being answered (0 = none)
+ */
+int cluster_protocol_encode_telemetry_ack(uint16_t node,
+                                          uint8_t seq,
+                                          bool ok,
+                                          int64_t echo_t1,
+                                          char *buffer,
+                                          size_t buffer_len);
+
+/**
+ * @brief Encode packed trace records (see cluster_trace.h)
+ *
+ * Format: $CLTRC,node,lost,records_base64*XX
+ *
+ * @param lost Records the slave dropped since its previous $CLTRC
+ * @return Length of encoded message, or -1 on error
+ */
+int cluster_protocol_encode_trace(uint16_t node,
+                                  uint32_t lost,
+                                  const uint8_t *records,
+                                  size_t records_len,
+                                  char *buffer,
+                                  size_t buffer_len);
+
+/**
+ * @brief Encode a settings read request (see cluster_remote_config.h)
+ *
+ * Format: $CLGET,node,req,ids_base64*XX
+ *
+ * @return Length of encoded message, or -1 on error
+ */
+int cluster_protocol_encode_setting_get(uint16_t node,
+                                        uint16_t req_id,
+                                        const uint8_t *ids,
+                                        size_t count,
+                                        char *buffer,
+                                        size_t buffer_len);
+
+/**
+ * @brief Encode a settings write request
+ *
+ * Format: $CLSET,node,req,flags,records_base64*XX
+ *
+ * @param records Packed by cluster_settings_pack()
+ * @return Length of encoded message, or -1 on error
+ */
+int cluster_protocol_encode_setting_set(uint16_t node,
+                                        uint16_t req_id,
+                                        uint8_t flags,
+                                        const uint8_t *records,
+                                        size_t records_len,
+                                        char *buffer,
+                                        size_t buffer_len);
+
+/**
+ * @brief Encode the answer to $CLGET / $CLSET
+ *
+ * Format: $CLSTR,node,req,status,index,[records_base64]*XX
+ *
+ * @param index Setting the status refers to (0xFF = none)
+ * @param records Values read (back), may be empty
+ * @return Length of encoded message, or -1 on error
+ */
+int cluster_protocol_encode_setting_reply(uint16_t node,
+                                          uint16_t req_id,
+                                          uint8_t status,
+                                          uint8_t index,
+                                          const uint8_t *records,
+                                          size_t records_len,
+                                          char *buffer,
+                                          size_t buffer_len);
+
 // ============================================================================
 // Decoding Functions
 // ============================================================================
@@ -185,12 +302,21 @@ esp_err_t cluster_protocol_decode_heartbeat_ex(const char *payload,
  * @return ESP_OK on success
  */
 esp_err_t cluster_protocol_decode_heartbeat(const char *payload,
-                                             uint8_t *slave_id,
+                                             uint16_t *slave_id,
                                              uint32_t *hashrate,
                                              float *temp,
                                              uint16_t *fan_rpm,
                                              uint32_t *shares);
 
+/**
+ * @brief Decode the master's heartbeat reply
+ *
+ * @param echo_t1 Output: echoed clock stamp, 0 if none (may be NULL)
+ */
+esp_err_t cluster_protocol_decode_heartbeat_reply(const char *payload,
+                                                   uint16_t *slave_id,
+                                                   int64_t *echo_t1);
+
 /**
  * @brief Decode registration from received message (extended)
  */
@@ -211,7 +337,7 @@ esp_err_t cluster_protocol_decode_register(const char *payload,
  * @brief Decode acknowledgment from received message
  */
 esp_err_t cluster_protocol_decode_ack(const char *payload,
-                                       uint8_t *slave_id,
+                                       uint16_t *slave_id,
                                        char *status,
                                        size_t status_len);
 
@@ -225,6 +351,81 @@ esp_err_t cluster_protocol_decode_ack(const char *payload,
 esp_err_t cluster_protocol_decode_timing(const char *payload,
                                           uint16_t *interval_ms);
 
+/**
+ * @brief Decode binary telemetry message
+ *
+ * @param frame Output: raw frame bytes
+ * @param frame_len Output: frame length
+ * @param clock Output: clock stamps, zeroed if absent (may be NULL)
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if malformed or too long
+ */
+esp_err_t cluster_protocol_decode_telemetry(const char *payload,
+                                             uint16_t *node,
+                                             uint8_t *frame,
+                                             size_t frame_max,
+                                             size_t *frame_len,
+                                             cluster_clock_stamp_t *clock);
+
+/**
+ * @brief Decode telemetry acknowledgment
+ *
+ * @param echo_t1 Output: echoed clock stamp, 0 if none (may be NULL)
+ */
+esp_err_t cluster_protocol_decode_telemetry_ack(const char *payload,
+                                                 uint16_t *node,
+                                                 uint8_t *seq,
+                                                 bool *ok,
+                                                 int64_t *echo_t1);
+
+/**
+ * @brief Decode packed trace records
+ *
+ * @param records_len Output: bytes decoded into records
+ * @param lost Output: records the slave dropped (may be NULL)
+ */
+esp_err_t cluster_protocol_decode_trace(const char *payload,
+                                        uint16_t *node,
+                                        uint32_t *lost,
+                                        uint8_t *records,
+                                        size_t records_max,
+                                        size_t *records_len);
+
+/**
+ * @brief Decode a settings read request
+ * @param count Output: ids decoded
+ */
+esp_err_t cluster_protocol_decode_setting_get(const char *payload,
+                                              uint16_t *node,
+                                              uint16_t *req_id,
+                                              uint8_t *ids,
+                                              size_t ids_max,
+                                              size_t *count);
+
+/**
+ * @brief Decode a settings write request
+ * @param records_len Output: bytes decoded into records
+ */
+esp_err_t cluster_protocol_decode_setting_set(const char *payload,
+                                              uint16_t *node,
+                                              uint16_t *req_id,
+                                              uint8_t *flags,
+                                              uint8_t *records,
+                                              size_t records_max,
+                                              size_t *records_len);
+
+/**
+ * @brief Decode the answer to $CLGET / $CLSET
+ * @param records_len Output: bytes decoded into records (0 if none)
+ */
+esp_err_t cluster_protocol_decode_setting_reply(const char *payload,
+                                                uint16_t *node,
+                                                uint16_t *req_id,
+                                                uint8_t *status,
+                                                uint8_t *index,
+                                                uint8_t *records,
+                                                size_t records_max,
+                                                size_t *records_len);
+
 // ============================================================================
 // Utility Functions
 // ============================================================================
@@ -0,0 +1,456 @@
+/**
+ * @file cluster_proxy.c
+ * @brief ClusterAxe master-side HTTP proxy to slave web servers
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#include "cluster_proxy.h"
+#include "cluster_config.h"
+
+#if CLUSTER_ENABLED && CLUSTER_IS_MASTER
+
+#include "cluster.h"
+#include "cluster_proxy_cache.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "cluster_proxy";
+
+#define PROXY_TIMEOUT_MS        5000
+#define PROXY_IDLE_CLOSE_MS     30000   // Under the slave's own idle purge
+#define PROXY_MAX_RESPONSE      16384
+#define PROXY_CACHE_BYTES       (32 * 1024)
+#define PROXY_WORKER_STACK_SIZE 4096
+#define PROXY_WORKER_PRIORITY   5
+
+// ============================================================================
+// State
+// ============================================================================
+
+typedef struct {
+    char *data;
+    int len;
+    bool overflow;
+} proxy_buf_t;
+
+typedef struct {
+    SemaphoreHandle_t lock;             // One request at a time per connection
+    esp_http_client_handle_t client;    // NULL = closed
+    char ip[16];
+    int64_t last_used_ms;
+} proxy_conn_t;
+
+typedef struct {
+    const char *path;
+    cluster_proxy_result_t *result;
+    SemaphoreHandle_t done;
+} proxy_job_t;
+
+static struct {
+    bool initialized;
+    SemaphoreHandle_t inflight;         // Counting, CONFIG_CLUSTER_PROXY_MAX_INFLIGHT
+    SemaphoreHandle_t mutex;            // Cache and stats
+    QueueHandle_t jobs;
+    proxy_conn_t conns[CONFIG_CLUSTER_MAX_SLAVES];
+    proxy_cache_t cache;
+    cluster_proxy_stats_t stats;
+    uint8_t inflight_now;
+} g_proxy = {0};
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static void lock(void)
+{
+    xSemaphoreTake(g_proxy.mutex, portMAX_DELAY);
+}
+
+static void unlock(void)
+{
+    xSemaphoreGive(g_proxy.mutex);
+}
+
+static bool is_valid_ip(const char *ip)
+{
+    return ip[0] >= '0' && ip[0] <= '9' && strcmp(ip, "0.0.0.0") != 0;
+}
+
+// ============================================================================
+// Connections
+// ============================================================================
+
+static esp_err_t proxy_event_handler(esp_http_client_event_t *evt)
+{
+    proxy_buf_t *buf = evt->user_data;
+    if (evt->event_id != HTTP_EVENT_ON_DATA || evt->data_len <= 0 || !buf || buf->overflow) {
+        return ESP_OK;
+    }
+
+    // Chunked or not, the body arrives in pieces
+    char *data = NULL;
+    if (buf->len + evt->data_len <= PROXY_MAX_RESPONSE) {
+        data = realloc(buf->data, buf->len + evt->data_len + 1);
+    }
+    if (!data) {
+        buf->overflow = true;
+        return ESP_OK;
+    }
+    memcpy(data + buf->len, evt->data, evt->data_len);
+    buf->len += evt->data_len;
+    data[buf->len] = '\0';
+    buf->data = data;
+    return ESP_OK;
+}
+
+static void conn_close(proxy_conn_t *conn)
+{
+    if (conn->client) {
+        esp_http_client_cleanup(conn->client);
+        conn->client = NULL;
+        lock();
+        g_proxy.stats.open_connections--;
+        unlock();
+    }
+}
+
+/**
+ * @brief One request over the slave's connection, opening it if needed
+ * @param reused Set if an open connection was used
+ */
+static esp_err_t conn_perform(proxy_conn_t *conn, const char *ip, const char *path,
+                              esp_http_client_method_t method, const char *body,
+                              proxy_buf_t *buf, int *status, bool *reused)
+{
+    char url[128];
+    snprintf(url, sizeof(url), "http://%s%s", ip, path);
+
+    // Another address, or idle long enough that the slave may have dropped it
+    int64_t now = esp_timer_get_time() / 1000;
+    if (conn->client && (strcmp(conn->ip, ip) != 0 || now - conn->last_used_ms > PROXY_IDLE_CLOSE_MS)) {
+        conn_close(conn);
+    }
+
+    *reused = conn->client != NULL;
+    if (!conn->client) {
+        esp_http_client_config_t config = {
+            .url = url,
+            .timeout_ms = PROXY_TIMEOUT_MS,
+            .event_handler = proxy_event_handler,
+            .buffer_size = 2048,
+            .buffer_size_tx = 1024,
+            .keep_alive_enable = true,
+        };
+        conn->client = esp_http_client_init(&config);
+        if (!conn->client) {
+            return ESP_ERR_NO_MEM;
+        }
+        strncpy(conn->ip, ip, sizeof(conn->ip) - 1);
+        conn->ip[sizeof(conn->ip) - 1] = '\0';
+        lock();
+        g_proxy.stats.open_connections++;
+        unlock();
+    } else {
+        esp_http_client_set_url(conn->client, url);
+    }
+
+    esp_http_client_set_user_data(conn->client, buf);
+    esp_http_client_set_method(conn->client, method);
+    if (body) {
+        esp_http_client_set_header(conn->client, "Content-Type", "application/json");
+        esp_http_client_set_post_field(conn->client, body, strlen(body));
+    } else {
+        esp_http_client_delete_header(conn->client, "Content-Type");
+        esp_http_client_set_post_field(conn->client, NULL, 0);
+    }
+
+    esp_err_t err = esp_http_client_perform(conn->client);
+    if (err == ESP_OK) {
+        *status = esp_http_client_get_status_code(conn->client);
+        conn->last_used_ms = now;
+    } else {
+        conn_close(conn);
+    }
+    return err;
+}
+
+/**
+ * @brief Whether a request that failed on a reused connection may be resent
+ *
+ * The slave may have dropped the socket before or after acting on the
+ * request. GET, and PATCH (settings set to absolute values), are safe to
+ * repeat; anything else only if the request never went out.
+ */
+static bool can_resend(esp_http_client_method_t method, esp_err_t err)
+{
+    if (method == HTTP_METHOD_GET || method == HTTP_METHOD_PATCH) {
+        return true;
+    }
+    return err == ESP_ERR_HTTP_CONNECT || err == ESP_ERR_HTTP_WRITE_DATA;
+}
+
+// ============================================================================
+// Gather Workers
+// ============================================================================
+
+static void cluster_proxy_worker_task(void *pvParameters)
+{
+    (void)pvParameters;
+
+    proxy_job_t *job;
+    while (true) {
+        if (xQueueReceive(g_proxy.jobs, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        cluster_proxy_result_t *result = job->result;
+        result->err = cluster_proxy_request(result->slave_id, job->path, HTTP_METHOD_GET, NULL,
+                                            &result->body, &result->status);
+        xSemaphoreGive(job->done);
+    }
+}
+
+// ============================================================================
+// API
+// ============================================================================
+
+esp_err_t cluster_proxy_init(void)
+{
+    if (g_proxy.initialized) {
+        return ESP_OK;
+    }
+
+    g_proxy.mutex = xSemaphoreCreateMutex();
+    g_proxy.inflight = xSemaphoreCreateCounting(CONFIG_CLUSTER_PROXY_MAX_INFLIGHT, CONFIG_CLUSTER_PROXY_MAX_INFLIGHT);
+    g_proxy.jobs = xQueueCreate(CONFIG_CLUSTER_MAX_SLAVES, sizeof(proxy_job_t *));
+    if (!g_proxy.mutex || !g_proxy.inflight || !g_proxy.jobs) {
+        ESP_LOGE(TAG, "Failed to create proxy primitives");
+        return ESP_ERR_NO_MEM;
+    }
+    for (int i = 0; i < CONFIG_CLUSTER_MAX_SLAVES; i++) {
+        g_proxy.conns[i].lock = xSemaphoreCreateMutex();
+        if (!g_proxy.conns[i].lock) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    cluster_proxy_cache_init(&g_proxy.cache, CONFIG_CLUSTER_PROXY_CACHE_TTL_MS, PROXY_CACHE_BYTES);
+
+    for (int i = 0; i < CONFIG_CLUSTER_PROXY_MAX_INFLIGHT; i++) {
+        if (xTaskCreate(cluster_proxy_worker_task, "cluster_proxy", PROXY_WORKER_STACK_SIZE, NULL,
+                        PROXY_WORKER_PRIORITY, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create proxy worker %d", i);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    g_proxy.initialized = true;
+    ESP_LOGI(TAG, "Slave proxy: %d in flight, %d ms cache", CONFIG_CLUSTER_PROXY_MAX_INFLIGHT,
+             CONFIG_CLUSTER_PROXY_CACHE_TTL_MS);
+    return ESP_OK;
+}
+
+/**
+ * @brief Cached response for a GET, under the cache mutex
+ */
+static bool cache_lookup(uint8_t slave_id, const char *path, char **response, int *status)
+{
+    lock();
+    char *body = cluster_proxy_cache_get(&g_proxy.cache, slave_id, path, now_ms(), NULL);
+    if (body) {
+        g_proxy.stats.cache_hits++;
+    }
+    unlock();
+
+    if (!body) {
+        return false;
+    }
+    if (status) {
+        *status = 200;
+    }
+    if (response) {
+        *response = body;
+    } else {
+        free(body);
+    }
+    return true;
+}
+
+esp_err_t cluster_proxy_request(uint8_t slave_id, const char *path, esp_http_client_method_t method,
+                                const char *body, char **response, int *status)
+{
+    if (response) {
+        *response = NULL;
+    }
+    if (!g_proxy.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (slave_id >= CONFIG_CLUSTER_MAX_SLAVES || !path) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    cluster_slave_t slave_info;
+    if (cluster_master_get_slave_info(slave_id, &slave_info) != ESP_OK ||
+        slave_info.state == SLAVE_STATE_DISCONNECTED) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (!is_valid_ip(slave_info.ip_addr)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    bool is_get = method == HTTP_METHOD_GET;
+    if (is_get && cache_lookup(slave_id, path, response, status)) {
+        return ESP_OK;
+    }
+    if (!is_get) {
+        lock();
+        cluster_proxy_cache_invalidate(&g_proxy.cache, slave_id);
+        unlock();
+    }
+
+    proxy_conn_t *conn = &g_proxy.conns[slave_id];
+    xSemaphoreTake(conn->lock, portMAX_DELAY);
+
+    // Someone else may have fetched it while we waited for the connection
+    if (is_get && cache_lookup(slave_id, path, response, status)) {
+        xSemaphoreGive(conn->lock);
+        return ESP_OK;
+    }
+
+    if (xSemaphoreTake(g_proxy.inflight, pdMS_TO_TICKS(PROXY_TIMEOUT_MS)) != pdTRUE) {
+        xSemaphoreGive(conn->lock);
+        lock();
+        g_proxy.stats.busy++;
+        unlock();
+        ESP_LOGW(TAG, "Slave %d %s: no free slot", slave_id, path);
+        return ESP_ERR_TIMEOUT;
+    }
+    lock();
+    g_proxy.inflight_now++;
+    if (g_proxy.inflight_now > g_proxy.stats.inflight_peak) {
+        g_proxy.stats.inflight_peak = g_proxy.inflight_now;
+    }
+    unlock();
+
+    proxy_buf_t buf = {0};
+    int http_status = 0;
+    bool reused;
+    esp_err_t err = conn_perform(conn, slave_info.ip_addr, path, method, body, &buf, &http_status, &reused);
+    bool retried = err != ESP_OK && reused && can_resend(method, err);
+    if (retried) {
+        // The slave closed the kept-alive socket: once more on a new one
+        free(buf.data);
+        buf = (proxy_buf_t){0};
+        err = conn_perform(conn, slave_info.ip_addr, path, method, body, &buf, &http_status, &reused);
+    }
+    if (err == ESP_OK && buf.overflow) {
+        err = ESP_ERR_INVALID_SIZE;
+    }
+
+    xSemaphoreGive(g_proxy.inflight);
+    xSemaphoreGive(conn->lock);
+
+    lock();
+    g_proxy.inflight_now--;
+    g_proxy.stats.requests++;
+    g_proxy.stats.reused += reused;
+    g_proxy.stats.reconnects += retried;
+    g_proxy.stats.failures += err != ESP_OK;
+    if (err == ESP_OK && is_get && http_status == 200 && buf.data) {
+        cluster_proxy_cache_put(&g_proxy.cache, slave_id, path, buf.data, buf.len, now_ms());
+    }
+    unlock();
+
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Slave %d %s: %s", slave_id, path, esp_err_to_name(err));
+        free(buf.data);
+        return err;
+    }
+
+    ESP_LOGD(TAG, "Slave %d %s: status=%d, len=%d%s", slave_id, path, http_status, buf.len,
+             reused ? " (kept alive)" : "");
+    if (status) {
+        *status = http_status;
+    }
+    if (response) {
+        *response = buf.data;
+    } else {
+        free(buf.data);
+    }
+    return ESP_OK;
+}
+
+int cluster_proxy_get_all(const char *path, cluster_proxy_result_t *results, int max)
+{
+    if (!results || max <= 0) {
+        return 0;
+    }
+
+    SemaphoreHandle_t done = xSemaphoreCreateCounting(CONFIG_CLUSTER_MAX_SLAVES, 0);
+    proxy_job_t jobs[CONFIG_CLUSTER_MAX_SLAVES];
+    int count = 0, queued = 0;
+
+    for (int i = 0; i < CONFIG_CLUSTER_MAX_SLAVES && count < max; i++) {
+        cluster_slave_t slave_info;
+        if (cluster_master_get_slave_info(i, &slave_info) != ESP_OK ||
+            slave_info.state == SLAVE_STATE_DISCONNECTED) {
+            continue;
+        }
+
+        cluster_proxy_result_t *result = &results[count++];
+        *result = (cluster_proxy_result_t){ .slave_id = (uint8_t)i, .err = ESP_ERR_INVALID_STATE };
+        if (!is_valid_ip(slave_info.ip_addr)) {
+            continue;
+        }
+
+        // Without the pool, one at a time here
+        proxy_job_t *job = &jobs[queued];
+        *job = (proxy_job_t){ .path = path, .result = result, .done = done };
+        if (!g_proxy.initialized || !done || xQueueSend(g_proxy.jobs, &job, 0) != pdTRUE) {
+            result->err = cluster_proxy_request(result->slave_id, path, HTTP_METHOD_GET, NULL,
+                                                &result->body, &result->status);
+            continue;
+        }
+        queued++;
+    }
+
+    // Every request is bounded by the client timeout, so this returns
+    for (int i = 0; i < queued; i++) {
+        xSemaphoreTake(done, portMAX_DELAY);
+    }
+    if (done) {
+        vSemaphoreDelete(done);
+    }
+    return count;
+}
+
+void cluster_proxy_free_results(cluster_proxy_result_t *results, int count)
+{
+    for (int i = 0; i < count; i++) {
+        free(results[i].body);
+        results[i].body = NULL;
+    }
+}
+
+void cluster_proxy_get_stats(cluster_proxy_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    if (!g_proxy.initialized) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    lock();
+    *stats = g_proxy.stats;
+    unlock();
+}
+
+#endif // CLUSTER_ENABLED && CLUSTER_IS_MASTER
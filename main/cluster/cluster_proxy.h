@@ -0,0 +1,98 @@
+/**
+ * @file cluster_proxy.h
+ * @brief ClusterAxe master-side HTTP proxy to slave web servers
+ *
+ * The web UI reaches slaves through the master. Every request here:
+ *
+ *   - reuses one keep-alive connection per slave, reopened when the slave's
+ *     address changes, after 30 s idle, or if the reused socket failed; a
+ *     failed GET or PATCH is then sent once more, a POST only if it never
+ *     went out
+ *   - collects its response in its own buffer, so handlers, the autotune
+ *     and gather workers can proxy at the same time
+ *   - waits for one of CONFIG_CLUSTER_PROXY_MAX_INFLIGHT slots, so a burst
+ *     of dashboard requests cannot exhaust sockets or heap
+ *   - serves GETs from a CONFIG_CLUSTER_PROXY_CACHE_TTL_MS response cache
+ *     (cluster_proxy_cache.h); anything else sent to a slave clears its
+ *     entries
+ *
+ * cluster_proxy_get_all() fans one GET out to every registered slave on a
+ * pool of worker tasks, so it takes as long as the slowest slave rather
+ * than the sum of them.
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#ifndef CLUSTER_PROXY_H
+#define CLUSTER_PROXY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_http_client.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief One slave's answer in cluster_proxy_get_all()
+ */
+typedef struct {
+    uint8_t     slave_id;
+    esp_err_t   err;                    // ESP_ERR_INVALID_STATE: no IP address
+    int         status;                 // HTTP status when err is ESP_OK
+    char       *body;                   // NUL-terminated, or NULL
+} cluster_proxy_result_t;
+
+typedef struct {
+    uint32_t    requests;               // Sent to slaves
+    uint32_t    cache_hits;
+    uint32_t    reused;                 // Over an open connection
+    uint32_t    reconnects;             // Stale keep-alive retried on a new one
+    uint32_t    failures;
+    uint32_t    busy;                   // No in-flight slot in time
+    uint8_t     inflight_peak;
+    uint8_t     open_connections;
+} cluster_proxy_stats_t;
+
+/**
+ * @brief Create the connection pool, cache and gather workers
+ * @return ESP_OK, or ESP_ERR_NO_MEM
+ */
+esp_err_t cluster_proxy_init(void);
+
+/**
+ * @brief Send a request to a slave's web server
+ *
+ * @param slave_id Slave slot
+ * @param path Path with query, e.g. "/api/system/info"
+ * @param method HTTP method
+ * @param body JSON body for POST/PATCH, or NULL
+ * @param response Set to the body (caller frees), may be NULL
+ * @param status Set to the HTTP status, may be NULL
+ * @return ESP_OK, ESP_ERR_NOT_FOUND (no such slave), ESP_ERR_INVALID_STATE
+ *         (no IP address), ESP_ERR_TIMEOUT (every slot busy),
+ *         ESP_ERR_INVALID_SIZE (response over 16 KB), or the client's error
+ */
+esp_err_t cluster_proxy_request(uint8_t slave_id, const char *path, esp_http_client_method_t method,
+                                const char *body, char **response, int *status);
+
+/**
+ * @brief GET a path from every registered slave in parallel
+ * @param results One per slave, in slot order
+ * @param max Entries in results
+ * @return Entries written; free them with cluster_proxy_free_results()
+ */
+int cluster_proxy_get_all(const char *path, cluster_proxy_result_t *results, int max);
+
+void cluster_proxy_free_results(cluster_proxy_result_t *results, int count);
+
+void cluster_proxy_get_stats(cluster_proxy_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLUSTER_PROXY_H
@@ -0,0 +1,151 @@
+/**
+ * @file cluster_proxy_cache.c
+ * @brief ClusterAxe short-lived cache of slave HTTP responses
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#include "cluster_proxy_cache.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static void drop(proxy_cache_t *cache, proxy_cache_entry_t *e)
+{
+    if (e->slave < 0) {
+        return;
+    }
+    cache->bytes -= e->len;
+    free(e->body);
+    e->body = NULL;
+    e->len = 0;
+    e->slave = -1;
+}
+
+static proxy_cache_entry_t *find(proxy_cache_t *cache, int8_t slave, const char *path)
+{
+    for (int i = 0; i < CLUSTER_PROXY_CACHE_ENTRIES; i++) {
+        proxy_cache_entry_t *e = &cache->entries[i];
+        if (e->slave == slave && strcmp(e->path, path) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static proxy_cache_entry_t *lru(proxy_cache_t *cache)
+{
+    proxy_cache_entry_t *oldest = NULL;
+    for (int i = 0; i < CLUSTER_PROXY_CACHE_ENTRIES; i++) {
+        proxy_cache_entry_t *e = &cache->entries[i];
+        if (e->slave >= 0 && (!oldest || (int32_t)(e->used_ms - oldest->used_ms) < 0)) {
+            oldest = e;
+        }
+    }
+    return oldest;
+}
+
+static bool expired(const proxy_cache_t *cache, const proxy_cache_entry_t *e, uint32_t now_ms)
+{
+    return now_ms - e->fetched_ms >= cache->ttl_ms;
+}
+
+// ============================================================================
+// API
+// ============================================================================
+
+void cluster_proxy_cache_init(proxy_cache_t *cache, uint32_t ttl_ms, size_t max_bytes)
+{
+    memset(cache, 0, sizeof(*cache));
+    for (int i = 0; i < CLUSTER_PROXY_CACHE_ENTRIES; i++) {
+        cache->entries[i].slave = -1;
+    }
+    cache->ttl_ms = ttl_ms;
+    cache->max_bytes = max_bytes;
+}
+
+char *cluster_proxy_cache_get(proxy_cache_t *cache, int8_t slave, const char *path,
+                              uint32_t now_ms, size_t *len)
+{
+    proxy_cache_entry_t *e = find(cache, slave, path);
+    if (e && expired(cache, e, now_ms)) {
+        drop(cache, e);
+        e = NULL;
+    }
+    if (!e) {
+        cache->misses++;
+        return NULL;
+    }
+
+    char *copy = malloc(e->len + 1);
+    if (!copy) {
+        return NULL;
+    }
+    memcpy(copy, e->body, e->len + 1);
+    e->used_ms = now_ms;
+    cache->hits++;
+    if (len) {
+        *len = e->len;
+    }
+    return copy;
+}
+
+bool cluster_proxy_cache_put(proxy_cache_t *cache, int8_t slave, const char *path,
+                             const char *body, size_t len, uint32_t now_ms)
+{
+    if (slave < 0 || strlen(path) >= CLUSTER_PROXY_CACHE_PATH_LEN || len > cache->max_bytes) {
+        return false;
+    }
+
+    proxy_cache_entry_t *e = find(cache, slave, path);
+    if (e) {
+        drop(cache, e);
+    }
+
+    // Expired entries go first, then the least recently used
+    for (int i = 0; i < CLUSTER_PROXY_CACHE_ENTRIES; i++) {
+        if (cache->entries[i].slave >= 0 && expired(cache, &cache->entries[i], now_ms)) {
+            drop(cache, &cache->entries[i]);
+        }
+    }
+    while (cache->bytes + len > cache->max_bytes) {
+        drop(cache, lru(cache));
+    }
+    e = NULL;
+    for (int i = 0; i < CLUSTER_PROXY_CACHE_ENTRIES && !e; i++) {
+        if (cache->entries[i].slave < 0) {
+            e = &cache->entries[i];
+        }
+    }
+    if (!e) {
+        e = lru(cache);
+        drop(cache, e);
+    }
+
+    e->body = malloc(len + 1);
+    if (!e->body) {
+        return false;
+    }
+    memcpy(e->body, body, len);
+    e->body[len] = '\0';
+    e->len = len;
+    e->slave = slave;
+    strcpy(e->path, path);
+    e->fetched_ms = now_ms;
+    e->used_ms = now_ms;
+    cache->bytes += len;
+    return true;
+}
+
+void cluster_proxy_cache_invalidate(proxy_cache_t *cache, int8_t slave)
+{
+    for (int i = 0; i < CLUSTER_PROXY_CACHE_ENTRIES; i++) {
+        if (slave < 0 || cache->entries[i].slave == slave) {
+            drop(cache, &cache->entries[i]);
+        }
+    }
+}
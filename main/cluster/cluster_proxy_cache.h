@@ -0,0 +1,82 @@
+/**
+ * @file cluster_proxy_cache.h
+ * @brief ClusterAxe short-lived cache of slave HTTP responses
+ *
+ * Dashboards poll the same slave endpoints from every open browser tab.
+ * Responses to GET requests proxied by the master are kept for ttl_ms, so
+ * N tabs polling M slaves cost M requests per TTL rather than N x M:
+ *
+ *   (slave, path) -> body, fetched_ms
+ *
+ * A lookup past the TTL misses (and frees the entry). When full, by entries
+ * or by bytes, the least recently used entry makes room. Anything sent to a
+ * slave other than a GET drops its entries, so a changed setting is never
+ * read back stale.
+ *
+ * Not thread-safe: cluster_proxy.c holds a mutex around every call.
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#ifndef CLUSTER_PROXY_CACHE_H
+#define CLUSTER_PROXY_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CLUSTER_PROXY_CACHE_ENTRIES     16
+#define CLUSTER_PROXY_CACHE_PATH_LEN    48
+
+typedef struct {
+    int8_t      slave;                  // -1 = free
+    char        path[CLUSTER_PROXY_CACHE_PATH_LEN];
+    char       *body;                   // NUL-terminated
+    size_t      len;
+    uint32_t    fetched_ms;
+    uint32_t    used_ms;                // For LRU
+} proxy_cache_entry_t;
+
+typedef struct {
+    proxy_cache_entry_t entries[CLUSTER_PROXY_CACHE_ENTRIES];
+    uint32_t    ttl_ms;
+    size_t      max_bytes;              // Bodies held at once
+    size_t      bytes;
+    uint32_t    hits;
+    uint32_t    misses;
+} proxy_cache_t;
+
+/**
+ * @brief Empty cache
+ */
+void cluster_proxy_cache_init(proxy_cache_t *cache, uint32_t ttl_ms, size_t max_bytes);
+
+/**
+ * @brief Copy of a fresh response
+ * @return Body the caller frees, or NULL on a miss
+ */
+char *cluster_proxy_cache_get(proxy_cache_t *cache, int8_t slave, const char *path,
+                              uint32_t now_ms, size_t *len);
+
+/**
+ * @brief Keep a copy of a response
+ * @return false if it was not kept (too large, path too long, no memory)
+ */
+bool cluster_proxy_cache_put(proxy_cache_t *cache, int8_t slave, const char *path,
+                             const char *body, size_t len, uint32_t now_ms);
+
+/**
+ * @brief Drop a slave's responses (-1 = all)
+ */
+void cluster_proxy_cache_invalidate(proxy_cache_t *cache, int8_t slave);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLUSTER_PROXY_CACHE_H
@@ -0,0 +1,498 @@
+/**
+ * @file cluster_relay.c
+ * @brief Clusteraxe Relay (sub-master) Node
+ *
+ * Keeps a small registry of downstream slaves and runs one task that
+ * pushes subdivided work to them and expires silent children. Shares,
+ * heartbeats and telemetry arrive on the ESP-NOW RX task and are handled
+ * inline; the relay acknowledges its children's telemetry itself.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include "cluster_relay.h"
+#include "cluster_telemetry.h"
+#include "cluster_topology.h"
+#include "cluster_transport.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "string.h"
+#include "stdio.h"
+
+#if CLUSTER_IS_RELAY
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "cluster_relay";
+
+// Attempts per child when pushing work (unicast, MAC-level ACK)
+#define RELAY_WORK_SEND_ATTEMPTS    3
+
+// ============================================================================
+// Private State
+// ============================================================================
+
+typedef struct {
+    bool                        active;
+    uint8_t                     mac[6];
+    char                        hostname[32];
+    char                        ip_addr[16];
+    int64_t                     last_seen;
+    bool                        hb_valid;
+    cluster_heartbeat_data_t    hb;
+    cluster_telemetry_rx_t      tlm_rx;
+    uint32_t                    shares_forwarded;
+} relay_child_slot_t;
+
+static struct {
+    bool                initialized;
+    relay_child_slot_t  children[CLUSTER_RELAY_MAX_CHILDREN];
+    SemaphoreHandle_t   mutex;
+    TaskHandle_t        task;
+
+    cluster_work_t      parent_work;
+    bool                parent_work_valid;
+    bool                work_pending;
+
+    // Master slot the current child addresses were derived from
+    uint16_t            acked_as;
+} g_relay = {0};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static inline uint16_t my_slot(void)
+{
+    return cluster_slave_get_node_addr();
+}
+
+static inline uint16_t child_addr(uint16_t slot, int index)
+{
+    return CLUSTER_NODE_ADDR(slot, index);
+}
+
+static void send_ack(uint16_t addr, const relay_child_slot_t *child)
+{
+    char payload[64];
+    int len = cluster_protocol_encode_ack(addr, child->hostname, payload, sizeof(payload));
+    if (len > 0) {
+        cluster_transport_send(child->mac, payload, len);
+    }
+}
+
+static void send_work(const cluster_work_t *parent, uint16_t addr, const uint8_t *mac)
+{
+    cluster_work_t work;
+    cluster_topology_derive_child_work(parent, addr, &work);
+
+    char payload[256];
+    int len = cluster_protocol_encode_work(&work, payload, sizeof(payload));
+    if (len < 0) {
+        ESP_LOGE(TAG, "Failed to encode work for node 0x%04X", addr);
+        return;
+    }
+
+    for (int attempt = 0; attempt < RELAY_WORK_SEND_ATTEMPTS; attempt++) {
+        if (cluster_transport_send(mac, payload, len) == ESP_OK) {
+            return;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    ESP_LOGW(TAG, "Work to node 0x%04X not acknowledged", addr);
+}
+
+// ============================================================================
+// Relay Task
+// ============================================================================
+
+static void relay_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "Relay task started");
+
+    relay_child_slot_t snapshot[CLUSTER_RELAY_MAX_CHILDREN];
+    cluster_work_t work;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+
+        uint16_t slot = my_slot();
+        int64_t now = esp_timer_get_time() / 1000;
+        bool push_work = false;
+        bool readdress = false;
+
+        xSemaphoreTake(g_relay.mutex, portMAX_DELAY);
+
+        // Expire silent children
+        for (int i = 0; i < CLUSTER_RELAY_MAX_CHILDREN; i++) {
+            relay_child_slot_t *c = &g_relay.children[i];
+            if (c->active && (now - c->last_seen) > CLUSTER_TIMEOUT_MS) {
+                ESP_LOGW(TAG, "Child %d (%s) timed out", i, c->hostname);
+                c->active = false;
+                c->hb_valid = false;
+            }
+        }
+
+        // Our master slot changed (master reboot / re-registration):
+        // child addresses embed it, so hand out new ones
+        if (slot != CLUSTER_NODE_ADDR_INVALID && slot != g_relay.acked_as) {
+            g_relay.acked_as = slot;
+            readdress = true;
+        }
+
+        if (g_relay.work_pending && g_relay.parent_work_valid) {
+            work = g_relay.parent_work;
+            push_work = true;
+        }
+        g_relay.work_pending = false;
+
+        memcpy(snapshot, g_relay.children, sizeof(snapshot));
+        xSemaphoreGive(g_relay.mutex);
+
+        if (slot == CLUSTER_NODE_ADDR_INVALID) {
+            continue;
+        }
+
+        // Radio sends happen outside the lock
+        for (int i = 0; i < CLUSTER_RELAY_MAX_CHILDREN; i++) {
+            if (!snapshot[i].active) {
+                continue;
+            }
+            if (readdress) {
+                send_ack(child_addr(slot, i), &snapshot[i]);
+            }
+            if (push_work) {
+                send_work(&work, child_addr(slot, i), snapshot[i].mac);
+            }
+        }
+    }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+esp_err_t cluster_relay_init(void)
+{
+    if (g_relay.initialized) {
+        return ESP_OK;
+    }
+
+    memset(&g_relay, 0, sizeof(g_relay));
+    g_relay.acked_as = CLUSTER_NODE_ADDR_INVALID;
+
+    g_relay.mutex = xSemaphoreCreateMutex();
+    if (!g_relay.mutex) {
+        ESP_LOGE(TAG, "Failed to create relay mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(relay_task, "cluster_relay", 4096, NULL, 5, &g_relay.task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create relay task");
+        vSemaphoreDelete(g_relay.mutex);
+        g_relay.mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    g_relay.initialized = true;
+    ESP_LOGI(TAG, "Relay initialized (max %d children)", CLUSTER_RELAY_MAX_CHILDREN);
+
+    return ESP_OK;
+}
+
+void cluster_relay_deinit(void)
+{
+    if (!g_relay.initialized) {
+        return;
+    }
+
+    if (g_relay.task) {
+        vTaskDelete(g_relay.task);
+    }
+    if (g_relay.mutex) {
+        vSemaphoreDelete(g_relay.mutex);
+    }
+
+    memset(&g_relay, 0, sizeof(g_relay));
+    ESP_LOGI(TAG, "Relay deinitialized");
+}
+
+esp_err_t cluster_relay_handle_registration(const char *hostname,
+                                            const char *ip_addr,
+                                            const uint8_t *mac_addr)
+{
+    if (!g_relay.initialized || !hostname || !mac_addr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint16_t slot = my_slot();
+    if (slot == CLUSTER_NODE_ADDR_INVALID) {
+        ESP_LOGW(TAG, "Ignoring registration from %s - relay not registered yet", hostname);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(g_relay.mutex, portMAX_DELAY);
+
+    // Re-registration: same MAC or hostname keeps its index
+    int index = -1;
+    for (int i = 0; i < CLUSTER_RELAY_MAX_CHILDREN; i++) {
+        relay_child_slot_t *c = &g_relay.children[i];
+        if (c->active && (memcmp(c->mac, mac_addr, 6) == 0 ||
+                          strcmp(c->hostname, hostname) == 0)) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        for (int i = 0; i < CLUSTER_RELAY_MAX_CHILDREN; i++) {
+            if (!g_relay.children[i].active) {
+                index = i;
+                break;
+            }
+        }
+    }
+
+    if (index < 0) {
+        xSemaphoreGive(g_relay.mutex);
+        ESP_LOGW(TAG, "Relay full, rejecting %s", hostname);
+        return ESP_ERR_NO_MEM;
+    }
+
+    relay_child_slot_t *c = &g_relay.children[index];
+    if (!c->active) {
+        memset(c, 0, sizeof(*c));
+    }
+    c->active = true;
+    memcpy(c->mac, mac_addr, 6);
+    strncpy(c->hostname, hostname, sizeof(c->hostname) - 1);
+    c->hostname[sizeof(c->hostname) - 1] = '\0';
+    if (ip_addr) {
+        strncpy(c->ip_addr, ip_addr, sizeof(c->ip_addr) - 1);
+        c->ip_addr[sizeof(c->ip_addr) - 1] = '\0';
+    }
+    c->last_seen = esp_timer_get_time() / 1000;
+
+    relay_child_slot_t copy = *c;
+    cluster_work_t work = g_relay.parent_work;
+    bool have_work = g_relay.parent_work_valid;
+
+    xSemaphoreGive(g_relay.mutex);
+
+    uint16_t addr = child_addr(slot, index);
+    ESP_LOGI(TAG, "Registered child '%s' as node 0x%04X", hostname, addr);
+
+    send_ack(addr, &copy);
+    if (have_work) {
+        send_work(&work, addr, copy.mac);
+    }
+
+    return ESP_OK;
+}
+
+void cluster_relay_on_parent_work(const cluster_work_t *work)
+{
+    if (!g_relay.initialized || !work) {
+        return;
+    }
+
+    xSemaphoreTake(g_relay.mutex, portMAX_DELAY);
+    g_relay.parent_work = *work;
+    g_relay.parent_work_valid = true;
+    g_relay.work_pending = true;
+    xSemaphoreGive(g_relay.mutex);
+
+    xTaskNotifyGive(g_relay.task);
+}
+
+bool cluster_relay_owns_node(uint16_t node_addr)
+{
+    uint16_t slot = my_slot();
+
+    return g_relay.initialized &&
+           slot != CLUSTER_NODE_ADDR_INVALID &&
+           CLUSTER_NODE_IS_DOWNSTREAM(node_addr) &&
+           CLUSTER_NODE_SLOT(node_addr) == slot &&
+           CLUSTER_NODE_LOCAL(node_addr) < CLUSTER_RELAY_MAX_CHILDREN;
+}
+
+esp_err_t cluster_relay_handle_share(const cluster_share_t *share)
+{
+    if (!share || !cluster_relay_owns_node(share->slave_id)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(g_relay.mutex, portMAX_DELAY);
+    relay_child_slot_t *c = &g_relay.children[CLUSTER_NODE_LOCAL(share->slave_id)];
+    if (c->active) {
+        c->shares_forwarded++;
+        c->last_seen = esp_timer_get_time() / 1000;
+    }
+    xSemaphoreGive(g_relay.mutex);
+
+    ESP_LOGD(TAG, "Forwarding share from node 0x%04X: job=%lu nonce=0x%08lX",
+             share->slave_id, (unsigned long)share->job_id, (unsigned long)share->nonce);
+
+    return cluster_slave_queue_share(share);
+}
+
+/**
+ * @brief Find the child slot for a report, recovering it if it expired
+ *
+ * Takes g_relay.mutex; on success the caller must release it.
+ */
+static relay_child_slot_t *lock_child_for_report(uint16_t node, const uint8_t *mac_addr)
+{
+    xSemaphoreTake(g_relay.mutex, portMAX_DELAY);
+
+    relay_child_slot_t *c = &g_relay.children[CLUSTER_NODE_LOCAL(node)];
+    if (!c->active) {
+        // Expired after lost heartbeats but still following our beacons,
+        // so it won't re-register - recover it like the master does
+        if (!mac_addr) {
+            xSemaphoreGive(g_relay.mutex);
+            return NULL;
+        }
+        memset(c, 0, sizeof(*c));
+        c->active = true;
+        snprintf(c->hostname, sizeof(c->hostname), "node-%04X", node);
+        ESP_LOGI(TAG, "Recovering child node 0x%04X via heartbeat", node);
+    }
+
+    c->last_seen = esp_timer_get_time() / 1000;
+    if (mac_addr) {
+        memcpy(c->mac, mac_addr, 6);
+    }
+    return c;
+}
+
+esp_err_t cluster_relay_handle_heartbeat(const cluster_heartbeat_data_t *data,
+                                         const uint8_t *mac_addr)
+{
+    if (!data || !cluster_relay_owns_node(data->slave_id)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    relay_child_slot_t *c = lock_child_for_report(data->slave_id, mac_addr);
+    if (!c) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    c->hb = *data;
+    c->hb_valid = true;
+
+    xSemaphoreGive(g_relay.mutex);
+    return ESP_OK;
+}
+
+esp_err_t cluster_relay_handle_telemetry(uint16_t node, const uint8_t *frame, size_t len,
+                                         const uint8_t *mac_addr)
+{
+    if (!frame || !cluster_relay_owns_node(node)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    relay_child_slot_t *c = lock_child_for_report(node, mac_addr);
+    if (!c) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    uint8_t seq = 0;
+    bool keyframe = false;
+    bool ack = false;
+    esp_err_t ret = cluster_telemetry_decode(&c->tlm_rx, frame, len, &seq, &keyframe);
+    if (ret == ESP_OK) {
+        // Only the heartbeat view is aggregated upstream
+        cluster_telemetry_to_heartbeat(&c->tlm_rx.current, node, &c->hb);
+        c->hb_valid = true;
+        ack = cluster_telemetry_rx_ack_due(&c->tlm_rx, keyframe, c->last_seen,
+                                           CLUSTER_HEARTBEAT_MS);
+    }
+
+    uint8_t mac[6];
+    memcpy(mac, c->mac, sizeof(mac));
+    xSemaphoreGive(g_relay.mutex);
+
+    if (ack || ret == ESP_ERR_NOT_FOUND) {
+        char payload[48];
+        // No clock echo: only the master estimates clocks, for the nodes
+        // directly under it (see cluster_clock.h)
+        int plen = cluster_protocol_encode_telemetry_ack(node, seq, ret == ESP_OK, 0,
+                                                         payload, sizeof(payload));
+        if (plen > 0) {
+            cluster_transport_send(mac, payload, plen);
+        }
+    }
+
+    return ret;
+}
+
+void cluster_relay_aggregate_heartbeat(cluster_heartbeat_data_t *hb)
+{
+    if (!g_relay.initialized || !hb) {
+        return;
+    }
+
+    xSemaphoreTake(g_relay.mutex, portMAX_DELAY);
+    for (int i = 0; i < CLUSTER_RELAY_MAX_CHILDREN; i++) {
+        relay_child_slot_t *c = &g_relay.children[i];
+        if (c->active && c->hb_valid) {
+            cluster_topology_aggregate_heartbeat(hb, &c->hb);
+        }
+    }
+    xSemaphoreGive(g_relay.mutex);
+}
+
+uint8_t cluster_relay_free_slots(void)
+{
+    return CLUSTER_RELAY_MAX_CHILDREN - cluster_relay_get_child_count();
+}
+
+uint8_t cluster_relay_get_child_count(void)
+{
+    if (!g_relay.initialized) {
+        return 0;
+    }
+
+    uint8_t count = 0;
+    xSemaphoreTake(g_relay.mutex, portMAX_DELAY);
+    for (int i = 0; i < CLUSTER_RELAY_MAX_CHILDREN; i++) {
+        if (g_relay.children[i].active) {
+            count++;
+        }
+    }
+    xSemaphoreGive(g_relay.mutex);
+
+    return count;
+}
+
+esp_err_t cluster_relay_get_child(uint8_t index, cluster_relay_child_t *child)
+{
+    if (!g_relay.initialized || !child || index >= CLUSTER_RELAY_MAX_CHILDREN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    uint16_t slot = my_slot();
+
+    xSemaphoreTake(g_relay.mutex, portMAX_DELAY);
+    relay_child_slot_t *c = &g_relay.children[index];
+    if (c->active) {
+        child->node_addr = slot != CLUSTER_NODE_ADDR_INVALID ? child_addr(slot, index)
+                                                              : CLUSTER_NODE_ADDR_INVALID;
+        memcpy(child->mac, c->mac, 6);
+        strncpy(child->hostname, c->hostname, sizeof(child->hostname));
+        child->hashrate = c->hb_valid ? c->hb.hashrate : 0;
+        child->temperature = c->hb_valid ? c->hb.temp : 0.0f;
+        child->shares_forwarded = c->shares_forwarded;
+        child->last_seen = c->last_seen;
+        ret = ESP_OK;
+    }
+    xSemaphoreGive(g_relay.mutex);
+
+    return ret;
+}
+
+#endif // CLUSTER_IS_RELAY
@@ -0,0 +1,124 @@
+/**
+ * @file cluster_relay.h
+ * @brief Clusteraxe Relay (sub-master) Node
+ *
+ * A relay is a slave that accepts its own group of downstream slaves over
+ * ESP-NOW. It registers with the master like any other slave, then
+ * advertises itself with "CLAXE,RELAY,<free>" beacons. Work received from
+ * the master is subdivided per child (see cluster_topology.h), children's
+ * shares are forwarded upstream unchanged, and children's heartbeats are
+ * folded into the relay's own heartbeat so the master sees one slot.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#ifndef CLUSTER_RELAY_H
+#define CLUSTER_RELAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "cluster.h"
+#include "cluster_protocol.h"
+#include "cluster_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CLUSTER_RELAY_MAX_CHILDREN      CONFIG_CLUSTER_RELAY_MAX_CHILDREN
+
+/**
+ * @brief Downstream slave info (for status/API)
+ */
+typedef struct {
+    uint16_t    node_addr;
+    uint8_t     mac[6];
+    char        hostname[32];
+    uint32_t    hashrate;           // GH/s * 100
+    float       temperature;
+    uint32_t    shares_forwarded;
+    int64_t     last_seen;
+} cluster_relay_child_t;
+
+#if CLUSTER_IS_RELAY
+
+/**
+ * @brief Create relay state and start the relay task
+ */
+esp_err_t cluster_relay_init(void);
+
+/**
+ * @brief Stop the relay task and drop all children
+ */
+void cluster_relay_deinit(void);
+
+/**
+ * @brief Handle a downstream slave's registration (ESP-NOW $REGISTER)
+ *
+ * Assigns a child address, ACKs the child by unicast and sends it the
+ * current subdivided work. Does nothing while the relay itself is not
+ * registered with the master or when the group is full.
+ */
+esp_err_t cluster_relay_handle_registration(const char *hostname,
+                                            const char *ip_addr,
+                                            const uint8_t *mac_addr);
+
+/**
+ * @brief Hand the relay's own work to the relay task for subdivision
+ */
+void cluster_relay_on_parent_work(const cluster_work_t *work);
+
+/**
+ * @brief Check whether a node address belongs to this relay's group
+ */
+bool cluster_relay_owns_node(uint16_t node_addr);
+
+/**
+ * @brief Forward a downstream share to the master
+ */
+esp_err_t cluster_relay_handle_share(const cluster_share_t *share);
+
+/**
+ * @brief Record a downstream heartbeat
+ * @param mac_addr Sender MAC (refreshes the child's address), may be NULL
+ */
+esp_err_t cluster_relay_handle_heartbeat(const cluster_heartbeat_data_t *data,
+                                         const uint8_t *mac_addr);
+
+/**
+ * @brief Decode a downstream telemetry frame and ack/NAK it
+ * @param mac_addr Sender MAC (refreshes the child's address), may be NULL
+ */
+esp_err_t cluster_relay_handle_telemetry(uint16_t node, const uint8_t *frame, size_t len,
+                                         const uint8_t *mac_addr);
+
+/**
+ * @brief Fold all live children into the relay's outgoing heartbeat
+ */
+void cluster_relay_aggregate_heartbeat(cluster_heartbeat_data_t *hb);
+
+/**
+ * @brief Child slots still available (advertised in relay beacons)
+ */
+uint8_t cluster_relay_free_slots(void);
+
+/**
+ * @brief Get downstream slave info by index
+ * @return ESP_OK if a child is registered at that index
+ */
+esp_err_t cluster_relay_get_child(uint8_t index, cluster_relay_child_t *child);
+
+/**
+ * @brief Number of registered downstream slaves
+ */
+uint8_t cluster_relay_get_child_count(void);
+
+#endif // CLUSTER_IS_RELAY
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLUSTER_RELAY_H
@@ -0,0 +1,915 @@
+/**
+ * @file cluster_remote_config.c
+ * @brief Remote configuration protocol for ClusterAxe
+ *
+ * Master: requests are tracked by (slave, request id) until their $CLSTR
+ * arrives. The caller's task sends every request of a call first, then
+ * waits for the answers, resending the unanswered ones every
+ * REMOTE_RETRY_MS.
+ *
+ * Slave: requests for this node are queued to one apply task, which
+ * answers when the settings are in effect. The newest request id and its
+ * answer are kept so a resent request is answered again, not re-applied.
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#include "cluster_remote_config.h"
+#include "cluster.h"
+#include "cluster_integration.h"
+#include "cluster_protocol.h"
+#include "cluster_settings.h"
+#include "cluster_topology.h"
+#include "cluster_transport.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if CLUSTER_ENABLED
+
+static const char *TAG = "cluster_rcfg";
+
+// Longest sentence: one ESP-NOW frame
+#define REMOTE_SENTENCE_MAX         256
+
+#define REMOTE_RETRY_MS             300
+
+// Ramp steps and how long each is held before the next
+#define REMOTE_RAMP_STEP_MHZ        25
+#define REMOTE_RAMP_STEP_MV         25
+#define REMOTE_RAMP_HOLD_MS         20
+
+#define REMOTE_QUEUE_DEPTH          2
+#define REMOTE_TASK_STACK_SIZE      4096
+#define REMOTE_TASK_PRIORITY        4
+
+static const char *status_name(cluster_response_status_t status)
+{
+    switch (status) {
+        case CLUSTER_RESP_OK:               return "ok";
+        case CLUSTER_RESP_ERROR:            return "error";
+        case CLUSTER_RESP_INVALID_SETTING:  return "unknown setting";
+        case CLUSTER_RESP_READ_ONLY:        return "read-only";
+        case CLUSTER_RESP_INVALID_VALUE:    return "invalid value";
+        case CLUSTER_RESP_NOT_SUPPORTED:    return "not supported";
+        case CLUSTER_RESP_BUSY:             return "busy";
+        case CLUSTER_RESP_AUTH_REQUIRED:    return "auth required";
+        case CLUSTER_RESP_TIMEOUT:          return "timeout";
+        default:                            return "?";
+    }
+}
+
+// ============================================================================
+// Master: Request Tracking
+// ============================================================================
+
+#if CLUSTER_IS_MASTER
+
+typedef struct {
+    uint8_t                     slave_id;
+    uint16_t                    req_id;
+    char                        sentence[REMOTE_SENTENCE_MAX];
+    int                         len;                // 0 = not sent
+
+    // Filled in by the $CLSTR
+    bool                        answered;
+    cluster_response_status_t   status;
+    uint8_t                     index;
+    cluster_setting_value_t    *values;             // Where read values go, or NULL
+    int                         max_values;
+    int                         count;
+
+    SemaphoreHandle_t           waiter;
+} remote_request_t;
+
+static struct {
+    SemaphoreHandle_t   mutex;
+    uint16_t            next_req;
+    remote_request_t   *requests[CLUSTER_MAX_SLAVES * 2];
+} g_rcfg_master;
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+/**
+ * @brief Give each request an id and a slot in the table
+ *
+ * A request the table has no room for is answered BUSY right away.
+ */
+static void track(remote_request_t *reqs, int n)
+{
+    xSemaphoreTake(g_rcfg_master.mutex, portMAX_DELAY);
+    for (int i = 0; i < n; i++) {
+        remote_request_t *req = &reqs[i];
+        if (req->answered) {
+            continue;
+        }
+        req->req_id = 0;
+        for (size_t s = 0; s < sizeof(g_rcfg_master.requests) / sizeof(g_rcfg_master.requests[0]); s++) {
+            if (!g_rcfg_master.requests[s]) {
+                g_rcfg_master.requests[s] = req;
+                // 0 is never used, so an untracked request stays recognizable
+                if (++g_rcfg_master.next_req == 0) {
+                    g_rcfg_master.next_req = 1;
+                }
+                req->req_id = g_rcfg_master.next_req;
+                break;
+            }
+        }
+        if (req->req_id == 0) {
+            req->answered = true;
+            req->status = CLUSTER_RESP_BUSY;
+        }
+    }
+    xSemaphoreGive(g_rcfg_master.mutex);
+}
+
+static void untrack(remote_request_t *reqs, int n)
+{
+    xSemaphoreTake(g_rcfg_master.mutex, portMAX_DELAY);
+    for (size_t s = 0; s < sizeof(g_rcfg_master.requests) / sizeof(g_rcfg_master.requests[0]); s++) {
+        remote_request_t *req = g_rcfg_master.requests[s];
+        if (req && req >= reqs && req < reqs + n) {
+            g_rcfg_master.requests[s] = NULL;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        if (!reqs[i].answered) {
+            reqs[i].status = CLUSTER_RESP_TIMEOUT;
+        }
+    }
+    xSemaphoreGive(g_rcfg_master.mutex);
+}
+
+static esp_err_t send_request(const remote_request_t *req)
+{
+    cluster_slave_t slave;
+    if (cluster_master_get_slave_info(req->slave_id, &slave) != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (slave.state != SLAVE_STATE_ACTIVE && slave.state != SLAVE_STATE_STALE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return cluster_transport_broadcast_to(slave.mac_addr, req->sentence, req->len);
+}
+
+/**
+ * @brief Send every request, then wait for the answers until timeout_ms
+ */
+static void run_requests(remote_request_t *reqs, int n, uint32_t timeout_ms)
+{
+    SemaphoreHandle_t waiter = xSemaphoreCreateBinary();
+    if (!waiter) {
+        for (int i = 0; i < n; i++) {
+            reqs[i].answered = true;
+            reqs[i].status = CLUSTER_RESP_ERROR;
+        }
+        return;
+    }
+
+    xSemaphoreTake(g_rcfg_master.mutex, portMAX_DELAY);
+    for (int i = 0; i < n; i++) {
+        reqs[i].waiter = waiter;
+    }
+    xSemaphoreGive(g_rcfg_master.mutex);
+
+    for (int i = 0; i < n; i++) {
+        if (!reqs[i].answered && (reqs[i].len <= 0 || send_request(&reqs[i]) != ESP_OK)) {
+            reqs[i].answered = true;
+            reqs[i].status = CLUSTER_RESP_ERROR;
+        }
+    }
+
+    uint32_t start = now_ms();
+    uint32_t last_send = start;
+    while (true) {
+        bool pending = false;
+        xSemaphoreTake(g_rcfg_master.mutex, portMAX_DELAY);
+        for (int i = 0; i < n && !pending; i++) {
+            pending = !reqs[i].answered;
+        }
+        xSemaphoreGive(g_rcfg_master.mutex);
+
+        uint32_t now = now_ms();
+        if (!pending || now - start >= timeout_ms) {
+            break;
+        }
+
+        if (now - last_send >= REMOTE_RETRY_MS) {
+            for (int i = 0; i < n; i++) {
+                if (!reqs[i].answered) {
+                    send_request(&reqs[i]);
+                }
+            }
+            last_send = now;
+        }
+
+        uint32_t wait = REMOTE_RETRY_MS - (now - last_send);
+        if (wait > timeout_ms - (now - start)) {
+            wait = timeout_ms - (now - start);
+        }
+        xSemaphoreTake(waiter, pdMS_TO_TICKS(wait));
+    }
+
+    untrack(reqs, n);
+    vSemaphoreDelete(waiter);
+}
+
+esp_err_t cluster_master_handle_config_reply(const char *payload, size_t len)
+{
+    (void)len;
+    if (!g_rcfg_master.mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint16_t node = 0, req_id = 0;
+    uint8_t status = 0, index = CLUSTER_REMOTE_NO_INDEX;
+    uint8_t records[CLUSTER_SETTINGS_WIRE_MAX];
+    size_t records_len = 0;
+    esp_err_t ret = cluster_protocol_decode_setting_reply(payload, &node, &req_id, &status, &index,
+                                                          records, sizeof(records), &records_len);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    xSemaphoreTake(g_rcfg_master.mutex, portMAX_DELAY);
+    remote_request_t *req = NULL;
+    for (size_t s = 0; s < sizeof(g_rcfg_master.requests) / sizeof(g_rcfg_master.requests[0]); s++) {
+        remote_request_t *r = g_rcfg_master.requests[s];
+        if (r && r->slave_id == node && r->req_id == req_id && !r->answered) {
+            req = r;
+            break;
+        }
+    }
+    if (req) {
+        req->status = (cluster_response_status_t)status;
+        req->index = index;
+        if (req->values && records_len > 0) {
+            int count = cluster_settings_unpack(records, records_len, req->values, req->max_values);
+            if (count < 0) {
+                req->status = CLUSTER_RESP_ERROR;
+                count = 0;
+            }
+            req->count = count;
+        }
+        req->answered = true;
+        if (req->waiter) {
+            xSemaphoreGive(req->waiter);
+        }
+    }
+    xSemaphoreGive(g_rcfg_master.mutex);
+
+    if (!req) {
+        // Resent answer to a request already answered or given up on
+        ESP_LOGD(TAG, "Unmatched settings reply from slave %u (req %u)", node, req_id);
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+// ============================================================================
+// Master API
+// ============================================================================
+
+esp_err_t cluster_master_set_slaves_settings(cluster_remote_set_t *sets, int n,
+                                             uint8_t flags, uint32_t timeout_ms)
+{
+    if (!sets || n <= 0 || n > CLUSTER_MAX_SLAVES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!g_rcfg_master.mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (timeout_ms == 0) {
+        timeout_ms = CLUSTER_REMOTE_CONFIG_TIMEOUT_MS;
+    }
+
+    remote_request_t *reqs = calloc(n, sizeof(remote_request_t));
+    if (!reqs) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Refuse locally what the slave would refuse
+    for (int i = 0; i < n; i++) {
+        int bad = -1;
+        reqs[i].slave_id = sets[i].slave_id;
+        reqs[i].index = CLUSTER_REMOTE_NO_INDEX;
+        if (sets[i].count == 0 || sets[i].count > CLUSTER_REMOTE_MAX_BATCH) {
+            reqs[i].status = CLUSTER_RESP_INVALID_VALUE;
+            reqs[i].answered = true;
+            continue;
+        }
+        cluster_response_status_t status = cluster_settings_validate(sets[i].values, sets[i].count, &bad);
+        if (status != CLUSTER_RESP_OK) {
+            reqs[i].status = status;
+            reqs[i].index = (uint8_t)bad;
+            reqs[i].answered = true;
+        }
+    }
+
+    track(reqs, n);
+
+    uint8_t records[CLUSTER_SETTINGS_WIRE_MAX];
+    for (int i = 0; i < n; i++) {
+        if (reqs[i].answered) {
+            continue;
+        }
+        int records_len = cluster_settings_pack(sets[i].values, sets[i].count, records, sizeof(records));
+        if (records_len > 0) {
+            reqs[i].len = cluster_protocol_encode_setting_set(sets[i].slave_id, reqs[i].req_id, flags,
+                                                              records, records_len,
+                                                              reqs[i].sentence, sizeof(reqs[i].sentence));
+        }
+        if (reqs[i].len <= 0) {
+            reqs[i].len = 0;
+            reqs[i].status = CLUSTER_RESP_INVALID_VALUE;
+            reqs[i].answered = true;
+        }
+    }
+
+    run_requests(reqs, n, timeout_ms);
+
+    esp_err_t ret = ESP_OK;
+    for (int i = 0; i < n; i++) {
+        sets[i].status = reqs[i].status;
+        sets[i].bad_index = reqs[i].index;
+        if (reqs[i].status == CLUSTER_RESP_OK) {
+            continue;
+        }
+        ESP_LOGW(TAG, "Slave %u refused settings: %s (setting %u)", sets[i].slave_id,
+                 status_name(reqs[i].status), reqs[i].index);
+        if (reqs[i].status == CLUSTER_RESP_TIMEOUT) {
+            ret = ESP_ERR_TIMEOUT;
+        } else if (ret == ESP_OK) {
+            ret = ESP_FAIL;
+        }
+    }
+
+    free(reqs);
+    return ret;
+}
+
+esp_err_t cluster_master_get_slave_settings(uint8_t slave_id,
+                                            const uint8_t *setting_ids,
+                                            int count,
+                                            cluster_setting_value_t *values,
+                                            uint32_t timeout_ms)
+{
+    if (!setting_ids || !values || count <= 0 || count > CLUSTER_REMOTE_MAX_BATCH ||
+        slave_id >= CLUSTER_MAX_SLAVES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!g_rcfg_master.mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (timeout_ms == 0) {
+        timeout_ms = CLUSTER_REMOTE_CONFIG_TIMEOUT_MS;
+    }
+
+    remote_request_t *req = calloc(1, sizeof(remote_request_t));
+    if (!req) {
+        return ESP_ERR_NO_MEM;
+    }
+    req->slave_id = slave_id;
+    req->values = values;
+    req->max_values = count;
+    track(req, 1);
+
+    if (!req->answered) {
+        req->len = cluster_protocol_encode_setting_get(slave_id, req->req_id, setting_ids, count,
+                                                       req->sentence, sizeof(req->sentence));
+    }
+    run_requests(req, 1, timeout_ms);
+
+    esp_err_t ret = ESP_OK;
+    if (req->status == CLUSTER_RESP_TIMEOUT) {
+        ret = ESP_ERR_TIMEOUT;
+    } else if (req->count != count) {
+        ret = ESP_FAIL;
+    }
+    free(req);
+    return ret;
+}
+
+esp_err_t cluster_master_set_slave_setting(uint8_t slave_id,
+                                            const cluster_setting_value_t *value)
+{
+    if (!value) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    cluster_remote_set_t *set = calloc(1, sizeof(cluster_remote_set_t));
+    if (!set) {
+        return ESP_ERR_NO_MEM;
+    }
+    set->slave_id = slave_id;
+    set->count = 1;
+    set->values[0] = *value;
+
+    esp_err_t ret = cluster_master_set_slaves_settings(set, 1, 0, 0);
+    free(set);
+    return ret;
+}
+
+static void set_u32(cluster_setting_value_t *value, uint8_t id, uint32_t v)
+{
+    memset(value, 0, sizeof(*value));
+    value->setting_id = id;
+    value->data_type = CLUSTER_SETTING_TYPE_U32;
+    value->value.u32 = v;
+}
+
+esp_err_t cluster_master_set_slave_mining(uint8_t slave_id, uint16_t freq_mhz, uint16_t voltage_mv)
+{
+    cluster_remote_set_t *set = calloc(1, sizeof(cluster_remote_set_t));
+    if (!set) {
+        return ESP_ERR_NO_MEM;
+    }
+    set->slave_id = slave_id;
+    set->count = 2;
+    set_u32(&set->values[0], CLUSTER_SETTING_FREQUENCY, freq_mhz);
+    set_u32(&set->values[1], CLUSTER_SETTING_CORE_VOLTAGE, voltage_mv);
+
+    esp_err_t ret = cluster_master_set_slaves_settings(set, 1, CLUSTER_REMOTE_FLAG_RAMP, 0);
+    free(set);
+    return ret;
+}
+
+esp_err_t cluster_master_set_slave_frequency(uint8_t slave_id, uint16_t freq_mhz)
+{
+    cluster_setting_value_t value;
+    set_u32(&value, CLUSTER_SETTING_FREQUENCY, freq_mhz);
+    return cluster_master_set_slave_setting(slave_id, &value);
+}
+
+esp_err_t cluster_master_set_slave_voltage(uint8_t slave_id, uint16_t voltage_mv)
+{
+    cluster_setting_value_t value;
+    set_u32(&value, CLUSTER_SETTING_CORE_VOLTAGE, voltage_mv);
+    return cluster_master_set_slave_setting(slave_id, &value);
+}
+
+esp_err_t cluster_master_set_slave_fan(uint8_t slave_id, uint8_t speed_percent)
+{
+    cluster_remote_set_t *set = calloc(1, sizeof(cluster_remote_set_t));
+    if (!set) {
+        return ESP_ERR_NO_MEM;
+    }
+    set->slave_id = slave_id;
+    set->count = 2;
+    set_u32(&set->values[0], CLUSTER_SETTING_FAN_SPEED, speed_percent);
+    set_u32(&set->values[1], CLUSTER_SETTING_FAN_MODE, 1);
+
+    esp_err_t ret = cluster_master_set_slaves_settings(set, 1, 0, 0);
+    free(set);
+    return ret;
+}
+
+esp_err_t cluster_remote_config_init(void)
+{
+    if (!g_rcfg_master.mutex) {
+        g_rcfg_master.mutex = xSemaphoreCreateMutex();
+        if (!g_rcfg_master.mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    memset(g_rcfg_master.requests, 0, sizeof(g_rcfg_master.requests));
+
+    // A slave may still hold our last run's ids: start somewhere else
+    g_rcfg_master.next_req = (uint16_t)esp_timer_get_time();
+    return ESP_OK;
+}
+
+void cluster_remote_config_deinit(void)
+{
+    // Callers may still be waiting on requests in the table; keep the mutex
+}
+
+#endif // CLUSTER_IS_MASTER
+
+// ============================================================================
+// Slave: Board Access
+// ============================================================================
+
+#if CLUSTER_IS_SLAVE
+
+// Implemented in cluster_integration.c; these defaults report no support
+
+__attribute__((weak)) void cluster_get_asic_settings(uint16_t *freq_mhz, uint16_t *voltage_mv)
+{
+    *freq_mhz = cluster_get_asic_frequency();
+    *voltage_mv = cluster_get_core_voltage();
+}
+
+__attribute__((weak)) esp_err_t cluster_set_asic_settings(uint16_t freq_mhz, uint16_t voltage_mv,
+                                                          bool persist)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+__attribute__((weak)) void cluster_get_fan_settings(bool *auto_fan, uint8_t *manual_percent,
+                                                    uint8_t *target_temp)
+{
+    *auto_fan = true;
+    *manual_percent = 100;
+    *target_temp = 60;
+}
+
+__attribute__((weak)) esp_err_t cluster_set_fan_settings(bool auto_fan, uint8_t manual_percent,
+                                                         uint8_t target_temp)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+static void set_string(cluster_setting_value_t *value, const char *str)
+{
+    value->data_type = CLUSTER_SETTING_TYPE_STRING;
+    strncpy(value->value.str, str ? str : "", CLUSTER_SETTINGS_STR_MAX);
+    value->value.str[CLUSTER_SETTINGS_STR_MAX] = '\0';
+}
+
+cluster_response_status_t cluster_slave_read_setting(uint8_t setting_id,
+                                                     cluster_setting_value_t *value)
+{
+    const cluster_setting_desc_t *desc = cluster_settings_find(setting_id);
+
+    memset(value, 0, sizeof(*value));
+    value->setting_id = setting_id;
+    value->data_type = CLUSTER_SETTING_TYPE_NONE;
+    if (!desc) {
+        return CLUSTER_RESP_INVALID_SETTING;
+    }
+    value->data_type = desc->type;
+
+    uint16_t freq, mv;
+    bool auto_fan;
+    uint8_t manual, target;
+
+    switch (setting_id) {
+        case CLUSTER_SETTING_HOSTNAME:
+            set_string(value, cluster_get_hostname());
+            break;
+        case CLUSTER_SETTING_UPTIME:
+            value->value.u32 = (uint32_t)(esp_timer_get_time() / 1000000);
+            break;
+        case CLUSTER_SETTING_FREE_HEAP:
+            value->value.u32 = esp_get_free_heap_size();
+            break;
+        case CLUSTER_SETTING_CHIP_TEMP:
+            value->value.f32 = cluster_get_chip_temp();
+            break;
+        case CLUSTER_SETTING_FREQUENCY:
+        case CLUSTER_SETTING_CORE_VOLTAGE:
+            cluster_get_asic_settings(&freq, &mv);
+            value->value.u32 = setting_id == CLUSTER_SETTING_FREQUENCY ? freq : mv;
+            break;
+        case CLUSTER_SETTING_FAN_SPEED:
+        case CLUSTER_SETTING_FAN_MODE:
+        case CLUSTER_SETTING_TARGET_TEMP:
+            cluster_get_fan_settings(&auto_fan, &manual, &target);
+            value->value.u32 = setting_id == CLUSTER_SETTING_FAN_SPEED ? manual :
+                               setting_id == CLUSTER_SETTING_FAN_MODE ? (auto_fan ? 0 : 1) : target;
+            break;
+        case CLUSTER_SETTING_HASHRATE:
+            value->value.u32 = cluster_get_asic_hashrate();
+            break;
+        case CLUSTER_SETTING_POWER:
+            value->value.f32 = cluster_get_power();
+            break;
+        case CLUSTER_SETTING_EFFICIENCY: {
+            // Hashrate is GH/s * 100
+            float th = cluster_get_asic_hashrate() / 100000.0f;
+            value->value.f32 = th > 0 ? cluster_get_power() / th : 0.0f;
+            break;
+        }
+        case CLUSTER_SETTING_ASIC_COUNT: {
+            cluster_board_telemetry_t board;
+            cluster_get_board_telemetry(&board);
+            value->value.u32 = board.asic_count;
+            break;
+        }
+        case CLUSTER_SETTING_IP_ADDR:
+            set_string(value, cluster_get_ip_addr());
+            break;
+        case CLUSTER_SETTING_SLAVE_ID:
+            value->value.u32 = cluster_slave_get_node_addr();
+            break;
+        case CLUSTER_SETTING_MASTER_MAC: {
+            uint8_t mac[6];
+            char mac_str[18] = "";
+            if (cluster_transport_get_uplink_mac(mac)) {
+                cluster_transport_mac_to_str(mac, mac_str);
+            }
+            set_string(value, mac_str);
+            break;
+        }
+        case CLUSTER_SETTING_TRANSPORT:
+            value->value.u32 = cluster_transport_get_type();
+            break;
+        default:
+            value->data_type = CLUSTER_SETTING_TYPE_NONE;
+            return CLUSTER_RESP_NOT_SUPPORTED;
+    }
+    return CLUSTER_RESP_OK;
+}
+
+cluster_response_status_t cluster_slave_apply_settings(const cluster_setting_value_t *values,
+                                                       int count,
+                                                       uint8_t flags,
+                                                       int *bad_index)
+{
+    int bad = -1;
+    cluster_response_status_t status = cluster_settings_validate(values, count, &bad);
+    if (status != CLUSTER_RESP_OK) {
+        *bad_index = bad;
+        return status;
+    }
+    *bad_index = -1;
+
+    uint16_t freq, mv;
+    bool auto_fan;
+    uint8_t manual, target;
+    cluster_get_asic_settings(&freq, &mv);
+    cluster_get_fan_settings(&auto_fan, &manual, &target);
+
+    uint16_t to_freq = freq, to_mv = mv;
+    int asic_index = -1, fan_index = -1;
+    for (int i = 0; i < count; i++) {
+        uint32_t v = values[i].value.u32;
+        switch (values[i].setting_id) {
+            case CLUSTER_SETTING_FREQUENCY:     to_freq = (uint16_t)v; asic_index = i; break;
+            case CLUSTER_SETTING_CORE_VOLTAGE:  to_mv = (uint16_t)v; asic_index = i; break;
+            case CLUSTER_SETTING_FAN_SPEED:     manual = (uint8_t)v; fan_index = i; break;
+            case CLUSTER_SETTING_FAN_MODE:      auto_fan = v == 0; fan_index = i; break;
+            case CLUSTER_SETTING_TARGET_TEMP:   target = (uint8_t)v; fan_index = i; break;
+            default: break;
+        }
+    }
+
+    if (fan_index >= 0 && cluster_set_fan_settings(auto_fan, manual, target) != ESP_OK) {
+        *bad_index = fan_index;
+        return CLUSTER_RESP_NOT_SUPPORTED;
+    }
+
+    if (asic_index < 0) {
+        return CLUSTER_RESP_OK;
+    }
+
+    if (flags & CLUSTER_REMOTE_FLAG_RAMP) {
+        cluster_settings_ramp_step_t steps[CLUSTER_SETTINGS_RAMP_MAX];
+        int n = cluster_settings_plan_ramp(freq, mv, to_freq, to_mv,
+                                           REMOTE_RAMP_STEP_MHZ, REMOTE_RAMP_STEP_MV,
+                                           steps, CLUSTER_SETTINGS_RAMP_MAX);
+        if (n < 0) {
+            *bad_index = asic_index;
+            return CLUSTER_RESP_INVALID_VALUE;
+        }
+        // The last step is the target, applied below
+        for (int i = 0; i < n - 1; i++) {
+            if (cluster_set_asic_settings(steps[i].freq_mhz, steps[i].voltage_mv, false) != ESP_OK) {
+                break;
+            }
+            vTaskDelay(pdMS_TO_TICKS(REMOTE_RAMP_HOLD_MS));
+        }
+        if (n > 1) {
+            ESP_LOGI(TAG, "Ramped %u MHz / %u mV -> %u MHz / %u mV in %d steps",
+                     freq, mv, to_freq, to_mv, n);
+        }
+    }
+
+    esp_err_t ret = cluster_set_asic_settings(to_freq, to_mv, true);
+    if (ret != ESP_OK) {
+        *bad_index = asic_index;
+        return ret == ESP_ERR_NOT_SUPPORTED ? CLUSTER_RESP_NOT_SUPPORTED : CLUSTER_RESP_ERROR;
+    }
+    return CLUSTER_RESP_OK;
+}
+
+// ============================================================================
+// Slave: Request Handling
+// ============================================================================
+
+typedef struct {
+    uint16_t                    req_id;
+    bool                        is_set;
+    uint8_t                     flags;
+    uint8_t                     count;
+    uint8_t                     ids[CLUSTER_REMOTE_MAX_BATCH];
+    cluster_setting_value_t     values[CLUSTER_REMOTE_MAX_BATCH];
+} remote_job_t;
+
+static struct {
+    QueueHandle_t       queue;
+    TaskHandle_t        task;
+    SemaphoreHandle_t   mutex;
+
+    // Newest request taken, and its answer once sent
+    bool                have_last;
+    uint16_t            last_req;
+    bool                last_done;
+    char                last_reply[REMOTE_SENTENCE_MAX];
+    int                 last_reply_len;
+} g_rcfg_slave;
+
+static void send_reply(const char *sentence, int len)
+{
+    if (cluster_transport_send_to_master(sentence, len) != ESP_OK) {
+        cluster_transport_broadcast(sentence, len);
+    }
+}
+
+static void reply(uint16_t req_id, cluster_response_status_t status, int bad_index,
+                  const cluster_setting_value_t *values, int count)
+{
+    uint8_t records[CLUSTER_SETTINGS_WIRE_MAX];
+    int records_len = values ? cluster_settings_pack(values, count, records, sizeof(records)) : 0;
+    if (records_len < 0) {
+        records_len = 0;
+        status = CLUSTER_RESP_ERROR;
+    }
+
+    char sentence[REMOTE_SENTENCE_MAX];
+    int len = cluster_protocol_encode_setting_reply(cluster_slave_get_node_addr(), req_id, status,
+                                                    bad_index < 0 ? CLUSTER_REMOTE_NO_INDEX : (uint8_t)bad_index,
+                                                    records, records_len, sentence, sizeof(sentence));
+    if (len <= 0) {
+        ESP_LOGE(TAG, "Failed to encode settings reply");
+        return;
+    }
+
+    xSemaphoreTake(g_rcfg_slave.mutex, portMAX_DELAY);
+    if (g_rcfg_slave.have_last && g_rcfg_slave.last_req == req_id) {
+        memcpy(g_rcfg_slave.last_reply, sentence, len);
+        g_rcfg_slave.last_reply_len = len;
+        g_rcfg_slave.last_done = true;
+    }
+    xSemaphoreGive(g_rcfg_slave.mutex);
+
+    send_reply(sentence, len);
+}
+
+static void remote_config_task(void *pvParameters)
+{
+    (void)pvParameters;
+    remote_job_t *job = malloc(sizeof(remote_job_t));
+    cluster_setting_value_t *read = malloc(CLUSTER_REMOTE_MAX_BATCH * sizeof(cluster_setting_value_t));
+    if (!job || !read) {
+        ESP_LOGE(TAG, "Failed to allocate remote config buffers");
+        free(job);
+        free(read);
+        g_rcfg_slave.task = NULL;
+        vTaskDelete(NULL);
+        return;
+    }
+
+    while (true) {
+        if (xQueueReceive(g_rcfg_slave.queue, job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        cluster_response_status_t status = CLUSTER_RESP_OK;
+        int bad_index = -1;
+        int count = 0;
+
+        if (job->is_set) {
+            status = cluster_slave_apply_settings(job->values, job->count, job->flags, &bad_index);
+            // Read back what took effect, or what is left in place
+            for (int i = 0; i < job->count; i++) {
+                cluster_slave_read_setting(job->values[i].setting_id, &read[count++]);
+            }
+            ESP_LOGI(TAG, "Settings request %u: %s", job->req_id, status_name(status));
+        } else {
+            for (int i = 0; i < job->count; i++) {
+                cluster_response_status_t s = cluster_slave_read_setting(job->ids[i], &read[count++]);
+                if (s != CLUSTER_RESP_OK && status == CLUSTER_RESP_OK) {
+                    status = s;
+                    bad_index = i;
+                }
+            }
+        }
+
+        reply(job->req_id, status, bad_index, read, count);
+    }
+}
+
+esp_err_t cluster_slave_handle_config_message(const char *msg_type,
+                                               const char *payload,
+                                               size_t len)
+{
+    (void)len;
+    if (!g_rcfg_slave.queue) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    remote_job_t *job = calloc(1, sizeof(remote_job_t));
+    if (!job) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint16_t node = CLUSTER_NODE_ADDR_INVALID;
+    esp_err_t ret;
+    if (strcmp(msg_type, BAP_MSG_SETTING_SET) == 0) {
+        uint8_t records[CLUSTER_SETTINGS_WIRE_MAX];
+        size_t records_len = 0;
+        job->is_set = true;
+        ret = cluster_protocol_decode_setting_set(payload, &node, &job->req_id, &job->flags,
+                                                  records, sizeof(records), &records_len);
+        if (ret == ESP_OK) {
+            int count = cluster_settings_unpack(records, records_len, job->values, CLUSTER_REMOTE_MAX_BATCH);
+            ret = count > 0 ? ESP_OK : ESP_ERR_INVALID_SIZE;
+            job->count = count > 0 ? (uint8_t)count : 0;
+        }
+    } else {
+        size_t count = 0;
+        ret = cluster_protocol_decode_setting_get(payload, &node, &job->req_id, job->ids,
+                                                  sizeof(job->ids), &count);
+        job->count = (uint8_t)count;
+    }
+
+    if (ret != ESP_OK || node != cluster_slave_get_node_addr()) {
+        // Malformed, or for another node on a shared medium
+        free(job);
+        return ret;
+    }
+
+    // A resent request: answer again if done, otherwise it is still being applied
+    char resend[REMOTE_SENTENCE_MAX];
+    int resend_len = 0;
+    bool duplicate = false;
+    xSemaphoreTake(g_rcfg_slave.mutex, portMAX_DELAY);
+    if (g_rcfg_slave.have_last && g_rcfg_slave.last_req == job->req_id) {
+        duplicate = true;
+        if (g_rcfg_slave.last_done) {
+            resend_len = g_rcfg_slave.last_reply_len;
+            memcpy(resend, g_rcfg_slave.last_reply, resend_len);
+        }
+    } else if (uxQueueMessagesWaiting(g_rcfg_slave.queue) < REMOTE_QUEUE_DEPTH) {
+        g_rcfg_slave.have_last = true;
+        g_rcfg_slave.last_req = job->req_id;
+        g_rcfg_slave.last_done = false;
+    } else {
+        duplicate = true;       // Dropped; the master resends
+    }
+    xSemaphoreGive(g_rcfg_slave.mutex);
+
+    if (duplicate) {
+        if (resend_len > 0) {
+            send_reply(resend, resend_len);
+        }
+        free(job);
+        return ESP_OK;
+    }
+
+    if (xQueueSend(g_rcfg_slave.queue, job, 0) != pdTRUE) {
+        reply(job->req_id, CLUSTER_RESP_BUSY, -1, NULL, 0);
+    }
+    free(job);
+    return ESP_OK;
+}
+
+esp_err_t cluster_remote_config_init(void)
+{
+    memset(&g_rcfg_slave, 0, sizeof(g_rcfg_slave));
+    g_rcfg_slave.mutex = xSemaphoreCreateMutex();
+    g_rcfg_slave.queue = xQueueCreate(REMOTE_QUEUE_DEPTH, sizeof(remote_job_t));
+    if (!g_rcfg_slave.mutex || !g_rcfg_slave.queue) {
+        ESP_LOGE(TAG, "Failed to create remote config queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(remote_config_task, "cluster_rcfg", REMOTE_TASK_STACK_SIZE, NULL,
+                    REMOTE_TASK_PRIORITY, &g_rcfg_slave.task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create remote config task");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void cluster_remote_config_deinit(void)
+{
+    if (g_rcfg_slave.task) {
+        vTaskDelete(g_rcfg_slave.task);
+        g_rcfg_slave.task = NULL;
+    }
+    if (g_rcfg_slave.queue) {
+        vQueueDelete(g_rcfg_slave.queue);
+        g_rcfg_slave.queue = NULL;
+    }
+    if (g_rcfg_slave.mutex) {
+        vSemaphoreDelete(g_rcfg_slave.mutex);
+        g_rcfg_slave.mutex = NULL;
+    }
+}
+
+#endif // CLUSTER_IS_SLAVE
+
+#endif // CLUSTER_ENABLED
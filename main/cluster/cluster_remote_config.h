@@ -6,10 +6,17 @@
  * Essential for ESP-NOW mode where slaves may not have direct web access.
  *
  * Protocol Messages:
- *   $CLCFG - Configuration request/response
- *   $CLCMD - Remote command execution
- *   $CLGET - Get setting value
- *   $CLSET - Set setting value
+ *   $CLGET - Read settings: master -> slave
+ *   $CLSET - Write a batch of settings: master -> slave
+ *   $CLSTR - Result and read-back values: slave -> master
+ *
+ * Every request carries a 16-bit request id that its $CLSTR echoes. The
+ * master resends until answered; a slave that sees a request id again
+ * resends its answer without applying anything twice. A batch is checked
+ * as a whole before anything is applied, so either every setting in it
+ * takes effect or none does. With CLUSTER_REMOTE_FLAG_RAMP, frequency and
+ * voltage move to the target in steps (voltage up before frequency,
+ * frequency down before voltage). Settings are packed by cluster_settings.h.
  *
  * @author ClusterAxe Project
  * @license GPL-3.0
@@ -20,6 +27,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
 #include "cluster_config.h"
 
@@ -74,22 +82,6 @@ typedef enum {
 #define CLUSTER_SETTING_TRANSPORT       0x62    // BAP/ESP-NOW
 #define CLUSTER_SETTING_RSSI            0x63    // Read-only (ESP-NOW signal)
 
-// ============================================================================
-// Remote Commands
-// ============================================================================
-
-typedef enum {
-    CLUSTER_CMD_RESTART = 0,        // Restart device
-    CLUSTER_CMD_FACTORY_RESET,      // Factory reset
-    CLUSTER_CMD_OTA_START,          // Start OTA update
-    CLUSTER_CMD_SAVE_SETTINGS,      // Save current settings to NVS
-    CLUSTER_CMD_LOAD_DEFAULTS,      // Load default settings
-    CLUSTER_CMD_IDENTIFY,           // Flash LED for identification
-    CLUSTER_CMD_START_MINING,       // Start/resume mining
-    CLUSTER_CMD_STOP_MINING,        // Stop mining
-    CLUSTER_CMD_CALIBRATE,          // Run ASIC calibration
-} cluster_remote_cmd_t;
-
 // ============================================================================
 // Response Status Codes
 // ============================================================================
@@ -103,18 +95,26 @@ typedef enum {
     CLUSTER_RESP_NOT_SUPPORTED,     // Feature not supported
     CLUSTER_RESP_BUSY,              // Device busy, try later
     CLUSTER_RESP_AUTH_REQUIRED,     // Authentication needed
+    CLUSTER_RESP_TIMEOUT,           // No answer from the slave (master only)
 } cluster_response_status_t;
 
 // ============================================================================
 // Data Structures
 // ============================================================================
 
+#define CLUSTER_SETTING_TYPE_U32        0
+#define CLUSTER_SETTING_TYPE_I32        1
+#define CLUSTER_SETTING_TYPE_FLOAT      2
+#define CLUSTER_SETTING_TYPE_STRING     3
+#define CLUSTER_SETTING_TYPE_BOOL       4
+#define CLUSTER_SETTING_TYPE_NONE       0xFF    // Not readable (in $CLSTR)
+
 /**
  * @brief Setting value (union for different types)
  */
 typedef struct {
     uint8_t setting_id;
-    uint8_t data_type;      // 0=uint32, 1=int32, 2=float, 3=string, 4=bool
+    uint8_t data_type;      // CLUSTER_SETTING_TYPE_*
     union {
         uint32_t    u32;
         int32_t     i32;
@@ -124,122 +124,78 @@ typedef struct {
     } value;
 } cluster_setting_value_t;
 
-/**
- * @brief Configuration snapshot (all settings)
- */
-typedef struct {
-    // System
-    char        hostname[32];
-    char        device_model[16];
-    char        fw_version[16];
-    uint32_t    uptime_seconds;
-    uint32_t    free_heap;
-
-    // Mining
-    uint16_t    frequency;          // MHz
-    uint16_t    core_voltage;       // mV
-    uint8_t     fan_speed;          // % (0-100)
-    uint8_t     fan_mode;           // 0=auto, 1=manual
-    uint8_t     target_temp;        // Celsius
-    uint32_t    hashrate;           // GH/s * 100
-    float       power;              // Watts
-    float       efficiency;         // J/TH
-    float       chip_temp;          // Celsius
-
-    // Network
-    char        wifi_ssid[32];
-    char        ip_addr[16];
-    uint8_t     wifi_status;        // 0=disconnected, 1=connected
-
-    // Cluster
-    uint8_t     slave_id;
-    int8_t      rssi;               // dBm (ESP-NOW only)
-} cluster_config_snapshot_t;
+// Settings in one $CLGET/$CLSET
+#define CLUSTER_REMOTE_MAX_BATCH        6
+
+// $CLSET flags
+#define CLUSTER_REMOTE_FLAG_RAMP        0x01    // Step frequency/voltage to the target
+
+// No setting to blame in a result
+#define CLUSTER_REMOTE_NO_INDEX         0xFF
 
 /**
- * @brief Remote command request
+ * @brief One slave's batch for cluster_master_set_slaves_settings()
  */
 typedef struct {
-    uint8_t     slave_id;           // Target slave (0xFF = all)
-    cluster_remote_cmd_t cmd;
-    uint8_t     params[32];         // Command-specific parameters
-    uint8_t     params_len;
-} cluster_remote_cmd_request_t;
+    uint8_t                     slave_id;
+    uint8_t                     count;
+    cluster_setting_value_t     values[CLUSTER_REMOTE_MAX_BATCH];
+
+    // Filled in on return
+    cluster_response_status_t   status;
+    uint8_t                     bad_index;      // Setting status refers to, or CLUSTER_REMOTE_NO_INDEX
+} cluster_remote_set_t;
 
 /**
- * @brief Remote command response
+ * @brief Set up request tracking (master) or the apply task (slave)
+ *
+ * Called from cluster_master_init() / cluster_slave_init().
  */
-typedef struct {
-    uint8_t     slave_id;
-    cluster_remote_cmd_t cmd;
-    cluster_response_status_t status;
-    char        message[64];        // Status message
-} cluster_remote_cmd_response_t;
+esp_err_t cluster_remote_config_init(void);
+
+void cluster_remote_config_deinit(void);
 
 // ============================================================================
 // Master API - Send configuration requests to slaves
 // ============================================================================
 
 /**
- * @brief Request full configuration from a slave
- * @param slave_id Target slave ID
- * @param callback Function to call with result
- * @param ctx User context
- * @return ESP_OK if request sent
+ * @brief Write a batch of settings to each of several slaves
+ *
+ * Every request goes out before the first answer is awaited, so n slaves
+ * take about one round trip rather than n. Unanswered requests are resent
+ * until timeout_ms.
+ *
+ * @param sets One batch per slave; status and bad_index are filled in
+ * @param flags CLUSTER_REMOTE_FLAG_*
+ * @param timeout_ms Give up after this long (0 = CONFIG_CLUSTER_REMOTE_CONFIG_TIMEOUT_MS)
+ * @return ESP_OK if every slave applied its batch, ESP_ERR_TIMEOUT if any
+ *         did not answer, ESP_FAIL if any refused
  */
-typedef void (*cluster_config_callback_t)(uint8_t slave_id,
-                                           const cluster_config_snapshot_t *config,
-                                           cluster_response_status_t status,
-                                           void *ctx);
-
-esp_err_t cluster_master_get_slave_config(uint8_t slave_id,
-                                           cluster_config_callback_t callback,
-                                           void *ctx);
+esp_err_t cluster_master_set_slaves_settings(cluster_remote_set_t *sets, int n,
+                                             uint8_t flags, uint32_t timeout_ms);
 
 /**
- * @brief Get a specific setting from a slave
- * @param slave_id Target slave ID
- * @param setting_id Setting to read
- * @param callback Function to call with result
- * @param ctx User context
- * @return ESP_OK if request sent
+ * @brief Read settings from a slave
+ * @param values Output, one per id; CLUSTER_SETTING_TYPE_NONE if unreadable
+ * @return ESP_OK if the slave answered (even if some were unreadable)
  */
-typedef void (*cluster_setting_callback_t)(uint8_t slave_id,
-                                            const cluster_setting_value_t *value,
-                                            cluster_response_status_t status,
-                                            void *ctx);
-
-esp_err_t cluster_master_get_slave_setting(uint8_t slave_id,
-                                            uint8_t setting_id,
-                                            cluster_setting_callback_t callback,
-                                            void *ctx);
+esp_err_t cluster_master_get_slave_settings(uint8_t slave_id,
+                                            const uint8_t *setting_ids,
+                                            int count,
+                                            cluster_setting_value_t *values,
+                                            uint32_t timeout_ms);
 
 /**
  * @brief Set a setting on a slave
- * @param slave_id Target slave ID (0xFF = all slaves)
- * @param value Setting ID and value to set
- * @param callback Function to call with result
- * @param ctx User context
- * @return ESP_OK if request sent
  */
 esp_err_t cluster_master_set_slave_setting(uint8_t slave_id,
-                                            const cluster_setting_value_t *value,
-                                            cluster_setting_callback_t callback,
-                                            void *ctx);
+                                            const cluster_setting_value_t *value);
 
 /**
- * @brief Execute remote command on a slave
- * @param request Command request
- * @param callback Function to call with result
- * @param ctx User context
- * @return ESP_OK if request sent
+ * @brief Move a slave to a frequency and voltage together, ramped
  */
-typedef void (*cluster_cmd_callback_t)(const cluster_remote_cmd_response_t *response,
-                                        void *ctx);
-
-esp_err_t cluster_master_send_command(const cluster_remote_cmd_request_t *request,
-                                       cluster_cmd_callback_t callback,
-                                       void *ctx);
+esp_err_t cluster_master_set_slave_mining(uint8_t slave_id, uint16_t freq_mhz, uint16_t voltage_mv);
 
 /**
  * @brief Convenience: Set frequency on slave
@@ -252,33 +208,26 @@ esp_err_t cluster_master_set_slave_frequency(uint8_t slave_id, uint16_t freq_mhz
 esp_err_t cluster_master_set_slave_voltage(uint8_t slave_id, uint16_t voltage_mv);
 
 /**
- * @brief Convenience: Set fan speed on slave
+ * @brief Convenience: Set fan speed on slave (switches it to manual)
  */
 esp_err_t cluster_master_set_slave_fan(uint8_t slave_id, uint8_t speed_percent);
 
 /**
- * @brief Convenience: Restart a slave
- */
-esp_err_t cluster_master_restart_slave(uint8_t slave_id);
-
-/**
- * @brief Convenience: Restart all slaves
+ * @brief Handle a $CLSTR from a slave (called by message handler)
  */
-esp_err_t cluster_master_restart_all_slaves(void);
+esp_err_t cluster_master_handle_config_reply(const char *payload, size_t len);
 
 // ============================================================================
 // Slave API - Handle incoming configuration requests
 // ============================================================================
 
-/**
- * @brief Initialize remote config handler on slave
- * @return ESP_OK on success
- */
-esp_err_t cluster_slave_remote_config_init(void);
-
 /**
  * @brief Handle incoming config request (called by message handler)
- * @param msg_type Message type (CLCFG, CLGET, CLSET, CLCMD)
+ *
+ * Requests for this node are queued to the apply task, which answers with
+ * a $CLSTR when done.
+ *
+ * @param msg_type Message type (CLGET, CLSET)
  * @param payload Message payload
  * @param len Payload length
  * @return ESP_OK on success
@@ -288,85 +237,22 @@ esp_err_t cluster_slave_handle_config_message(const char *msg_type,
                                                size_t len);
 
 /**
- * @brief Get current config snapshot (for sending to master)
- * @param config Output: configuration snapshot
- * @return ESP_OK on success
- */
-esp_err_t cluster_slave_get_config_snapshot(cluster_config_snapshot_t *config);
-
-/**
- * @brief Apply a setting value
- * @param value Setting to apply
+ * @brief Read a setting's current value
  * @return Response status
  */
-cluster_response_status_t cluster_slave_apply_setting(const cluster_setting_value_t *value);
-
-// ============================================================================
-// Protocol Message Encoding/Decoding
-// ============================================================================
+cluster_response_status_t cluster_slave_read_setting(uint8_t setting_id,
+                                                     cluster_setting_value_t *value);
 
 /**
- * @brief Encode GET request message
- * Format: $CLGET,slave_id,setting_id*XX
- */
-int cluster_encode_get_request(char *buf, size_t buf_len,
-                                uint8_t slave_id, uint8_t setting_id);
-
-/**
- * @brief Encode SET request message
- * Format: $CLSET,slave_id,setting_id,type,value*XX
- */
-int cluster_encode_set_request(char *buf, size_t buf_len,
-                                uint8_t slave_id,
-                                const cluster_setting_value_t *value);
-
-/**
- * @brief Encode config request message
- * Format: $CLCFG,slave_id,category*XX
- */
-int cluster_encode_config_request(char *buf, size_t buf_len,
-                                   uint8_t slave_id,
-                                   cluster_config_category_t category);
-
-/**
- * @brief Encode command request message
- * Format: $CLCMD,slave_id,cmd_id,params...*XX
- */
-int cluster_encode_cmd_request(char *buf, size_t buf_len,
-                                const cluster_remote_cmd_request_t *request);
-
-/**
- * @brief Encode config response message
- * Format: $CLCFR,slave_id,status,data...*XX
- */
-int cluster_encode_config_response(char *buf, size_t buf_len,
-                                    uint8_t slave_id,
-                                    cluster_response_status_t status,
-                                    const cluster_config_snapshot_t *config);
-
-/**
- * @brief Encode setting response message
- * Format: $CLSTR,slave_id,status,setting_id,type,value*XX
- */
-int cluster_encode_setting_response(char *buf, size_t buf_len,
-                                     uint8_t slave_id,
-                                     cluster_response_status_t status,
-                                     const cluster_setting_value_t *value);
-
-/**
- * @brief Decode incoming config/setting messages
+ * @brief Apply a batch of settings, all or none
+ * @param flags CLUSTER_REMOTE_FLAG_*
+ * @param bad_index Output: setting the status refers to
+ * @return Response status
  */
-esp_err_t cluster_decode_get_request(const char *payload, size_t len,
-                                      uint8_t *slave_id, uint8_t *setting_id);
-
-esp_err_t cluster_decode_set_request(const char *payload, size_t len,
-                                      uint8_t *slave_id,
-                                      cluster_setting_value_t *value);
-
-esp_err_t cluster_decode_config_response(const char *payload, size_t len,
-                                          uint8_t *slave_id,
-                                          cluster_response_status_t *status,
-                                          cluster_config_snapshot_t *config);
+cluster_response_status_t cluster_slave_apply_settings(const cluster_setting_value_t *values,
+                                                       int count,
+                                                       uint8_t flags,
+                                                       int *bad_index);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,315 @@
+/**
+ * @file cluster_settings.c
+ * @brief ClusterAxe remote setting batches: wire format, limits and ramps
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#include "cluster_settings.h"
+#include <string.h>
+
+// ============================================================================
+// Setting Table
+// ============================================================================
+
+static const cluster_setting_desc_t SETTINGS[] = {
+    // System
+    { CLUSTER_SETTING_HOSTNAME,     CLUSTER_SETTING_TYPE_STRING, false, 0, 0 },
+    { CLUSTER_SETTING_DEVICE_MODEL, CLUSTER_SETTING_TYPE_STRING, false, 0, 0 },
+    { CLUSTER_SETTING_FW_VERSION,   CLUSTER_SETTING_TYPE_STRING, false, 0, 0 },
+    { CLUSTER_SETTING_UPTIME,       CLUSTER_SETTING_TYPE_U32,    false, 0, 0 },
+    { CLUSTER_SETTING_FREE_HEAP,    CLUSTER_SETTING_TYPE_U32,    false, 0, 0 },
+    { CLUSTER_SETTING_CHIP_TEMP,    CLUSTER_SETTING_TYPE_FLOAT,  false, 0, 0 },
+
+    // Mining
+    { CLUSTER_SETTING_FREQUENCY,    CLUSTER_SETTING_TYPE_U32,    true,  100, 1200 },
+    { CLUSTER_SETTING_CORE_VOLTAGE, CLUSTER_SETTING_TYPE_U32,    true,  800, 1400 },
+    { CLUSTER_SETTING_FAN_SPEED,    CLUSTER_SETTING_TYPE_U32,    true,  0,   100 },
+    { CLUSTER_SETTING_FAN_MODE,     CLUSTER_SETTING_TYPE_U32,    true,  0,   1 },
+    { CLUSTER_SETTING_TARGET_TEMP,  CLUSTER_SETTING_TYPE_U32,    true,  35,  66 },
+    { CLUSTER_SETTING_HASHRATE,     CLUSTER_SETTING_TYPE_U32,    false, 0, 0 },
+    { CLUSTER_SETTING_POWER,        CLUSTER_SETTING_TYPE_FLOAT,  false, 0, 0 },
+    { CLUSTER_SETTING_EFFICIENCY,   CLUSTER_SETTING_TYPE_FLOAT,  false, 0, 0 },
+    { CLUSTER_SETTING_ASIC_COUNT,   CLUSTER_SETTING_TYPE_U32,    false, 0, 0 },
+
+    // Network (WiFi credentials are not exposed)
+    { CLUSTER_SETTING_IP_ADDR,      CLUSTER_SETTING_TYPE_STRING, false, 0, 0 },
+    { CLUSTER_SETTING_WIFI_STATUS,  CLUSTER_SETTING_TYPE_U32,    false, 0, 0 },
+
+    // Cluster
+    { CLUSTER_SETTING_SLAVE_ID,     CLUSTER_SETTING_TYPE_U32,    false, 0, 0 },
+    { CLUSTER_SETTING_MASTER_MAC,   CLUSTER_SETTING_TYPE_STRING, false, 0, 0 },
+    { CLUSTER_SETTING_TRANSPORT,    CLUSTER_SETTING_TYPE_U32,    false, 0, 0 },
+    { CLUSTER_SETTING_RSSI,         CLUSTER_SETTING_TYPE_I32,    false, 0, 0 },
+};
+
+#define SETTING_COUNT   (sizeof(SETTINGS) / sizeof(SETTINGS[0]))
+
+const cluster_setting_desc_t *cluster_settings_find(uint8_t id)
+{
+    for (size_t i = 0; i < SETTING_COUNT; i++) {
+        if (SETTINGS[i].id == id) {
+            return &SETTINGS[i];
+        }
+    }
+    return NULL;
+}
+
+// ============================================================================
+// Wire Format
+// ============================================================================
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+int cluster_settings_pack(const cluster_setting_value_t *values, int count,
+                          uint8_t *buf, size_t buf_len)
+{
+    if (!values || !buf || count < 0) {
+        return -1;
+    }
+
+    size_t o = 0;
+    for (int i = 0; i < count; i++) {
+        const cluster_setting_value_t *v = &values[i];
+        size_t need = 2;
+        size_t str_len = 0;
+
+        switch (v->data_type) {
+            case CLUSTER_SETTING_TYPE_U32:
+            case CLUSTER_SETTING_TYPE_I32:
+            case CLUSTER_SETTING_TYPE_FLOAT:
+                need += 4;
+                break;
+            case CLUSTER_SETTING_TYPE_BOOL:
+                need += 1;
+                break;
+            case CLUSTER_SETTING_TYPE_STRING:
+                str_len = strnlen(v->value.str, sizeof(v->value.str));
+                if (str_len > CLUSTER_SETTINGS_STR_MAX) {
+                    return -1;
+                }
+                need += 1 + str_len;
+                break;
+            case CLUSTER_SETTING_TYPE_NONE:
+                break;
+            default:
+                return -1;
+        }
+        if (o + need > buf_len) {
+            return -1;
+        }
+
+        buf[o++] = v->setting_id;
+        buf[o++] = v->data_type;
+        switch (v->data_type) {
+            case CLUSTER_SETTING_TYPE_U32:
+                put_u32(buf + o, v->value.u32);
+                o += 4;
+                break;
+            case CLUSTER_SETTING_TYPE_I32:
+                put_u32(buf + o, (uint32_t)v->value.i32);
+                o += 4;
+                break;
+            case CLUSTER_SETTING_TYPE_FLOAT: {
+                uint32_t bits;
+                memcpy(&bits, &v->value.f32, sizeof(bits));
+                put_u32(buf + o, bits);
+                o += 4;
+                break;
+            }
+            case CLUSTER_SETTING_TYPE_BOOL:
+                buf[o++] = v->value.b ? 1 : 0;
+                break;
+            case CLUSTER_SETTING_TYPE_STRING:
+                buf[o++] = (uint8_t)str_len;
+                memcpy(buf + o, v->value.str, str_len);
+                o += str_len;
+                break;
+            default:
+                break;
+        }
+    }
+    return (int)o;
+}
+
+int cluster_settings_unpack(const uint8_t *buf, size_t len,
+                            cluster_setting_value_t *values, int max)
+{
+    if (!buf || !values) {
+        return -1;
+    }
+
+    size_t p = 0;
+    int count = 0;
+    while (p < len) {
+        if (count >= max || p + 2 > len) {
+            return -1;
+        }
+        cluster_setting_value_t *v = &values[count];
+        memset(v, 0, sizeof(*v));
+        v->setting_id = buf[p++];
+        v->data_type = buf[p++];
+
+        switch (v->data_type) {
+            case CLUSTER_SETTING_TYPE_U32:
+            case CLUSTER_SETTING_TYPE_I32:
+            case CLUSTER_SETTING_TYPE_FLOAT: {
+                if (p + 4 > len) {
+                    return -1;
+                }
+                uint32_t bits = get_u32(buf + p);
+                p += 4;
+                if (v->data_type == CLUSTER_SETTING_TYPE_U32) {
+                    v->value.u32 = bits;
+                } else if (v->data_type == CLUSTER_SETTING_TYPE_I32) {
+                    v->value.i32 = (int32_t)bits;
+                } else {
+                    memcpy(&v->value.f32, &bits, sizeof(bits));
+                }
+                break;
+            }
+            case CLUSTER_SETTING_TYPE_BOOL:
+                if (p + 1 > len) {
+                    return -1;
+                }
+                v->value.b = buf[p++] != 0;
+                break;
+            case CLUSTER_SETTING_TYPE_STRING: {
+                if (p + 1 > len) {
+                    return -1;
+                }
+                size_t str_len = buf[p++];
+                if (str_len > CLUSTER_SETTINGS_STR_MAX || p + str_len > len) {
+                    return -1;
+                }
+                memcpy(v->value.str, buf + p, str_len);
+                v->value.str[str_len] = '\0';
+                p += str_len;
+                break;
+            }
+            case CLUSTER_SETTING_TYPE_NONE:
+                break;
+            default:
+                return -1;
+        }
+        count++;
+    }
+    return count;
+}
+
+// ============================================================================
+// Validation
+// ============================================================================
+
+cluster_response_status_t cluster_settings_validate(const cluster_setting_value_t *values,
+                                                    int count, int *bad_index)
+{
+    if (bad_index) {
+        *bad_index = -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const cluster_setting_value_t *v = &values[i];
+        cluster_response_status_t status = CLUSTER_RESP_OK;
+        const cluster_setting_desc_t *desc = cluster_settings_find(v->setting_id);
+
+        if (!desc) {
+            status = CLUSTER_RESP_INVALID_SETTING;
+        } else if (!desc->writable) {
+            status = CLUSTER_RESP_READ_ONLY;
+        } else if (v->data_type != desc->type) {
+            status = CLUSTER_RESP_INVALID_VALUE;
+        } else if (desc->type == CLUSTER_SETTING_TYPE_U32 &&
+                   (v->value.u32 < (uint32_t)desc->min || v->value.u32 > (uint32_t)desc->max)) {
+            status = CLUSTER_RESP_INVALID_VALUE;
+        } else if (desc->type == CLUSTER_SETTING_TYPE_I32 &&
+                   (v->value.i32 < desc->min || v->value.i32 > desc->max)) {
+            status = CLUSTER_RESP_INVALID_VALUE;
+        }
+
+        // The same setting twice leaves which one wins up to the order
+        for (int j = 0; j < i && status == CLUSTER_RESP_OK; j++) {
+            if (values[j].setting_id == v->setting_id) {
+                status = CLUSTER_RESP_INVALID_VALUE;
+            }
+        }
+
+        if (status != CLUSTER_RESP_OK) {
+            if (bad_index) {
+                *bad_index = i;
+            }
+            return status;
+        }
+    }
+    return CLUSTER_RESP_OK;
+}
+
+// ============================================================================
+// Frequency/Voltage Ramp
+// ============================================================================
+
+static bool ramp_push(cluster_settings_ramp_step_t *steps, int max, int *n,
+                      uint16_t freq_mhz, uint16_t voltage_mv)
+{
+    if (*n >= max) {
+        return false;
+    }
+    steps[*n].freq_mhz = freq_mhz;
+    steps[*n].voltage_mv = voltage_mv;
+    (*n)++;
+    return true;
+}
+
+static uint16_t step_toward(uint16_t from, uint16_t to, uint16_t step)
+{
+    if (from < to) {
+        return (to - from > step) ? from + step : to;
+    }
+    return (from - to > step) ? from - step : to;
+}
+
+int cluster_settings_plan_ramp(uint16_t from_mhz, uint16_t from_mv,
+                               uint16_t to_mhz, uint16_t to_mv,
+                               uint16_t step_mhz, uint16_t step_mv,
+                               cluster_settings_ramp_step_t *steps, int max)
+{
+    if (!steps || step_mhz == 0 || step_mv == 0) {
+        return -1;
+    }
+
+    int n = 0;
+    uint16_t freq = from_mhz;
+    uint16_t mv = from_mv;
+
+    while (mv < to_mv) {
+        mv = step_toward(mv, to_mv, step_mv);
+        if (!ramp_push(steps, max, &n, freq, mv)) {
+            return -1;
+        }
+    }
+    while (freq != to_mhz) {
+        freq = step_toward(freq, to_mhz, step_mhz);
+        if (!ramp_push(steps, max, &n, freq, mv)) {
+            return -1;
+        }
+    }
+    while (mv > to_mv) {
+        mv = step_toward(mv, to_mv, step_mv);
+        if (!ramp_push(steps, max, &n, freq, mv)) {
+            return -1;
+        }
+    }
+    return n;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file cluster_settings.h
+ * @brief ClusterAxe remote setting batches: wire format, limits and ramps
+ *
+ * $CLSET and $CLSTR (cluster_remote_config.h) carry settings packed as
+ * records, base64 encoded by cluster_protocol.c:
+ *
+ *   id u8, type u8, value
+ *
+ * where value is 4 bytes little-endian for u32/i32/float, 1 byte for bool
+ * and a length byte plus that many characters for strings. $CLGET carries
+ * the bare setting ids. A $CLSTR answering a $CLGET has one record per
+ * requested id, typed CLUSTER_SETTING_TYPE_NONE (no value) where it could
+ * not be read.
+ *
+ * The setting table gives each id its type, whether it can be written and
+ * its range, so a slave can check a whole batch before applying any of it.
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#ifndef CLUSTER_SETTINGS_H
+#define CLUSTER_SETTINGS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cluster_remote_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Packed records in one sentence: fits an ESP-NOW frame once base64 encoded
+#define CLUSTER_SETTINGS_WIRE_MAX       150
+
+// Longest string value on the wire, without terminator
+#define CLUSTER_SETTINGS_STR_MAX        31
+
+// Most steps a ramp can take: enough for any two points in range at 25 MHz / 25 mV
+#define CLUSTER_SETTINGS_RAMP_MAX       96
+
+typedef struct {
+    uint8_t     id;
+    uint8_t     type;                   // CLUSTER_SETTING_TYPE_*
+    bool        writable;
+    int32_t     min;                    // Numeric range, writable settings only
+    int32_t     max;
+} cluster_setting_desc_t;
+
+typedef struct {
+    uint16_t    freq_mhz;
+    uint16_t    voltage_mv;
+} cluster_settings_ramp_step_t;
+
+/**
+ * @brief Look up a setting
+ * @return Its description, or NULL for an unknown id
+ */
+const cluster_setting_desc_t *cluster_settings_find(uint8_t id);
+
+/**
+ * @brief Pack values into records
+ * @return Bytes written, or -1 (bad type, string too long, buffer too small)
+ */
+int cluster_settings_pack(const cluster_setting_value_t *values, int count,
+                          uint8_t *buf, size_t buf_len);
+
+/**
+ * @brief Unpack records
+ * @return Values written, or -1 if truncated, malformed or more than max
+ */
+int cluster_settings_unpack(const uint8_t *buf, size_t len,
+                            cluster_setting_value_t *values, int max);
+
+/**
+ * @brief Check a batch for writing
+ *
+ * Every setting must be known, writable, of its table type and in range,
+ * and appear once.
+ *
+ * @param bad_index Output: first offending setting, or -1
+ * @return CLUSTER_RESP_OK or the reason the batch is refused
+ */
+cluster_response_status_t cluster_settings_validate(const cluster_setting_value_t *values,
+                                                    int count, int *bad_index);
+
+/**
+ * @brief Plan the steps from one frequency/voltage point to another
+ *
+ * Voltage rises first, frequency then moves, voltage falls last, so
+ * frequency always moves at the higher of the two voltages. Each step
+ * changes one of them by at most step_mhz / step_mv; the last step is the
+ * target.
+ *
+ * @return Steps written (0 if already there), or -1 if more than max
+ */
+int cluster_settings_plan_ramp(uint16_t from_mhz, uint16_t from_mv,
+                               uint16_t to_mhz, uint16_t to_mv,
+                               uint16_t step_mhz, uint16_t step_mv,
+                               cluster_settings_ramp_step_t *steps, int max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLUSTER_SETTINGS_H
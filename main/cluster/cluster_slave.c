@@ -6,6 +6,10 @@
  * performs mining on its assigned nonce range, and reports
  * found shares back to the master.
  *
+ * If the uplink goes quiet the slave keeps mining: it rolls ntime on its
+ * last work for up to CLUSTER_AUTONOMOUS_MAX_MS and holds the shares it
+ * finds in a replay ring (mirrored to NVS) until the uplink is back.
+ *
  * @author Clusteraxe Project
  * @license GPL-3.0
  */
@@ -13,10 +17,18 @@
 #include "cluster.h"
 #include "cluster_protocol.h"
 #include "cluster_config.h"
+#include "cluster_topology.h"
+#include "cluster_relay.h"
+#include "cluster_remote_config.h"
+#include "cluster_telemetry.h"
+#include "cluster_trace.h"
+#include "cluster_transport.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "nvs.h"
 #include "string.h"
 #include "stdio.h"
+#include "stdlib.h"
 
 #if CLUSTER_ENABLED && CLUSTER_IS_SLAVE
 
@@ -92,6 +104,12 @@ __attribute__((weak)) float cluster_get_voltage_in(void)
     return 0.0f;
 }
 
+// Board stats beyond the heartbeat for binary telemetry
+__attribute__((weak)) void cluster_get_board_telemetry(cluster_board_telemetry_t *board)
+{
+    memset(board, 0, sizeof(*board));
+}
+
 // Submit work to ASIC (will be integrated with create_jobs_task)
 __attribute__((weak)) void cluster_submit_work_to_asic(const cluster_work_t *work)
 {
@@ -105,6 +123,26 @@ __attribute__((weak)) void cluster_submit_work_to_asic(const cluster_work_t *wor
 
 static cluster_slave_state_t *g_slave = NULL;
 
+// Telemetry encoder; last_ack tells whether the uplink speaks telemetry
+static struct {
+    SemaphoreHandle_t       mutex;
+    cluster_telemetry_tx_t  tx;
+    int64_t                 last_ack;       // ms, 0 = never
+} g_tlm;
+
+// Clock exchange with the uplink, see cluster_clock.h (guarded by g_tlm.mutex)
+static struct {
+    int64_t                 sent_t1;        // Stamp on the last heartbeat/telemetry frame
+    int64_t                 echo_t1;        // Last stamp the uplink echoed back
+    int64_t                 echo_t4;        // When that echo arrived
+} g_clock;
+
+// Trace upload position (heartbeat task only)
+static struct {
+    uint32_t                cursor;         // Next record to upload
+    uint32_t                lost;           // Dropped since the last $CLTRC
+} g_trace;
+
 // ============================================================================
 // Job -> Extranonce2 Mapping (fixes race condition with work updates)
 // ============================================================================
@@ -158,7 +196,7 @@ esp_err_t cluster_slave_receive_work(const cluster_work_t *work)
 
     // Filter: only process work targeted at this slave
     // Work is broadcast, so each slave receives all work messages
-    if (!g_slave->registered || g_slave->my_id == 0xFF) {
+    if (!g_slave->registered || g_slave->my_id == CLUSTER_NODE_ADDR_INVALID) {
         ESP_LOGW(TAG, "Ignoring work - not registered yet");
         return ESP_ERR_INVALID_STATE;
     }
@@ -170,6 +208,7 @@ esp_err_t cluster_slave_receive_work(const cluster_work_t *work)
     }
 
     ESP_LOGI(TAG, "Work is for me (slave %d), processing...", g_slave->my_id);
+    cluster_trace_record(CLUSTER_TRACE_WORK_RX, g_slave->my_id, work->job_id, 0);
 
     xSemaphoreTake(g_slave->work_mutex, portMAX_DELAY);
 
@@ -185,6 +224,11 @@ esp_err_t cluster_slave_receive_work(const cluster_work_t *work)
              (unsigned long)work->nonce_start,
              (unsigned long)work->nonce_end);
 
+#if CLUSTER_IS_RELAY
+    // Subdivide for downstream slaves
+    cluster_relay_on_parent_work(work);
+#endif
+
     // Notify worker task that new work is available
     if (g_slave->worker_task) {
         xTaskNotifyGive(g_slave->worker_task);
@@ -220,12 +264,162 @@ bool cluster_slave_has_work(void)
     return g_slave && g_slave->work_valid;
 }
 
+// ============================================================================
+// Share Replay Ring
+// ============================================================================
+// Shares that could not be delivered (uplink down, or unicast never
+// acknowledged) wait here and are resent once the uplink is heard from
+// again. The ring is kept oldest-first in one array so it can be saved to
+// NVS as a single blob; a reboot during an outage does not lose it. The
+// master's dedup and job index drop replays that arrived anyway or went
+// stale. Only the share sender task touches the ring after init.
+
+#define REPLAY_NVS_NAMESPACE    "cluster"
+#define REPLAY_NVS_KEY          "share_ring"
+#define REPLAY_MAX_ATTEMPTS     3       // Unicast tries per share once the link is back
+#define REPLAY_POLL_MS          500     // Sender wake-up while shares are held
+#define REPLAY_SAVE_MS          5000    // Minimum spacing of NVS writes
+
+typedef struct {
+    cluster_share_t share;
+    uint8_t         attempts;
+} replay_entry_t;
+
+static struct {
+    replay_entry_t  entries[CLUSTER_SHARE_REPLAY_SIZE];
+    uint16_t        count;
+    bool            dirty;              // Differs from the NVS copy
+    int64_t         last_save;          // ms
+} g_replay;
+
+static void replay_drop_oldest(void)
+{
+    memmove(&g_replay.entries[0], &g_replay.entries[1],
+            (g_replay.count - 1) * sizeof(replay_entry_t));
+    g_replay.count--;
+    g_replay.dirty = true;
+}
+
+static void replay_push(const cluster_share_t *share, uint8_t attempts)
+{
+    if (g_replay.count == CLUSTER_SHARE_REPLAY_SIZE) {
+        // The oldest share is the most likely to be stale by now
+        ESP_LOGW(TAG, "Replay ring full, dropping share job %lu",
+                 (unsigned long)g_replay.entries[0].share.job_id);
+        replay_drop_oldest();
+        g_slave->shares_lost++;
+    }
+
+    g_replay.entries[g_replay.count].share = *share;
+    g_replay.entries[g_replay.count].attempts = attempts;
+    g_replay.count++;
+    g_replay.dirty = true;
+}
+
+static void replay_load(void)
+{
+    nvs_handle_t handle;
+    if (nvs_open(REPLAY_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+
+    size_t len = sizeof(g_replay.entries);
+    if (nvs_get_blob(handle, REPLAY_NVS_KEY, g_replay.entries, &len) == ESP_OK &&
+        len % sizeof(replay_entry_t) == 0) {
+        g_replay.count = len / sizeof(replay_entry_t);
+    }
+    nvs_close(handle);
+
+    if (g_replay.count > 0) {
+        ESP_LOGI(TAG, "Loaded %d share(s) held from before restart", g_replay.count);
+    }
+}
+
+static void replay_save(void)
+{
+    int64_t now = esp_timer_get_time() / 1000;
+    if (!g_replay.dirty ||
+        (g_replay.count > 0 && now - g_replay.last_save < REPLAY_SAVE_MS)) {
+        return;
+    }
+    g_replay.dirty = false;
+    g_replay.last_save = now;
+
+    nvs_handle_t handle;
+    if (nvs_open(REPLAY_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+        return;
+    }
+
+    esp_err_t err;
+    if (g_replay.count == 0) {
+        err = nvs_erase_key(handle, REPLAY_NVS_KEY);
+        if (err == ESP_ERR_NVS_NOT_FOUND) {
+            err = ESP_OK;
+        }
+    } else {
+        err = nvs_set_blob(handle, REPLAY_NVS_KEY, g_replay.entries,
+                           g_replay.count * sizeof(replay_entry_t));
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save replay ring: %s", esp_err_to_name(err));
+    }
+}
+
 // ============================================================================
 // Share Submission
 // ============================================================================
 
+/**
+ * @brief Encode a share and unicast it to the uplink
+ *
+ * Without an uplink address (BAP cable) the share is broadcast instead,
+ * which is as confirmed as the cable gets.
+ *
+ * @param payload Output: encoded share, for a caller-side broadcast fallback
+ * @param len Output: payload length
+ * @return ESP_OK once delivered
+ */
+static esp_err_t transmit_share(const cluster_share_t *share, char *payload,
+                                size_t payload_size, int *len)
+{
+    *len = cluster_protocol_encode_share(share, payload, payload_size);
+    if (*len < 0) {
+        ESP_LOGE(TAG, "Failed to encode share");
+        return ESP_FAIL;
+    }
+
+    ESP_LOGD(TAG, "SHARE TX: %s (len=%d)", payload, *len);
+
+    uint8_t master_mac[6];
+    if (!cluster_transport_get_uplink_mac(master_mac)) {
+        return cluster_transport_broadcast(payload, *len);
+    }
+
+    // Retry up to 3 times with delays (master broadcasts work frequently, may miss our TX)
+    esp_err_t ret = ESP_FAIL;
+    for (int attempt = 0; attempt < 3; attempt++) {
+        ret = cluster_transport_send_to_master(payload, *len);
+        if (ret == ESP_OK) {
+            ESP_LOGD(TAG, "Share sent (attempt %d)", attempt + 1);
+            break;
+        }
+        ESP_LOGD(TAG, "Share attempt %d failed: %s", attempt + 1, esp_err_to_name(ret));
+        vTaskDelay(pdMS_TO_TICKS(30));  // Small delay before retry
+    }
+    return ret;
+}
+
 /**
  * @brief Submit share found by ASIC to master
+ *
+ * While the uplink is down the share goes straight to the replay ring.
+ * If unicast goes unacknowledged it is broadcast as a fallback and a copy
+ * is kept for replay in case that was lost too.
  */
 esp_err_t cluster_slave_submit_share(const cluster_share_t *share)
 {
@@ -233,65 +427,88 @@ esp_err_t cluster_slave_submit_share(const cluster_share_t *share)
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (!g_slave->registered) {
-        ESP_LOGW(TAG, "Cannot submit share - not registered with master");
+    if (!g_slave->registered || !cluster_slave_uplink_alive()) {
+        ESP_LOGW(TAG, "Uplink down - holding share for replay (job %lu, %d held)",
+                 (unsigned long)share->job_id, g_replay.count + 1);
+        replay_push(share, 0);
         return ESP_ERR_INVALID_STATE;
     }
 
-    // Encode share for BAP transmission
     char payload[256];
-    int len = cluster_protocol_encode_share(share, payload, sizeof(payload));
+    int len = 0;
+    esp_err_t ret = transmit_share(share, payload, sizeof(payload), &len);
 
-    if (len < 0) {
-        ESP_LOGE(TAG, "Failed to encode share");
-        return ESP_FAIL;
+    if (ret != ESP_OK && len > 0) {
+        ESP_LOGW(TAG, "Unicast failed, falling back to broadcast and holding for replay");
+        replay_push(share, 1);
+        ret = cluster_transport_broadcast(payload, len);
     }
 
-    ESP_LOGD(TAG, "SHARE TX: %s (len=%d)", payload, len);
+    if (ret == ESP_OK) {
+        cluster_trace_record(CLUSTER_TRACE_SHARE_TX, share->slave_id, share->job_id, share->nonce);
 
-    esp_err_t ret = ESP_FAIL;
+        // Relayed shares belong to downstream slaves
+        if (share->slave_id == g_slave->my_id) {
+            g_slave->shares_submitted++;
+        }
+        ESP_LOGI(TAG, "Submitted share: job %lu, nonce 0x%08lX",
+                 (unsigned long)share->job_id,
+                 (unsigned long)share->nonce);
+    } else {
+        ESP_LOGE(TAG, "Share submission FAILED: %s", esp_err_to_name(ret));
+    }
 
-    // Try ESP-NOW first if we have master MAC
-    // Send multiple times with delays to improve reliability (master may be busy TX)
-#if defined(CONFIG_CLUSTER_TRANSPORT_ESPNOW) || defined(CONFIG_CLUSTER_TRANSPORT_BOTH)
-    extern bool cluster_espnow_get_master_mac(uint8_t *mac);
-    extern esp_err_t cluster_espnow_send(const uint8_t *dest_mac, const char *data, size_t len);
+    return ret;
+}
 
-    uint8_t master_mac[6];
-    if (cluster_espnow_get_master_mac(master_mac)) {
-        // Retry up to 3 times with delays (master broadcasts work frequently, may miss our TX)
-        for (int attempt = 0; attempt < 3; attempt++) {
-            ret = cluster_espnow_send(master_mac, payload, len);
-            if (ret == ESP_OK) {
-                ESP_LOGD(TAG, "ESP-NOW share sent (attempt %d)", attempt + 1);
-                break;
-            }
-            ESP_LOGD(TAG, "ESP-NOW share attempt %d failed: %s", attempt + 1, esp_err_to_name(ret));
-            vTaskDelay(pdMS_TO_TICKS(30));  // Small delay before retry
-        }
+/**
+ * @brief Resend the oldest held share if the uplink is up
+ *
+ * Called from the share sender task when no fresh share is waiting.
+ */
+static void replay_send_one(void)
+{
+    if (g_replay.count == 0 || !cluster_slave_uplink_alive()) {
+        return;
+    }
+
+    replay_entry_t *entry = &g_replay.entries[0];
+    char payload[256];
+    int len = 0;
 
-        if (ret != ESP_OK) {
-            ESP_LOGW(TAG, "ESP-NOW failed, falling back to broadcast");
+    if (transmit_share(&entry->share, payload, sizeof(payload), &len) == ESP_OK) {
+        cluster_trace_record(CLUSTER_TRACE_SHARE_TX, entry->share.slave_id,
+                             entry->share.job_id, entry->share.nonce);
+        if (entry->share.slave_id == g_slave->my_id) {
+            g_slave->shares_submitted++;
         }
+        g_slave->shares_replayed++;
+        ESP_LOGI(TAG, "Replayed share: job %lu, nonce 0x%08lX (%d left)",
+                 (unsigned long)entry->share.job_id,
+                 (unsigned long)entry->share.nonce, g_replay.count - 1);
+        replay_drop_oldest();
+    } else if (++entry->attempts >= REPLAY_MAX_ATTEMPTS) {
+        ESP_LOGW(TAG, "Giving up on held share job %lu", (unsigned long)entry->share.job_id);
+        replay_drop_oldest();
+        g_slave->shares_lost++;
     }
-#endif
+}
 
-    // Fallback to UART broadcast if ESP-NOW failed or unavailable
-    if (ret != ESP_OK) {
-        extern esp_err_t BAP_uart_send_raw(const char *data, size_t len);
-        ret = BAP_uart_send_raw(payload, len);
+/**
+ * @brief Queue a share for transmission upstream (relay forwarding path)
+ */
+esp_err_t cluster_slave_queue_share(const cluster_share_t *share)
+{
+    if (!g_slave || !share) {
+        return ESP_ERR_INVALID_ARG;
     }
 
-    if (ret == ESP_OK) {
-        g_slave->shares_submitted++;
-        ESP_LOGI(TAG, "Submitted share: job %lu, nonce 0x%08lX",
-                 (unsigned long)share->job_id,
-                 (unsigned long)share->nonce);
-    } else {
-        ESP_LOGE(TAG, "Share submission FAILED: %s", esp_err_to_name(ret));
+    if (xQueueSend(g_slave->share_queue, share, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Share queue full, dropping share from node 0x%04X", share->slave_id);
+        return ESP_ERR_NO_MEM;
     }
 
-    return ret;
+    return ESP_OK;
 }
 
 /**
@@ -354,6 +571,7 @@ void cluster_slave_on_share_found(uint32_t nonce, uint32_t job_id, uint32_t vers
         return;
     }
     slave_record_share(nonce, job_id);
+    cluster_trace_record(CLUSTER_TRACE_SHARE_FOUND, g_slave->my_id, job_id, nonce);
 
     g_slave->shares_found++;
 
@@ -367,7 +585,7 @@ void cluster_slave_on_share_found(uint32_t nonce, uint32_t job_id, uint32_t vers
         .job_id = job_id,
         .nonce = nonce,
         .slave_id = g_slave->my_id,
-        .version = version,    // Use actual rolled version from ASIC
+        .version = version,    // Rolled bits (rolled ^ job version) from the ASIC
         .ntime = ntime,        // Use actual ntime (may be rolled)
         .timestamp = esp_timer_get_time() / 1000,
         .pool_id = pool_id     // For dual pool routing on master
@@ -432,9 +650,16 @@ esp_err_t cluster_slave_register(const char *hostname)
         return ESP_FAIL;
     }
 
+    esp_err_t ret = ESP_FAIL;
+
+    // Unicast to the uplink picked from beacons (master or relay) so other
+    // coordinators in range don't claim us
+    ret = cluster_transport_send_to_master(payload, len);
+
     // Send registration request
-    extern esp_err_t BAP_uart_send_raw(const char *data, size_t len);
-    esp_err_t ret = BAP_uart_send_raw(payload, len);
+    if (ret != ESP_OK) {
+        ret = cluster_transport_broadcast(payload, len);
+    }
 
     if (ret == ESP_OK) {
         ESP_LOGI(TAG, "Sent registration request as '%s' (IP: %s)",
@@ -447,36 +672,169 @@ esp_err_t cluster_slave_register(const char *hostname)
 /**
  * @brief Handle registration acknowledgment from master
  */
-esp_err_t cluster_slave_handle_ack(uint8_t assigned_id, const char *hostname)
+esp_err_t cluster_slave_handle_ack(uint16_t assigned_id, const char *hostname)
 {
     if (!g_slave) {
         return ESP_ERR_INVALID_STATE;
     }
 
+#if CLUSTER_IS_RELAY
+    // Relays sit directly under the master
+    if (CLUSTER_NODE_IS_DOWNSTREAM(assigned_id)) {
+        ESP_LOGW(TAG, "Ignoring downstream address 0x%04X for relay", assigned_id);
+        return ESP_ERR_INVALID_ARG;
+    }
+#endif
+
+    // An ACK the master had to broadcast reaches every slave; it names the
+    // slave it was meant for
+    const char *my_hostname = cluster_get_hostname();
+    if (hostname && hostname[0] &&
+        strncmp(hostname, my_hostname ? my_hostname : "bitaxe", 31) != 0) {
+        ESP_LOGD(TAG, "Ignoring ACK for '%s'", hostname);
+        return ESP_OK;
+    }
+
     g_slave->my_id = assigned_id;
     g_slave->registered = true;
+    cluster_slave_on_uplink_rx();
+
+    // New uplink session: it holds none of our telemetry references or
+    // clock exchanges
+    xSemaphoreTake(g_tlm.mutex, portMAX_DELAY);
+    cluster_telemetry_tx_reset(&g_tlm.tx, CLUSTER_TELEMETRY_KEYFRAME);
+    g_tlm.last_ack = 0;
+    memset(&g_clock, 0, sizeof(g_clock));
+    xSemaphoreGive(g_tlm.mutex);
+
+    cluster_transport_on_registered();
 
     if (hostname) {
         strncpy(g_slave->master_hostname, hostname, 31);
         g_slave->master_hostname[31] = '\0';
     }
 
-    ESP_LOGI(TAG, "Registered with master, assigned ID: %d", assigned_id);
+    if (CLUSTER_NODE_IS_DOWNSTREAM(assigned_id)) {
+        ESP_LOGI(TAG, "Registered with relay, assigned node 0x%04X", assigned_id);
+    } else {
+        ESP_LOGI(TAG, "Registered with master, assigned ID: %d", assigned_id);
+    }
 
     return ESP_OK;
 }
 
 /**
- * @brief Send heartbeat to master with extended stats
+ * @brief Note that the uplink was just heard from
+ *
+ * Called for every message from the master/relay, so heartbeat replies
+ * and work broadcasts both keep the link alive.
  */
-static esp_err_t send_heartbeat(void)
+void cluster_slave_on_uplink_rx(void)
+{
+    if (g_slave) {
+        g_slave->last_uplink_rx = esp_timer_get_time() / 1000;
+    }
+}
+
+bool cluster_slave_uplink_alive(void)
 {
     if (!g_slave || !g_slave->registered) {
-        return ESP_ERR_INVALID_STATE;
+        return false;
     }
+    int64_t silent = (esp_timer_get_time() / 1000) - g_slave->last_uplink_rx;
+    return silent < CLUSTER_LINK_TIMEOUT_MS;
+}
+
+// ============================================================================
+// Telemetry
+// ============================================================================
+// Until the uplink acknowledges a $CLTLM frame the slave sends the text
+// heartbeat plus a telemetry keyframe each interval, so an older master
+// keeps working. Once acks arrive it streams only telemetry frames every
+// CLUSTER_TELEMETRY_MS; if they stop it falls back to text heartbeats.
+
+#define TELEMETRY_ACK_TIMEOUT_MS    (3 * CLUSTER_HEARTBEAT_MS)
+
+static bool telemetry_active(void)
+{
+    return g_tlm.last_ack != 0 &&
+           (esp_timer_get_time() / 1000) - g_tlm.last_ack < TELEMETRY_ACK_TIMEOUT_MS;
+}
+
+void cluster_slave_handle_telemetry_ack(uint8_t seq, bool ok)
+{
+    if (!g_slave || !g_tlm.mutex) {
+        return;
+    }
+
+    xSemaphoreTake(g_tlm.mutex, portMAX_DELAY);
+    cluster_telemetry_tx_on_ack(&g_tlm.tx, seq, ok);
+    g_tlm.last_ack = esp_timer_get_time() / 1000;
+    xSemaphoreGive(g_tlm.mutex);
+
+    if (!ok) {
+        ESP_LOGD(TAG, "Telemetry frame %u not decodable upstream, sending keyframe", seq);
+    }
+}
+
+void cluster_slave_handle_clock_reply(int64_t echo_t1)
+{
+    int64_t t4 = esp_timer_get_time();
+
+    if (!g_slave || !g_tlm.mutex || echo_t1 == 0) {
+        return;
+    }
+
+    // Only the reply to our latest stamp: the uplink pairs it with that frame
+    xSemaphoreTake(g_tlm.mutex, portMAX_DELAY);
+    if (echo_t1 == g_clock.sent_t1) {
+        g_clock.echo_t1 = echo_t1;
+        g_clock.echo_t4 = t4;
+    }
+    xSemaphoreGive(g_tlm.mutex);
+}
 
-    // Gather current stats from ESP-Miner modules
-    cluster_heartbeat_data_t hb_data = {
+/**
+ * @brief Stamp an uplink frame for the clock exchange (t1 = now)
+ *
+ * Also hands back t1/t4 of the last completed exchange so the uplink has
+ * all four stamps.
+ */
+static void clock_stamp(cluster_clock_stamp_t *stamp)
+{
+    xSemaphoreTake(g_tlm.mutex, portMAX_DELAY);
+    stamp->echo_t1 = g_clock.echo_t1;
+    stamp->echo_t4 = g_clock.echo_t4;
+    stamp->t1 = esp_timer_get_time();
+    g_clock.sent_t1 = stamp->t1;
+    xSemaphoreGive(g_tlm.mutex);
+}
+
+/**
+ * @brief Unicast to the uplink, falling back to broadcast
+ */
+static esp_err_t send_uplink(const char *payload, size_t len)
+{
+    uint8_t master_mac[6];
+    if (cluster_transport_get_uplink_mac(master_mac)) {
+        esp_err_t ret = cluster_transport_send_to_master(payload, len);
+        if (ret == ESP_OK) {
+            return ESP_OK;
+        }
+        ESP_LOGW(TAG, "Unicast to uplink failed: %s, falling back", esp_err_to_name(ret));
+    } else {
+        ESP_LOGW(TAG, "No master MAC - sending via broadcast");
+    }
+
+    return cluster_transport_broadcast(payload, len);
+}
+
+/**
+ * @brief Gather current stats from ESP-Miner modules
+ */
+static void gather_heartbeat(cluster_heartbeat_data_t *hb_data)
+{
+    *hb_data = (cluster_heartbeat_data_t){
         .slave_id = g_slave->my_id,
         .hashrate = cluster_get_asic_hashrate(),
         .temp = cluster_get_chip_temp(),
@@ -488,8 +846,65 @@ static esp_err_t send_heartbeat(void)
         .voltage_in = cluster_get_voltage_in()
     };
 
+#if CLUSTER_IS_RELAY
+    // Master sees the whole group as this slot
+    cluster_relay_aggregate_heartbeat(hb_data);
+#endif
+}
+
+/**
+ * @brief Send a telemetry frame (keyframe or delta) to the uplink
+ */
+static esp_err_t send_telemetry(const cluster_heartbeat_data_t *hb_data, bool force_key)
+{
+    cluster_board_telemetry_t board;
+    cluster_get_board_telemetry(&board);
+
+    cluster_telemetry_t sample;
+    cluster_telemetry_build(&sample, hb_data, &board,
+                            (uint8_t)(uxQueueMessagesWaiting(g_slave->share_queue) + g_replay.count));
+
+    uint8_t frame[CLUSTER_TLM_MAX_FRAME];
+    xSemaphoreTake(g_tlm.mutex, portMAX_DELAY);
+    int frame_len = cluster_telemetry_encode(&g_tlm.tx, &sample, force_key, frame, sizeof(frame));
+    xSemaphoreGive(g_tlm.mutex);
+
+    if (frame_len < 0) {
+        ESP_LOGE(TAG, "Failed to encode telemetry");
+        return ESP_FAIL;
+    }
+
+    char payload[192];
+    int len = cluster_protocol_encode_telemetry(hb_data->slave_id, frame, frame_len,
+                                                &hb_data->clock, payload, sizeof(payload));
+    if (len < 0) {
+        ESP_LOGE(TAG, "Failed to encode telemetry message");
+        return ESP_FAIL;
+    }
+
+    return send_uplink(payload, len);
+}
+
+/**
+ * @brief Send heartbeat to master with extended stats
+ */
+static esp_err_t send_heartbeat(void)
+{
+    if (!g_slave || !g_slave->registered) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    cluster_heartbeat_data_t hb_data;
+    gather_heartbeat(&hb_data);
+
+    if (telemetry_active()) {
+        clock_stamp(&hb_data.clock);
+        return send_telemetry(&hb_data, false);
+    }
+
     // Build heartbeat payload with extended data
-    char payload[128];
+    char payload[192];
+    clock_stamp(&hb_data.clock);
     int len = cluster_protocol_encode_heartbeat_ex(&hb_data, payload, sizeof(payload));
 
     if (len < 0) {
@@ -497,30 +912,54 @@ static esp_err_t send_heartbeat(void)
         return ESP_FAIL;
     }
 
-    // Try ESP-NOW first if we have master MAC
-#if defined(CONFIG_CLUSTER_TRANSPORT_ESPNOW) || defined(CONFIG_CLUSTER_TRANSPORT_BOTH)
-    extern bool cluster_espnow_get_master_mac(uint8_t *mac);
-    extern esp_err_t cluster_espnow_send(const uint8_t *dest_mac, const char *data, size_t len);
+    esp_err_t ret = send_uplink(payload, len);
 
-    uint8_t master_mac[6];
-    if (cluster_espnow_get_master_mac(master_mac)) {
-        ESP_LOGI(TAG, "Sending heartbeat via ESP-NOW to %02X:%02X:%02X:%02X:%02X:%02X",
-                 master_mac[0], master_mac[1], master_mac[2],
-                 master_mac[3], master_mac[4], master_mac[5]);
-        esp_err_t ret = cluster_espnow_send(master_mac, payload, len);
-        if (ret == ESP_OK) {
-            ESP_LOGI(TAG, "Heartbeat sent via ESP-NOW OK");
-            return ESP_OK;
+    // Offer telemetry; an ack switches us over. The heartbeat carried the
+    // clock stamp
+    memset(&hb_data.clock, 0, sizeof(hb_data.clock));
+    send_telemetry(&hb_data, true);
+
+    return ret;
+}
+
+/**
+ * @brief Upload trace records written since the last upload
+ *
+ * Up to CLUSTER_TRACE_UPLOAD_BURST sentences per call; the rest wait for
+ * the next heartbeat. Records the ring overwrote first are reported as
+ * lost.
+ */
+static void send_trace(void)
+{
+    for (int burst = 0; burst < CLUSTER_TRACE_UPLOAD_BURST; burst++) {
+        cluster_trace_record_t recs[CLUSTER_TRACE_UPLOAD_RECORDS];
+        uint32_t cursor = g_trace.cursor;
+        uint32_t lost = 0;
+        size_t count = cluster_trace_read(&cursor, recs, CLUSTER_TRACE_UPLOAD_RECORDS, &lost);
+
+        if (count == 0) {
+            g_trace.cursor = cursor;
+            g_trace.lost += lost;
+            return;
+        }
+
+        uint8_t packed[CLUSTER_TRACE_UPLOAD_RECORDS * CLUSTER_TRACE_WIRE_SIZE];
+        int packed_len = cluster_trace_pack(recs, count, packed, sizeof(packed));
+        char payload[250];
+        int len = cluster_protocol_encode_trace(g_slave->my_id, g_trace.lost + lost,
+                                                packed, packed_len, payload, sizeof(payload));
+        if (len < 0) {
+            ESP_LOGE(TAG, "Failed to encode trace records");
+            return;
         }
-        ESP_LOGW(TAG, "ESP-NOW heartbeat failed: %s, falling back", esp_err_to_name(ret));
-    } else {
-        ESP_LOGW(TAG, "No master MAC - heartbeat via broadcast");
-    }
-#endif
 
-    // Fallback to UART broadcast
-    extern esp_err_t BAP_uart_send_raw(const char *data, size_t len);
-    return BAP_uart_send_raw(payload, len);
+        // Unsent records stay in the ring for the next heartbeat
+        if (send_uplink(payload, len) != ESP_OK) {
+            return;
+        }
+        g_trace.cursor = cursor;
+        g_trace.lost = 0;
+    }
 }
 
 // ============================================================================
@@ -537,12 +976,21 @@ static void share_sender_task(void *pvParameters)
     ESP_LOGI(TAG, "Share sender task started");
 
     while (1) {
-        if (xQueueReceive(g_slave->share_queue, &share, portMAX_DELAY) == pdTRUE) {
+        // Poll while shares are held so they go out soon after the link returns
+        TickType_t wait = (g_replay.count > 0 || g_replay.dirty)
+                          ? pdMS_TO_TICKS(REPLAY_POLL_MS) : portMAX_DELAY;
+
+        if (xQueueReceive(g_slave->share_queue, &share, wait) == pdTRUE) {
             cluster_slave_submit_share(&share);
 
             // Small delay between share submissions
             vTaskDelay(pdMS_TO_TICKS(50));
+        } else if (uxQueueMessagesWaiting(g_slave->share_queue) == 0) {
+            // Fresh shares first; replay one held share per idle pass
+            replay_send_one();
         }
+
+        replay_save();
     }
 }
 
@@ -558,10 +1006,13 @@ static void heartbeat_task(void *pvParameters)
     cluster_slave_register(hostname);
 
     while (1) {
-        vTaskDelay(pdMS_TO_TICKS(CLUSTER_HEARTBEAT_MS));
+        vTaskDelay(pdMS_TO_TICKS(telemetry_active() ? CLUSTER_TELEMETRY_MS : CLUSTER_HEARTBEAT_MS));
 
         if (g_slave->registered) {
             send_heartbeat();
+            if (cluster_slave_uplink_alive()) {
+                send_trace();
+            }
         } else {
             // Retry registration
             ESP_LOGI(TAG, "Retrying registration...");
@@ -583,6 +1034,7 @@ static void worker_task(void *pvParameters)
     uint32_t last_job_id = 0;
     uint8_t last_extranonce2[8] = {0};
     uint8_t last_en2_len = 0;
+    uint32_t last_ntime = 0;
 
     while (1) {
         // Wait for notification of new work (or timeout for polling)
@@ -610,17 +1062,56 @@ static void worker_task(void *pvParameters)
             last_job_id = work.job_id;
             memcpy(last_extranonce2, work.extranonce2, work.extranonce2_len);
             last_en2_len = work.extranonce2_len;
+            last_ntime = work.ntime;
 
             // Store job_id -> extranonce2 mapping BEFORE submitting to ASIC
             // This ensures we use the correct extranonce2 when shares are found
             store_job_mapping(work.job_id, work.extranonce2, work.extranonce2_len);
 
             // Submit work to ASIC via integration layer
+            cluster_trace_record(CLUSTER_TRACE_ASIC, g_slave->my_id, work.job_id, 0);
             cluster_submit_work_to_asic(&work);
         }
 
+        int64_t now = esp_timer_get_time() / 1000;
+        int64_t age = now - g_slave->last_work_received;
+
+        // Uplink lost: keep the ASIC busy by rolling ntime on the last work.
+        // Whole group-span steps keep every node in a relay group on its own
+        // ntime slot, so no two nodes hash the same header.
+        if (g_slave->registered && !cluster_slave_uplink_alive()) {
+            if (!g_slave->autonomous) {
+                g_slave->autonomous = true;
+                g_slave->autonomous_since = now;
+                ESP_LOGW(TAG, "Uplink silent for %d ms - mining autonomously on job %lu",
+                         CLUSTER_LINK_TIMEOUT_MS, (unsigned long)work.job_id);
+            }
+
+            if (now - g_slave->autonomous_since <= CLUSTER_AUTONOMOUS_MAX_MS) {
+                cluster_work_t rolled = work;
+                rolled.ntime = cluster_topology_autonomous_ntime(work.ntime, age);
+                if (rolled.ntime != last_ntime) {
+                    ESP_LOGI(TAG, "Autonomous work: job %lu ntime +%lu s",
+                             (unsigned long)rolled.job_id,
+                             (unsigned long)(rolled.ntime - work.ntime));
+                    last_ntime = rolled.ntime;
+                    cluster_submit_work_to_asic(&rolled);
+#if CLUSTER_IS_RELAY
+                    cluster_relay_on_parent_work(&rolled);
+#endif
+                }
+            } else if (last_ntime != 0) {
+                ESP_LOGW(TAG, "Autonomous window (%d ms) over - holding last work",
+                         CLUSTER_AUTONOMOUS_MAX_MS);
+                last_ntime = 0;
+            }
+        } else if (g_slave->autonomous) {
+            g_slave->autonomous = false;
+            ESP_LOGI(TAG, "Uplink back after %lld ms autonomous, %d share(s) to replay",
+                     now - g_slave->autonomous_since, g_replay.count);
+        }
+
         // Check for stale work
-        int64_t age = (esp_timer_get_time() / 1000) - g_slave->last_work_received;
         if (age > 30000) {  // 30 seconds
             ESP_LOGW(TAG, "Work is stale (%lld ms old)", age);
         }
@@ -642,10 +1133,11 @@ esp_err_t cluster_slave_init(cluster_slave_state_t *state)
 
     // Initialize synchronization primitives
     g_slave->work_mutex = xSemaphoreCreateMutex();
+    g_tlm.mutex = xSemaphoreCreateMutex();
     g_slave->share_queue = xQueueCreate(CLUSTER_SHARE_QUEUE_SIZE,
                                          sizeof(cluster_share_t));
 
-    if (!g_slave->work_mutex || !g_slave->share_queue) {
+    if (!g_slave->work_mutex || !g_slave->share_queue || !g_tlm.mutex) {
         ESP_LOGE(TAG, "Failed to create synchronization primitives");
         return ESP_ERR_NO_MEM;
     }
@@ -653,9 +1145,21 @@ esp_err_t cluster_slave_init(cluster_slave_state_t *state)
     // Initialize state
     g_slave->registered = false;
     g_slave->work_valid = false;
-    g_slave->my_id = 0xFF;  // Invalid until assigned
+    g_slave->my_id = CLUSTER_NODE_ADDR_INVALID;  // Invalid until assigned
     g_slave->shares_found = 0;
     g_slave->shares_submitted = 0;
+    g_slave->shares_replayed = 0;
+    g_slave->shares_lost = 0;
+    g_slave->last_uplink_rx = 0;
+    g_slave->autonomous = false;
+    g_slave->autonomous_since = 0;
+
+    cluster_telemetry_tx_reset(&g_tlm.tx, CLUSTER_TELEMETRY_KEYFRAME);
+    g_tlm.last_ack = 0;
+
+    // Shares held through a reboot during an outage
+    memset(&g_replay, 0, sizeof(g_replay));
+    replay_load();
 
     // Create tasks with balanced stack sizes (avoid memory exhaustion)
     xTaskCreate(worker_task, "cluster_worker", 3072, NULL, 6,
@@ -667,6 +1171,19 @@ esp_err_t cluster_slave_init(cluster_slave_state_t *state)
     xTaskCreate(share_sender_task, "cluster_shares", 3072, NULL, 5,
                 &share_task);
 
+    // Settings requests from the master
+    esp_err_t ret = cluster_remote_config_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+#if CLUSTER_IS_RELAY
+    ret = cluster_relay_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+#endif
+
     g_slave->initialized = true;
 
     ESP_LOGI(TAG, "Cluster slave initialized");
@@ -678,6 +1195,11 @@ void cluster_slave_deinit(void)
 {
     if (!g_slave) return;
 
+#if CLUSTER_IS_RELAY
+    cluster_relay_deinit();
+#endif
+    cluster_remote_config_deinit();
+
     // Stop tasks
     if (g_slave->worker_task) {
         vTaskDelete(g_slave->worker_task);
@@ -693,6 +1215,10 @@ void cluster_slave_deinit(void)
     if (g_slave->share_queue) {
         vQueueDelete(g_slave->share_queue);
     }
+    if (g_tlm.mutex) {
+        vSemaphoreDelete(g_tlm.mutex);
+        g_tlm.mutex = NULL;
+    }
 
     g_slave->initialized = false;
     g_slave = NULL;
@@ -700,6 +1226,14 @@ void cluster_slave_deinit(void)
     ESP_LOGI(TAG, "Cluster slave deinitialized");
 }
 
+uint16_t cluster_slave_get_node_addr(void)
+{
+    if (!g_slave || !g_slave->registered) {
+        return CLUSTER_NODE_ADDR_INVALID;
+    }
+    return g_slave->my_id;
+}
+
 void cluster_slave_get_shares(uint32_t *shares_found, uint32_t *shares_submitted)
 {
     if (shares_found) {
@@ -0,0 +1,336 @@
+/**
+ * @file cluster_telemetry.c
+ * @brief Clusteraxe Binary Delta Telemetry
+ *
+ * Quantization and the keyframe/delta codec. See cluster_telemetry.h for
+ * the frame layout and acknowledgment rules.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include "cluster_telemetry.h"
+#include "string.h"
+#include <math.h>
+
+#if CLUSTER_ENABLED
+
+// ============================================================================
+// Quantization
+// ============================================================================
+
+static int32_t quantize(float value, float unit)
+{
+    if (!isfinite(value)) {
+        return 0;
+    }
+    return (int32_t)lroundf(value / unit);
+}
+
+void cluster_telemetry_build(cluster_telemetry_t *out,
+                             const cluster_heartbeat_data_t *hb,
+                             const cluster_board_telemetry_t *board,
+                             uint8_t share_queue)
+{
+    if (!out) {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+
+    if (hb) {
+        out->v[CLUSTER_TLM_HASHRATE]     = (int32_t)((hb->hashrate + 5) / 10);
+        out->v[CLUSTER_TLM_TEMP]         = quantize(hb->temp, 0.1f);
+        out->v[CLUSTER_TLM_POWER]        = quantize(hb->power, 0.1f);
+        out->v[CLUSTER_TLM_VIN]          = quantize(hb->voltage_in, 0.01f);
+        out->v[CLUSTER_TLM_FAN]          = (hb->fan_rpm + 5) / 10;
+        out->v[CLUSTER_TLM_FREQUENCY]    = hb->frequency;
+        out->v[CLUSTER_TLM_CORE_VOLTAGE] = hb->core_voltage;
+        out->v[CLUSTER_TLM_SHARES]       = (int32_t)hb->shares;
+        out->v[CLUSTER_TLM_NODES]        = hb->nodes;
+    }
+
+    out->v[CLUSTER_TLM_SHARE_QUEUE] = share_queue;
+
+    if (board) {
+        out->v[CLUSTER_TLM_TEMP2]      = quantize(board->chip_temp2, 0.1f);
+        out->v[CLUSTER_TLM_VR_TEMP]    = quantize(board->vr_temp, 0.1f);
+        out->v[CLUSTER_TLM_FAN2]       = (board->fan2_rpm + 5) / 10;
+        out->v[CLUSTER_TLM_ERROR]      = quantize(board->error_percent, 0.01f);
+        out->v[CLUSTER_TLM_ASIC_QUEUE] = board->asic_queue;
+
+        int count = board->asic_count;
+        if (count > CLUSTER_TELEMETRY_MAX_ASICS) {
+            count = CLUSTER_TELEMETRY_MAX_ASICS;
+        }
+        out->v[CLUSTER_TLM_ASIC_COUNT] = count;
+        for (int i = 0; i < count; i++) {
+            out->v[CLUSTER_TLM_ASIC_HASHRATE + i] = quantize(board->asic_hashrate[i], 1.0f);
+            out->v[CLUSTER_TLM_ASIC_ERROR + i]    = quantize(board->asic_error[i], 0.01f);
+        }
+    }
+}
+
+void cluster_telemetry_to_heartbeat(const cluster_telemetry_t *tlm, uint16_t node,
+                                    cluster_heartbeat_data_t *hb)
+{
+    if (!tlm || !hb) {
+        return;
+    }
+
+    memset(hb, 0, sizeof(*hb));
+    hb->slave_id     = node;
+    hb->hashrate     = (uint32_t)tlm->v[CLUSTER_TLM_HASHRATE] * 10;
+    hb->temp         = tlm->v[CLUSTER_TLM_TEMP] / 10.0f;
+    hb->fan_rpm      = (uint16_t)(tlm->v[CLUSTER_TLM_FAN] * 10);
+    hb->shares       = (uint32_t)tlm->v[CLUSTER_TLM_SHARES];
+    hb->frequency    = (uint16_t)tlm->v[CLUSTER_TLM_FREQUENCY];
+    hb->core_voltage = (uint16_t)tlm->v[CLUSTER_TLM_CORE_VOLTAGE];
+    hb->power        = tlm->v[CLUSTER_TLM_POWER] / 10.0f;
+    hb->voltage_in   = tlm->v[CLUSTER_TLM_VIN] / 100.0f;
+    hb->nodes        = (uint16_t)tlm->v[CLUSTER_TLM_NODES];
+}
+
+// ============================================================================
+// Varints
+// ============================================================================
+
+static int put_varint(uint8_t *buf, size_t len, size_t pos, uint32_t value)
+{
+    do {
+        if (pos >= len) {
+            return -1;
+        }
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        buf[pos++] = byte | (value ? 0x80 : 0);
+    } while (value);
+    return (int)pos;
+}
+
+static int get_varint(const uint8_t *buf, size_t len, size_t pos, uint32_t *value)
+{
+    uint32_t result = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos >= len) {
+            return -1;
+        }
+        uint8_t byte = buf[pos++];
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return (int)pos;
+        }
+    }
+    return -1;
+}
+
+static inline uint32_t zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t v)
+{
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+// ============================================================================
+// Encoder
+// ============================================================================
+
+void cluster_telemetry_tx_reset(cluster_telemetry_tx_t *tx, uint16_t keyframe_interval)
+{
+    if (!tx) {
+        return;
+    }
+    uint8_t seq = tx->next_seq;     // Keep counting so stale acks don't match
+    memset(tx, 0, sizeof(*tx));
+    tx->next_seq = seq;
+    tx->keyframe_interval = keyframe_interval;
+}
+
+int cluster_telemetry_encode(cluster_telemetry_tx_t *tx, const cluster_telemetry_t *sample,
+                             bool force_key, uint8_t *frame, size_t frame_len)
+{
+    if (!tx || !sample || !frame) {
+        return -1;
+    }
+
+    uint8_t seq = tx->next_seq;
+    bool key = force_key || !tx->has_ref ||
+               (tx->keyframe_interval && tx->since_key + 1 >= tx->keyframe_interval) ||
+               (uint8_t)(seq - tx->ref_seq) >= CLUSTER_TLM_TX_HISTORY;
+
+    uint32_t mask = 0;
+    for (int i = 0; i < CLUSTER_TLM_FIELD_COUNT; i++) {
+        int32_t base = key ? 0 : tx->ref.v[i];
+        if (sample->v[i] != base) {
+            mask |= 1u << i;
+        }
+    }
+
+    if (frame_len < 3) {
+        return -1;
+    }
+    size_t pos = 0;
+    frame[pos++] = (CLUSTER_TLM_VERSION << 4) | (key ? CLUSTER_TLM_FLAG_KEY : 0);
+    frame[pos++] = seq;
+    if (!key) {
+        frame[pos++] = tx->ref_seq;
+    }
+
+    int next = put_varint(frame, frame_len, pos, mask);
+    for (int i = 0; i < CLUSTER_TLM_FIELD_COUNT && next >= 0; i++) {
+        if (mask & (1u << i)) {
+            int32_t base = key ? 0 : tx->ref.v[i];
+            next = put_varint(frame, frame_len, (size_t)next,
+                              zigzag((int32_t)((uint32_t)sample->v[i] - (uint32_t)base)));
+        }
+    }
+    if (next < 0) {
+        return -1;
+    }
+
+    cluster_tlm_frame_t *sent = &tx->sent[seq % CLUSTER_TLM_TX_HISTORY];
+    sent->valid = true;
+    sent->seq = seq;
+    sent->sample = *sample;
+
+    tx->next_seq++;
+    tx->since_key = key ? 0 : tx->since_key + 1;
+
+    return next;
+}
+
+void cluster_telemetry_tx_on_ack(cluster_telemetry_tx_t *tx, uint8_t seq, bool ok)
+{
+    if (!tx) {
+        return;
+    }
+
+    if (!ok) {
+        tx->has_ref = false;
+        return;
+    }
+
+    // Only move forward; an old ack arriving late must not replace a newer reference
+    if (tx->has_ref && (int8_t)(seq - tx->ref_seq) <= 0) {
+        return;
+    }
+
+    const cluster_tlm_frame_t *sent = &tx->sent[seq % CLUSTER_TLM_TX_HISTORY];
+    if (!sent->valid || sent->seq != seq) {
+        return;
+    }
+
+    tx->ref = sent->sample;
+    tx->ref_seq = seq;
+    tx->has_ref = true;
+}
+
+// ============================================================================
+// Decoder
+// ============================================================================
+
+void cluster_telemetry_rx_reset(cluster_telemetry_rx_t *rx)
+{
+    if (rx) {
+        memset(rx, 0, sizeof(*rx));
+    }
+}
+
+esp_err_t cluster_telemetry_decode(cluster_telemetry_rx_t *rx, const uint8_t *frame,
+                                   size_t frame_len, uint8_t *seq, bool *keyframe)
+{
+    if (!rx || !frame) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (frame_len < 3) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if ((frame[0] >> 4) != CLUSTER_TLM_VERSION) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    bool key = (frame[0] & CLUSTER_TLM_FLAG_KEY) != 0;
+    uint8_t frame_seq = frame[1];
+    size_t pos = 2;
+
+    const cluster_telemetry_t *ref = NULL;
+    if (!key) {
+        uint8_t ref_seq = frame[pos++];
+        for (int i = 0; i < CLUSTER_TLM_RX_REFS; i++) {
+            if (rx->refs[i].valid && rx->refs[i].seq == ref_seq) {
+                ref = &rx->refs[i].sample;
+                break;
+            }
+        }
+        if (!ref) {
+            if (seq) *seq = frame_seq;
+            if (keyframe) *keyframe = false;
+            return ESP_ERR_NOT_FOUND;
+        }
+    }
+
+    uint32_t mask = 0;
+    int next = get_varint(frame, frame_len, pos, &mask);
+    if (next < 0 || (mask >> CLUSTER_TLM_FIELD_COUNT) != 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    cluster_telemetry_t sample;
+    for (int i = 0; i < CLUSTER_TLM_FIELD_COUNT; i++) {
+        int32_t base = ref ? ref->v[i] : 0;
+        if (mask & (1u << i)) {
+            uint32_t raw = 0;
+            next = get_varint(frame, frame_len, (size_t)next, &raw);
+            if (next < 0) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            sample.v[i] = (int32_t)((uint32_t)base + (uint32_t)unzigzag(raw));
+        } else {
+            sample.v[i] = base;
+        }
+    }
+    if ((size_t)next != frame_len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    rx->current = sample;
+    rx->current_seq = frame_seq;
+    rx->valid = true;
+
+    if (seq) *seq = frame_seq;
+    if (keyframe) *keyframe = key;
+    return ESP_OK;
+}
+
+void cluster_telemetry_rx_acked(cluster_telemetry_rx_t *rx)
+{
+    if (!rx || !rx->valid) {
+        return;
+    }
+
+    cluster_tlm_frame_t *ref = &rx->refs[rx->next_ref];
+    ref->valid = true;
+    ref->seq = rx->current_seq;
+    ref->sample = rx->current;
+    rx->next_ref = (rx->next_ref + 1) % CLUSTER_TLM_RX_REFS;
+}
+
+bool cluster_telemetry_rx_ack_due(cluster_telemetry_rx_t *rx, bool keyframe,
+                                  int64_t now_ms, uint32_t interval_ms)
+{
+    if (!rx || !rx->valid) {
+        return false;
+    }
+    if (!keyframe && now_ms - rx->last_ack_ms < (int64_t)interval_ms) {
+        return false;
+    }
+
+    cluster_telemetry_rx_acked(rx);
+    rx->last_ack_ms = now_ms;
+    return true;
+}
+
+#endif // CLUSTER_ENABLED
@@ -0,0 +1,206 @@
+/**
+ * @file cluster_telemetry.h
+ * @brief Clusteraxe Binary Delta Telemetry
+ *
+ * Slaves report their stats as a compact binary frame instead of the text
+ * heartbeat. Every value is quantized to a fixed-point integer field; a
+ * frame carries only the fields that differ from a reference frame the
+ * receiver has acknowledged, as zigzag varints. A full keyframe (all
+ * non-zero fields) is sent periodically, when there is no usable
+ * reference, or when the receiver asks for one.
+ *
+ * Frame layout (before base64 in a $CLTLM sentence):
+ *
+ *   header   (version << 4) | flags        flags: 0x01 keyframe
+ *   seq      frame sequence number (wraps)
+ *   ref_seq  reference frame (delta frames only)
+ *   mask     varint, bit i = field i present
+ *   values   zigzag varint per present field, in field order
+ *            (keyframe: the value; delta: value - reference value)
+ *
+ * The receiver acknowledges a frame with $CLTAK,node,seq,1 - at most once
+ * per heartbeat interval, and always for keyframes - and keeps the last
+ * few acknowledged frames as references. A delta against a reference it
+ * does not have is answered with $CLTAK,node,seq,0, which makes the sender
+ * send a keyframe next.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#ifndef CLUSTER_TELEMETRY_H
+#define CLUSTER_TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "cluster.h"
+#include "cluster_protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Fields
+// ============================================================================
+
+#define CLUSTER_TLM_VERSION         1
+#define CLUSTER_TLM_FLAG_KEY        0x01
+
+#define CLUSTER_TLM_TX_HISTORY      8       // Sent frames the encoder remembers
+#define CLUSTER_TLM_RX_REFS         3       // Acknowledged frames the decoder keeps
+#define CLUSTER_TLM_MAX_FRAME       (3 + 5 + CLUSTER_TLM_FIELD_COUNT * 5)
+
+/**
+ * @brief Telemetry fields and their fixed-point units
+ */
+typedef enum {
+    CLUSTER_TLM_HASHRATE = 0,       // 0.1 GH/s (whole node, relay group included)
+    CLUSTER_TLM_TEMP,               // 0.1 C, hottest chip
+    CLUSTER_TLM_TEMP2,              // 0.1 C, second sensor
+    CLUSTER_TLM_VR_TEMP,            // 0.1 C, voltage regulator
+    CLUSTER_TLM_POWER,              // 0.1 W
+    CLUSTER_TLM_VIN,                // 10 mV
+    CLUSTER_TLM_FAN,                // 10 RPM
+    CLUSTER_TLM_FAN2,               // 10 RPM
+    CLUSTER_TLM_FREQUENCY,          // MHz
+    CLUSTER_TLM_CORE_VOLTAGE,       // mV
+    CLUSTER_TLM_SHARES,             // Shares found
+    CLUSTER_TLM_ERROR,              // 0.01 %, whole board
+    CLUSTER_TLM_ASIC_QUEUE,         // Jobs queued for the ASIC
+    CLUSTER_TLM_SHARE_QUEUE,        // Shares waiting to go upstream
+    CLUSTER_TLM_NODES,              // Downstream nodes (relays)
+    CLUSTER_TLM_ASIC_COUNT,         // Chips reported below
+    CLUSTER_TLM_ASIC_HASHRATE,      // GH/s, one field per chip
+    CLUSTER_TLM_ASIC_ERROR = CLUSTER_TLM_ASIC_HASHRATE + CLUSTER_TELEMETRY_MAX_ASICS, // 0.01 %, per chip
+    CLUSTER_TLM_FIELD_COUNT = CLUSTER_TLM_ASIC_ERROR + CLUSTER_TELEMETRY_MAX_ASICS
+} cluster_tlm_field_t;
+
+_Static_assert(CLUSTER_TLM_FIELD_COUNT <= 32, "telemetry field mask is 32 bits");
+
+/**
+ * @brief One quantized telemetry sample
+ */
+typedef struct {
+    int32_t v[CLUSTER_TLM_FIELD_COUNT];
+} cluster_telemetry_t;
+
+/**
+ * @brief Board stats beyond the heartbeat (see cluster_get_board_telemetry())
+ */
+typedef struct {
+    float       chip_temp2;                                 // C
+    float       vr_temp;                                    // C
+    uint16_t    fan2_rpm;
+    float       error_percent;                              // Whole board
+    uint8_t     asic_count;
+    float       asic_hashrate[CLUSTER_TELEMETRY_MAX_ASICS]; // GH/s
+    float       asic_error[CLUSTER_TELEMETRY_MAX_ASICS];    // %
+    uint8_t     asic_queue;                                 // Jobs queued for the ASIC
+} cluster_board_telemetry_t;
+
+/**
+ * @brief Quantize a heartbeat and board stats into a sample
+ *
+ * @param board May be NULL (fields left zero)
+ */
+void cluster_telemetry_build(cluster_telemetry_t *out,
+                             const cluster_heartbeat_data_t *hb,
+                             const cluster_board_telemetry_t *board,
+                             uint8_t share_queue);
+
+/**
+ * @brief Heartbeat view of a sample, for code that consumes heartbeats
+ */
+void cluster_telemetry_to_heartbeat(const cluster_telemetry_t *tlm, uint16_t node,
+                                    cluster_heartbeat_data_t *hb);
+
+// ============================================================================
+// Encoder (sender side)
+// ============================================================================
+
+typedef struct {
+    bool                valid;
+    uint8_t             seq;
+    cluster_telemetry_t sample;
+} cluster_tlm_frame_t;
+
+typedef struct {
+    uint8_t             next_seq;
+    uint16_t            since_key;          // Frames since the last keyframe
+    uint16_t            keyframe_interval;  // Force a keyframe every N frames
+    bool                has_ref;
+    uint8_t             ref_seq;
+    cluster_telemetry_t ref;
+    cluster_tlm_frame_t sent[CLUSTER_TLM_TX_HISTORY];
+} cluster_telemetry_tx_t;
+
+/**
+ * @brief Start over: the next frame is a keyframe
+ */
+void cluster_telemetry_tx_reset(cluster_telemetry_tx_t *tx, uint16_t keyframe_interval);
+
+/**
+ * @brief Encode a sample as a keyframe or a delta against the acked reference
+ *
+ * @param force_key Send a keyframe regardless of the reference
+ * @return Frame length, or -1 if the buffer is too small
+ */
+int cluster_telemetry_encode(cluster_telemetry_tx_t *tx, const cluster_telemetry_t *sample,
+                             bool force_key, uint8_t *frame, size_t frame_len);
+
+/**
+ * @brief Handle $CLTAK from the receiver
+ *
+ * @param ok false if the receiver could not decode a delta (next frame is a keyframe)
+ */
+void cluster_telemetry_tx_on_ack(cluster_telemetry_tx_t *tx, uint8_t seq, bool ok);
+
+// ============================================================================
+// Decoder (receiver side)
+// ============================================================================
+
+typedef struct {
+    bool                valid;              // `current` holds a decoded sample
+    cluster_telemetry_t current;
+    uint8_t             current_seq;
+    cluster_tlm_frame_t refs[CLUSTER_TLM_RX_REFS];
+    uint8_t             next_ref;
+    int64_t             last_ack_ms;        // When the last positive ack was due
+} cluster_telemetry_rx_t;
+
+void cluster_telemetry_rx_reset(cluster_telemetry_rx_t *rx);
+
+/**
+ * @brief Decode a frame into rx->current
+ *
+ * @param seq Output: frame sequence number
+ * @param keyframe Output: frame was a keyframe
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if the delta's reference is not held
+ *         (answer with a NAK), ESP_ERR_INVALID_SIZE / ESP_ERR_INVALID_VERSION
+ *         for a malformed frame
+ */
+esp_err_t cluster_telemetry_decode(cluster_telemetry_rx_t *rx, const uint8_t *frame,
+                                   size_t frame_len, uint8_t *seq, bool *keyframe);
+
+/**
+ * @brief Keep rx->current as a reference; call when acknowledging it
+ */
+void cluster_telemetry_rx_acked(cluster_telemetry_rx_t *rx);
+
+/**
+ * @brief Decide whether the frame just decoded gets a positive ack
+ *
+ * Keyframes always do; deltas at most once per interval_ms. When it
+ * returns true the frame has been kept as a reference (rx_acked()).
+ */
+bool cluster_telemetry_rx_ack_due(cluster_telemetry_rx_t *rx, bool keyframe,
+                                  int64_t now_ms, uint32_t interval_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLUSTER_TELEMETRY_H
@@ -0,0 +1,181 @@
+/**
+ * @file cluster_topology.c
+ * @brief Clusteraxe Hierarchical Topology (relay / sub-master)
+ *
+ * Beacon format, uplink selection policy, work subdivision and heartbeat
+ * aggregation for relay nodes. See cluster_topology.h for the addressing
+ * scheme.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include "cluster_topology.h"
+#include "string.h"
+#include "stdio.h"
+#include "stdlib.h"
+
+#if CLUSTER_ENABLED
+
+_Static_assert(CONFIG_CLUSTER_RELAY_MAX_CHILDREN < CLUSTER_GROUP_NTIME_SPAN,
+               "relay group must fit in one autonomous ntime step");
+
+// ============================================================================
+// Discovery Beacons
+// ============================================================================
+
+int cluster_topology_encode_beacon(bool is_relay, uint8_t free_slots,
+                                   char *buffer, size_t buffer_len)
+{
+    if (!buffer) {
+        return -1;
+    }
+
+    int len = snprintf(buffer, buffer_len, "%s,%s,%u",
+                       CLUSTER_BEACON_MAGIC,
+                       is_relay ? "RELAY" : "MASTER",
+                       free_slots);
+
+    if (len < 0 || (size_t)len >= buffer_len) {
+        return -1;
+    }
+    return len;
+}
+
+bool cluster_topology_parse_beacon(const uint8_t *data, size_t len,
+                                   cluster_beacon_t *beacon)
+{
+    const size_t magic_len = sizeof(CLUSTER_BEACON_MAGIC) - 1;
+
+    if (!data || !beacon || len < magic_len ||
+        memcmp(data, CLUSTER_BEACON_MAGIC, magic_len) != 0) {
+        return false;
+    }
+
+    // Work on a terminated copy - radio payloads are not null-terminated
+    char buf[32];
+    size_t n = len < sizeof(buf) - 1 ? len : sizeof(buf) - 1;
+    memcpy(buf, data, n);
+    buf[n] = '\0';
+
+    beacon->is_relay = false;
+    beacon->free_slots = CLUSTER_BEACON_FREE_UNKNOWN;
+
+    char *role = strchr(buf, ',');
+    if (!role) {
+        return true;
+    }
+    role++;
+    beacon->is_relay = (strncmp(role, "RELAY", 5) == 0);
+
+    char *free_field = strchr(role, ',');
+    if (free_field) {
+        beacon->free_slots = (uint8_t)strtoul(free_field + 1, NULL, 10);
+    }
+
+    return true;
+}
+
+// ============================================================================
+// Uplink Selection
+// ============================================================================
+
+bool cluster_topology_should_join(cluster_uplink_t *uplink,
+                                  const cluster_beacon_t *beacon,
+                                  bool from_uplink, bool self_is_relay,
+                                  int64_t now_ms)
+{
+    if (!uplink || !beacon) {
+        return false;
+    }
+
+    // Single relay tier: relays hang directly off the master
+    if (self_is_relay && beacon->is_relay) {
+        return false;
+    }
+
+    if (from_uplink) {
+        uplink->last_uplink_beacon_ms = now_ms;
+
+        // Registration may have been lost - retry if still unanswered
+        return uplink->joined && !uplink->acked &&
+               beacon->free_slots > 0 &&
+               (now_ms - uplink->join_time_ms) > CLUSTER_JOIN_TIMEOUT_MS;
+    }
+
+    if (beacon->free_slots == 0) {
+        return false;
+    }
+
+    if (!uplink->joined) {
+        return true;
+    }
+
+    // Current uplink never answered (full, or out of range for our TX)
+    if (!uplink->acked) {
+        return (now_ms - uplink->join_time_ms) > CLUSTER_JOIN_TIMEOUT_MS;
+    }
+
+    // Stay with an acknowledged uplink until it goes silent
+    return (now_ms - uplink->last_uplink_beacon_ms) > CLUSTER_TIMEOUT_MS;
+}
+
+void cluster_topology_on_join(cluster_uplink_t *uplink, bool is_relay, int64_t now_ms)
+{
+    if (!uplink) {
+        return;
+    }
+
+    uplink->joined = true;
+    uplink->acked = false;
+    uplink->uplink_is_relay = is_relay;
+    uplink->join_time_ms = now_ms;
+    uplink->last_uplink_beacon_ms = now_ms;
+}
+
+// ============================================================================
+// Work Subdivision & Aggregation
+// ============================================================================
+
+void cluster_topology_derive_child_work(const cluster_work_t *parent,
+                                        cluster_node_addr_t child,
+                                        cluster_work_t *out)
+{
+    if (!parent || !out) {
+        return;
+    }
+
+    *out = *parent;
+    out->target_slave_id = child;
+
+    // Same extranonce2/merkle root as the relay; distinct ntime per node
+    out->ntime = parent->ntime + CLUSTER_NODE_LOCAL(child) + 1;
+}
+
+uint32_t cluster_topology_autonomous_ntime(uint32_t work_ntime, int64_t work_age_ms)
+{
+    if (work_age_ms <= 0) {
+        return work_ntime;
+    }
+
+    uint32_t steps = (uint32_t)(work_age_ms / 1000 / CLUSTER_GROUP_NTIME_SPAN);
+    return work_ntime + steps * CLUSTER_GROUP_NTIME_SPAN;
+}
+
+void cluster_topology_aggregate_heartbeat(cluster_heartbeat_data_t *agg,
+                                          const cluster_heartbeat_data_t *child)
+{
+    if (!agg || !child) {
+        return;
+    }
+
+    agg->hashrate += child->hashrate;
+    agg->shares += child->shares;
+    agg->power += child->power;
+    if (child->temp > agg->temp) {
+        agg->temp = child->temp;
+    }
+    agg->nodes += 1 + child->nodes;
+}
+
+#endif // CLUSTER_ENABLED
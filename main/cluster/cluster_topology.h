@@ -0,0 +1,175 @@
+/**
+ * @file cluster_topology.h
+ * @brief Clusteraxe Hierarchical Topology (relay / sub-master)
+ *
+ * A relay is a slave that also acts as a sub-master for a group of
+ * downstream slaves. The master sees the relay as a single slot; the relay
+ * subdivides the work it receives and aggregates shares and heartbeats
+ * from its group upstream. Only one relay tier is supported.
+ *
+ * Node addressing (16 bits):
+ *   0x00SS   Direct slave in master slot SS
+ *   0xRRLL   Downstream slave LL of the relay in master slot RR-1
+ *
+ * Work subdivision: every node under a relay shares the relay's
+ * extranonce2 and merkle root, and child LL mines at ntime + LL + 1 (the
+ * relay itself mines at ntime + 0), so headers never overlap. A node that
+ * loses its uplink rolls ntime in whole group spans (see
+ * cluster_topology_autonomous_ntime()) and keeps that separation.
+ *
+ * Everything in this header is pure logic with no RTOS or radio
+ * dependencies so it can be exercised by the host-side simulator.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#ifndef CLUSTER_TOPOLOGY_H
+#define CLUSTER_TOPOLOGY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cluster.h"
+#include "cluster_protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Node Addressing
+// ============================================================================
+
+typedef uint16_t cluster_node_addr_t;
+
+#define CLUSTER_NODE_ADDR_INVALID       0xFFFF
+
+// Address of downstream node `local` under the relay in master slot `slot`
+#define CLUSTER_NODE_ADDR(slot, local)  ((cluster_node_addr_t)((((slot) + 1) << 8) | ((local) & 0xFF)))
+
+// True if the address belongs to a node behind a relay
+#define CLUSTER_NODE_IS_DOWNSTREAM(a)   (((a) >> 8) != 0 && (a) != CLUSTER_NODE_ADDR_INVALID)
+
+// Master slot accountable for an address (the relay's slot for downstream nodes)
+#define CLUSTER_NODE_SLOT(a)            (CLUSTER_NODE_IS_DOWNSTREAM(a) ? (((a) >> 8) - 1) : (a))
+
+// Index of a downstream node within its relay group
+#define CLUSTER_NODE_LOCAL(a)           ((a) & 0xFF)
+
+// ============================================================================
+// Discovery Beacons
+// ============================================================================
+
+#define CLUSTER_BEACON_MAGIC            "CLAXE"
+
+// Free slot count when an older master omits it from its beacon
+#define CLUSTER_BEACON_FREE_UNKNOWN     0xFF
+
+// Time without an ACK before a joining node may try another uplink (ms)
+#ifndef CLUSTER_JOIN_TIMEOUT_MS
+    #define CLUSTER_JOIN_TIMEOUT_MS     5000
+#endif
+
+typedef struct {
+    bool    is_relay;           // Beacon came from a relay, not the master
+    uint8_t free_slots;         // Slots the sender can still accept
+} cluster_beacon_t;
+
+/**
+ * @brief Uplink selection state kept by each slave
+ */
+typedef struct {
+    bool    joined;             // Registration sent to current uplink
+    bool    acked;              // Current uplink acknowledged registration
+    bool    uplink_is_relay;
+    int64_t join_time_ms;
+    int64_t last_uplink_beacon_ms;
+} cluster_uplink_t;
+
+/**
+ * @brief Build a discovery beacon payload
+ * Format: CLAXE,MASTER,free  or  CLAXE,RELAY,free
+ * @return Length written, or -1 if the buffer is too small
+ */
+int cluster_topology_encode_beacon(bool is_relay, uint8_t free_slots,
+                                   char *buffer, size_t buffer_len);
+
+/**
+ * @brief Parse a discovery beacon payload (accepts the legacy "CLAXE,MASTER")
+ * @return true if data is a Clusteraxe beacon
+ */
+bool cluster_topology_parse_beacon(const uint8_t *data, size_t len,
+                                   cluster_beacon_t *beacon);
+
+/**
+ * @brief Decide whether to (re)register with the sender of a beacon
+ *
+ * A node keeps its uplink while it is acknowledged and still beaconing.
+ * It moves on if the uplink never ACKed within CLUSTER_JOIN_TIMEOUT_MS or
+ * went silent for CLUSTER_TIMEOUT_MS. Relays only join the master, and
+ * senders with no free slots are skipped.
+ *
+ * @param uplink Current uplink state (last beacon time updated in place)
+ * @param beacon Parsed beacon
+ * @param from_uplink Beacon came from the current uplink
+ * @param self_is_relay This node is a relay
+ * @param now_ms Current time (ms)
+ * @return true to register with the beacon sender
+ */
+bool cluster_topology_should_join(cluster_uplink_t *uplink,
+                                  const cluster_beacon_t *beacon,
+                                  bool from_uplink, bool self_is_relay,
+                                  int64_t now_ms);
+
+/**
+ * @brief Record that registration was sent to a new uplink
+ */
+void cluster_topology_on_join(cluster_uplink_t *uplink, bool is_relay, int64_t now_ms);
+
+// ============================================================================
+// Work Subdivision & Aggregation
+// ============================================================================
+
+/**
+ * @brief Derive a downstream node's work from the relay's work
+ * @param parent Work the relay received from the master
+ * @param child Downstream node address
+ * @param out Output: work for the child
+ */
+void cluster_topology_derive_child_work(const cluster_work_t *parent,
+                                        cluster_node_addr_t child,
+                                        cluster_work_t *out);
+
+// ntime values one relay group occupies: the relay (+0) and up to 8 children
+#define CLUSTER_GROUP_NTIME_SPAN        9
+
+/**
+ * @brief ntime to mine at while the uplink is down
+ *
+ * Advances the work's ntime by the time since it was received, rounded
+ * down to whole CLUSTER_GROUP_NTIME_SPAN steps, so each node in a relay
+ * group stays on its own ntime residue and never reaches a sibling's
+ * headers. Direct slaves have their own extranonce2 and could roll by
+ * one, but use the same steps so a relay and its children agree.
+ *
+ * @param work_ntime ntime of the last work received
+ * @param work_age_ms Time since that work was received (ms)
+ * @return Rolled ntime (work_ntime until a full span has passed)
+ */
+uint32_t cluster_topology_autonomous_ntime(uint32_t work_ntime, int64_t work_age_ms);
+
+/**
+ * @brief Fold a downstream node's heartbeat into the relay's heartbeat
+ *
+ * Hashrate, shares and power are summed, temperature is the maximum,
+ * and the node count is incremented.
+ */
+void cluster_topology_aggregate_heartbeat(cluster_heartbeat_data_t *agg,
+                                          const cluster_heartbeat_data_t *child);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLUSTER_TOPOLOGY_H
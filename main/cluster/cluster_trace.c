@@ -0,0 +1,443 @@
+/**
+ * @file cluster_trace.c
+ * @brief Clusteraxe job and share tracing
+ *
+ * The record ring, the $CLTRC packing and the latency summary. See
+ * cluster_trace.h for the stages and how records reach the master.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include "cluster_trace.h"
+#include "cluster.h"
+#include "esp_timer.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if CLUSTER_ENABLED
+
+// A slave's record may land up to this far before the master's record it
+// follows: the clock estimate is good to a fraction of the link delay
+#define TRACE_SKEW_US       5000
+
+static const char *s_stage_names[CLUSTER_TRACE_STAGE_COUNT] = {
+    [CLUSTER_TRACE_NONE]            = "none",
+    [CLUSTER_TRACE_NOTIFY]          = "notify",
+    [CLUSTER_TRACE_DISTRIBUTE]      = "distribute",
+    [CLUSTER_TRACE_WORK_RX]         = "work_rx",
+    [CLUSTER_TRACE_ASIC]            = "asic",
+    [CLUSTER_TRACE_SHARE_FOUND]     = "share_found",
+    [CLUSTER_TRACE_SHARE_TX]        = "share_tx",
+    [CLUSTER_TRACE_SHARE_RX]        = "share_rx",
+    [CLUSTER_TRACE_SUBMIT]          = "submit",
+    [CLUSTER_TRACE_ACCEPTED]        = "accepted",
+    [CLUSTER_TRACE_REJECTED]        = "rejected",
+    [CLUSTER_TRACE_DROP_DUPLICATE]  = "drop_duplicate",
+    [CLUSTER_TRACE_DROP_STALE]      = "drop_stale",
+    [CLUSTER_TRACE_DROP_INVALID]    = "drop_invalid",
+};
+
+const char *cluster_trace_stage_name(uint8_t stage)
+{
+    return stage < CLUSTER_TRACE_STAGE_COUNT ? s_stage_names[stage] : "unknown";
+}
+
+bool cluster_trace_is_share_stage(uint8_t stage)
+{
+    return stage >= CLUSTER_TRACE_SHARE_FOUND && stage < CLUSTER_TRACE_STAGE_COUNT;
+}
+
+// ============================================================================
+// Ring
+// ============================================================================
+
+#if CLUSTER_TRACE_SIZE > 0
+
+// seq is 2 * index + 1 while a writer fills the slot, 2 * index + 2 once
+// the record for that index is complete
+typedef struct {
+    _Atomic uint32_t        seq;
+    cluster_trace_record_t  rec;
+} trace_slot_t;
+
+static trace_slot_t g_ring[CLUSTER_TRACE_SIZE];
+static _Atomic uint32_t g_head;
+static _Atomic uint32_t g_lost;
+
+void cluster_trace_put(const cluster_trace_record_t *rec)
+{
+    if (!rec) {
+        return;
+    }
+
+    uint32_t index = atomic_fetch_add_explicit(&g_head, 1, memory_order_relaxed);
+    trace_slot_t *slot = &g_ring[index % CLUSTER_TRACE_SIZE];
+
+    atomic_store_explicit(&slot->seq, 2 * index + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->rec = *rec;
+    atomic_store_explicit(&slot->seq, 2 * index + 2, memory_order_release);
+}
+
+size_t cluster_trace_read(uint32_t *cursor, cluster_trace_record_t *out, size_t max,
+                          uint32_t *lost)
+{
+    if (lost) {
+        *lost = 0;
+    }
+    if (!cursor || !out) {
+        return 0;
+    }
+
+    uint32_t head = atomic_load_explicit(&g_head, memory_order_acquire);
+    uint32_t index = *cursor;
+    uint32_t skipped = 0;
+
+    if (index > head) {
+        index = 0;      // Ring was reset
+    }
+    if (head - index > CLUSTER_TRACE_SIZE) {
+        skipped += head - CLUSTER_TRACE_SIZE - index;
+        index = head - CLUSTER_TRACE_SIZE;
+    }
+
+    size_t n = 0;
+    for (; index != head && n < max; index++) {
+        trace_slot_t *slot = &g_ring[index % CLUSTER_TRACE_SIZE];
+        uint32_t want = 2 * index + 2;
+
+        uint32_t before = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if ((int32_t)(before - want) < 0) {
+            break;      // Claimed but not written yet; pick it up next time
+        }
+        if (before != want) {
+            skipped++;  // Overwritten
+            continue;
+        }
+
+        cluster_trace_record_t rec = slot->rec;
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->seq, memory_order_relaxed) != before) {
+            skipped++;  // Overwritten while we copied
+            continue;
+        }
+        out[n++] = rec;
+    }
+
+    *cursor = index;
+    if (lost) {
+        *lost = skipped;
+    }
+    return n;
+}
+
+uint32_t cluster_trace_count(void)
+{
+    return atomic_load_explicit(&g_head, memory_order_relaxed);
+}
+
+void cluster_trace_add_lost(uint32_t count)
+{
+    atomic_fetch_add_explicit(&g_lost, count, memory_order_relaxed);
+}
+
+uint32_t cluster_trace_lost(void)
+{
+    return atomic_load_explicit(&g_lost, memory_order_relaxed);
+}
+
+void cluster_trace_reset(void)
+{
+    for (int i = 0; i < CLUSTER_TRACE_SIZE; i++) {
+        atomic_store_explicit(&g_ring[i].seq, 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&g_lost, 0, memory_order_relaxed);
+    atomic_store_explicit(&g_head, 0, memory_order_release);
+}
+
+#else // CLUSTER_TRACE_SIZE == 0
+
+void cluster_trace_put(const cluster_trace_record_t *rec)
+{
+    (void)rec;
+}
+
+size_t cluster_trace_read(uint32_t *cursor, cluster_trace_record_t *out, size_t max,
+                          uint32_t *lost)
+{
+    if (lost) {
+        *lost = 0;
+    }
+    return 0;
+}
+
+uint32_t cluster_trace_count(void)
+{
+    return 0;
+}
+
+void cluster_trace_add_lost(uint32_t count)
+{
+    (void)count;
+}
+
+uint32_t cluster_trace_lost(void)
+{
+    return 0;
+}
+
+void cluster_trace_reset(void)
+{
+}
+
+#endif // CLUSTER_TRACE_SIZE
+
+void cluster_trace_record(cluster_trace_stage_t stage, uint16_t node,
+                          uint32_t job_id, uint32_t aux)
+{
+#if CLUSTER_TRACE_SIZE > 0
+    cluster_trace_record_t rec = {
+        .ts_us = esp_timer_get_time(),
+        .job_id = job_id,
+        .aux = aux,
+        .node = node,
+        .stage = (uint8_t)stage,
+    };
+    cluster_trace_put(&rec);
+#endif
+}
+
+// ============================================================================
+// Wire Format
+// ============================================================================
+
+// Little-endian: ts_us(8) job_id(4) aux(4) node(2) stage(1); flags stay
+// on the master
+
+static void put_le(uint8_t *p, uint64_t v, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static uint64_t get_le(const uint8_t *p, int bytes)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; i++) {
+        v |= (uint64_t)p[i] << (8 * i);
+    }
+    return v;
+}
+
+int cluster_trace_pack(const cluster_trace_record_t *recs, size_t count,
+                       uint8_t *buf, size_t buf_len)
+{
+    if (!recs || !buf || count * CLUSTER_TRACE_WIRE_SIZE > buf_len) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        uint8_t *p = buf + i * CLUSTER_TRACE_WIRE_SIZE;
+        put_le(p, (uint64_t)recs[i].ts_us, 8);
+        put_le(p + 8, recs[i].job_id, 4);
+        put_le(p + 12, recs[i].aux, 4);
+        put_le(p + 16, recs[i].node, 2);
+        p[18] = recs[i].stage;
+    }
+    return (int)(count * CLUSTER_TRACE_WIRE_SIZE);
+}
+
+int cluster_trace_unpack(const uint8_t *buf, size_t len,
+                         cluster_trace_record_t *recs, size_t max)
+{
+    if (!buf || !recs || len % CLUSTER_TRACE_WIRE_SIZE != 0 ||
+        len / CLUSTER_TRACE_WIRE_SIZE > max) {
+        return -1;
+    }
+
+    size_t count = len / CLUSTER_TRACE_WIRE_SIZE;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *p = buf + i * CLUSTER_TRACE_WIRE_SIZE;
+        if (p[18] == CLUSTER_TRACE_NONE || p[18] >= CLUSTER_TRACE_STAGE_COUNT) {
+            return -1;
+        }
+        recs[i] = (cluster_trace_record_t){
+            .ts_us = (int64_t)get_le(p, 8),
+            .job_id = (uint32_t)get_le(p + 8, 4),
+            .aux = (uint32_t)get_le(p + 12, 4),
+            .node = (uint16_t)get_le(p + 16, 2),
+            .stage = p[18],
+        };
+    }
+    return (int)count;
+}
+
+// ============================================================================
+// Latency Summary
+// ============================================================================
+
+typedef enum {
+    SPAN_KEY_JOB,           // Same job
+    SPAN_KEY_NODE,          // Same job and slave
+    SPAN_KEY_SHARE,         // Same job and nonce
+} span_key_t;
+
+static const struct {
+    const char  *name;
+    uint8_t     from;
+    uint8_t     to;
+    uint8_t     to_alt;         // Second stage that also ends the span
+    span_key_t  key;
+    bool        first_only;     // Only the first "to" per job and slave (skip rebroadcasts)
+} s_spans[CLUSTER_TRACE_SPAN_COUNT] = {
+    { "dispatch",   CLUSTER_TRACE_NOTIFY,      CLUSTER_TRACE_DISTRIBUTE,  0,                      SPAN_KEY_JOB,   true  },
+    { "downlink",   CLUSTER_TRACE_DISTRIBUTE,  CLUSTER_TRACE_WORK_RX,     0,                      SPAN_KEY_NODE,  false },
+    { "asic_feed",  CLUSTER_TRACE_WORK_RX,     CLUSTER_TRACE_ASIC,        0,                      SPAN_KEY_NODE,  false },
+    { "job_age",    CLUSTER_TRACE_NOTIFY,      CLUSTER_TRACE_SHARE_FOUND, 0,                      SPAN_KEY_JOB,   false },
+    { "share_send", CLUSTER_TRACE_SHARE_FOUND, CLUSTER_TRACE_SHARE_TX,    0,                      SPAN_KEY_SHARE, false },
+    { "uplink",     CLUSTER_TRACE_SHARE_TX,    CLUSTER_TRACE_SHARE_RX,    0,                      SPAN_KEY_SHARE, false },
+    { "submit",     CLUSTER_TRACE_SHARE_RX,    CLUSTER_TRACE_SUBMIT,      0,                      SPAN_KEY_SHARE, false },
+    { "pool",       CLUSTER_TRACE_SUBMIT,      CLUSTER_TRACE_ACCEPTED,    CLUSTER_TRACE_REJECTED, SPAN_KEY_SHARE, false },
+    { "found_to_result", CLUSTER_TRACE_SHARE_FOUND, CLUSTER_TRACE_ACCEPTED, CLUSTER_TRACE_REJECTED, SPAN_KEY_SHARE, false },
+    { "stale_age",  CLUSTER_TRACE_NOTIFY,      CLUSTER_TRACE_DROP_STALE,  0,                      SPAN_KEY_JOB,   false },
+};
+
+static bool span_key_match(span_key_t key, const cluster_trace_record_t *a,
+                           const cluster_trace_record_t *b)
+{
+    if (a->job_id != b->job_id) {
+        return false;
+    }
+    switch (key) {
+        case SPAN_KEY_NODE:  return a->node == b->node;
+        case SPAN_KEY_SHARE: return a->aux == b->aux;
+        default:             return true;
+    }
+}
+
+// Whether no earlier record in the stage bucket has the same job and node
+static bool first_of_node(const cluster_trace_record_t *recs, const uint16_t *by_stage,
+                          size_t begin, size_t t)
+{
+    const cluster_trace_record_t *rec = &recs[by_stage[t]];
+    for (size_t i = begin; i < t; i++) {
+        const cluster_trace_record_t *other = &recs[by_stage[i]];
+        if (other->job_id == rec->job_id && other->node == rec->node) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int cmp_int32(const void *a, const void *b)
+{
+    int32_t x = *(const int32_t *)a;
+    int32_t y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+void cluster_trace_summarize(const cluster_trace_record_t *recs, size_t count,
+                             cluster_trace_span_t *spans)
+{
+    if (!spans) {
+        return;
+    }
+
+    for (int s = 0; s < CLUSTER_TRACE_SPAN_COUNT; s++) {
+        spans[s] = (cluster_trace_span_t){
+            .name = s_spans[s].name,
+            .from = s_spans[s].from,
+            .to = s_spans[s].to,
+        };
+    }
+    if (!recs || count == 0) {
+        return;
+    }
+    if (count > UINT16_MAX) {
+        count = UINT16_MAX;
+    }
+
+    // Record indices grouped by stage (counting sort), so each span only
+    // compares its two stages
+    uint16_t *by_stage = malloc(count * sizeof(uint16_t));
+    int32_t *latency = malloc(count * sizeof(int32_t));
+    if (!by_stage || !latency) {
+        free(by_stage);
+        free(latency);
+        return;
+    }
+
+    size_t first[CLUSTER_TRACE_STAGE_COUNT + 1] = {0};
+    for (size_t i = 0; i < count; i++) {
+        if (recs[i].stage < CLUSTER_TRACE_STAGE_COUNT) {
+            first[recs[i].stage + 1]++;
+        }
+    }
+    for (int st = 0; st < CLUSTER_TRACE_STAGE_COUNT; st++) {
+        first[st + 1] += first[st];
+    }
+    size_t fill[CLUSTER_TRACE_STAGE_COUNT];
+    memcpy(fill, first, sizeof(fill));
+    for (size_t i = 0; i < count; i++) {
+        if (recs[i].stage < CLUSTER_TRACE_STAGE_COUNT) {
+            by_stage[fill[recs[i].stage]++] = (uint16_t)i;
+        }
+    }
+
+    for (int s = 0; s < CLUSTER_TRACE_SPAN_COUNT; s++) {
+        uint8_t from = s_spans[s].from;
+        size_t n = 0;
+
+        for (int pass = 0; pass < 2; pass++) {
+            uint8_t to = pass == 0 ? s_spans[s].to : s_spans[s].to_alt;
+            if (to == CLUSTER_TRACE_NONE) {
+                continue;
+            }
+
+            for (size_t t = first[to]; t < first[to + 1]; t++) {
+                const cluster_trace_record_t *end = &recs[by_stage[t]];
+                if (end->flags & CLUSTER_TRACE_F_UNSYNCED) {
+                    continue;
+                }
+                if (s_spans[s].first_only && !first_of_node(recs, by_stage, first[to], t)) {
+                    continue;
+                }
+
+                // Latest start at or (within the clock error) just after the end
+                const cluster_trace_record_t *start = NULL;
+                for (size_t f = first[from]; f < first[from + 1]; f++) {
+                    const cluster_trace_record_t *cand = &recs[by_stage[f]];
+                    if (!(cand->flags & CLUSTER_TRACE_F_UNSYNCED) &&
+                        cand->ts_us <= end->ts_us + TRACE_SKEW_US &&
+                        span_key_match(s_spans[s].key, cand, end) &&
+                        (!start || cand->ts_us > start->ts_us)) {
+                        start = cand;
+                    }
+                }
+                if (!start) {
+                    continue;
+                }
+
+                int64_t us = end->ts_us - start->ts_us;
+                latency[n++] = us > INT32_MAX ? INT32_MAX : (int32_t)us;
+            }
+        }
+
+        if (n == 0) {
+            continue;
+        }
+        qsort(latency, n, sizeof(int32_t), cmp_int32);
+        spans[s].count = n > UINT16_MAX ? UINT16_MAX : (uint16_t)n;
+        spans[s].p50_us = latency[(n - 1) * 50 / 100];
+        spans[s].p90_us = latency[(n - 1) * 90 / 100];
+        spans[s].max_us = latency[n - 1];
+    }
+
+    free(by_stage);
+    free(latency);
+}
+
+#endif // CLUSTER_ENABLED
@@ -0,0 +1,181 @@
+/**
+ * @file cluster_trace.h
+ * @brief Clusteraxe job and share tracing
+ *
+ * Every node writes a fixed-size record - stage, esp_timer timestamp, job
+ * id and nonce/node - at each hop a job and its shares take:
+ *
+ *   master  NOTIFY -> DISTRIBUTE ........................ SHARE_RX -> SUBMIT -> RESULT
+ *   slave               WORK_RX -> ASIC -> SHARE_FOUND -> SHARE_TX
+ *
+ * Records go into a per-node ring that any task can write without a lock
+ * (one atomic increment claims a slot; a per-slot sequence lets readers
+ * skip slots being written). Slaves upload theirs to the master in $CLTRC
+ * sentences; the master maps their timestamps onto its own clock (see
+ * cluster_clock.h) and keeps them in its ring, where /api/cluster/trace
+ * rebuilds timelines and latency percentiles from them.
+ *
+ * Relays upload their own records but do not forward their children's.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#ifndef CLUSTER_TRACE_H
+#define CLUSTER_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CLUSTER_TRACE_NODE_MASTER       0xFFFE      // Node of records about no slave
+#define CLUSTER_TRACE_WIRE_SIZE         19          // Packed record in $CLTRC
+#define CLUSTER_TRACE_UPLOAD_RECORDS    8           // Records per $CLTRC (fits ESP-NOW)
+#define CLUSTER_TRACE_UPLOAD_BURST      4           // $CLTRC sentences per heartbeat at most
+
+#define CLUSTER_TRACE_F_UNSYNCED        0x01        // Node clock not yet mapped to the master's
+
+/**
+ * @brief Trace stages, in the order a share passes them
+ */
+typedef enum {
+    CLUSTER_TRACE_NONE = 0,
+    CLUSTER_TRACE_NOTIFY,           // Master: mining.notify turned into work
+    CLUSTER_TRACE_DISTRIBUTE,       // Master: work sent to a slave
+    CLUSTER_TRACE_WORK_RX,          // Slave: work for us received
+    CLUSTER_TRACE_ASIC,             // Slave: work handed to the ASIC
+    CLUSTER_TRACE_SHARE_FOUND,      // Slave: ASIC returned a nonce
+    CLUSTER_TRACE_SHARE_TX,         // Slave: $CLSHR delivered upstream
+    CLUSTER_TRACE_SHARE_RX,         // Master: $CLSHR received
+    CLUSTER_TRACE_SUBMIT,           // Master: mining.submit sent
+    CLUSTER_TRACE_ACCEPTED,         // Master: pool accepted the share
+    CLUSTER_TRACE_REJECTED,         // Master: pool rejected the share
+    CLUSTER_TRACE_DROP_DUPLICATE,   // Master: share seen before
+    CLUSTER_TRACE_DROP_STALE,       // Master: job gone or ntime out of range
+    CLUSTER_TRACE_DROP_INVALID,     // Master: failed re-hash
+    CLUSTER_TRACE_STAGE_COUNT
+} cluster_trace_stage_t;
+
+/**
+ * @brief One event
+ *
+ * Job stages carry the slave in node; share stages carry the nonce in aux
+ * and the node that found the share in node.
+ */
+typedef struct {
+    int64_t     ts_us;          // esp_timer (master clock once on the master)
+    uint32_t    job_id;
+    uint32_t    aux;            // Nonce for share stages
+    uint16_t    node;           // Slave address, or CLUSTER_TRACE_NODE_MASTER
+    uint8_t     stage;          // cluster_trace_stage_t
+    uint8_t     flags;          // CLUSTER_TRACE_F_*
+} cluster_trace_record_t;
+
+/**
+ * @brief Latency between two stages of the same job, slave or share
+ */
+typedef struct {
+    const char  *name;
+    uint8_t     from;           // cluster_trace_stage_t
+    uint8_t     to;
+    uint16_t    count;          // Pairs found
+    int32_t     p50_us;
+    int32_t     p90_us;
+    int32_t     max_us;
+} cluster_trace_span_t;
+
+#define CLUSTER_TRACE_SPAN_COUNT        10
+
+/**
+ * @brief Record an event now (no-op with tracing off)
+ *
+ * Safe from any task; never blocks.
+ */
+void cluster_trace_record(cluster_trace_stage_t stage, uint16_t node,
+                          uint32_t job_id, uint32_t aux);
+
+/**
+ * @brief Store a record as is (uploaded by a slave)
+ */
+void cluster_trace_put(const cluster_trace_record_t *rec);
+
+/**
+ * @brief Copy out records written at or after *cursor, oldest first
+ *
+ * Pass *cursor = 0 for everything still in the ring. Slots overwritten
+ * before they were read, or being written during the copy, are skipped
+ * and counted in *lost.
+ *
+ * @param cursor In: first record wanted; out: where to continue
+ * @param lost Output: records skipped (may be NULL)
+ * @return Records copied
+ */
+size_t cluster_trace_read(uint32_t *cursor, cluster_trace_record_t *out, size_t max,
+                          uint32_t *lost);
+
+/**
+ * @brief Records written since boot
+ */
+uint32_t cluster_trace_count(void);
+
+/**
+ * @brief Count records a slave dropped before uploading them (master)
+ */
+void cluster_trace_add_lost(uint32_t count);
+
+/**
+ * @brief Records slaves reported dropped since boot (master)
+ */
+uint32_t cluster_trace_lost(void);
+
+/**
+ * @brief Empty the ring
+ */
+void cluster_trace_reset(void);
+
+/**
+ * @brief Pack records for $CLTRC (CLUSTER_TRACE_WIRE_SIZE bytes each)
+ * @return Bytes written, or -1 if buf is too small
+ */
+int cluster_trace_pack(const cluster_trace_record_t *recs, size_t count,
+                       uint8_t *buf, size_t buf_len);
+
+/**
+ * @brief Unpack records from $CLTRC
+ * @return Records unpacked, or -1 on a malformed buffer
+ */
+int cluster_trace_unpack(const uint8_t *buf, size_t len,
+                         cluster_trace_record_t *recs, size_t max);
+
+/**
+ * @brief Latency percentiles for each span over a set of records
+ *
+ * Each "to" record is paired with the latest "from" record of the same
+ * job (and slave, or share) at or before it; dispatch only counts the
+ * first send of a job to each slave, not the master's rebroadcasts.
+ * Records flagged CLUSTER_TRACE_F_UNSYNCED are left out.
+ *
+ * @param spans Output: CLUSTER_TRACE_SPAN_COUNT entries
+ */
+void cluster_trace_summarize(const cluster_trace_record_t *recs, size_t count,
+                             cluster_trace_span_t *spans);
+
+/**
+ * @brief Whether a stage belongs to a share (aux is a nonce)
+ */
+bool cluster_trace_is_share_stage(uint8_t stage);
+
+/**
+ * @brief Stage name for logs and the API
+ */
+const char *cluster_trace_stage_name(uint8_t stage);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLUSTER_TRACE_H
@@ -0,0 +1,894 @@
+/**
+ * @file cluster_transport.c
+ * @brief Transport router for ClusterAxe
+ *
+ * Sits between the cluster core and the frame backends (BAP, ESP-NOW,
+ * UDP). Owns everything that does not depend on the medium:
+ *   - Backend selection (all backends on the master, one on a slave)
+ *   - Peer -> backend routing, learned from received frames
+ *   - Discovery beacons and uplink selection / registration
+ *   - Parsing received frames and dispatching them to the cluster core
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#include "cluster_transport.h"
+#include "cluster_config.h"
+
+#if CLUSTER_ENABLED
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "nvs.h"
+#include "cluster.h"
+#include "cluster_topology.h"
+#include "cluster_relay.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "cluster_transport";
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define NVS_NAMESPACE           "cluster"
+#define NVS_KEY_TRANSPORT       "transport"
+
+// Gap after each work broadcast on backends that repeat work
+#define WORK_RESEND_DELAY_MS    20
+
+#ifdef CONFIG_CLUSTER_ESPNOW_DISCOVERY_INTERVAL_MS
+    #define DISCOVERY_INTERVAL_MS   CONFIG_CLUSTER_ESPNOW_DISCOVERY_INTERVAL_MS
+#else
+    #define DISCOVERY_INTERVAL_MS   1000
+#endif
+
+// Backends in order of preference for a slave's default
+static const cluster_transport_ops_t *const s_backends[] = {
+#if CLUSTER_HAS_ESPNOW
+    &cluster_transport_espnow,
+#endif
+#if CLUSTER_HAS_UDP
+    &cluster_transport_udp,
+#endif
+#if CLUSTER_HAS_BAP
+    &cluster_transport_bap,
+#endif
+};
+
+#define BACKEND_COUNT   (sizeof(s_backends) / sizeof(s_backends[0]))
+
+// ============================================================================
+// State
+// ============================================================================
+
+typedef struct {
+    uint8_t mac[6];
+    const cluster_transport_ops_t *ops;     // NULL = free slot
+    int64_t last_seen;
+} transport_peer_t;
+
+static struct {
+    bool initialized;
+    const cluster_transport_ops_t *active[CLUSTER_TRANSPORT_COUNT];
+    const cluster_transport_ops_t *primary;
+    cluster_transport_rx_cb_t rx_callback;
+    void *rx_callback_ctx;
+    SemaphoreHandle_t mutex;                // Peers and uplink
+
+#if CLUSTER_IS_MASTER || CLUSTER_IS_RELAY
+    transport_peer_t peers[CLUSTER_TRANSPORT_MAX_PEERS];
+    bool discovery_active;
+    TaskHandle_t discovery_task;
+#endif
+
+    // Uplink (slaves and relays)
+    bool registration_sent;                 // Registration sent to current uplink
+    uint8_t uplink_mac[6];
+    const cluster_transport_ops_t *uplink_ops;
+    cluster_uplink_t uplink;                // Uplink selection state
+} g_transport = {0};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static const cluster_transport_ops_t *find_backend(cluster_transport_type_t type)
+{
+    for (size_t i = 0; i < BACKEND_COUNT; i++) {
+        if (s_backends[i]->type == type) {
+            return s_backends[i];
+        }
+    }
+    return NULL;
+}
+
+static bool mac_is_zero(const uint8_t *mac)
+{
+    static const uint8_t zero[6] = {0};
+    return memcmp(mac, zero, 6) == 0;
+}
+
+/**
+ * @brief Backend serving a peer, or NULL if unknown
+ */
+static const cluster_transport_ops_t *peer_backend(const uint8_t *mac)
+{
+    if (!mac || !g_transport.mutex) {
+        return NULL;
+    }
+
+    const cluster_transport_ops_t *ops = NULL;
+    xSemaphoreTake(g_transport.mutex, portMAX_DELAY);
+
+    if (g_transport.uplink_ops && memcmp(g_transport.uplink_mac, mac, 6) == 0) {
+        ops = g_transport.uplink_ops;
+    }
+#if CLUSTER_IS_MASTER || CLUSTER_IS_RELAY
+    for (int i = 0; !ops && i < CLUSTER_TRANSPORT_MAX_PEERS; i++) {
+        if (g_transport.peers[i].ops && memcmp(g_transport.peers[i].mac, mac, 6) == 0) {
+            ops = g_transport.peers[i].ops;
+        }
+    }
+#endif
+
+    xSemaphoreGive(g_transport.mutex);
+    return ops;
+}
+
+#if CLUSTER_IS_MASTER || CLUSTER_IS_RELAY
+/**
+ * @brief Remember which backend a peer was heard on (evicts the stalest)
+ */
+static void learn_peer(const uint8_t *mac, const cluster_transport_ops_t *ops)
+{
+    int64_t now = esp_timer_get_time() / 1000;
+    int free_slot = -1;
+    int oldest = 0;
+
+    xSemaphoreTake(g_transport.mutex, portMAX_DELAY);
+    for (int i = 0; i < CLUSTER_TRANSPORT_MAX_PEERS; i++) {
+        transport_peer_t *p = &g_transport.peers[i];
+        if (!p->ops) {
+            if (free_slot < 0) {
+                free_slot = i;
+            }
+            continue;
+        }
+        if (memcmp(p->mac, mac, 6) == 0) {
+            if (p->ops != ops) {
+                ESP_LOGI(TAG, MACSTR " moved %s -> %s", MAC2STR(mac), p->ops->name, ops->name);
+            }
+            p->ops = ops;
+            p->last_seen = now;
+            xSemaphoreGive(g_transport.mutex);
+            return;
+        }
+        if (p->last_seen < g_transport.peers[oldest].last_seen) {
+            oldest = i;
+        }
+    }
+
+    transport_peer_t *p = &g_transport.peers[free_slot >= 0 ? free_slot : oldest];
+    memcpy(p->mac, mac, 6);
+    p->ops = ops;
+    p->last_seen = now;
+    xSemaphoreGive(g_transport.mutex);
+}
+#endif
+
+static esp_err_t send_work_on(const cluster_transport_ops_t *ops, const char *data, size_t len)
+{
+    if (len > ops->max_msg_size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    esp_err_t ret = ESP_FAIL;
+    for (int attempt = 0; attempt < ops->work_sends; attempt++) {
+        if (ops->broadcast(data, len) == ESP_OK) {
+            ret = ESP_OK;
+        } else {
+            ESP_LOGD(TAG, "%s work send %d failed", ops->name, attempt + 1);
+        }
+        if (ops->work_sends > 1) {
+            vTaskDelay(pdMS_TO_TICKS(WORK_RESEND_DELAY_MS));
+        }
+    }
+    return ret;
+}
+
+// ============================================================================
+// Uplink Registration (slaves)
+// ============================================================================
+
+#if CLUSTER_IS_SLAVE
+/**
+ * @brief A beacon arrived: decide whether to (re)join and register
+ */
+static void handle_beacon(const cluster_transport_ops_t *from, const uint8_t *src_mac,
+                          const cluster_beacon_t *beacon)
+{
+    int64_t now_ms = esp_timer_get_time() / 1000;
+    bool from_uplink = (g_transport.registration_sent &&
+                        memcmp(g_transport.uplink_mac, src_mac, 6) == 0);
+
+    if (!cluster_topology_should_join(&g_transport.uplink, beacon, from_uplink,
+                                      CLUSTER_IS_RELAY, now_ms)) {
+        ESP_LOGD(TAG, "Ignoring beacon from " MACSTR, MAC2STR(src_mac));
+        return;
+    }
+
+    // New uplink, or current one never answered - process it
+    ESP_LOGI(TAG, "Discovery beacon from %s " MACSTR " via %s (free=%u)",
+             beacon->is_relay ? "relay" : "master",
+             MAC2STR(src_mac), from->name, beacon->free_slots);
+
+    if (from->add_peer) {
+        from->add_peer(src_mac);
+    }
+
+    extern const char* cluster_get_hostname(void);
+    extern const char* cluster_get_ip_addr(void);
+
+    // IP is optional (direct MAC-addressed communication); "N/A" is
+    // only for display on the master
+    const char *ip_addr = cluster_get_ip_addr();
+    if (!ip_addr || ip_addr[0] == '\0' || strcmp(ip_addr, "0.0.0.0") == 0) {
+        ip_addr = "N/A";
+        ESP_LOGI(TAG, "No IP assigned yet - registering with IP=N/A");
+    }
+
+    char msg_buf[128];
+    int msg_len = snprintf(msg_buf, sizeof(msg_buf), "$REGISTER,%s,%s",
+                           cluster_get_hostname(), ip_addr);
+
+    // Checksum: XOR of chars between $ and *
+    uint8_t checksum = 0;
+    for (int i = 1; i < msg_len; i++) {
+        checksum ^= msg_buf[i];
+    }
+    msg_len += snprintf(msg_buf + msg_len, sizeof(msg_buf) - msg_len, "*%02X\r\n", checksum);
+
+    // Unicast so other coordinators in range don't claim us
+    esp_err_t ret = from->send(src_mac, msg_buf, msg_len);
+    if (ret == ESP_OK) {
+        xSemaphoreTake(g_transport.mutex, portMAX_DELAY);
+        g_transport.registration_sent = true;
+        memcpy(g_transport.uplink_mac, src_mac, 6);
+        g_transport.uplink_ops = from;
+        xSemaphoreGive(g_transport.mutex);
+        cluster_topology_on_join(&g_transport.uplink, beacon->is_relay, now_ms);
+        ESP_LOGI(TAG, "Sent registration to %s", beacon->is_relay ? "relay" : "master");
+    } else {
+        ESP_LOGW(TAG, "Failed to send registration: %s", esp_err_to_name(ret));
+    }
+}
+#endif
+
+#if CLUSTER_IS_MASTER || CLUSTER_IS_RELAY
+/**
+ * @brief $REGISTER,hostname,ip*CS from a node that picked us from a beacon
+ */
+static void handle_registration(const char *payload, const uint8_t *src_mac)
+{
+    char hostname[32] = {0};
+    char ip_addr[16] = {0};
+
+    const char *ip_comma = strchr(payload, ',');
+    if (ip_comma) {
+        size_t hostname_len = ip_comma - payload;
+        if (hostname_len < sizeof(hostname)) {
+            strncpy(hostname, payload, hostname_len);
+        }
+        // Copy IP (up to * or end)
+        const char *ip_start = ip_comma + 1;
+        const char *ip_end = strchr(ip_start, '*');
+        size_t ip_len = ip_end ? (size_t)(ip_end - ip_start) : strlen(ip_start);
+        if (ip_len < sizeof(ip_addr)) {
+            strncpy(ip_addr, ip_start, ip_len);
+        }
+    } else {
+        // No IP, just hostname
+        const char *end = strchr(payload, '*');
+        size_t len = end ? (size_t)(end - payload) : strlen(payload);
+        if (len < sizeof(hostname)) {
+            strncpy(hostname, payload, len);
+        }
+    }
+
+    ESP_LOGI(TAG, "Registration from " MACSTR ": hostname='%s', ip='%s'",
+             MAC2STR(src_mac), hostname, ip_addr);
+
+#if CLUSTER_IS_MASTER
+    extern esp_err_t cluster_master_handle_registration_with_mac(
+        const char *hostname, const char *ip_addr, const uint8_t *mac_addr);
+    cluster_master_handle_registration_with_mac(hostname, ip_addr, src_mac);
+#else
+    cluster_relay_handle_registration(hostname, ip_addr, src_mac);
+#endif
+}
+#endif
+
+// ============================================================================
+// Receive Path
+// ============================================================================
+
+void cluster_transport_receive(const cluster_transport_ops_t *from,
+                               const uint8_t *src_mac,
+                               char *data, size_t len)
+{
+    if (!g_transport.initialized || !from || !src_mac || !data || len == 0) {
+        return;
+    }
+    data[len] = '\0';
+
+    // Discovery beacon
+    cluster_beacon_t beacon;
+    if (cluster_topology_parse_beacon((const uint8_t *)data, len, &beacon)) {
+#if CLUSTER_IS_SLAVE
+        handle_beacon(from, src_mac, &beacon);
+#endif
+        return;
+    }
+
+#if CLUSTER_IS_MASTER || CLUSTER_IS_RELAY
+    learn_peer(src_mac, from);
+#endif
+
+    ESP_LOGD(TAG, "%s RX from " MACSTR ": %.20s... (len=%d)",
+             from->name, MAC2STR(src_mac), data, (int)len);
+
+    // Cluster message: $MSGTYPE,payload*CS
+    if (data[0] != '$') {
+        ESP_LOGW(TAG, "Message doesn't start with $: 0x%02X", (uint8_t)data[0]);
+        return;
+    }
+
+    char *comma = strchr(data, ',');
+    if (!comma) {
+        ESP_LOGW(TAG, "Message has no comma separator");
+        return;
+    }
+
+    size_t type_len = comma - data - 1;
+    char msg_type[16] = {0};
+    if (type_len >= sizeof(msg_type)) {
+        ESP_LOGW(TAG, "Message type too long: %d", (int)type_len);
+        return;
+    }
+    memcpy(msg_type, data + 1, type_len);
+
+#if CLUSTER_IS_MASTER
+    // Update slave MAC from heartbeats/telemetry (fixes stale/wrong MAC from old registration)
+    if (strcmp(msg_type, "CLHBT") == 0 || strcmp(msg_type, "CLTLM") == 0) {
+        int slave_id = atoi(comma + 1);
+        if (slave_id >= 0 && slave_id < CLUSTER_MAX_SLAVES) {
+            extern void cluster_master_update_slave_mac(uint8_t slave_id, const uint8_t *mac);
+            cluster_master_update_slave_mac(slave_id, src_mac);
+        }
+    }
+#endif
+
+#if CLUSTER_IS_MASTER || CLUSTER_IS_RELAY
+    // Registration carries the MAC we will address the node by
+    if (strcmp(msg_type, "REGISTER") == 0) {
+        handle_registration(comma + 1, src_mac);
+        return;
+    }
+#endif
+
+    if (g_transport.rx_callback) {
+        g_transport.rx_callback(msg_type, comma + 1, len - (comma - data) - 1,
+                                src_mac, g_transport.rx_callback_ctx);
+    } else {
+        ESP_LOGW(TAG, "No rx_callback set!");
+    }
+}
+
+// ============================================================================
+// Discovery Task (Master / Relay)
+// ============================================================================
+
+#if CLUSTER_IS_MASTER || CLUSTER_IS_RELAY
+static void discovery_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "Discovery task started");
+
+    char beacon[32];
+    int64_t last_log = 0;
+
+    while (g_transport.discovery_active) {
+#if CLUSTER_IS_MASTER
+        int beacon_len = cluster_topology_encode_beacon(false, cluster_master_get_free_slots(),
+                                                        beacon, sizeof(beacon));
+#else
+        // A relay only advertises once it has a master slot of its own. It
+        // keeps beaconing when full so its children don't time out the uplink.
+        int beacon_len = -1;
+        if (cluster_slave_get_node_addr() != CLUSTER_NODE_ADDR_INVALID) {
+            beacon_len = cluster_topology_encode_beacon(true, cluster_relay_free_slots(),
+                                                        beacon, sizeof(beacon));
+        }
+#endif
+
+        for (int t = 0; beacon_len > 0 && t < CLUSTER_TRANSPORT_COUNT; t++) {
+            const cluster_transport_ops_t *ops = g_transport.active[t];
+            if (!ops || !ops->discovery) {
+                continue;
+            }
+            esp_err_t ret = ops->broadcast(beacon, beacon_len);
+            // Only log errors occasionally to prevent spamming logs during heavy traffic
+            if (ret != ESP_OK && esp_timer_get_time() - last_log > 5000000) {
+                ESP_LOGW(TAG, "Failed to send %s discovery beacon: %s",
+                         ops->name, esp_err_to_name(ret));
+                last_log = esp_timer_get_time();
+            }
+        }
+
+        // Add random jitter to avoid collisions and yield
+        int jitter = esp_random() % 200;
+        vTaskDelay(pdMS_TO_TICKS(DISCOVERY_INTERVAL_MS + jitter));
+    }
+
+    ESP_LOGI(TAG, "Discovery task stopped");
+    vTaskDelete(NULL);
+}
+#endif
+
+// ============================================================================
+// Core Transport API
+// ============================================================================
+
+esp_err_t cluster_transport_init(cluster_transport_type_t type)
+{
+    if (g_transport.initialized) {
+        ESP_LOGW(TAG, "Already initialized");
+        return ESP_OK;
+    }
+
+    g_transport.mutex = xSemaphoreCreateMutex();
+    if (!g_transport.mutex) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Backends may deliver frames as soon as they start
+    g_transport.initialized = true;
+
+    esp_err_t ret = ESP_ERR_NOT_SUPPORTED;
+    for (size_t i = 0; i < BACKEND_COUNT; i++) {
+        const cluster_transport_ops_t *ops = s_backends[i];
+        if (type != CLUSTER_TRANSPORT_NONE && ops->type != type) {
+            continue;
+        }
+
+        esp_err_t err = ops->init();
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to start %s transport: %s", ops->name, esp_err_to_name(err));
+            ret = (ret == ESP_ERR_NOT_SUPPORTED) ? err : ret;
+            continue;
+        }
+
+        g_transport.active[ops->type] = ops;
+        if (!g_transport.primary) {
+            g_transport.primary = ops;
+        }
+        ret = ESP_OK;
+        ESP_LOGI(TAG, "%s transport started (max %u bytes)", ops->name, (unsigned)ops->max_msg_size);
+    }
+
+    if (ret != ESP_OK) {
+        g_transport.initialized = false;
+        vSemaphoreDelete(g_transport.mutex);
+        g_transport.mutex = NULL;
+    }
+    return ret;
+}
+
+void cluster_transport_deinit(void)
+{
+    if (!g_transport.initialized) {
+        return;
+    }
+
+    cluster_transport_stop_discovery();
+
+    for (int t = 0; t < CLUSTER_TRANSPORT_COUNT; t++) {
+        if (g_transport.active[t]) {
+            g_transport.active[t]->deinit();
+        }
+    }
+
+    vSemaphoreDelete(g_transport.mutex);
+    memset(&g_transport, 0, sizeof(g_transport));
+    ESP_LOGI(TAG, "Transport deinitialized");
+}
+
+cluster_transport_type_t cluster_transport_get_type(void)
+{
+    return g_transport.primary ? g_transport.primary->type : CLUSTER_TRANSPORT_NONE;
+}
+
+esp_err_t cluster_transport_get_info(cluster_transport_info_t *info)
+{
+    if (!info) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(info, 0, sizeof(*info));
+    info->type = cluster_transport_get_type();
+    info->initialized = g_transport.initialized;
+    info->discovery_active = cluster_transport_is_discovering();
+    esp_read_mac(info->self_mac, ESP_MAC_WIFI_STA);
+
+    if (!g_transport.initialized) {
+        return ESP_OK;
+    }
+
+    xSemaphoreTake(g_transport.mutex, portMAX_DELAY);
+    for (int t = 0; t < CLUSTER_TRANSPORT_COUNT; t++) {
+        if (g_transport.active[t]) {
+            info->active_mask |= 1u << t;
+        }
+    }
+    if (g_transport.uplink_ops) {
+        info->has_uplink = true;
+        info->uplink_type = g_transport.uplink_ops->type;
+    }
+#if CLUSTER_IS_MASTER || CLUSTER_IS_RELAY
+    for (int i = 0; i < CLUSTER_TRANSPORT_MAX_PEERS; i++) {
+        if (g_transport.peers[i].ops) {
+            info->peer_count++;
+        }
+    }
+#endif
+    xSemaphoreGive(g_transport.mutex);
+
+    return ESP_OK;
+}
+
+bool cluster_transport_is_ready(void)
+{
+    if (!g_transport.initialized) {
+        return false;
+    }
+    for (int t = 0; t < CLUSTER_TRANSPORT_COUNT; t++) {
+        if (g_transport.active[t] && g_transport.active[t]->is_ready()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+cluster_transport_type_t cluster_transport_get_preferred(void)
+{
+    cluster_transport_type_t type = BACKEND_COUNT ? s_backends[0]->type : CLUSTER_TRANSPORT_NONE;
+
+    nvs_handle_t handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        uint8_t val = 0;
+        if (nvs_get_u8(handle, NVS_KEY_TRANSPORT, &val) == ESP_OK &&
+            find_backend((cluster_transport_type_t)val)) {
+            type = (cluster_transport_type_t)val;
+        }
+        nvs_close(handle);
+    }
+
+    return type;
+}
+
+esp_err_t cluster_transport_set_preferred(cluster_transport_type_t type)
+{
+    if (type != CLUSTER_TRANSPORT_NONE && !find_backend(type)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    err = nvs_set_u8(handle, NVS_KEY_TRANSPORT, (uint8_t)type);
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+
+    nvs_close(handle);
+    return err;
+}
+
+const char *cluster_transport_type_name(cluster_transport_type_t type)
+{
+    switch (type) {
+        case CLUSTER_TRANSPORT_BAP:     return "bap";
+        case CLUSTER_TRANSPORT_ESPNOW:  return "espnow";
+        case CLUSTER_TRANSPORT_UDP:     return "udp";
+        default:                        return "none";
+    }
+}
+
+cluster_transport_type_t cluster_transport_type_from_name(const char *name)
+{
+    for (int t = CLUSTER_TRANSPORT_BAP; name && t < CLUSTER_TRANSPORT_COUNT; t++) {
+        if (strcmp(name, cluster_transport_type_name((cluster_transport_type_t)t)) == 0) {
+            return (cluster_transport_type_t)t;
+        }
+    }
+    return CLUSTER_TRANSPORT_NONE;
+}
+
+// ============================================================================
+// Send/Receive API
+// ============================================================================
+
+esp_err_t cluster_transport_send(const uint8_t *dest_mac, const char *data, size_t len)
+{
+    if (!g_transport.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!dest_mac || !data || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const cluster_transport_ops_t *ops = peer_backend(dest_mac);
+#if !CLUSTER_IS_MASTER
+    // A slave only has one backend
+    if (!ops) {
+        ops = g_transport.primary;
+    }
+#endif
+    if (!ops) {
+        ESP_LOGW(TAG, "No route to " MACSTR, MAC2STR(dest_mac));
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (len > ops->max_msg_size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    return ops->send(dest_mac, data, len);
+}
+
+esp_err_t cluster_transport_send_work(const uint8_t *dest_mac, const char *data, size_t len)
+{
+    if (!g_transport.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const cluster_transport_ops_t *ops = NULL;
+    if (dest_mac && !mac_is_zero(dest_mac)) {
+        ops = peer_backend(dest_mac);
+    }
+    if (ops) {
+        return send_work_on(ops, data, len);
+    }
+
+    // Unknown route (e.g. registered over BAP): every backend
+    esp_err_t ret = ESP_FAIL;
+    for (int t = 0; t < CLUSTER_TRANSPORT_COUNT; t++) {
+        if (g_transport.active[t] && send_work_on(g_transport.active[t], data, len) == ESP_OK) {
+            ret = ESP_OK;
+        }
+    }
+    return ret;
+}
+
+esp_err_t cluster_transport_broadcast_to(const uint8_t *dest_mac, const char *data, size_t len)
+{
+    if (!g_transport.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const cluster_transport_ops_t *ops = peer_backend(dest_mac);
+    if (ops) {
+        return ops->broadcast(data, len);
+    }
+    return cluster_transport_broadcast(data, len);
+}
+
+esp_err_t cluster_transport_send_to_master(const char *data, size_t len)
+{
+    if (!g_transport.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint8_t mac[6];
+    xSemaphoreTake(g_transport.mutex, portMAX_DELAY);
+    const cluster_transport_ops_t *ops = g_transport.uplink_ops;
+    memcpy(mac, g_transport.uplink_mac, 6);
+    xSemaphoreGive(g_transport.mutex);
+
+    if (!ops) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return ops->send(mac, data, len);
+}
+
+esp_err_t cluster_transport_broadcast(const char *data, size_t len)
+{
+    if (!g_transport.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_FAIL;
+    for (int t = 0; t < CLUSTER_TRANSPORT_COUNT; t++) {
+        const cluster_transport_ops_t *ops = g_transport.active[t];
+        if (ops && len <= ops->max_msg_size && ops->broadcast(data, len) == ESP_OK) {
+            ret = ESP_OK;
+        }
+    }
+    return ret;
+}
+
+esp_err_t cluster_transport_register_rx_callback(cluster_transport_rx_cb_t cb, void *ctx)
+{
+    g_transport.rx_callback_ctx = ctx;
+    g_transport.rx_callback = cb;
+    return ESP_OK;
+}
+
+size_t cluster_transport_get_max_msg_size(const uint8_t *dest_mac)
+{
+    const cluster_transport_ops_t *ops = peer_backend(dest_mac);
+    if (ops) {
+        return ops->max_msg_size;
+    }
+
+    size_t max = 0;
+    for (int t = 0; t < CLUSTER_TRANSPORT_COUNT; t++) {
+        const cluster_transport_ops_t *a = g_transport.active[t];
+        if (a && (max == 0 || a->max_msg_size < max)) {
+            max = a->max_msg_size;
+        }
+    }
+    return max;
+}
+
+// ============================================================================
+// Discovery & Uplink
+// ============================================================================
+
+esp_err_t cluster_transport_start_discovery(void)
+{
+#if CLUSTER_IS_MASTER || CLUSTER_IS_RELAY
+    if (g_transport.discovery_active) {
+        return ESP_OK;
+    }
+
+    g_transport.discovery_active = true;
+
+    BaseType_t ret = xTaskCreate(discovery_task,
+                                  "cl_disc",
+                                  8192,
+                                  NULL,
+                                  4,
+                                  &g_transport.discovery_task);
+
+    if (ret != pdPASS) {
+        g_transport.discovery_active = false;
+        ESP_LOGE(TAG, "Failed to create discovery task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Discovery started");
+    return ESP_OK;
+#else
+    ESP_LOGW(TAG, "Discovery only available on master or relay");
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void cluster_transport_stop_discovery(void)
+{
+#if CLUSTER_IS_MASTER || CLUSTER_IS_RELAY
+    if (!g_transport.discovery_active) {
+        return;
+    }
+
+    g_transport.discovery_active = false;
+
+    // Task will delete itself
+    if (g_transport.discovery_task) {
+        // Give task time to exit
+        vTaskDelay(pdMS_TO_TICKS(200));
+        g_transport.discovery_task = NULL;
+    }
+
+    ESP_LOGI(TAG, "Discovery stopped");
+#endif
+}
+
+bool cluster_transport_is_discovering(void)
+{
+#if CLUSTER_IS_MASTER || CLUSTER_IS_RELAY
+    return g_transport.discovery_active;
+#else
+    return false;
+#endif
+}
+
+bool cluster_transport_get_uplink_mac(uint8_t *mac)
+{
+    if (!mac || !g_transport.initialized) {
+        return false;
+    }
+
+    xSemaphoreTake(g_transport.mutex, portMAX_DELAY);
+    bool has_uplink = g_transport.uplink_ops != NULL;
+    if (has_uplink) {
+        memcpy(mac, g_transport.uplink_mac, 6);
+    }
+    xSemaphoreGive(g_transport.mutex);
+
+    return has_uplink;
+}
+
+void cluster_transport_on_registered(void)
+{
+    g_transport.uplink.acked = true;
+}
+
+void cluster_transport_reset_registration(void)
+{
+    if (!g_transport.initialized) {
+        return;
+    }
+
+    xSemaphoreTake(g_transport.mutex, portMAX_DELAY);
+    g_transport.registration_sent = false;
+    g_transport.uplink_ops = NULL;
+    memset(g_transport.uplink_mac, 0, 6);
+    memset(&g_transport.uplink, 0, sizeof(g_transport.uplink));
+    xSemaphoreGive(g_transport.mutex);
+
+    ESP_LOGI(TAG, "Registration state reset - will re-register on next beacon");
+}
+
+void cluster_transport_on_wifi_reconnect(void)
+{
+    if (!g_transport.initialized) {
+        return;
+    }
+
+    for (int t = 0; t < CLUSTER_TRANSPORT_COUNT; t++) {
+        const cluster_transport_ops_t *ops = g_transport.active[t];
+        if (ops && ops->on_wifi_reconnect) {
+            ops->on_wifi_reconnect();
+        }
+    }
+
+    // Handles the case where master or slave rebooted
+    cluster_transport_reset_registration();
+}
+
+// ============================================================================
+// Utility Functions
+// ============================================================================
+
+void cluster_transport_mac_to_str(const uint8_t *mac, char *str)
+{
+    snprintf(str, 18, "%02X:%02X:%02X:%02X:%02X:%02X",
+             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+}
+
+esp_err_t cluster_transport_str_to_mac(const char *str, uint8_t *mac)
+{
+    unsigned int b[6];
+    if (!str || !mac ||
+        sscanf(str, "%2x:%2x:%2x:%2x:%2x:%2x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < 6; i++) {
+        mac[i] = (uint8_t)b[i];
+    }
+    return ESP_OK;
+}
+
+#endif // CLUSTER_ENABLED
@@ -4,7 +4,18 @@
  *
  * Provides a unified API for cluster communication over different transports:
  * - BAP (UART cable) - Original wired transport
- * - ESP-NOW (Wireless) - New wireless transport
+ * - ESP-NOW (Wireless) - 250-byte frames on the WiFi radio
+ * - UDP (LAN) - Multicast work / unicast shares over the WiFi network
+ *
+ * Each backend is a cluster_transport_ops_t that only moves frames. Peer
+ * discovery, uplink selection, registration and message dispatch live in
+ * cluster_transport.c and are shared by all backends. Nodes are identified
+ * by their 6-byte STA MAC on every backend (UDP frames carry it in a small
+ * header), so the cluster core never sees transport addresses.
+ *
+ * The master runs every compiled-in backend at once and learns which one
+ * each slave uses from the frames it receives. A slave runs one backend,
+ * chosen at runtime (NVS, see cluster_transport_set_preferred()).
  *
  * @author ClusterAxe Project
  * @license GPL-3.0
@@ -15,6 +26,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
 #include "cluster_config.h"
 
@@ -22,64 +34,120 @@
 extern "C" {
 #endif
 
+// ============================================================================
+// Backend Availability
+// ============================================================================
+
+#if defined(CONFIG_CLUSTER_TRANSPORT_BAP) || defined(CONFIG_CLUSTER_TRANSPORT_BOTH)
+    #define CLUSTER_HAS_BAP         1
+#else
+    #define CLUSTER_HAS_BAP         0
+#endif
+
+#if defined(CONFIG_CLUSTER_TRANSPORT_ESPNOW) || defined(CONFIG_CLUSTER_TRANSPORT_BOTH)
+    #define CLUSTER_HAS_ESPNOW      1
+#else
+    #define CLUSTER_HAS_ESPNOW      0
+#endif
+
+#if defined(CONFIG_CLUSTER_TRANSPORT_UDP)
+    #define CLUSTER_HAS_UDP         1
+#else
+    #define CLUSTER_HAS_UDP         0
+#endif
+
+// Largest message any backend carries (UDP); ESP-NOW is limited to 250
+#define CLUSTER_TRANSPORT_MAX_MSG       1024
+
+// Peers whose backend the master/relay remembers (slaves + relay children)
+#ifndef CLUSTER_TRANSPORT_MAX_PEERS
+    #define CLUSTER_TRANSPORT_MAX_PEERS (CONFIG_CLUSTER_MAX_SLAVES + 8)
+#endif
+
 // ============================================================================
 // Transport Types
 // ============================================================================
 
 typedef enum {
-    CLUSTER_TRANSPORT_NONE = 0,
+    CLUSTER_TRANSPORT_NONE = 0,     // "All available" for init, "default" for preference
     CLUSTER_TRANSPORT_BAP,          // UART/BAP cable
-    CLUSTER_TRANSPORT_ESPNOW        // ESP-NOW wireless
+    CLUSTER_TRANSPORT_ESPNOW,       // ESP-NOW wireless
+    CLUSTER_TRANSPORT_UDP,          // UDP over the WiFi LAN
+    CLUSTER_TRANSPORT_COUNT
 } cluster_transport_type_t;
 
-// Special slave_id values
-#define CLUSTER_TRANSPORT_BROADCAST     0xFF    // Send to all slaves
-#define CLUSTER_TRANSPORT_MASTER        0xFE    // Send to master
-
 // ============================================================================
 // Callback Types
 // ============================================================================
 
 /**
  * @brief Receive callback function type
- * @param data Received message data
- * @param len Message length
- * @param src_id Source slave ID (or 0xFE for master, 0xFF for unknown)
- * @param ctx User context pointer
+ * @param msg_type Message type string
+ * @param payload Message payload
+ * @param len Payload length
+ * @param src_mac Source MAC address (6 bytes, may be NULL for BAP)
+ * @param ctx User context
  */
-typedef void (*cluster_transport_rx_cb_t)(const uint8_t *data,
-                                           size_t len,
-                                           uint8_t src_id,
-                                           void *ctx);
+typedef void (*cluster_transport_rx_cb_t)(const char *msg_type,
+                                          const char *payload,
+                                          size_t len,
+                                          const uint8_t *src_mac,
+                                          void *ctx);
 
-/**
- * @brief Send complete callback function type
- * @param dst_id Destination slave ID
- * @param success True if send was successful
- */
-typedef void (*cluster_transport_tx_cb_t)(uint8_t dst_id, bool success);
+// ============================================================================
+// Backend Interface
+// ============================================================================
 
 /**
- * @brief Peer discovered callback (ESP-NOW only)
- * @param mac_addr Peer MAC address
- * @param rssi Signal strength
+ * @brief Transport backend operations
+ *
+ * send() is a unicast to a known peer; broadcast() reaches every node on
+ * the backend (ESP-NOW broadcast, UDP multicast, UART). Backends hand
+ * received frames to cluster_transport_receive() from their RX task.
  */
-typedef void (*cluster_transport_peer_cb_t)(const uint8_t *mac_addr, int8_t rssi);
+typedef struct {
+    cluster_transport_type_t type;
+    const char *name;
+    size_t max_msg_size;
+    uint8_t work_sends;             // Times each work message is sent (no ACK on broadcast)
+    bool discovery;                 // Carries discovery beacons
+
+    esp_err_t (*init)(void);
+    void (*deinit)(void);
+    bool (*is_ready)(void);
+    esp_err_t (*send)(const uint8_t *dest_mac, const char *data, size_t len);
+    esp_err_t (*broadcast)(const char *data, size_t len);
+
+    // Optional (may be NULL)
+    esp_err_t (*add_peer)(const uint8_t *mac);
+    esp_err_t (*remove_peer)(const uint8_t *mac);
+    void (*on_wifi_reconnect)(void);
+} cluster_transport_ops_t;
+
+#if CLUSTER_HAS_BAP
+extern const cluster_transport_ops_t cluster_transport_bap;
+#endif
+#if CLUSTER_HAS_ESPNOW
+extern const cluster_transport_ops_t cluster_transport_espnow;
+#endif
+#if CLUSTER_HAS_UDP
+extern const cluster_transport_ops_t cluster_transport_udp;
+#endif
 
 // ============================================================================
 // Transport Info Structure
 // ============================================================================
 
 typedef struct {
-    cluster_transport_type_t type;
+    cluster_transport_type_t type;  // Slave: its backend. Master: first active backend
+    uint8_t active_mask;            // Bit per cluster_transport_type_t that is running
     bool initialized;
     bool discovery_active;
 
-    // ESP-NOW specific
     uint8_t self_mac[6];
-    uint8_t channel;
-    bool encrypted;
-    uint8_t peer_count;
+    bool has_uplink;
+    cluster_transport_type_t uplink_type;
+    uint8_t peer_count;             // Peers with a known backend (master/relay)
 } cluster_transport_info_t;
 
 // ============================================================================
@@ -88,8 +156,8 @@ typedef struct {
 
 /**
  * @brief Initialize the transport layer
- * @param type Transport type to use
- * @return ESP_OK on success
+ * @param type Backend to run, or CLUSTER_TRANSPORT_NONE for every compiled-in backend
+ * @return ESP_OK if at least one backend started
  */
 esp_err_t cluster_transport_init(cluster_transport_type_t type);
 
@@ -100,7 +168,7 @@ void cluster_transport_deinit(void);
 
 /**
  * @brief Get current transport type
- * @return Active transport type
+ * @return Slave: its backend. Master: first active backend
  */
 cluster_transport_type_t cluster_transport_get_type(void);
 
@@ -117,34 +185,60 @@ esp_err_t cluster_transport_get_info(cluster_transport_info_t *info);
  */
 bool cluster_transport_is_ready(void);
 
+/**
+ * @brief Backend a slave should run, from NVS (falls back to the build default)
+ */
+cluster_transport_type_t cluster_transport_get_preferred(void);
+
+/**
+ * @brief Store the backend this node runs as a slave (takes effect on restart)
+ * @return ESP_ERR_NOT_SUPPORTED if the backend is not compiled in
+ */
+esp_err_t cluster_transport_set_preferred(cluster_transport_type_t type);
+
+/**
+ * @brief Short name ("bap", "espnow", "udp")
+ */
+const char *cluster_transport_type_name(cluster_transport_type_t type);
+
+/**
+ * @brief Parse a short name; returns CLUSTER_TRANSPORT_NONE if unknown
+ */
+cluster_transport_type_t cluster_transport_type_from_name(const char *name);
+
 // ============================================================================
 // Send/Receive API
 // ============================================================================
 
 /**
- * @brief Send message to specific slave (master -> slave)
- * @param slave_id Target slave ID (0-15) or CLUSTER_TRANSPORT_BROADCAST
- * @param data Message data
- * @param len Message length
- * @return ESP_OK on success
+ * @brief Unicast to a peer on the backend it was last heard on
+ * @return ESP_ERR_NOT_FOUND if the peer's backend is unknown
  */
-esp_err_t cluster_transport_send(uint8_t slave_id, const uint8_t *data, size_t len);
+esp_err_t cluster_transport_send(const uint8_t *dest_mac, const char *data, size_t len);
 
 /**
- * @brief Send message to master (slave -> master)
- * @param data Message data
- * @param len Message length
- * @return ESP_OK on success
+ * @brief Send work for one node: broadcast on that node's backend
+ *
+ * Sent work_sends times (20 ms apart) on backends without delivery
+ * confirmation. Unknown or NULL MAC: every active backend.
  */
-esp_err_t cluster_transport_send_to_master(const uint8_t *data, size_t len);
+esp_err_t cluster_transport_send_work(const uint8_t *dest_mac, const char *data, size_t len);
 
 /**
- * @brief Broadcast message to all peers
- * @param data Message data
- * @param len Message length
- * @return ESP_OK on success
+ * @brief Broadcast on the backend a peer uses (every backend if unknown)
  */
-esp_err_t cluster_transport_broadcast(const uint8_t *data, size_t len);
+esp_err_t cluster_transport_broadcast_to(const uint8_t *dest_mac, const char *data, size_t len);
+
+/**
+ * @brief Unicast to our uplink (master or relay)
+ * @return ESP_ERR_INVALID_STATE if no uplink is known yet
+ */
+esp_err_t cluster_transport_send_to_master(const char *data, size_t len);
+
+/**
+ * @brief Broadcast on every active backend
+ */
+esp_err_t cluster_transport_broadcast(const char *data, size_t len);
 
 /**
  * @brief Register receive callback
@@ -155,86 +249,70 @@ esp_err_t cluster_transport_broadcast(const uint8_t *data, size_t len);
 esp_err_t cluster_transport_register_rx_callback(cluster_transport_rx_cb_t cb, void *ctx);
 
 /**
- * @brief Register send complete callback
- * @param cb Callback function
- * @return ESP_OK on success
+ * @brief Largest message the backend serving a peer can carry
+ * @param dest_mac Peer, or NULL for the smallest limit of all active backends
+ */
+size_t cluster_transport_get_max_msg_size(const uint8_t *dest_mac);
+
+/**
+ * @brief Entry point for backends: one received frame
+ *
+ * Handles discovery beacons (uplink selection and registration), learns
+ * the sender's backend, and dispatches cluster messages. data must be
+ * writable with room for a terminating NUL at data[len].
  */
-esp_err_t cluster_transport_register_tx_callback(cluster_transport_tx_cb_t cb);
+void cluster_transport_receive(const cluster_transport_ops_t *from,
+                               const uint8_t *src_mac,
+                               char *data, size_t len);
 
 // ============================================================================
-// Discovery API (ESP-NOW)
+// Discovery & Uplink
 // ============================================================================
 
 /**
- * @brief Start peer discovery (master mode)
- * Broadcasts discovery beacons so slaves can find the master.
- * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if BAP transport
+ * @brief Start broadcasting discovery beacons (master or relay)
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED on a plain slave
  */
 esp_err_t cluster_transport_start_discovery(void);
 
 /**
- * @brief Stop peer discovery
+ * @brief Stop discovery broadcasting
  */
 void cluster_transport_stop_discovery(void);
 
 /**
  * @brief Check if discovery is active
- * @return true if broadcasting discovery beacons
  */
 bool cluster_transport_is_discovering(void);
 
 /**
- * @brief Register peer discovery callback
- * Called when a new peer is discovered (ESP-NOW only).
- * @param cb Callback function
- * @return ESP_OK on success
+ * @brief Get uplink MAC address (slaves only)
+ * @return true if an uplink is known
  */
-esp_err_t cluster_transport_register_peer_callback(cluster_transport_peer_cb_t cb);
-
-// ============================================================================
-// Peer Management API
-// ============================================================================
+bool cluster_transport_get_uplink_mac(uint8_t *mac);
 
 /**
- * @brief Add a peer (for directed communication)
- * @param slave_id Slave ID to assign
- * @param mac_addr Peer MAC address (6 bytes) - NULL for BAP
- * @return ESP_OK on success
- */
-esp_err_t cluster_transport_add_peer(uint8_t slave_id, const uint8_t *mac_addr);
-
-/**
- * @brief Remove a peer
- * @param slave_id Slave ID to remove
- * @return ESP_OK on success
+ * @brief Mark the current uplink as having acknowledged our registration
+ *
+ * Until then the node may move to another master/relay beacon
+ * (see cluster_topology.h).
  */
-esp_err_t cluster_transport_remove_peer(uint8_t slave_id);
+void cluster_transport_on_registered(void);
 
 /**
- * @brief Get peer MAC address
- * @param slave_id Slave ID
- * @param mac_addr Output: MAC address (6 bytes)
- * @return ESP_OK on success, ESP_ERR_NOT_FOUND if peer doesn't exist
+ * @brief Forget the uplink; re-register on the next beacon
  */
-esp_err_t cluster_transport_get_peer_mac(uint8_t slave_id, uint8_t *mac_addr);
+void cluster_transport_reset_registration(void);
 
 /**
- * @brief Get peer signal strength (ESP-NOW only)
- * @param slave_id Slave ID
- * @return RSSI in dBm, or 0 if not available
+ * @brief WiFi reconnected: let backends refresh and re-register
  */
-int8_t cluster_transport_get_rssi(uint8_t slave_id);
+void cluster_transport_on_wifi_reconnect(void);
 
 // ============================================================================
 // Utility Functions
 // ============================================================================
 
-/**
- * @brief Get maximum message size for current transport
- * @return Maximum payload size in bytes
- */
-size_t cluster_transport_get_max_msg_size(void);
-
 /**
  * @brief Convert MAC address to string
  * @param mac MAC address (6 bytes)
@@ -0,0 +1,473 @@
+/**
+ * @file cluster_udp.c
+ * @brief LAN UDP transport backend for ClusterAxe
+ *
+ * Plain BSD sockets (lwIP on the device), so the same file builds and runs
+ * on Linux; see tools/cluster_sim/udp_loopback.c.
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#include "cluster_udp.h"
+#include "cluster_transport.h"
+#include "cluster_config.h"
+
+#if CLUSTER_ENABLED && CLUSTER_HAS_UDP
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "cluster_udp";
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define UDP_MAX_PEERS           CLUSTER_TRANSPORT_MAX_PEERS
+#define UDP_FRAME_MAX           (CLUSTER_UDP_HEADER_LEN + CLUSTER_UDP_MAX_MSG)
+#define UDP_RX_POLL_MS          500
+
+// ============================================================================
+// State
+// ============================================================================
+
+typedef struct {
+    bool used;
+    uint8_t mac[6];
+    struct sockaddr_in addr;
+    int64_t last_seen;
+} udp_peer_t;
+
+static struct {
+    bool initialized;
+    volatile bool running;
+    bool configured;
+    cluster_udp_config_t config;
+    uint8_t self_mac[6];
+    int tx_sock;                    // Ephemeral port: all sends + unicast replies
+    int mc_sock;                    // Group port: multicast
+    bool joined;
+    struct sockaddr_in group_addr;
+    struct in_addr iface_addr;
+    udp_peer_t peers[UDP_MAX_PEERS];
+    SemaphoreHandle_t mutex;        // Peers
+    TaskHandle_t rx_task;
+    uint8_t rx_frame[UDP_FRAME_MAX + 1];   // +1 for the terminator added on receive
+} g_udp = { .tx_sock = -1, .mc_sock = -1 };
+
+// ============================================================================
+// Framing
+// ============================================================================
+
+int cluster_udp_encode_frame(const uint8_t *src_mac, const char *msg, size_t msg_len,
+                             uint8_t *frame, size_t frame_len)
+{
+    if (!src_mac || !msg || msg_len > CLUSTER_UDP_MAX_MSG ||
+        frame_len < CLUSTER_UDP_HEADER_LEN + msg_len) {
+        return -1;
+    }
+
+    frame[0] = CLUSTER_UDP_MAGIC_0;
+    frame[1] = CLUSTER_UDP_MAGIC_1;
+    frame[2] = CLUSTER_UDP_VERSION;
+    frame[3] = 0;
+    memcpy(frame + 4, src_mac, 6);
+    memcpy(frame + CLUSTER_UDP_HEADER_LEN, msg, msg_len);
+    return (int)(CLUSTER_UDP_HEADER_LEN + msg_len);
+}
+
+int cluster_udp_decode_frame(const uint8_t *frame, size_t frame_len, uint8_t *src_mac)
+{
+    if (!frame || frame_len <= CLUSTER_UDP_HEADER_LEN ||
+        frame[0] != CLUSTER_UDP_MAGIC_0 || frame[1] != CLUSTER_UDP_MAGIC_1 ||
+        frame[2] != CLUSTER_UDP_VERSION) {
+        return -1;
+    }
+
+    if (src_mac) {
+        memcpy(src_mac, frame + 4, 6);
+    }
+    return CLUSTER_UDP_HEADER_LEN;
+}
+
+// ============================================================================
+// Peers
+// ============================================================================
+
+static void learn_peer(const uint8_t *mac, const struct sockaddr_in *addr)
+{
+    int64_t now = esp_timer_get_time() / 1000;
+    int free_slot = -1;
+    int oldest = 0;
+
+    xSemaphoreTake(g_udp.mutex, portMAX_DELAY);
+    for (int i = 0; i < UDP_MAX_PEERS; i++) {
+        udp_peer_t *p = &g_udp.peers[i];
+        if (!p->used) {
+            if (free_slot < 0) {
+                free_slot = i;
+            }
+            continue;
+        }
+        if (memcmp(p->mac, mac, 6) == 0) {
+            p->addr = *addr;
+            p->last_seen = now;
+            xSemaphoreGive(g_udp.mutex);
+            return;
+        }
+        if (p->last_seen < g_udp.peers[oldest].last_seen) {
+            oldest = i;
+        }
+    }
+
+    udp_peer_t *p = &g_udp.peers[free_slot >= 0 ? free_slot : oldest];
+    p->used = true;
+    memcpy(p->mac, mac, 6);
+    p->addr = *addr;
+    p->last_seen = now;
+    xSemaphoreGive(g_udp.mutex);
+
+    ESP_LOGI(TAG, "Peer " MACSTR " at %s:%u", MAC2STR(mac),
+             inet_ntoa(addr->sin_addr), ntohs(addr->sin_port));
+}
+
+static bool lookup_peer(const uint8_t *mac, struct sockaddr_in *addr)
+{
+    bool found = false;
+
+    xSemaphoreTake(g_udp.mutex, portMAX_DELAY);
+    for (int i = 0; i < UDP_MAX_PEERS; i++) {
+        if (g_udp.peers[i].used && memcmp(g_udp.peers[i].mac, mac, 6) == 0) {
+            *addr = g_udp.peers[i].addr;
+            found = true;
+            break;
+        }
+    }
+    xSemaphoreGive(g_udp.mutex);
+
+    return found;
+}
+
+// ============================================================================
+// Sockets
+// ============================================================================
+
+static void try_join_group(void)
+{
+    struct ip_mreq mreq = {
+        .imr_multiaddr = g_udp.group_addr.sin_addr,
+        .imr_interface = g_udp.iface_addr,
+    };
+
+    if (setsockopt(g_udp.mc_sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) == 0) {
+        g_udp.joined = true;
+        ESP_LOGI(TAG, "Joined %s:%u", g_udp.config.group, g_udp.config.port);
+    }
+}
+
+static void close_sockets(void)
+{
+    if (g_udp.tx_sock >= 0) {
+        close(g_udp.tx_sock);
+        g_udp.tx_sock = -1;
+    }
+    if (g_udp.mc_sock >= 0) {
+        close(g_udp.mc_sock);
+        g_udp.mc_sock = -1;
+    }
+    g_udp.joined = false;
+}
+
+static esp_err_t open_sockets(void)
+{
+    g_udp.tx_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    g_udp.mc_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (g_udp.tx_sock < 0 || g_udp.mc_sock < 0) {
+        ESP_LOGE(TAG, "Failed to create sockets");
+        close_sockets();
+        return ESP_FAIL;
+    }
+
+    // Several nodes may bind the group port on one host
+    int one = 1;
+    setsockopt(g_udp.mc_sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#ifdef SO_REUSEPORT
+    setsockopt(g_udp.mc_sock, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+#endif
+
+    struct sockaddr_in mc_bind = {
+        .sin_family = AF_INET,
+        .sin_port = htons(g_udp.config.port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    struct sockaddr_in tx_bind = {
+        .sin_family = AF_INET,
+        .sin_port = 0,
+        .sin_addr = g_udp.iface_addr,
+    };
+    if (bind(g_udp.mc_sock, (struct sockaddr *)&mc_bind, sizeof(mc_bind)) != 0 ||
+        bind(g_udp.tx_sock, (struct sockaddr *)&tx_bind, sizeof(tx_bind)) != 0) {
+        ESP_LOGE(TAG, "Failed to bind port %u", g_udp.config.port);
+        close_sockets();
+        return ESP_FAIL;
+    }
+
+    // Stay on the local network; loop back so nodes sharing a host hear
+    // each other (our own frames are dropped by MAC)
+    uint8_t ttl = 1;
+    uint8_t loop = 1;
+    setsockopt(g_udp.tx_sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+    setsockopt(g_udp.tx_sock, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    if (g_udp.iface_addr.s_addr != htonl(INADDR_ANY)) {
+        setsockopt(g_udp.tx_sock, IPPROTO_IP, IP_MULTICAST_IF,
+                   &g_udp.iface_addr, sizeof(g_udp.iface_addr));
+    }
+
+    try_join_group();
+    return ESP_OK;
+}
+
+static esp_err_t send_frame(const struct sockaddr_in *to, const char *data, size_t len)
+{
+    uint8_t frame[UDP_FRAME_MAX];
+    int frame_len = cluster_udp_encode_frame(g_udp.self_mac, data, len, frame, sizeof(frame));
+    if (frame_len < 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    int sent = sendto(g_udp.tx_sock, frame, frame_len, 0,
+                      (const struct sockaddr *)to, sizeof(*to));
+    return (sent == frame_len) ? ESP_OK : ESP_FAIL;
+}
+
+// ============================================================================
+// Receive Task
+// ============================================================================
+
+static void receive_from(int sock)
+{
+    struct sockaddr_in from;
+    socklen_t from_len = sizeof(from);
+
+    int n = recvfrom(sock, g_udp.rx_frame, UDP_FRAME_MAX, 0,
+                     (struct sockaddr *)&from, &from_len);
+    if (n <= 0) {
+        return;
+    }
+
+    uint8_t src_mac[6];
+    int offset = cluster_udp_decode_frame(g_udp.rx_frame, n, src_mac);
+    if (offset < 0 || memcmp(src_mac, g_udp.self_mac, 6) == 0) {
+        return;
+    }
+
+    learn_peer(src_mac, &from);
+    cluster_transport_receive(&cluster_transport_udp, src_mac,
+                              (char *)g_udp.rx_frame + offset, n - offset);
+}
+
+static void udp_rx_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "RX task started");
+
+    while (g_udp.running) {
+        if (!g_udp.joined) {
+            try_join_group();
+        }
+
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(g_udp.tx_sock, &readable);
+        FD_SET(g_udp.mc_sock, &readable);
+        int max_fd = g_udp.tx_sock > g_udp.mc_sock ? g_udp.tx_sock : g_udp.mc_sock;
+        struct timeval timeout = { .tv_sec = 0, .tv_usec = UDP_RX_POLL_MS * 1000 };
+
+        if (select(max_fd + 1, &readable, NULL, NULL, &timeout) <= 0) {
+            continue;
+        }
+        if (FD_ISSET(g_udp.mc_sock, &readable)) {
+            receive_from(g_udp.mc_sock);
+        }
+        if (FD_ISSET(g_udp.tx_sock, &readable)) {
+            receive_from(g_udp.tx_sock);
+        }
+    }
+
+    ESP_LOGI(TAG, "RX task stopped");
+    g_udp.rx_task = NULL;
+    vTaskDelete(NULL);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+esp_err_t cluster_udp_configure(const cluster_udp_config_t *config)
+{
+    if (!config || g_udp.initialized) {
+        return config ? ESP_ERR_INVALID_STATE : ESP_ERR_INVALID_ARG;
+    }
+
+    g_udp.config = *config;
+    g_udp.configured = true;
+    return ESP_OK;
+}
+
+esp_err_t cluster_udp_init(void)
+{
+    if (g_udp.initialized) {
+        ESP_LOGW(TAG, "Already initialized");
+        return ESP_OK;
+    }
+
+    if (!g_udp.configured) {
+        g_udp.config.port = CONFIG_CLUSTER_UDP_PORT;
+        strncpy(g_udp.config.group, CONFIG_CLUSTER_UDP_GROUP, sizeof(g_udp.config.group) - 1);
+        g_udp.config.iface[0] = '\0';
+    }
+
+    g_udp.group_addr.sin_family = AF_INET;
+    g_udp.group_addr.sin_port = htons(g_udp.config.port);
+    if (inet_aton(g_udp.config.group, &g_udp.group_addr.sin_addr) == 0) {
+        ESP_LOGE(TAG, "Invalid multicast group '%s'", g_udp.config.group);
+        return ESP_ERR_INVALID_ARG;
+    }
+    g_udp.iface_addr.s_addr = htonl(INADDR_ANY);
+    if (g_udp.config.iface[0] && inet_aton(g_udp.config.iface, &g_udp.iface_addr) == 0) {
+        ESP_LOGE(TAG, "Invalid interface address '%s'", g_udp.config.iface);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_read_mac(g_udp.self_mac, ESP_MAC_WIFI_STA);
+
+    g_udp.mutex = xSemaphoreCreateMutex();
+    if (!g_udp.mutex) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (open_sockets() != ESP_OK) {
+        vSemaphoreDelete(g_udp.mutex);
+        g_udp.mutex = NULL;
+        return ESP_FAIL;
+    }
+
+    g_udp.running = true;
+    if (xTaskCreate(udp_rx_task, "udp_rx", 4096, NULL, 5, &g_udp.rx_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create RX task");
+        g_udp.running = false;
+        close_sockets();
+        vSemaphoreDelete(g_udp.mutex);
+        g_udp.mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    g_udp.initialized = true;
+    ESP_LOGI(TAG, "UDP transport on port %u, group %s (" MACSTR ")",
+             g_udp.config.port, g_udp.config.group, MAC2STR(g_udp.self_mac));
+    return ESP_OK;
+}
+
+void cluster_udp_deinit(void)
+{
+    if (!g_udp.initialized) {
+        return;
+    }
+
+    // Task exits within one poll interval
+    g_udp.running = false;
+    for (int i = 0; g_udp.rx_task && i < 10; i++) {
+        vTaskDelay(pdMS_TO_TICKS(UDP_RX_POLL_MS / 4));
+    }
+
+    close_sockets();
+    vSemaphoreDelete(g_udp.mutex);
+    g_udp.mutex = NULL;
+    memset(g_udp.peers, 0, sizeof(g_udp.peers));
+    g_udp.initialized = false;
+    ESP_LOGI(TAG, "UDP transport deinitialized");
+}
+
+bool cluster_udp_is_ready(void)
+{
+    return g_udp.initialized && g_udp.joined;
+}
+
+esp_err_t cluster_udp_send(const uint8_t *dest_mac, const char *data, size_t len)
+{
+    if (!g_udp.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!dest_mac || !data || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct sockaddr_in to;
+    if (!lookup_peer(dest_mac, &to)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return send_frame(&to, data, len);
+}
+
+esp_err_t cluster_udp_broadcast(const char *data, size_t len)
+{
+    if (!g_udp.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!data || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return send_frame(&g_udp.group_addr, data, len);
+}
+
+void cluster_udp_on_wifi_reconnect(void)
+{
+    if (!g_udp.initialized) {
+        return;
+    }
+
+    // Membership is lost with the interface; the RX task re-joins
+    g_udp.joined = false;
+
+    xSemaphoreTake(g_udp.mutex, portMAX_DELAY);
+    memset(g_udp.peers, 0, sizeof(g_udp.peers));
+    xSemaphoreGive(g_udp.mutex);
+}
+
+// ============================================================================
+// Transport Backend
+// ============================================================================
+
+static esp_err_t udp_add_peer(const uint8_t *mac)
+{
+    // Addresses are learned from received frames
+    (void)mac;
+    return ESP_OK;
+}
+
+const cluster_transport_ops_t cluster_transport_udp = {
+    .type = CLUSTER_TRANSPORT_UDP,
+    .name = "udp",
+    .max_msg_size = CLUSTER_UDP_MAX_MSG,
+    .work_sends = 1,
+    .discovery = true,
+    .init = cluster_udp_init,
+    .deinit = cluster_udp_deinit,
+    .is_ready = cluster_udp_is_ready,
+    .send = cluster_udp_send,
+    .broadcast = cluster_udp_broadcast,
+    .add_peer = udp_add_peer,
+    .on_wifi_reconnect = cluster_udp_on_wifi_reconnect,
+};
+
+#endif // CLUSTER_ENABLED && CLUSTER_HAS_UDP
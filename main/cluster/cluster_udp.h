@@ -0,0 +1,118 @@
+/**
+ * @file cluster_udp.h
+ * @brief LAN UDP transport for ClusterAxe
+ *
+ * Carries the same cluster messages as ESP-NOW over the WiFi network the
+ * nodes are already joined to. Work and discovery beacons go to a
+ * multicast group; registration, shares and heartbeats are unicast to the
+ * address the peer was last heard from. Frames can be much larger than
+ * ESP-NOW's 250 bytes.
+ *
+ * Every datagram starts with a small header carrying the sender's STA MAC,
+ * which is how the cluster core identifies nodes on every backend:
+ *
+ *   'C' 'X' version flags mac[6] | $MSGTYPE,payload*CS\r\n
+ *
+ * Each node uses two sockets: one bound to the group port for multicast,
+ * and one on an ephemeral port for everything it sends and for unicast
+ * replies, so several nodes can share one host (Linux loopback tests).
+ *
+ * @author ClusterAxe Project
+ * @license GPL-3.0
+ */
+
+#ifndef CLUSTER_UDP_H
+#define CLUSTER_UDP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "cluster_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Configuration (can be overridden by Kconfig)
+// ============================================================================
+
+#ifndef CONFIG_CLUSTER_UDP_PORT
+#define CONFIG_CLUSTER_UDP_PORT             47800
+#endif
+
+#ifndef CONFIG_CLUSTER_UDP_GROUP
+#define CONFIG_CLUSTER_UDP_GROUP            "239.255.67.88"
+#endif
+
+#define CLUSTER_UDP_MAGIC_0                 'C'
+#define CLUSTER_UDP_MAGIC_1                 'X'
+#define CLUSTER_UDP_VERSION                 1
+#define CLUSTER_UDP_HEADER_LEN              10
+#define CLUSTER_UDP_MAX_MSG                 1024
+
+typedef struct {
+    uint16_t port;                  // Multicast group port
+    char group[16];                 // Multicast group address
+    char iface[16];                 // Local address to send/join on ("" = default route)
+} cluster_udp_config_t;
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * @brief Override the Kconfig port/group/interface; call before init
+ */
+esp_err_t cluster_udp_configure(const cluster_udp_config_t *config);
+
+/**
+ * @brief Open sockets and start the RX task
+ *
+ * Joining the group is retried from the RX task until the network is up.
+ */
+esp_err_t cluster_udp_init(void);
+
+void cluster_udp_deinit(void);
+
+/**
+ * @brief Sockets open and multicast group joined
+ */
+bool cluster_udp_is_ready(void);
+
+/**
+ * @brief Unicast to a peer we have heard from
+ * @return ESP_ERR_NOT_FOUND if the peer's address is not known yet
+ */
+esp_err_t cluster_udp_send(const uint8_t *dest_mac, const char *data, size_t len);
+
+/**
+ * @brief Send to the multicast group
+ */
+esp_err_t cluster_udp_broadcast(const char *data, size_t len);
+
+/**
+ * @brief Re-join the group and drop learned addresses (DHCP may have changed them)
+ */
+void cluster_udp_on_wifi_reconnect(void);
+
+/**
+ * @brief Build a datagram: header + message
+ * @return Frame length, or -1 if it does not fit
+ */
+int cluster_udp_encode_frame(const uint8_t *src_mac, const char *msg, size_t msg_len,
+                             uint8_t *frame, size_t frame_len);
+
+/**
+ * @brief Validate a datagram's header
+ * @param src_mac Output: sender MAC (6 bytes)
+ * @return Offset of the message in the frame, or -1 if not a cluster frame
+ */
+int cluster_udp_decode_frame(const uint8_t *frame, size_t frame_len, uint8_t *src_mac);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLUSTER_UDP_H
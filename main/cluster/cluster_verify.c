@@ -0,0 +1,103 @@
+/**
+ * @file cluster_verify.c
+ * @brief Clusteraxe Master Share Verification
+ *
+ * Header reconstruction and difficulty check. See cluster_verify.h.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include "cluster_verify.h"
+#include "utils.h"
+#include "string.h"
+
+#if CLUSTER_ENABLED && CLUSTER_IS_MASTER
+
+// Difficulty 1 target, 0x00000000FFFF0000...0000 (same constant as mining.c)
+static const double truediffone = 26959535291011309493156476344723991336010898738574164086137773096960.0;
+
+static void put_le32(uint8_t *dest, uint32_t value)
+{
+    dest[0] = value & 0xFF;
+    dest[1] = (value >> 8) & 0xFF;
+    dest[2] = (value >> 16) & 0xFF;
+    dest[3] = (value >> 24) & 0xFF;
+}
+
+void cluster_verify_header_from_work(const cluster_work_t *work, cluster_work_header_t *out)
+{
+    if (!work || !out) {
+        return;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->job_id = work->job_id;
+    out->pool_id = work->pool_id;
+    out->extranonce2_len = work->extranonce2_len > 8 ? 8 : work->extranonce2_len;
+    memcpy(out->extranonce2, work->extranonce2, out->extranonce2_len);
+    out->version = work->version;
+    out->version_mask = work->version_mask;
+    out->nbits = work->nbits;
+    out->pool_diff = work->pool_diff;
+
+    // Stratum sends the previous block hash with each 32-bit word byte-swapped
+    memcpy(out->prev_block_hash, work->prev_block_hash, 32);
+    reverse_endianness_per_word(out->prev_block_hash);
+    memcpy(out->merkle_root, work->merkle_root, 32);
+}
+
+cluster_verify_result_t cluster_verify_share(const cluster_work_header_t *header,
+                                             const cluster_share_t *share,
+                                             double *difficulty)
+{
+    if (difficulty) {
+        *difficulty = 0;
+    }
+    if (!header || !share) {
+        return CLUSTER_VERIFY_BAD_HASH;
+    }
+
+    // Slaves send only the rolled bits, as they would submit them to the pool.
+    // No mask means the pool did not negotiate rolling; leave it to the hash check
+    if (header->version_mask && (share->version & ~header->version_mask)) {
+        return CLUSTER_VERIFY_BAD_VERSION;
+    }
+
+    uint8_t block_header[80];
+    put_le32(block_header, header->version ^ share->version);
+    memcpy(block_header + 4, header->prev_block_hash, 32);
+    memcpy(block_header + 36, header->merkle_root, 32);
+    put_le32(block_header + 68, share->ntime);
+    put_le32(block_header + 72, header->nbits);
+    put_le32(block_header + 76, share->nonce);
+
+    uint8_t hash[32];
+    double_sha256_bin(block_header, sizeof(block_header), hash);
+
+    double diff = truediffone / le256todouble(hash);
+    if (difficulty) {
+        *difficulty = diff;
+    }
+
+    if (diff < 1.0) {
+        return CLUSTER_VERIFY_BAD_HASH;
+    }
+    if (diff < (double)header->pool_diff) {
+        return CLUSTER_VERIFY_LOW_DIFF;
+    }
+    return CLUSTER_VERIFY_OK;
+}
+
+const char *cluster_verify_result_name(cluster_verify_result_t result)
+{
+    switch (result) {
+        case CLUSTER_VERIFY_OK:          return "ok";
+        case CLUSTER_VERIFY_BAD_VERSION: return "version outside mask";
+        case CLUSTER_VERIFY_BAD_HASH:    return "header mismatch";
+        case CLUSTER_VERIFY_LOW_DIFF:    return "below pool difficulty";
+        default:                         return "?";
+    }
+}
+
+#endif // CLUSTER_ENABLED && CLUSTER_IS_MASTER
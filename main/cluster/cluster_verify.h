@@ -0,0 +1,80 @@
+/**
+ * @file cluster_verify.h
+ * @brief Clusteraxe Master Share Verification
+ *
+ * Before a slave share goes to the pool the master rebuilds the 80-byte
+ * block header from the work it sent that slave (cluster_work_header_t,
+ * kept in the work index) plus the share's nonce, ntime and rolled
+ * version bits, and hashes it. A share that does not reach the pool
+ * difficulty would only come back as a reject, so it is counted against
+ * the slave and, by default, dropped.
+ *
+ * Header layout, as test_nonce_value() builds it on the slave:
+ *
+ *   version   job version XOR the share's rolled bits, little-endian
+ *   prev      previous block hash (stratum words byte-swapped)
+ *   merkle    merkle root for the slave's extranonce2
+ *   ntime, nbits, nonce   little-endian
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#ifndef CLUSTER_VERIFY_H
+#define CLUSTER_VERIFY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cluster.h"
+#include "cluster_index.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CLUSTER_SHARE_VERIFY_OFF    0
+#define CLUSTER_SHARE_VERIFY_COUNT  1
+#define CLUSTER_SHARE_VERIFY_DROP   2
+
+// Shares waiting behind the one being submitted above which verification is
+// skipped, so a burst (e.g. replay after an outage) is not delayed by hashing
+#ifndef CLUSTER_SHARE_VERIFY_MAX_BACKLOG
+    #define CLUSTER_SHARE_VERIFY_MAX_BACKLOG    8
+#endif
+
+/**
+ * @brief Verification outcome
+ */
+typedef enum {
+    CLUSTER_VERIFY_OK = 0,
+    CLUSTER_VERIFY_BAD_VERSION,     // Rolled bits outside the job's version mask
+    CLUSTER_VERIFY_BAD_HASH,        // Below difficulty 1: header does not match the work
+    CLUSTER_VERIFY_LOW_DIFF,        // Valid header, but below the pool difficulty
+} cluster_verify_result_t;
+
+/**
+ * @brief Header fields of a work assignment, as the slave will hash them
+ *
+ * @param work Work as sent to the slave (its extranonce2 and merkle root)
+ */
+void cluster_verify_header_from_work(const cluster_work_t *work, cluster_work_header_t *out);
+
+/**
+ * @brief Re-hash a share against its work assignment
+ *
+ * @param difficulty Output (optional): share difficulty, 0 if not hashed
+ */
+cluster_verify_result_t cluster_verify_share(const cluster_work_header_t *header,
+                                             const cluster_share_t *share,
+                                             double *difficulty);
+
+/**
+ * @brief Short name of a verification result for logs
+ */
+const char *cluster_verify_result_name(cluster_verify_result_t result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLUSTER_VERIFY_H
@@ -14,6 +14,7 @@
 #include "work_queue.h"
 #include "device_config.h"
 #include "display.h"
+#include "boot_timeline.h"
 
 #define STRATUM_USER CONFIG_STRATUM_USER
 #define FALLBACK_STRATUM_USER CONFIG_FALLBACK_STRATUM_USER
@@ -191,6 +192,9 @@ typedef struct
     bool ASIC_initalized;
     bool psram_is_available;
 
+    // When each startup phase ran, for /api/system/boot
+    boot_timeline_t BOOT_TIMELINE;
+
     // Task handle for job creation task (for notifications)
     TaskHandle_t create_jobs_task_handle;
 
@@ -0,0 +1,59 @@
+// Writes dist/axe-os/assets.txt, the index the firmware loads at boot to
+// serve the UI without probing SPIFFS (see main/http_server/static_assets.h).
+// Runs last, after the files are compressed and the originals removed.
+const crypto = require('crypto');
+const fs = require('fs');
+const path = require('path');
+
+const directory = path.join(__dirname, 'dist', 'axe-os');
+const manifestName = 'assets.txt';
+
+const mimeTypes = {
+    '.html': 'text/html',
+    '.js': 'application/javascript',
+    '.css': 'text/css',
+    '.json': 'application/json',
+    '.txt': 'text/plain',
+    '.png': 'image/png',
+    '.jpg': 'image/jpeg',
+    '.ico': 'image/x-icon',
+    '.svg': 'image/svg+xml',
+    '.pdf': 'application/pdf',
+    '.woff': 'font/woff',
+    '.woff2': 'font/woff2',
+    '.webmanifest': 'application/manifest+json',
+};
+
+// outputHashing "all" names bundles and media name.<hash>.ext
+const hashedName = /\.[0-9a-f]{16,}\.[a-z0-9]+$/;
+
+function listFiles(dirPath) {
+    return fs.readdirSync(dirPath, { withFileTypes: true }).flatMap(entry => {
+        const filePath = path.join(dirPath, entry.name);
+        return entry.isDirectory() ? listFiles(filePath) : [filePath];
+    });
+}
+
+const lines = [`# ClusterAxe UI assets: etag size flags mime path`];
+for (const filePath of listFiles(directory).sort()) {
+    let urlPath = '/' + path.relative(directory, filePath).split(path.sep).join('/');
+    if (urlPath === '/' + manifestName) {
+        continue;
+    }
+    const gzip = urlPath.endsWith('.gz');
+    if (gzip) {
+        urlPath = urlPath.slice(0, -3);
+    }
+    const data = fs.readFileSync(filePath);
+    const etag = crypto.createHash('sha256').update(data).digest('hex').slice(0, 16);
+    const mime = mimeTypes[path.extname(urlPath).toLowerCase()] || 'application/octet-stream';
+    const flags = (gzip ? 'g' : '') + (hashedName.test(urlPath) ? 'i' : '') || '-';
+
+    // As browsers send it: the server matches the raw request URI
+    lines.push(`${etag} ${data.length} ${flags} ${mime} ${encodeURI(urlPath)}`);
+}
+
+const outputPath = path.join(directory, manifestName);
+fs.writeFileSync(outputPath, lines.join('\n') + '\n');
+
+console.log(`Generated ${outputPath} with ${lines.length - 1} assets`);
@@ -130,7 +130,8 @@ export class SystemService {
     }
 
     if (environment.production) {
-      const options = { params: new HttpParams().set('columns', columnList.join(',')) };
+      // The firmware downsamples its 720 rows to what the chart can show
+      const options = { params: new HttpParams().set('columns', columnList.join(',')).set('points', '240') };
       return this.httpClient.get<ISystemStatistics>(`${uri}/api/system/statistics`, options).pipe(timeout(5000));
     }
 
@@ -1,10 +1,12 @@
 #include <pthread.h>
+#include <ctype.h>
 #include <fcntl.h>
 #include <string.h>
 #include <limits.h>
 #include <math.h>
 #include <sys/param.h>
 #include <sys/stat.h>
+#include <time.h>
 #include <esp_heap_caps.h>
 
 #include "freertos/FreeRTOS.h"
@@ -43,10 +45,15 @@
 #include "asic.h"
 #include "TPS546.h"
 #include "statistics_task.h"
+#include "statistics_downsample.h"
+#include "log_task.h"
+#include "metrics.h"
+#include "static_assets.h"
 #include "theme_api.h"  // Add theme API include
 #include "axe-os/api/system/asic_settings.h"
 #include "display.h"
 #include "http_server.h"
+#include "json_stream.h"
 #include "system.h"
 #include "websocket.h"
 #include "auto_timing.h"
@@ -57,8 +64,11 @@
 #include "cluster.h"
 #include "cluster_integration.h"
 #include "cluster_autotune.h"
+#include "cluster_proxy.h"
+#include "cluster_transport.h"
+#include "cluster_trace.h"
 #if defined(CONFIG_CLUSTER_TRANSPORT_ESPNOW) || defined(CONFIG_CLUSTER_TRANSPORT_BOTH)
-#include "cluster_espnow.h"
+#include "cluster_relay.h"
 #endif
 #endif
 
@@ -86,8 +96,6 @@ static const char * STATS_LABEL_FREE_HEAP = "freeHeap";
 
 static const char * STATS_LABEL_TIMESTAMP = "timestamp";
 
-static int system_info_prebuffer_len = 256;
-static int system_statistics_prebuffer_len = 256;
 static int system_wifi_scan_prebuffer_len = 256;
 static int api_common_prebuffer_len = 256;
 
@@ -135,6 +143,67 @@ DataSource strToDataSource(const char * sourceStr)
     return SRC_NONE;
 }
 
+static const char * dataSourceToStr(DataSource source)
+{
+    switch (source) {
+        case SRC_HASHRATE:          return STATS_LABEL_HASHRATE;
+        case SRC_HASHRATE_1m:       return STATS_LABEL_HASHRATE_1m;
+        case SRC_HASHRATE_10m:      return STATS_LABEL_HASHRATE_10m;
+        case SRC_HASHRATE_1h:       return STATS_LABEL_HASHRATE_1h;
+        case SRC_ERROR_PERCENTAGE:  return STATS_LABEL_ERROR_PERCENTAGE;
+        case SRC_ASIC_TEMP:         return STATS_LABEL_ASIC_TEMP;
+        case SRC_VR_TEMP:           return STATS_LABEL_VR_TEMP;
+        case SRC_ASIC_VOLTAGE:      return STATS_LABEL_ASIC_VOLTAGE;
+        case SRC_VOLTAGE:           return STATS_LABEL_VOLTAGE;
+        case SRC_POWER:             return STATS_LABEL_POWER;
+        case SRC_CURRENT:           return STATS_LABEL_CURRENT;
+        case SRC_FAN_SPEED:         return STATS_LABEL_FAN_SPEED;
+        case SRC_FAN_RPM:           return STATS_LABEL_FAN_RPM;
+        case SRC_FAN2_RPM:          return STATS_LABEL_FAN2_RPM;
+        case SRC_WIFI_RSSI:         return STATS_LABEL_WIFI_RSSI;
+        case SRC_FREE_HEAP:         return STATS_LABEL_FREE_HEAP;
+        default:                    return NULL;
+    }
+}
+
+static double statisticValue(const struct StatisticsData * data, DataSource source)
+{
+    switch (source) {
+        case SRC_HASHRATE:          return data->hashrate;
+        case SRC_HASHRATE_1m:       return data->hashrate_1m;
+        case SRC_HASHRATE_10m:      return data->hashrate_10m;
+        case SRC_HASHRATE_1h:       return data->hashrate_1h;
+        case SRC_ERROR_PERCENTAGE:  return data->errorPercentage;
+        case SRC_ASIC_TEMP:         return data->chipTemperature;
+        case SRC_VR_TEMP:           return data->vrTemperature;
+        case SRC_ASIC_VOLTAGE:      return data->coreVoltageActual;
+        case SRC_VOLTAGE:           return data->voltage;
+        case SRC_POWER:             return data->power;
+        case SRC_CURRENT:           return data->current;
+        case SRC_FAN_SPEED:         return data->fanSpeed;
+        case SRC_FAN_RPM:           return data->fanRPM;
+        case SRC_FAN2_RPM:          return data->fan2RPM;
+        case SRC_WIFI_RSSI:         return data->wifiRSSI;
+        case SRC_FREE_HEAP:         return data->freeHeap;
+        default:                    return 0;
+    }
+}
+
+// Integer columns print as they are, float columns with cJSON_CreateFloat's rounding
+static bool statisticIsFloat(DataSource source)
+{
+    switch (source) {
+        case SRC_ASIC_VOLTAGE:
+        case SRC_FAN_RPM:
+        case SRC_FAN2_RPM:
+        case SRC_WIFI_RSSI:
+        case SRC_FREE_HEAP:
+            return false;
+        default:
+            return true;
+    }
+}
+
 static GlobalState * GLOBAL_STATE;
 static httpd_handle_t server = NULL;
 
@@ -148,6 +217,31 @@ esp_err_t HTTP_send_json(httpd_req_t * req, const cJSON * item, int * prebuffer_
     return res;
 }
 
+// Scratch buffer for streamed responses, on the httpd task's stack
+#define JSON_CHUNK_SIZE 1024
+
+static esp_err_t json_chunk_flush(void * ctx, const char * data, size_t len)
+{
+    return httpd_resp_send_chunk((httpd_req_t *) ctx, data, len);
+}
+
+/**
+ * @brief Close a streamed response: last chunk, then the terminating empty one
+ *
+ * Large responses are written with json_stream straight into chunks of
+ * JSON_CHUNK_SIZE rather than built as a cJSON tree and printed into one
+ * heap string, so their heap use no longer grows with the document.
+ */
+static esp_err_t HTTP_finish_json_stream(httpd_req_t * req, json_stream_t * js)
+{
+    esp_err_t res = json_stream_finish(js);
+    if (res != ESP_OK) {
+        ESP_LOGW(TAG, "Streamed JSON response failed after %u bytes: %s", (unsigned) js->total, esp_err_to_name(res));
+        return res;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
 /**
  * Precision factor for float to JSON conversion
  *
@@ -364,6 +458,97 @@ static void readAxeOSVersion(void) {
     }
 }
 
+// Web UI files as listed by the build's manifest; empty for a www
+// partition built before there was one. Files it does not list are
+// served by probing the filesystem, as before.
+static static_assets_t web_assets;
+
+static char * read_whole_file(const char * path, size_t * len)
+{
+    FILE * f = fopen(path, "r");
+    if (f == NULL) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char * data = (size >= 0) ? malloc(size + 1) : NULL;
+    if (data != NULL && fread(data, 1, size, f) != (size_t) size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    if (data != NULL) {
+        data[size] = '\0';
+        *len = size;
+    }
+    return data;
+}
+
+/**
+ * @brief Load the asset manifest and hold the small files in PSRAM
+ */
+static void load_web_assets(void)
+{
+    size_t len = 0;
+    char * manifest = read_whole_file(STATIC_ASSETS_MANIFEST, &len);
+    if (manifest == NULL) {
+        ESP_LOGW(TAG, "No %s, web UI is served without ETags", STATIC_ASSETS_MANIFEST);
+        return;
+    }
+    esp_err_t err = static_assets_load(&web_assets, manifest);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Bad %s (%s)", STATIC_ASSETS_MANIFEST, esp_err_to_name(err));
+        return;
+    }
+
+    size_t budget = CONFIG_HTTP_ASSET_CACHE_KB * 1024;
+    size_t cached = 0;
+    int cached_count = 0;
+    for (int i = 0; i < web_assets.count; i++) {
+        static_asset_t * asset = &web_assets.assets[i];
+        if (asset->size > CONFIG_HTTP_ASSET_CACHE_FILE_KB * 1024 || cached + asset->size > budget) {
+            continue;
+        }
+        char path[FILE_PATH_MAX];
+        if (!static_assets_file_path(asset, "", path, sizeof(path))) {
+            continue;
+        }
+        uint8_t * data = heap_caps_malloc(asset->size ? asset->size : 1, MALLOC_CAP_SPIRAM);
+        if (data == NULL) {
+            // No PSRAM: everything is streamed
+            break;
+        }
+        int fd = open(path, O_RDONLY, 0);
+        ssize_t read_bytes = (fd >= 0) ? read(fd, data, asset->size) : -1;
+        if (fd >= 0) {
+            close(fd);
+        }
+        if (read_bytes != (ssize_t) asset->size) {
+            ESP_LOGW(TAG, "%s does not match the manifest", path);
+            free(data);
+            continue;
+        }
+        asset->data = data;
+        cached += asset->size;
+        cached_count++;
+    }
+
+    ESP_LOGI(TAG, "Web UI: %d assets, %d held in PSRAM (%u bytes)", web_assets.count, cached_count,
+             (unsigned) cached);
+}
+
+/**
+ * @brief Drop the manifest and the PSRAM copies, e.g. before loading a new www partition's
+ */
+static void unload_web_assets(void)
+{
+    for (int i = 0; i < web_assets.count; i++) {
+        free(web_assets.assets[i].data);
+    }
+    static_assets_free(&web_assets);
+}
+
 esp_err_t init_fs(void)
 {
     esp_vfs_spiffs_conf_t conf = {.base_path = "", .partition_label = NULL, .max_files = 5, .format_if_mount_failed = false};
@@ -389,6 +574,7 @@ esp_err_t init_fs(void)
     }
 
     readAxeOSVersion();
+    load_web_assets();
 
     return ESP_OK;
 }
@@ -495,14 +681,106 @@ static bool file_exists(const char *path) {
     return (stat(path, &buffer) == 0);
 }
 
+/* Send the unknown path back to the root, which also serves the captive portal */
+static esp_err_t redirect_to_root(httpd_req_t * req)
+{
+    // Set status
+    httpd_resp_set_status(req, "302 Temporary Redirect");
+    // Redirect to the "/" root directory
+    httpd_resp_set_hdr(req, "Location", "/");
+    // iOS requires content in the response to detect a captive portal, simply redirecting is not sufficient.
+    httpd_resp_send(req, "Redirect to the captive portal", HTTPD_RESP_USE_STRLEN);
+
+    ESP_LOGI(TAG, "Redirecting to root");
+    return ESP_OK;
+}
+
+/* Stream an open file as the response body, then close it */
+static esp_err_t send_file_chunks(httpd_req_t * req, rest_server_context_t * rest_context, int fd, const char * path)
+{
+    char * chunk = rest_context->scratch;
+    ssize_t read_bytes;
+    do {
+        /* Read file in chunks into the scratch buffer */
+        read_bytes = read(fd, chunk, SCRATCH_BUFSIZE);
+        if (read_bytes == -1) {
+            ESP_LOGE(TAG, "Failed to read file : %s", path);
+        } else if (read_bytes > 0) {
+            /* Send the buffer contents as HTTP response chunk */
+            if (httpd_resp_send_chunk(req, chunk, read_bytes) != ESP_OK) {
+                close(fd);
+                ESP_LOGE(TAG, "File sending failed!");
+                /* Abort sending file */
+                httpd_resp_sendstr_chunk(req, NULL);
+                /* Respond with 500 Internal Server Error */
+                httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to send file");
+                return ESP_OK;
+            }
+        }
+    } while (read_bytes > 0);
+    /* Close file after sending complete */
+    close(fd);
+    ESP_LOGI(TAG, "File sending complete");
+    /* Respond with an empty chunk to signal HTTP response completion */
+    httpd_resp_send_chunk(req, NULL, 0);
+    return ESP_OK;
+}
+
+/**
+ * @brief Serve a file listed in the manifest
+ *
+ * A browser that already has it gets a bodiless 304 and flash is not
+ * touched; a file held in PSRAM goes out in one send; anything else is a
+ * single open() and the usual chunked read.
+ */
+static esp_err_t send_web_asset(httpd_req_t * req, rest_server_context_t * rest_context, const static_asset_t * asset)
+{
+    httpd_resp_set_type(req, asset->mime);
+    httpd_resp_set_hdr(req, "ETag", asset->etag);
+    httpd_resp_set_hdr(req, "Cache-Control", static_assets_cache_control(asset));
+
+    char if_none_match[128];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK &&
+        static_assets_etag_matches(if_none_match, asset->etag)) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    if (asset->flags & STATIC_ASSET_GZIP) {
+        httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    }
+
+    if (asset->data != NULL) {
+        return httpd_resp_send(req, (const char *) asset->data, asset->size);
+    }
+
+    char filepath[FILE_PATH_MAX];
+    int fd = -1;
+    if (static_assets_file_path(asset, rest_context->base_path, filepath, sizeof(filepath))) {
+        fd = open(filepath, O_RDONLY, 0);
+    }
+    if (fd == -1) {
+        ESP_LOGE(TAG, "%s is in the manifest but cannot be opened", asset->path);
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to read file");
+    }
+    return send_file_chunks(req, rest_context, fd, filepath);
+}
+
 /* Send HTTP response with the contents of the requested file */
 static esp_err_t rest_common_get_handler(httpd_req_t * req)
 {
+    rest_server_context_t * rest_context = (rest_server_context_t *) req->user_ctx;
+
+    // Anything the manifest does not list is looked for on the filesystem
+    const static_asset_t * asset = static_assets_find(&web_assets, req->uri);
+    if (asset != NULL) {
+        return send_web_asset(req, rest_context, asset);
+    }
+
     char filepath[FILE_PATH_MAX];
     char gz_file[FILE_PATH_MAX];
     uint8_t filePathLength = sizeof(filepath);
 
-    rest_server_context_t * rest_context = (rest_server_context_t *) req->user_ctx;
     strlcpy(filepath, rest_context->base_path, filePathLength);
     if (req->uri[strlen(req->uri) - 1] == '/') {
         strlcat(filepath, "/index.html", filePathLength);
@@ -519,15 +797,7 @@ static esp_err_t rest_common_get_handler(httpd_req_t * req)
 
     int fd = open(file_to_open, O_RDONLY, 0);
     if (fd == -1) {
-        // Set status
-        httpd_resp_set_status(req, "302 Temporary Redirect");
-        // Redirect to the "/" root directory
-        httpd_resp_set_hdr(req, "Location", "/");
-        // iOS requires content in the response to detect a captive portal, simply redirecting is not sufficient.
-        httpd_resp_send(req, "Redirect to the captive portal", HTTPD_RESP_USE_STRLEN);
-
-        ESP_LOGI(TAG, "Redirecting to root");
-        return ESP_OK;
+        return redirect_to_root(req);
     }
     if (req->uri[strlen(req->uri) - 1] != '/') {
         httpd_resp_set_hdr(req, "Cache-Control", "max-age=2592000");
@@ -537,32 +807,7 @@ static esp_err_t rest_common_get_handler(httpd_req_t * req)
         httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
     }
 
-    char * chunk = rest_context->scratch;
-    ssize_t read_bytes;
-    do {
-        /* Read file in chunks into the scratch buffer */
-        read_bytes = read(fd, chunk, SCRATCH_BUFSIZE);
-        if (read_bytes == -1) {
-            ESP_LOGE(TAG, "Failed to read file : %s", file_to_open);
-        } else if (read_bytes > 0) {
-            /* Send the buffer contents as HTTP response chunk */
-            if (httpd_resp_send_chunk(req, chunk, read_bytes) != ESP_OK) {
-                close(fd);
-                ESP_LOGE(TAG, "File sending failed!");
-                /* Abort sending file */
-                httpd_resp_sendstr_chunk(req, NULL);
-                /* Respond with 500 Internal Server Error */
-                httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to send file");
-                return ESP_OK;
-            }
-        }
-    } while (read_bytes > 0);
-    /* Close file after sending complete */
-    close(fd);
-    ESP_LOGI(TAG, "File sending complete");
-    /* Respond with an empty chunk to signal HTTP response completion */
-    httpd_resp_send_chunk(req, NULL, 0);
-    return ESP_OK;
+    return send_file_chunks(req, rest_context, fd, file_to_open);
 }
 
 static esp_err_t handle_options_request(httpd_req_t * req)
@@ -858,164 +1103,166 @@ static esp_err_t GET_system_info(httpd_req_t * req)
     int8_t wifi_rssi = -90;
     get_wifi_current_rssi(&wifi_rssi);
 
-    cJSON * root = cJSON_CreateObject();
-    cJSON_AddFloatToObject(root, "power", GLOBAL_STATE->POWER_MANAGEMENT_MODULE.power);
-    cJSON_AddFloatToObject(root, "voltage", GLOBAL_STATE->POWER_MANAGEMENT_MODULE.voltage);
-    cJSON_AddFloatToObject(root, "current", Power_get_current(GLOBAL_STATE));
+    char chunk[JSON_CHUNK_SIZE];
+    json_stream_t js;
+    json_stream_init(&js, chunk, sizeof(chunk), true, json_chunk_flush, req);
+
+    json_stream_begin_object(&js, NULL);
+    json_stream_float(&js, "power", GLOBAL_STATE->POWER_MANAGEMENT_MODULE.power);
+    json_stream_float(&js, "voltage", GLOBAL_STATE->POWER_MANAGEMENT_MODULE.voltage);
+    json_stream_float(&js, "current", Power_get_current(GLOBAL_STATE));
 
     // Calculate efficiency (J/TH) = Power (W) / Hashrate (TH/s)
     // hashRate is in GH/s, so divide by 1000 to get TH/s
     float hashrate_th = GLOBAL_STATE->SYSTEM_MODULE.current_hashrate / 1000.0f;
     float efficiency = (hashrate_th > 0) ? (GLOBAL_STATE->POWER_MANAGEMENT_MODULE.power / hashrate_th) : 0;
-    cJSON_AddFloatToObject(root, "efficiency", efficiency);
-    cJSON_AddFloatToObject(root, "temp", GLOBAL_STATE->POWER_MANAGEMENT_MODULE.chip_temp_avg);
-    cJSON_AddFloatToObject(root, "temp2", GLOBAL_STATE->POWER_MANAGEMENT_MODULE.chip_temp2_avg);
-    cJSON_AddFloatToObject(root, "vrTemp", GLOBAL_STATE->POWER_MANAGEMENT_MODULE.vr_temp);
-    cJSON_AddNumberToObject(root, "maxPower", GLOBAL_STATE->DEVICE_CONFIG.family.max_power);
-    cJSON_AddNumberToObject(root, "nominalVoltage", GLOBAL_STATE->DEVICE_CONFIG.family.nominal_voltage);
-    cJSON_AddFloatToObject(root, "hashRate", GLOBAL_STATE->SYSTEM_MODULE.current_hashrate);
-    cJSON_AddFloatToObject(root, "hashRate_1m", GLOBAL_STATE->SYSTEM_MODULE.hashrate_1m);
-    cJSON_AddFloatToObject(root, "hashRate_10m", GLOBAL_STATE->SYSTEM_MODULE.hashrate_10m);
-    cJSON_AddFloatToObject(root, "hashRate_1h", GLOBAL_STATE->SYSTEM_MODULE.hashrate_1h);
-    cJSON_AddFloatToObject(root, "expectedHashrate", GLOBAL_STATE->POWER_MANAGEMENT_MODULE.expected_hashrate);
-    cJSON_AddFloatToObject(root, "errorPercentage", GLOBAL_STATE->SYSTEM_MODULE.error_percentage);
-    cJSON_AddNumberToObject(root, "bestDiff", GLOBAL_STATE->SYSTEM_MODULE.best_nonce_diff);
-    cJSON_AddNumberToObject(root, "bestSessionDiff", GLOBAL_STATE->SYSTEM_MODULE.best_session_nonce_diff);
-    cJSON_AddNumberToObject(root, "poolDifficulty", GLOBAL_STATE->pool_difficulty);
-
-    cJSON_AddNumberToObject(root, "isUsingFallbackStratum", GLOBAL_STATE->SYSTEM_MODULE.is_using_fallback);
-    cJSON_AddNumberToObject(root, "poolAddrFamily", GLOBAL_STATE->SYSTEM_MODULE.pool_addr_family);
-
-    cJSON_AddNumberToObject(root, "isPSRAMAvailable", GLOBAL_STATE->psram_is_available);
-
-    cJSON_AddNumberToObject(root, "freeHeap", esp_get_free_heap_size());
-
-    cJSON_AddNumberToObject(root, "freeHeapInternal", heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
-    cJSON_AddNumberToObject(root, "freeHeapSpiram", heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
-    
-    cJSON_AddNumberToObject(root, "coreVoltage", nvs_config_get_u16(NVS_CONFIG_ASIC_VOLTAGE));
-    cJSON_AddNumberToObject(root, "coreVoltageActual", VCORE_get_voltage_mv(GLOBAL_STATE));
-    cJSON_AddNumberToObject(root, "frequency", frequency);
-    cJSON_AddStringToObject(root, "ssid", ssid);
-    cJSON_AddStringToObject(root, "macAddr", formattedMac);
-    cJSON_AddStringToObject(root, "hostname", hostname);
-    cJSON_AddStringToObject(root, "ipv4", ipv4);
-    cJSON_AddStringToObject(root, "ipv6", ipv6);
-    cJSON_AddStringToObject(root, "wifiStatus", GLOBAL_STATE->SYSTEM_MODULE.wifi_status);
-    cJSON_AddNumberToObject(root, "wifiRSSI", wifi_rssi);
-    cJSON_AddNumberToObject(root, "apEnabled", GLOBAL_STATE->SYSTEM_MODULE.ap_enabled);
-    cJSON_AddNumberToObject(root, "sharesAccepted", GLOBAL_STATE->SYSTEM_MODULE.shares_accepted);
-    cJSON_AddNumberToObject(root, "sharesRejected", GLOBAL_STATE->SYSTEM_MODULE.shares_rejected);
-
-    cJSON *error_array = cJSON_CreateArray();
-    cJSON_AddItemToObject(root, "sharesRejectedReasons", error_array);
+    json_stream_float(&js, "efficiency", efficiency);
+    json_stream_float(&js, "temp", GLOBAL_STATE->POWER_MANAGEMENT_MODULE.chip_temp_avg);
+    json_stream_float(&js, "temp2", GLOBAL_STATE->POWER_MANAGEMENT_MODULE.chip_temp2_avg);
+    json_stream_float(&js, "vrTemp", GLOBAL_STATE->POWER_MANAGEMENT_MODULE.vr_temp);
+    json_stream_number(&js, "maxPower", GLOBAL_STATE->DEVICE_CONFIG.family.max_power);
+    json_stream_number(&js, "nominalVoltage", GLOBAL_STATE->DEVICE_CONFIG.family.nominal_voltage);
+    json_stream_float(&js, "hashRate", GLOBAL_STATE->SYSTEM_MODULE.current_hashrate);
+    json_stream_float(&js, "hashRate_1m", GLOBAL_STATE->SYSTEM_MODULE.hashrate_1m);
+    json_stream_float(&js, "hashRate_10m", GLOBAL_STATE->SYSTEM_MODULE.hashrate_10m);
+    json_stream_float(&js, "hashRate_1h", GLOBAL_STATE->SYSTEM_MODULE.hashrate_1h);
+    json_stream_float(&js, "expectedHashrate", GLOBAL_STATE->POWER_MANAGEMENT_MODULE.expected_hashrate);
+    json_stream_float(&js, "errorPercentage", GLOBAL_STATE->SYSTEM_MODULE.error_percentage);
+    json_stream_number(&js, "bestDiff", GLOBAL_STATE->SYSTEM_MODULE.best_nonce_diff);
+    json_stream_number(&js, "bestSessionDiff", GLOBAL_STATE->SYSTEM_MODULE.best_session_nonce_diff);
+    json_stream_number(&js, "poolDifficulty", GLOBAL_STATE->pool_difficulty);
+
+    json_stream_number(&js, "isUsingFallbackStratum", GLOBAL_STATE->SYSTEM_MODULE.is_using_fallback);
+    json_stream_number(&js, "poolAddrFamily", GLOBAL_STATE->SYSTEM_MODULE.pool_addr_family);
+
+    json_stream_number(&js, "isPSRAMAvailable", GLOBAL_STATE->psram_is_available);
+
+    json_stream_number(&js, "freeHeap", esp_get_free_heap_size());
+
+    json_stream_number(&js, "freeHeapInternal", heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+    json_stream_number(&js, "freeHeapSpiram", heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
     
+    json_stream_number(&js, "coreVoltage", nvs_config_get_u16(NVS_CONFIG_ASIC_VOLTAGE));
+    json_stream_number(&js, "coreVoltageActual", VCORE_get_voltage_mv(GLOBAL_STATE));
+    json_stream_number(&js, "frequency", frequency);
+    json_stream_string(&js, "ssid", ssid);
+    json_stream_string(&js, "macAddr", formattedMac);
+    json_stream_string(&js, "hostname", hostname);
+    json_stream_string(&js, "ipv4", ipv4);
+    json_stream_string(&js, "ipv6", ipv6);
+    json_stream_string(&js, "wifiStatus", GLOBAL_STATE->SYSTEM_MODULE.wifi_status);
+    json_stream_number(&js, "wifiRSSI", wifi_rssi);
+    json_stream_number(&js, "apEnabled", GLOBAL_STATE->SYSTEM_MODULE.ap_enabled);
+    json_stream_number(&js, "sharesAccepted", GLOBAL_STATE->SYSTEM_MODULE.shares_accepted);
+    json_stream_number(&js, "sharesRejected", GLOBAL_STATE->SYSTEM_MODULE.shares_rejected);
+
+    json_stream_begin_array(&js, "sharesRejectedReasons");
     for (int i = 0; i < GLOBAL_STATE->SYSTEM_MODULE.rejected_reason_stats_count; i++) {
-        cJSON *error_obj = cJSON_CreateObject();
-        cJSON_AddStringToObject(error_obj, "message", GLOBAL_STATE->SYSTEM_MODULE.rejected_reason_stats[i].message);
-        cJSON_AddNumberToObject(error_obj, "count", GLOBAL_STATE->SYSTEM_MODULE.rejected_reason_stats[i].count);
-        cJSON_AddItemToArray(error_array, error_obj);
-    }
-
-    cJSON_AddNumberToObject(root, "uptimeSeconds", (esp_timer_get_time() - GLOBAL_STATE->SYSTEM_MODULE.start_time) / 1000000);
-    cJSON_AddNumberToObject(root, "smallCoreCount", GLOBAL_STATE->DEVICE_CONFIG.family.asic.small_core_count);
-    cJSON_AddStringToObject(root, "ASICModel", GLOBAL_STATE->DEVICE_CONFIG.family.asic.name);
-    cJSON_AddStringToObject(root, "stratumURL", stratumURL);
-    cJSON_AddNumberToObject(root, "stratumPort", nvs_config_get_u16(NVS_CONFIG_STRATUM_PORT));
-    cJSON_AddStringToObject(root, "stratumUser", stratumUser);
-    cJSON_AddNumberToObject(root, "stratumSuggestedDifficulty", nvs_config_get_u16(NVS_CONFIG_STRATUM_DIFFICULTY));
-    cJSON_AddNumberToObject(root, "stratumExtranonceSubscribe", nvs_config_get_bool(NVS_CONFIG_STRATUM_EXTRANONCE_SUBSCRIBE));
-    cJSON_AddStringToObject(root, "fallbackStratumURL", fallbackStratumURL);
-    cJSON_AddNumberToObject(root, "fallbackStratumPort", nvs_config_get_u16(NVS_CONFIG_FALLBACK_STRATUM_PORT));
-    cJSON_AddStringToObject(root, "fallbackStratumUser", fallbackStratumUser);
-    cJSON_AddNumberToObject(root, "fallbackStratumSuggestedDifficulty", nvs_config_get_u16(NVS_CONFIG_FALLBACK_STRATUM_DIFFICULTY));
-    cJSON_AddNumberToObject(root, "fallbackStratumExtranonceSubscribe", nvs_config_get_bool(NVS_CONFIG_FALLBACK_STRATUM_EXTRANONCE_SUBSCRIBE));
-    cJSON_AddNumberToObject(root, "responseTime", GLOBAL_STATE->SYSTEM_MODULE.response_time);
-    cJSON_AddNumberToObject(root, "responseTimeSecondary", GLOBAL_STATE->SYSTEM_MODULE.response_time_secondary);
+        json_stream_begin_object(&js, NULL);
+        json_stream_string(&js, "message", GLOBAL_STATE->SYSTEM_MODULE.rejected_reason_stats[i].message);
+        json_stream_number(&js, "count", GLOBAL_STATE->SYSTEM_MODULE.rejected_reason_stats[i].count);
+        json_stream_end_object(&js);
+    }
+    json_stream_end_array(&js);
+
+    json_stream_number(&js, "uptimeSeconds", (esp_timer_get_time() - GLOBAL_STATE->SYSTEM_MODULE.start_time) / 1000000);
+    json_stream_number(&js, "smallCoreCount", GLOBAL_STATE->DEVICE_CONFIG.family.asic.small_core_count);
+    json_stream_string(&js, "ASICModel", GLOBAL_STATE->DEVICE_CONFIG.family.asic.name);
+    json_stream_string(&js, "stratumURL", stratumURL);
+    json_stream_number(&js, "stratumPort", nvs_config_get_u16(NVS_CONFIG_STRATUM_PORT));
+    json_stream_string(&js, "stratumUser", stratumUser);
+    json_stream_number(&js, "stratumSuggestedDifficulty", nvs_config_get_u16(NVS_CONFIG_STRATUM_DIFFICULTY));
+    json_stream_number(&js, "stratumExtranonceSubscribe", nvs_config_get_bool(NVS_CONFIG_STRATUM_EXTRANONCE_SUBSCRIBE));
+    json_stream_string(&js, "fallbackStratumURL", fallbackStratumURL);
+    json_stream_number(&js, "fallbackStratumPort", nvs_config_get_u16(NVS_CONFIG_FALLBACK_STRATUM_PORT));
+    json_stream_string(&js, "fallbackStratumUser", fallbackStratumUser);
+    json_stream_number(&js, "fallbackStratumSuggestedDifficulty", nvs_config_get_u16(NVS_CONFIG_FALLBACK_STRATUM_DIFFICULTY));
+    json_stream_number(&js, "fallbackStratumExtranonceSubscribe", nvs_config_get_bool(NVS_CONFIG_FALLBACK_STRATUM_EXTRANONCE_SUBSCRIBE));
+    json_stream_number(&js, "responseTime", GLOBAL_STATE->SYSTEM_MODULE.response_time);
+    json_stream_number(&js, "responseTimeSecondary", GLOBAL_STATE->SYSTEM_MODULE.response_time_secondary);
 
     // Dual pool mode settings
-    cJSON_AddNumberToObject(root, "poolMode", nvs_config_get_u16(NVS_CONFIG_POOL_MODE));
-    cJSON_AddNumberToObject(root, "poolBalance", nvs_config_get_u16(NVS_CONFIG_POOL_BALANCE));
-    cJSON_AddNumberToObject(root, "primaryPoolConnected", GLOBAL_STATE->primary_pool_connected);
-    cJSON_AddNumberToObject(root, "secondaryPoolConnected", GLOBAL_STATE->secondary_pool_connected);
-    cJSON_AddNumberToObject(root, "poolDifficultySecondary", GLOBAL_STATE->pool_difficulty_secondary);
+    json_stream_number(&js, "poolMode", nvs_config_get_u16(NVS_CONFIG_POOL_MODE));
+    json_stream_number(&js, "poolBalance", nvs_config_get_u16(NVS_CONFIG_POOL_BALANCE));
+    json_stream_number(&js, "primaryPoolConnected", GLOBAL_STATE->primary_pool_connected);
+    json_stream_number(&js, "secondaryPoolConnected", GLOBAL_STATE->secondary_pool_connected);
+    json_stream_number(&js, "poolDifficultySecondary", GLOBAL_STATE->pool_difficulty_secondary);
 
     // Dual pool statistics
-    cJSON *dualPoolStats = cJSON_CreateObject();
-    cJSON_AddNumberToObject(dualPoolStats, "primaryAccepted", GLOBAL_STATE->SYSTEM_MODULE.dual_pool_shares_accepted[0]);
-    cJSON_AddNumberToObject(dualPoolStats, "primaryRejected", GLOBAL_STATE->SYSTEM_MODULE.dual_pool_shares_rejected[0]);
-    cJSON_AddNumberToObject(dualPoolStats, "secondaryAccepted", GLOBAL_STATE->SYSTEM_MODULE.dual_pool_shares_accepted[1]);
-    cJSON_AddNumberToObject(dualPoolStats, "secondaryRejected", GLOBAL_STATE->SYSTEM_MODULE.dual_pool_shares_rejected[1]);
-    cJSON_AddItemToObject(root, "dualPoolStats", dualPoolStats);
+    json_stream_begin_object(&js, "dualPoolStats");
+    json_stream_number(&js, "primaryAccepted", GLOBAL_STATE->SYSTEM_MODULE.dual_pool_shares_accepted[0]);
+    json_stream_number(&js, "primaryRejected", GLOBAL_STATE->SYSTEM_MODULE.dual_pool_shares_rejected[0]);
+    json_stream_number(&js, "secondaryAccepted", GLOBAL_STATE->SYSTEM_MODULE.dual_pool_shares_accepted[1]);
+    json_stream_number(&js, "secondaryRejected", GLOBAL_STATE->SYSTEM_MODULE.dual_pool_shares_rejected[1]);
+    json_stream_end_object(&js);
 
-    cJSON_AddStringToObject(root, "version", esp_app_get_description()->version);
-    cJSON_AddStringToObject(root, "axeOSVersion", axeOSVersion);
+    json_stream_string(&js, "version", esp_app_get_description()->version);
+    json_stream_string(&js, "axeOSVersion", axeOSVersion);
 
-    cJSON_AddStringToObject(root, "idfVersion", esp_get_idf_version());
-    cJSON_AddStringToObject(root, "boardVersion", GLOBAL_STATE->DEVICE_CONFIG.board_version);
-    cJSON_AddStringToObject(root, "resetReason", esp_reset_reason_to_string(esp_reset_reason()));
-    cJSON_AddStringToObject(root, "runningPartition", esp_ota_get_running_partition()->label);
+    json_stream_string(&js, "idfVersion", esp_get_idf_version());
+    json_stream_string(&js, "boardVersion", GLOBAL_STATE->DEVICE_CONFIG.board_version);
+    json_stream_string(&js, "resetReason", esp_reset_reason_to_string(esp_reset_reason()));
+    json_stream_string(&js, "runningPartition", esp_ota_get_running_partition()->label);
 
-    cJSON_AddNumberToObject(root, "overheat_mode", nvs_config_get_bool(NVS_CONFIG_OVERHEAT_MODE));
-    cJSON_AddNumberToObject(root, "overclockEnabled", nvs_config_get_bool(NVS_CONFIG_OVERCLOCK_ENABLED));
-    cJSON_AddStringToObject(root, "display", display);
-    cJSON_AddNumberToObject(root, "rotation", nvs_config_get_u16(NVS_CONFIG_ROTATION));
-    cJSON_AddNumberToObject(root, "invertscreen", nvs_config_get_bool(NVS_CONFIG_INVERT_SCREEN));
-    cJSON_AddNumberToObject(root, "displayTimeout", nvs_config_get_i32(NVS_CONFIG_DISPLAY_TIMEOUT));
+    json_stream_number(&js, "overheat_mode", nvs_config_get_bool(NVS_CONFIG_OVERHEAT_MODE));
+    json_stream_number(&js, "overclockEnabled", nvs_config_get_bool(NVS_CONFIG_OVERCLOCK_ENABLED));
+    json_stream_string(&js, "display", display);
+    json_stream_number(&js, "rotation", nvs_config_get_u16(NVS_CONFIG_ROTATION));
+    json_stream_number(&js, "invertscreen", nvs_config_get_bool(NVS_CONFIG_INVERT_SCREEN));
+    json_stream_number(&js, "displayTimeout", nvs_config_get_i32(NVS_CONFIG_DISPLAY_TIMEOUT));
 
-    cJSON_AddNumberToObject(root, "autofanspeed", nvs_config_get_bool(NVS_CONFIG_AUTO_FAN_SPEED));
+    json_stream_number(&js, "autofanspeed", nvs_config_get_bool(NVS_CONFIG_AUTO_FAN_SPEED));
 
-    cJSON_AddFloatToObject(root, "fanspeed", GLOBAL_STATE->POWER_MANAGEMENT_MODULE.fan_perc);
-    cJSON_AddNumberToObject(root, "manualFanSpeed", nvs_config_get_u16(NVS_CONFIG_MANUAL_FAN_SPEED));
-    cJSON_AddNumberToObject(root, "minFanSpeed", nvs_config_get_u16(NVS_CONFIG_MIN_FAN_SPEED));
-    cJSON_AddNumberToObject(root, "temptarget", nvs_config_get_u16(NVS_CONFIG_TEMP_TARGET));
-    cJSON_AddNumberToObject(root, "fanrpm", GLOBAL_STATE->POWER_MANAGEMENT_MODULE.fan_rpm);
-    cJSON_AddNumberToObject(root, "fan2rpm", GLOBAL_STATE->POWER_MANAGEMENT_MODULE.fan2_rpm);
+    json_stream_float(&js, "fanspeed", GLOBAL_STATE->POWER_MANAGEMENT_MODULE.fan_perc);
+    json_stream_number(&js, "manualFanSpeed", nvs_config_get_u16(NVS_CONFIG_MANUAL_FAN_SPEED));
+    json_stream_number(&js, "minFanSpeed", nvs_config_get_u16(NVS_CONFIG_MIN_FAN_SPEED));
+    json_stream_number(&js, "temptarget", nvs_config_get_u16(NVS_CONFIG_TEMP_TARGET));
+    json_stream_number(&js, "fanrpm", GLOBAL_STATE->POWER_MANAGEMENT_MODULE.fan_rpm);
+    json_stream_number(&js, "fan2rpm", GLOBAL_STATE->POWER_MANAGEMENT_MODULE.fan2_rpm);
 
-    cJSON_AddNumberToObject(root, "statsFrequency", nvs_config_get_u16(NVS_CONFIG_STATISTICS_FREQUENCY));
+    json_stream_number(&js, "statsFrequency", nvs_config_get_u16(NVS_CONFIG_STATISTICS_FREQUENCY));
 
-    cJSON_AddNumberToObject(root, "blockFound", GLOBAL_STATE->SYSTEM_MODULE.block_found);
+    json_stream_number(&js, "blockFound", GLOBAL_STATE->SYSTEM_MODULE.block_found);
 
     if (GLOBAL_STATE->SYSTEM_MODULE.power_fault > 0) {
-        cJSON_AddStringToObject(root, "power_fault", VCORE_get_fault_string(GLOBAL_STATE));
+        json_stream_string(&js, "power_fault", VCORE_get_fault_string(GLOBAL_STATE));
     }
 
     if (GLOBAL_STATE->block_height > 0) {
-        cJSON_AddNumberToObject(root, "blockHeight", GLOBAL_STATE->block_height);
-        cJSON_AddStringToObject(root, "scriptsig", GLOBAL_STATE->scriptsig);
-        cJSON_AddNumberToObject(root, "networkDifficulty", GLOBAL_STATE->network_nonce_diff);
+        json_stream_number(&js, "blockHeight", GLOBAL_STATE->block_height);
+        json_stream_string(&js, "scriptsig", GLOBAL_STATE->scriptsig);
+        json_stream_number(&js, "networkDifficulty", GLOBAL_STATE->network_nonce_diff);
     }
 
     // Secondary pool block header info
     if (GLOBAL_STATE->block_height_secondary > 0) {
-        cJSON_AddNumberToObject(root, "blockHeightSecondary", GLOBAL_STATE->block_height_secondary);
-        cJSON_AddStringToObject(root, "scriptsigSecondary", GLOBAL_STATE->scriptsig_secondary);
-        cJSON_AddNumberToObject(root, "networkDifficultySecondary", GLOBAL_STATE->network_nonce_diff_secondary);
+        json_stream_number(&js, "blockHeightSecondary", GLOBAL_STATE->block_height_secondary);
+        json_stream_string(&js, "scriptsigSecondary", GLOBAL_STATE->scriptsig_secondary);
+        json_stream_number(&js, "networkDifficultySecondary", GLOBAL_STATE->network_nonce_diff_secondary);
     }
 
-    cJSON *hashrate_monitor = cJSON_CreateObject();
-    cJSON_AddItemToObject(root, "hashrateMonitor", hashrate_monitor);
-    
-    cJSON *asics_array = cJSON_CreateArray();
-    cJSON_AddItemToObject(hashrate_monitor, "asics", asics_array);
+    json_stream_begin_object(&js, "hashrateMonitor");
+    json_stream_begin_array(&js, "asics");
 
     if (GLOBAL_STATE->HASHRATE_MONITOR_MODULE.is_initialized) {
         for (int asic_nr = 0; asic_nr < GLOBAL_STATE->DEVICE_CONFIG.family.asic_count; asic_nr++) {
-            cJSON *asic = cJSON_CreateObject();
-            cJSON_AddItemToArray(asics_array, asic);
-            cJSON_AddFloatToObject(asic, "total", GLOBAL_STATE->HASHRATE_MONITOR_MODULE.total_measurement[asic_nr].hashrate);
+            json_stream_begin_object(&js, NULL);
+            json_stream_float(&js, "total", GLOBAL_STATE->HASHRATE_MONITOR_MODULE.total_measurement[asic_nr].hashrate);
 
             int hash_domains = GLOBAL_STATE->DEVICE_CONFIG.family.asic.hash_domains;
-            cJSON* hash_domain_array = cJSON_CreateArray();
+            json_stream_begin_array(&js, "domains");
             for (int domain_nr = 0; domain_nr < hash_domains; domain_nr++) {
-                cJSON *hashrate = cJSON_CreateFloat(GLOBAL_STATE->HASHRATE_MONITOR_MODULE.domain_measurements[asic_nr][domain_nr].hashrate);
-                cJSON_AddItemToArray(hash_domain_array, hashrate);
+                json_stream_float(&js, NULL, GLOBAL_STATE->HASHRATE_MONITOR_MODULE.domain_measurements[asic_nr][domain_nr].hashrate);
             }
-            cJSON_AddItemToObject(asic, "domains", hash_domain_array);
+            json_stream_end_array(&js);
 
-            cJSON_AddNumberToObject(asic, "errorCount", GLOBAL_STATE->HASHRATE_MONITOR_MODULE.error_measurement[asic_nr].value);
+            json_stream_number(&js, "errorCount", GLOBAL_STATE->HASHRATE_MONITOR_MODULE.error_measurement[asic_nr].value);
+            json_stream_end_object(&js);
         }
     }
+    json_stream_end_array(&js);
+    json_stream_end_object(&js);
+    json_stream_end_object(&js);
 
     free(ssid);
     free(hostname);
@@ -1025,13 +1272,167 @@ static esp_err_t GET_system_info(httpd_req_t * req)
     free(fallbackStratumUser);
     free(display);
 
-    esp_err_t res = HTTP_send_json(req, root, &system_info_prebuffer_len);
+    return HTTP_finish_json_stream(req, &js);
+}
 
-    cJSON_Delete(root);
+typedef enum
+{
+    STATS_FORMAT_ROWS,      // {"labels", "statistics": [[row], ...]}, as before
+    STATS_FORMAT_COLUMNS,   // {"labels", "columns": [[column], ...]}
+    STATS_FORMAT_BIN,       // Little-endian columns, see sendStatisticsBinary()
+} StatsFormat;
 
-    return res;
+static void streamStatistic(json_stream_t * js, const struct StatisticsData * data, DataSource source)
+{
+    if (statisticIsFloat(source)) {
+        json_stream_float(js, NULL, statisticValue(data, source));
+    } else {
+        json_stream_number(js, NULL, statisticValue(data, source));
+    }
 }
 
+static esp_err_t sendStatisticsJson(httpd_req_t * req, const struct StatisticsData * rows, const uint16_t * picks,
+                                    uint16_t count, const bool * dataSelection, StatsFormat format)
+{
+    char chunk[JSON_CHUNK_SIZE];
+    json_stream_t js;
+    json_stream_init(&js, chunk, sizeof(chunk), true, json_chunk_flush, req);
+
+    json_stream_begin_object(&js, NULL);
+    json_stream_number(&js, "currentTimestamp", (esp_timer_get_time() / 1000));
+
+    json_stream_begin_array(&js, "labels");
+    for (DataSource source = 0; source < SRC_NONE; source++) {
+        if (dataSelection[source]) {
+            json_stream_string(&js, NULL, dataSourceToStr(source));
+        }
+    }
+    json_stream_string(&js, NULL, STATS_LABEL_TIMESTAMP);
+    json_stream_end_array(&js);
+
+    if (STATS_FORMAT_COLUMNS == format) {
+        json_stream_begin_array(&js, "columns");
+        for (DataSource source = 0; source < SRC_NONE; source++) {
+            if (dataSelection[source]) {
+                json_stream_begin_array(&js, NULL);
+                for (uint16_t i = 0; i < count; i++) {
+                    streamStatistic(&js, &rows[picks[i]], source);
+                }
+                json_stream_end_array(&js);
+            }
+        }
+        json_stream_begin_array(&js, NULL);
+        for (uint16_t i = 0; i < count; i++) {
+            json_stream_number(&js, NULL, rows[picks[i]].timestamp);
+        }
+        json_stream_end_array(&js);
+        json_stream_end_array(&js);
+    } else {
+        json_stream_begin_array(&js, "statistics");
+        for (uint16_t i = 0; i < count; i++) {
+            json_stream_begin_array(&js, NULL);
+            for (DataSource source = 0; source < SRC_NONE; source++) {
+                if (dataSelection[source]) {
+                    streamStatistic(&js, &rows[picks[i]], source);
+                }
+            }
+            json_stream_number(&js, NULL, rows[picks[i]].timestamp);
+            json_stream_end_array(&js);
+        }
+        json_stream_end_array(&js);
+    }
+
+    json_stream_end_object(&js);
+    return HTTP_finish_json_stream(req, &js);
+}
+
+static esp_err_t sendBinaryBytes(httpd_req_t * req, char * chunk, size_t * len, const void * data, size_t size)
+{
+    if (*len + size > JSON_CHUNK_SIZE) {
+        esp_err_t err = httpd_resp_send_chunk(req, chunk, *len);
+        *len = 0;
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    memcpy(chunk + *len, data, size);
+    *len += size;
+    return ESP_OK;
+}
+
+/**
+ * @brief Statistics as binary columns (?format=bin)
+ *
+ * Little-endian throughout:
+ *
+ *   u32 currentTimestamp (ms), u16 rows, u8 columns, u8 version (1)
+ *   then each column in label order, rows values each:
+ *   float32 for the selected columns, u32 for the timestamps (last)
+ *
+ * The labels, in the same order as the JSON ones, are in the
+ * X-Statistics-Labels header.
+ */
+static esp_err_t sendStatisticsBinary(httpd_req_t * req, const struct StatisticsData * rows, const uint16_t * picks,
+                                      uint16_t count, const bool * dataSelection)
+{
+    char labels[256] = "";
+    uint8_t columns = 1;
+    for (DataSource source = 0; source < SRC_NONE; source++) {
+        if (dataSelection[source]) {
+            strlcat(labels, dataSourceToStr(source), sizeof(labels));
+            strlcat(labels, ",", sizeof(labels));
+            columns++;
+        }
+    }
+    strlcat(labels, STATS_LABEL_TIMESTAMP, sizeof(labels));
+
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "X-Statistics-Labels", labels);
+
+    char chunk[JSON_CHUNK_SIZE];
+    size_t len = 0;
+    esp_err_t err = ESP_OK;
+
+    // The ESP32 is little-endian: fields go out as they are in memory
+    uint32_t now = esp_timer_get_time() / 1000;
+    uint8_t version = 1;
+    err = sendBinaryBytes(req, chunk, &len, &now, sizeof(now));
+    if (ESP_OK == err) err = sendBinaryBytes(req, chunk, &len, &count, sizeof(count));
+    if (ESP_OK == err) err = sendBinaryBytes(req, chunk, &len, &columns, sizeof(columns));
+    if (ESP_OK == err) err = sendBinaryBytes(req, chunk, &len, &version, sizeof(version));
+
+    for (DataSource source = 0; source < SRC_NONE && ESP_OK == err; source++) {
+        if (dataSelection[source]) {
+            for (uint16_t i = 0; i < count && ESP_OK == err; i++) {
+                float value = statisticValue(&rows[picks[i]], source);
+                err = sendBinaryBytes(req, chunk, &len, &value, sizeof(value));
+            }
+        }
+    }
+    for (uint16_t i = 0; i < count && ESP_OK == err; i++) {
+        err = sendBinaryBytes(req, chunk, &len, &rows[picks[i]].timestamp, sizeof(rows[picks[i]].timestamp));
+    }
+
+    if (ESP_OK == err && len > 0) {
+        err = httpd_resp_send_chunk(req, chunk, len);
+    }
+    if (ESP_OK == err) {
+        err = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    return err;
+}
+
+/**
+ * @brief Chart history
+ *
+ * Query parameters:
+ *   columns     comma separated labels (default: all)
+ *   points      at most this many rows, chosen by the first selected column
+ *   downsample  lttb (default) or minmax
+ *   format      rows (default), columns or bin
+ *
+ * The buffer is copied under one lock, then written out unlocked.
+ */
 static esp_err_t GET_system_statistics(httpd_req_t * req)
 {
     if (is_network_allowed(req) != ESP_OK) {
@@ -1049,6 +1450,9 @@ static esp_err_t GET_system_statistics(httpd_req_t * req)
     size_t bufLen = httpd_req_get_url_query_len(req) + 1;
     bool dataSelection[SRC_NONE] = {false};
     bool selectionCheck = false;
+    uint16_t points = 0;
+    StatsDownsample method = STATS_DOWNSAMPLE_LTTB;
+    StatsFormat format = STATS_FORMAT_ROWS;
 
     // Check query parameters
     if (1 < bufLen) {
@@ -1066,6 +1470,19 @@ static esp_err_t GET_system_statistics(httpd_req_t * req)
                     param = strtok(NULL, ",");
                 }
             }
+
+            char value[16];
+            if (httpd_query_key_value(buf, "points", value, sizeof(value)) == ESP_OK) {
+                int requested = atoi(value);
+                points = (requested > 0 && requested < STATISTICS_MAX_DATA_COUNT) ? requested : 0;
+            }
+            if (httpd_query_key_value(buf, "downsample", value, sizeof(value)) == ESP_OK && strcmp(value, "minmax") == 0) {
+                method = STATS_DOWNSAMPLE_MINMAX;
+            }
+            if (httpd_query_key_value(buf, "format", value, sizeof(value)) == ESP_OK) {
+                if (strcmp(value, "columns") == 0) format = STATS_FORMAT_COLUMNS;
+                if (strcmp(value, "bin") == 0)     format = STATS_FORMAT_BIN;
+            }
         }
     }
 
@@ -1076,65 +1493,355 @@ static esp_err_t GET_system_statistics(httpd_req_t * req)
         }
     }
 
-    // Create object for statistics
-    cJSON * root = cJSON_CreateObject();
-    cJSON_AddNumberToObject(root, "currentTimestamp", (esp_timer_get_time() / 1000));
-
-    cJSON * labelArray = cJSON_CreateArray();
-    if (dataSelection[SRC_HASHRATE]) { cJSON_AddItemToArray(labelArray, cJSON_CreateString(STATS_LABEL_HASHRATE)); }
-    if (dataSelection[SRC_HASHRATE_1m]) { cJSON_AddItemToArray(labelArray, cJSON_CreateString(STATS_LABEL_HASHRATE_1m)); }
-    if (dataSelection[SRC_HASHRATE_10m]) { cJSON_AddItemToArray(labelArray, cJSON_CreateString(STATS_LABEL_HASHRATE_10m)); }
-    if (dataSelection[SRC_HASHRATE_1h]) { cJSON_AddItemToArray(labelArray, cJSON_CreateString(STATS_LABEL_HASHRATE_1h)); }
-    if (dataSelection[SRC_ERROR_PERCENTAGE]) { cJSON_AddItemToArray(labelArray, cJSON_CreateString(STATS_LABEL_ERROR_PERCENTAGE)); }
-    if (dataSelection[SRC_ASIC_TEMP]) { cJSON_AddItemToArray(labelArray, cJSON_CreateString(STATS_LABEL_ASIC_TEMP)); }
-    if (dataSelection[SRC_VR_TEMP]) { cJSON_AddItemToArray(labelArray, cJSON_CreateString(STATS_LABEL_VR_TEMP)); }
-    if (dataSelection[SRC_ASIC_VOLTAGE]) { cJSON_AddItemToArray(labelArray, cJSON_CreateString(STATS_LABEL_ASIC_VOLTAGE)); }
-    if (dataSelection[SRC_VOLTAGE]) { cJSON_AddItemToArray(labelArray, cJSON_CreateString(STATS_LABEL_VOLTAGE)); }
-    if (dataSelection[SRC_POWER]) { cJSON_AddItemToArray(labelArray, cJSON_CreateString(STATS_LABEL_POWER)); }
-    if (dataSelection[SRC_CURRENT]) { cJSON_AddItemToArray(labelArray, cJSON_CreateString(STATS_LABEL_CURRENT)); }
-    if (dataSelection[SRC_FAN_SPEED]) { cJSON_AddItemToArray(labelArray, cJSON_CreateString(STATS_LABEL_FAN_SPEED)); }
-    if (dataSelection[SRC_FAN_RPM]) { cJSON_AddItemToArray(labelArray, cJSON_CreateString(STATS_LABEL_FAN_RPM)); }
-    if (dataSelection[SRC_FAN2_RPM]) { cJSON_AddItemToArray(labelArray, cJSON_CreateString(STATS_LABEL_FAN2_RPM)); }
-    if (dataSelection[SRC_WIFI_RSSI]) { cJSON_AddItemToArray(labelArray, cJSON_CreateString(STATS_LABEL_WIFI_RSSI)); }
-    if (dataSelection[SRC_FREE_HEAP]) { cJSON_AddItemToArray(labelArray, cJSON_CreateString(STATS_LABEL_FREE_HEAP)); }
-    cJSON_AddItemToArray(labelArray, cJSON_CreateString(STATS_LABEL_TIMESTAMP));
-
-    cJSON_AddItemToObject(root, "labels", labelArray);
-
-    cJSON * statsArray = cJSON_AddArrayToObject(root, "statistics");
-    struct StatisticsData statsData;
-    uint16_t index = 0;
-
-    while (getStatisticData(index++, &statsData)) {
-        cJSON * valueArray = cJSON_CreateArray();
-        if (dataSelection[SRC_HASHRATE]) { cJSON_AddItemToArray(valueArray, cJSON_CreateFloat(statsData.hashrate)); }
-        if (dataSelection[SRC_HASHRATE_1m]) { cJSON_AddItemToArray(valueArray, cJSON_CreateFloat(statsData.hashrate_1m)); }
-        if (dataSelection[SRC_HASHRATE_10m]) { cJSON_AddItemToArray(valueArray, cJSON_CreateFloat(statsData.hashrate_10m)); }
-        if (dataSelection[SRC_HASHRATE_1h]) { cJSON_AddItemToArray(valueArray, cJSON_CreateFloat(statsData.hashrate_1h)); }
-        if (dataSelection[SRC_ERROR_PERCENTAGE]) { cJSON_AddItemToArray(valueArray, cJSON_CreateFloat(statsData.errorPercentage)); }
-        if (dataSelection[SRC_ASIC_TEMP]) { cJSON_AddItemToArray(valueArray, cJSON_CreateFloat(statsData.chipTemperature)); }
-        if (dataSelection[SRC_VR_TEMP]) { cJSON_AddItemToArray(valueArray, cJSON_CreateFloat(statsData.vrTemperature)); }
-        if (dataSelection[SRC_ASIC_VOLTAGE]) { cJSON_AddItemToArray(valueArray, cJSON_CreateNumber(statsData.coreVoltageActual)); }
-        if (dataSelection[SRC_VOLTAGE]) { cJSON_AddItemToArray(valueArray, cJSON_CreateFloat(statsData.voltage)); }
-        if (dataSelection[SRC_POWER]) { cJSON_AddItemToArray(valueArray, cJSON_CreateFloat(statsData.power)); }
-        if (dataSelection[SRC_CURRENT]) { cJSON_AddItemToArray(valueArray, cJSON_CreateFloat(statsData.current)); }
-        if (dataSelection[SRC_FAN_SPEED]) { cJSON_AddItemToArray(valueArray, cJSON_CreateFloat(statsData.fanSpeed)); }
-        if (dataSelection[SRC_FAN_RPM]) { cJSON_AddItemToArray(valueArray, cJSON_CreateNumber(statsData.fanRPM)); }
-        if (dataSelection[SRC_FAN2_RPM]) { cJSON_AddItemToArray(valueArray, cJSON_CreateNumber(statsData.fan2RPM)); }
-        if (dataSelection[SRC_WIFI_RSSI]) { cJSON_AddItemToArray(valueArray, cJSON_CreateNumber(statsData.wifiRSSI)); }
-        if (dataSelection[SRC_FREE_HEAP]) { cJSON_AddItemToArray(valueArray, cJSON_CreateNumber(statsData.freeHeap)); }
-        cJSON_AddItemToArray(valueArray, cJSON_CreateNumber(statsData.timestamp));
-
-        cJSON_AddItemToArray(statsArray, valueArray);
-    }
-
-    esp_err_t res = HTTP_send_json(req, root, &system_statistics_prebuffer_len);
+    // Snapshot and downsampling scratch in PSRAM, where the statistics buffer lives
+    const size_t rowsSize = sizeof(struct StatisticsData) * STATISTICS_MAX_DATA_COUNT;
+    const size_t scratchSize = rowsSize + STATISTICS_MAX_DATA_COUNT * (sizeof(uint32_t) + sizeof(float) + sizeof(uint16_t));
+    uint8_t * scratch = heap_caps_malloc(scratchSize, MALLOC_CAP_SPIRAM);
+    struct StatisticsData * rows = (struct StatisticsData *) scratch;
+    uint32_t * x = (uint32_t *) (scratch + rowsSize);
+    float * y = (float *) (x + STATISTICS_MAX_DATA_COUNT);
+    uint16_t * picks = (uint16_t *) (y + STATISTICS_MAX_DATA_COUNT);
 
-    cJSON_Delete(root);
+    uint16_t count = 0;
+    if (NULL != scratch) {
+        count = getStatisticSnapshot(rows, STATISTICS_MAX_DATA_COUNT);
+    } else {
+        ESP_LOGW(TAG, "No memory for a statistics snapshot");
+    }
+
+    if (0 < count) {
+        DataSource primary = SRC_HASHRATE;
+        while (!dataSelection[primary]) {
+            primary++;
+        }
+        for (uint16_t i = 0; i < count; i++) {
+            x[i] = rows[i].timestamp;
+            y[i] = statisticValue(&rows[i], primary);
+        }
+        count = statistics_downsample(method, x, y, count, points, picks);
+    }
+
+    esp_err_t res;
+    if (STATS_FORMAT_BIN == format) {
+        res = sendStatisticsBinary(req, rows, picks, count, dataSelection);
+    } else {
+        res = sendStatisticsJson(req, rows, picks, count, dataSelection, format);
+    }
+
+    heap_caps_free(scratch);
 
     return res;
 }
 
+// Efficiency from a mean power and hashrate, as the dashboard shows it
+static double historyEfficiency(const StatsHistoryRecord * record)
+{
+    return (record->hashrate > 0) ? record->power / (record->hashrate / 1000.0) : 0;
+}
+
+static bool streamHistoryRecord(void * ctx, const StatsHistoryRecord * record)
+{
+    json_stream_t * js = (json_stream_t *) ctx;
+
+    json_stream_begin_array(js, NULL);
+    json_stream_number(js, NULL, record->time);
+    json_stream_float(js, NULL, record->hashrate);
+    json_stream_float(js, NULL, record->hashrateMin);
+    json_stream_float(js, NULL, record->hashrateMax);
+    json_stream_float(js, NULL, record->power);
+    json_stream_float(js, NULL, historyEfficiency(record));
+    json_stream_float(js, NULL, record->chipTemperature);
+    json_stream_float(js, NULL, record->errorPercentage);
+    json_stream_number(js, NULL, record->samples);
+    json_stream_end_array(js);
+
+    // Stop reading flash once the client is gone
+    return ESP_OK == js->err;
+}
+
+/**
+ * @brief Long-term statistics from the flash history
+ *
+ * Query parameters:
+ *   from, to    Unix seconds, default the last 24 hours
+ *   resolution  auto (default), 5s, 1m, 15m or 1h
+ *   points      Most rows for auto, default 1000
+ *
+ * Rows are read from flash a few at a time and streamed as they come.
+ */
+static esp_err_t GET_system_statistics_history(httpd_req_t * req)
+{
+    if (is_network_allowed(req) != ESP_OK) {
+        return httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Unauthorized");
+    }
+
+    // Set CORS headers
+    if (set_cors_headers(req) != ESP_OK) {
+        httpd_resp_send_500(req);
+        return ESP_OK;
+    }
+
+    uint32_t to = (uint32_t) time(NULL);
+    uint32_t from = (to > 86400) ? to - 86400 : 0;
+    uint32_t points = 1000;
+    int level = -1;
+
+    size_t bufLen = httpd_req_get_url_query_len(req) + 1;
+    if (1 < bufLen) {
+        char buf[bufLen];
+        if (httpd_req_get_url_query_str(req, buf, bufLen) == ESP_OK) {
+            char value[16];
+            if (httpd_query_key_value(buf, "from", value, sizeof(value)) == ESP_OK) {
+                from = strtoul(value, NULL, 10);
+            }
+            if (httpd_query_key_value(buf, "to", value, sizeof(value)) == ESP_OK) {
+                to = strtoul(value, NULL, 10);
+            }
+            if (httpd_query_key_value(buf, "points", value, sizeof(value)) == ESP_OK && atoi(value) > 0) {
+                points = atoi(value);
+            }
+            if (httpd_query_key_value(buf, "resolution", value, sizeof(value)) == ESP_OK) {
+                if (strcmp(value, "5s") == 0)  level = STATS_HISTORY_RAW;
+                if (strcmp(value, "1m") == 0)  level = STATS_HISTORY_1M;
+                if (strcmp(value, "15m") == 0) level = STATS_HISTORY_15M;
+                if (strcmp(value, "1h") == 0)  level = STATS_HISTORY_1H;
+            }
+        }
+    }
+
+    if (from > to) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "from is after to");
+    }
+    if (level < 0) {
+        level = pickStatisticHistoryLevel(from, to, points);
+    }
+
+    httpd_resp_set_type(req, "application/json");
+
+    char chunk[JSON_CHUNK_SIZE];
+    json_stream_t js;
+    json_stream_init(&js, chunk, sizeof(chunk), true, json_chunk_flush, req);
+
+    json_stream_begin_object(&js, NULL);
+    json_stream_number(&js, "resolution", statistics_history_period(level));
+    json_stream_number(&js, "from", from);
+    json_stream_number(&js, "to", to);
+    json_stream_begin_array(&js, "labels");
+    json_stream_string(&js, NULL, "time");
+    json_stream_string(&js, NULL, "hashrate");
+    json_stream_string(&js, NULL, "hashrateMin");
+    json_stream_string(&js, NULL, "hashrateMax");
+    json_stream_string(&js, NULL, "power");
+    json_stream_string(&js, NULL, "efficiency");
+    json_stream_string(&js, NULL, "asicTemp");
+    json_stream_string(&js, NULL, "errorPercentage");
+    json_stream_string(&js, NULL, "samples");
+    json_stream_end_array(&js);
+    json_stream_begin_array(&js, "statistics");
+
+    esp_err_t err = getStatisticHistory(level, from, to, streamHistoryRecord, &js);
+    if (ESP_OK != err && ESP_ERR_NOT_FOUND != err) {
+        ESP_LOGW(TAG, "Statistics history query failed: %s", esp_err_to_name(err));
+    }
+
+    json_stream_end_array(&js);
+    json_stream_bool(&js, "available", ESP_ERR_NOT_FOUND != err);
+    json_stream_end_object(&js);
+
+    return HTTP_finish_json_stream(req, &js);
+}
+
+// Log lines more severe than or as severe as the level asked for; untagged lines always pass
+static bool log_level_passes(uint8_t level, uint8_t wanted)
+{
+    static const char order[] = "EWIDV";
+    if (level == 0 || wanted == 0) {
+        return true;
+    }
+    const char * l = strchr(order, level);
+    const char * w = strchr(order, wanted);
+    return l == NULL || w == NULL || l <= w;
+}
+
+static esp_err_t GET_system_logs(httpd_req_t * req)
+{
+    if (is_network_allowed(req) != ESP_OK) {
+        return httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Unauthorized");
+    }
+
+    // Set CORS headers
+    if (set_cors_headers(req) != ESP_OK) {
+        httpd_resp_send_500(req);
+        return ESP_OK;
+    }
+
+    const log_ring_t * ring = log_task_ring();
+    if (ring == NULL) {
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Logs are not kept on this device");
+    }
+
+    uint8_t wanted = 0;
+    uint32_t lines = 0;
+    size_t bufLen = httpd_req_get_url_query_len(req) + 1;
+    if (1 < bufLen) {
+        char buf[bufLen];
+        if (httpd_req_get_url_query_str(req, buf, bufLen) == ESP_OK) {
+            char value[16];
+            if (httpd_query_key_value(buf, "level", value, sizeof(value)) == ESP_OK) {
+                wanted = (uint8_t) toupper((unsigned char) value[0]);
+            }
+            if (httpd_query_key_value(buf, "lines", value, sizeof(value)) == ESP_OK && atoi(value) > 0) {
+                lines = atoi(value);
+            }
+        }
+    }
+
+    // Up to the lines logged before the request, so a busy log cannot keep it going
+    uint32_t end = log_ring_head(ring);
+    uint32_t cursor = log_ring_oldest(ring);
+    if (lines > 0 && end - cursor > lines) {
+        cursor = end - lines;
+    }
+
+    httpd_resp_set_type(req, "text/plain");
+
+    char chunk[4 * LOG_RING_LINE_SIZE];
+    size_t len = 0;
+    uint32_t lost = 0;
+    log_record_t record;
+    esp_err_t err = ESP_OK;
+    while (err == ESP_OK && (int32_t) (end - cursor) > 0 && log_ring_read(ring, &cursor, &record, &lost)) {
+        if (!log_level_passes(record.level, wanted)) {
+            continue;
+        }
+        if (sizeof(chunk) - len < LOG_RING_LINE_SIZE) {
+            err = httpd_resp_send_chunk(req, chunk, len);
+            len = 0;
+        }
+        len += log_ring_format(&record, chunk + len, sizeof(chunk) - len);
+    }
+    if (err == ESP_OK && len > 0) {
+        err = httpd_resp_send_chunk(req, chunk, len);
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+/**
+ * @brief When each startup phase ran, and the milestones up to the first share
+ */
+static esp_err_t GET_system_boot(httpd_req_t * req)
+{
+    if (is_network_allowed(req) != ESP_OK) {
+        return httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Unauthorized");
+    }
+
+    httpd_resp_set_type(req, "application/json");
+
+    if (set_cors_headers(req) != ESP_OK) {
+        httpd_resp_send_500(req);
+        return ESP_OK;
+    }
+
+    const boot_timeline_t * timeline = &GLOBAL_STATE->BOOT_TIMELINE;
+    uint32_t count = boot_timeline_count(timeline);
+
+    char chunk[JSON_CHUNK_SIZE];
+    json_stream_t js;
+    json_stream_init(&js, chunk, sizeof(chunk), true, json_chunk_flush, req);
+    json_stream_begin_object(&js, NULL);
+
+    json_stream_begin_array(&js, "phases");
+    for (uint32_t i = 0; i < count; i++) {
+        const boot_phase_t * phase = &timeline->phases[i];
+        if (phase->name == NULL || phase->milestone) {
+            continue;
+        }
+        json_stream_begin_object(&js, NULL);
+        json_stream_string(&js, "name", phase->name);
+        json_stream_number(&js, "startMs", phase->start_us / 1000);
+        if (phase->end_us == 0) {
+            json_stream_null(&js, "durationMs");
+        } else {
+            json_stream_number(&js, "durationMs", (phase->end_us - phase->start_us) / 1000);
+        }
+        json_stream_end_object(&js);
+    }
+    json_stream_end_array(&js);
+
+    json_stream_begin_array(&js, "milestones");
+    for (uint32_t i = 0; i < count; i++) {
+        const boot_phase_t * phase = &timeline->phases[i];
+        if (phase->name == NULL || !phase->milestone) {
+            continue;
+        }
+        json_stream_begin_object(&js, NULL);
+        json_stream_string(&js, "name", phase->name);
+        json_stream_number(&js, "atMs", phase->start_us / 1000);
+        json_stream_end_object(&js);
+    }
+    json_stream_end_array(&js);
+
+    boot_timeline_summary_t summary;
+    boot_timeline_summarize(timeline, &summary);
+    json_stream_number(&js, "elapsedMs", summary.elapsed_us / 1000);
+    json_stream_number(&js, "serialMs", summary.serial_us / 1000);
+    json_stream_number(&js, "running", summary.running);
+
+    json_stream_end_object(&js);
+    return HTTP_finish_json_stream(req, &js);
+}
+
+// Values read at scrape time rather than kept in a variable
+static void collect_system_metrics(metrics_writer_t * w, void * ctx)
+{
+    metrics_write_family(w, "bitaxe_uptime_seconds", METRICS_COUNTER, "Seconds since boot");
+    metrics_write_sample(w, "bitaxe_uptime_seconds", NULL,
+                         (esp_timer_get_time() - GLOBAL_STATE->SYSTEM_MODULE.start_time) / 1000000);
+
+    metrics_write_family(w, "bitaxe_free_heap_bytes", METRICS_GAUGE, "Free heap");
+    metrics_write_sample(w, "bitaxe_free_heap_bytes", "memory=\"internal\"", heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+    metrics_write_sample(w, "bitaxe_free_heap_bytes", "memory=\"spiram\"", heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+
+    int8_t wifi_rssi = -90;
+    if (get_wifi_current_rssi(&wifi_rssi) == ESP_OK) {
+        metrics_write_family(w, "bitaxe_wifi_rssi_dbm", METRICS_GAUGE, "WiFi signal strength");
+        metrics_write_sample(w, "bitaxe_wifi_rssi_dbm", NULL, wifi_rssi);
+    }
+
+    char version[32], asic[32], board[32];
+    metrics_escape_label(version, sizeof(version), esp_app_get_description()->version);
+    metrics_escape_label(asic, sizeof(asic), GLOBAL_STATE->DEVICE_CONFIG.family.asic.name);
+    metrics_escape_label(board, sizeof(board), GLOBAL_STATE->DEVICE_CONFIG.board_version);
+    char labels[128];
+    snprintf(labels, sizeof(labels), "version=\"%s\",asic=\"%s\",board=\"%s\"", version, asic, board);
+    metrics_write_family(w, "bitaxe_info", METRICS_GAUGE, "Firmware and hardware, as labels");
+    metrics_write_sample(w, "bitaxe_info", labels, 1);
+}
+
+/**
+ * @brief Prometheus scrape of everything registered with metrics.h
+ */
+static esp_err_t GET_metrics(httpd_req_t * req)
+{
+    if (is_network_allowed(req) != ESP_OK) {
+        return httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Unauthorized");
+    }
+
+    httpd_resp_set_type(req, METRICS_CONTENT_TYPE);
+
+    char chunk[JSON_CHUNK_SIZE];
+    metrics_writer_t w;
+    metrics_writer_init(&w, chunk, sizeof(chunk), json_chunk_flush, req);
+    esp_err_t err = metrics_render(&w);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
 esp_err_t POST_WWW_update(httpd_req_t * req)
 {
     if (is_network_allowed(req) != ESP_OK) {
@@ -1198,7 +1905,11 @@ esp_err_t POST_WWW_update(httpd_req_t * req)
 
     httpd_resp_sendstr(req, "WWW update complete\n");
 
+    // The new partition has its own manifest, ETags and bundle names; the
+    // server task is busy here, so no request sees the swap half done
     readAxeOSVersion();
+    unload_web_assets();
+    load_web_assets();
 
     snprintf(GLOBAL_STATE->SYSTEM_MODULE.firmware_update_status, 20, "Finished...");
     vTaskDelay(1000 / portTICK_PERIOD_MS);
@@ -1304,11 +2015,15 @@ static esp_err_t GET_cluster_status(httpd_req_t *req)
         return ESP_OK;
     }
 
-    cJSON *root = cJSON_CreateObject();
+    char chunk[JSON_CHUNK_SIZE];
+    json_stream_t js;
+    json_stream_init(&js, chunk, sizeof(chunk), true, json_chunk_flush, req);
+
+    json_stream_begin_object(&js, NULL);
 
     // Basic cluster info
-    cJSON_AddBoolToObject(root, "enabled", cluster_is_active());
-    cJSON_AddNumberToObject(root, "mode", cluster_get_mode());
+    json_stream_bool(&js, "enabled", cluster_is_active());
+    json_stream_number(&js, "mode", cluster_get_mode());
 
     const char *mode_str = "disabled";
     cluster_mode_t mode = cluster_get_mode();
@@ -1317,7 +2032,7 @@ static esp_err_t GET_cluster_status(httpd_req_t *req)
     } else if (mode == CLUSTER_MODE_SLAVE) {
         mode_str = "slave";
     }
-    cJSON_AddStringToObject(root, "modeString", mode_str);
+    json_stream_string(&js, "modeString", mode_str);
 
 #if CLUSTER_IS_MASTER
     // Master-specific info
@@ -1325,17 +2040,20 @@ static esp_err_t GET_cluster_status(httpd_req_t *req)
     uint8_t active_slaves = 0;
     cluster_master_get_stats(&stats, &active_slaves);
 
-    cJSON_AddNumberToObject(root, "activeSlaves", active_slaves);
-    cJSON_AddNumberToObject(root, "totalHashrate", stats.total_hashrate);
-    cJSON_AddNumberToObject(root, "totalShares", stats.total_shares);
-    cJSON_AddNumberToObject(root, "totalSharesAccepted", stats.total_shares_accepted);
-    cJSON_AddNumberToObject(root, "totalSharesRejected", stats.total_shares_rejected);
+    json_stream_number(&js, "activeSlaves", active_slaves);
+    json_stream_number(&js, "totalHashrate", stats.total_hashrate);
+    json_stream_number(&js, "totalShares", stats.total_shares);
+    json_stream_number(&js, "totalSharesAccepted", stats.total_shares_accepted);
+    json_stream_number(&js, "totalSharesRejected", stats.total_shares_rejected);
+    // Master-side verification (CONFIG_CLUSTER_SHARE_VERIFY)
+    json_stream_number(&js, "totalSharesInvalid", stats.total_shares_invalid);
+    json_stream_number(&js, "totalSharesUnverified", stats.total_shares_unverified);
 
     // Per-pool stats for dual pool mode
-    cJSON_AddNumberToObject(root, "primarySharesAccepted", stats.primary_shares_accepted);
-    cJSON_AddNumberToObject(root, "primarySharesRejected", stats.primary_shares_rejected);
-    cJSON_AddNumberToObject(root, "secondarySharesAccepted", stats.secondary_shares_accepted);
-    cJSON_AddNumberToObject(root, "secondarySharesRejected", stats.secondary_shares_rejected);
+    json_stream_number(&js, "primarySharesAccepted", stats.primary_shares_accepted);
+    json_stream_number(&js, "primarySharesRejected", stats.primary_shares_rejected);
+    json_stream_number(&js, "secondarySharesAccepted", stats.secondary_shares_accepted);
+    json_stream_number(&js, "secondarySharesRejected", stats.secondary_shares_rejected);
 
     // Calculate total power (master + all slaves)
     float master_power = GLOBAL_STATE->POWER_MANAGEMENT_MODULE.power;
@@ -1346,199 +2064,335 @@ static esp_err_t GET_cluster_status(httpd_req_t *req)
             total_power += slave_info.power;
         }
     }
-    cJSON_AddFloatToObject(root, "totalPower", total_power);
+    json_stream_float(&js, "totalPower", total_power);
 
     // Calculate total efficiency (J/TH) = total power / total hashrate in TH/s
     // totalHashrate is in GH/s * 100, so divide by 100000 to get TH/s
     float total_hashrate_th = (float)stats.total_hashrate / 100000.0f;
     float total_efficiency = (total_hashrate_th > 0) ? (total_power / total_hashrate_th) : 0;
-    cJSON_AddFloatToObject(root, "totalEfficiency", total_efficiency);
+    json_stream_float(&js, "totalEfficiency", total_efficiency);
 
-    // Transport info for ESP-NOW
-#if defined(CONFIG_CLUSTER_TRANSPORT_ESPNOW) || defined(CONFIG_CLUSTER_TRANSPORT_BOTH)
-    cJSON *transport = cJSON_CreateObject();
-    if (transport) {
-        cJSON_AddStringToObject(transport, "type", "espnow");
+    // Transport info
+    cluster_transport_info_t tinfo;
+    cluster_transport_get_info(&tinfo);
+
+    json_stream_begin_object(&js, "transport");
+    json_stream_string(&js, "type", cluster_transport_type_name(tinfo.type));
 #ifdef CONFIG_CLUSTER_ESPNOW_CHANNEL
-        cJSON_AddNumberToObject(transport, "channel", CONFIG_CLUSTER_ESPNOW_CHANNEL);
+    json_stream_number(&js, "channel", CONFIG_CLUSTER_ESPNOW_CHANNEL);
 #else
-        cJSON_AddNumberToObject(transport, "channel", 1);
+    json_stream_number(&js, "channel", 1);
 #endif
-        cJSON_AddBoolToObject(transport, "encrypted", false);
-        // Safely check if ESP-NOW is initialized
-        bool espnow_ready = false;
-        if (cluster_is_active()) {
-            espnow_ready = cluster_espnow_is_initialized();
+    json_stream_bool(&js, "encrypted", false);
+    json_stream_bool(&js, "discoveryActive", tinfo.discovery_active);
+    json_stream_number(&js, "peerCount", active_slaves);
+
+    // Every backend the master is listening on
+    json_stream_begin_array(&js, "active");
+    for (int t = CLUSTER_TRANSPORT_BAP; t < CLUSTER_TRANSPORT_COUNT; t++) {
+        if (tinfo.active_mask & (1u << t)) {
+            json_stream_string(&js, NULL, cluster_transport_type_name((cluster_transport_type_t)t));
         }
-        cJSON_AddBoolToObject(transport, "discoveryActive", espnow_ready);
-        cJSON_AddNumberToObject(transport, "peerCount", active_slaves);
-        cJSON_AddItemToObject(root, "transport", transport);
     }
-#endif
+    json_stream_end_array(&js);
+    json_stream_end_object(&js);
 
     // Current device time (ms since boot) for calculating "last seen" on frontend
-    cJSON_AddNumberToObject(root, "currentTime", esp_timer_get_time() / 1000);
+    json_stream_number(&js, "currentTime", esp_timer_get_time() / 1000);
 
     // Slave list
-    cJSON *slaves = cJSON_CreateArray();
+    json_stream_begin_array(&js, "slaves");
     for (int i = 0; i < CONFIG_CLUSTER_MAX_SLAVES; i++) {
         cluster_slave_t slave_info;
         if (cluster_master_get_slave_info(i, &slave_info) == ESP_OK && slave_info.state != SLAVE_STATE_DISCONNECTED) {
-            cJSON *slave = cJSON_CreateObject();
-            cJSON_AddNumberToObject(slave, "slot", i);
-            cJSON_AddNumberToObject(slave, "slaveId", slave_info.slave_id);
-            cJSON_AddStringToObject(slave, "hostname", slave_info.hostname);
-            cJSON_AddStringToObject(slave, "ipAddr", slave_info.ip_addr);
-            cJSON_AddNumberToObject(slave, "state", slave_info.state);
-            cJSON_AddNumberToObject(slave, "hashrate", slave_info.hashrate);
-            cJSON_AddFloatToObject(slave, "temperature", slave_info.temperature);
-            cJSON_AddNumberToObject(slave, "fanRpm", slave_info.fan_rpm);
-            cJSON_AddNumberToObject(slave, "sharesSubmitted", slave_info.shares_submitted);
-            cJSON_AddNumberToObject(slave, "sharesAccepted", slave_info.shares_accepted);
-            cJSON_AddNumberToObject(slave, "lastSeen", slave_info.last_seen);
+            json_stream_begin_object(&js, NULL);
+            json_stream_number(&js, "slot", i);
+            json_stream_number(&js, "slaveId", slave_info.slave_id);
+            json_stream_string(&js, "hostname", slave_info.hostname);
+            json_stream_string(&js, "ipAddr", slave_info.ip_addr);
+            json_stream_number(&js, "state", slave_info.state);
+            json_stream_number(&js, "hashrate", slave_info.hashrate);
+            json_stream_float(&js, "temperature", slave_info.temperature);
+            json_stream_number(&js, "fanRpm", slave_info.fan_rpm);
+            json_stream_number(&js, "sharesSubmitted", slave_info.shares_submitted);
+            json_stream_number(&js, "sharesAccepted", slave_info.shares_accepted);
+            json_stream_number(&js, "sharesInvalid", slave_info.shares_invalid);
+            // Percentage of the shares received from this slave that failed verification
+            json_stream_float(&js, "invalidRate", slave_info.shares_submitted > 0 ?
+                100.0f * slave_info.shares_invalid / slave_info.shares_submitted : 0.0f);
+            json_stream_number(&js, "lastSeen", slave_info.last_seen);
             // Extended stats
-            cJSON_AddNumberToObject(slave, "frequency", slave_info.frequency);
-            cJSON_AddNumberToObject(slave, "coreVoltage", slave_info.core_voltage);
-            cJSON_AddFloatToObject(slave, "power", slave_info.power);
-            cJSON_AddFloatToObject(slave, "voltageIn", slave_info.voltage_in);
-            cJSON_AddItemToArray(slaves, slave);
+            json_stream_number(&js, "frequency", slave_info.frequency);
+            json_stream_number(&js, "coreVoltage", slave_info.core_voltage);
+            json_stream_float(&js, "power", slave_info.power);
+            json_stream_float(&js, "voltageIn", slave_info.voltage_in);
+            // Relays: slaves behind this slot (stats above are the group totals)
+            json_stream_number(&js, "downstream", slave_info.downstream_count);
+            // Binary telemetry only
+            json_stream_bool(&js, "telemetry", slave_info.telemetry);
+            if (slave_info.telemetry) {
+                json_stream_float(&js, "temperature2", slave_info.chip_temp2);
+                json_stream_float(&js, "vrTemp", slave_info.vr_temp);
+                json_stream_number(&js, "fan2Rpm", slave_info.fan2_rpm);
+                json_stream_float(&js, "errorPercentage", slave_info.error_percent);
+                json_stream_number(&js, "asicQueue", slave_info.asic_queue);
+                json_stream_number(&js, "shareQueue", slave_info.share_queue);
+                json_stream_begin_array(&js, "asics");
+                for (int a = 0; a < slave_info.asic_count; a++) {
+                    json_stream_begin_object(&js, NULL);
+                    json_stream_float(&js, "hashrate", slave_info.asic_hashrate[a]);
+                    json_stream_float(&js, "errorPercentage", slave_info.asic_error[a]);
+                    json_stream_end_object(&js);
+                }
+                json_stream_end_array(&js);
+            }
+            // Slave clock against ours, for lining up timestamps across nodes
+            json_stream_begin_object(&js, "clock");
+            json_stream_bool(&js, "synced", slave_info.clock_synced);
+            json_stream_number(&js, "offsetUs", (double)slave_info.clock_offset_us);
+            json_stream_float(&js, "driftPpm", slave_info.clock_drift_ppb / 1000.0f);
+            json_stream_number(&js, "delayUs", slave_info.clock_delay_us);
+            json_stream_end_object(&js);
+            json_stream_end_object(&js);
         }
     }
-    cJSON_AddItemToObject(root, "slaves", slaves);
+    json_stream_end_array(&js);
 
 #elif CLUSTER_IS_SLAVE
     // Slave-specific info
-    cJSON_AddBoolToObject(root, "connectedToMaster", cluster_is_active());
-    cJSON_AddNumberToObject(root, "localHashrate", cluster_get_asic_hashrate());
-    cJSON_AddFloatToObject(root, "localTemperature", cluster_get_chip_temp());
-    cJSON_AddNumberToObject(root, "localFanRpm", cluster_get_fan_rpm());
-    cJSON_AddStringToObject(root, "hostname", cluster_get_hostname());
+    json_stream_bool(&js, "connectedToMaster", cluster_is_active());
+    json_stream_number(&js, "localHashrate", cluster_get_asic_hashrate());
+    json_stream_float(&js, "localTemperature", cluster_get_chip_temp());
+    json_stream_number(&js, "localFanRpm", cluster_get_fan_rpm());
+    json_stream_string(&js, "hostname", cluster_get_hostname());
 
     // Slave share statistics
     uint32_t shares_found = 0, shares_submitted = 0;
     cluster_slave_get_shares(&shares_found, &shares_submitted);
-    cJSON_AddNumberToObject(root, "sharesFound", shares_found);
-    cJSON_AddNumberToObject(root, "sharesSubmitted", shares_submitted);
+    json_stream_number(&js, "sharesFound", shares_found);
+    json_stream_number(&js, "sharesSubmitted", shares_submitted);
 
     // Master's pool info from current work (for slave UI display)
     cluster_work_t work;
     esp_err_t work_err = cluster_slave_get_work(&work);
-    cJSON_AddBoolToObject(root, "hasWork", work_err == ESP_OK);
+    json_stream_bool(&js, "hasWork", work_err == ESP_OK);
     if (work_err == ESP_OK && work.pool_diff > 0) {
-        cJSON_AddNumberToObject(root, "masterPoolDiff", work.pool_diff);
+        json_stream_number(&js, "masterPoolDiff", work.pool_diff);
+    }
+
+#if CLUSTER_IS_RELAY
+    // Downstream slaves coordinated by this relay
+    json_stream_bool(&js, "relay", true);
+    json_stream_begin_array(&js, "downstream");
+    for (int i = 0; i < CLUSTER_RELAY_MAX_CHILDREN; i++) {
+        cluster_relay_child_t child;
+        if (cluster_relay_get_child(i, &child) == ESP_OK) {
+            json_stream_begin_object(&js, NULL);
+            json_stream_number(&js, "nodeAddr", child.node_addr);
+            json_stream_string(&js, "hostname", child.hostname);
+            json_stream_number(&js, "hashrate", child.hashrate);
+            json_stream_float(&js, "temperature", child.temperature);
+            json_stream_number(&js, "sharesForwarded", child.shares_forwarded);
+            json_stream_number(&js, "lastSeen", child.last_seen);
+            json_stream_end_object(&js);
+        }
     }
+    json_stream_end_array(&js);
+#endif
 #endif
 
-    esp_err_t res = HTTP_send_json(req, root, &cluster_prebuffer_len);
-    cJSON_Delete(root);
-
-    return res;
+    json_stream_end_object(&js);
+    return HTTP_finish_json_stream(req, &js);
 }
 
-#if CLUSTER_IS_MASTER
-
-// HTTP response buffer for proxy requests
-static char *http_proxy_response = NULL;
-static int http_proxy_response_len = 0;
+#define TRACE_DEFAULT_JOBS  8
+#define TRACE_MAX_JOBS      32
 
-static esp_err_t http_proxy_event_handler(esp_http_client_event_t *evt)
+/**
+ * @brief Write one trace event; t is relative to the start of its job
+ */
+static void stream_trace_event(json_stream_t *js, const cluster_trace_record_t *rec, int64_t start_us)
 {
-    switch (evt->event_id) {
-        case HTTP_EVENT_ON_DATA:
-            // Handle both chunked and non-chunked responses
-            if (evt->data_len > 0) {
-                if (http_proxy_response == NULL) {
-                    http_proxy_response = malloc(evt->data_len + 1);
-                    http_proxy_response_len = 0;
-                } else {
-                    char *new_buf = realloc(http_proxy_response, http_proxy_response_len + evt->data_len + 1);
-                    if (new_buf) {
-                        http_proxy_response = new_buf;
-                    } else {
-                        ESP_LOGE(TAG, "Failed to realloc response buffer");
-                        return ESP_FAIL;
-                    }
-                }
-                if (http_proxy_response) {
-                    memcpy(http_proxy_response + http_proxy_response_len, evt->data, evt->data_len);
-                    http_proxy_response_len += evt->data_len;
-                    http_proxy_response[http_proxy_response_len] = '\0';
-                }
-            }
-            break;
-        default:
-            break;
+    json_stream_begin_object(js, NULL);
+    json_stream_string(js, "stage", cluster_trace_stage_name(rec->stage));
+    json_stream_number(js, "tUs", (double)(rec->ts_us - start_us));
+    if (rec->node != CLUSTER_TRACE_NODE_MASTER) {
+        json_stream_number(js, "node", rec->node);
     }
-    return ESP_OK;
+    if (rec->flags & CLUSTER_TRACE_F_UNSYNCED) {
+        json_stream_bool(js, "unsynced", true);
+    }
+    json_stream_end_object(js);
 }
 
-/**
- * @brief Proxy an HTTP request to a slave device
- * @param slave_ip IP address of the slave
- * @param path API path (e.g., "/api/cluster/autotune/status")
- * @param method HTTP method (HTTP_METHOD_GET or HTTP_METHOD_POST)
- * @param post_data POST data (NULL for GET requests)
- * @param response Output buffer for response (caller must free)
- * @return ESP_OK on success
- */
-static esp_err_t http_proxy_to_slave(const char *slave_ip, const char *path,
-                                      esp_http_client_method_t method,
-                                      const char *post_data, char **response)
+/* Handler for job/share traces: /api/cluster/trace[?job=<hex>][&limit=<jobs>] */
+static esp_err_t GET_cluster_trace(httpd_req_t *req)
 {
-    char url[128];
-    snprintf(url, sizeof(url), "http://%s%s", slave_ip, path);
+    if (is_network_allowed(req) != ESP_OK) {
+        return httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Unauthorized");
+    }
 
-    ESP_LOGI(TAG, "Proxying request to slave: %s", url);
+    httpd_resp_set_type(req, "application/json");
 
-    // Reset response buffer
-    if (http_proxy_response) {
-        free(http_proxy_response);
-        http_proxy_response = NULL;
+    if (set_cors_headers(req) != ESP_OK) {
+        httpd_resp_send_500(req);
+        return ESP_OK;
     }
-    http_proxy_response_len = 0;
 
-    esp_http_client_config_t config = {
-        .url = url,
-        .method = method,
-        .timeout_ms = 5000,
-        .event_handler = http_proxy_event_handler,
-        .buffer_size = 2048,
-        .buffer_size_tx = 1024,
-    };
+    // Optional filters
+    bool job_filter = false;
+    uint32_t job_wanted = 0;
+    int job_limit = TRACE_DEFAULT_JOBS;
+    char query[64];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        char value[16];
+        if (httpd_query_key_value(query, "job", value, sizeof(value)) == ESP_OK) {
+            job_wanted = strtoul(value, NULL, 16);
+            job_filter = true;
+        }
+        if (httpd_query_key_value(query, "limit", value, sizeof(value)) == ESP_OK) {
+            job_limit = atoi(value);
+            if (job_limit < 1) job_limit = 1;
+            if (job_limit > TRACE_MAX_JOBS) job_limit = TRACE_MAX_JOBS;
+        }
+    }
 
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (!client) {
-        ESP_LOGE(TAG, "Failed to init HTTP client");
-        return ESP_FAIL;
+    char chunk[JSON_CHUNK_SIZE];
+    json_stream_t js;
+    json_stream_init(&js, chunk, sizeof(chunk), true, json_chunk_flush, req);
+    json_stream_begin_object(&js, NULL);
+    json_stream_bool(&js, "enabled", CLUSTER_TRACE_SIZE > 0);
+    json_stream_number(&js, "size", CLUSTER_TRACE_SIZE);
+    json_stream_number(&js, "recorded", cluster_trace_count());
+    json_stream_number(&js, "uploadLost", cluster_trace_lost());
+    json_stream_number(&js, "currentTimestamp", esp_timer_get_time() / 1000);
+
+    size_t count = 0;
+    cluster_trace_record_t *recs = NULL;
+    if (CLUSTER_TRACE_SIZE > 0) {
+        recs = malloc(CLUSTER_TRACE_SIZE * sizeof(cluster_trace_record_t));
+        if (recs) {
+            uint32_t cursor = 0;
+            count = cluster_trace_read(&cursor, recs, CLUSTER_TRACE_SIZE, NULL);
+        }
+    }
+    json_stream_number(&js, "records", count);
+
+    // Stage-to-stage latencies over everything in the ring
+    cluster_trace_span_t spans[CLUSTER_TRACE_SPAN_COUNT];
+    cluster_trace_summarize(recs, count, spans);
+    json_stream_begin_array(&js, "latency");
+    for (int i = 0; i < CLUSTER_TRACE_SPAN_COUNT; i++) {
+        json_stream_begin_object(&js, NULL);
+        json_stream_string(&js, "name", spans[i].name);
+        json_stream_string(&js, "from", cluster_trace_stage_name(spans[i].from));
+        json_stream_string(&js, "to", cluster_trace_stage_name(spans[i].to));
+        json_stream_number(&js, "count", spans[i].count);
+        if (spans[i].count > 0) {
+            json_stream_number(&js, "p50Us", spans[i].p50_us);
+            json_stream_number(&js, "p90Us", spans[i].p90_us);
+            json_stream_number(&js, "maxUs", spans[i].max_us);
+        }
+        json_stream_end_object(&js);
     }
+    json_stream_end_array(&js);
 
-    if ((method == HTTP_METHOD_POST || method == HTTP_METHOD_PATCH) && post_data) {
-        esp_http_client_set_header(client, "Content-Type", "application/json");
-        esp_http_client_set_post_field(client, post_data, strlen(post_data));
+    // Most recently active jobs first
+    uint32_t job_ids[TRACE_MAX_JOBS];
+    int job_count = 0;
+    for (size_t i = count; i-- > 0 && job_count < job_limit;) {
+        uint32_t id = recs[i].job_id;
+        if (job_filter && id != job_wanted) {
+            continue;
+        }
+        bool seen = false;
+        for (int j = 0; j < job_count && !seen; j++) {
+            seen = job_ids[j] == id;
+        }
+        if (!seen) {
+            job_ids[job_count++] = id;
+        }
     }
 
-    esp_err_t err = esp_http_client_perform(client);
+    json_stream_begin_array(&js, "jobs");
+    uint16_t *order = count ? malloc(count * sizeof(uint16_t)) : NULL;
+    for (int j = 0; j < job_count && order; j++) {
+        // This job's records by time (slave uploads arrive late)
+        size_t n = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (recs[i].job_id != job_ids[j]) {
+                continue;
+            }
+            size_t k = n++;
+            while (k > 0 && recs[order[k - 1]].ts_us > recs[i].ts_us) {
+                order[k] = order[k - 1];
+                k--;
+            }
+            order[k] = (uint16_t)i;
+        }
 
-    if (err == ESP_OK) {
-        int status = esp_http_client_get_status_code(client);
-        ESP_LOGI(TAG, "Slave response: status=%d, len=%d", status, http_proxy_response_len);
+        int64_t start_us = recs[order[0]].ts_us;
+        char id_str[9];
+        snprintf(id_str, sizeof(id_str), "%08lx", (unsigned long)job_ids[j]);
+
+        json_stream_begin_object(&js, NULL);
+        json_stream_string(&js, "jobId", id_str);
+        json_stream_number(&js, "startMs", (double)(start_us / 1000));
 
-        if (response && http_proxy_response) {
-            *response = http_proxy_response;
-            http_proxy_response = NULL;  // Transfer ownership
+        json_stream_begin_array(&js, "events");
+        for (size_t k = 0; k < n; k++) {
+            const cluster_trace_record_t *rec = &recs[order[k]];
+            if (!cluster_trace_is_share_stage(rec->stage)) {
+                stream_trace_event(&js, rec, start_us);
+            }
         }
-    } else {
-        ESP_LOGE(TAG, "HTTP request failed: %s", esp_err_to_name(err));
-        if (http_proxy_response) {
-            free(http_proxy_response);
-            http_proxy_response = NULL;
+        json_stream_end_array(&js);
+
+        // Share events grouped by nonce, in order of first appearance
+        json_stream_begin_array(&js, "shares");
+        for (size_t k = 0; k < n; k++) {
+            const cluster_trace_record_t *rec = &recs[order[k]];
+            if (!cluster_trace_is_share_stage(rec->stage)) {
+                continue;
+            }
+            bool seen = false;
+            for (size_t e = 0; e < k && !seen; e++) {
+                const cluster_trace_record_t *earlier = &recs[order[e]];
+                seen = cluster_trace_is_share_stage(earlier->stage) && earlier->aux == rec->aux;
+            }
+            if (seen) {
+                continue;
+            }
+
+            char nonce_str[9];
+            snprintf(nonce_str, sizeof(nonce_str), "%08lx", (unsigned long)rec->aux);
+            json_stream_begin_object(&js, NULL);
+            json_stream_string(&js, "nonce", nonce_str);
+            json_stream_begin_array(&js, "events");
+            for (size_t e = k; e < n; e++) {
+                const cluster_trace_record_t *same = &recs[order[e]];
+                if (cluster_trace_is_share_stage(same->stage) && same->aux == rec->aux) {
+                    stream_trace_event(&js, same, start_us);
+                }
+            }
+            json_stream_end_array(&js);
+            json_stream_end_object(&js);
         }
+        json_stream_end_array(&js);
+
+        json_stream_end_object(&js);
     }
+    json_stream_end_array(&js);
 
-    esp_http_client_cleanup(client);
-    return err;
+    free(order);
+    free(recs);
+
+    json_stream_end_object(&js);
+    return HTTP_finish_json_stream(req, &js);
 }
 
+#if CLUSTER_IS_MASTER
+
 // Unified handler for all /api/cluster/slave/{id}/{action} requests
 static esp_err_t cluster_slave_api_handler(httpd_req_t *req)
 {
@@ -1590,7 +2444,7 @@ static esp_err_t cluster_slave_api_handler(httpd_req_t *req)
         ESP_LOGI(TAG, "Slave %d config request: IP='%s', valid=%d", slave_id, slave_info.ip_addr, has_valid_ip);
 
         if (has_valid_ip) {
-            esp_err_t err = http_proxy_to_slave(slave_info.ip_addr, "/api/system/info", HTTP_METHOD_GET, NULL, &slave_response);
+            esp_err_t err = cluster_proxy_request(slave_id, "/api/system/info", HTTP_METHOD_GET, NULL, &slave_response, NULL);
             if (err == ESP_OK && slave_response) {
                 slave_system = cJSON_Parse(slave_response);
                 if (!slave_system) {
@@ -1751,7 +2605,7 @@ static esp_err_t cluster_slave_api_handler(httpd_req_t *req)
         // Proxy to slave via HTTP PATCH
         ESP_LOGI(TAG, "Applying to slave %s: %s", slave_info.ip_addr, patch_data);
         char *response = NULL;
-        esp_err_t err = http_proxy_to_slave(slave_info.ip_addr, "/api/system", HTTP_METHOD_PATCH, patch_data, &response);
+        esp_err_t err = cluster_proxy_request(slave_id, "/api/system", HTTP_METHOD_PATCH, patch_data, &response, NULL);
 
         if (response) {
             free(response);
@@ -1793,9 +2647,9 @@ static esp_err_t cluster_slave_api_handler(httpd_req_t *req)
 
         if (strcmp(action, "autotune/status") == 0 && req->method == HTTP_GET) {
             // GET autotune status from slave
-            esp_err_t err = http_proxy_to_slave(slave_info.ip_addr,
-                                                 "/api/cluster/autotune/status",
-                                                 HTTP_METHOD_GET, NULL, &response);
+            esp_err_t err = cluster_proxy_request(slave_id,
+                                                   "/api/cluster/autotune/status",
+                                                   HTTP_METHOD_GET, NULL, &response, NULL);
             if (err == ESP_OK && response) {
                 httpd_resp_set_type(req, "application/json");
                 httpd_resp_sendstr(req, response);
@@ -1813,9 +2667,9 @@ static esp_err_t cluster_slave_api_handler(httpd_req_t *req)
             }
             buf[received] = '\0';
 
-            esp_err_t err = http_proxy_to_slave(slave_info.ip_addr,
-                                                 "/api/cluster/autotune",
-                                                 HTTP_METHOD_POST, buf, &response);
+            esp_err_t err = cluster_proxy_request(slave_id,
+                                                   "/api/cluster/autotune",
+                                                   HTTP_METHOD_POST, buf, &response, NULL);
             if (err == ESP_OK && response) {
                 httpd_resp_set_type(req, "application/json");
                 httpd_resp_sendstr(req, response);
@@ -1829,6 +2683,60 @@ static esp_err_t cluster_slave_api_handler(httpd_req_t *req)
     return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Unknown action");
 }
 
+// GET /api/cluster/slaves/info - every slave's /api/system/info, fetched in parallel
+static esp_err_t GET_cluster_slaves_info(httpd_req_t *req)
+{
+    cluster_proxy_result_t *results = calloc(CONFIG_CLUSTER_MAX_SLAVES, sizeof(cluster_proxy_result_t));
+    if (!results) {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+    }
+    int count = cluster_proxy_get_all("/api/system/info", results, CONFIG_CLUSTER_MAX_SLAVES);
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON *slaves = cJSON_AddArrayToObject(root, "slaves");
+    for (int i = 0; i < count; i++) {
+        const cluster_proxy_result_t *result = &results[i];
+        cluster_slave_t slave_info;
+        if (cluster_master_get_slave_info(result->slave_id, &slave_info) != ESP_OK) {
+            continue;
+        }
+
+        cJSON *slave = cJSON_CreateObject();
+        cJSON_AddNumberToObject(slave, "slaveId", result->slave_id);
+        cJSON_AddStringToObject(slave, "hostname", slave_info.hostname);
+        cJSON_AddStringToObject(slave, "ipAddr", slave_info.ip_addr);
+
+        cJSON *info = result->err == ESP_OK && result->status == 200 && result->body ?
+                      cJSON_Parse(result->body) : NULL;
+        cJSON_AddBoolToObject(slave, "online", info != NULL);
+        if (info) {
+            cJSON_AddItemToObject(slave, "info", info);
+        } else {
+            cJSON_AddStringToObject(slave, "error", result->err != ESP_OK ? esp_err_to_name(result->err) :
+                                                    result->status != 200 ? "HTTP error" : "Invalid JSON");
+        }
+        cJSON_AddItemToArray(slaves, slave);
+    }
+    cluster_proxy_free_results(results, count);
+    free(results);
+
+    cluster_proxy_stats_t stats;
+    cluster_proxy_get_stats(&stats);
+    cJSON *proxy = cJSON_AddObjectToObject(root, "proxy");
+    cJSON_AddNumberToObject(proxy, "requests", stats.requests);
+    cJSON_AddNumberToObject(proxy, "cacheHits", stats.cache_hits);
+    cJSON_AddNumberToObject(proxy, "reused", stats.reused);
+    cJSON_AddNumberToObject(proxy, "reconnects", stats.reconnects);
+    cJSON_AddNumberToObject(proxy, "failures", stats.failures);
+    cJSON_AddNumberToObject(proxy, "busy", stats.busy);
+    cJSON_AddNumberToObject(proxy, "inflightPeak", stats.inflight_peak);
+    cJSON_AddNumberToObject(proxy, "openConnections", stats.open_connections);
+
+    esp_err_t res = HTTP_send_json(req, root, &cluster_prebuffer_len);
+    cJSON_Delete(root);
+    return res;
+}
+
 // Handler for bulk slave operations - /api/cluster/slaves/{action}
 static esp_err_t cluster_slaves_api_handler(httpd_req_t *req)
 {
@@ -1846,6 +2754,10 @@ static esp_err_t cluster_slaves_api_handler(httpd_req_t *req)
     httpd_resp_set_type(req, "application/json");
     set_cors_headers(req);
 
+    if (strcmp(action, "info") == 0 && req->method == HTTP_GET) {
+        return GET_cluster_slaves_info(req);
+    }
+
     char buf[256];
     int received = httpd_req_recv(req, buf, sizeof(buf) - 1);
     if (received > 0) {
@@ -1901,6 +2813,18 @@ static esp_err_t POST_cluster_mode(httpd_req_t *req)
     }
 
     int new_mode = mode_item->valueint;
+
+    // Optional slave transport: "espnow", "udp" or "bap"
+    cluster_transport_type_t new_transport = CLUSTER_TRANSPORT_NONE;
+    cJSON *transport_item = cJSON_GetObjectItem(root, "transport");
+    if (cJSON_IsString(transport_item)) {
+        new_transport = cluster_transport_type_from_name(transport_item->valuestring);
+        if (new_transport == CLUSTER_TRANSPORT_NONE) {
+            cJSON_Delete(root);
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid transport value");
+            return ESP_FAIL;
+        }
+    }
     cJSON_Delete(root);
 
     // Validate mode (0=disabled, 1=master, 2=slave)
@@ -1909,6 +2833,12 @@ static esp_err_t POST_cluster_mode(httpd_req_t *req)
         return ESP_FAIL;
     }
 
+    if (new_transport != CLUSTER_TRANSPORT_NONE &&
+        cluster_transport_set_preferred(new_transport) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Transport not available");
+        return ESP_FAIL;
+    }
+
     // Store the new mode in NVS - will take effect after restart
     esp_err_t ret = cluster_set_mode((cluster_mode_t)new_mode);
 
@@ -1982,6 +2912,32 @@ static esp_err_t GET_autotune_status(httpd_req_t *req)
     cJSON_AddNumberToObject(root, "testsTotal", status.tests_total);
     cJSON_AddNumberToObject(root, "testDuration", status.test_duration_ms);
     cJSON_AddNumberToObject(root, "totalDuration", status.total_duration_ms);
+    cJSON_AddStringToObject(root, "search", cluster_autotune_get_search());
+
+    // Power budget shared by all devices being tuned
+    cJSON_AddNumberToObject(root, "powerBudget", cluster_autotune_get_power_budget());
+    cJSON_AddFloatToObject(root, "powerCommitted", status.power_committed_w);
+
+    // Every device is tuned in parallel
+    autotune_device_status_t devices[CONFIG_CLUSTER_MAX_SLAVES + 1];
+    int device_count = cluster_autotune_get_devices(devices, sizeof(devices) / sizeof(devices[0]));
+    cJSON *device_array = cJSON_AddArrayToObject(root, "devices");
+    for (int i = 0; i < device_count; i++) {
+        cJSON *dev = cJSON_CreateObject();
+        cJSON_AddNumberToObject(dev, "device", devices[i].device);
+        cJSON_AddStringToObject(dev, "state", devices[i].state);
+        cJSON_AddNumberToObject(dev, "currentFrequency", devices[i].current_frequency);
+        cJSON_AddNumberToObject(dev, "currentVoltage", devices[i].current_voltage);
+        cJSON_AddNumberToObject(dev, "bestFrequency", devices[i].best_frequency);
+        cJSON_AddNumberToObject(dev, "bestVoltage", devices[i].best_voltage);
+        cJSON_AddFloatToObject(dev, "bestEfficiency", devices[i].best_efficiency);
+        cJSON_AddFloatToObject(dev, "bestHashrate", devices[i].best_hashrate);
+        cJSON_AddFloatToObject(dev, "power", devices[i].power);
+        cJSON_AddNumberToObject(dev, "testsCompleted", devices[i].tests_completed);
+        cJSON_AddNumberToObject(dev, "testsTotal", devices[i].tests_total);
+        cJSON_AddNumberToObject(dev, "budgetWaitMs", devices[i].budget_wait_ms);
+        cJSON_AddItemToArray(device_array, dev);
+    }
 
     // Error
     if (status.error_msg[0] != '\0') {
@@ -1992,6 +2948,36 @@ static esp_err_t GET_autotune_status(httpd_req_t *req)
     cJSON_AddBoolToObject(root, "watchdogEnabled", cluster_autotune_watchdog_is_enabled());
     cJSON_AddBoolToObject(root, "watchdogRunning", cluster_autotune_watchdog_is_running());
 
+    // Online optimizer after the lock
+    autotune_online_status_t online;
+    cluster_autotune_get_online_status(&online);
+    cJSON *online_obj = cJSON_AddObjectToObject(root, "online");
+    cJSON_AddBoolToObject(online_obj, "enabled", online.enabled);
+    cJSON_AddBoolToObject(online_obj, "running", online.running);
+    if (online.running) {
+        cJSON_AddStringToObject(online_obj, "state", online.state);
+        cJSON_AddNumberToObject(online_obj, "frequency", online.frequency);
+        cJSON_AddNumberToObject(online_obj, "voltage", online.voltage);
+        cJSON_AddNumberToObject(online_obj, "lockFrequency", online.lock_frequency);
+        cJSON_AddNumberToObject(online_obj, "lockVoltage", online.lock_voltage);
+        if (online.have_gain) {
+            cJSON_AddFloatToObject(online_obj, "gainPct", online.gain_pct);
+        }
+        cJSON_AddNumberToObject(online_obj, "probes", online.probes);
+        cJSON_AddNumberToObject(online_obj, "kept", online.kept);
+        cJSON_AddNumberToObject(online_obj, "reverted", online.reverted);
+        cJSON_AddNumberToObject(online_obj, "unstable", online.unstable);
+        cJSON_AddNumberToObject(online_obj, "breaches", online.breaches);
+        cJSON_AddNumberToObject(online_obj, "rebases", online.rebases);
+    }
+
+    // Temperature-indexed profiles
+    bool ambient_measured;
+    cJSON_AddFloatToObject(root, "ambient", cluster_autotune_get_ambient(&ambient_measured));
+    cJSON_AddStringToObject(root, "ambientSource", ambient_measured ? "sensor" : "estimate");
+    cJSON_AddBoolToObject(root, "profileFollow", cluster_autotune_get_profile_follow());
+    cJSON_AddNumberToObject(root, "profileCount", cluster_autotune_get_profile_count());
+
     char *json_str = cJSON_Print(root);
     httpd_resp_sendstr(req, json_str);
 
@@ -2077,7 +3063,21 @@ static esp_err_t POST_autotune(httpd_req_t *req)
                 cluster_autotune_set_slave_mask(mask);
             }
 
-            ret = cluster_autotune_start(mode);
+            cJSON *power_budget = cJSON_GetObjectItem(root, "powerBudget");
+            if (power_budget && cJSON_IsNumber(power_budget)) {
+                cluster_autotune_set_power_budget((float)power_budget->valuedouble);
+            }
+
+            // "grid", "bisect" or "climb"; unknown names are refused
+            cJSON *search = cJSON_GetObjectItem(root, "search");
+            ret = ESP_OK;
+            if (search && cJSON_IsString(search)) {
+                ret = cluster_autotune_set_search(search->valuestring);
+            }
+
+            if (ret == ESP_OK) {
+                ret = cluster_autotune_start(mode);
+            }
         } else if (strcmp(action_str, "stop") == 0 || strcmp(action_str, "disable") == 0) {
             cJSON *apply_best = cJSON_GetObjectItem(root, "applyBest");
             bool should_apply = true;
@@ -2093,9 +3093,25 @@ static esp_err_t POST_autotune(httpd_req_t *req)
             ret = cluster_autotune_watchdog_enable(true);
         } else if (strcmp(action_str, "disableWatchdog") == 0) {
             ret = cluster_autotune_watchdog_enable(false);
+        } else if (strcmp(action_str, "enableOnline") == 0) {
+            ret = cluster_autotune_set_online(true);
+        } else if (strcmp(action_str, "disableOnline") == 0) {
+            ret = cluster_autotune_set_online(false);
+        } else if (strcmp(action_str, "enableProfiles") == 0) {
+            ret = cluster_autotune_set_profile_follow(true);
+        } else if (strcmp(action_str, "disableProfiles") == 0) {
+            ret = cluster_autotune_set_profile_follow(false);
+        } else if (strcmp(action_str, "clearProfiles") == 0) {
+            ret = cluster_autotune_clear_profiles();
         }
     }
 
+    // Room temperature from an external sensor, in °C
+    cJSON *ambient = cJSON_GetObjectItem(root, "ambient");
+    if (ambient && cJSON_IsNumber(ambient)) {
+        ret = cluster_autotune_set_ambient((float)ambient->valuedouble);
+    }
+
     // Also check for direct watchdog flag (alternative syntax)
     cJSON *watchdog = cJSON_GetObjectItem(root, "watchdog");
     if (watchdog && cJSON_IsBool(watchdog)) {
@@ -2114,6 +3130,59 @@ static esp_err_t POST_autotune(httpd_req_t *req)
     return ret;
 }
 
+/* Handler for the temperature-indexed profiles remembered by autotune */
+static esp_err_t GET_autotune_profiledb(httpd_req_t *req)
+{
+    if (is_network_allowed(req) != ESP_OK) {
+        return httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Unauthorized");
+    }
+
+    int max = cluster_autotune_get_profile_count();
+    autotune_profile_info_t *profiles = max ? malloc(max * sizeof(autotune_profile_info_t)) : NULL;
+    int count = profiles ? cluster_autotune_get_profiles(profiles, max) : 0;
+
+    static const char *mode_names[] = {"efficiency", "hashrate", "balanced"};
+
+    httpd_resp_set_type(req, "application/json");
+
+    char chunk[JSON_CHUNK_SIZE];
+    json_stream_t js;
+    json_stream_init(&js, chunk, sizeof(chunk), true, json_chunk_flush, req);
+    json_stream_begin_object(&js, NULL);
+    json_stream_bool(&js, "follow", cluster_autotune_get_profile_follow());
+    json_stream_begin_array(&js, "profiles");
+    for (int i = 0; i < count; i++) {
+        const autotune_profile_info_t *p = &profiles[i];
+        char mac[18];
+        snprintf(mac, sizeof(mac), "%02X:%02X:%02X:%02X:%02X:%02X",
+                 p->mac[0], p->mac[1], p->mac[2], p->mac[3], p->mac[4], p->mac[5]);
+
+        json_stream_begin_object(&js, NULL);
+        json_stream_string(&js, "mac", mac);
+        if (p->asic_id) {
+            char asic[8];
+            snprintf(asic, sizeof(asic), "BM%u", p->asic_id);
+            json_stream_string(&js, "asicModel", asic);
+        }
+        if (p->board[0]) {
+            json_stream_string(&js, "boardVersion", p->board);
+        }
+        json_stream_string(&js, "mode", p->mode <= AUTOTUNE_MODE_BALANCED ? mode_names[p->mode] : "unknown");
+        json_stream_number(&js, "ambient", p->temp_c);
+        json_stream_number(&js, "frequency", p->frequency);
+        json_stream_number(&js, "voltage", p->voltage);
+        json_stream_float(&js, "efficiency", p->efficiency);
+        json_stream_float(&js, "hashrate", p->hashrate);
+        json_stream_number(&js, "savedAt", p->saved_at);
+        json_stream_end_object(&js);
+    }
+    json_stream_end_array(&js);
+    json_stream_end_object(&js);
+    free(profiles);
+
+    return HTTP_finish_json_stream(req, &js);
+}
+
 // ============================================================================
 // Auto-Timing API
 // ============================================================================
@@ -2567,8 +3636,8 @@ static esp_err_t POST_apply_profile(httpd_req_t *req)
                 snprintf(post_data, sizeof(post_data),
                          "{\"settingId\":32,\"value\":%d}", frequency->valueint);
                 char *response = NULL;
-                http_proxy_to_slave(slave_info.ip_addr, "/api/cluster/slave/0/setting",
-                                    HTTP_METHOD_POST, post_data, &response);
+                cluster_proxy_request(slave_id, "/api/cluster/slave/0/setting",
+                                      HTTP_METHOD_POST, post_data, &response, NULL);
                 free(response);
                 applied_count++;
             }
@@ -2576,8 +3645,8 @@ static esp_err_t POST_apply_profile(httpd_req_t *req)
                 snprintf(post_data, sizeof(post_data),
                          "{\"settingId\":33,\"value\":%d}", voltage->valueint);
                 char *response = NULL;
-                http_proxy_to_slave(slave_info.ip_addr, "/api/cluster/slave/0/setting",
-                                    HTTP_METHOD_POST, post_data, &response);
+                cluster_proxy_request(slave_id, "/api/cluster/slave/0/setting",
+                                      HTTP_METHOD_POST, post_data, &response, NULL);
                 free(response);
                 applied_count++;
             }
@@ -2622,6 +3691,8 @@ esp_err_t start_rest_server(void * pvParameters)
     
     // Initialize the ASIC API with the global state
     asic_api_init(GLOBAL_STATE);
+    websocket_init(GLOBAL_STATE);
+    metrics_register_collector(collect_system_metrics, NULL);
     const char * base_path = "";
 
     bool enter_recovery = false;
@@ -2647,6 +3718,13 @@ esp_err_t start_rest_server(void * pvParameters)
     ESP_LOGI(TAG, "Starting HTTP Server");
     REST_CHECK(httpd_start(&server, &config) == ESP_OK, "Start server failed", err_start);
 
+#if CLUSTER_ENABLED && CLUSTER_IS_MASTER
+    // Slave requests from the web UI go through the pooled proxy
+    if (cluster_proxy_init() != ESP_OK) {
+        ESP_LOGE(TAG, "Slave proxy unavailable");
+    }
+#endif
+
     httpd_uri_t recovery_explicit_get_uri = {
         .uri = "/recovery", 
         .method = HTTP_GET, 
@@ -2685,6 +3763,42 @@ esp_err_t start_rest_server(void * pvParameters)
     };
     httpd_register_uri_handler(server, &system_statistics_get_uri);
 
+    /* URI handler for long-term statistics from flash */
+    httpd_uri_t system_statistics_history_get_uri = {
+        .uri = "/api/system/statistics/history",
+        .method = HTTP_GET,
+        .handler = GET_system_statistics_history,
+        .user_ctx = rest_context
+    };
+    httpd_register_uri_handler(server, &system_statistics_history_get_uri);
+
+    /* URI handler for downloading the kept log lines */
+    httpd_uri_t system_logs_get_uri = {
+        .uri = "/api/system/logs",
+        .method = HTTP_GET,
+        .handler = GET_system_logs,
+        .user_ctx = rest_context
+    };
+    httpd_register_uri_handler(server, &system_logs_get_uri);
+
+    /* URI handler for the startup timeline */
+    httpd_uri_t system_boot_get_uri = {
+        .uri = "/api/system/boot",
+        .method = HTTP_GET,
+        .handler = GET_system_boot,
+        .user_ctx = rest_context
+    };
+    httpd_register_uri_handler(server, &system_boot_get_uri);
+
+    /* URI handler for Prometheus scrapes */
+    httpd_uri_t metrics_get_uri = {
+        .uri = "/metrics",
+        .method = HTTP_GET,
+        .handler = GET_metrics,
+        .user_ctx = rest_context
+    };
+    httpd_register_uri_handler(server, &metrics_get_uri);
+
     /* URI handler for WiFi scan */
     httpd_uri_t wifi_scan_get_uri = {
         .uri = "/api/system/wifi/scan",
@@ -2774,6 +3888,14 @@ esp_err_t start_rest_server(void * pvParameters)
     };
     httpd_register_uri_handler(server, &cluster_mode_uri);
 
+    httpd_uri_t cluster_trace_uri = {
+        .uri = "/api/cluster/trace",
+        .method = HTTP_GET,
+        .handler = GET_cluster_trace,
+        .user_ctx = rest_context
+    };
+    httpd_register_uri_handler(server, &cluster_trace_uri);
+
     // Autotune API endpoints
     httpd_uri_t autotune_status_uri = {
         .uri = "/api/cluster/autotune/status",
@@ -2791,6 +3913,14 @@ esp_err_t start_rest_server(void * pvParameters)
     };
     httpd_register_uri_handler(server, &autotune_control_uri);
 
+    httpd_uri_t autotune_profiledb_uri = {
+        .uri = "/api/cluster/autotune/profiledb",
+        .method = HTTP_GET,
+        .handler = GET_autotune_profiledb,
+        .user_ctx = rest_context
+    };
+    httpd_register_uri_handler(server, &autotune_profiledb_uri);
+
     // Profile API endpoints
     httpd_uri_t profiles_get_uri = {
         .uri = "/api/cluster/profiles",
@@ -2900,7 +4030,7 @@ esp_err_t start_rest_server(void * pvParameters)
 
     httpd_register_err_handler(server, HTTPD_404_NOT_FOUND, http_404_error_handler);
 
-    // Start websocket log handler thread
+    // Start websocket thread: log lines and metric topics
     xTaskCreateWithCaps(websocket_task, "websocket_task", 8192, server, 2, NULL, MALLOC_CAP_SPIRAM);
 
     // Start the DNS server that will redirect all queries to the softAP IP
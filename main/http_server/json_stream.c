@@ -0,0 +1,291 @@
+#include "json_stream.h"
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// Same rounding as cJSON_AddFloatToObject in http_server.c
+#define FLOAT_FACTOR    10000000.0
+
+// ============================================================================
+// Output
+// ============================================================================
+
+static void flush_buf(json_stream_t *js)
+{
+    if (js->len == 0 || js->err != ESP_OK) {
+        return;
+    }
+    esp_err_t err = js->flush ? js->flush(js->ctx, js->buf, js->len) : ESP_OK;
+    if (err != ESP_OK) {
+        js->err = err;
+    }
+    js->len = 0;
+}
+
+static void put(json_stream_t *js, const char *s, size_t n)
+{
+    while (n > 0 && js->err == ESP_OK) {
+        size_t room = js->cap - js->len;
+        size_t take = n < room ? n : room;
+        memcpy(js->buf + js->len, s, take);
+        js->len += take;
+        js->total += take;
+        s += take;
+        n -= take;
+        if (js->len == js->cap) {
+            flush_buf(js);
+        }
+    }
+}
+
+static void put_char(json_stream_t *js, char c)
+{
+    put(js, &c, 1);
+}
+
+static void put_tabs(json_stream_t *js, int count)
+{
+    for (int i = 0; i < count; i++) {
+        put_char(js, '\t');
+    }
+}
+
+/**
+ * @brief Quoted, escaped as cJSON's print_string_ptr does
+ *
+ * Runs of plain characters go out in one copy.
+ */
+static void put_string(json_stream_t *js, const char *s)
+{
+    put_char(js, '"');
+    const char *run = s;
+    for (const unsigned char *p = (const unsigned char *)s; *p; p++) {
+        if (*p >= 32 && *p != '"' && *p != '\\') {
+            continue;
+        }
+        put(js, run, (const char *)p - run);
+        run = (const char *)p + 1;
+
+        char esc[7];
+        switch (*p) {
+            case '"':  put(js, "\\\"", 2); break;
+            case '\\': put(js, "\\\\", 2); break;
+            case '\b': put(js, "\\b", 2); break;
+            case '\f': put(js, "\\f", 2); break;
+            case '\n': put(js, "\\n", 2); break;
+            case '\r': put(js, "\\r", 2); break;
+            case '\t': put(js, "\\t", 2); break;
+            default:
+                snprintf(esc, sizeof(esc), "\\u%04x", *p);
+                put(js, esc, 6);
+                break;
+        }
+    }
+    put(js, run, strlen(run));
+    put_char(js, '"');
+}
+
+// ============================================================================
+// Structure
+// ============================================================================
+
+/**
+ * @brief Separator and key ahead of a value
+ * @return false if the stream has failed
+ */
+static bool begin_value(json_stream_t *js, const char *key)
+{
+    if (js->err != ESP_OK) {
+        return false;
+    }
+
+    uint32_t bit = 1u << js->depth;
+    if (js->depth == 0) {
+        // One root value per document
+        if (js->has_items & bit) {
+            js->err = ESP_ERR_INVALID_STATE;
+            return false;
+        }
+        js->has_items |= bit;
+        return true;
+    }
+
+    bool array = (js->in_array & bit) != 0;
+    if (!array && !key) {
+        js->err = ESP_ERR_INVALID_ARG;
+        return false;
+    }
+    if (js->has_items & bit) {
+        put_char(js, ',');
+        if (js->format) {
+            put_char(js, array ? ' ' : '\n');
+        }
+    }
+    js->has_items |= bit;
+
+    if (!array) {
+        if (js->format) {
+            put_tabs(js, js->depth);
+        }
+        put_string(js, key);
+        put(js, ":\t", js->format ? 2 : 1);
+    }
+    return js->err == ESP_OK;
+}
+
+static void begin_container(json_stream_t *js, const char *key, bool array)
+{
+    if (!begin_value(js, key)) {
+        return;
+    }
+    if (js->depth + 1 >= JSON_STREAM_MAX_DEPTH) {
+        js->err = ESP_ERR_INVALID_STATE;
+        return;
+    }
+
+    put_char(js, array ? '[' : '{');
+    js->depth++;
+    uint32_t bit = 1u << js->depth;
+    js->has_items &= ~bit;
+    if (array) {
+        js->in_array |= bit;
+    } else {
+        js->in_array &= ~bit;
+        if (js->format) {
+            put_char(js, '\n');
+        }
+    }
+}
+
+static void end_container(json_stream_t *js, bool array)
+{
+    if (js->err != ESP_OK) {
+        return;
+    }
+    uint32_t bit = 1u << js->depth;
+    if (js->depth == 0 || ((js->in_array & bit) != 0) != array) {
+        js->err = ESP_ERR_INVALID_STATE;
+        return;
+    }
+
+    if (!array && js->format) {
+        if (js->has_items & bit) {
+            put_char(js, '\n');
+        }
+        put_tabs(js, js->depth - 1);
+    }
+    put_char(js, array ? ']' : '}');
+    js->depth--;
+}
+
+void json_stream_init(json_stream_t *js, char *buf, size_t cap, bool format,
+                      json_stream_flush_t flush, void *ctx)
+{
+    memset(js, 0, sizeof(*js));
+    js->buf = buf;
+    js->cap = cap;
+    js->format = format;
+    js->flush = flush;
+    js->ctx = ctx;
+    if (!buf || cap == 0) {
+        js->err = ESP_ERR_INVALID_ARG;
+    }
+}
+
+void json_stream_begin_object(json_stream_t *js, const char *key)
+{
+    begin_container(js, key, false);
+}
+
+void json_stream_begin_array(json_stream_t *js, const char *key)
+{
+    begin_container(js, key, true);
+}
+
+void json_stream_end_object(json_stream_t *js)
+{
+    end_container(js, false);
+}
+
+void json_stream_end_array(json_stream_t *js)
+{
+    end_container(js, true);
+}
+
+// ============================================================================
+// Values
+// ============================================================================
+
+static bool same_double(double a, double b)
+{
+    double max = fabs(a) > fabs(b) ? fabs(a) : fabs(b);
+    return fabs(a - b) <= max * DBL_EPSILON;
+}
+
+void json_stream_number(json_stream_t *js, const char *key, double value)
+{
+    if (!begin_value(js, key)) {
+        return;
+    }
+
+    if (isnan(value) || isinf(value)) {
+        put(js, "null", 4);
+        return;
+    }
+
+    char num[26];
+    int len;
+    // cJSON keeps a saturated int copy of every number and prints that when it is exact
+    int as_int = value >= INT_MAX ? INT_MAX : value <= (double)INT_MIN ? INT_MIN : (int)value;
+
+    if (value == (double)as_int) {
+        len = snprintf(num, sizeof(num), "%d", as_int);
+    } else {
+        double back = 0;
+        len = snprintf(num, sizeof(num), "%1.15g", value);
+        if (sscanf(num, "%lg", &back) != 1 || !same_double(back, value)) {
+            len = snprintf(num, sizeof(num), "%1.17g", value);
+        }
+    }
+    put(js, num, (size_t)len);
+}
+
+void json_stream_float(json_stream_t *js, const char *key, float value)
+{
+    json_stream_number(js, key, round((double)value * FLOAT_FACTOR) / FLOAT_FACTOR);
+}
+
+void json_stream_bool(json_stream_t *js, const char *key, bool value)
+{
+    if (begin_value(js, key)) {
+        put(js, value ? "true" : "false", value ? 4 : 5);
+    }
+}
+
+void json_stream_null(json_stream_t *js, const char *key)
+{
+    if (begin_value(js, key)) {
+        put(js, "null", 4);
+    }
+}
+
+void json_stream_string(json_stream_t *js, const char *key, const char *value)
+{
+    if (!value) {
+        return;
+    }
+    if (begin_value(js, key)) {
+        put_string(js, value);
+    }
+}
+
+esp_err_t json_stream_finish(json_stream_t *js)
+{
+    if (js->err == ESP_OK && (js->depth != 0 || !(js->has_items & 1u))) {
+        js->err = ESP_ERR_INVALID_STATE;
+    }
+    flush_buf(js);
+    return js->err;
+}
@@ -0,0 +1,96 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Streaming JSON writer for large API responses. A document is written
+// member by member into a fixed scratch buffer, and each full buffer goes to
+// a flush callback (httpd_resp_send_chunk), so the response never exists as
+// a cJSON tree or as one heap string. The output is byte for byte what
+// cJSON_Print gives for the same tree.
+//
+// Errors are sticky: after the first failed flush or misuse every call is a
+// no-op and json_stream_finish() returns the error.
+
+// Deepest nesting of objects and arrays
+#define JSON_STREAM_MAX_DEPTH   16
+
+/**
+ * @brief Take a full buffer (or the tail at the end)
+ * @return ESP_OK, or an error that stops the stream
+ */
+typedef esp_err_t (*json_stream_flush_t)(void *ctx, const char *data, size_t len);
+
+typedef struct {
+    char                *buf;
+    size_t              cap;
+    size_t              len;            // Bytes waiting in buf
+    size_t              total;          // Bytes written so far, flushed or not
+    json_stream_flush_t flush;
+    void                *ctx;
+    bool                format;         // cJSON_Print layout rather than cJSON_PrintUnformatted
+    uint8_t             depth;
+    uint32_t            in_array;       // Bit per depth: container is an array
+    uint32_t            has_items;      // Bit per depth: container has a member already
+    esp_err_t           err;
+} json_stream_t;
+
+/**
+ * @brief Start a document
+ *
+ * @param buf Scratch buffer, at least one byte; its size is the chunk size
+ * @param format Indent like cJSON_Print (true) or compact (false)
+ */
+void json_stream_init(json_stream_t *js, char *buf, size_t cap, bool format,
+                      json_stream_flush_t flush, void *ctx);
+
+/**
+ * @brief Open an object or array
+ *
+ * The key names the member inside an object and is ignored inside an
+ * array or for the root value.
+ */
+void json_stream_begin_object(json_stream_t *js, const char *key);
+void json_stream_begin_array(json_stream_t *js, const char *key);
+void json_stream_end_object(json_stream_t *js);
+void json_stream_end_array(json_stream_t *js);
+
+/**
+ * @brief Write a number as cJSON_AddNumberToObject would
+ *
+ * Integral values in int range print as integers, everything else with
+ * the shortest of %1.15g / %1.17g that reads back exactly; NaN and
+ * infinity print as null.
+ */
+void json_stream_number(json_stream_t *js, const char *key, double value);
+
+/**
+ * @brief Write a float as the http_server cJSON_AddFloatToObject would
+ *
+ * Rounded to 7 decimal places first, so 0.1f prints as 0.1 rather than
+ * 0.10000000149011612.
+ */
+void json_stream_float(json_stream_t *js, const char *key, float value);
+
+void json_stream_bool(json_stream_t *js, const char *key, bool value);
+void json_stream_null(json_stream_t *js, const char *key);
+
+/**
+ * @brief Write a string
+ *
+ * A NULL value writes nothing, matching cJSON_AddStringToObject, which
+ * leaves the member out.
+ */
+void json_stream_string(json_stream_t *js, const char *key, const char *value);
+
+/**
+ * @brief Flush what is left
+ * @return ESP_OK, the first flush error, or ESP_ERR_INVALID_STATE if the
+ *         document was not closed or was misused
+ */
+esp_err_t json_stream_finish(json_stream_t *js);
+
+#endif // JSON_STREAM_H
@@ -0,0 +1,390 @@
+#include <math.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include "metrics.h"
+
+typedef struct {
+    const char      *name;
+    const char      *help;
+    metrics_type_t  type;
+} family_t;
+
+typedef struct {
+    uint8_t                 family;
+    metrics_source_t        source;
+    const volatile void     *value;
+    metrics_histogram_t     *histogram;
+    char                    labels[METRICS_LABELS_SIZE];
+    char                    prefix[METRICS_PREFIX_SIZE];    // Counters and gauges
+    uint8_t                 prefix_len;
+} series_t;
+
+typedef struct {
+    metrics_collect_fn  collect;
+    void                *ctx;
+} collector_t;
+
+// What a scrape reads of a series; re-registration may change it meanwhile
+typedef struct {
+    uint8_t                 family;
+    metrics_source_t        source;
+    const volatile void     *value;
+    metrics_histogram_t     *histogram;
+} series_view_t;
+
+// Registration happens as tasks start. Entries are only ever appended and a
+// family's name or a series' labels never change, so a scrape copies what it
+// needs under the lock and renders from the copy while registration goes on.
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static family_t families[METRICS_MAX_FAMILIES];
+static series_t series[METRICS_MAX_SERIES];
+static collector_t collectors[METRICS_MAX_COLLECTORS];
+static uint8_t family_count;
+static uint8_t series_count;
+static uint8_t collector_count;
+
+static const char *type_names[] = {
+    [METRICS_COUNTER]   = "counter",
+    [METRICS_GAUGE]     = "gauge",
+    [METRICS_HISTOGRAM] = "histogram",
+};
+
+// ============================================================================
+// Registration
+// ============================================================================
+
+static int find_family(const char *name, metrics_type_t type, const char *help)
+{
+    for (int i = 0; i < family_count; i++) {
+        if (strcmp(families[i].name, name) == 0) {
+            return (families[i].type == type) ? i : -1;
+        }
+    }
+    if (family_count == METRICS_MAX_FAMILIES) {
+        return -2;
+    }
+    families[family_count] = (family_t) { .name = name, .help = help, .type = type };
+    return family_count++;
+}
+
+static esp_err_t add_series(const char *name, metrics_type_t type, const char *help, const char *labels,
+                            metrics_source_t source, const volatile void *value, metrics_histogram_t *histogram)
+{
+    if (name == NULL || (value == NULL && histogram == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (labels == NULL) {
+        labels = "";
+    }
+    if (strlen(labels) >= METRICS_LABELS_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    pthread_mutex_lock(&registry_lock);
+
+    esp_err_t err = ESP_OK;
+    int family = find_family(name, type, help);
+    if (family < 0) {
+        err = (family == -1) ? ESP_ERR_INVALID_ARG : ESP_ERR_NO_MEM;
+        goto done;
+    }
+
+    series_t *s = NULL;
+    for (int i = 0; i < series_count; i++) {
+        if (series[i].family == family && strcmp(series[i].labels, labels) == 0) {
+            s = &series[i];
+            break;
+        }
+    }
+    if (s == NULL) {
+        if (series_count == METRICS_MAX_SERIES) {
+            err = ESP_ERR_NO_MEM;
+            goto done;
+        }
+        s = &series[series_count++];
+        s->family = family;
+        strcpy(s->labels, labels);
+        int len = snprintf(s->prefix, sizeof(s->prefix), labels[0] ? "%s{%s} " : "%s ", name, labels);
+        s->prefix_len = (len < (int) sizeof(s->prefix)) ? len : sizeof(s->prefix) - 1;
+    }
+    s->source = source;
+    s->value = value;
+    s->histogram = histogram;
+
+done:
+    pthread_mutex_unlock(&registry_lock);
+    return err;
+}
+
+esp_err_t metrics_register(const char *name, metrics_type_t type, const char *help, const char *labels,
+                           metrics_source_t source, const volatile void *value)
+{
+    if (type == METRICS_HISTOGRAM) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return add_series(name, type, help, labels, source, value, NULL);
+}
+
+esp_err_t metrics_register_histogram(const char *name, const char *help, const char *labels,
+                                     metrics_histogram_t *histogram)
+{
+    return add_series(name, METRICS_HISTOGRAM, help, labels, METRICS_DOUBLE, NULL, histogram);
+}
+
+esp_err_t metrics_register_collector(metrics_collect_fn collect, void *ctx)
+{
+    if (collect == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&registry_lock);
+    esp_err_t err = ESP_OK;
+    if (collector_count == METRICS_MAX_COLLECTORS) {
+        err = ESP_ERR_NO_MEM;
+    } else {
+        collectors[collector_count++] = (collector_t) { .collect = collect, .ctx = ctx };
+    }
+    pthread_mutex_unlock(&registry_lock);
+    return err;
+}
+
+void metrics_reset(void)
+{
+    pthread_mutex_lock(&registry_lock);
+    family_count = 0;
+    series_count = 0;
+    collector_count = 0;
+    pthread_mutex_unlock(&registry_lock);
+}
+
+void metrics_histogram_init(metrics_histogram_t *histogram, const double *bounds, uint8_t count)
+{
+    memset(histogram, 0, sizeof(*histogram));
+    histogram->bounds = bounds;
+    histogram->count = (count < METRICS_MAX_BUCKETS) ? count : METRICS_MAX_BUCKETS;
+}
+
+void metrics_observe(metrics_histogram_t *histogram, double value)
+{
+    for (int i = 0; i < histogram->count; i++) {
+        if (value <= histogram->bounds[i]) {
+            histogram->buckets[i]++;
+            break;
+        }
+    }
+    histogram->observations++;
+    histogram->sum += value;
+}
+
+// ============================================================================
+// Writing
+// ============================================================================
+
+void metrics_writer_init(metrics_writer_t *w, char *buf, size_t cap, metrics_flush_t flush, void *ctx)
+{
+    memset(w, 0, sizeof(*w));
+    w->buf = buf;
+    w->cap = cap;
+    w->flush = flush;
+    w->ctx = ctx;
+    w->err = (buf == NULL || cap == 0) ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+
+static void put(metrics_writer_t *w, const char *data, size_t len)
+{
+    w->total += len;
+    while (len > 0 && w->err == ESP_OK) {
+        size_t n = w->cap - w->len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(&w->buf[w->len], data, n);
+        w->len += n;
+        data += n;
+        len -= n;
+        if (w->len == w->cap) {
+            w->err = w->flush ? w->flush(w->ctx, w->buf, w->len) : ESP_ERR_INVALID_STATE;
+            w->len = 0;
+        }
+    }
+}
+
+static void put_str(metrics_writer_t *w, const char *s)
+{
+    put(w, s, strlen(s));
+}
+
+static int format_double(char *out, size_t size, double value, int digits)
+{
+    if (isnan(value)) {
+        return snprintf(out, size, "NaN");
+    }
+    if (isinf(value)) {
+        return snprintf(out, size, value > 0 ? "+Inf" : "-Inf");
+    }
+    return snprintf(out, size, "%.*g", digits, value);
+}
+
+static void put_value(metrics_writer_t *w, metrics_source_t source, const volatile void *value)
+{
+    char text[32];
+    int len;
+    switch (source) {
+        case METRICS_FLOAT:  len = format_double(text, sizeof(text), *(const volatile float *) value, 7); break;
+        case METRICS_DOUBLE: len = format_double(text, sizeof(text), *(const volatile double *) value, 15); break;
+        case METRICS_BOOL:   len = snprintf(text, sizeof(text), "%d", *(const volatile bool *) value ? 1 : 0); break;
+        case METRICS_U8:     len = snprintf(text, sizeof(text), "%u", (unsigned) *(const volatile uint8_t *) value); break;
+        case METRICS_U16:    len = snprintf(text, sizeof(text), "%u", (unsigned) *(const volatile uint16_t *) value); break;
+        case METRICS_U32:    len = snprintf(text, sizeof(text), "%" PRIu32, *(const volatile uint32_t *) value); break;
+        case METRICS_U64:    len = snprintf(text, sizeof(text), "%" PRIu64, *(const volatile uint64_t *) value); break;
+        case METRICS_I32:    len = snprintf(text, sizeof(text), "%" PRId32, *(const volatile int32_t *) value); break;
+        case METRICS_I64:    len = snprintf(text, sizeof(text), "%" PRId64, *(const volatile int64_t *) value); break;
+        default:             len = snprintf(text, sizeof(text), "NaN"); break;
+    }
+    put(w, text, len);
+    put(w, "\n", 1);
+}
+
+void metrics_write_family(metrics_writer_t *w, const char *name, metrics_type_t type, const char *help)
+{
+    if (help != NULL) {
+        put_str(w, "# HELP ");
+        put_str(w, name);
+        put(w, " ", 1);
+        put_str(w, help);
+        put(w, "\n", 1);
+    }
+    put_str(w, "# TYPE ");
+    put_str(w, name);
+    put(w, " ", 1);
+    put_str(w, type_names[type]);
+    put(w, "\n", 1);
+}
+
+static void put_sample_name(metrics_writer_t *w, const char *name, const char *suffix, const char *labels,
+                            const char *extra)
+{
+    put_str(w, name);
+    if (suffix != NULL) {
+        put_str(w, suffix);
+    }
+    bool has_labels = labels != NULL && labels[0] != '\0';
+    if (has_labels || extra != NULL) {
+        put(w, "{", 1);
+        if (has_labels) {
+            put_str(w, labels);
+        }
+        if (extra != NULL) {
+            if (has_labels) {
+                put(w, ",", 1);
+            }
+            put_str(w, extra);
+        }
+        put(w, "}", 1);
+    }
+    put(w, " ", 1);
+}
+
+void metrics_write_sample(metrics_writer_t *w, const char *name, const char *labels, double value)
+{
+    put_sample_name(w, name, NULL, labels, NULL);
+    put_value(w, METRICS_DOUBLE, &value);
+}
+
+static void put_histogram(metrics_writer_t *w, const char *name, const char *labels, const metrics_histogram_t *h)
+{
+    char le[32];
+    uint32_t cumulative = 0;
+    for (int i = 0; i < h->count; i++) {
+        cumulative += h->buckets[i];
+        int n = snprintf(le, sizeof(le), "le=\"");
+        n += format_double(&le[n], sizeof(le) - n, h->bounds[i], 15);
+        snprintf(&le[n], sizeof(le) - n, "\"");
+        put_sample_name(w, name, "_bucket", labels, le);
+        put_value(w, METRICS_U32, &cumulative);
+    }
+    uint32_t observations = h->observations;
+    put_sample_name(w, name, "_bucket", labels, "le=\"+Inf\"");
+    put_value(w, METRICS_U32, &observations);
+    double sum = h->sum;
+    put_sample_name(w, name, "_sum", labels, NULL);
+    put_value(w, METRICS_DOUBLE, &sum);
+    put_sample_name(w, name, "_count", labels, NULL);
+    put_value(w, METRICS_U32, &observations);
+}
+
+esp_err_t metrics_render(metrics_writer_t *w)
+{
+    series_view_t views[METRICS_MAX_SERIES];
+    collector_t collecting[METRICS_MAX_COLLECTORS];
+
+    // Nothing is sent under the lock: a slow client must not hold up a task registering its metrics
+    pthread_mutex_lock(&registry_lock);
+    uint8_t families_seen = family_count;
+    uint8_t series_seen = series_count;
+    uint8_t collectors_seen = collector_count;
+    for (int i = 0; i < series_seen; i++) {
+        views[i] = (series_view_t) {
+            .family = series[i].family,
+            .source = series[i].source,
+            .value = series[i].value,
+            .histogram = series[i].histogram,
+        };
+    }
+    memcpy(collecting, collectors, collectors_seen * sizeof(collector_t));
+    pthread_mutex_unlock(&registry_lock);
+
+    // Every series of a family goes under one header, whatever order they were registered in
+    for (int f = 0; f < families_seen && w->err == ESP_OK; f++) {
+        metrics_write_family(w, families[f].name, families[f].type, families[f].help);
+        for (int i = 0; i < series_seen; i++) {
+            const series_view_t *v = &views[i];
+            if (v->family != f) {
+                continue;
+            }
+            if (v->histogram != NULL) {
+                put_histogram(w, families[f].name, series[i].labels, v->histogram);
+            } else {
+                put(w, series[i].prefix, series[i].prefix_len);
+                put_value(w, v->source, v->value);
+            }
+        }
+    }
+    for (int i = 0; i < collectors_seen && w->err == ESP_OK; i++) {
+        collecting[i].collect(w, collecting[i].ctx);
+    }
+
+    if (w->err == ESP_OK && w->len > 0) {
+        w->err = w->flush ? w->flush(w->ctx, w->buf, w->len) : ESP_ERR_INVALID_STATE;
+        w->len = 0;
+    }
+    return w->err;
+}
+
+size_t metrics_escape_label(char *out, size_t size, const char *value)
+{
+    if (size == 0) {
+        return 0;
+    }
+    size_t len = 0;
+    for (; value != NULL && *value != '\0'; value++) {
+        const char *esc = NULL;
+        if (*value == '\\') esc = "\\\\";
+        else if (*value == '"') esc = "\\\"";
+        else if (*value == '\n') esc = "\\n";
+        size_t need = esc ? 2 : 1;
+        if (len + need >= size) {
+            break;
+        }
+        if (esc) {
+            memcpy(&out[len], esc, 2);
+        } else {
+            out[len] = *value;
+        }
+        len += need;
+    }
+    out[len] = '\0';
+    return len;
+}
@@ -0,0 +1,132 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Metrics registry rendered as Prometheus text at /metrics. Subsystems
+// register the variables they already keep once at startup, and a scrape
+// prints each value behind its name and labels, formatted once at
+// registration, straight into the chunked response. Values that only exist
+// at scrape time (uptime, cluster slaves) come from collectors.
+//
+// Registering the same name and labels again points the series at the new
+// variable. Names and help texts must be string literals; labels are copied.
+
+#define METRICS_MAX_FAMILIES    64
+#define METRICS_MAX_SERIES      96
+#define METRICS_MAX_COLLECTORS  4
+#define METRICS_MAX_BUCKETS     12
+#define METRICS_LABELS_SIZE     48
+#define METRICS_PREFIX_SIZE     96      // "name{labels} "
+
+#define METRICS_CONTENT_TYPE    "text/plain; version=0.0.4; charset=utf-8"
+
+typedef enum {
+    METRICS_COUNTER,
+    METRICS_GAUGE,
+    METRICS_HISTOGRAM,
+} metrics_type_t;
+
+// What a registered pointer points at
+typedef enum {
+    METRICS_FLOAT,
+    METRICS_DOUBLE,
+    METRICS_BOOL,
+    METRICS_U8,
+    METRICS_U16,
+    METRICS_U32,
+    METRICS_U64,
+    METRICS_I32,
+    METRICS_I64,
+} metrics_source_t;
+
+/**
+ * @brief A distribution; observed by its owner, read by scrapes
+ */
+typedef struct {
+    const double    *bounds;            // Upper bounds, ascending; +Inf is implied
+    uint8_t         count;
+    uint32_t        buckets[METRICS_MAX_BUCKETS];   // Per bucket, not cumulative
+    uint32_t        observations;
+    double          sum;
+} metrics_histogram_t;
+
+/**
+ * @brief Take a full buffer (or the tail at the end)
+ * @return ESP_OK, or an error that stops the scrape
+ */
+typedef esp_err_t (*metrics_flush_t)(void *ctx, const char *data, size_t len);
+
+typedef struct {
+    char            *buf;
+    size_t          cap;
+    size_t          len;                // Bytes waiting in buf
+    size_t          total;              // Bytes written so far, flushed or not
+    metrics_flush_t flush;
+    void            *ctx;
+    esp_err_t       err;                // Sticky
+} metrics_writer_t;
+
+typedef void (*metrics_collect_fn)(metrics_writer_t *w, void *ctx);
+
+/**
+ * @brief Register a counter or gauge series
+ *
+ * @param labels Preformatted label pairs, e.g. asic="0", or NULL
+ * @return ESP_ERR_INVALID_ARG if the name is taken by another type,
+ *         ESP_ERR_NO_MEM if the registry is full
+ */
+esp_err_t metrics_register(const char *name, metrics_type_t type, const char *help, const char *labels,
+                           metrics_source_t source, const volatile void *value);
+
+esp_err_t metrics_register_histogram(const char *name, const char *help, const char *labels,
+                                     metrics_histogram_t *histogram);
+
+esp_err_t metrics_register_collector(metrics_collect_fn collect, void *ctx);
+
+/**
+ * @brief Forget everything registered, for tests; not while a scrape runs
+ */
+void metrics_reset(void);
+
+void metrics_histogram_init(metrics_histogram_t *histogram, const double *bounds, uint8_t count);
+void metrics_observe(metrics_histogram_t *histogram, double value);
+
+/**
+ * @brief Start a scrape
+ * @param buf Scratch buffer; its size is the chunk size
+ */
+void metrics_writer_init(metrics_writer_t *w, char *buf, size_t cap, metrics_flush_t flush, void *ctx);
+
+/**
+ * @brief Write every registered series, then every collector's, and flush
+ *
+ * The registry is copied under its lock and rendered after releasing it,
+ * so flushes and collectors may take their time, or register metrics;
+ * series registered meanwhile appear in the next scrape.
+ *
+ * @return ESP_OK or the first flush error
+ */
+esp_err_t metrics_render(metrics_writer_t *w);
+
+/**
+ * @brief For collectors: the # HELP and # TYPE lines of a family
+ */
+void metrics_write_family(metrics_writer_t *w, const char *name, metrics_type_t type, const char *help);
+
+/**
+ * @brief For collectors: one sample line
+ * @param labels Preformatted label pairs, or NULL
+ */
+void metrics_write_sample(metrics_writer_t *w, const char *name, const char *labels, double value);
+
+/**
+ * @brief Escape a label value (backslash, quote, newline)
+ * @return Length written
+ */
+size_t metrics_escape_label(char *out, size_t size, const char *value);
+
+#endif // METRICS_H
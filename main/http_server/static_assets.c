@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "static_assets.h"
+
+// FNV-1a over the path, up to a query string
+static uint32_t hash_path(const char *path, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t) path[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Next space-separated field; the separator becomes the terminator
+static char *next_field(char **cursor, bool last)
+{
+    char *start = *cursor;
+    if (*start == '\0') {
+        return NULL;
+    }
+    if (last) {
+        *cursor = start + strlen(start);
+        return start;
+    }
+    char *space = strchr(start, ' ');
+    if (space == NULL) {
+        return NULL;
+    }
+    *space = '\0';
+    *cursor = space + 1;
+    return start;
+}
+
+static esp_err_t parse_line(char *line, static_asset_t *asset)
+{
+    char *cursor = line;
+    char *etag = next_field(&cursor, false);
+    char *size = next_field(&cursor, false);
+    char *flags = next_field(&cursor, false);
+    char *mime = next_field(&cursor, false);
+    char *path = next_field(&cursor, true);
+    if (etag == NULL || size == NULL || flags == NULL || mime == NULL || path == NULL ||
+        path[0] != '/' || strlen(etag) + 3 > sizeof(asset->etag)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char *end;
+    unsigned long bytes = strtoul(size, &end, 10);
+    if (*end != '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(asset, 0, sizeof(*asset));
+    snprintf(asset->etag, sizeof(asset->etag), "\"%s\"", etag);
+    asset->size = bytes;
+    asset->mime = mime;
+    asset->path = path;
+    for (const char *f = flags; *f; f++) {
+        if (*f == 'g') asset->flags |= STATIC_ASSET_GZIP;
+        else if (*f == 'i') asset->flags |= STATIC_ASSET_IMMUTABLE;
+    }
+    return ESP_OK;
+}
+
+esp_err_t static_assets_load(static_assets_t *index, char *text)
+{
+    memset(index, 0, sizeof(*index));
+    if (text == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    index->text = text;
+
+    size_t lines = 1;
+    for (const char *p = text; *p; p++) {
+        lines += (*p == '\n');
+    }
+    if (lines > UINT16_MAX / 2) {
+        static_assets_free(index);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    index->assets = calloc(lines, sizeof(static_asset_t));
+    if (index->assets == NULL) {
+        static_assets_free(index);
+        return ESP_ERR_NO_MEM;
+    }
+
+    char *line = text;
+    while (line != NULL && *line != '\0') {
+        char *newline = strchr(line, '\n');
+        if (newline != NULL) {
+            *newline = '\0';
+        }
+        size_t len = strlen(line);
+        if (len > 0 && line[len - 1] == '\r') {
+            line[--len] = '\0';
+        }
+        if (len > 0 && line[0] != '#') {
+            if (parse_line(line, &index->assets[index->count]) != ESP_OK) {
+                static_assets_free(index);
+                return ESP_ERR_INVALID_ARG;
+            }
+            index->count++;
+        }
+        line = newline ? newline + 1 : NULL;
+    }
+
+    // At most half full, so probes stay short
+    uint16_t size = 8;
+    while (size < index->count * 2) {
+        size *= 2;
+    }
+    index->table = calloc(size, sizeof(uint16_t));
+    if (index->table == NULL) {
+        static_assets_free(index);
+        return ESP_ERR_NO_MEM;
+    }
+    index->table_size = size;
+
+    for (uint16_t i = 0; i < index->count; i++) {
+        const char *path = index->assets[i].path;
+        uint32_t slot = hash_path(path, strlen(path)) & (size - 1);
+        while (index->table[slot] != 0) {
+            slot = (slot + 1) & (size - 1);
+        }
+        index->table[slot] = i + 1;
+    }
+    return ESP_OK;
+}
+
+void static_assets_free(static_assets_t *index)
+{
+    free(index->assets);
+    free(index->table);
+    free(index->text);
+    memset(index, 0, sizeof(*index));
+}
+
+static_asset_t *static_assets_find(const static_assets_t *index, const char *uri)
+{
+    if (index->table == NULL || uri == NULL || uri[0] != '/') {
+        return NULL;
+    }
+
+    size_t len = strcspn(uri, "?#");
+    if (len > 0 && uri[len - 1] == '/') {
+        // Directory: its index.html, as the handler always served it
+        char path[len + sizeof("index.html")];
+        memcpy(path, uri, len);
+        strcpy(&path[len], "index.html");
+        return static_assets_find(index, path);
+    }
+
+    uint32_t slot = hash_path(uri, len) & (index->table_size - 1);
+    while (index->table[slot] != 0) {
+        static_asset_t *asset = &index->assets[index->table[slot] - 1];
+        if (strncmp(asset->path, uri, len) == 0 && asset->path[len] == '\0') {
+            return asset;
+        }
+        slot = (slot + 1) & (index->table_size - 1);
+    }
+    return NULL;
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool static_assets_file_path(const static_asset_t *asset, const char *base_path, char *out, size_t size)
+{
+    size_t len = strlen(base_path);
+    if (len >= size) {
+        return false;
+    }
+    memcpy(out, base_path, len);
+
+    for (const char *p = asset->path; *p; p++) {
+        char c = *p;
+        if (c == '%' && hex_value(p[1]) >= 0 && hex_value(p[2]) >= 0) {
+            c = (char) (hex_value(p[1]) * 16 + hex_value(p[2]));
+            p += 2;
+        }
+        if (len + 1 >= size) {
+            return false;
+        }
+        out[len++] = c;
+    }
+    out[len] = '\0';
+
+    if (asset->flags & STATIC_ASSET_GZIP) {
+        if (len + sizeof(".gz") > size) {
+            return false;
+        }
+        strcpy(&out[len], ".gz");
+    }
+    return true;
+}
+
+bool static_assets_etag_matches(const char *if_none_match, const char *etag)
+{
+    if (if_none_match == NULL || etag == NULL) {
+        return false;
+    }
+    size_t etag_len = strlen(etag);
+
+    const char *p = if_none_match;
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == ',') {
+            p++;
+        }
+        if (*p == '*') {
+            return true;
+        }
+        if (p[0] == 'W' && p[1] == '/') {
+            p += 2;
+        }
+        if (*p != '"') {
+            // Not a tag; skip to the next list entry
+            p += strcspn(p, ",");
+            continue;
+        }
+        const char *close = strchr(p + 1, '"');
+        if (close == NULL) {
+            return false;
+        }
+        size_t len = close - p + 1;
+        if (len == etag_len && memcmp(p, etag, len) == 0) {
+            return true;
+        }
+        p = close + 1;
+    }
+    return false;
+}
+
+const char *static_assets_cache_control(const static_asset_t *asset)
+{
+    if (asset->flags & STATIC_ASSET_IMMUTABLE) {
+        return "public, max-age=31536000, immutable";
+    }
+    return "no-cache";
+}
@@ -0,0 +1,81 @@
+#ifndef STATIC_ASSETS_H
+#define STATIC_ASSETS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// In-RAM index of the web UI files, loaded from /assets.txt in the www
+// partition (written by axe-os/generate-manifest.js), so a request is
+// answered with an ETag check or a single open() instead of probing flash.
+//
+// One line per file, fields separated by one space, path last:
+//
+//     <etag> <size> <flags> <mime> <path>
+//
+// flags is "-" or any of 'g' (stored as path.gz, sent gzip-encoded) and 'i'
+// (the name carries a build hash, cache forever). Lines starting with '#'
+// are comments.
+
+#define STATIC_ASSETS_MANIFEST      "/assets.txt"
+#define STATIC_ASSETS_ETAG_SIZE     24      // Quoted, e.g. "1f3a9c0d2b4e6a78"
+
+#define STATIC_ASSET_GZIP           0x01
+#define STATIC_ASSET_IMMUTABLE      0x02
+
+typedef struct {
+    const char      *path;              // Request path, e.g. /main.3f2a....js
+    const char      *mime;
+    char            etag[STATIC_ASSETS_ETAG_SIZE];
+    uint32_t        size;               // Bytes stored, compressed if gzip
+    uint8_t         flags;
+    const uint8_t   *data;              // Contents held in RAM, or NULL
+} static_asset_t;
+
+typedef struct {
+    static_asset_t  *assets;
+    uint16_t        count;
+    uint16_t        *table;             // Open addressing, asset index + 1
+    uint16_t        table_size;         // Power of two
+    char            *text;              // The manifest; paths and types point into it
+} static_assets_t;
+
+/**
+ * @brief Build the index from a manifest
+ *
+ * Parses in place: text is kept and freed with the index.
+ *
+ * @param text Manifest, NUL terminated, allocated with malloc()
+ * @return ESP_ERR_INVALID_ARG on a malformed line, ESP_ERR_NO_MEM
+ */
+esp_err_t static_assets_load(static_assets_t *index, char *text);
+
+void static_assets_free(static_assets_t *index);
+
+/**
+ * @brief Look up a request path; a query string is ignored, "/" means /index.html
+ */
+static_asset_t *static_assets_find(const static_assets_t *index, const char *uri);
+
+/**
+ * @brief File to open for an asset: base path, path with %XX decoded, .gz if stored compressed
+ * @return false if it does not fit
+ */
+bool static_assets_file_path(const static_asset_t *asset, const char *base_path, char *out, size_t size);
+
+/**
+ * @brief Whether an If-None-Match header names this ETag (weak comparison)
+ */
+bool static_assets_etag_matches(const char *if_none_match, const char *etag);
+
+/**
+ * @brief Cache-Control value for an asset
+ *
+ * Hashed names never change content, so browsers keep them for a year
+ * without asking; everything else is revalidated, which the ETag makes a
+ * bodiless 304.
+ */
+const char *static_assets_cache_control(const static_asset_t *asset);
+
+#endif // STATIC_ASSETS_H
@@ -5,58 +5,43 @@
 #include <stdint.h>
 #include <unistd.h>
 #include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "freertos/task.h"
+#include "esp_heap_caps.h"
 #include "esp_log.h"
 #include "esp_http_server.h"
+#include "cJSON.h"
 #include "websocket.h"
+#include "ws_topics.h"
 #include "http_server.h"
+#include "log_task.h"
+#include "cluster_config.h"
+#if CLUSTER_ENABLED && CLUSTER_IS_MASTER
+#include "cluster.h"
+#endif
 
 static const char * TAG = "websocket";
 
-static QueueHandle_t log_queue = NULL;
+#define LOG_FRAME_SIZE 4096
+
+static GlobalState * GLOBAL_STATE = NULL;
 static int clients[MAX_WEBSOCKET_CLIENTS];
+static ws_subscription_t subscriptions[MAX_WEBSOCKET_CLIENTS];
+static uint32_t generations[MAX_WEBSOCKET_CLIENTS];    // Bumped on every change to a slot
 static int active_clients = 0;
 static SemaphoreHandle_t clients_mutex = NULL;
+static ws_topics_t topics;
 
-int log_to_queue(const char *format, va_list args)
-{
-    va_list args_copy;
-    va_copy(args_copy, args);
-
-    // Calculate the required buffer size +1 for \n
-    int needed_size = vsnprintf(NULL, 0, format, args_copy) + 1;
-    va_end(args_copy);
-
-    // Allocate the buffer dynamically
-    char *log_buffer = (char *)calloc(needed_size, sizeof(char));
-    if (log_buffer == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate memory for log buffer");
-        return 0;
-    }
+// What websocket_task works from, copied under the mutex
+typedef struct {
+    int fd;
+    uint32_t generation;
+    ws_subscription_t sub;
+} client_snapshot_t;
 
-    // Format the string into the allocated buffer
-    va_copy(args_copy, args);
-    vsnprintf(log_buffer, needed_size, format, args_copy);
-    va_end(args_copy);
-
-    // Ensure the log message ends with a newline
-    size_t len = strlen(log_buffer);
-    if (len > 0 && log_buffer[len - 1] != '\n') {
-        log_buffer[len] = '\n';
-        log_buffer[len + 1] = '\0';
-    }
-
-    // Print to standard output
-    fputs(log_buffer, stdout);
-
-    // Send to queue for WebSocket broadcasting
-    if (xQueueSendToBack(log_queue, &log_buffer, pdMS_TO_TICKS(100)) != pdPASS) {
-        ESP_LOGW(TAG, "Failed to send log to queue, freeing buffer");
-        free(log_buffer);
-    }
-
-    return 0;
+void websocket_init(GlobalState * global_state)
+{
+    GLOBAL_STATE = global_state;
 }
 
 static esp_err_t add_client(int fd)
@@ -69,11 +54,9 @@ static esp_err_t add_client(int fd)
     esp_err_t ret = ESP_FAIL;
     for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++) {
         if (clients[i] == -1) {
-            if (active_clients == 0) {
-                esp_log_set_vprintf(log_to_queue);
-            }
-
             clients[i] = fd;
+            ws_subscription_init(&subscriptions[i]);
+            generations[i]++;
             active_clients++;
             ESP_LOGI(TAG, "Added WebSocket client, fd: %d, slot: %d", fd, i);
             ret = ESP_OK;
@@ -98,6 +81,7 @@ static void remove_client(int fd)
     for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++) {
         if (clients[i] == fd) {
             clients[i] = -1;
+            generations[i]++;
             active_clients--;
             ESP_LOGI(TAG, "Removed WebSocket client, fd: %d, slot: %d", fd, i);
 
@@ -105,13 +89,99 @@ static void remove_client(int fd)
         }
     }
 
-    if (active_clients == 0) {
-        esp_log_set_vprintf(vprintf);
-    }
 
     xSemaphoreGive(clients_mutex);
 }
 
+static int snapshot_clients(client_snapshot_t * out)
+{
+    int n = 0;
+    if (xSemaphoreTake(clients_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return 0;
+    }
+    for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++) {
+        if (clients[i] != -1) {
+            out[n].fd = clients[i];
+            out[n].generation = generations[i];
+            out[n].sub = subscriptions[i];
+            n++;
+        }
+    }
+    xSemaphoreGive(clients_mutex);
+    return n;
+}
+
+static void apply_topic_list(ws_subscription_t * sub, const cJSON * list, bool add)
+{
+    const cJSON * item;
+    cJSON_ArrayForEach(item, list) {
+        ws_topic_id_t topic = ws_topics_find(cJSON_GetStringValue(item));
+        if (topic == WS_TOPIC_COUNT) {
+            continue;
+        }
+        if (add) {
+            ws_subscription_add(sub, topic);
+        } else {
+            ws_subscription_remove(sub, topic);
+        }
+    }
+}
+
+/**
+ * @brief Apply {"subscribe": [...], "unsubscribe": [...], "rate": ms} and
+ *        answer with what the client now gets
+ */
+static esp_err_t handle_command(httpd_req_t * req, const char * text)
+{
+    int fd = httpd_req_to_sockfd(req);
+    cJSON * command = cJSON_Parse(text);
+    cJSON * reply = cJSON_CreateObject();
+
+    if (!cJSON_IsObject(command)) {
+        cJSON_AddStringToObject(reply, "error", "Expected {\"subscribe\": [topics], \"rate\": ms}");
+    } else if (xSemaphoreTake(clients_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++) {
+            if (clients[i] != fd) {
+                continue;
+            }
+            ws_subscription_t * sub = &subscriptions[i];
+            apply_topic_list(sub, cJSON_GetObjectItem(command, "subscribe"), true);
+            apply_topic_list(sub, cJSON_GetObjectItem(command, "unsubscribe"), false);
+            const cJSON * rate = cJSON_GetObjectItem(command, "rate");
+            if (cJSON_IsNumber(rate) && rate->valuedouble > 0) {
+                ws_subscription_set_rate(sub, (uint32_t) rate->valuedouble);
+            }
+            generations[i]++;
+
+            cJSON * list = cJSON_AddArrayToObject(reply, "subscribed");
+            for (int topic = 0; topic < WS_TOPIC_COUNT; topic++) {
+                if (sub->topics & (1u << topic)) {
+                    cJSON_AddItemToArray(list, cJSON_CreateString(ws_topics_name(topic)));
+                }
+            }
+            cJSON_AddNumberToObject(reply, "rate", ws_subscription_rate(sub));
+            break;
+        }
+        xSemaphoreGive(clients_mutex);
+    }
+    cJSON_Delete(command);
+
+    char * out = cJSON_PrintUnformatted(reply);
+    cJSON_Delete(reply);
+    if (out == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    httpd_ws_frame_t ws_pkt = {
+        .type = HTTPD_WS_TYPE_TEXT,
+        .payload = (uint8_t *) out,
+        .len = strlen(out),
+    };
+    esp_err_t ret = httpd_ws_send_frame(req, &ws_pkt);
+    free(out);
+    return ret;
+}
+
 void websocket_close_fn(httpd_handle_t hd, int fd)
 {
     ESP_LOGI(TAG, "WebSocket client disconnected, fd: %d", fd);
@@ -166,7 +236,8 @@ esp_err_t websocket_handler(httpd_req_t *req)
         return ret;
     }
 
-    uint8_t *buf = (uint8_t *)calloc(ws_pkt.len, sizeof(uint8_t));
+    // One more for the terminator text commands get
+    uint8_t *buf = (uint8_t *)calloc(ws_pkt.len + 1, sizeof(uint8_t));
     if (buf == NULL) {
         ESP_LOGE(TAG, "Failed to allocate memory for WebSocket frame buffer");
         remove_client(httpd_req_to_sockfd(req));
@@ -200,19 +271,10 @@ esp_err_t websocket_handler(httpd_req_t *req)
     } else if (ws_pkt.type == HTTPD_WS_TYPE_PONG) {
         ESP_LOGD(TAG, "Received PONG");
     } else if (ws_pkt.type == HTTPD_WS_TYPE_TEXT) {
-        // Handle text messages - currently just echo for debugging
-        // Add null terminator for safe string operations
-        if (ws_pkt.len < ws_pkt.len + 1) {
-            buf[ws_pkt.len] = '\0';
-            ESP_LOGI(TAG, "Received text message (%d bytes): %s", ws_pkt.len, buf);
-
-            // Echo the message back (for debugging/testing)
-            // In production, you might want to parse JSON commands here
-            // Example: {"cmd": "restart"}, {"cmd": "get_status"}, etc.
-            ret = httpd_ws_send_frame(req, &ws_pkt);
-            if (ret != ESP_OK) {
-                ESP_LOGE(TAG, "Failed to echo message: %s", esp_err_to_name(ret));
-            }
+        buf[ws_pkt.len] = '\0';
+        ret = handle_command(req, (const char *)buf);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to answer command: %s", esp_err_to_name(ret));
         }
     } else if (ws_pkt.type == HTTPD_WS_TYPE_BINARY) {
         ESP_LOGW(TAG, "Received binary message (%d bytes) - not supported", ws_pkt.len);
@@ -222,17 +284,215 @@ esp_err_t websocket_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
+static void send_logs(httpd_handle_t https_handle, const client_snapshot_t * snap, int n, const char * text, size_t len)
+{
+    for (int i = 0; i < n; i++) {
+        if (!(snap[i].sub.topics & (1u << WS_TOPIC_LOGS))) {
+            continue;
+        }
+        httpd_ws_frame_t ws_pkt;
+        memset(&ws_pkt, 0, sizeof(httpd_ws_frame_t));
+        ws_pkt.payload = (uint8_t *)text;
+        ws_pkt.len = len;
+        ws_pkt.type = HTTPD_WS_TYPE_TEXT;
+
+        if (httpd_ws_send_frame_async(https_handle, snap[i].fd, &ws_pkt) != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to send WebSocket frame to fd: %d", snap[i].fd);
+            remove_client(snap[i].fd);
+        }
+    }
+}
+
+// Lines logged since the last tick, formatted once and sent as one frame (or a few) per client
+static void send_new_logs(httpd_handle_t https_handle, uint32_t * cursor, char * frame)
+{
+    const log_ring_t * ring = log_task_ring();
+    if (ring == NULL || frame == NULL) {
+        return;
+    }
+
+    client_snapshot_t snap[MAX_WEBSOCKET_CLIENTS];
+    int n = snapshot_clients(snap);
+    bool wanted = false;
+    for (int i = 0; i < n; i++) {
+        wanted |= (snap[i].sub.topics & (1u << WS_TOPIC_LOGS)) != 0;
+    }
+    if (!wanted) {
+        *cursor = log_ring_head(ring);
+        return;
+    }
+
+    log_record_t record;
+    uint32_t lost = 0;
+    size_t len = 0;
+    while (log_ring_read(ring, cursor, &record, &lost)) {
+        if (LOG_FRAME_SIZE - len < LOG_RING_LINE_SIZE + 32) {
+            send_logs(https_handle, snap, n, frame, len);
+            len = 0;
+        }
+        if (lost > 0) {
+            len += snprintf(frame + len, LOG_FRAME_SIZE - len, "--- %lu log lines lost ---\n", (unsigned long) lost);
+            lost = 0;
+        }
+        len += log_ring_format(&record, frame + len, LOG_FRAME_SIZE - len);
+    }
+    if (len > 0) {
+        send_logs(https_handle, snap, n, frame, len);
+    }
+}
+
+static void sample_topics(uint32_t wanted)
+{
+    SystemModule * sys = &GLOBAL_STATE->SYSTEM_MODULE;
+    PowerManagementModule * pm = &GLOBAL_STATE->POWER_MANAGEMENT_MODULE;
+    double cluster_hashrate = sys->current_hashrate;
+    double cluster_power = pm->power;
+    double cluster_accepted = sys->shares_accepted;
+    double cluster_rejected = sys->shares_rejected;
+
+#if CLUSTER_ENABLED && CLUSTER_IS_MASTER
+    if (wanted & ~((1u << WS_TOPIC_LOGS) | (1u << WS_TOPIC_SLAVES))) {
+        cluster_stats_t stats;
+        uint8_t active_slaves = 0;
+        cluster_master_get_stats(&stats, &active_slaves);
+        cluster_hashrate = stats.total_hashrate / 100.0;
+        cluster_accepted = stats.total_shares_accepted;
+        cluster_rejected = stats.total_shares_rejected;
+    }
+    if (wanted & ((1u << WS_TOPIC_POWER) | (1u << WS_TOPIC_SLAVES))) {
+        if (wanted & (1u << WS_TOPIC_SLAVES)) {
+            ws_topics_rows_begin(&topics, WS_TOPIC_SLAVES);
+        }
+        for (int i = 0; i < CONFIG_CLUSTER_MAX_SLAVES; i++) {
+            cluster_slave_t slave;
+            if (cluster_master_get_slave_info(i, &slave) != ESP_OK || slave.state == SLAVE_STATE_DISCONNECTED) {
+                continue;
+            }
+            cluster_power += slave.power;
+            if (!(wanted & (1u << WS_TOPIC_SLAVES))) {
+                continue;
+            }
+            int row = ws_topics_row(&topics, WS_TOPIC_SLAVES, i);
+            ws_topics_set_label(&topics, WS_TOPIC_SLAVES, row, slave.hostname);
+            ws_topics_set(&topics, WS_TOPIC_SLAVES, row, WS_SLAVE_STATE, slave.state);
+            ws_topics_set(&topics, WS_TOPIC_SLAVES, row, WS_SLAVE_HASHRATE, slave.hashrate);
+            ws_topics_set(&topics, WS_TOPIC_SLAVES, row, WS_SLAVE_TEMPERATURE, slave.temperature);
+            ws_topics_set(&topics, WS_TOPIC_SLAVES, row, WS_SLAVE_POWER, slave.power);
+            ws_topics_set(&topics, WS_TOPIC_SLAVES, row, WS_SLAVE_FAN_RPM, slave.fan_rpm);
+            ws_topics_set(&topics, WS_TOPIC_SLAVES, row, WS_SLAVE_FREQUENCY, slave.frequency);
+            ws_topics_set(&topics, WS_TOPIC_SLAVES, row, WS_SLAVE_SHARES_ACCEPTED, slave.shares_accepted);
+            ws_topics_set(&topics, WS_TOPIC_SLAVES, row, WS_SLAVE_SHARES_REJECTED, slave.shares_rejected);
+            ws_topics_set(&topics, WS_TOPIC_SLAVES, row, WS_SLAVE_SHARES_INVALID, slave.shares_invalid);
+        }
+        if (wanted & (1u << WS_TOPIC_SLAVES)) {
+            ws_topics_rows_end(&topics, WS_TOPIC_SLAVES);
+        }
+    }
+#endif
+
+    if (wanted & (1u << WS_TOPIC_HASHRATE)) {
+        ws_topics_set(&topics, WS_TOPIC_HASHRATE, 0, WS_HASHRATE_CURRENT, sys->current_hashrate);
+        ws_topics_set(&topics, WS_TOPIC_HASHRATE, 0, WS_HASHRATE_1M, sys->hashrate_1m);
+        ws_topics_set(&topics, WS_TOPIC_HASHRATE, 0, WS_HASHRATE_10M, sys->hashrate_10m);
+        ws_topics_set(&topics, WS_TOPIC_HASHRATE, 0, WS_HASHRATE_1H, sys->hashrate_1h);
+        ws_topics_set(&topics, WS_TOPIC_HASHRATE, 0, WS_HASHRATE_EXPECTED, pm->expected_hashrate);
+        ws_topics_set(&topics, WS_TOPIC_HASHRATE, 0, WS_HASHRATE_ERROR, sys->error_percentage);
+        ws_topics_set(&topics, WS_TOPIC_HASHRATE, 0, WS_HASHRATE_CLUSTER, cluster_hashrate);
+    }
+
+    if (wanted & (1u << WS_TOPIC_POWER)) {
+        // Values the power management task already read: no I2C traffic from here
+        double hashrate_th = sys->current_hashrate / 1000.0;
+        ws_topics_set(&topics, WS_TOPIC_POWER, 0, WS_POWER_POWER, pm->power);
+        ws_topics_set(&topics, WS_TOPIC_POWER, 0, WS_POWER_VOLTAGE, pm->voltage);
+        ws_topics_set(&topics, WS_TOPIC_POWER, 0, WS_POWER_CURRENT, pm->current);
+        ws_topics_set(&topics, WS_TOPIC_POWER, 0, WS_POWER_EFFICIENCY, hashrate_th > 0 ? pm->power / hashrate_th : 0);
+        ws_topics_set(&topics, WS_TOPIC_POWER, 0, WS_POWER_CHIP_TEMP, pm->chip_temp_avg);
+        ws_topics_set(&topics, WS_TOPIC_POWER, 0, WS_POWER_VR_TEMP, pm->vr_temp);
+        ws_topics_set(&topics, WS_TOPIC_POWER, 0, WS_POWER_FREQUENCY, pm->frequency_value);
+        ws_topics_set(&topics, WS_TOPIC_POWER, 0, WS_POWER_FAN_SPEED, pm->fan_perc);
+        ws_topics_set(&topics, WS_TOPIC_POWER, 0, WS_POWER_FAN_RPM, pm->fan_rpm);
+        ws_topics_set(&topics, WS_TOPIC_POWER, 0, WS_POWER_CLUSTER, cluster_power);
+    }
+
+    if (wanted & (1u << WS_TOPIC_SHARES)) {
+        ws_topics_set(&topics, WS_TOPIC_SHARES, 0, WS_SHARES_ACCEPTED, sys->shares_accepted);
+        ws_topics_set(&topics, WS_TOPIC_SHARES, 0, WS_SHARES_REJECTED, sys->shares_rejected);
+        ws_topics_set(&topics, WS_TOPIC_SHARES, 0, WS_SHARES_BEST_DIFF, sys->best_nonce_diff);
+        ws_topics_set(&topics, WS_TOPIC_SHARES, 0, WS_SHARES_BEST_SESSION_DIFF, sys->best_session_nonce_diff);
+        ws_topics_set(&topics, WS_TOPIC_SHARES, 0, WS_SHARES_POOL_DIFFICULTY, GLOBAL_STATE->pool_difficulty);
+        ws_topics_set(&topics, WS_TOPIC_SHARES, 0, WS_SHARES_CLUSTER_ACCEPTED, cluster_accepted);
+        ws_topics_set(&topics, WS_TOPIC_SHARES, 0, WS_SHARES_CLUSTER_REJECTED, cluster_rejected);
+    }
+}
+
+/**
+ * @brief One tick: sample the topics someone wants and send each client
+ *        what changed, if its rate is due
+ */
+static void publish_topics(httpd_handle_t https_handle)
+{
+    client_snapshot_t snap[MAX_WEBSOCKET_CLIENTS];
+    int n = snapshot_clients(snap);
+
+    uint32_t wanted = 0;
+    for (int i = 0; i < n; i++) {
+        wanted |= snap[i].sub.topics;
+    }
+    // Log-only clients cost nothing here
+    if (GLOBAL_STATE == NULL || !(wanted & ~(1u << WS_TOPIC_LOGS))) {
+        return;
+    }
+
+    uint32_t tick = ws_topics_tick(&topics);
+    sample_topics(wanted);
+
+    for (int i = 0; i < n; i++) {
+        bool failed = false;
+        for (int topic = WS_TOPIC_LOGS + 1; topic < WS_TOPIC_COUNT && !failed; topic++) {
+            if (!ws_subscription_due(&snap[i].sub, topic, tick)) {
+                continue;
+            }
+            size_t len = 0;
+            const char * msg = ws_topics_message(&topics, topic, snap[i].sub.sent[topic], &len);
+            if (msg != NULL) {
+                httpd_ws_frame_t ws_pkt = {
+                    .type = HTTPD_WS_TYPE_TEXT,
+                    .payload = (uint8_t *) msg,
+                    .len = len,
+                };
+                if (httpd_ws_send_frame_async(https_handle, snap[i].fd, &ws_pkt) != ESP_OK) {
+                    ESP_LOGW(TAG, "Failed to send topic %s to fd: %d", ws_topics_name(topic), snap[i].fd);
+                    remove_client(snap[i].fd);
+                    failed = true;
+                    break;
+                }
+            }
+            snap[i].sub.sent[topic] = tick;
+        }
+
+        // Keep what was sent, unless the client changed its subscription meanwhile
+        if (!failed && xSemaphoreTake(clients_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            for (int slot = 0; slot < MAX_WEBSOCKET_CLIENTS; slot++) {
+                if (clients[slot] == snap[i].fd && generations[slot] == snap[i].generation) {
+                    memcpy(subscriptions[slot].sent, snap[i].sub.sent, sizeof(subscriptions[slot].sent));
+                }
+            }
+            xSemaphoreGive(clients_mutex);
+        }
+    }
+}
+
 void websocket_task(void *pvParameters)
 {
     ESP_LOGI(TAG, "websocket_task starting");
     httpd_handle_t https_handle = (httpd_handle_t)pvParameters;
 
-    log_queue = xQueueCreateWithCaps(MESSAGE_QUEUE_SIZE, sizeof(char*), MALLOC_CAP_SPIRAM);
-    if (log_queue == NULL) {
-        ESP_LOGE(TAG, "Error creating queue");
-        vTaskDelete(NULL);
-        return;
+    char * frame = heap_caps_malloc(LOG_FRAME_SIZE, MALLOC_CAP_SPIRAM);
+    if (frame == NULL) {
+        ESP_LOGE(TAG, "No memory for log frames");
     }
+    uint32_t log_cursor = 0;
 
     memset(clients, -1, sizeof(clients));
 
@@ -241,33 +501,33 @@ void websocket_task(void *pvParameters)
         ESP_LOGE(TAG, "Failed to create clients mutex");
     }
 
+    if (ws_topics_init(&topics) != ESP_OK) {
+        ESP_LOGE(TAG, "No memory for websocket topics");
+    }
+
+    const TickType_t tick_period = pdMS_TO_TICKS(WS_TOPICS_TICK_MS);
+    TickType_t next_tick = xTaskGetTickCount() + tick_period;
+
     while (true) {
         if (active_clients == 0) {
             vTaskDelay(pdMS_TO_TICKS(100));
+            next_tick = xTaskGetTickCount() + tick_period;
+            // A new client gets lines from when it connects
+            if (log_task_ring() != NULL) {
+                log_cursor = log_ring_head(log_task_ring());
+            }
             continue;
         }
 
-        char *message;
-        if (xQueueReceive(log_queue, &message, pdMS_TO_TICKS(1000)) != pdPASS) {
-            continue;
-        }
-
-        for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++) {
-            int client_fd = clients[i];
-            if (client_fd != -1) {
-                httpd_ws_frame_t ws_pkt;
-                memset(&ws_pkt, 0, sizeof(httpd_ws_frame_t));
-                ws_pkt.payload = (uint8_t *)message;
-                ws_pkt.len = strlen(message);
-                ws_pkt.type = HTTPD_WS_TYPE_TEXT;
-
-                if (httpd_ws_send_frame_async(https_handle, client_fd, &ws_pkt) != ESP_OK) {
-                    ESP_LOGW(TAG, "Failed to send WebSocket frame to fd: %d", client_fd);
-                    remove_client(client_fd);
-                }
-            }
+        TickType_t now = xTaskGetTickCount();
+        if ((int32_t)(next_tick - now) > 0) {
+            vTaskDelay(next_tick - now);
+            now = xTaskGetTickCount();
         }
+        // Skip ticks rather than bursting to catch up
+        next_tick = ((int32_t)(now - next_tick) < (int32_t)tick_period) ? next_tick + tick_period : now + tick_period;
 
-        free(message);
+        send_new_logs(https_handle, &log_cursor, frame);
+        publish_topics(https_handle);
     }
 }
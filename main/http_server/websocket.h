@@ -2,10 +2,13 @@
 #define WEBSOCKET_H_
 
 #include "esp_err.h"
+#include "esp_http_server.h"
+#include "global_state.h"
 
-#define MESSAGE_QUEUE_SIZE (128)
 #define MAX_WEBSOCKET_CLIENTS (10)
 
+// Metric topics read the miner's state from here
+void websocket_init(GlobalState * global_state);
 esp_err_t websocket_handler(httpd_req_t * req);
 void websocket_task(void * pvParameters);
 void websocket_close_fn(httpd_handle_t hd, int sockfd);
@@ -0,0 +1,439 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ws_topics.h"
+#include "json_stream.h"
+
+typedef struct {
+    const char  *key;
+    uint8_t     decimals;               // Sent and compared at this precision
+} ws_field_t;
+
+typedef struct {
+    const char          *name;
+    const ws_field_t    *fields;
+    uint8_t             field_count;
+    const char          *label_key;     // Keyed topics only
+} ws_topic_def_t;
+
+// Keys and units as /api/system/info and /api/cluster/status have them; cluster* totals are new
+static const ws_field_t hashrate_fields[WS_HASHRATE_FIELDS] = {
+    [WS_HASHRATE_CURRENT]   = { "hashRate", 2 },
+    [WS_HASHRATE_1M]        = { "hashRate_1m", 2 },
+    [WS_HASHRATE_10M]       = { "hashRate_10m", 2 },
+    [WS_HASHRATE_1H]        = { "hashRate_1h", 2 },
+    [WS_HASHRATE_EXPECTED]  = { "expectedHashrate", 2 },
+    [WS_HASHRATE_ERROR]     = { "errorPercentage", 2 },
+    [WS_HASHRATE_CLUSTER]   = { "clusterHashrate", 2 },      // GH/s, master and slaves
+};
+
+static const ws_field_t power_fields[WS_POWER_FIELDS] = {
+    [WS_POWER_POWER]        = { "power", 2 },
+    [WS_POWER_VOLTAGE]      = { "voltage", 0 },
+    [WS_POWER_CURRENT]      = { "current", 0 },
+    [WS_POWER_EFFICIENCY]   = { "efficiency", 2 },
+    [WS_POWER_CHIP_TEMP]    = { "temp", 1 },
+    [WS_POWER_VR_TEMP]      = { "vrTemp", 1 },
+    [WS_POWER_FREQUENCY]    = { "frequency", 0 },
+    [WS_POWER_FAN_SPEED]    = { "fanspeed", 0 },
+    [WS_POWER_FAN_RPM]      = { "fanrpm", 0 },
+    [WS_POWER_CLUSTER]      = { "clusterPower", 1 },
+};
+
+static const ws_field_t shares_fields[WS_SHARES_FIELDS] = {
+    [WS_SHARES_ACCEPTED]            = { "sharesAccepted", 0 },
+    [WS_SHARES_REJECTED]            = { "sharesRejected", 0 },
+    [WS_SHARES_BEST_DIFF]           = { "bestDiff", 0 },
+    [WS_SHARES_BEST_SESSION_DIFF]   = { "bestSessionDiff", 0 },
+    [WS_SHARES_POOL_DIFFICULTY]     = { "poolDifficulty", 0 },
+    [WS_SHARES_CLUSTER_ACCEPTED]    = { "clusterSharesAccepted", 0 },
+    [WS_SHARES_CLUSTER_REJECTED]    = { "clusterSharesRejected", 0 },
+};
+
+static const ws_field_t slave_fields[WS_SLAVE_FIELDS] = {
+    [WS_SLAVE_STATE]            = { "state", 0 },
+    [WS_SLAVE_HASHRATE]         = { "hashrate", 0 },         // GH/s * 100
+    [WS_SLAVE_TEMPERATURE]      = { "temperature", 1 },
+    [WS_SLAVE_POWER]            = { "power", 1 },
+    [WS_SLAVE_FAN_RPM]          = { "fanRpm", 0 },
+    [WS_SLAVE_FREQUENCY]        = { "frequency", 0 },
+    [WS_SLAVE_SHARES_ACCEPTED]  = { "sharesAccepted", 0 },
+    [WS_SLAVE_SHARES_REJECTED]  = { "sharesRejected", 0 },
+    [WS_SLAVE_SHARES_INVALID]   = { "sharesInvalid", 0 },
+};
+
+static const ws_topic_def_t topic_defs[WS_TOPIC_COUNT] = {
+    [WS_TOPIC_LOGS]     = { "logs", NULL, 0, NULL },
+    [WS_TOPIC_HASHRATE] = { "hashrate", hashrate_fields, WS_HASHRATE_FIELDS, NULL },
+    [WS_TOPIC_POWER]    = { "power", power_fields, WS_POWER_FIELDS, NULL },
+    [WS_TOPIC_SHARES]   = { "shares", shares_fields, WS_SHARES_FIELDS, NULL },
+    [WS_TOPIC_SLAVES]   = { "slaves", slave_fields, WS_SLAVE_FIELDS, "hostname" },
+};
+
+static bool is_metric(ws_topic_id_t topic)
+{
+    return topic > WS_TOPIC_LOGS && topic < WS_TOPIC_COUNT;
+}
+
+static bool is_keyed(ws_topic_id_t topic)
+{
+    return topic_defs[topic].label_key != NULL;
+}
+
+// ============================================================================
+// Topics
+// ============================================================================
+
+esp_err_t ws_topics_init(ws_topics_t *t)
+{
+    memset(t, 0, sizeof(*t));
+
+    for (int topic = WS_TOPIC_LOGS + 1; topic < WS_TOPIC_COUNT; topic++) {
+        ws_topic_t *tp = &t->topics[topic];
+        tp->max_rows = is_keyed(topic) ? WS_TOPIC_MAX_ROWS : 1;
+        tp->rows = calloc(tp->max_rows, sizeof(ws_row_t));
+        if (tp->rows == NULL) {
+            ws_topics_deinit(t);
+            return ESP_ERR_NO_MEM;
+        }
+        if (!is_keyed(topic)) {
+            tp->rows[0].present = true;
+        }
+    }
+    return ESP_OK;
+}
+
+static void drop_cache(ws_topic_t *tp)
+{
+    for (int i = 0; i < tp->cached; i++) {
+        free(tp->cache[i].msg);
+    }
+    tp->cached = 0;
+    tp->next_evict = 0;
+}
+
+void ws_topics_deinit(ws_topics_t *t)
+{
+    for (int topic = 0; topic < WS_TOPIC_COUNT; topic++) {
+        drop_cache(&t->topics[topic]);
+        free(t->topics[topic].rows);
+        t->topics[topic].rows = NULL;
+    }
+}
+
+ws_topic_id_t ws_topics_find(const char *name)
+{
+    for (int topic = 0; topic < WS_TOPIC_COUNT; topic++) {
+        if (name != NULL && strcmp(name, topic_defs[topic].name) == 0) {
+            return topic;
+        }
+    }
+    return WS_TOPIC_COUNT;
+}
+
+const char *ws_topics_name(ws_topic_id_t topic)
+{
+    return (topic < WS_TOPIC_COUNT) ? topic_defs[topic].name : NULL;
+}
+
+uint32_t ws_topics_tick(ws_topics_t *t)
+{
+    for (int topic = 0; topic < WS_TOPIC_COUNT; topic++) {
+        drop_cache(&t->topics[topic]);
+    }
+    return ++t->tick;
+}
+
+static double quantize(double value, uint8_t decimals)
+{
+    static const double scale[] = { 1, 10, 100, 1000, 10000 };
+    double s = scale[decimals < 4 ? decimals : 4];
+    return round(value * s) / s;
+}
+
+void ws_topics_set(ws_topics_t *t, ws_topic_id_t topic, int row, int field, double value)
+{
+    if (!is_metric(topic) || row < 0 || row >= t->topics[topic].max_rows ||
+        field < 0 || field >= topic_defs[topic].field_count) {
+        return;
+    }
+
+    ws_row_t *r = &t->topics[topic].rows[row];
+    double q = isfinite(value) ? quantize(value, topic_defs[topic].fields[field].decimals) : 0;
+    if (r->value_tick[field] == 0 || r->values[field] != q) {
+        r->values[field] = q;
+        r->value_tick[field] = t->tick;
+    }
+}
+
+void ws_topics_rows_begin(ws_topics_t *t, ws_topic_id_t topic)
+{
+    if (!is_metric(topic) || !is_keyed(topic)) {
+        return;
+    }
+    ws_topic_t *tp = &t->topics[topic];
+    for (int i = 0; i < tp->max_rows; i++) {
+        tp->rows[i].seen = false;
+    }
+}
+
+int ws_topics_row(ws_topics_t *t, ws_topic_id_t topic, int32_t id)
+{
+    if (!is_metric(topic)) {
+        return -1;
+    }
+    if (!is_keyed(topic)) {
+        return 0;
+    }
+
+    ws_topic_t *tp = &t->topics[topic];
+    int free_row = -1;
+    for (int i = 0; i < tp->max_rows; i++) {
+        ws_row_t *r = &tp->rows[i];
+        if (r->present && r->id == id) {
+            r->seen = true;
+            return i;
+        }
+        // Rows never used first, then the one removed longest ago: clients have most likely had its null
+        if (!r->present && (free_row < 0 || r->present_tick < tp->rows[free_row].present_tick)) {
+            free_row = i;
+        }
+    }
+    if (free_row < 0) {
+        return -1;
+    }
+
+    ws_row_t *r = &tp->rows[free_row];
+    memset(r, 0, sizeof(*r));
+    r->id = id;
+    r->present = true;
+    r->seen = true;
+    r->present_tick = t->tick;
+    r->label_tick = t->tick;
+    return free_row;
+}
+
+void ws_topics_rows_end(ws_topics_t *t, ws_topic_id_t topic)
+{
+    if (!is_metric(topic) || !is_keyed(topic)) {
+        return;
+    }
+    ws_topic_t *tp = &t->topics[topic];
+    for (int i = 0; i < tp->max_rows; i++) {
+        ws_row_t *r = &tp->rows[i];
+        if (r->present && !r->seen) {
+            r->present = false;
+            r->present_tick = t->tick;
+        }
+    }
+}
+
+void ws_topics_set_label(ws_topics_t *t, ws_topic_id_t topic, int row, const char *label)
+{
+    if (!is_metric(topic) || !is_keyed(topic) || row < 0 || row >= t->topics[topic].max_rows || label == NULL) {
+        return;
+    }
+    ws_row_t *r = &t->topics[topic].rows[row];
+    if (strncmp(r->label, label, sizeof(r->label) - 1) != 0) {
+        strncpy(r->label, label, sizeof(r->label) - 1);
+        r->label[sizeof(r->label) - 1] = '\0';
+        r->label_tick = t->tick;
+    }
+}
+
+// ============================================================================
+// Messages
+// ============================================================================
+
+typedef struct {
+    char    *buf;
+    size_t  len;
+    size_t  cap;
+} ws_buffer_t;
+
+static esp_err_t buffer_flush(void *ctx, const char *data, size_t len)
+{
+    ws_buffer_t *b = (ws_buffer_t *)ctx;
+    if (b->len + len + 1 > b->cap) {
+        size_t cap = (b->cap ? b->cap * 2 : 256);
+        while (cap < b->len + len + 1) {
+            cap *= 2;
+        }
+        char *grown = realloc(b->buf, cap);
+        if (grown == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        b->buf = grown;
+        b->cap = cap;
+    }
+    memcpy(b->buf + b->len, data, len);
+    b->len += len;
+    b->buf[b->len] = '\0';
+    return ESP_OK;
+}
+
+/**
+ * @brief Fields of a row changed after since
+ * @return Fields written
+ */
+static int write_fields(json_stream_t *js, const ws_topic_def_t *def, const ws_row_t *r, uint32_t since)
+{
+    int written = 0;
+    for (int f = 0; f < def->field_count; f++) {
+        if (r->value_tick[f] != 0 && (since == 0 || r->value_tick[f] > since)) {
+            json_stream_number(js, def->fields[f].key, r->values[f]);
+            written++;
+        }
+    }
+    return written;
+}
+
+static char *build_message(ws_topics_t *t, ws_topic_id_t topic, uint32_t since, size_t *len)
+{
+    const ws_topic_def_t *def = &topic_defs[topic];
+    const ws_topic_t *tp = &t->topics[topic];
+    const bool full = (since == 0);
+    int changes = 0;
+
+    char chunk[256];
+    ws_buffer_t out = { 0 };
+    json_stream_t js;
+    json_stream_init(&js, chunk, sizeof(chunk), false, buffer_flush, &out);
+
+    json_stream_begin_object(&js, NULL);
+    json_stream_string(&js, "topic", def->name);
+    json_stream_number(&js, "tick", t->tick);
+    json_stream_bool(&js, "full", full);
+    json_stream_begin_object(&js, "data");
+
+    if (!is_keyed(topic)) {
+        changes = write_fields(&js, def, &tp->rows[0], since);
+    } else {
+        for (int i = 0; i < tp->max_rows; i++) {
+            const ws_row_t *r = &tp->rows[i];
+            char key[12];
+            snprintf(key, sizeof(key), "%ld", (long)r->id);
+
+            if (!r->present) {
+                // Gone since the client's last message, and it knew about it
+                if (!full && r->present_tick > since) {
+                    json_stream_null(&js, key);
+                    changes++;
+                }
+                continue;
+            }
+
+            // New rows are sent whole
+            const uint32_t row_since = (r->present_tick > since) ? 0 : since;
+            if (row_since != 0 && r->label_tick <= since && r->present_tick <= since) {
+                bool any = false;
+                for (int f = 0; f < def->field_count && !any; f++) {
+                    any = r->value_tick[f] > since;
+                }
+                if (!any) {
+                    continue;
+                }
+            }
+
+            json_stream_begin_object(&js, key);
+            if (row_since == 0 || r->label_tick > since) {
+                json_stream_string(&js, def->label_key, r->label);
+            }
+            write_fields(&js, def, r, row_since);
+            json_stream_end_object(&js);
+            changes++;
+        }
+    }
+
+    json_stream_end_object(&js);
+    json_stream_end_object(&js);
+
+    if (json_stream_finish(&js) != ESP_OK || (!full && changes == 0)) {
+        free(out.buf);
+        return NULL;
+    }
+    t->serializations++;
+    *len = out.len;
+    return out.buf;
+}
+
+const char *ws_topics_message(ws_topics_t *t, ws_topic_id_t topic, uint32_t since, size_t *len)
+{
+    if (!is_metric(topic) || len == NULL) {
+        return NULL;
+    }
+
+    ws_topic_t *tp = &t->topics[topic];
+    for (int i = 0; i < tp->cached; i++) {
+        if (tp->cache[i].since == since) {
+            *len = tp->cache[i].len;
+            return tp->cache[i].msg;
+        }
+    }
+
+    // Clients at the same rate share since; past WS_TOPIC_CACHE kinds, replace the oldest
+    ws_cached_t *slot;
+    if (tp->cached < WS_TOPIC_CACHE) {
+        slot = &tp->cache[tp->cached++];
+    } else {
+        slot = &tp->cache[tp->next_evict];
+        tp->next_evict = (tp->next_evict + 1) % WS_TOPIC_CACHE;
+        free(slot->msg);
+    }
+
+    slot->since = since;
+    slot->len = 0;
+    slot->msg = build_message(t, topic, since, &slot->len);
+    *len = slot->len;
+    return slot->msg;
+}
+
+// ============================================================================
+// Subscriptions
+// ============================================================================
+
+void ws_subscription_init(ws_subscription_t *sub)
+{
+    memset(sub, 0, sizeof(*sub));
+    sub->topics = 1u << WS_TOPIC_LOGS;
+    ws_subscription_set_rate(sub, WS_TOPICS_DEFAULT_RATE);
+}
+
+void ws_subscription_add(ws_subscription_t *sub, ws_topic_id_t topic)
+{
+    if (topic < WS_TOPIC_COUNT && !(sub->topics & (1u << topic))) {
+        sub->topics |= 1u << topic;
+        sub->sent[topic] = 0;
+    }
+}
+
+void ws_subscription_remove(ws_subscription_t *sub, ws_topic_id_t topic)
+{
+    if (topic < WS_TOPIC_COUNT) {
+        sub->topics &= ~(1u << topic);
+    }
+}
+
+void ws_subscription_set_rate(ws_subscription_t *sub, uint32_t rate_ms)
+{
+    if (rate_ms > WS_TOPICS_MAX_RATE) {
+        rate_ms = WS_TOPICS_MAX_RATE;
+    }
+    uint32_t period = (rate_ms + WS_TOPICS_TICK_MS - 1) / WS_TOPICS_TICK_MS;
+    sub->period = period ? period : 1;
+}
+
+uint32_t ws_subscription_rate(const ws_subscription_t *sub)
+{
+    return (uint32_t)sub->period * WS_TOPICS_TICK_MS;
+}
+
+bool ws_subscription_due(const ws_subscription_t *sub, ws_topic_id_t topic, uint32_t tick)
+{
+    if (!is_metric(topic) || !(sub->topics & (1u << topic))) {
+        return false;
+    }
+    // A new subscription gets its full message on the next tick, then falls into step
+    return sub->sent[topic] == 0 || tick % sub->period == 0;
+}
@@ -0,0 +1,190 @@
+#ifndef WS_TOPICS_H
+#define WS_TOPICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Metric topics pushed over /api/ws. A client sends
+// {"subscribe": ["hashrate", "power"], "rate": 500} and then gets a message
+// per topic whenever something in it changed, at most every rate ms:
+//
+//   {"topic":"power","tick":812,"full":false,"data":{"power":18.42,"temp":61.5}}
+//
+// The first message is full, later ones carry only the fields changed since
+// that client's previous message; rows of keyed topics (slaves) are objects
+// under their id, and null once gone. Values are rounded to their sent
+// precision before being compared. Clients are only sent on ticks that are a
+// multiple of their rate, so each topic is serialized once per tick for all
+// clients at the same rate.
+
+#define WS_TOPICS_TICK_MS       250
+#define WS_TOPICS_DEFAULT_RATE  1000    // ms
+#define WS_TOPICS_MAX_RATE      60000   // ms
+#define WS_TOPIC_MAX_FIELDS     12
+#define WS_TOPIC_MAX_ROWS       16      // Keyed topics
+#define WS_TOPIC_LABEL_SIZE     32
+#define WS_TOPIC_CACHE          4       // Messages per topic per tick, one per distinct "since"
+
+typedef enum {
+    WS_TOPIC_LOGS,              // Log lines as plain text frames, as before topics existed
+    WS_TOPIC_HASHRATE,
+    WS_TOPIC_POWER,
+    WS_TOPIC_SHARES,
+    WS_TOPIC_SLAVES,            // Keyed by slave slot, master only
+    WS_TOPIC_COUNT,
+} ws_topic_id_t;
+
+enum {
+    WS_HASHRATE_CURRENT,
+    WS_HASHRATE_1M,
+    WS_HASHRATE_10M,
+    WS_HASHRATE_1H,
+    WS_HASHRATE_EXPECTED,
+    WS_HASHRATE_ERROR,
+    WS_HASHRATE_CLUSTER,
+    WS_HASHRATE_FIELDS,
+};
+
+enum {
+    WS_POWER_POWER,
+    WS_POWER_VOLTAGE,
+    WS_POWER_CURRENT,
+    WS_POWER_EFFICIENCY,
+    WS_POWER_CHIP_TEMP,
+    WS_POWER_VR_TEMP,
+    WS_POWER_FREQUENCY,
+    WS_POWER_FAN_SPEED,
+    WS_POWER_FAN_RPM,
+    WS_POWER_CLUSTER,
+    WS_POWER_FIELDS,
+};
+
+enum {
+    WS_SHARES_ACCEPTED,
+    WS_SHARES_REJECTED,
+    WS_SHARES_BEST_DIFF,
+    WS_SHARES_BEST_SESSION_DIFF,
+    WS_SHARES_POOL_DIFFICULTY,
+    WS_SHARES_CLUSTER_ACCEPTED,
+    WS_SHARES_CLUSTER_REJECTED,
+    WS_SHARES_FIELDS,
+};
+
+enum {
+    WS_SLAVE_STATE,
+    WS_SLAVE_HASHRATE,
+    WS_SLAVE_TEMPERATURE,
+    WS_SLAVE_POWER,
+    WS_SLAVE_FAN_RPM,
+    WS_SLAVE_FREQUENCY,
+    WS_SLAVE_SHARES_ACCEPTED,
+    WS_SLAVE_SHARES_REJECTED,
+    WS_SLAVE_SHARES_INVALID,
+    WS_SLAVE_FIELDS,
+};
+
+typedef struct {
+    int32_t     id;                     // Keyed topics: slot
+    bool        present;
+    bool        seen;                   // Between ws_topics_rows_begin and _end
+    uint32_t    present_tick;           // Tick it appeared or went
+    char        label[WS_TOPIC_LABEL_SIZE];
+    uint32_t    label_tick;
+    double      values[WS_TOPIC_MAX_FIELDS];
+    uint32_t    value_tick[WS_TOPIC_MAX_FIELDS];    // 0 = never set
+} ws_row_t;
+
+typedef struct {
+    uint32_t    since;
+    char        *msg;                   // NULL: nothing changed since
+    size_t      len;
+} ws_cached_t;
+
+typedef struct {
+    ws_row_t    *rows;
+    uint8_t     max_rows;
+    ws_cached_t cache[WS_TOPIC_CACHE];
+    uint8_t     cached;
+    uint8_t     next_evict;
+} ws_topic_t;
+
+typedef struct {
+    uint32_t    tick;
+    ws_topic_t  topics[WS_TOPIC_COUNT]; // Unused for WS_TOPIC_LOGS
+    uint32_t    serializations;         // Messages built, for the host test
+} ws_topics_t;
+
+/**
+ * @brief What one client gets
+ */
+typedef struct {
+    uint32_t    topics;                 // Bit per ws_topic_id_t
+    uint16_t    period;                 // Ticks between messages
+    uint32_t    sent[WS_TOPIC_COUNT];   // Tick of the last message, 0 = send a full one
+} ws_subscription_t;
+
+esp_err_t ws_topics_init(ws_topics_t *t);
+void ws_topics_deinit(ws_topics_t *t);
+
+/**
+ * @brief Topic by name ("hashrate"), WS_TOPIC_COUNT if unknown
+ */
+ws_topic_id_t ws_topics_find(const char *name);
+const char *ws_topics_name(ws_topic_id_t topic);
+
+/**
+ * @brief Start the next tick: drops the cached messages
+ * @return The new tick, from 1
+ */
+uint32_t ws_topics_tick(ws_topics_t *t);
+
+/**
+ * @brief Set a field of an unkeyed topic, or of a row from ws_topics_row()
+ *
+ * Values are set after ws_topics_tick(), and count as changed in that tick.
+ */
+void ws_topics_set(ws_topics_t *t, ws_topic_id_t topic, int row, int field, double value);
+
+/**
+ * @brief Keyed topics: mark every row unseen, then look up each row that
+ *        still exists with ws_topics_row(); ws_topics_rows_end() removes
+ *        the rest
+ */
+void ws_topics_rows_begin(ws_topics_t *t, ws_topic_id_t topic);
+int ws_topics_row(ws_topics_t *t, ws_topic_id_t topic, int32_t id);
+void ws_topics_rows_end(ws_topics_t *t, ws_topic_id_t topic);
+void ws_topics_set_label(ws_topics_t *t, ws_topic_id_t topic, int row, const char *label);
+
+/**
+ * @brief Message with what changed after tick since, everything if 0
+ *
+ * Built once per topic and since in a tick. The pointer stays valid until
+ * the next ws_topics_tick(), or until WS_TOPIC_CACHE other values of since
+ * have been asked for.
+ *
+ * @return NULL if nothing changed (or out of memory)
+ */
+const char *ws_topics_message(ws_topics_t *t, ws_topic_id_t topic, uint32_t since, size_t *len);
+
+/**
+ * @brief New client: log lines only, at the default rate
+ */
+void ws_subscription_init(ws_subscription_t *sub);
+
+void ws_subscription_add(ws_subscription_t *sub, ws_topic_id_t topic);
+void ws_subscription_remove(ws_subscription_t *sub, ws_topic_id_t topic);
+
+/**
+ * @brief Rate in ms, rounded up to whole ticks and kept to 1 tick..WS_TOPICS_MAX_RATE
+ */
+void ws_subscription_set_rate(ws_subscription_t *sub, uint32_t rate_ms);
+uint32_t ws_subscription_rate(const ws_subscription_t *sub);
+
+/**
+ * @brief Whether a subscribed metric topic goes out on this tick
+ */
+bool ws_subscription_due(const ws_subscription_t *sub, ws_topic_id_t topic, uint32_t tick);
+
+#endif // WS_TOPICS_H
@@ -0,0 +1,379 @@
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "log_ring.h"
+
+#define SPEC_MAX    24      // Longest conversion kept, "%-08.3lld" and the like
+
+typedef enum {
+    ARG_NONE,               // "%%"
+    ARG_INT,
+    ARG_LONG,
+    ARG_LLONG,
+    ARG_SIZE,
+    ARG_INTMAX,
+    ARG_PTRDIFF,
+    ARG_DOUBLE,
+    ARG_PTR,
+    ARG_STR,
+    ARG_BAD,                // Anything else: the line is kept as text
+} arg_kind_t;
+
+// String arguments: a marker byte, then a pointer or the characters
+#define STR_POINTER 0
+#define STR_INLINE  1
+
+typedef struct {
+    const char  *start;     // The '%'
+    size_t      len;        // Up to and including the conversion
+    arg_kind_t  kind;
+    int         stars;      // '*' widths and precisions, each an int argument
+} spec_t;
+
+// ============================================================================
+// Format strings
+// ============================================================================
+
+static const char *parse_spec(const char *p, spec_t *spec)
+{
+    spec->start = p++;
+    spec->stars = 0;
+
+    while (*p != '\0' && strchr("-+ #0'", *p) != NULL) p++;
+    if (*p == '*') {
+        spec->stars++;
+        p++;
+    }
+    while (*p >= '0' && *p <= '9') p++;
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            spec->stars++;
+            p++;
+        }
+        while (*p >= '0' && *p <= '9') p++;
+    }
+
+    arg_kind_t integer = ARG_INT;
+    bool wide = false;
+    switch (*p) {
+        case 'h': p++; if (*p == 'h') p++; break;
+        case 'l': p++; integer = ARG_LONG; wide = true; if (*p == 'l') { p++; integer = ARG_LLONG; } break;
+        case 'z': p++; integer = ARG_SIZE; break;
+        case 'j': p++; integer = ARG_INTMAX; break;
+        case 't': p++; integer = ARG_PTRDIFF; break;
+        case 'L': p++; integer = ARG_BAD; break;
+        default: break;
+    }
+
+    char conv = *p;
+    if (conv != '\0') p++;
+    spec->len = p - spec->start;
+
+    switch (conv) {
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+            spec->kind = integer;
+            break;
+        case 'c':
+            spec->kind = wide ? ARG_BAD : ARG_INT;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            spec->kind = (integer == ARG_BAD) ? ARG_BAD : ARG_DOUBLE;
+            break;
+        case 'p':
+            spec->kind = ARG_PTR;
+            break;
+        case 's':
+            spec->kind = wide ? ARG_BAD : ARG_STR;
+            break;
+        case '%':
+            spec->kind = (spec->len == 2) ? ARG_NONE : ARG_BAD;
+            break;
+        default:
+            spec->kind = ARG_BAD;
+            break;
+    }
+    if (spec->len > SPEC_MAX) {
+        spec->kind = ARG_BAD;
+    }
+    return p;
+}
+
+uint8_t log_ring_level(const char *format)
+{
+    if (format == NULL) {
+        return 0;
+    }
+    // Skip the colour, if any
+    if (format[0] == '\033' && format[1] == '[') {
+        const char *end = strchr(format, 'm');
+        if (end == NULL) {
+            return 0;
+        }
+        format = end + 1;
+    }
+    if (strchr("EWIDV", format[0]) != NULL && format[0] != '\0' && format[1] == ' ') {
+        return (uint8_t) format[0];
+    }
+    return 0;
+}
+
+// ============================================================================
+// Writing
+// ============================================================================
+
+esp_err_t log_ring_init(log_ring_t *ring, log_slot_t *slots, uint32_t count, log_ring_static_fn is_static)
+{
+    if (ring == NULL || slots == NULL || count < 2 || (count & (count - 1)) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(slots, 0, count * sizeof(log_slot_t));
+    ring->slots = slots;
+    ring->count = count;
+    ring->is_static = is_static;
+    atomic_store_explicit(&ring->head, 0, memory_order_release);
+    return ESP_OK;
+}
+
+#define PUT(value) do {                                             \
+        if (used + sizeof(value) > LOG_RING_ARGS_SIZE) return false; \
+        memcpy(&record->args[used], &(value), sizeof(value));       \
+        used += sizeof(value);                                      \
+    } while (0)
+
+/**
+ * @brief Copy the arguments a format uses, false if the line has to be text
+ */
+static bool capture(const log_ring_t *ring, log_record_t *record, const char *format, va_list args)
+{
+    if (ring->is_static == NULL || !ring->is_static(format)) {
+        return false;
+    }
+
+    size_t used = 0;
+    const char *p = format;
+    while ((p = strchr(p, '%')) != NULL) {
+        spec_t spec;
+        p = parse_spec(p, &spec);
+        if (spec.kind == ARG_BAD) {
+            return false;
+        }
+        for (int i = 0; i < spec.stars; i++) {
+            int star = va_arg(args, int);
+            PUT(star);
+        }
+
+        switch (spec.kind) {
+            case ARG_INT:     { int v = va_arg(args, int); PUT(v); break; }
+            case ARG_LONG:    { long v = va_arg(args, long); PUT(v); break; }
+            case ARG_LLONG:   { long long v = va_arg(args, long long); PUT(v); break; }
+            case ARG_SIZE:    { size_t v = va_arg(args, size_t); PUT(v); break; }
+            case ARG_INTMAX:  { intmax_t v = va_arg(args, intmax_t); PUT(v); break; }
+            case ARG_PTRDIFF: { ptrdiff_t v = va_arg(args, ptrdiff_t); PUT(v); break; }
+            case ARG_DOUBLE:  { double v = va_arg(args, double); PUT(v); break; }
+            case ARG_PTR:     { void *v = va_arg(args, void *); PUT(v); break; }
+            case ARG_STR: {
+                const char *s = va_arg(args, const char *);
+                if (s == NULL || ring->is_static(s)) {
+                    uint8_t marker = STR_POINTER;
+                    PUT(marker);
+                    PUT(s);
+                } else {
+                    size_t len = strlen(s) + 1;
+                    if (used + 1 + len > LOG_RING_ARGS_SIZE) {
+                        return false;
+                    }
+                    record->args[used++] = STR_INLINE;
+                    memcpy(&record->args[used], s, len);
+                    used += len;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    record->args_len = used;
+    return true;
+}
+
+void log_ring_vwrite(log_ring_t *ring, uint8_t level, const char *format, va_list args)
+{
+    uint32_t index = atomic_fetch_add_explicit(&ring->head, 1, memory_order_relaxed);
+    log_slot_t *slot = &ring->slots[index & (ring->count - 1)];
+    log_record_t *record = &slot->rec;
+
+    atomic_store_explicit(&slot->seq, 2 * index + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    record->level = level;
+    record->flags = 0;
+    record->format = format;
+
+    va_list copy;
+    va_copy(copy, args);
+    bool captured = capture(ring, record, format, copy);
+    va_end(copy);
+
+    if (!captured) {
+        va_copy(copy, args);
+        int len = vsnprintf((char *) record->args, LOG_RING_ARGS_SIZE, format, copy);
+        va_end(copy);
+        record->flags = LOG_RING_TEXT;
+        record->args_len = (len < 0) ? 0 : (len >= LOG_RING_ARGS_SIZE ? LOG_RING_ARGS_SIZE - 1 : len);
+    }
+
+    atomic_store_explicit(&slot->seq, 2 * index + 2, memory_order_release);
+}
+
+// ============================================================================
+// Reading
+// ============================================================================
+
+uint32_t log_ring_head(const log_ring_t *ring)
+{
+    return atomic_load_explicit(&((log_ring_t *) ring)->head, memory_order_acquire);
+}
+
+uint32_t log_ring_oldest(const log_ring_t *ring)
+{
+    uint32_t head = log_ring_head(ring);
+    return (head > ring->count) ? head - ring->count : 0;
+}
+
+bool log_ring_read(const log_ring_t *ring, uint32_t *cursor, log_record_t *record, uint32_t *lost)
+{
+    uint32_t head = log_ring_head(ring);
+    uint32_t index = *cursor;
+
+    if (head - index > ring->count) {
+        *lost += head - ring->count - index;
+        index = head - ring->count;
+    }
+
+    bool found = false;
+    for (; index != head; index++) {
+        log_slot_t *slot = &ring->slots[index & (ring->count - 1)];
+        uint32_t want = 2 * index + 2;
+
+        uint32_t before = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if ((int32_t)(before - want) < 0) {
+            break;      // Claimed but not written yet; pick it up next time
+        }
+        if (before != want) {
+            (*lost)++;  // Overwritten
+            continue;
+        }
+
+        memcpy(record, &slot->rec, sizeof(*record));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->seq, memory_order_relaxed) != before) {
+            (*lost)++;  // Overwritten while we copied
+            continue;
+        }
+        found = true;
+        index++;
+        break;
+    }
+
+    *cursor = index;
+    return found;
+}
+
+#define GET(type, var) \
+        type var; \
+        if (used + sizeof(type) > record->args_len) goto done; \
+        memcpy(&var, &record->args[used], sizeof(type)); \
+        used += sizeof(type)
+
+size_t log_ring_format(const log_record_t *record, char *out, size_t size)
+{
+    if (size < 2) {
+        if (size == 1) out[0] = '\0';
+        return 0;
+    }
+
+    size_t len = 0;
+    if (record->flags & LOG_RING_TEXT) {
+        len = strnlen((const char *) record->args, record->args_len);
+        if (len > size - 1) len = size - 1;
+        memcpy(out, record->args, len);
+        goto done;
+    }
+
+    size_t used = 0;
+    const char *p = record->format;
+    while (*p != '\0' && len < size - 1) {
+        if (*p != '%') {
+            out[len++] = *p++;
+            continue;
+        }
+
+        spec_t spec;
+        const char *next = parse_spec(p, &spec);
+        if (spec.kind == ARG_NONE) {
+            out[len++] = '%';
+            p = next;
+            continue;
+        }
+
+        // The conversion on its own, with '*' replaced by the value given
+        char fmt[SPEC_MAX + 24];
+        size_t f = 0;
+        for (size_t i = 0; i < spec.len; i++) {
+            if (spec.start[i] == '*') {
+                GET(int, star);
+                f += snprintf(&fmt[f], sizeof(fmt) - f, "%d", star);
+            } else {
+                fmt[f++] = spec.start[i];
+            }
+        }
+        fmt[f] = '\0';
+
+        int n = 0;
+        char *dst = &out[len];
+        size_t room = size - len;
+        switch (spec.kind) {
+            case ARG_INT:     { GET(int, v); n = snprintf(dst, room, fmt, v); break; }
+            case ARG_LONG:    { GET(long, v); n = snprintf(dst, room, fmt, v); break; }
+            case ARG_LLONG:   { GET(long long, v); n = snprintf(dst, room, fmt, v); break; }
+            case ARG_SIZE:    { GET(size_t, v); n = snprintf(dst, room, fmt, v); break; }
+            case ARG_INTMAX:  { GET(intmax_t, v); n = snprintf(dst, room, fmt, v); break; }
+            case ARG_PTRDIFF: { GET(ptrdiff_t, v); n = snprintf(dst, room, fmt, v); break; }
+            case ARG_DOUBLE:  { GET(double, v); n = snprintf(dst, room, fmt, v); break; }
+            case ARG_PTR:     { GET(void *, v); n = snprintf(dst, room, fmt, v); break; }
+            case ARG_STR: {
+                GET(uint8_t, marker);
+                const char *s;
+                if (marker == STR_POINTER) {
+                    GET(const char *, ptr);
+                    s = (ptr != NULL) ? ptr : "(null)";
+                } else {
+                    s = (const char *) &record->args[used];
+                    size_t slen = strnlen(s, record->args_len - used);
+                    if (used + slen >= record->args_len) goto done;
+                    used += slen + 1;
+                }
+                n = snprintf(dst, room, fmt, s);
+                break;
+            }
+            default:
+                goto done;
+        }
+        if (n > 0) {
+            len += ((size_t) n < room) ? (size_t) n : room - 1;
+        }
+        p = next;
+    }
+
+done:
+    if (len == 0 || out[len - 1] != '\n') {
+        if (len > size - 2) len = size - 2;
+        out[len++] = '\n';
+    }
+    out[len] = '\0';
+    return len;
+}
@@ -0,0 +1,97 @@
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include "esp_err.h"
+
+// Log lines kept as a format pointer and raw arguments, and only formatted
+// when something reads them (UART console, /api/ws, /api/system/logs).
+// Logging a line is one pass over the format and a copy of the arguments
+// into a preallocated slot: no allocation, no vsnprintf, no lock.
+//
+// Writers claim a slot with an atomic increment and publish it by storing
+// its sequence number last. Readers keep their own cursor and skip ahead,
+// counting the lost lines, when writers have lapped them.
+//
+// String arguments in flash (tags, __func__, literals) are kept as pointers,
+// others are copied. A line that cannot be kept that way is formatted on
+// the spot and kept as text.
+
+#define LOG_RING_ARGS_SIZE      116     // Slots are 128 bytes on the device
+#define LOG_RING_LINE_SIZE      512     // Longest formatted line, newline included
+
+#define LOG_RING_TEXT           0x01    // args holds the formatted line
+
+typedef struct {
+    uint8_t     level;                  // 'E', 'W', 'I', 'D', 'V' or 0
+    uint8_t     flags;
+    uint16_t    args_len;
+    const char  *format;
+    uint8_t     args[LOG_RING_ARGS_SIZE];
+} log_record_t;
+
+// seq is 2 * index + 1 while a writer fills the slot, 2 * index + 2 once
+// the line for that index is complete
+typedef struct {
+    _Atomic uint32_t    seq;
+    log_record_t        rec;
+} log_slot_t;
+
+/**
+ * @brief Whether a pointer stays valid for the life of the program
+ */
+typedef bool (*log_ring_static_fn)(const void *ptr);
+
+typedef struct {
+    log_slot_t          *slots;         // Caller's memory, PSRAM on the device
+    uint32_t            count;          // Power of two
+    _Atomic uint32_t    head;           // Next index to write; keep in internal RAM
+    log_ring_static_fn  is_static;      // NULL: nothing is, every line is kept as text
+} log_ring_t;
+
+/**
+ * @brief Set up a ring over count slots of memory
+ * @return ESP_ERR_INVALID_ARG unless count is a power of two
+ */
+esp_err_t log_ring_init(log_ring_t *ring, log_slot_t *slots, uint32_t count, log_ring_static_fn is_static);
+
+/**
+ * @brief Level letter of an ESP_LOGx format ("\033[0;32mI (%lu) %s: ..."), 0 if none
+ */
+uint8_t log_ring_level(const char *format);
+
+/**
+ * @brief Keep a line; safe from any task on either core, never blocks
+ */
+void log_ring_vwrite(log_ring_t *ring, uint8_t level, const char *format, va_list args);
+
+/**
+ * @brief Index of the oldest line still held, to read the whole ring from
+ */
+uint32_t log_ring_oldest(const log_ring_t *ring);
+
+/**
+ * @brief Index the next line will get, to read only lines from now on
+ */
+uint32_t log_ring_head(const log_ring_t *ring);
+
+/**
+ * @brief Copy out the line at *cursor and advance it
+ *
+ * Lines writers overwrote before the cursor reached them are skipped and
+ * added to *lost.
+ *
+ * @return false if there is no complete line at the cursor yet
+ */
+bool log_ring_read(const log_ring_t *ring, uint32_t *cursor, log_record_t *record, uint32_t *lost);
+
+/**
+ * @brief Format a line read with log_ring_read(); always ends in a newline
+ * @return Length written, without the terminator
+ */
+size_t log_ring_format(const log_record_t *record, char *out, size_t size);
+
+#endif // LOG_RING_H
@@ -1,12 +1,14 @@
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_psram.h"
+#include "esp_timer.h"
 
 #include "asic_result_task.h"
 #include "asic_task.h"
 #include "create_jobs_task.h"
 #include "hashrate_monitor_task.h"
 #include "statistics_task.h"
+#include "log_task.h"
 #include "system.h"
 #include "http_server.h"
 #include "serial.h"
@@ -21,6 +23,7 @@
 #include "connect.h"
 #include "asic_reset.h"
 #include "asic_init.h"
+#include "boot_timeline.h"
 
 // Clusteraxe integration
 #include "cluster_config.h"
@@ -35,8 +38,49 @@ static GlobalState GLOBAL_STATE;
 
 static const char * TAG = "bitaxe";
 
+static int phase_begin(const char * name)
+{
+    return boot_timeline_begin(&GLOBAL_STATE.BOOT_TIMELINE, name, esp_timer_get_time());
+}
+
+static void phase_end(int phase)
+{
+    boot_timeline_end(&GLOBAL_STATE.BOOT_TIMELINE, phase, esp_timer_get_time());
+}
+
+// Chip detection and the frequency ramp take seconds; they run here while
+// app_main waits for WiFi and the stratum task connects to the pool
+static void asic_init_task(void * pvParameters)
+{
+    GlobalState * GLOBAL_STATE = (GlobalState *) pvParameters;
+
+    int phase = phase_begin("asic init");
+    uint8_t chip_count = asic_initialize(GLOBAL_STATE, ASIC_INIT_COLD_BOOT, 0);
+    phase_end(phase);
+
+    if (chip_count > 0) {
+        if (xTaskCreate(ASIC_task, "asic", 8192, (void *) GLOBAL_STATE, 10, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "Error creating asic task");
+        }
+        if (xTaskCreate(ASIC_result_task, "asic result", 8192, (void *) GLOBAL_STATE, 12, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "Error creating asic result task");
+        }
+        if (xTaskCreateWithCaps(hashrate_monitor_task, "hashrate monitor", 8192, (void *) GLOBAL_STATE, 5, NULL, MALLOC_CAP_SPIRAM) != pdPASS) {
+            ESP_LOGE(TAG, "Error creating hashrate monitor task");
+        }
+    }
+
+    vTaskDelete(NULL);
+}
+
 void app_main(void)
 {
+    int phase = phase_begin("log");
+
+    // Log lines go to a PSRAM ring from here on and reach the console from a low-priority task
+    log_task_init();
+    phase_end(phase);
+
     ESP_LOGI(TAG, "Welcome to the bitaxe - FOSS || GTFO!");
 
     if (!esp_psram_is_initialized()) {
@@ -46,6 +90,8 @@ void app_main(void)
         GLOBAL_STATE.psram_is_available = true;
     }
 
+    phase = phase_begin("i2c");
+
     // Init I2C
     ESP_ERROR_CHECK(i2c_bitaxe_init());
     ESP_LOGI(TAG, "I2C initialized successfully");
@@ -59,8 +105,10 @@ void app_main(void)
 
     //Init ADC
     ADC_init();
+    phase_end(phase);
 
     //initialize the ESP32 NVS
+    phase = phase_begin("nvs");
     if (nvs_config_init() != ESP_OK){
         ESP_LOGE(TAG, "Failed to init NVS");
         return;
@@ -70,41 +118,66 @@ void app_main(void)
         ESP_LOGE(TAG, "Failed to init device config");
         return;
     }
+    phase_end(phase);
 
     if (self_test(&GLOBAL_STATE)) return;
 
+    phase = phase_begin("system");
     SYSTEM_init_system(&GLOBAL_STATE);
+    phase_end(phase);
 
     // init AP and connect to wifi
+    phase = phase_begin("wifi init");
     wifi_init(&GLOBAL_STATE);
+    phase_end(phase);
 
+    phase = phase_begin("peripherals");
     if (SYSTEM_init_peripherals(&GLOBAL_STATE) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to init peripherals");
         return;
     }
+    phase_end(phase);
 
     if (xTaskCreate(POWER_MANAGEMENT_task, "power management", 8192, (void *) &GLOBAL_STATE, 10, NULL) != pdPASS) {
         ESP_LOGE(TAG, "Error creating power management task");
     }
 
+    queue_init(&GLOBAL_STATE.stratum_queue);
+    queue_init(&GLOBAL_STATE.stratum_queue_secondary);  // For dual pool mode
+    queue_init(&GLOBAL_STATE.ASIC_jobs_queue);
+
+    // Stratum and cluster work reach the job tables before the ASIC tasks start
+    ASIC_task_init(&GLOBAL_STATE);
+
+    if (xTaskCreate(asic_init_task, "asic init", 8192, (void *) &GLOBAL_STATE, 10, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Error creating asic init task");
+    }
+
     //start the API for AxeOS
+    phase = phase_begin("rest server");
     start_rest_server((void *) &GLOBAL_STATE);
+    phase_end(phase);
 
     // Initialize BAP interface
+    phase = phase_begin("bap");
     esp_err_t bap_ret = BAP_init(&GLOBAL_STATE);
     if (bap_ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize BAP interface: %d", bap_ret);
         // Continue anyway, as BAP is not critical for core functionality
     }
+    phase_end(phase);
 
+    phase = phase_begin("wifi connect");
     while (!GLOBAL_STATE.SYSTEM_MODULE.is_connected) {
         vTaskDelay(100 / portTICK_PERIOD_MS);
     }
+    phase_end(phase);
 
     // Initialize Clusteraxe module AFTER WiFi is connected
     // ESP-NOW requires stable WiFi state - initializing before connection
     // causes conflicts when wifi_softap_off() changes mode to STA-only
 #if CLUSTER_ENABLED
+    phase = phase_begin("cluster");
     esp_err_t cluster_ret = cluster_integration_init(&GLOBAL_STATE);
     if (cluster_ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize cluster module: %d", cluster_ret);
@@ -117,16 +190,9 @@ void app_main(void)
     auto_timing_init(&GLOBAL_STATE);
     auto_timing_start(&GLOBAL_STATE);
 #endif
+    phase_end(phase);
 #endif
 
-    queue_init(&GLOBAL_STATE.stratum_queue);
-    queue_init(&GLOBAL_STATE.stratum_queue_secondary);  // For dual pool mode
-    queue_init(&GLOBAL_STATE.ASIC_jobs_queue);
-
-    if (asic_initialize(&GLOBAL_STATE, ASIC_INIT_COLD_BOOT, 0) == 0) {
-        return;
-    }
-
     // Slaves don't need stratum tasks - they receive work from master
 #if !CLUSTER_IS_SLAVE
     if (xTaskCreate(stratum_task, "stratum admin", 8192, (void *) &GLOBAL_STATE, 5, NULL) != pdPASS) {
@@ -142,15 +208,6 @@ void app_main(void)
 #else
     ESP_LOGI(TAG, "Slave mode: Stratum tasks disabled, receiving work from master");
 #endif
-    if (xTaskCreate(ASIC_task, "asic", 8192, (void *) &GLOBAL_STATE, 10, NULL) != pdPASS) {
-        ESP_LOGE(TAG, "Error creating asic task");
-    }
-    if (xTaskCreate(ASIC_result_task, "asic result", 8192, (void *) &GLOBAL_STATE, 12, NULL) != pdPASS) {
-        ESP_LOGE(TAG, "Error creating asic result task");
-    }
-    if (xTaskCreateWithCaps(hashrate_monitor_task, "hashrate monitor", 8192, (void *) &GLOBAL_STATE, 5, NULL, MALLOC_CAP_SPIRAM) != pdPASS) {
-        ESP_LOGE(TAG, "Error creating hashrate monitor task");
-    }
     if (xTaskCreateWithCaps(statistics_task, "statistics", 8192, (void *) &GLOBAL_STATE, 3, NULL, MALLOC_CAP_SPIRAM) != pdPASS) {
         ESP_LOGE(TAG, "Error creating statistics task");
     }
@@ -7,12 +7,18 @@
 #include <freertos/queue.h>
 #include <freertos/task.h>
 #include <freertos/event_groups.h>
+#include <freertos/semphr.h>
+#include "esp_system.h"
+#include "esp_timer.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
+#include <inttypes.h>
 #include "display.h"
 #include "theme_api.h"
+#include "metrics.h"
+#include "nvs_writeback.h"
 
 #define NVS_CONFIG_NAMESPACE "main"
 #define NVS_STR_LIMIT (4000 - 1) // See nvs_set_str
@@ -40,9 +46,15 @@ typedef struct {
 
 static const char * TAG = "nvs_config";
 
+_Static_assert(NVS_CONFIG_COUNT <= NVS_WRITEBACK_MAX_KEYS, "raise NVS_WRITEBACK_MAX_KEYS");
+
 static QueueHandle_t nvs_save_queue = NULL;
 static nvs_handle_t handle;
 
+// Held by nvs_task while it applies or writes, and by a flush at shutdown
+static SemaphoreHandle_t nvs_lock = NULL;
+static nvs_writeback_t writeback;
+
 static Settings settings[NVS_CONFIG_COUNT] = {
     [NVS_CONFIG_WIFI_SSID]                             = {.nvs_key_name = "wifissid",        .type = TYPE_STR,   .default_value = {.str = (char *)CONFIG_ESP_WIFI_SSID},                .rest_name = "ssid",                               .min = 1,  .max = 32},
     [NVS_CONFIG_WIFI_PASS]                             = {.nvs_key_name = "wifipass",        .type = TYPE_STR,   .default_value = {.str = (char *)CONFIG_ESP_WIFI_PASSWORD},            .rest_name = "wifiPass",                           .min = 0,  .max = 63},
@@ -159,60 +171,186 @@ static void nvs_config_apply_fallback(NvsConfigKey key, Settings * setting)
     }
 }
 
+// Written as soon as they are set, together with anything else waiting:
+// losing these to a power cut leaves the device unreachable or hot
+static bool nvs_config_is_critical(NvsConfigKey key)
+{
+    switch (key) {
+        case NVS_CONFIG_WIFI_SSID:
+        case NVS_CONFIG_WIFI_PASS:
+        case NVS_CONFIG_HOSTNAME:
+        case NVS_CONFIG_STRATUM_URL:
+        case NVS_CONFIG_STRATUM_PORT:
+        case NVS_CONFIG_STRATUM_USER:
+        case NVS_CONFIG_STRATUM_PASS:
+        case NVS_CONFIG_FALLBACK_STRATUM_URL:
+        case NVS_CONFIG_FALLBACK_STRATUM_PORT:
+        case NVS_CONFIG_FALLBACK_STRATUM_USER:
+        case NVS_CONFIG_FALLBACK_STRATUM_PASS:
+        case NVS_CONFIG_OVERHEAT_MODE:
+        case NVS_CONFIG_SELF_TEST:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t) (esp_timer_get_time() / 1000);
+}
+
+/**
+ * @brief Make a queued update the current value; flash follows later
+ */
+static void nvs_config_apply(const ConfigUpdate *update)
+{
+    Settings *setting = nvs_config_get_settings(update->key);
+    if (!setting || setting->type != update->type) {
+        if (update->type == TYPE_STR) {
+            free(update->value.str);
+        }
+        return;
+    }
+
+    char *old_str = NULL;
+    switch (update->type) {
+        case TYPE_STR:
+            old_str = setting->value.str;
+            setting->value.str = update->value.str;
+            break;
+        case TYPE_U16:
+            setting->value.u16 = update->value.u16;
+            break;
+        case TYPE_I32:
+            setting->value.i32 = update->value.i32;
+            break;
+        case TYPE_U64:
+            setting->value.u64 = update->value.u64;
+            break;
+        case TYPE_FLOAT:
+            setting->value.f = update->value.f;
+            break;
+        case TYPE_BOOL:
+            setting->value.b = update->value.b;
+            break;
+    }
+    if (old_str) free(old_str);
+
+    nvs_writeback_mark(&writeback, update->key, nvs_config_is_critical(update->key), now_ms());
+}
+
+static esp_err_t nvs_config_write(NvsConfigKey key)
+{
+    Settings *setting = &settings[key];
+    esp_err_t ret = ESP_OK;
+    switch (setting->type) {
+        case TYPE_STR:
+            ret = nvs_set_str(handle, setting->nvs_key_name, setting->value.str);
+            break;
+        case TYPE_U16:
+            ret = nvs_set_u16(handle, setting->nvs_key_name, setting->value.u16);
+            break;
+        case TYPE_I32:
+            ret = nvs_set_i32(handle, setting->nvs_key_name, setting->value.i32);
+            break;
+        case TYPE_U64:
+            ret = nvs_set_u64(handle, setting->nvs_key_name, setting->value.u64);
+            break;
+        case TYPE_FLOAT: {
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%f", setting->value.f);
+            ret = nvs_set_str(handle, setting->nvs_key_name, buf);
+            break;
+        }
+        case TYPE_BOOL:
+            ret = nvs_set_u16(handle, setting->nvs_key_name, setting->value.b ? 1 : 0);
+            break;
+    }
+
+    nvs_config_apply_fallback(key, setting);
+    return ret;
+}
+
+/**
+ * @brief Write every dirty key and commit them once; call with nvs_lock held
+ */
+static void nvs_config_write_dirty(void)
+{
+    uint16_t key;
+    int written = 0;
+    while (nvs_writeback_take(&writeback, &key)) {
+        if (nvs_config_write(key) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to write %s to NVS", settings[key].nvs_key_name);
+        }
+        written++;
+    }
+    if (written == 0) {
+        return;
+    }
+    if (nvs_commit(handle) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to commit data to NVS");
+    }
+    nvs_writeback_committed(&writeback);
+    ESP_LOGD(TAG, "Committed %d keys (%" PRIu32 " updates, %" PRIu32 " flash writes so far)",
+             written, writeback.requested, writeback.flash_writes);
+}
+
 static void nvs_task(void *pvParameters)
 {
     while (1) {
-        ConfigUpdate update;
-        if (xQueueReceive(nvs_save_queue, &update, portMAX_DELAY) == pdTRUE) {
-            Settings *setting = nvs_config_get_settings(update.key);
-            if (setting && setting->type == update.type) {
-                esp_err_t ret = ESP_OK;
-                char *old_str = NULL;
-                switch (update.type) {
-                    case TYPE_STR:
-                        old_str = setting->value.str;
-                        setting->value.str = update.value.str;
-                        ret = nvs_set_str(handle, setting->nvs_key_name, setting->value.str);
-                        break;
-                    case TYPE_U16:
-                        setting->value.u16 = update.value.u16;
-                        ret = nvs_set_u16(handle, setting->nvs_key_name, setting->value.u16);
-                        break;
-                    case TYPE_I32:
-                        setting->value.i32 = update.value.i32;
-                        ret = nvs_set_i32(handle, setting->nvs_key_name, setting->value.i32);
-                        break;
-                    case TYPE_U64:
-                        setting->value.u64 = update.value.u64;
-                        ret = nvs_set_u64(handle, setting->nvs_key_name, setting->value.u64);
-                        break;
-                    case TYPE_FLOAT:
-                        setting->value.f = update.value.f;
-                        char buf[32];
-                        snprintf(buf, sizeof(buf), "%f", setting->value.f);
-                        ret = nvs_set_str(handle, setting->nvs_key_name, buf);
-                        break;
-                    case TYPE_BOOL:
-                        setting->value.b = update.value.b;
-                        ret = nvs_set_u16(handle, setting->nvs_key_name, setting->value.b ? 1 : 0);
-                        break;
-                }
+        uint32_t wait_ms = nvs_writeback_wait_ms(&writeback, now_ms());
+        TickType_t wait = (wait_ms == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(wait_ms);
 
-                nvs_config_apply_fallback(update.key, setting);
+        ConfigUpdate update;
+        bool received = xQueueReceive(nvs_save_queue, &update, wait) == pdTRUE;
 
-                if (ret == ESP_OK) {
-                    ret = nvs_commit(handle);
-                    if (ret != ESP_OK) {
-                        ESP_LOGE(TAG, "Failed to commit data to NVS");
-                    }
-                }
-                if (old_str) free(old_str);
-            } 
-            else if (update.type == TYPE_STR) {
-                free(update.value.str);
-            }
+        xSemaphoreTake(nvs_lock, portMAX_DELAY);
+        if (received) {
+            nvs_config_apply(&update);
+        }
+        if (nvs_writeback_due(&writeback, now_ms())) {
+            nvs_config_write_dirty();
         }
+        xSemaphoreGive(nvs_lock);
+    }
+}
+
+esp_err_t nvs_config_flush(void)
+{
+    if (nvs_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (xSemaphoreTake(nvs_lock, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    // Updates still queued are as good as set
+    ConfigUpdate update;
+    while (xQueueReceive(nvs_save_queue, &update, 0) == pdTRUE) {
+        nvs_config_apply(&update);
     }
+    nvs_config_write_dirty();
+
+    xSemaphoreGive(nvs_lock);
+    return ESP_OK;
+}
+
+static void nvs_config_shutdown(void)
+{
+    nvs_config_flush();
+}
+
+static void nvs_config_register_metrics(void)
+{
+    metrics_register("bitaxe_nvs_updates_total", METRICS_COUNTER, "Settings updates requested", NULL,
+                     METRICS_U32, &writeback.requested);
+    metrics_register("bitaxe_nvs_coalesced_total", METRICS_COUNTER, "Updates replaced before reaching flash", NULL,
+                     METRICS_U32, &writeback.coalesced);
+    metrics_register("bitaxe_nvs_flash_writes_total", METRICS_COUNTER, "Settings written to flash", NULL,
+                     METRICS_U32, &writeback.flash_writes);
+    metrics_register("bitaxe_nvs_commits_total", METRICS_COUNTER, "NVS commits", NULL,
+                     METRICS_U32, &writeback.commits);
 }
 
 esp_err_t nvs_config_init(void)
@@ -284,6 +422,8 @@ esp_err_t nvs_config_init(void)
         }
     }
 
+    nvs_writeback_init(&writeback, CONFIG_NVS_WRITEBACK_MS);
+    nvs_lock = xSemaphoreCreateMutex();
     nvs_save_queue = xQueueCreate(20, sizeof(ConfigUpdate));
 
     TaskHandle_t task_handle;
@@ -295,6 +435,10 @@ esp_err_t nvs_config_init(void)
 
         return ESP_FAIL;
     }
+
+    // Whatever is still waiting goes to flash before esp_restart()
+    esp_register_shutdown_handler(nvs_config_shutdown);
+    nvs_config_register_metrics();
     return ESP_OK;
 }
 
@@ -107,6 +107,14 @@ typedef struct {
 
 esp_err_t nvs_config_init(void);
 
+/**
+ * @brief Write every pending setting to flash now
+ *
+ * Sets normally reach flash in batches (see nvs_writeback.h); this is for
+ * callers about to lose power. esp_restart() already does it.
+ */
+esp_err_t nvs_config_flush(void);
+
 char * nvs_config_get_string(NvsConfigKey key);
 void nvs_config_set_string(NvsConfigKey key, const char * value);
 uint16_t nvs_config_get_u16(NvsConfigKey key);
@@ -0,0 +1,72 @@
+#include <string.h>
+#include "nvs_writeback.h"
+
+void nvs_writeback_init(nvs_writeback_t *wb, uint32_t window_ms)
+{
+    memset(wb, 0, sizeof(*wb));
+    wb->window_ms = window_ms;
+}
+
+void nvs_writeback_mark(nvs_writeback_t *wb, uint16_t key, bool critical, uint32_t now_ms)
+{
+    if (key >= NVS_WRITEBACK_MAX_KEYS) {
+        return;
+    }
+
+    wb->requested++;
+    uint8_t bit = 1 << (key & 7);
+    if (wb->dirty[key >> 3] & bit) {
+        wb->coalesced++;
+    } else {
+        if (wb->dirty_count == 0) {
+            wb->first_dirty_ms = now_ms;
+        }
+        wb->dirty[key >> 3] |= bit;
+        wb->dirty_count++;
+    }
+    wb->critical |= critical;
+}
+
+bool nvs_writeback_due(const nvs_writeback_t *wb, uint32_t now_ms)
+{
+    return nvs_writeback_wait_ms(wb, now_ms) == 0;
+}
+
+uint32_t nvs_writeback_wait_ms(const nvs_writeback_t *wb, uint32_t now_ms)
+{
+    if (wb->dirty_count == 0) {
+        return UINT32_MAX;
+    }
+    if (wb->critical) {
+        return 0;
+    }
+    uint32_t waited = now_ms - wb->first_dirty_ms;
+    return (waited >= wb->window_ms) ? 0 : wb->window_ms - waited;
+}
+
+bool nvs_writeback_take(nvs_writeback_t *wb, uint16_t *key)
+{
+    if (wb->dirty_count == 0) {
+        return false;
+    }
+    for (uint16_t i = 0; i < sizeof(wb->dirty); i++) {
+        if (wb->dirty[i] == 0) {
+            continue;
+        }
+        int bit = __builtin_ctz(wb->dirty[i]);
+        wb->dirty[i] &= ~(1 << bit);
+        wb->dirty_count--;
+        wb->flash_writes++;
+        *key = i * 8 + bit;
+        return true;
+    }
+    return false;
+}
+
+void nvs_writeback_committed(nvs_writeback_t *wb)
+{
+    wb->commits++;
+    if (wb->dirty_count == 0) {
+        wb->critical = false;
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef NVS_WRITEBACK_H
+#define NVS_WRITEBACK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Which settings still have to reach flash, and when to write them.
+// nvs_config applies a set to its in-memory value at once and marks the key
+// dirty here. Dirty keys are written together in one nvs_commit() when the
+// oldest has waited the coalescing window, or straight away when a critical
+// key (WiFi, pool, overheat) is among them.
+
+#define NVS_WRITEBACK_MAX_KEYS  128
+
+typedef struct {
+    uint32_t    window_ms;              // 0: every update is due at once
+    uint8_t     dirty[NVS_WRITEBACK_MAX_KEYS / 8];
+    uint16_t    dirty_count;
+    bool        critical;               // A critical key is dirty
+    uint32_t    first_dirty_ms;         // When the oldest dirty key was set
+
+    // Accounting
+    uint32_t    requested;              // Updates callers made
+    uint32_t    coalesced;              // Of those, updates to a key already waiting
+    uint32_t    flash_writes;           // Keys written to NVS
+    uint32_t    commits;                // nvs_commit() calls
+} nvs_writeback_t;
+
+void nvs_writeback_init(nvs_writeback_t *wb, uint32_t window_ms);
+
+/**
+ * @brief Record an update of a key whose in-memory value was just changed
+ */
+void nvs_writeback_mark(nvs_writeback_t *wb, uint16_t key, bool critical, uint32_t now_ms);
+
+/**
+ * @brief Whether the dirty keys should be written now
+ */
+bool nvs_writeback_due(const nvs_writeback_t *wb, uint32_t now_ms);
+
+/**
+ * @brief Milliseconds until the dirty keys are due, UINT32_MAX if none are dirty
+ */
+uint32_t nvs_writeback_wait_ms(const nvs_writeback_t *wb, uint32_t now_ms);
+
+/**
+ * @brief Take the next dirty key to write, counting it as written
+ * @return false when none are left
+ */
+bool nvs_writeback_take(nvs_writeback_t *wb, uint16_t *key);
+
+/**
+ * @brief Count the commit that ended a batch
+ */
+void nvs_writeback_committed(nvs_writeback_t *wb);
+
+#endif // NVS_WRITEBACK_H
@@ -144,6 +144,12 @@ void SYSTEM_notify_accepted_share(GlobalState * GLOBAL_STATE)
 
     module->shares_accepted++;
 
+    static bool first_share_marked;
+    if (!first_share_marked) {
+        boot_timeline_mark(&GLOBAL_STATE->BOOT_TIMELINE, "first share", esp_timer_get_time());
+        first_share_marked = true;
+    }
+
     // Notify auto-timing module for rejection rate tracking
     auto_timing_notify_share_accepted();
 }
@@ -5,12 +5,14 @@
 #include "serial.h"
 #include <string.h>
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "nvs_config.h"
 #include "utils.h"
 #include "stratum_task.h"
 #include "stratum_api.h"
 #include "hashrate_monitor_task.h"
 #include "asic.h"
+#include "metrics.h"
 
 // Clusteraxe integration
 #include "cluster_config.h"
@@ -21,10 +23,21 @@
 
 static const char *TAG = "asic_result";
 
+static const double nonce_difficulty_bounds[] = { 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10 };
+static metrics_histogram_t nonce_difficulty_histogram;
+static uint32_t invalid_job_nonces;
+
 void ASIC_result_task(void *pvParameters)
 {
     GlobalState *GLOBAL_STATE = (GlobalState *)pvParameters;
 
+    metrics_histogram_init(&nonce_difficulty_histogram, nonce_difficulty_bounds,
+                           sizeof(nonce_difficulty_bounds) / sizeof(nonce_difficulty_bounds[0]));
+    metrics_register_histogram("bitaxe_asic_nonce_difficulty", "Difficulty of nonces returned by the ASICs", NULL,
+                               &nonce_difficulty_histogram);
+    metrics_register("bitaxe_asic_invalid_job_nonces_total", METRICS_COUNTER, "Nonces for jobs no longer valid", NULL,
+                     METRICS_U32, &invalid_job_nonces);
+
     while (1)
     {
         // Check if ASIC is initialized before trying to process work
@@ -50,13 +63,21 @@ void ASIC_result_task(void *pvParameters)
 
         if (GLOBAL_STATE->valid_jobs[job_id] == 0)
         {
+            invalid_job_nonces++;
             ESP_LOGW(TAG, "Invalid job nonce found, 0x%02X", job_id);
             continue;
         }
 
+        static bool first_nonce_marked;
+        if (!first_nonce_marked) {
+            boot_timeline_mark(&GLOBAL_STATE->BOOT_TIMELINE, "first nonce", esp_timer_get_time());
+            first_nonce_marked = true;
+        }
+
         bm_job *active_job = GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[job_id];
         // check the nonce difficulty
         double nonce_diff = test_nonce_value(active_job, asic_result->nonce, asic_result->rolled_version);
+        metrics_observe(&nonce_difficulty_histogram, nonce_diff);
 
         //log the ASIC response
         ESP_LOGI(TAG, "ID: %s, ASIC nr: %d, ver: %08" PRIX32 " Nonce %08" PRIX32 " diff %.1f of %ld.", active_job->jobid, asic_result->asic_nr, asic_result->rolled_version, asic_result->nonce, nonce_diff, active_job->pool_diff);
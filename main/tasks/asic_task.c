@@ -14,7 +14,7 @@ static const char *TAG = "asic_task";
 
 // static bm_job ** active_jobs; is required to keep track of the active jobs since the
 
-void ASIC_task(void *pvParameters)
+void ASIC_task_init(void *pvParameters)
 {
     GlobalState *GLOBAL_STATE = (GlobalState *)pvParameters;
 
@@ -28,6 +28,11 @@ void ASIC_task(void *pvParameters)
         GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[i] = NULL;
         GLOBAL_STATE->valid_jobs[i] = 0;
     }
+}
+
+void ASIC_task(void *pvParameters)
+{
+    GlobalState *GLOBAL_STATE = (GlobalState *)pvParameters;
 
     double asic_job_frequency_ms = ASIC_get_asic_job_frequency_ms(GLOBAL_STATE);
 
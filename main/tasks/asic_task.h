@@ -14,6 +14,10 @@ typedef struct
     SemaphoreHandle_t semaphore;
 } AsicTaskModule;
 
+/**
+ * @brief Allocate the job tables; stratum and cluster work use them before ASIC_task runs
+ */
+void ASIC_task_init(void *pvParameters);
 void ASIC_task(void *pvParameters);
 
 #endif /* ASIC_TASK_H_ */
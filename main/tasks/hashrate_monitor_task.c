@@ -1,3 +1,4 @@
+#include <stdio.h>
 #include <string.h>
 #include <esp_heap_caps.h>
 #include <math.h>
@@ -7,6 +8,7 @@
 #include "common.h"
 #include "asic.h"
 #include "utils.h"
+#include "metrics.h"
 
 #define EPSILON 0.0001f
 
@@ -129,6 +131,32 @@ static void update_hashrate_averages(SystemModule * SYSTEM_MODULE)
     poll_count++;
 }
 
+static void register_metrics(GlobalState * GLOBAL_STATE, int asic_count)
+{
+    HashrateMonitorModule * HASHRATE_MONITOR_MODULE = &GLOBAL_STATE->HASHRATE_MONITOR_MODULE;
+    SystemModule * SYSTEM_MODULE = &GLOBAL_STATE->SYSTEM_MODULE;
+
+    metrics_register("bitaxe_hashrate_ghs", METRICS_GAUGE, "Hashrate, current and averaged", "window=\"current\"",
+                     METRICS_FLOAT, &SYSTEM_MODULE->current_hashrate);
+    metrics_register("bitaxe_hashrate_ghs", METRICS_GAUGE, "Hashrate, current and averaged", "window=\"1m\"",
+                     METRICS_FLOAT, &SYSTEM_MODULE->hashrate_1m);
+    metrics_register("bitaxe_hashrate_ghs", METRICS_GAUGE, "Hashrate, current and averaged", "window=\"10m\"",
+                     METRICS_FLOAT, &SYSTEM_MODULE->hashrate_10m);
+    metrics_register("bitaxe_hashrate_ghs", METRICS_GAUGE, "Hashrate, current and averaged", "window=\"1h\"",
+                     METRICS_FLOAT, &SYSTEM_MODULE->hashrate_1h);
+    metrics_register("bitaxe_hashrate_error_percent", METRICS_GAUGE, "Share of hashes in error", NULL,
+                     METRICS_FLOAT, &SYSTEM_MODULE->error_percentage);
+
+    for (int asic_nr = 0; asic_nr < asic_count; asic_nr++) {
+        char labels[16];
+        snprintf(labels, sizeof(labels), "asic=\"%d\"", asic_nr);
+        metrics_register("bitaxe_asic_hashrate_ghs", METRICS_GAUGE, "Hashrate per ASIC", labels,
+                         METRICS_FLOAT, &HASHRATE_MONITOR_MODULE->total_measurement[asic_nr].hashrate);
+        metrics_register("bitaxe_asic_error_hashrate_ghs", METRICS_GAUGE, "Hashes in error per ASIC", labels,
+                         METRICS_FLOAT, &HASHRATE_MONITOR_MODULE->error_measurement[asic_nr].hashrate);
+    }
+}
+
 void hashrate_monitor_task(void *pvParameters)
 {
     GlobalState * GLOBAL_STATE = (GlobalState *)pvParameters;
@@ -152,6 +180,8 @@ void hashrate_monitor_task(void *pvParameters)
 
     HASHRATE_MONITOR_MODULE->is_initialized = true;
 
+    register_metrics(GLOBAL_STATE, asic_count);
+
     TickType_t taskWakeTime = xTaskGetTickCount();
     while (1) {
         ASIC_read_registers(GLOBAL_STATE);
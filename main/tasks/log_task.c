@@ -0,0 +1,167 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_memory_utils.h"
+#include "esp_psram.h"
+#include "esp_rom_sys.h"
+#include "esp_system.h"
+#include "esp_private/cache_utils.h"
+
+#include "log_task.h"
+
+#define LOG_TASK_POLL_MS 20
+#define LOG_TASK_LOCK_MS 50
+
+static const char * TAG = "log";
+
+// The head is updated atomically, which PSRAM does not support: only the slots live there
+static log_ring_t ring;
+static bool ring_ready = false;
+
+// The console's place in the ring; whoever holds console_lock prints from it
+static SemaphoreHandle_t console_lock;
+static uint32_t console_cursor;
+static uint32_t console_lost;
+static volatile bool console_running = false;
+
+// On the S3 the DROM window also maps PSRAM (heap, SPIRAM task stacks,
+// EXT_RAM BSS), which can be freed or reused before the line is read
+static bool is_static(const void * ptr)
+{
+    return esp_ptr_in_drom(ptr) && !esp_ptr_external_ram(ptr);
+}
+
+// Print every line the console has not printed yet; hold console_lock
+static void console_drain(void)
+{
+    char line[LOG_RING_LINE_SIZE];
+    log_record_t record;
+
+    while (log_ring_read(&ring, &console_cursor, &record, &console_lost)) {
+        if (console_lost > 0) {
+            printf("--- %lu log lines lost ---\n", (unsigned long) console_lost);
+            console_lost = 0;
+        }
+        log_ring_format(&record, line, sizeof(line));
+        fputs(line, stdout);
+    }
+}
+
+static void console_drain_now(TickType_t wait)
+{
+    if (xSemaphoreTake(console_lock, wait) == pdTRUE) {
+        console_drain();
+        xSemaphoreGive(console_lock);
+    }
+}
+
+static int log_to_ring(const char * format, va_list args)
+{
+    uint8_t level = log_ring_level(format);
+    log_ring_vwrite(&ring, level, format, args);
+
+    if (xPortInIsrContext() || xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+        return 0;
+    }
+
+    // Errors reach the UART before the call returns: the next thing may be
+    // an abort or a reset. So does everything until the console task runs,
+    // and a backlog the starved console task would otherwise lose.
+    if (level == 'E' || !console_running) {
+        console_drain_now(pdMS_TO_TICKS(LOG_TASK_LOCK_MS));
+    } else if (log_ring_head(&ring) - console_cursor > ring.count / 2) {
+        console_drain_now(0);
+    }
+    return 0;
+}
+
+static void log_task(void * pvParameters)
+{
+    console_running = true;
+
+    while (1) {
+        console_drain_now(portMAX_DELAY);
+        vTaskDelay(pdMS_TO_TICKS(LOG_TASK_POLL_MS));
+    }
+}
+
+// Restarts: print what is left before the chip resets
+static void log_task_shutdown(void)
+{
+    console_drain_now(pdMS_TO_TICKS(LOG_TASK_LOCK_MS));
+}
+
+extern void __real_esp_panic_handler(void * info);
+
+// Panics: print what is left with the ROM printer, ahead of the panic
+// report. Skipped when the flash cache is off, since the ring code and
+// the format strings are in flash.
+void IRAM_ATTR __wrap_esp_panic_handler(void * info)
+{
+    if (ring_ready && spi_flash_cache_enabled()) {
+        char line[LOG_RING_LINE_SIZE];
+        log_record_t record;
+        uint32_t cursor = console_cursor;
+        uint32_t lost = 0;
+        while (log_ring_read(&ring, &cursor, &record, &lost)) {
+            log_ring_format(&record, line, sizeof(line));
+            esp_rom_printf("%s", line);
+        }
+    }
+    __real_esp_panic_handler(info);
+}
+
+void log_task_init(void)
+{
+    // Without PSRAM a smaller ring in internal RAM still feeds /api/ws and /api/system/logs
+    bool psram = esp_psram_is_initialized();
+    uint32_t caps = psram ? MALLOC_CAP_SPIRAM : MALLOC_CAP_INTERNAL;
+    uint32_t lines = psram ? CONFIG_LOG_RING_LINES : CONFIG_LOG_RING_LINES_INTERNAL;
+    if (lines < 2) {
+        return;
+    }
+
+    uint32_t count = 1;
+    while (count * 2 <= lines) {
+        count *= 2;
+    }
+
+    log_slot_t * slots = heap_caps_malloc(count * sizeof(log_slot_t), caps);
+    if (slots == NULL || log_ring_init(&ring, slots, count, is_static) != ESP_OK) {
+        ESP_LOGE(TAG, "No memory for %lu log lines", (unsigned long) count);
+        free(slots);
+        return;
+    }
+
+    console_lock = xSemaphoreCreateMutex();
+    if (console_lock == NULL) {
+        ESP_LOGE(TAG, "Error creating console lock");
+        free(slots);
+        return;
+    }
+
+    // Lowest priority: the console prints whenever nothing else needs the CPU
+    if (xTaskCreateWithCaps(log_task, "log", 4096, NULL, 1, NULL, caps) != pdPASS) {
+        ESP_LOGE(TAG, "Error creating log task");
+        vSemaphoreDelete(console_lock);
+        free(slots);
+        return;
+    }
+
+    ring_ready = true;
+    esp_log_set_vprintf(log_to_ring);
+    esp_register_shutdown_handler(log_task_shutdown);
+    ESP_LOGI(TAG, "Keeping %lu log lines in %s", (unsigned long) count, psram ? "PSRAM" : "internal RAM");
+}
+
+const log_ring_t * log_task_ring(void)
+{
+    return ring_ready ? &ring : NULL;
+}
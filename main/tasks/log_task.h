@@ -0,0 +1,25 @@
+#ifndef LOG_TASK_H_
+#define LOG_TASK_H_
+
+#include "log_ring.h"
+
+/**
+ * @brief Send ESP_LOGx output to the log ring and start the task that
+ *        prints it to the UART console
+ *
+ * Errors, and any line logged before the console task runs, are printed
+ * before the log call returns. Lines still in the ring are printed on
+ * restart and ahead of a panic report.
+ *
+ * Call first thing in app_main. Without PSRAM the ring is smaller and in
+ * internal RAM; with CONFIG_LOG_RING_LINES_INTERNAL at 0 there, logging
+ * stays as it was.
+ */
+void log_task_init(void);
+
+/**
+ * @brief The log ring, NULL if logging did not move to it
+ */
+const log_ring_t * log_task_ring(void);
+
+#endif /* LOG_TASK_H_ */
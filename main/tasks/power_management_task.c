@@ -4,6 +4,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "global_state.h"
+#include "metrics.h"
 #include "math.h"
 #include "mining.h"
 #include "nvs_config.h"
@@ -75,6 +76,33 @@ void POWER_MANAGEMENT_init_frequency(void * pvParameters)
     ESP_LOGI(TAG, "ASIC Frequency: %g MHz, Expected hashrate: %sH/s", frequency, expected_hashrate_str);
 }
 
+// Scrapes read what this task last measured; nothing touches I2C for /metrics
+static void register_metrics(PowerManagementModule * power_management)
+{
+    metrics_register("bitaxe_power_watts", METRICS_GAUGE, "Input power", NULL,
+                     METRICS_FLOAT, &power_management->power);
+    metrics_register("bitaxe_input_voltage_millivolts", METRICS_GAUGE, "Input voltage", NULL,
+                     METRICS_FLOAT, &power_management->voltage);
+    metrics_register("bitaxe_input_current_milliamps", METRICS_GAUGE, "Input current", NULL,
+                     METRICS_FLOAT, &power_management->current);
+    metrics_register("bitaxe_asic_temperature_celsius", METRICS_GAUGE, "Average ASIC temperature", "sensor=\"1\"",
+                     METRICS_FLOAT, &power_management->chip_temp_avg);
+    metrics_register("bitaxe_asic_temperature_celsius", METRICS_GAUGE, "Average ASIC temperature", "sensor=\"2\"",
+                     METRICS_FLOAT, &power_management->chip_temp2_avg);
+    metrics_register("bitaxe_vr_temperature_celsius", METRICS_GAUGE, "Voltage regulator temperature", NULL,
+                     METRICS_FLOAT, &power_management->vr_temp);
+    metrics_register("bitaxe_fan_speed_percent", METRICS_GAUGE, "Fan duty cycle", NULL,
+                     METRICS_FLOAT, &power_management->fan_perc);
+    metrics_register("bitaxe_fan_rpm", METRICS_GAUGE, "Fan speed", "fan=\"1\"",
+                     METRICS_U16, &power_management->fan_rpm);
+    metrics_register("bitaxe_fan_rpm", METRICS_GAUGE, "Fan speed", "fan=\"2\"",
+                     METRICS_U16, &power_management->fan2_rpm);
+    metrics_register("bitaxe_asic_frequency_mhz", METRICS_GAUGE, "ASIC frequency", NULL,
+                     METRICS_FLOAT, &power_management->frequency_value);
+    metrics_register("bitaxe_expected_hashrate_ghs", METRICS_GAUGE, "Hashrate expected at this frequency", NULL,
+                     METRICS_FLOAT, &power_management->expected_hashrate);
+}
+
 void POWER_MANAGEMENT_task(void * pvParameters)
 {
     ESP_LOGI(TAG, "Starting");
@@ -85,6 +113,7 @@ void POWER_MANAGEMENT_task(void * pvParameters)
     SystemModule * sys_module = &GLOBAL_STATE->SYSTEM_MODULE;
 
     POWER_MANAGEMENT_init_frequency(GLOBAL_STATE);
+    register_metrics(power_management);
     
     float last_asic_frequency = power_management->frequency_value;
 
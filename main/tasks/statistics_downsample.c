@@ -0,0 +1,118 @@
+#include <math.h>
+#include "statistics_downsample.h"
+
+// Timestamps relative to the first row, so a wrapped millisecond counter still increases
+static double x_at(const uint32_t * x, uint16_t i)
+{
+    return (double)(uint32_t)(x[i] - x[0]);
+}
+
+static uint16_t keep_all(uint16_t count, uint16_t * out)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        out[i] = i;
+    }
+    return count;
+}
+
+static uint16_t lttb(const uint32_t * x, const float * y, uint16_t count, uint16_t points, uint16_t * out)
+{
+    uint16_t n = 0;
+    out[n++] = 0;
+    if (points < 3) {
+        if (points == 2) {
+            out[n++] = count - 1;
+        }
+        return n;
+    }
+
+    // Rows between the first and the last, split into points - 2 buckets
+    const double every = (double)(count - 2) / (points - 2);
+    uint16_t a = 0;
+
+    for (uint16_t bucket = 0; bucket < points - 2; bucket++) {
+        // Average of the next bucket (the last row after the final one)
+        uint16_t next_start = (uint16_t)floor((bucket + 1) * every) + 1;
+        uint16_t next_end = (uint16_t)floor((bucket + 2) * every) + 1;
+        if (next_end > count) {
+            next_end = count;
+        }
+        if (next_start >= next_end) {
+            next_start = count - 1;
+            next_end = count;
+        }
+        double avg_x = 0;
+        double avg_y = 0;
+        for (uint16_t i = next_start; i < next_end; i++) {
+            avg_x += x_at(x, i);
+            avg_y += y[i];
+        }
+        avg_x /= next_end - next_start;
+        avg_y /= next_end - next_start;
+
+        // Row of this bucket with the largest triangle against the last pick and that average
+        uint16_t start = (uint16_t)floor(bucket * every) + 1;
+        uint16_t end = (uint16_t)floor((bucket + 1) * every) + 1;
+        const double ax = x_at(x, a);
+        const double ay = y[a];
+        double best_area = -1;
+        uint16_t best = start;
+        for (uint16_t i = start; i < end; i++) {
+            double area = fabs((ax - avg_x) * (y[i] - ay) - (ax - x_at(x, i)) * (avg_y - ay));
+            if (area > best_area) {
+                best_area = area;
+                best = i;
+            }
+        }
+        out[n++] = best;
+        a = best;
+    }
+
+    out[n++] = count - 1;
+    return n;
+}
+
+static uint16_t min_max(const float * y, uint16_t count, uint16_t points, uint16_t * out)
+{
+    const uint16_t buckets = points / 2;
+    uint16_t n = 0;
+
+    for (uint16_t bucket = 0; bucket < buckets; bucket++) {
+        uint16_t start = (uint32_t)bucket * count / buckets;
+        uint16_t end = (uint32_t)(bucket + 1) * count / buckets;
+        uint16_t lo = start;
+        uint16_t hi = start;
+        for (uint16_t i = start + 1; i < end; i++) {
+            if (y[i] < y[lo]) {
+                lo = i;
+            }
+            if (y[i] > y[hi]) {
+                hi = i;
+            }
+        }
+        // In time order, once if the bucket is flat
+        uint16_t first = lo < hi ? lo : hi;
+        uint16_t second = lo < hi ? hi : lo;
+        out[n++] = first;
+        if (second != first) {
+            out[n++] = second;
+        }
+    }
+    return n;
+}
+
+uint16_t statistics_downsample(StatsDownsample method, const uint32_t * x, const float * y,
+                               uint16_t count, uint16_t points, uint16_t * out)
+{
+    if (count == 0) {
+        return 0;
+    }
+    if (points == 0 || points >= count) {
+        return keep_all(count, out);
+    }
+
+    if (method == STATS_DOWNSAMPLE_MINMAX && points >= 2) {
+        return min_max(y, count, points, out);
+    }
+    return lttb(x, y, count, points, out);
+}
@@ -0,0 +1,31 @@
+#ifndef STATISTICS_DOWNSAMPLE_H_
+#define STATISTICS_DOWNSAMPLE_H_
+
+#include <stdint.h>
+
+// Pick which statistics rows to chart when there are more rows than points.
+// Both methods choose by one series against the row timestamps and return
+// row indices, oldest first, so every other column can be cut to the same
+// rows:
+//
+//   - LTTB (largest triangle three buckets) keeps the visual shape
+//   - min/max keeps every spike, at two rows per bucket
+
+typedef enum
+{
+    STATS_DOWNSAMPLE_LTTB,
+    STATS_DOWNSAMPLE_MINMAX,
+} StatsDownsample;
+
+/**
+ * @brief Choose at most points rows out of count
+ *
+ * With points 0 or at least count every row is kept.
+ *
+ * @param out Row indices, room for count (or points, if smaller)
+ * @return Rows written to out
+ */
+uint16_t statistics_downsample(StatsDownsample method, const uint32_t * x, const float * y,
+                               uint16_t count, uint16_t points, uint16_t * out);
+
+#endif // STATISTICS_DOWNSAMPLE_H_
@@ -0,0 +1,576 @@
+#include <string.h>
+#include "statistics_history.h"
+
+#define HEADER_MAGIC    0x31485453u     // "STH1"
+#define HEADER_SIZE     12              // Magic, seq, level, record size, reserved
+#define READ_BATCH      8               // Records per flash read
+
+static const uint32_t periods[STATS_HISTORY_LEVELS] = { 5, 60, 15 * 60, 60 * 60 };
+
+// ============================================================================
+// Encoding
+// ============================================================================
+
+static void put_u16(uint8_t * p, uint16_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static void put_u32(uint8_t * p, uint32_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static void put_f32(uint8_t * p, float v)
+{
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    put_u32(p, bits);
+}
+
+static uint16_t get_u16(const uint8_t * p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t * p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static float get_f32(const uint8_t * p)
+{
+    uint32_t bits = get_u32(p);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+// CRC-16/CCITT-FALSE
+static uint16_t crc16(const uint8_t * data, size_t len, uint16_t crc)
+{
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+// Record: time u32, samples u16, crc u16, then six floats. The CRC skips its own field.
+static uint16_t record_crc(const uint8_t * slot)
+{
+    return crc16(slot + 8, STATS_HISTORY_RECORD_SIZE - 8, crc16(slot, 6, 0xFFFF));
+}
+
+static void encode_record(uint8_t * slot, const StatsHistoryRecord * record)
+{
+    put_u32(slot, record->time);
+    put_u16(slot + 4, record->samples);
+    put_f32(slot + 8, record->hashrate);
+    put_f32(slot + 12, record->hashrateMin);
+    put_f32(slot + 16, record->hashrateMax);
+    put_f32(slot + 20, record->power);
+    put_f32(slot + 24, record->chipTemperature);
+    put_f32(slot + 28, record->errorPercentage);
+    put_u16(slot + 6, record_crc(slot));
+}
+
+static bool decode_record(const uint8_t * slot, StatsHistoryRecord * record)
+{
+    record->time = get_u32(slot);
+    record->samples = get_u16(slot + 4);
+    if (record->time == UINT32_MAX || record->samples == 0 || get_u16(slot + 6) != record_crc(slot)) {
+        return false;
+    }
+    record->hashrate = get_f32(slot + 8);
+    record->hashrateMin = get_f32(slot + 12);
+    record->hashrateMax = get_f32(slot + 16);
+    record->power = get_f32(slot + 20);
+    record->chipTemperature = get_f32(slot + 24);
+    record->errorPercentage = get_f32(slot + 28);
+    return true;
+}
+
+static bool erased(const uint8_t * slot)
+{
+    for (int i = 0; i < STATS_HISTORY_RECORD_SIZE; i++) {
+        if (slot[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Sectors
+// ============================================================================
+
+static uint32_t sector_offset(const StatsHistoryRing * ring, uint16_t index)
+{
+    return (uint32_t)(ring->firstSector + index) * STATS_HISTORY_SECTOR_SIZE;
+}
+
+static uint32_t parse_header(const uint8_t * header, StatsHistoryLevel level)
+{
+    if (get_u32(header) != HEADER_MAGIC || header[8] != level || header[9] != STATS_HISTORY_RECORD_SIZE ||
+        get_u16(header + HEADER_SIZE) != crc16(header, HEADER_SIZE, 0xFFFF)) {
+        return 0;
+    }
+    return get_u32(header + 4);
+}
+
+/**
+ * @brief Sequence number of a formatted sector of this level, 0 if not
+ */
+static uint32_t read_header(const StatsHistory * history, StatsHistoryLevel level, uint16_t index)
+{
+    const StatsHistoryRing * ring = &history->rings[level];
+    uint8_t header[HEADER_SIZE + 2];
+
+    if (history->flash.read(history->flash.ctx, sector_offset(ring, index), header, sizeof(header)) != ESP_OK) {
+        return 0;
+    }
+    return parse_header(header, level);
+}
+
+/**
+ * @brief Erase the next sector of the ring and make it the head
+ */
+static esp_err_t advance(StatsHistory * history, StatsHistoryLevel level)
+{
+    StatsHistoryRing * ring = &history->rings[level];
+    const uint16_t next = (ring->seq == 0) ? 0 : (ring->head + 1) % ring->sectors;
+    const uint32_t offset = sector_offset(ring, next);
+
+    esp_err_t err = history->flash.erase(history->flash.ctx, offset, STATS_HISTORY_SECTOR_SIZE);
+    if (err != ESP_OK) {
+        return err;
+    }
+    history->erases++;
+
+    uint8_t header[STATS_HISTORY_RECORD_SIZE];
+    memset(header, 0xFF, sizeof(header));
+    put_u32(header, HEADER_MAGIC);
+    put_u32(header + 4, ring->seq + 1);
+    header[8] = level;
+    header[9] = STATS_HISTORY_RECORD_SIZE;
+    header[10] = 0;
+    header[11] = 0;
+    put_u16(header + HEADER_SIZE, crc16(header, HEADER_SIZE, 0xFFFF));
+
+    err = history->flash.write(history->flash.ctx, offset, header, sizeof(header));
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    ring->head = next;
+    ring->seq++;
+    ring->slot = 1;
+    return ESP_OK;
+}
+
+static esp_err_t append(StatsHistory * history, StatsHistoryLevel level, const StatsHistoryRecord * record)
+{
+    StatsHistoryRing * ring = &history->rings[level];
+
+    if (ring->seq == 0 || ring->slot >= STATS_HISTORY_SLOTS) {
+        esp_err_t err = advance(history, level);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    uint8_t slot[STATS_HISTORY_RECORD_SIZE];
+    encode_record(slot, record);
+
+    // A failed write may have left some bits behind, so the slot is used up either way
+    const uint32_t offset = sector_offset(ring, ring->head) + ring->slot * STATS_HISTORY_RECORD_SIZE;
+    ring->slot++;
+    esp_err_t err = history->flash.write(history->flash.ctx, offset, slot, sizeof(slot));
+    if (err == ESP_OK) {
+        history->writes++;
+    }
+    return err;
+}
+
+/**
+ * @brief Walk the valid records of one sector, from slot 1 up to end
+ * @return false if the callback stopped or the flash could not be read
+ */
+static bool scan_sector(const StatsHistory * history, const StatsHistoryRing * ring, uint16_t index, uint16_t end,
+                        StatsHistoryCallback callback, void * ctx)
+{
+    uint8_t batch[READ_BATCH * STATS_HISTORY_RECORD_SIZE];
+    StatsHistoryRecord record;
+
+    for (uint16_t slot = 1; slot < end; slot += READ_BATCH) {
+        const uint16_t count = (end - slot < READ_BATCH) ? end - slot : READ_BATCH;
+        const uint32_t offset = sector_offset(ring, index) + slot * STATS_HISTORY_RECORD_SIZE;
+
+        if (history->flash.read(history->flash.ctx, offset, batch, count * STATS_HISTORY_RECORD_SIZE) != ESP_OK) {
+            return false;
+        }
+        for (uint16_t i = 0; i < count; i++) {
+            if (decode_record(&batch[i * STATS_HISTORY_RECORD_SIZE], &record) && !callback(ctx, &record)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool keep_last(void * ctx, const StatsHistoryRecord * record)
+{
+    *(StatsHistoryRecord *)ctx = *record;
+    return true;
+}
+
+static bool keep_first(void * ctx, const StatsHistoryRecord * record)
+{
+    *(StatsHistoryRecord *)ctx = *record;
+    return false;
+}
+
+/**
+ * @brief Check a sector's sequence number and get its first record
+ *
+ * Header and first record come in one read; the rest of the sector is
+ * only read if that record is not valid.
+ *
+ * @return false if the sector is not the expected one
+ */
+static bool sector_first(const StatsHistory * history, StatsHistoryLevel level, uint16_t index, uint32_t seq,
+                         StatsHistoryRecord * first)
+{
+    const StatsHistoryRing * ring = &history->rings[level];
+    uint8_t slots[2 * STATS_HISTORY_RECORD_SIZE];
+
+    first->samples = 0;
+    if (history->flash.read(history->flash.ctx, sector_offset(ring, index), slots, sizeof(slots)) != ESP_OK ||
+        parse_header(slots, level) != seq) {
+        return false;
+    }
+    if (!decode_record(&slots[STATS_HISTORY_RECORD_SIZE], first)) {
+        first->samples = 0;
+        scan_sector(history, ring, index, STATS_HISTORY_SLOTS, keep_first, first);
+    }
+    return true;
+}
+
+/**
+ * @brief Newest record of a level on flash
+ */
+static bool newest_record(const StatsHistory * history, StatsHistoryLevel level, StatsHistoryRecord * record)
+{
+    const StatsHistoryRing * ring = &history->rings[level];
+    record->samples = 0;
+
+    if (ring->seq == 0) {
+        return false;
+    }
+    scan_sector(history, ring, ring->head, ring->slot, keep_last, record);
+    if (record->samples == 0 && ring->seq > 1) {
+        // Head was just started: the sector before it
+        const uint16_t previous = (ring->head + ring->sectors - 1) % ring->sectors;
+        if (read_header(history, level, previous) == ring->seq - 1) {
+            scan_sector(history, ring, previous, STATS_HISTORY_SLOTS, keep_last, record);
+        }
+    }
+    return record->samples != 0;
+}
+
+// ============================================================================
+// Rollups
+// ============================================================================
+
+static void rollup_add(StatsHistoryRollup * rollup, uint32_t start, const StatsHistoryRecord * record)
+{
+    if (rollup->samples == 0) {
+        rollup->start = start;
+        rollup->hashrateMin = record->hashrateMin;
+        rollup->hashrateMax = record->hashrateMax;
+    }
+    rollup->samples += record->samples;
+    rollup->hashrate += (double)record->hashrate * record->samples;
+    rollup->power += (double)record->power * record->samples;
+    rollup->chipTemperature += (double)record->chipTemperature * record->samples;
+    rollup->errorPercentage += (double)record->errorPercentage * record->samples;
+    if (record->hashrateMin < rollup->hashrateMin) {
+        rollup->hashrateMin = record->hashrateMin;
+    }
+    if (record->hashrateMax > rollup->hashrateMax) {
+        rollup->hashrateMax = record->hashrateMax;
+    }
+}
+
+static void rollup_record(const StatsHistoryRollup * rollup, StatsHistoryRecord * record)
+{
+    record->time = rollup->start;
+    record->samples = (rollup->samples > UINT16_MAX) ? UINT16_MAX : rollup->samples;
+    record->hashrate = rollup->hashrate / rollup->samples;
+    record->hashrateMin = rollup->hashrateMin;
+    record->hashrateMax = rollup->hashrateMax;
+    record->power = rollup->power / rollup->samples;
+    record->chipTemperature = rollup->chipTemperature / rollup->samples;
+    record->errorPercentage = rollup->errorPercentage / rollup->samples;
+}
+
+static esp_err_t fold(StatsHistory * history, StatsHistoryLevel level, const StatsHistoryRecord * record);
+
+/**
+ * @brief Write out the rollups, from this level up, whose period ended before now
+ */
+static esp_err_t roll(StatsHistory * history, StatsHistoryLevel level, uint32_t now)
+{
+    StatsHistoryRollup * rollup = &history->rings[level].rollup;
+    esp_err_t err = ESP_OK;
+
+    if (rollup->samples != 0 && rollup->start != now - now % periods[level]) {
+        StatsHistoryRecord done;
+        rollup_record(rollup, &done);
+        memset(rollup, 0, sizeof(*rollup));
+
+        err = append(history, level, &done);
+        if (level + 1 < STATS_HISTORY_LEVELS) {
+            esp_err_t up = fold(history, level + 1, &done);
+            if (err == ESP_OK) {
+                err = up;
+            }
+        }
+    }
+
+    if (level + 1 < STATS_HISTORY_LEVELS) {
+        esp_err_t up = roll(history, level + 1, now);
+        if (err == ESP_OK) {
+            err = up;
+        }
+    }
+    return err;
+}
+
+/**
+ * @brief Fold a record of the level below into a level's rollup
+ */
+static esp_err_t fold(StatsHistory * history, StatsHistoryLevel level, const StatsHistoryRecord * record)
+{
+    esp_err_t err = roll(history, level, record->time);
+    rollup_add(&history->rings[level].rollup, record->time - record->time % periods[level], record);
+    return err;
+}
+
+typedef struct
+{
+    StatsHistoryRollup * rollup;
+    uint32_t start;
+} RebuildContext;
+
+static bool rebuild_add(void * ctx, const StatsHistoryRecord * record)
+{
+    RebuildContext * rebuild = (RebuildContext *)ctx;
+    rollup_add(rebuild->rollup, rebuild->start, record);
+    return true;
+}
+
+/**
+ * @brief Refold the records of the level below that are in the period of
+ *        the newest one, unless that period has been written out already
+ */
+static void rebuild_rollup(StatsHistory * history, StatsHistoryLevel level)
+{
+    StatsHistoryRecord below;
+    StatsHistoryRecord mine;
+
+    if (!newest_record(history, level - 1, &below)) {
+        return;
+    }
+    const uint32_t start = below.time - below.time % periods[level];
+    if (newest_record(history, level, &mine) && mine.time >= start) {
+        return;
+    }
+
+    RebuildContext rebuild = { .rollup = &history->rings[level].rollup, .start = start };
+    statistics_history_query(history, level - 1, start, start + periods[level] - 1, rebuild_add, &rebuild);
+}
+
+typedef struct
+{
+    uint32_t from;
+    uint32_t to;
+    StatsHistoryCallback callback;
+    void * ctx;
+    bool stopped;               // By the caller's callback
+} RangeContext;
+
+static bool in_range(void * ctx, const StatsHistoryRecord * record)
+{
+    RangeContext * range = (RangeContext *)ctx;
+    if (record->time < range->from || record->time > range->to) {
+        return true;
+    }
+    if (!range->callback(range->ctx, record)) {
+        range->stopped = true;
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+uint32_t statistics_history_period(StatsHistoryLevel level)
+{
+    return (level < STATS_HISTORY_LEVELS) ? periods[level] : 0;
+}
+
+esp_err_t statistics_history_mount(StatsHistory * history, const StatsHistoryFlash * flash, uint32_t size)
+{
+    if (history == NULL || flash == NULL || flash->read == NULL || flash->write == NULL || flash->erase == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (size < STATS_HISTORY_MIN_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    memset(history, 0, sizeof(*history));
+    history->flash = *flash;
+
+    // Raw gets half the sectors, 1 minute a quarter, 15 minute and 1 hour an eighth each
+    const uint32_t total = (size / STATS_HISTORY_SECTOR_SIZE > UINT16_MAX) ? UINT16_MAX : size / STATS_HISTORY_SECTOR_SIZE;
+    const uint16_t shares[STATS_HISTORY_LEVELS] = { total / 2, total / 4, total / 8, total - total / 2 - total / 4 - total / 8 };
+    uint16_t first = 0;
+
+    for (int level = 0; level < STATS_HISTORY_LEVELS; level++) {
+        StatsHistoryRing * ring = &history->rings[level];
+        ring->firstSector = first;
+        ring->sectors = shares[level];
+        first += shares[level];
+
+        // Head is the sector with the highest sequence number
+        for (uint16_t i = 0; i < ring->sectors; i++) {
+            uint32_t seq = read_header(history, level, i);
+            if (seq > ring->seq) {
+                ring->seq = seq;
+                ring->head = i;
+            }
+        }
+        if (ring->seq == 0) {
+            continue;
+        }
+
+        // Writing resumes after the last slot that is not erased
+        uint8_t batch[READ_BATCH * STATS_HISTORY_RECORD_SIZE];
+        ring->slot = 1;
+        for (uint16_t slot = 1; slot < STATS_HISTORY_SLOTS; slot += READ_BATCH) {
+            const uint16_t count = (STATS_HISTORY_SLOTS - slot < READ_BATCH) ? STATS_HISTORY_SLOTS - slot : READ_BATCH;
+            const uint32_t offset = sector_offset(ring, ring->head) + slot * STATS_HISTORY_RECORD_SIZE;
+            esp_err_t err = flash->read(flash->ctx, offset, batch, count * STATS_HISTORY_RECORD_SIZE);
+            if (err != ESP_OK) {
+                return err;
+            }
+            for (uint16_t i = 0; i < count; i++) {
+                if (!erased(&batch[i * STATS_HISTORY_RECORD_SIZE])) {
+                    ring->slot = slot + i + 1;
+                }
+            }
+        }
+    }
+
+    for (int level = STATS_HISTORY_1M; level < STATS_HISTORY_LEVELS; level++) {
+        rebuild_rollup(history, level);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t statistics_history_add(StatsHistory * history, const StatsHistoryRecord * sample)
+{
+    if (history == NULL || sample == NULL || sample->time < STATS_HISTORY_MIN_TIME || sample->time == UINT32_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    StatsHistoryRecord raw = *sample;
+    raw.samples = 1;
+    raw.hashrateMin = raw.hashrate;
+    raw.hashrateMax = raw.hashrate;
+
+    esp_err_t err = append(history, STATS_HISTORY_RAW, &raw);
+    esp_err_t up = fold(history, STATS_HISTORY_1M, &raw);
+    return (err != ESP_OK) ? err : up;
+}
+
+esp_err_t statistics_history_query(const StatsHistory * history, StatsHistoryLevel level,
+                                   uint32_t from, uint32_t to, StatsHistoryCallback callback, void * ctx)
+{
+    if (history == NULL || level >= STATS_HISTORY_LEVELS || callback == NULL || from > to) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const StatsHistoryRing * ring = &history->rings[level];
+    if (ring->seq == 0) {
+        return ESP_OK;
+    }
+
+    RangeContext range = { .from = from, .to = to, .callback = callback, .ctx = ctx, .stopped = false };
+
+    // Oldest first: the sector after the head holds seq - (sectors - 1), round to the head holding seq.
+    // Each step looks at the next sector's first record, so a sector that ends before the range is skipped.
+    int32_t back = (ring->seq - 1 < (uint32_t)ring->sectors - 1) ? (int32_t)ring->seq - 1 : ring->sectors - 1;
+    StatsHistoryRecord first;
+    bool valid = sector_first(history, level, (ring->head + ring->sectors - back) % ring->sectors, ring->seq - back, &first);
+
+    for (; back >= 0; back--) {
+        const uint16_t index = (ring->head + ring->sectors - back) % ring->sectors;
+        StatsHistoryRecord nextFirst = { .samples = 0 };
+        bool nextValid = false;
+        if (back > 0) {
+            nextValid = sector_first(history, level, (index + 1) % ring->sectors, ring->seq - back + 1, &nextFirst);
+        }
+
+        if (valid) {
+            if (first.samples != 0 && first.time > to) {
+                break;
+            }
+            const bool before = nextValid && nextFirst.samples != 0 && nextFirst.time < from;
+            const uint16_t end = (back == 0) ? ring->slot : STATS_HISTORY_SLOTS;
+            if (!before && !scan_sector(history, ring, index, end, in_range, &range) && range.stopped) {
+                break;
+            }
+        }
+
+        valid = nextValid;
+        first = nextFirst;
+    }
+
+    return ESP_OK;
+}
+
+uint32_t statistics_history_capacity(const StatsHistory * history, StatsHistoryLevel level)
+{
+    if (history == NULL || level >= STATS_HISTORY_LEVELS) {
+        return 0;
+    }
+    // The head sector is erased again once the ring wraps
+    return (uint32_t)(history->rings[level].sectors - 1) * (STATS_HISTORY_SLOTS - 1);
+}
+
+StatsHistoryLevel statistics_history_pick_level(const StatsHistory * history, uint32_t from, uint32_t to,
+                                                uint32_t maxPoints, uint32_t now)
+{
+    const uint32_t age = (now > from) ? now - from : 0;
+    const uint32_t span = (to > from) ? to - from : 0;
+
+    for (int level = STATS_HISTORY_RAW; level < STATS_HISTORY_1H; level++) {
+        const uint64_t kept = (uint64_t)statistics_history_capacity(history, level) * periods[level];
+        if (age <= kept && span / periods[level] + 1 <= maxPoints) {
+            return level;
+        }
+    }
+    return STATS_HISTORY_1H;
+}
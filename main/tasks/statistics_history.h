@@ -0,0 +1,153 @@
+#ifndef STATISTICS_HISTORY_H_
+#define STATISTICS_HISTORY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Long-term statistics in the "stats" flash partition, as four rings of 4 KB
+// sectors: raw samples and 1 minute, 15 minute and 1 hour rollups. Each ring
+// is an append-only log of STATS_HISTORY_RECORD_SIZE byte records:
+//
+//   - a sector starts with a header slot (magic, sequence, level) and is
+//     only erased right before it is reused, so wear is even
+//   - records carry a CRC, so a write cut short by a power loss is skipped
+//   - rollups are folded incrementally in RAM and rebuilt from the level
+//     below after a reboot
+//
+// Times are Unix seconds, so samples are only recorded once the clock has
+// been set.
+
+#define STATS_HISTORY_SECTOR_SIZE   4096
+#define STATS_HISTORY_RECORD_SIZE   32
+#define STATS_HISTORY_SLOTS         (STATS_HISTORY_SECTOR_SIZE / STATS_HISTORY_RECORD_SIZE)    // Header + records
+
+// Smallest partition: two sectors per ring
+#define STATS_HISTORY_MIN_SIZE      (16 * STATS_HISTORY_SECTOR_SIZE)
+
+// Samples before this are from a clock that has not been set
+#define STATS_HISTORY_MIN_TIME      1600000000u
+
+typedef enum
+{
+    STATS_HISTORY_RAW,
+    STATS_HISTORY_1M,
+    STATS_HISTORY_15M,
+    STATS_HISTORY_1H,
+    STATS_HISTORY_LEVELS,
+} StatsHistoryLevel;
+
+/**
+ * @brief One sample, or the rollup of a period
+ */
+typedef struct
+{
+    uint32_t time;              // Unix seconds: the sample, or the start of the period
+    uint16_t samples;           // Raw samples folded in
+    float hashrate;             // GH/s, mean
+    float hashrateMin;
+    float hashrateMax;
+    float power;                // W, mean
+    float chipTemperature;      // °C, mean
+    float errorPercentage;      // Mean
+} StatsHistoryRecord;
+
+/**
+ * @brief Partition access, offsets from its start
+ *
+ * Erase is sector aligned and sets bytes to 0xFF; write only clears bits.
+ */
+typedef struct
+{
+    esp_err_t (*read)(void * ctx, uint32_t offset, void * buf, size_t len);
+    esp_err_t (*write)(void * ctx, uint32_t offset, const void * buf, size_t len);
+    esp_err_t (*erase)(void * ctx, uint32_t offset, size_t len);
+    void * ctx;
+} StatsHistoryFlash;
+
+typedef struct
+{
+    uint32_t start;             // Period start
+    uint32_t samples;           // 0 = nothing folded in yet
+    double hashrate;            // Sums weighted by samples
+    double power;
+    double chipTemperature;
+    double errorPercentage;
+    float hashrateMin;
+    float hashrateMax;
+} StatsHistoryRollup;
+
+typedef struct
+{
+    uint16_t firstSector;       // In the partition
+    uint16_t sectors;
+    uint16_t head;              // Sector being written, in the ring
+    uint16_t slot;              // Next record slot in it; STATS_HISTORY_SLOTS = full
+    uint32_t seq;               // Head's sequence number, 0 = ring never written
+    StatsHistoryRollup rollup;  // Rollups only: the period in progress
+} StatsHistoryRing;
+
+typedef struct
+{
+    StatsHistoryFlash flash;
+    StatsHistoryRing rings[STATS_HISTORY_LEVELS];
+    uint32_t writes;            // Records written since mount
+    uint32_t erases;            // Sectors erased since mount
+} StatsHistory;
+
+/**
+ * @brief Called per record in range, oldest first
+ * @return false to stop
+ */
+typedef bool (*StatsHistoryCallback)(void * ctx, const StatsHistoryRecord * record);
+
+/**
+ * @brief Seconds per record of a level (the nominal 5 s for raw)
+ */
+uint32_t statistics_history_period(StatsHistoryLevel level);
+
+/**
+ * @brief Find each ring's head and rebuild the rollups in progress
+ *
+ * An unformatted partition mounts empty; sectors are formatted as the
+ * rings first reach them.
+ *
+ * @param size Partition size, at least STATS_HISTORY_MIN_SIZE
+ */
+esp_err_t statistics_history_mount(StatsHistory * history, const StatsHistoryFlash * flash, uint32_t size);
+
+/**
+ * @brief Record a sample and roll it up
+ *
+ * The sample's samples, hashrateMin and hashrateMax are ignored.
+ *
+ * @return ESP_ERR_INVALID_ARG for a time before STATS_HISTORY_MIN_TIME,
+ *         or a flash error
+ */
+esp_err_t statistics_history_add(StatsHistory * history, const StatsHistoryRecord * sample);
+
+/**
+ * @brief Read the records of one level with from <= time <= to
+ *
+ * Only records on flash: the rollup of the period in progress is not
+ * included. The history may be a copy taken while holding the caller's
+ * lock; records appended or erased while the query runs are either seen
+ * whole or skipped.
+ */
+esp_err_t statistics_history_query(const StatsHistory * history, StatsHistoryLevel level,
+                                   uint32_t from, uint32_t to, StatsHistoryCallback callback, void * ctx);
+
+/**
+ * @brief Records a level always holds, however far its ring has wrapped
+ */
+uint32_t statistics_history_capacity(const StatsHistory * history, StatsHistoryLevel level);
+
+/**
+ * @brief Finest level that still reaches back to from and covers
+ *        from..to in at most maxPoints records
+ */
+StatsHistoryLevel statistics_history_pick_level(const StatsHistory * history, uint32_t from, uint32_t to,
+                                                uint32_t maxPoints, uint32_t now);
+
+#endif // STATISTICS_HISTORY_H_
@@ -1,6 +1,9 @@
 #include <stdint.h>
+#include <string.h>
 #include <pthread.h>
+#include <time.h>
 #include "esp_log.h"
+#include "esp_partition.h"
 #include "esp_timer.h"
 #include <esp_heap_caps.h>
 #include "freertos/FreeRTOS.h"
@@ -22,7 +25,11 @@ static uint16_t statisticsDataStart;
 static uint16_t statisticsDataSize;
 static pthread_mutex_t statisticsDataLock = PTHREAD_MUTEX_INITIALIZER;
 
-static const uint16_t maxDataCount = 720;
+static const uint16_t maxDataCount = STATISTICS_MAX_DATA_COUNT;
+
+static StatsHistory statisticsHistory;
+static bool statisticsHistoryMounted;
+static pthread_mutex_t statisticsHistoryLock = PTHREAD_MUTEX_INITIALIZER;
 
 void createStatisticsBuffer()
 {
@@ -109,6 +116,128 @@ bool getStatisticData(uint16_t index, StatisticsDataPtr dataOut)
     return result;
 }
 
+uint16_t getStatisticSnapshot(StatisticsDataPtr dataOut, uint16_t maxCount)
+{
+    uint16_t count = 0;
+
+    if ((NULL == statisticsBuffer) || (NULL == dataOut)) {
+        return count;
+    }
+
+    pthread_mutex_lock(&statisticsDataLock);
+
+    if (NULL != statisticsBuffer) {
+        count = (statisticsDataSize < maxCount) ? statisticsDataSize : maxCount;
+
+        // The ring is at most two runs: start to the end of the buffer, then from the beginning
+        const uint16_t first = statisticsDataStart;
+        const uint16_t firstRun = ((maxDataCount - first) < count) ? (maxDataCount - first) : count;
+        memcpy(dataOut, &statisticsBuffer[first], firstRun * sizeof(struct StatisticsData));
+        memcpy(&dataOut[firstRun], statisticsBuffer, (count - firstRun) * sizeof(struct StatisticsData));
+    }
+
+    pthread_mutex_unlock(&statisticsDataLock);
+
+    return count;
+}
+
+static esp_err_t historyRead(void * ctx, uint32_t offset, void * buf, size_t len)
+{
+    return esp_partition_read((const esp_partition_t *)ctx, offset, buf, len);
+}
+
+static esp_err_t historyWrite(void * ctx, uint32_t offset, const void * buf, size_t len)
+{
+    return esp_partition_write((const esp_partition_t *)ctx, offset, buf, len);
+}
+
+static esp_err_t historyErase(void * ctx, uint32_t offset, size_t len)
+{
+    return esp_partition_erase_range((const esp_partition_t *)ctx, offset, len);
+}
+
+static void mountStatisticsHistory()
+{
+    const esp_partition_t * partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, STATISTICS_HISTORY_SUBTYPE,
+                                                                 STATISTICS_HISTORY_PARTITION);
+    if (NULL == partition) {
+        // Partition tables are not updated over OTA: a full flash adds it
+        ESP_LOGW(TAG, "No \"%s\" partition, long-term statistics disabled", STATISTICS_HISTORY_PARTITION);
+        return;
+    }
+
+    const StatsHistoryFlash flash = {
+        .read = historyRead,
+        .write = historyWrite,
+        .erase = historyErase,
+        .ctx = (void *)partition,
+    };
+
+    pthread_mutex_lock(&statisticsHistoryLock);
+    esp_err_t err = statistics_history_mount(&statisticsHistory, &flash, partition->size);
+    statisticsHistoryMounted = (ESP_OK == err);
+    pthread_mutex_unlock(&statisticsHistoryLock);
+
+    if (ESP_OK != err) {
+        ESP_LOGE(TAG, "Long-term statistics mount failed: %s", esp_err_to_name(err));
+        return;
+    }
+    ESP_LOGI(TAG, "Long-term statistics: %lu KB, %lu days at 15 min", (unsigned long)(partition->size / 1024),
+             (unsigned long)(statistics_history_capacity(&statisticsHistory, STATS_HISTORY_15M) *
+                             statistics_history_period(STATS_HISTORY_15M) / 86400));
+}
+
+static void addStatisticHistory(const struct StatisticsData * data)
+{
+    const time_t now = time(NULL);
+    if (!statisticsHistoryMounted || now < STATS_HISTORY_MIN_TIME) {
+        return;
+    }
+
+    const StatsHistoryRecord sample = {
+        .time = (uint32_t)now,
+        .hashrate = data->hashrate,
+        .power = data->power,
+        .chipTemperature = data->chipTemperature,
+        .errorPercentage = data->errorPercentage,
+    };
+
+    pthread_mutex_lock(&statisticsHistoryLock);
+    esp_err_t err = statistics_history_add(&statisticsHistory, &sample);
+    pthread_mutex_unlock(&statisticsHistoryLock);
+
+    if (ESP_OK != err) {
+        ESP_LOGW(TAG, "Long-term statistics write failed: %s", esp_err_to_name(err));
+    }
+}
+
+esp_err_t getStatisticHistory(StatsHistoryLevel level, uint32_t from, uint32_t to,
+                              StatsHistoryCallback callback, void * ctx)
+{
+    StatsHistory history;
+
+    pthread_mutex_lock(&statisticsHistoryLock);
+    const bool mounted = statisticsHistoryMounted;
+    history = statisticsHistory;
+    pthread_mutex_unlock(&statisticsHistoryLock);
+
+    if (!mounted) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // Read from the copy without the lock, so sampling never waits on a long response
+    return statistics_history_query(&history, level, from, to, callback, ctx);
+}
+
+StatsHistoryLevel pickStatisticHistoryLevel(uint32_t from, uint32_t to, uint32_t maxPoints)
+{
+    pthread_mutex_lock(&statisticsHistoryLock);
+    StatsHistoryLevel level = statistics_history_pick_level(&statisticsHistory, from, to, maxPoints, (uint32_t)time(NULL));
+    pthread_mutex_unlock(&statisticsHistoryLock);
+
+    return level;
+}
+
 void statistics_task(void * pvParameters)
 {
     ESP_LOGI(TAG, "Starting");
@@ -118,6 +247,8 @@ void statistics_task(void * pvParameters)
     PowerManagementModule * power_management = &GLOBAL_STATE->POWER_MANAGEMENT_MODULE;
     struct StatisticsData statsData = {};
 
+    mountStatisticsHistory();
+
     TickType_t taskWakeTime = xTaskGetTickCount();
 
     while (1) {
@@ -125,6 +256,15 @@ void statistics_task(void * pvParameters)
         const uint16_t configStatsFrequency = nvs_config_get_u16(NVS_CONFIG_STATISTICS_FREQUENCY);
         const uint32_t statsFrequency = configStatsFrequency * 1000;
 
+        // Long-term history takes every poll, whatever the chart buffer's frequency
+        struct StatisticsData historyData = {
+            .hashrate = sys_module->current_hashrate,
+            .errorPercentage = sys_module->error_percentage,
+            .chipTemperature = power_management->chip_temp_avg,
+            .power = power_management->power,
+        };
+        addStatisticHistory(&historyData);
+
         if (0 != statsFrequency) {
             const int32_t waitingTime = statsData.timestamp + statsFrequency - (DEFAULT_POLL_RATE / 2);
 
@@ -1,6 +1,8 @@
 #ifndef STATISTICS_TASK_H_
 #define STATISTICS_TASK_H_
 
+#include "statistics_history.h"
+
 typedef struct StatisticsData * StatisticsDataPtr;
 
 struct StatisticsData
@@ -24,8 +26,25 @@ struct StatisticsData
     uint32_t freeHeap;
 };
 
+// Most rows the statistics buffer keeps
+#define STATISTICS_MAX_DATA_COUNT 720
+
+// Long-term history partition, see partitions.csv
+#define STATISTICS_HISTORY_PARTITION "stats"
+#define STATISTICS_HISTORY_SUBTYPE 0x40
+
 bool getStatisticData(uint16_t index, StatisticsDataPtr dataOut);
 
+// Copy up to maxCount rows, oldest first, under one lock; returns rows copied
+uint16_t getStatisticSnapshot(StatisticsDataPtr dataOut, uint16_t maxCount);
+
+// Long-term history records with from <= time <= to, oldest first; ESP_ERR_NOT_FOUND without the partition
+esp_err_t getStatisticHistory(StatsHistoryLevel level, uint32_t from, uint32_t to,
+                              StatsHistoryCallback callback, void * ctx);
+
+// Finest long-term history level that has from..to in at most maxPoints records
+StatsHistoryLevel pickStatisticHistoryLevel(uint32_t from, uint32_t to, uint32_t maxPoints);
+
 void statistics_task(void * pvParameters);
 
 #endif // STATISTICS_TASK_H_
@@ -15,6 +15,7 @@
 #include "esp_timer.h"
 #include <stdbool.h>
 #include "utils.h"
+#include "metrics.h"
 
 // Clusteraxe integration
 #include "cluster_config.h"
@@ -386,6 +387,42 @@ static void decode_mining_notification_secondary(GlobalState * GLOBAL_STATE, con
              GLOBAL_STATE->scriptsig_secondary ? GLOBAL_STATE->scriptsig_secondary : "NULL");
 }
 
+static const double response_time_bounds[] = { 10, 25, 50, 100, 250, 500, 1000, 2500, 5000 };
+static metrics_histogram_t response_time_histogram;
+
+static void register_metrics(GlobalState * GLOBAL_STATE)
+{
+    SystemModule * SYSTEM_MODULE = &GLOBAL_STATE->SYSTEM_MODULE;
+
+    metrics_register("bitaxe_shares_total", METRICS_COUNTER, "Shares answered by the pool", "result=\"accepted\"",
+                     METRICS_U64, &SYSTEM_MODULE->shares_accepted);
+    metrics_register("bitaxe_shares_total", METRICS_COUNTER, "Shares answered by the pool", "result=\"rejected\"",
+                     METRICS_U64, &SYSTEM_MODULE->shares_rejected);
+    metrics_register("bitaxe_stratum_notifications_total", METRICS_COUNTER, "mining.notify received on this connection", NULL,
+                     METRICS_U64, &SYSTEM_MODULE->work_received);
+    metrics_register("bitaxe_stratum_last_response_ms", METRICS_GAUGE, "Latest pool response time", "pool=\"primary\"",
+                     METRICS_DOUBLE, &SYSTEM_MODULE->response_time);
+    metrics_register("bitaxe_stratum_last_response_ms", METRICS_GAUGE, "Latest pool response time", "pool=\"secondary\"",
+                     METRICS_DOUBLE, &SYSTEM_MODULE->response_time_secondary);
+    metrics_register("bitaxe_stratum_using_fallback", METRICS_GAUGE, "1 while mining on the fallback pool", NULL,
+                     METRICS_BOOL, &SYSTEM_MODULE->is_using_fallback);
+    metrics_register("bitaxe_pool_difficulty", METRICS_GAUGE, "Share difficulty set by the pool", NULL,
+                     METRICS_U32, &GLOBAL_STATE->pool_difficulty);
+    metrics_register("bitaxe_best_difficulty", METRICS_GAUGE, "Best share difficulty", "scope=\"all\"",
+                     METRICS_U64, &SYSTEM_MODULE->best_nonce_diff);
+    metrics_register("bitaxe_best_difficulty", METRICS_GAUGE, "Best share difficulty", "scope=\"session\"",
+                     METRICS_U64, &SYSTEM_MODULE->best_session_nonce_diff);
+    metrics_register("bitaxe_network_difficulty", METRICS_GAUGE, "Network difficulty of the current job", NULL,
+                     METRICS_U64, &GLOBAL_STATE->network_nonce_diff);
+    metrics_register("bitaxe_block_height", METRICS_GAUGE, "Height of the block being mined", NULL,
+                     METRICS_I32, &GLOBAL_STATE->block_height);
+
+    metrics_histogram_init(&response_time_histogram, response_time_bounds,
+                           sizeof(response_time_bounds) / sizeof(response_time_bounds[0]));
+    metrics_register_histogram("bitaxe_stratum_response_ms", "Primary pool response times", NULL,
+                               &response_time_histogram);
+}
+
 void stratum_task(void * pvParameters)
 {
     GlobalState * GLOBAL_STATE = (GlobalState *) pvParameters;
@@ -398,6 +435,7 @@ void stratum_task(void * pvParameters)
     uint16_t difficulty = GLOBAL_STATE->SYSTEM_MODULE.pool_difficulty;
 
     STRATUM_V1_initialize_buffer();
+    register_metrics(GLOBAL_STATE);
     int retry_attempts = 0;
     int retry_critical_attempts = 0;
 
@@ -554,9 +592,15 @@ void stratum_task(void * pvParameters)
             if (response_time_ms >= 0) {
                 ESP_LOGI(TAG, "Primary stratum response time: %.2f ms", response_time_ms);
                 GLOBAL_STATE->SYSTEM_MODULE.response_time = response_time_ms;
+                metrics_observe(&response_time_histogram, response_time_ms);
             }
 
             if (stratum_api_v1_message.method == MINING_NOTIFY) {
+                static bool first_job_marked;
+                if (!first_job_marked) {
+                    boot_timeline_mark(&GLOBAL_STATE->BOOT_TIMELINE, "first job", esp_timer_get_time());
+                    first_job_marked = true;
+                }
                 GLOBAL_STATE->SYSTEM_MODULE.work_received++;
                 SYSTEM_notify_new_ntime(GLOBAL_STATE, stratum_api_v1_message.mining_notification->ntime);
                 if (stratum_api_v1_message.should_abandon_work &&
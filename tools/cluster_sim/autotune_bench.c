@@ -0,0 +1,352 @@
+/**
+ * @file autotune_bench.c
+ * @brief Clusteraxe autotune search strategies on a chip model
+ *
+ * Runs cluster_autotune_coord.c with each search strategy against a
+ * parametric model of BM1370 boards on simulated time, with the firmware's
+ * grid, timings and limits, and prints one row per mode and strategy:
+ * tuning time, points tested per board, how many stopped early, and the
+ * J/TH, hashrate and regret of what the boards end up on.
+ *
+ * The chip model (sim_chip.h) has hashrate, power and error rate against
+ * frequency, voltage and temperature, thermal lag and silicon lottery;
+ * reported hashrate carries 2% noise.
+ *
+ * Regret is how far the true (noise-free, steady-state) score of a board's
+ * final point is from the best point of the mode that is within the error,
+ * temperature and input voltage limits, found by brute force.
+ *
+ * "grid (current)" is the tuning before search strategies: every point,
+ * 45 s each, no error limit. The other rows use sequential testing and the
+ * error limit.
+ *
+ * Options: --boards N, --seed S, --mode efficiency|balanced|hashrate.
+ * With --check the exit status is non-zero unless, in every mode, bisect
+ * and climb take at most BENCH_MAX_TIME of the current grid's time and end
+ * with regret under BENCH_MAX_REGRET. (The current grid's regret can be
+ * negative: without the error limit it may pick a point that errors more.)
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cluster_autotune_coord.h"
+#include "sim_chip.h"
+
+#define BENCH_MAX_BOARDS        16
+#define BENCH_TICK_MS           1000
+#define BENCH_LIMIT_MS          (24 * 3600 * 1000u)
+#define BENCH_MAX_TIME          0.6     // Of the current grid's tuning time
+#define BENCH_MAX_REGRET        0.02    // Of the best score within limits
+
+// Firmware tables and limits (cluster_autotune.c)
+static const uint16_t FREQ_STEPS[] = {450, 500, 525, 550, 600, 625, 650, 700, 725, 750, 800};
+static const uint16_t VOLTAGE_STEPS[] = {1100, 1150, 1200, 1225, 1250, 1275, 1300};
+
+#define NUM_FREQ_STEPS      (sizeof(FREQ_STEPS) / sizeof(FREQ_STEPS[0]))
+#define NUM_VOLTAGE_STEPS   (sizeof(VOLTAGE_STEPS) / sizeof(VOLTAGE_STEPS[0]))
+
+#define TEMP_MAX_C          65.0f
+#define VIN_MIN             4.9f
+#define ERROR_MAX_PCT       1.0f
+
+// ============================================================================
+// Chip Model
+// ============================================================================
+
+typedef struct {
+    sim_chip_t  chips[BENCH_MAX_BOARDS];
+    int         count;
+    uint32_t    now_ms;
+    uint32_t    seed;
+} model_t;
+
+static void model_init(model_t *m, int count, uint32_t seed)
+{
+    memset(m, 0, sizeof(*m));
+    m->count = count;
+    m->seed = seed;
+    for (int i = 0; i < count; i++) {
+        sim_chip_init(&m->chips[i], &m->seed);
+    }
+}
+
+static esp_err_t model_apply(int8_t device, uint16_t freq, uint16_t voltage, void *ctx)
+{
+    model_t *m = ctx;
+    sim_chip_t *c = &m->chips[device + 1];
+    c->freq = freq;
+    c->voltage = voltage;
+    return ESP_OK;
+}
+
+static bool model_sample(int8_t device, autotune_sample_t *s, void *ctx)
+{
+    model_t *m = ctx;
+    const sim_chip_t *c = &m->chips[device + 1];
+    // Slaves report with their heartbeat, the master every tick
+    if (device >= 0 && (m->now_ms / 1000 + device) % 3 != 0) {
+        return false;
+    }
+    float power = sim_chip_power(c, c->freq, c->voltage, c->temp);
+    float err = sim_chip_error(c, c->freq, c->voltage, c->temp);
+    s->hashrate_gh = sim_chip_hashrate(c, c->freq, c->voltage, c->temp) * (1.0f + 0.02f * sim_chip_gauss(&m->seed));
+    s->power_w = power * (1.0f + 0.005f * sim_chip_gauss(&m->seed));
+    s->temp_c = c->temp + 0.3f * sim_chip_gauss(&m->seed);
+    s->vin = sim_chip_vin(power);
+    s->error_pct = err * (1.0f + 0.2f * sim_chip_gauss(&m->seed));
+    if (s->error_pct < 0) {
+        s->error_pct = 0;
+    }
+    return true;
+}
+
+// ============================================================================
+// Truth
+// ============================================================================
+
+typedef struct {
+    float   score;
+    float   jth;
+    float   hashrate_gh;
+    bool    within_limits;
+} truth_t;
+
+static truth_t chip_truth(const sim_chip_t *c, autotune_mode_t mode, uint16_t freq, uint16_t voltage)
+{
+    float temp = sim_chip_settled_temp(c, freq, voltage);
+    float power = sim_chip_power(c, freq, voltage, temp);
+    float hashrate = sim_chip_hashrate(c, freq, voltage, temp);
+    return (truth_t){
+        .score = cluster_autotune_score(mode, hashrate, power),
+        .jth = hashrate > 0 ? power * 1000.0f / hashrate : 0,
+        .hashrate_gh = hashrate,
+        .within_limits = sim_chip_error(c, freq, voltage, temp) <= ERROR_MAX_PCT &&
+                         temp <= TEMP_MAX_C && sim_chip_vin(power) >= VIN_MIN,
+    };
+}
+
+// Best score of the mode within limits, over the grid the coordinator sees
+static float chip_best(const sim_chip_t *c, const autotune_search_grid_t *grid)
+{
+    float best = -1e9f;
+    for (int f = 0; f < grid->freq_count; f++) {
+        for (int v = 0; v < grid->voltage_count; v++) {
+            truth_t t = chip_truth(c, grid->mode, grid->freq_steps[f], grid->voltage_steps[v]);
+            if (t.within_limits && t.score > best) {
+                best = t.score;
+            }
+        }
+    }
+    return best;
+}
+
+// ============================================================================
+// Runs
+// ============================================================================
+
+typedef struct {
+    const char              *label;
+    autotune_search_type_t  search;
+    bool                    adaptive;       // Sequential testing and error limit
+} strategy_t;
+
+static const strategy_t STRATEGIES[] = {
+    {"grid (current)",  AUTOTUNE_SEARCH_GRID,   false},
+    {"grid",            AUTOTUNE_SEARCH_GRID,   true},
+    {"bisect",          AUTOTUNE_SEARCH_BISECT, true},
+    {"climb",           AUTOTUNE_SEARCH_CLIMB,  true},
+};
+
+#define NUM_STRATEGIES  (sizeof(STRATEGIES) / sizeof(STRATEGIES[0]))
+
+typedef struct {
+    double  hours;
+    double  points;         // Per board
+    double  early;          // Per board
+    double  jth;            // Mean true value at the final point
+    double  hashrate_gh;
+    double  regret;         // Mean, fraction of the best score
+    int     failed;         // Boards not done
+} result_t;
+
+static autotune_coord_config_t bench_config(autotune_mode_t mode, const strategy_t *strategy)
+{
+    return (autotune_coord_config_t){
+        .mode = mode,
+        .search = strategy->search,
+        .freq_steps = FREQ_STEPS,
+        .freq_count = NUM_FREQ_STEPS,
+        .freq_max = mode == AUTOTUNE_MODE_HASHRATE ? 800 : mode == AUTOTUNE_MODE_BALANCED ? 700 : 625,
+        .voltage_steps = VOLTAGE_STEPS,
+        .voltage_count = NUM_VOLTAGE_STEPS,
+        .voltage_max = mode == AUTOTUNE_MODE_HASHRATE ? 1300 : mode == AUTOTUNE_MODE_BALANCED ? 1200 : 1175,
+        .base_freq = 450,
+        .base_voltage = 1100,
+        .base_ms = 30000,
+        .stabilize_ms = 20000,
+        .test_ms = 45000,
+        .test_min_ms = strategy->adaptive ? 15000 : 0,
+        .ci_rel = strategy->adaptive ? 0.02f : 0,
+        .error_max_pct = strategy->adaptive ? ERROR_MAX_PCT : 0,
+        .temp_max_c = TEMP_MAX_C,
+        .vin_min = VIN_MIN,
+    };
+}
+
+static result_t run(autotune_mode_t mode, const strategy_t *strategy, int boards, uint32_t seed)
+{
+    static model_t model;
+    static autotune_coord_t coord;
+    model_init(&model, boards, seed);
+
+    autotune_coord_config_t config = bench_config(mode, strategy);
+    autotune_coord_ops_t ops = {
+        .apply = model_apply,
+        .sample = model_sample,
+        .ctx = &model,
+    };
+    cluster_autotune_coord_init(&coord, &config, &ops);
+    for (int i = 0; i < boards; i++) {
+        cluster_autotune_coord_add(&coord, (int8_t)(i - 1));   // Master, then slaves 0..
+    }
+
+    bool finished = false;
+    while (!finished && model.now_ms < BENCH_LIMIT_MS) {
+        model.now_ms += BENCH_TICK_MS;
+        for (int i = 0; i < boards; i++) {
+            sim_chip_step(&model.chips[i], BENCH_TICK_MS / 1000.0f);
+        }
+        finished = cluster_autotune_coord_tick(&coord, model.now_ms);
+    }
+
+    result_t r = {.hours = model.now_ms / 3600000.0};
+    for (int i = 0; i < boards; i++) {
+        const autotune_node_t *node = &coord.nodes[i];
+        const sim_chip_t *c = &model.chips[i];
+        if (node->state != AUTOTUNE_NODE_DONE) {
+            r.failed++;
+        }
+        truth_t t = chip_truth(c, mode, c->freq, c->voltage);
+        float best = chip_best(c, &coord.grid);
+        r.points += node->tests_done;
+        r.early += node->tests_early;
+        r.jth += t.jth;
+        r.hashrate_gh += t.hashrate_gh;
+        r.regret += (best - t.score) / fabsf(best);
+    }
+    r.points /= boards;
+    r.early /= boards;
+    r.jth /= boards;
+    r.hashrate_gh /= boards;
+    r.regret /= boards;
+    return r;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+static const char *mode_name(autotune_mode_t mode)
+{
+    switch (mode) {
+        case AUTOTUNE_MODE_HASHRATE:    return "hashrate";
+        case AUTOTUNE_MODE_BALANCED:    return "balanced";
+        default:                        return "efficiency";
+    }
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [--boards N] [--seed S] [--mode efficiency|balanced|hashrate] [--check]\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    int boards = 9;
+    uint32_t seed = 1;
+    int mode_only = -1;
+    bool check = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--boards") == 0 && i + 1 < argc) {
+            boards = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            const char *m = argv[++i];
+            mode_only = strcmp(m, "hashrate") == 0 ? AUTOTUNE_MODE_HASHRATE :
+                        strcmp(m, "balanced") == 0 ? AUTOTUNE_MODE_BALANCED : AUTOTUNE_MODE_EFFICIENCY;
+        } else if (strcmp(argv[i], "--check") == 0) {
+            check = true;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (boards < 1 || boards > BENCH_MAX_BOARDS) {
+        fprintf(stderr, "--boards must be 1..%d\n", BENCH_MAX_BOARDS);
+        return 2;
+    }
+
+    static const autotune_mode_t MODES[] = {
+        AUTOTUNE_MODE_EFFICIENCY, AUTOTUNE_MODE_BALANCED, AUTOTUNE_MODE_HASHRATE,
+    };
+
+    int failures = 0;
+    printf("autotune_bench: %d boards, seed %u\n\n", boards, (unsigned)seed);
+    printf("%-10s  %-14s  %7s  %6s  %5s  %6s  %7s  %6s\n",
+           "mode", "search", "time", "points", "early", "J/TH", "GH/s", "regret");
+
+    for (size_t m = 0; m < sizeof(MODES) / sizeof(MODES[0]); m++) {
+        if (mode_only >= 0 && (int)MODES[m] != mode_only) {
+            continue;
+        }
+        result_t results[NUM_STRATEGIES];
+        for (size_t s = 0; s < NUM_STRATEGIES; s++) {
+            results[s] = run(MODES[m], &STRATEGIES[s], boards, seed);
+            const result_t *r = &results[s];
+            printf("%-10s  %-14s  %5.2f h  %6.1f  %5.1f  %6.2f  %7.0f  %5.1f%%\n",
+                   s == 0 ? mode_name(MODES[m]) : "", STRATEGIES[s].label, r->hours, r->points,
+                   r->early, r->jth, r->hashrate_gh, r->regret * 100);
+        }
+        printf("\n");
+
+        if (!check) {
+            continue;
+        }
+        const result_t *current = &results[0];
+        for (size_t s = 1; s < NUM_STRATEGIES; s++) {
+            const result_t *r = &results[s];
+            if (r->failed) {
+                printf("FAIL: %s/%s: %d boards did not finish\n", mode_name(MODES[m]),
+                       STRATEGIES[s].label, r->failed);
+                failures++;
+            }
+            if (STRATEGIES[s].search == AUTOTUNE_SEARCH_GRID) {
+                continue;
+            }
+            if (r->hours > current->hours * BENCH_MAX_TIME) {
+                printf("FAIL: %s/%s took %.2f h, current grid %.2f h\n", mode_name(MODES[m]),
+                       STRATEGIES[s].label, r->hours, current->hours);
+                failures++;
+            }
+            if (r->regret > BENCH_MAX_REGRET) {
+                printf("FAIL: %s/%s regret %.1f%%\n", mode_name(MODES[m]), STRATEGIES[s].label,
+                       r->regret * 100);
+                failures++;
+            }
+        }
+    }
+
+    if (check) {
+        printf("autotune_bench: %s\n", failures ? "FAILED" : "ok");
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,373 @@
+/**
+ * @file autotune_online.c
+ * @brief Online efficiency optimizer (perturb and observe) on a chip model
+ *
+ * Drives cluster_autotune_online.c against a sim_chip.h board for three
+ * simulated days with the ambient swinging 14°C between night and day,
+ * next to an identical board left on the static lock point and one moved to
+ * the best point every hour with hindsight, sampled every 5 s like the
+ * firmware:
+ *
+ *   - over six boards the optimizer uses less energy per hash than the
+ *     static lock, at least half of what hindsight saves, and what it logs
+ *     as gained matches the true gain
+ *   - the true error rate stays within the limit on average
+ *   - it never leaves the box around the lock point, and changes settings
+ *     no faster than its change rate allows (plus reverts)
+ *   - in hashrate mode in a warm room, where the lock point itself runs
+ *     over the temperature limit on hot afternoons, it backs off and
+ *     spends much less time over it than the static lock
+ *   - a change made by the watchdog is picked up, not fought
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cluster_autotune_online.h"
+#include "sim_chip.h"
+
+#define TEST_TICK_MS        5000
+#define TEST_DAYS           3
+#define TEST_RUN_MS         (TEST_DAYS * 24 * 3600 * 1000u)
+#define TEST_SWING_C        7.0f            // Ambient +- around its mean
+#define TEST_ERROR_MAX      1.0f
+#define TEST_TEMP_MAX       65.0f
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+// Firmware grid (cluster_autotune.c), to find the static lock point
+static const uint16_t FREQ_STEPS[] = {450, 500, 525, 550, 600, 625, 650, 700, 725, 750, 800};
+static const uint16_t VOLTAGE_STEPS[] = {1100, 1150, 1200, 1225, 1250, 1275, 1300};
+
+// ============================================================================
+// Board
+// ============================================================================
+
+typedef struct {
+    sim_chip_t  chip;
+    float       ambient_mean;
+    uint32_t    seed;
+    uint32_t    applies;
+    bool        out_of_box;
+    uint16_t    box_freq;           // Lock point and its box, to check against
+    uint16_t    box_voltage;
+    uint16_t    box_freq_dev;
+    uint16_t    box_voltage_dev;
+
+    // True totals over the run
+    double      joules;
+    double      terahashes;
+    double      error_time;         // Integral of error rate
+    double      seconds;
+    double      seconds_over_temp;
+} board_t;
+
+static esp_err_t board_apply(uint16_t freq, uint16_t voltage, void *ctx)
+{
+    board_t *b = ctx;
+    b->chip.freq = freq;
+    b->chip.voltage = voltage;
+    b->applies++;
+    if (abs(freq - b->box_freq) > b->box_freq_dev || abs(voltage - b->box_voltage) > b->box_voltage_dev) {
+        b->out_of_box = true;
+    }
+    return ESP_OK;
+}
+
+static void board_step(board_t *b, uint32_t now_ms, float dt_s)
+{
+    b->chip.ambient = b->ambient_mean + TEST_SWING_C * sinf(6.2831853f * now_ms / (24 * 3600 * 1000.0f));
+    sim_chip_step(&b->chip, dt_s);
+
+    const sim_chip_t *c = &b->chip;
+    b->joules += sim_chip_power(c, c->freq, c->voltage, c->temp) * dt_s;
+    b->terahashes += sim_chip_hashrate(c, c->freq, c->voltage, c->temp) * dt_s / 1000.0;
+    b->error_time += sim_chip_error(c, c->freq, c->voltage, c->temp) * dt_s;
+    b->seconds += dt_s;
+    if (c->temp > TEST_TEMP_MAX) {
+        b->seconds_over_temp += dt_s;
+    }
+}
+
+static void board_sample(board_t *b, autotune_sample_t *s)
+{
+    const sim_chip_t *c = &b->chip;
+    float power = sim_chip_power(c, c->freq, c->voltage, c->temp);
+    s->hashrate_gh = sim_chip_hashrate(c, c->freq, c->voltage, c->temp) * (1.0f + 0.02f * sim_chip_gauss(&b->seed));
+    s->power_w = power * (1.0f + 0.005f * sim_chip_gauss(&b->seed));
+    s->temp_c = c->temp + 0.3f * sim_chip_gauss(&b->seed);
+    s->vin = sim_chip_vin(power);
+    s->error_pct = fmaxf(0, sim_chip_error(c, c->freq, c->voltage, c->temp) * (1.0f + 0.2f * sim_chip_gauss(&b->seed)));
+}
+
+static float board_jth(const board_t *b)
+{
+    return b->terahashes > 0 ? b->joules / b->terahashes : 0;
+}
+
+/**
+ * @brief What autotune would lock: best grid point of the mode within limits, at mean ambient
+ */
+static void lock_point(const sim_chip_t *chip, autotune_mode_t mode, uint16_t freq_max,
+                       uint16_t voltage_max, uint16_t *freq, uint16_t *voltage)
+{
+    float best = -1e9f;
+    *freq = FREQ_STEPS[0];
+    *voltage = VOLTAGE_STEPS[0];
+    for (size_t f = 0; f < sizeof(FREQ_STEPS) / sizeof(FREQ_STEPS[0]) && FREQ_STEPS[f] <= freq_max; f++) {
+        for (size_t v = 0; v < sizeof(VOLTAGE_STEPS) / sizeof(VOLTAGE_STEPS[0]) && VOLTAGE_STEPS[v] <= voltage_max; v++) {
+            float temp = sim_chip_settled_temp(chip, FREQ_STEPS[f], VOLTAGE_STEPS[v]);
+            float power = sim_chip_power(chip, FREQ_STEPS[f], VOLTAGE_STEPS[v], temp);
+            float hashrate = sim_chip_hashrate(chip, FREQ_STEPS[f], VOLTAGE_STEPS[v], temp);
+            float score = cluster_autotune_score(mode, hashrate, power);
+            if (sim_chip_error(chip, FREQ_STEPS[f], VOLTAGE_STEPS[v], temp) <= TEST_ERROR_MAX &&
+                temp <= TEST_TEMP_MAX && score > best) {
+                best = score;
+                *freq = FREQ_STEPS[f];
+                *voltage = VOLTAGE_STEPS[v];
+            }
+        }
+    }
+}
+
+// ============================================================================
+// Runs
+// ============================================================================
+
+typedef struct {
+    board_t             fixed;      // Stays on the lock point
+    board_t             online;
+    board_t             oracle;     // Best point in the box every hour, knowing the model
+    autotune_online_t   opt;
+    uint16_t            lock_freq;
+    uint16_t            lock_voltage;
+    float               true_gain_at_reference;
+    float               logged_gain;
+    uint32_t            references;
+} run_t;
+
+static autotune_online_config_t online_config(autotune_mode_t mode, uint16_t freq_max, uint16_t voltage_max)
+{
+    return (autotune_online_config_t){
+        .mode = mode,
+        .freq_step_mhz = 10,
+        .voltage_step_mv = 5,
+        .max_freq_dev_mhz = 50,
+        .max_voltage_dev_mv = 50,
+        .freq_min = 400,
+        .freq_max = freq_max,
+        .voltage_min = 1000,
+        .voltage_max = voltage_max,
+        .settle_ms = 60000,
+        .window_ms = 300000,
+        .min_change_ms = 300000,
+        .hold_ms = 600000,
+        .reference_every = 12,
+        .hysteresis = 0.003f,
+        .temp_max_c = TEST_TEMP_MAX,
+        .vin_min = 4.9f,
+        .error_max_pct = TEST_ERROR_MAX,
+    };
+}
+
+static void run_init(run_t *run, autotune_mode_t mode, uint16_t freq_max, uint16_t voltage_max,
+                     float ambient, uint32_t seed)
+{
+    memset(run, 0, sizeof(*run));
+    uint32_t chip_seed = seed;
+    sim_chip_t chip;
+    sim_chip_init(&chip, &chip_seed);
+    chip.ambient = ambient;
+    lock_point(&chip, mode, freq_max, voltage_max, &run->lock_freq, &run->lock_voltage);
+
+    autotune_online_config_t config = online_config(mode, freq_max, voltage_max);
+    board_t *boards[] = {&run->fixed, &run->online, &run->oracle};
+    for (int i = 0; i < 3; i++) {
+        board_t *b = boards[i];
+        b->chip = chip;
+        b->ambient_mean = ambient;
+        b->seed = seed * 7919u + i;
+        b->box_freq = run->lock_freq;
+        b->box_voltage = run->lock_voltage;
+        b->box_freq_dev = config.max_freq_dev_mhz;
+        b->box_voltage_dev = config.max_voltage_dev_mv;
+        b->chip.freq = run->lock_freq;
+        b->chip.voltage = run->lock_voltage;
+        b->chip.temp = sim_chip_settled_temp(&b->chip, b->chip.freq, b->chip.voltage);
+    }
+
+    autotune_online_ops_t ops = {
+        .apply = board_apply,
+        .ctx = &run->online,
+    };
+    cluster_autotune_online_init(&run->opt, &config, &ops, run->lock_freq, run->lock_voltage, 0);
+}
+
+// Where the oracle board runs: best stable point on the optimizer's steps in the box
+static void oracle_move(run_t *run)
+{
+    board_t *b = &run->oracle;
+    const autotune_online_config_t *cfg = &run->opt.config;
+    float best = -1e9f;
+    for (int df = -cfg->max_freq_dev_mhz; df <= cfg->max_freq_dev_mhz; df += cfg->freq_step_mhz) {
+        for (int dv = -cfg->max_voltage_dev_mv; dv <= cfg->max_voltage_dev_mv; dv += cfg->voltage_step_mv) {
+            int f = run->lock_freq + df, v = run->lock_voltage + dv;
+            if (f < cfg->freq_min || f > cfg->freq_max || v < cfg->voltage_min || v > cfg->voltage_max) {
+                continue;
+            }
+            float temp = sim_chip_settled_temp(&b->chip, f, v);
+            float score = cluster_autotune_score(cfg->mode, sim_chip_hashrate(&b->chip, f, v, temp),
+                                                 sim_chip_power(&b->chip, f, v, temp));
+            if (sim_chip_error(&b->chip, f, v, temp) <= TEST_ERROR_MAX && temp <= TEST_TEMP_MAX &&
+                score > best) {
+                best = score;
+                b->chip.freq = f;
+                b->chip.voltage = v;
+            }
+        }
+    }
+}
+
+// Advance the boards; optionally let a "watchdog" change the online board's settings at one point
+static void run_until(run_t *run, uint32_t from_ms, uint32_t to_ms, uint32_t watchdog_at_ms)
+{
+    for (uint32_t now = from_ms + TEST_TICK_MS; now <= to_ms; now += TEST_TICK_MS) {
+        board_step(&run->fixed, now, TEST_TICK_MS / 1000.0f);
+        board_step(&run->online, now, TEST_TICK_MS / 1000.0f);
+        board_step(&run->oracle, now, TEST_TICK_MS / 1000.0f);
+        if (now % (3600 * 1000u) == 0) {
+            oracle_move(run);
+        }
+
+        if (watchdog_at_ms && now == watchdog_at_ms) {
+            run->online.chip.voltage += 25;     // Outside the optimizer, not through apply()
+        }
+
+        autotune_sample_t s;
+        board_sample(&run->online, &s);
+        bool had_gain = run->opt.have_gain;
+        float gain = run->opt.gain_pct;
+        cluster_autotune_online_tick(&run->opt, &s, run->online.chip.freq, run->online.chip.voltage, now);
+
+        // A reference just finished: compare what it logged with the truth right now
+        if (run->opt.have_gain && (!had_gain || run->opt.gain_pct != gain)) {
+            const sim_chip_t *c = &run->online.chip;
+            float t = sim_chip_settled_temp(c, run->opt.freq_mhz, run->opt.voltage_mv);
+            float cur = sim_chip_power(c, run->opt.freq_mhz, run->opt.voltage_mv, t) * 1000.0f /
+                        sim_chip_hashrate(c, run->opt.freq_mhz, run->opt.voltage_mv, t);
+            float tl = sim_chip_settled_temp(c, run->lock_freq, run->lock_voltage);
+            float ref = sim_chip_power(c, run->lock_freq, run->lock_voltage, tl) * 1000.0f /
+                        sim_chip_hashrate(c, run->lock_freq, run->lock_voltage, tl);
+            run->true_gain_at_reference = (ref - cur) * 100.0f / ref;
+            run->logged_gain = run->opt.gain_pct;
+            run->references++;
+        }
+    }
+}
+
+static void check_efficiency(void)
+{
+    static run_t run;
+    double sum_gain = 0, sum_oracle = 0;
+
+    for (uint32_t seed = 1; seed <= 6; seed++) {
+        run_init(&run, AUTOTUNE_MODE_EFFICIENCY, 625, 1175, 25.0f, seed);
+        run_until(&run, 0, TEST_RUN_MS, 0);
+
+        float fixed_jth = board_jth(&run.fixed);
+        float online_jth = board_jth(&run.online);
+        float gain = (fixed_jth - online_jth) * 100.0f / fixed_jth;
+        float oracle = (fixed_jth - board_jth(&run.oracle)) * 100.0f / fixed_jth;
+        float error = run.online.error_time / run.online.seconds;
+        const autotune_online_t *o = &run.opt;
+        printf("  seed %lu: lock %d MHz, %d mV -> %d MHz, %d mV; %.2f vs %.2f J/TH (%+.1f%%, oracle %+.1f%%), "
+               "%.2f%% errors\n",
+               (unsigned long)seed, run.lock_freq, run.lock_voltage, o->freq_mhz, o->voltage_mv,
+               online_jth, fixed_jth, gain, oracle, error);
+        printf("          %lu probes: %lu kept, %lu reverted, %lu unstable; %lu changes; "
+               "last reference %+.1f%% logged, %+.1f%% true\n",
+               (unsigned long)o->probes, (unsigned long)o->kept, (unsigned long)o->reverted,
+               (unsigned long)o->unstable, (unsigned long)run.online.applies, run.logged_gain,
+               run.true_gain_at_reference);
+        sum_gain += gain;
+        sum_oracle += oracle;
+
+        CHECK(gain > -0.3f, "seed %lu: %.1f%% worse than the static lock", (unsigned long)seed, -gain);
+        CHECK(run.references > 0, "seed %lu: no reference against the lock point", (unsigned long)seed);
+        CHECK(fabsf(run.logged_gain - run.true_gain_at_reference) < 1.5f,
+              "seed %lu: logged gain %.1f%%, true %.1f%%", (unsigned long)seed, run.logged_gain,
+              run.true_gain_at_reference);
+        CHECK(error <= TEST_ERROR_MAX, "seed %lu: mean error rate %.2f%%", (unsigned long)seed, error);
+        CHECK(!run.online.out_of_box, "seed %lu: left the box around the lock point", (unsigned long)seed);
+
+        // One change per min_change_ms, plus a revert for each
+        uint32_t allowed = 2 * (TEST_RUN_MS / o->config.min_change_ms) + 2;
+        CHECK(run.online.applies <= allowed, "seed %lu: %lu changes, at most %lu allowed",
+              (unsigned long)seed, (unsigned long)run.online.applies, (unsigned long)allowed);
+    }
+
+    printf("  efficiency: %+.1f%% J/TH on average, %.0f%% of what hourly hindsight gets (%+.1f%%)\n",
+           sum_gain / 6, sum_oracle > 0 ? 100 * sum_gain / sum_oracle : 0, sum_oracle / 6);
+    CHECK(sum_gain > 0.5 * sum_oracle, "optimizer got %.1f%%, hindsight %.1f%%", sum_gain / 6, sum_oracle / 6);
+}
+
+static void check_hot(void)
+{
+    static run_t run;
+    // Hashrate mode on a warm room: probes up in frequency run into the limit
+    run_init(&run, AUTOTUNE_MODE_HASHRATE, 800, 1300, 31.0f, 5);
+    run_until(&run, 0, TEST_RUN_MS, 0);
+
+    const autotune_online_t *o = &run.opt;
+    printf("  hot room  : lock %d MHz, %d mV -> %d MHz, %d mV; %lu breaches, %.0f s over %.0f°C "
+           "(static %.0f s)\n",
+           run.lock_freq, run.lock_voltage, o->freq_mhz, o->voltage_mv, (unsigned long)o->breaches,
+           run.online.seconds_over_temp, TEST_TEMP_MAX, run.fixed.seconds_over_temp);
+
+    CHECK(o->breaches > 0, "no probe reached the temperature limit");
+    CHECK(!run.online.out_of_box, "left the box around the lock point");
+    // Probes over the limit are reverted, and the lock point steps down on hot afternoons
+    CHECK(run.online.seconds_over_temp < 0.75 * run.fixed.seconds_over_temp,
+          "%.0f s over the limit, static %.0f s", run.online.seconds_over_temp,
+          run.fixed.seconds_over_temp);
+}
+
+static void check_watchdog(void)
+{
+    static run_t run;
+    run_init(&run, AUTOTUNE_MODE_EFFICIENCY, 625, 1175, 25.0f, 9);
+    uint32_t at = 6 * 3600 * 1000u;
+    run_until(&run, 0, 12 * 3600 * 1000u, at);
+
+    const autotune_online_t *o = &run.opt;
+    CHECK(o->rebases == 1, "%lu rebases after one outside change", (unsigned long)o->rebases);
+    CHECK(o->probes > 0 && o->state != AUTOTUNE_ONLINE_HOLD, "optimizer stuck in %s",
+          cluster_autotune_online_state_name(o->state));
+}
+
+int main(void)
+{
+    printf("autotune_online: %d days, ambient +-%.0f°C daily\n", TEST_DAYS, TEST_SWING_C);
+
+    check_efficiency();
+    check_hot();
+    check_watchdog();
+
+    printf("autotune_online: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,351 @@
+/**
+ * @file autotune_parallel.c
+ * @brief Parallel cluster autotune under a shared power budget
+ *
+ * Drives cluster_autotune_coord.c against a model of nine boards on
+ * simulated time, with the firmware's grid, timings and limits:
+ *
+ *   hashrate  f, less the share of cores erroring below the chip's
+ *             minimum stable voltage for f
+ *   power     static + k * f * V^2, k varying a few % between boards
+ *   temp      ambient + thermal resistance * power
+ *   vin       PSU sagging with the board's draw
+ *
+ * Checks:
+ *   - with no cap, tuning all nine boards takes as long as one board,
+ *     against nine times that when tuned one after another
+ *   - with a cap, the boards' true combined draw never exceeds it (beyond
+ *     the overshoot tolerance), high-power points are staggered, and the
+ *     final settings fit it together
+ *   - points over the temperature or input voltage limit are abandoned
+ *     and never picked
+ *   - a board that cannot be reached fails alone
+ *   - stopping early leaves every board on a measured point or base
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cluster_autotune_coord.h"
+
+#define TEST_BOARDS         9
+#define TEST_TICK_MS        1000
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+// Firmware tables (cluster_autotune.c)
+static const uint16_t FREQ_STEPS[] = {450, 500, 525, 550, 600, 625, 650, 700, 725, 750, 800};
+static const uint16_t VOLTAGE_STEPS[] = {1100, 1150, 1200, 1225, 1250, 1275, 1300};
+
+// ============================================================================
+// Board model
+// ============================================================================
+
+typedef struct {
+    uint16_t    freq;
+    uint16_t    voltage;
+    float       k;              // W per MHz*V^2
+    float       vmin_offset;    // mV, silicon lottery
+    float       ambient;
+    bool        unreachable;
+    uint32_t    applies;
+} board_t;
+
+typedef struct {
+    board_t     boards[TEST_BOARDS];
+    uint32_t    now_ms;
+    uint32_t    seed;
+} model_t;
+
+static float noise(model_t *m)
+{
+    m->seed = m->seed * 1103515245u + 12345u;
+    return ((m->seed >> 8) & 0xFFFF) / 65535.0f - 0.5f;
+}
+
+static float board_power(const board_t *b)
+{
+    float v = b->voltage / 1000.0f;
+    return 2.5f + b->k * b->freq * v * v;
+}
+
+static float board_hashrate(const board_t *b)
+{
+    float vmin = 1050.0f + (b->freq - 400) * 0.6f + b->vmin_offset;
+    float good = b->voltage >= vmin ? 1.0f : 1.0f - (vmin - b->voltage) / 100.0f;
+    return b->freq * 2.0f * (good > 0 ? good : 0);
+}
+
+static float board_temp(const board_t *b)
+{
+    return b->ambient + 1.65f * board_power(b);
+}
+
+static float board_vin(const board_t *b)
+{
+    return 5.25f - 0.012f * board_power(b);
+}
+
+static esp_err_t model_apply(int8_t device, uint16_t freq, uint16_t voltage, void *ctx)
+{
+    model_t *m = ctx;
+    board_t *b = &m->boards[device + 1];
+    if (b->unreachable) {
+        return ESP_FAIL;
+    }
+    b->freq = freq;
+    b->voltage = voltage;
+    b->applies++;
+    return ESP_OK;
+}
+
+static bool model_sample(int8_t device, autotune_sample_t *s, void *ctx)
+{
+    model_t *m = ctx;
+    board_t *b = &m->boards[device + 1];
+    if (b->unreachable) {
+        return false;
+    }
+    // Slaves report with their heartbeat, the master every tick
+    if (device >= 0 && (m->now_ms / 1000 + device) % 3 != 0) {
+        return false;
+    }
+    s->hashrate_gh = board_hashrate(b) * (1.0f + 0.01f * noise(m));
+    s->power_w = board_power(b) * (1.0f + 0.005f * noise(m));
+    s->temp_c = board_temp(b) + 0.3f * noise(m);
+    s->vin = board_vin(b);
+    return true;
+}
+
+static float model_total_power(const model_t *m)
+{
+    float sum = 0;
+    for (int i = 0; i < TEST_BOARDS; i++) {
+        sum += board_power(&m->boards[i]);
+    }
+    return sum;
+}
+
+static void model_init(model_t *m, uint32_t seed)
+{
+    memset(m, 0, sizeof(*m));
+    m->seed = seed;
+    for (int i = 0; i < TEST_BOARDS; i++) {
+        m->boards[i] = (board_t){
+            .freq = 525,
+            .voltage = 1150,
+            .k = 0.0175f * (1.0f + 0.06f * noise(m)),
+            .vmin_offset = 40.0f * noise(m),
+            .ambient = 24.0f + 2.0f * noise(m),
+        };
+    }
+}
+
+// ============================================================================
+// Runs
+// ============================================================================
+
+typedef struct {
+    autotune_coord_t    coord;
+    model_t             model;
+    uint32_t            elapsed_ms;
+    float               peak_w;         // True combined draw
+    bool                finished;
+} run_t;
+
+static void run_init(run_t *run, autotune_mode_t mode, float budget, int boards, uint32_t seed)
+{
+    memset(run, 0, sizeof(*run));
+    model_init(&run->model, seed);
+
+    autotune_coord_config_t config = {
+        .mode = mode,
+        .freq_steps = FREQ_STEPS,
+        .freq_count = sizeof(FREQ_STEPS) / sizeof(FREQ_STEPS[0]),
+        .freq_max = mode == AUTOTUNE_MODE_HASHRATE ? 800 : mode == AUTOTUNE_MODE_BALANCED ? 700 : 625,
+        .voltage_steps = VOLTAGE_STEPS,
+        .voltage_count = sizeof(VOLTAGE_STEPS) / sizeof(VOLTAGE_STEPS[0]),
+        .voltage_max = mode == AUTOTUNE_MODE_HASHRATE ? 1300 : mode == AUTOTUNE_MODE_BALANCED ? 1200 : 1175,
+        .base_freq = 450,
+        .base_voltage = 1100,
+        .base_ms = 30000,
+        .stabilize_ms = 20000,
+        .test_ms = 45000,
+        .temp_max_c = 65,
+        .vin_min = 4.9f,
+        .power_budget_w = budget,
+    };
+    autotune_coord_ops_t ops = {
+        .apply = model_apply,
+        .sample = model_sample,
+        .ctx = &run->model,
+    };
+    cluster_autotune_coord_init(&run->coord, &config, &ops);
+
+    for (int i = 0; i < boards; i++) {
+        cluster_autotune_coord_add(&run->coord, (int8_t)(i - 1));   // Master, then slaves 0..
+    }
+}
+
+static void run_until(run_t *run, uint32_t limit_ms)
+{
+    while (!run->finished && run->elapsed_ms < limit_ms) {
+        run->model.now_ms += TEST_TICK_MS;
+        run->elapsed_ms += TEST_TICK_MS;
+        run->finished = cluster_autotune_coord_tick(&run->coord, run->model.now_ms);
+
+        float total = model_total_power(&run->model);
+        if (total > run->peak_w) {
+            run->peak_w = total;
+        }
+    }
+}
+
+static uint32_t wait_s(const run_t *run)
+{
+    uint32_t ms = 0;
+    for (int i = 0; i < run->coord.count; i++) {
+        ms += run->coord.nodes[i].budget_wait_ms;
+    }
+    return ms / 1000;
+}
+
+static void check_picks(const run_t *run, const char *label)
+{
+    for (int i = 0; i < run->coord.count; i++) {
+        const autotune_node_t *node = &run->coord.nodes[i];
+        const board_t *b = &run->model.boards[i];
+        CHECK(node->state == AUTOTUNE_NODE_DONE, "%s: board %d ended %s", label, i,
+              cluster_autotune_node_state_name(node->state));
+        CHECK(b->freq == node->best_freq && b->voltage == node->best_voltage,
+              "%s: board %d runs %d/%d, best is %d/%d", label, i, b->freq, b->voltage,
+              node->best_freq, node->best_voltage);
+        CHECK(board_temp(b) <= 65.5f, "%s: board %d picked a %.1f°C point", label, i, board_temp(b));
+    }
+}
+
+static void check_unlimited(void)
+{
+    static run_t one, all;
+    run_init(&one, AUTOTUNE_MODE_HASHRATE, 0, 1, 7);
+    run_until(&one, 24 * 3600 * 1000u);
+    run_init(&all, AUTOTUNE_MODE_HASHRATE, 0, TEST_BOARDS, 7);
+    run_until(&all, 24 * 3600 * 1000u);
+
+    double sequential_h = TEST_BOARDS * one.elapsed_ms / 3600000.0;
+    double parallel_h = all.elapsed_ms / 3600000.0;
+    printf("  no cap   : 1 board %.2f h, %d boards %.2f h in parallel (%.2f h one at a time), "
+           "peak %.0f W\n", one.elapsed_ms / 3600000.0, TEST_BOARDS, parallel_h, sequential_h, all.peak_w);
+
+    CHECK(all.finished, "unlimited run did not finish");
+    CHECK(sequential_h / parallel_h > TEST_BOARDS * 0.9, "speedup only %.1fx", sequential_h / parallel_h);
+    check_picks(&all, "no cap");
+
+    // Hashrate mode runs into the temperature limit at the top of the grid
+    uint16_t skipped = 0;
+    for (int i = 0; i < all.coord.count; i++) {
+        skipped += all.coord.nodes[i].tests_skipped;
+    }
+    CHECK(skipped > 0, "no point tripped the temperature limit");
+}
+
+static void check_budget(void)
+{
+    static run_t free_run, capped;
+    run_init(&free_run, AUTOTUNE_MODE_HASHRATE, 0, TEST_BOARDS, 11);
+    run_until(&free_run, 24 * 3600 * 1000u);
+
+    // Room for everyone at base plus a little: the top points must take turns
+    float budget = 0.8f * free_run.peak_w;
+    run_init(&capped, AUTOTUNE_MODE_HASHRATE, budget, TEST_BOARDS, 11);
+    run_until(&capped, 24 * 3600 * 1000u);
+
+    float final_w = model_total_power(&capped.model);
+    printf("  %4.0f W cap: %.2f h (vs %.2f h uncapped), peak %.0f W, final %.0f W, "
+           "%lu s held back, %lu step-backs\n",
+           budget, capped.elapsed_ms / 3600000.0, free_run.elapsed_ms / 3600000.0, capped.peak_w,
+           final_w, (unsigned long)wait_s(&capped), (unsigned long)capped.coord.step_backs);
+
+    CHECK(capped.finished, "capped run did not finish");
+    CHECK(capped.peak_w <= budget * AUTOTUNE_COORD_OVERSHOOT, "true draw peaked at %.1f W over %.1f W",
+          capped.peak_w, budget);
+    CHECK(final_w <= budget, "final settings draw %.1f W over %.1f W", final_w, budget);
+    CHECK(wait_s(&capped) > 0, "nothing was staggered");
+    check_picks(&capped, "capped");
+
+    float capped_hashrate = 0, free_hashrate = 0;
+    for (int i = 0; i < TEST_BOARDS; i++) {
+        capped_hashrate += board_hashrate(&capped.model.boards[i]);
+        free_hashrate += board_hashrate(&free_run.model.boards[i]);
+    }
+    printf("             final hashrate %.0f GH/s (uncapped %.0f GH/s)\n", capped_hashrate, free_hashrate);
+    CHECK(capped_hashrate > 0.7f * free_hashrate, "capped cluster kept only %.0f GH/s", capped_hashrate);
+}
+
+static void check_unreachable(void)
+{
+    static run_t run;
+    run_init(&run, AUTOTUNE_MODE_EFFICIENCY, 0, 4, 3);
+    run.model.boards[2].unreachable = true;
+    run_until(&run, 24 * 3600 * 1000u);
+
+    CHECK(run.finished, "run with an unreachable board did not finish");
+    CHECK(run.coord.nodes[2].state == AUTOTUNE_NODE_FAILED, "unreachable board ended %s",
+          cluster_autotune_node_state_name(run.coord.nodes[2].state));
+    for (int i = 0; i < 4; i++) {
+        if (i != 2) {
+            CHECK(run.coord.nodes[i].state == AUTOTUNE_NODE_DONE, "board %d ended %s", i,
+                  cluster_autotune_node_state_name(run.coord.nodes[i].state));
+        }
+    }
+}
+
+static void check_stop(void)
+{
+    static run_t run;
+    run_init(&run, AUTOTUNE_MODE_BALANCED, 0, TEST_BOARDS, 5);
+    run_until(&run, 15 * 60 * 1000u);
+    CHECK(!run.finished, "run finished before the stop");
+
+    cluster_autotune_coord_finish_all(&run.coord);
+    for (int i = 0; i < TEST_BOARDS; i++) {
+        const autotune_node_t *node = &run.coord.nodes[i];
+        const board_t *b = &run.model.boards[i];
+        bool measured = b->freq == 450 && b->voltage == 1100;
+        for (int r = 0; r < node->result_count; r++) {
+            measured |= node->results[r].freq_mhz == b->freq && node->results[r].voltage_mv == b->voltage;
+        }
+        CHECK(node->state == AUTOTUNE_NODE_DONE && measured, "stopped board %d on %d/%d (%s)",
+              i, b->freq, b->voltage, cluster_autotune_node_state_name(node->state));
+    }
+}
+
+int main(void)
+{
+    printf("autotune_parallel: %d boards, %d x %d grid\n", TEST_BOARDS,
+           (int)(sizeof(FREQ_STEPS) / sizeof(FREQ_STEPS[0])),
+           (int)(sizeof(VOLTAGE_STEPS) / sizeof(VOLTAGE_STEPS[0])));
+
+    check_unlimited();
+    check_budget();
+    check_unreachable();
+    check_stop();
+
+    printf("autotune_parallel: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,312 @@
+/**
+ * @file clock_sync.c
+ * @brief Clock offset/drift estimation checks
+ *
+ * Drives cluster_clock.c with the four-stamp exchange a slave and its
+ * master run over heartbeats, and the stamped $CLHBT / $CLTLM / $CLTAK
+ * sentences from cluster_protocol.c.
+ *
+ * Checks:
+ *   - stamps survive every sentence that carries them, and sentences
+ *     without stamps still decode as before
+ *   - with the slave clock offset by seconds and running tens of ppm off,
+ *     the estimate maps slave timestamps to master time to within a
+ *     fraction of the link's delay jitter, over asymmetric, heavy-tailed
+ *     delays and loss
+ *   - drift is recovered once the window spans long enough
+ *   - a slave that reboots without re-registering is picked up again
+ *   - stamps out of order are refused
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cluster.h"
+#include "cluster_clock.h"
+#include "cluster_protocol.h"
+
+#define TEST_NODE           5
+#define TEST_INTERVAL_US    3000000LL   // Heartbeat interval
+#define TEST_EXCHANGES      200         // Ten minutes
+#define TEST_WARMUP         40          // Window full plus the drift baseline
+#define TEST_LOSS_PERCENT   5
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+int64_t esp_timer_get_time(void)
+{
+    return 0;
+}
+
+static uint32_t g_rng = 0x0BADF00D;
+
+static uint32_t sim_rand(void)
+{
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return g_rng >> 8;
+}
+
+static double sim_uniform(void)
+{
+    return (sim_rand() & 0xFFFFFF) / (double)0x1000000;
+}
+
+// ============================================================================
+// Sentences
+// ============================================================================
+
+static const char *parse(const char *msg, const char *expect_type)
+{
+    char type[6];
+    const char *payload = NULL;
+    CHECK(cluster_protocol_verify_checksum(msg), "bad checksum: %s", msg);
+    CHECK(cluster_protocol_parse_message(msg, type, &payload) == ESP_OK &&
+          strcmp(type, expect_type) == 0, "sentence type wrong: %s", msg);
+    return payload;
+}
+
+static void check_sentences(void)
+{
+    const cluster_clock_stamp_t stamp = {
+        .t1 = 31536000123456LL,     // A year of uptime
+        .echo_t1 = 31535997123001LL,
+        .echo_t4 = 31535997125999LL,
+    };
+    char msg[CLUSTER_MSG_MAX_LEN];
+
+    // Heartbeat: stamps force the nodes field out, and come back
+    cluster_heartbeat_data_t hb = {
+        .slave_id = TEST_NODE, .hashrate = 120000, .temp = 55.5f, .fan_rpm = 3000,
+        .shares = 42, .frequency = 525, .core_voltage = 1150, .power = 18.5f,
+        .voltage_in = 5.1f, .clock = stamp,
+    };
+    cluster_heartbeat_data_t rx;
+    CHECK(cluster_protocol_encode_heartbeat_ex(&hb, msg, 192) > 0, "stamped heartbeat too long");
+    CHECK(cluster_protocol_decode_heartbeat_ex(parse(msg, BAP_MSG_HEARTBEAT), &rx) == ESP_OK &&
+          rx.nodes == 0 && rx.shares == 42 &&
+          memcmp(&rx.clock, &stamp, sizeof(stamp)) == 0, "heartbeat stamps differ: %s", msg);
+
+    hb.nodes = 7;
+    cluster_protocol_encode_heartbeat_ex(&hb, msg, sizeof(msg));
+    CHECK(cluster_protocol_decode_heartbeat_ex(parse(msg, BAP_MSG_HEARTBEAT), &rx) == ESP_OK &&
+          rx.nodes == 7 && rx.clock.echo_t4 == stamp.echo_t4, "relay heartbeat stamps differ: %s", msg);
+
+    // Unstamped heartbeats look as they always did
+    memset(&hb.clock, 0, sizeof(hb.clock));
+    hb.nodes = 0;
+    cluster_protocol_encode_heartbeat_ex(&hb, msg, sizeof(msg));
+    int commas = 0;
+    for (const char *c = msg; *c; c++) {
+        commas += (*c == ',');
+    }
+    CHECK(commas == 9, "unstamped heartbeat has extra fields: %s", msg);
+    CHECK(cluster_protocol_decode_heartbeat_ex(parse(msg, BAP_MSG_HEARTBEAT), &rx) == ESP_OK &&
+          rx.clock.t1 == 0, "unstamped heartbeat decoded a stamp: %s", msg);
+
+    // Heartbeat reply, with and without the echo
+    uint16_t node = 0;
+    int64_t echo = 0;
+    cluster_protocol_encode_heartbeat_reply(TEST_NODE, stamp.t1, msg, sizeof(msg));
+    CHECK(cluster_protocol_decode_heartbeat_reply(parse(msg, BAP_MSG_HEARTBEAT), &node, &echo) == ESP_OK &&
+          node == TEST_NODE && echo == stamp.t1, "reply echo differs: %s", msg);
+    cluster_protocol_encode_heartbeat_reply(TEST_NODE, 0, msg, sizeof(msg));
+    CHECK(cluster_protocol_decode_heartbeat_reply(parse(msg, BAP_MSG_HEARTBEAT), &node, &echo) == ESP_OK &&
+          echo == 0, "unstamped reply has an echo: %s", msg);
+    CHECK(cluster_protocol_decode_heartbeat_reply("5,0,0.0,0,0", &node, &echo) == ESP_OK && echo == 0,
+          "legacy reply not accepted");
+
+    // Telemetry frame and its ack
+    const uint8_t frame[] = { 0x11, 0x07, 0x00, 0x81, 0x02, 0x2A, 0x33 };
+    uint8_t got[16];
+    size_t got_len = 0;
+    cluster_clock_stamp_t got_stamp;
+    cluster_protocol_encode_telemetry(TEST_NODE, frame, sizeof(frame), &stamp, msg, sizeof(msg));
+    CHECK(cluster_protocol_decode_telemetry(parse(msg, BAP_MSG_TELEMETRY), &node, got, sizeof(got),
+                                            &got_len, &got_stamp) == ESP_OK &&
+          got_len == sizeof(frame) && memcmp(got, frame, sizeof(frame)) == 0 &&
+          memcmp(&got_stamp, &stamp, sizeof(stamp)) == 0, "telemetry stamps differ: %s", msg);
+    cluster_protocol_encode_telemetry(TEST_NODE, frame, sizeof(frame), NULL, msg, sizeof(msg));
+    CHECK(cluster_protocol_decode_telemetry(parse(msg, BAP_MSG_TELEMETRY), &node, got, sizeof(got),
+                                            &got_len, &got_stamp) == ESP_OK &&
+          got_len == sizeof(frame) && got_stamp.t1 == 0, "unstamped telemetry decoded a stamp: %s", msg);
+
+    uint8_t seq = 0;
+    bool ok = false;
+    cluster_protocol_encode_telemetry_ack(TEST_NODE, 9, true, stamp.t1, msg, sizeof(msg));
+    CHECK(cluster_protocol_decode_telemetry_ack(parse(msg, BAP_MSG_TELEMETRY_ACK), &node, &seq, &ok,
+                                                &echo) == ESP_OK &&
+          seq == 9 && ok && echo == stamp.t1, "telemetry ack echo differs: %s", msg);
+    CHECK(cluster_protocol_decode_telemetry_ack("5,9,0", &node, &seq, &ok, &echo) == ESP_OK &&
+          !ok && echo == 0, "legacy telemetry ack not accepted");
+}
+
+// ============================================================================
+// Estimation
+// ============================================================================
+
+typedef struct {
+    double      offset_us;      // Slave clock at master time 0
+    double      drift_ppm;      // Slave clock rate error
+    double      base_ms;        // One-way latency floor
+    double      jitter_ms;      // Mean of the exponential extra delay
+    double      retry_percent;  // One-way trips that take a MAC retry
+} link_t;
+
+static int64_t slave_clock(const link_t *link, int64_t master_us)
+{
+    return (int64_t)llround(link->offset_us + master_us * (1.0 + link->drift_ppm * 1e-6));
+}
+
+static int64_t one_way_us(const link_t *link)
+{
+    double ms = link->base_ms - link->jitter_ms * log(1.0 - sim_uniform());
+    if (sim_rand() % 100 < link->retry_percent) {
+        ms += 5 + 20 * sim_uniform();
+    }
+    return (int64_t)(ms * 1000);
+}
+
+/**
+ * @brief Run the exchange the way cluster_slave.c and cluster_master.c do
+ *
+ * @param reboot_at Exchange at which the slave restarts its clock (-1 = never)
+ * @return Worst |error| after warm-up (us)
+ */
+static double run_link(const link_t *link_in, int reboot_at, double *drift_err_ppm,
+                       double *mean_err_us)
+{
+    link_t link = *link_in;
+    cluster_clock_t clk;
+    cluster_clock_reset(&clk);
+
+    int64_t pending_t1 = 0, pending_t2 = 0, pending_t3 = 0;
+    int64_t echo_t1 = 0, echo_t4 = 0;
+    double worst = 0, sum = 0;
+    int checked = 0;
+
+    for (int i = 0; i < TEST_EXCHANGES; i++) {
+        int64_t send_master = 10000000LL + i * TEST_INTERVAL_US;
+
+        if (i == reboot_at) {
+            // Clock restarts near zero, same crystal
+            link.offset_us = -(double)send_master;
+            echo_t1 = echo_t4 = 0;
+        }
+
+        // Slave stamps and sends; the master completes the last exchange
+        int64_t t1 = slave_clock(&link, send_master);
+        int64_t arrive = send_master + one_way_us(&link);
+        bool up_lost = sim_rand() % 100 < TEST_LOSS_PERCENT;
+        if (!up_lost) {
+            if (echo_t1 != 0 && echo_t1 == pending_t1 && pending_t3 != 0) {
+                cluster_clock_add_sample(&clk, pending_t1, pending_t2, pending_t3, echo_t4);
+            }
+            pending_t1 = t1;
+            pending_t2 = arrive;
+            pending_t3 = arrive + 200 + sim_rand() % 300;       // RX task turnaround
+
+            // Reply echoes t1; the slave keeps it if it arrives
+            int64_t back = pending_t3 + one_way_us(&link);
+            if (sim_rand() % 100 >= TEST_LOSS_PERCENT) {
+                echo_t1 = t1;
+                echo_t4 = slave_clock(&link, back);
+            }
+        }
+
+        if (i < TEST_WARMUP || (reboot_at >= 0 && i >= reboot_at && i < reboot_at + 3)) {
+            continue;
+        }
+
+        // A slave event somewhere in the next interval, mapped to master time
+        int64_t when = send_master + (int64_t)(sim_uniform() * TEST_INTERVAL_US);
+        double err = (double)(cluster_clock_to_master(&clk, slave_clock(&link, when)) - when);
+        CHECK(clk.synced, "not synced after %d exchanges", i);
+        if (fabs(err) > worst) {
+            worst = fabs(err);
+        }
+        sum += fabs(err);
+        checked++;
+    }
+
+    *drift_err_ppm = clk.drift_ppb / 1000.0 - link.drift_ppm;
+    *mean_err_us = checked ? sum / checked : 0;
+    return worst;
+}
+
+static void check_estimate(void)
+{
+    static const link_t links[] = {
+        { 1.5e6,   20.0, 1.0,  0.5,  2 },
+        { 73.2e6, -45.0, 1.0,  2.0,  5 },
+        { 0.4e6,   12.0, 2.0, 10.0, 10 },
+        { 9.9e6,    0.0, 1.0,  2.0,  5 },
+    };
+
+    for (size_t i = 0; i < sizeof(links) / sizeof(links[0]); i++) {
+        const link_t *l = &links[i];
+        double drift_err, mean_err;
+        double worst = run_link(l, -1, &drift_err, &mean_err);
+
+        printf("  offset %6.1f s drift %+5.1f ppm, delay %.1f ms + exp(%.1f) ms, %2.0f%% retries: "
+               "error mean %4.0f us max %4.0f us, drift error %+5.2f ppm\n",
+               l->offset_us / 1e6, l->drift_ppm, l->base_ms, l->jitter_ms, l->retry_percent,
+               mean_err, worst, drift_err);
+
+        // Bounded by the delay asymmetry of the quickest exchanges
+        double limit_us = 300 + 500 * l->jitter_ms;
+        double mean_limit_us = 100 + 150 * l->jitter_ms;
+        CHECK(worst < limit_us, "link %zu: max error %.0f us over %.0f us", i, worst, limit_us);
+        CHECK(mean_err < mean_limit_us, "link %zu: mean error %.0f us over %.0f us",
+              i, mean_err, mean_limit_us);
+        CHECK(fabs(drift_err) < 1.0 + l->jitter_ms, "link %zu: drift off by %.2f ppm", i, drift_err);
+    }
+
+    // Reboot without re-registration: the offset jumps by minutes
+    double drift_err, mean_err;
+    double worst = run_link(&links[1], TEST_EXCHANGES / 2, &drift_err, &mean_err);
+    printf("  slave reboot mid-run: error mean %4.0f us max %4.0f us\n", mean_err, worst);
+    CHECK(worst < 1500, "after reboot: max error %.0f us", worst);
+
+    // Stamps out of order
+    cluster_clock_t clk;
+    cluster_clock_reset(&clk);
+    CHECK(cluster_clock_add_sample(&clk, 1000, 5000, 4000, 3000) == ESP_ERR_INVALID_ARG,
+          "reply before request accepted");
+    CHECK(cluster_clock_add_sample(&clk, 1000, 5000, 5100, 900) == ESP_ERR_INVALID_ARG,
+          "t4 before t1 accepted");
+    CHECK(cluster_clock_add_sample(&clk, 1000, 5000, 9000, 2000) == ESP_ERR_INVALID_ARG,
+          "negative delay accepted");
+    CHECK(!clk.synced && cluster_clock_to_master(&clk, 1234) == 1234,
+          "unsynced clock converts timestamps");
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(void)
+{
+    printf("clock_sync: %d samples, heartbeat every %lld s, %d%% loss each way\n",
+           CLUSTER_CLOCK_SAMPLES, TEST_INTERVAL_US / 1000000, TEST_LOSS_PERCENT);
+
+    check_sentences();
+    check_estimate();
+
+    printf("clock_sync: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
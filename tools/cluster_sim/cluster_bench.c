@@ -0,0 +1,968 @@
+/**
+ * @file cluster_bench.c
+ * @brief Clusteraxe cluster benchmark on the host simulator
+ *
+ * Runs the real master and slave code (cluster.c, cluster_master.c,
+ * cluster_slave.c, cluster_index.c, cluster_protocol.c) against the
+ * simulated radio, pool and ASICs in sim.h, once per cluster size, and
+ * prints one report row per size:
+ *
+ *   - notify -> slave ASIC latency distribution (p50/p90/p99/max) and the
+ *     share of (job, slave) pairs that reached an ASIC at all
+ *   - share delivery rate (pool submits / shares found by ASICs) and the
+ *     pool's accepted / stale / duplicate / rejected counts
+ *   - master CPU time per job (all master tasks, including the stand-in
+ *     stratum tasks and the ESP-NOW RX task) and channel airtime use
+ *
+ * The master library is loaded once; the slave library is copied per slave
+ * and each copy dlopen()ed so every slave has its own statics. Each size
+ * runs in a forked child so one run cannot leak threads into the next.
+ *
+ * With --check the exit status is non-zero if any size failed to run, got
+ * no work to an ASIC or no share accepted, or if the pool saw duplicate or
+ * rejected shares, which the master's job index and dedup should prevent.
+ * It also fails if the master's share verification refused any share, or
+ * verified none: the simulated ASICs mine real (scaled) headers, so every
+ * share must re-hash.
+ * --min-deliv adds a floor on the delivery rate, for outage runs where
+ * slaves must hold and replay their shares.
+ * --skew gives every slave's esp_timer an offset of seconds and a rate
+ * error of up to the given ppm; each size then also reports how well the
+ * master's clock estimates map slave timestamps to master time, and --check
+ * fails if an active slave is not synced or is off by more than
+ * BENCH_CLOCK_MAX_ERR_US.
+ * --trace prints the latency of each stage pair from the master's trace
+ * ring (cluster_trace.h), slave records included, and --check fails if any
+ * hop from notify to the pool's answer left no pair in it.
+ * --config then sets a different frequency and core voltage on every
+ * active slave in one cluster_master_set_slaves_settings() call, ramped,
+ * reads them back one slave at a time, and reports how long both took;
+ * --check fails if a slave does not end up at and report its settings.
+ * Slaves dropping out at larger sizes is reported, not failed: that is what
+ * the benchmark is for.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "cluster_index.h"
+#include "cluster_remote_config.h"
+#include "cluster_trace.h"
+#include "sim.h"
+
+#ifndef SIM_MASTER_LIB
+    #define SIM_MASTER_LIB      "libcluster_sim_master.so"
+#endif
+#ifndef SIM_SLAVE_LIB
+    #define SIM_SLAVE_LIB       "libcluster_sim_slave.so"
+#endif
+
+#define BENCH_MAX_SIZES         16
+#define BENCH_DRAIN_S           5.0
+#define BENCH_CLOCK_MAX_ERR_US  3000
+
+typedef struct {
+    const char         *master_lib;
+    const char         *slave_lib;
+    char                slave_dir[64];
+    int                 sizes[BENCH_MAX_SIZES];
+    int                 size_count;
+    double              warmup_s;
+    double              duration_s;
+    double              speed;
+    double              outage_s;
+    double              min_deliv;          // --check floor on deliv%, 0 = none
+    double              skew_ppm;           // Slave clock rate error bound, 0 = no skew
+    bool                trace;
+    bool                config;
+    bool                check;
+    sim_net_config_t    net;
+    sim_pool_config_t   pool;
+    sim_asic_config_t   asic;
+} bench_config_t;
+
+typedef struct {
+    int                 slaves;
+    int                 active_slaves;
+    uint32_t            jobs;
+    uint32_t            deliveries;
+    uint32_t            regressions;
+    double              lat_p50, lat_p90, lat_p99, lat_max;
+    uint32_t            shares_found;
+    sim_pool_stats_t    pool;
+    uint32_t            master_dedup;
+    uint32_t            master_stale;
+    uint32_t            master_invalid;     // Failed share verification
+    uint32_t            master_unverified;
+    double              master_cpu_ms_per_job;
+    double              air_percent;
+    uint32_t            rx_overflows;
+    uint32_t            master_tx;
+    int                 clock_synced;       // Slaves with a clock estimate (--skew)
+    double              clock_err_mean_us;
+    double              clock_err_max_us;
+    int                 trace_records;      // In the master's ring (--trace)
+    struct {
+        char            name[20];           // Copied: the result crosses the fork pipe
+        uint16_t        count;
+        int32_t         p50_us, p90_us, max_us;
+    } spans[CLUSTER_TRACE_SPAN_COUNT];
+    int                 config_sent;        // Slaves given settings (--config)
+    int                 config_applied;     // ... running and reporting them after
+    int                 config_ramp_steps;  // Most changes one slave went through
+    bool                config_ramp_ok;
+    esp_err_t           config_err;
+    double              config_ms;          // The batch write to every slave
+    double              config_read_ms;     // Reading back, slave by slave
+    bool                ok;
+} bench_result_t;
+
+typedef esp_err_t (*cluster_init_fn)(cluster_mode_t mode);
+typedef esp_err_t (*handle_message_fn)(const char *, const char *, size_t, const uint8_t *);
+typedef esp_err_t (*transport_init_fn)(cluster_transport_type_t type);
+typedef esp_err_t (*register_rx_fn)(cluster_transport_rx_cb_t cb, void *ctx);
+typedef esp_err_t (*start_discovery_fn)(void);
+
+// ============================================================================
+// Node loading
+// ============================================================================
+
+static void *load_symbol(void *lib, const char *name)
+{
+    void *sym = dlsym(lib, name);
+    if (!sym) {
+        fprintf(stderr, "cluster_bench: missing symbol %s\n", name);
+    }
+    return sym;
+}
+
+/**
+ * @brief Same as transport_rx_wrapper() in cluster_integration.c
+ */
+static void transport_rx(const char *msg_type, const char *payload, size_t len,
+                         const uint8_t *src_mac, void *ctx)
+{
+    handle_message_fn handle_message = (handle_message_fn)ctx;
+    handle_message(msg_type, payload, len, src_mac);
+}
+
+/**
+ * @brief Bring up a node's transport and RX path; call in the node's context
+ *
+ * Mirrors cluster_integration_init(): the master also starts discovery, and
+ * slaves join from its beacons.
+ */
+static int start_transport(void *lib, int node)
+{
+    transport_init_fn transport_init = load_symbol(lib, "cluster_transport_init");
+    register_rx_fn register_rx = load_symbol(lib, "cluster_transport_register_rx_callback");
+    handle_message_fn handle_message = load_symbol(lib, "cluster_handle_transport_message");
+    sim_node_rx_t rx = {
+        .receive = load_symbol(lib, "cluster_transport_receive"),
+    };
+    if (!transport_init || !register_rx || !handle_message || !rx.receive) {
+        return -1;
+    }
+
+    register_rx(transport_rx, (void *)handle_message);
+    if (transport_init(CLUSTER_TRANSPORT_ESPNOW) != ESP_OK ||
+        sim_transport_attach(node, &rx) != ESP_OK) {
+        return -1;
+    }
+
+    if (node == SIM_MASTER_NODE) {
+        start_discovery_fn start_discovery = load_symbol(lib, "cluster_transport_start_discovery");
+        if (!start_discovery || start_discovery() != ESP_OK) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int copy_file(const char *src, const char *dst)
+{
+    int in = open(src, O_RDONLY);
+    if (in < 0) {
+        return -1;
+    }
+    int out = open(dst, O_WRONLY | O_CREAT | O_TRUNC, 0755);
+    if (out < 0) {
+        close(in);
+        return -1;
+    }
+
+    char buf[65536];
+    ssize_t n;
+    int ret = 0;
+    while ((n = read(in, buf, sizeof(buf))) > 0) {
+        if (write(out, buf, n) != n) {
+            ret = -1;
+            break;
+        }
+    }
+    if (n < 0) {
+        ret = -1;
+    }
+    close(in);
+    close(out);
+    return ret;
+}
+
+static void slave_lib_path(const bench_config_t *cfg, int node, char *path, size_t len)
+{
+    snprintf(path, len, "%s/slave_%02d.so", cfg->slave_dir, node);
+}
+
+// ============================================================================
+// One cluster size (runs in a child process)
+// ============================================================================
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double *sorted, uint32_t count, double p)
+{
+    if (count == 0) {
+        return 0;
+    }
+    uint32_t i = (uint32_t)(p * (count - 1) + 0.5);
+    return sorted[i];
+}
+
+/**
+ * @brief Compare the master's clock estimates with the skew each slave was given
+ */
+static void measure_clock(const bench_config_t *cfg, void *master, int slaves, bench_result_t *result)
+{
+    esp_err_t (*get_slave_info)(uint8_t, cluster_slave_t *) =
+        load_symbol(master, "cluster_master_get_slave_info");
+    esp_err_t (*to_master_time)(uint8_t, int64_t, int64_t *) =
+        load_symbol(master, "cluster_master_to_master_time");
+    if (!get_slave_info || !to_master_time) {
+        return;
+    }
+
+    double sum = 0;
+    for (int slot = 0; slot < CLUSTER_MAX_SLAVES; slot++) {
+        cluster_slave_t info;
+        if (get_slave_info(slot, &info) != ESP_OK || info.state == SLAVE_STATE_DISCONNECTED) {
+            continue;
+        }
+        for (int node = 1; node <= slaves; node++) {
+            uint8_t mac[6];
+            sim_transport_node_mac(node, mac);
+            if (memcmp(mac, info.mac_addr, sizeof(mac)) != 0) {
+                continue;
+            }
+
+            int64_t now = sim_now_us();
+            int64_t estimate;
+            if (to_master_time(slot, sim_node_time_us(node, now), &estimate) == ESP_OK) {
+                double err = fabs((double)(estimate - now));
+                result->clock_synced++;
+                sum += err;
+                if (err > result->clock_err_max_us) {
+                    result->clock_err_max_us = err;
+                }
+            }
+            break;
+        }
+    }
+    result->clock_err_mean_us = result->clock_synced ? sum / result->clock_synced : 0;
+}
+
+/**
+ * @brief Summarize the master's trace ring, as /api/cluster/trace does
+ */
+static void measure_trace(void *master, bench_result_t *result)
+{
+    size_t (*trace_read)(uint32_t *, cluster_trace_record_t *, size_t, uint32_t *) =
+        load_symbol(master, "cluster_trace_read");
+    void (*trace_summarize)(const cluster_trace_record_t *, size_t, cluster_trace_span_t *) =
+        load_symbol(master, "cluster_trace_summarize");
+    if (!trace_read || !trace_summarize) {
+        return;
+    }
+
+    static cluster_trace_record_t recs[CLUSTER_TRACE_SIZE];
+    uint32_t cursor = 0;
+    size_t count = trace_read(&cursor, recs, CLUSTER_TRACE_SIZE, NULL);
+
+    cluster_trace_span_t spans[CLUSTER_TRACE_SPAN_COUNT];
+    trace_summarize(recs, count, spans);
+
+    result->trace_records = (int)count;
+    for (int i = 0; i < CLUSTER_TRACE_SPAN_COUNT; i++) {
+        snprintf(result->spans[i].name, sizeof(result->spans[i].name), "%s", spans[i].name);
+        result->spans[i].count = spans[i].count;
+        result->spans[i].p50_us = spans[i].p50_us;
+        result->spans[i].p90_us = spans[i].p90_us;
+        result->spans[i].max_us = spans[i].max_us;
+    }
+}
+
+/**
+ * @brief Node of the slave registered in a slot, or -1
+ */
+static int slot_node(esp_err_t (*get_slave_info)(uint8_t, cluster_slave_t *), int slot, int slaves)
+{
+    cluster_slave_t info;
+    if (get_slave_info(slot, &info) != ESP_OK || info.state != SLAVE_STATE_ACTIVE) {
+        return -1;
+    }
+    for (int node = 1; node <= slaves; node++) {
+        uint8_t mac[6];
+        sim_transport_node_mac(node, mac);
+        if (memcmp(mac, info.mac_addr, sizeof(mac)) == 0) {
+            return node;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Retune every active slave over the radio and read the settings back
+ */
+static void measure_config(void *master, int slaves, bench_result_t *result)
+{
+    esp_err_t (*get_slave_info)(uint8_t, cluster_slave_t *) =
+        load_symbol(master, "cluster_master_get_slave_info");
+    esp_err_t (*set_settings)(cluster_remote_set_t *, int, uint8_t, uint32_t) =
+        load_symbol(master, "cluster_master_set_slaves_settings");
+    esp_err_t (*get_settings)(uint8_t, const uint8_t *, int, cluster_setting_value_t *, uint32_t) =
+        load_symbol(master, "cluster_master_get_slave_settings");
+    cluster_remote_set_t *sets = calloc(CLUSTER_MAX_SLAVES, sizeof(cluster_remote_set_t));
+    int *nodes = calloc(CLUSTER_MAX_SLAVES, sizeof(int));
+    if (!get_slave_info || !set_settings || !get_settings || !sets || !nodes) {
+        free(sets);
+        free(nodes);
+        return;
+    }
+
+    // A different point per slave, up to 200 MHz and 75 mV away from the default
+    int n = 0;
+    for (int slot = 0; slot < CLUSTER_MAX_SLAVES; slot++) {
+        int node = slot_node(get_slave_info, slot, slaves);
+        if (node < 0) {
+            continue;
+        }
+        cluster_remote_set_t *set = &sets[n];
+        set->slave_id = (uint8_t)slot;
+        set->count = 2;
+        set->values[0].setting_id = CLUSTER_SETTING_FREQUENCY;
+        set->values[0].data_type = CLUSTER_SETTING_TYPE_U32;
+        set->values[0].value.u32 = 525 + 25 * (node % 9) - 100;
+        set->values[1].setting_id = CLUSTER_SETTING_CORE_VOLTAGE;
+        set->values[1].data_type = CLUSTER_SETTING_TYPE_U32;
+        set->values[1].value.u32 = 1150 + 25 * (node % 4) - 25;
+        nodes[n++] = node;
+    }
+    result->config_sent = n;
+    result->config_ramp_ok = true;
+    if (n == 0) {
+        free(sets);
+        free(nodes);
+        return;
+    }
+
+    // Requests go out from the master's radio
+    sim_set_current_node(SIM_MASTER_NODE);
+    int64_t t0 = sim_now_us();
+    result->config_err = set_settings(sets, n, CLUSTER_REMOTE_FLAG_RAMP, 0);
+    int64_t t1 = sim_now_us();
+
+    static const uint8_t ids[] = {CLUSTER_SETTING_FREQUENCY, CLUSTER_SETTING_CORE_VOLTAGE};
+    bool reported[CLUSTER_MAX_SLAVES] = {false};
+    for (int i = 0; i < n; i++) {
+        cluster_setting_value_t values[2];
+        reported[i] = get_settings(sets[i].slave_id, ids, 2, values, 0) == ESP_OK &&
+                      values[0].value.u32 == sets[i].values[0].value.u32 &&
+                      values[1].value.u32 == sets[i].values[1].value.u32;
+    }
+    int64_t t2 = sim_now_us();
+    sim_set_current_node(SIM_NO_NODE);
+
+    for (int i = 0; i < n; i++) {
+        sim_asic_settings_t asic;
+        sim_asic_get_settings(nodes[i], &asic);
+        if (reported[i] && sets[i].status == CLUSTER_RESP_OK &&
+            asic.freq_mhz == sets[i].values[0].value.u32 &&
+            asic.voltage_mv == sets[i].values[1].value.u32) {
+            result->config_applied++;
+        }
+        if ((int)asic.steps > result->config_ramp_steps) {
+            result->config_ramp_steps = (int)asic.steps;
+        }
+        result->config_ramp_ok &= !asic.ramp_violation;
+    }
+    result->config_ms = (t1 - t0) / 1000.0;
+    result->config_read_ms = (t2 - t1) / 1000.0;
+
+    free(sets);
+    free(nodes);
+}
+
+static int run_size(const bench_config_t *cfg, int slaves, bench_result_t *result)
+{
+    memset(result, 0, sizeof(*result));
+    result->slaves = slaves;
+
+    sim_clock_init(cfg->speed);
+
+    sim_asic_config_t asic_cfg = cfg->asic;
+    asic_cfg.record_after_us = (int64_t)(cfg->warmup_s * 1e6);
+
+    if (sim_transport_init(&cfg->net, 1 + slaves) != ESP_OK ||
+        sim_asic_init(&asic_cfg, slaves) != ESP_OK) {
+        return -1;
+    }
+
+    // Master
+    void *master = dlopen(cfg->master_lib, RTLD_NOW | RTLD_LOCAL);
+    if (!master) {
+        fprintf(stderr, "cluster_bench: %s\n", dlerror());
+        return -1;
+    }
+    cluster_init_fn master_init = load_symbol(master, "cluster_init");
+    sim_pool_master_t pool_hooks = {
+        .on_notify = load_symbol(master, "sim_master_on_notify"),
+        .on_result = load_symbol(master, "cluster_notify_share_result"),
+    };
+    void (*get_stats)(cluster_stats_t *, uint8_t *) = load_symbol(master, "cluster_master_get_stats");
+    void (*get_index_stats)(cluster_index_stats_t *) = load_symbol(master, "cluster_index_get_stats");
+    if (!master_init || !pool_hooks.on_notify || !pool_hooks.on_result ||
+        !get_stats || !get_index_stats) {
+        return -1;
+    }
+
+    sim_set_current_node(SIM_MASTER_NODE);
+    if (master_init(CLUSTER_MODE_MASTER) != ESP_OK ||
+        start_transport(master, SIM_MASTER_NODE) != 0 ||
+        sim_pool_init(&cfg->pool, &pool_hooks) != ESP_OK ||
+        sim_pool_start() != ESP_OK) {
+        fprintf(stderr, "cluster_bench: master start failed\n");
+        return -1;
+    }
+
+    // Slaves
+    for (int node = 1; node <= slaves; node++) {
+        char path[128];
+        slave_lib_path(cfg, node, path, sizeof(path));
+        // Lazy: cluster.c still references master-only functions it never
+        // calls in a slave build (the firmware link drops them)
+        void *lib = dlopen(path, RTLD_LAZY | RTLD_LOCAL);
+        if (!lib) {
+            fprintf(stderr, "cluster_bench: %s\n", dlerror());
+            return -1;
+        }
+        cluster_init_fn slave_init = load_symbol(lib, "cluster_init");
+        sim_share_found_fn on_share = load_symbol(lib, "cluster_slave_on_share_found");
+        if (!slave_init || !on_share) {
+            return -1;
+        }
+
+        sim_set_current_node(node);
+        if (cfg->skew_ppm > 0) {
+            // Booted at different times, crystals spread over +-skew
+            sim_clock_set_skew(node, 250000 + node * 1000003LL, cfg->skew_ppm * ((node % 5) - 2) / 2.0);
+        }
+        sim_asic_attach(node, on_share);
+        if (slave_init(CLUSTER_MODE_SLAVE) != ESP_OK ||
+            start_transport(lib, node) != 0) {
+            fprintf(stderr, "cluster_bench: slave %d start failed\n", node);
+            return -1;
+        }
+    }
+    sim_set_current_node(SIM_NO_NODE);
+
+    if (sim_asic_start() != ESP_OK) {
+        return -1;
+    }
+
+    // Warm-up: registrations settle; counters are taken relative to its end
+    sim_sleep_us((int64_t)(cfg->warmup_s * 1e6));
+
+    sim_pool_stats_t pool0;
+    sim_asic_stats_t asic0;
+    sim_net_stats_t net0;
+    cluster_index_stats_t index0;
+    cluster_stats_t stats0;
+    sim_pool_get_stats(&pool0);
+    sim_asic_get_stats(&asic0);
+    sim_transport_get_stats(&net0);
+    get_index_stats(&index0);
+    get_stats(&stats0, NULL);
+    double cpu0 = sim_node_cpu_seconds(SIM_MASTER_NODE);
+    int64_t t0 = sim_now_us();
+
+    if (cfg->outage_s > 0) {
+        // Channel goes away for the whole rack a third of the way in
+        double before_s = cfg->duration_s / 3;
+        sim_sleep_us((int64_t)(before_s * 1e6));
+        sim_transport_set_outage(true);
+        sim_sleep_us((int64_t)(cfg->outage_s * 1e6));
+        sim_transport_set_outage(false);
+        sim_sleep_us((int64_t)((cfg->duration_s - before_s - cfg->outage_s) * 1e6));
+    } else {
+        sim_sleep_us((int64_t)(cfg->duration_s * 1e6));
+    }
+
+    // Stop new work and new shares, let in-flight traffic drain
+    sim_pool_stop();
+    sim_asic_stop();
+    sim_sleep_us((int64_t)(BENCH_DRAIN_S * 1e6));
+
+    sim_pool_stats_t pool1;
+    sim_asic_stats_t asic1;
+    sim_net_stats_t net1;
+    cluster_index_stats_t index1;
+    sim_pool_get_stats(&pool1);
+    sim_asic_get_stats(&asic1);
+    sim_transport_get_stats(&net1);
+    get_index_stats(&index1);
+    double cpu1 = sim_node_cpu_seconds(SIM_MASTER_NODE);
+    int64_t t1 = sim_now_us();
+
+    cluster_stats_t stats1;
+    uint8_t active = 0;
+    get_stats(&stats1, &active);
+
+    if (cfg->skew_ppm > 0) {
+        measure_clock(cfg, master, slaves, result);
+    }
+    if (cfg->trace) {
+        measure_trace(master, result);
+    }
+    if (cfg->config) {
+        measure_config(master, slaves, result);
+    }
+
+    result->active_slaves = active;
+    // Same cut-off the ASIC model uses for latency samples
+    result->jobs = sim_pool_jobs_since(asic_cfg.record_after_us);
+    result->deliveries = asic1.work_deliveries;
+    result->regressions = asic1.work_regressions - asic0.work_regressions;
+    result->shares_found = asic1.shares_found - asic0.shares_found;
+    result->pool.notifies = result->jobs;
+    result->pool.submitted = pool1.submitted - pool0.submitted;
+    result->pool.accepted = pool1.accepted - pool0.accepted;
+    result->pool.stale = pool1.stale - pool0.stale;
+    result->pool.duplicate = pool1.duplicate - pool0.duplicate;
+    result->pool.rejected = pool1.rejected - pool0.rejected;
+    result->master_dedup = index1.duplicates_dropped - index0.duplicates_dropped;
+    result->master_stale = index1.stale_dropped - index0.stale_dropped;
+    result->master_invalid = stats1.total_shares_invalid - stats0.total_shares_invalid;
+    result->master_unverified = stats1.total_shares_unverified - stats0.total_shares_unverified;
+    result->master_cpu_ms_per_job = result->jobs ? (cpu1 - cpu0) * 1000.0 / result->jobs : 0;
+    result->air_percent = 100.0 * (double)(net1.air_us - net0.air_us) / (double)(t1 - t0);
+    result->rx_overflows = net1.rx_overflows - net0.rx_overflows;
+    result->master_tx = net1.master_tx - net0.master_tx;
+
+    qsort(asic1.latency_ms, asic1.latency_count, sizeof(double), compare_double);
+    result->lat_p50 = percentile(asic1.latency_ms, asic1.latency_count, 0.50);
+    result->lat_p90 = percentile(asic1.latency_ms, asic1.latency_count, 0.90);
+    result->lat_p99 = percentile(asic1.latency_ms, asic1.latency_count, 0.99);
+    result->lat_max = asic1.latency_count ? asic1.latency_ms[asic1.latency_count - 1] : 0;
+
+    result->ok = true;
+    return 0;
+}
+
+/**
+ * @brief Fork, run one size in the child and read its result back
+ */
+static int run_size_isolated(const bench_config_t *cfg, int slaves, bench_result_t *result)
+{
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return -1;
+    }
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        bench_result_t child_result;
+        int ret = run_size(cfg, slaves, &child_result);
+        if (ret == 0 && write(fds[1], &child_result, sizeof(child_result)) != sizeof(child_result)) {
+            ret = -1;
+        }
+        close(fds[1]);
+        _exit(ret == 0 ? 0 : 1);
+    }
+
+    close(fds[1]);
+    ssize_t n;
+    do {
+        n = read(fds[0], result, sizeof(*result));
+    } while (n < 0 && errno == EINTR);
+    close(fds[0]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (n != sizeof(*result) || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// ============================================================================
+// Report
+// ============================================================================
+
+static void print_header(const bench_config_t *cfg)
+{
+    printf("Clusteraxe cluster benchmark\n");
+    printf("  radio : %.0f kbps, latency %.1f ms + %.1f ms jitter, loss %.1f%%, "
+           "reorder %.1f%% (<= %.0f ms)\n",
+           cfg->net.rate_kbps, cfg->net.latency_ms, cfg->net.jitter_ms,
+           cfg->net.loss * 100, cfg->net.reorder * 100, cfg->net.reorder_ms);
+    printf("  pool  : notify every %.1f s, %.0f%% new blocks, %d jobs kept, result after %.0f ms\n",
+           cfg->pool.notify_interval_ms / 1000, cfg->pool.clean_ratio * 100,
+           cfg->pool.jobs_kept, cfg->pool.rtt_ms);
+    printf("  asic  : %.2f shares/s per slave\n", cfg->asic.shares_per_s);
+    if (cfg->outage_s > 0) {
+        printf("  outage: all frames lost for %.0f s from %.0f s into the window\n",
+               cfg->outage_s, cfg->duration_s / 3);
+    }
+    if (cfg->skew_ppm > 0) {
+        printf("  clock : slave esp_timers offset by seconds, drift within +-%.0f ppm\n", cfg->skew_ppm);
+    }
+    printf("  window: %.0f s after %.0f s warm-up (+%.0f s drain), clock x%.0f\n\n",
+           cfg->duration_s, cfg->warmup_s, BENCH_DRAIN_S, cfg->speed);
+
+    printf("%6s %6s %5s %7s %5s | %8s %8s %8s %8s | %6s %6s | %6s %5s %3s %3s %5s %4s %5s %5s | %8s %6s %6s\n",
+           "slaves", "active", "jobs", "reach%", "back",
+           "p50 ms", "p90 ms", "p99 ms", "max ms",
+           "found", "deliv%",
+           "accept", "stale", "dup", "rej", "dedup", "drop", "inval", "unver",
+           "cpu/job", "air%", "rxdrop");
+}
+
+static void print_row(const bench_result_t *r)
+{
+    double reach = (r->jobs && r->slaves) ? 100.0 * r->deliveries / ((double)r->jobs * r->slaves) : 0;
+    double delivered = r->shares_found ? 100.0 * r->pool.submitted / r->shares_found : 0;
+
+    printf("%6d %6d %5u %7.1f %5u | %8.1f %8.1f %8.1f %8.1f | %6u %6.1f | %6u %5u %3u %3u %5u %4u %5u %5u | %6.2fms %6.1f %6u\n",
+           r->slaves, r->active_slaves, r->jobs, reach, r->regressions,
+           r->lat_p50, r->lat_p90, r->lat_p99, r->lat_max,
+           r->shares_found, delivered,
+           r->pool.accepted, r->pool.stale, r->pool.duplicate, r->pool.rejected, r->master_dedup, r->master_stale,
+           r->master_invalid, r->master_unverified,
+           r->master_cpu_ms_per_job, r->air_percent, r->rx_overflows);
+}
+
+static void print_clock_row(const bench_result_t *r)
+{
+    printf("%6s clock: %d/%d slaves synced, error mean %.0f us, max %.0f us\n",
+           "", r->clock_synced, r->active_slaves, r->clock_err_mean_us, r->clock_err_max_us);
+}
+
+static void print_trace_rows(const bench_result_t *r)
+{
+    printf("%6s trace: %d records\n", "", r->trace_records);
+    for (int i = 0; i < CLUSTER_TRACE_SPAN_COUNT; i++) {
+        if (r->spans[i].count == 0) {
+            printf("%6s   %-16s %5s\n", "", r->spans[i].name, "-");
+            continue;
+        }
+        printf("%6s   %-16s %5u  p50 %8.1f ms  p90 %8.1f ms  max %8.1f ms\n",
+               "", r->spans[i].name, r->spans[i].count,
+               r->spans[i].p50_us / 1000.0, r->spans[i].p90_us / 1000.0, r->spans[i].max_us / 1000.0);
+    }
+}
+
+static void print_config_row(const bench_result_t *r)
+{
+    printf("%6s config: %d/%d slaves retuned in %.0f ms (%s), up to %d steps%s; read back in %.0f ms\n",
+           "", r->config_applied, r->config_sent, r->config_ms, esp_err_to_name(r->config_err),
+           r->config_ramp_steps, r->config_ramp_ok ? "" : ", RAMP ORDER VIOLATED", r->config_read_ms);
+}
+
+static bool trace_covers_path(const bench_result_t *r)
+{
+    // Hops every accepted share passes; drops and job_age are not required
+    static const char *const required[] = {
+        "dispatch", "downlink", "asic_feed", "share_send", "uplink", "submit", "pool",
+    };
+
+    for (size_t i = 0; i < sizeof(required) / sizeof(required[0]); i++) {
+        bool found = false;
+        for (int s = 0; s < CLUSTER_TRACE_SPAN_COUNT; s++) {
+            if (strcmp(r->spans[s].name, required[i]) == 0) {
+                found = r->spans[s].count > 0;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool result_passes(const bench_config_t *cfg, const bench_result_t *r)
+{
+    double delivered = r->shares_found ? 100.0 * r->pool.submitted / r->shares_found : 0;
+
+    if (cfg->trace && !trace_covers_path(r)) {
+        return false;
+    }
+
+    if (cfg->config &&
+        (r->config_sent == 0 || r->config_applied < r->config_sent || r->config_err != ESP_OK ||
+         !r->config_ramp_ok)) {
+        return false;
+    }
+
+    if (cfg->skew_ppm > 0 &&
+        (r->clock_synced < r->active_slaves || r->clock_err_max_us > BENCH_CLOCK_MAX_ERR_US)) {
+        return false;
+    }
+
+    return r->ok &&
+           delivered >= cfg->min_deliv &&
+           r->pool.accepted > 0 &&
+           r->deliveries > 0 &&
+           r->pool.duplicate == 0 &&
+           r->pool.rejected == 0 &&
+           r->master_invalid == 0 &&
+           r->master_unverified < r->pool.submitted;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: cluster_bench [options]\n"
+        "  --slaves LIST       cluster sizes, e.g. 1,2,4,8,16,32,64 (max %d)\n"
+        "  --duration S        measured window, simulated seconds (60)\n"
+        "  --warmup S          warm-up before measuring (10)\n"
+        "  --speed X           simulated ms per real ms (10)\n"
+        "  --rate KBPS         air rate (1000)\n"
+        "  --latency MS        delivery latency after airtime (1)\n"
+        "  --jitter MS         extra uniform latency (2)\n"
+        "  --loss P            per-receiver frame loss (0.02)\n"
+        "  --reorder P         share of frames held back (0.01)\n"
+        "  --notify-ms MS      pool notify interval (10000)\n"
+        "  --clean P           share of notifies that start a new block (0.2)\n"
+        "  --shares-per-s R    shares per slave per second (0.5)\n"
+        "  --outage S          lose every frame for S s a third into the window (0)\n"
+        "  --seed N            random seed (1)\n"
+        "  --quick             sizes 1,8,64 with a 30 s window\n"
+        "  --check             fail on no accepted shares, duplicate, rejected or\n"
+        "                      unverifiable shares\n"
+        "  --min-deliv P       with --check, also fail below P%% delivered (0)\n"
+        "  --skew PPM          skew slave clocks by seconds and up to +-PPM; check the estimates\n"
+        "  --trace             print stage latencies from the master's trace; check every hop\n"
+        "  --config            retune every slave over the radio at the end; check they all took it\n"
+        "  --master-lib PATH   master library (%s)\n"
+        "  --slave-lib PATH    slave library (%s)\n",
+        SIM_MAX_SLAVES, SIM_MASTER_LIB, SIM_SLAVE_LIB);
+}
+
+static int parse_sizes(const char *list, bench_config_t *cfg)
+{
+    cfg->size_count = 0;
+    char buf[128];
+    strncpy(buf, list, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+
+    for (char *tok = strtok(buf, ","); tok; tok = strtok(NULL, ",")) {
+        int n = atoi(tok);
+        if (n < 1 || n > SIM_MAX_SLAVES || cfg->size_count >= BENCH_MAX_SIZES) {
+            return -1;
+        }
+        cfg->sizes[cfg->size_count++] = n;
+    }
+    return cfg->size_count > 0 ? 0 : -1;
+}
+
+int main(int argc, char **argv)
+{
+    bench_config_t cfg = {
+        .master_lib = SIM_MASTER_LIB,
+        .slave_lib = SIM_SLAVE_LIB,
+        .warmup_s = 10,
+        .duration_s = 60,
+        .speed = 10,
+        .net = {
+            .latency_ms = 1, .jitter_ms = 2, .loss = 0.02,
+            .reorder = 0.01, .reorder_ms = 20, .rate_kbps = 1000, .seed = 1,
+        },
+        .pool = {
+            .notify_interval_ms = 10000, .clean_ratio = 0.2, .rtt_ms = 40,
+            .jobs_kept = 8, .pool_diff = 1000, .seed = 1,
+        },
+        .asic = { .shares_per_s = 0.5, .seed = 1 },
+    };
+    parse_sizes("1,2,4,8,16,32,64", &cfg);
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--quick") == 0) {
+            parse_sizes("1,8,64", &cfg);
+            cfg.duration_s = 30;
+            continue;
+        }
+        if (strcmp(arg, "--check") == 0) {
+            cfg.check = true;
+            continue;
+        }
+        if (strcmp(arg, "--trace") == 0) {
+            cfg.trace = true;
+            continue;
+        }
+        if (strcmp(arg, "--config") == 0) {
+            cfg.config = true;
+            continue;
+        }
+        if (!val) {
+            usage();
+            return 2;
+        }
+        i++;
+
+        if (strcmp(arg, "--slaves") == 0) {
+            if (parse_sizes(val, &cfg) != 0) {
+                usage();
+                return 2;
+            }
+        } else if (strcmp(arg, "--duration") == 0) {
+            cfg.duration_s = atof(val);
+        } else if (strcmp(arg, "--warmup") == 0) {
+            cfg.warmup_s = atof(val);
+        } else if (strcmp(arg, "--speed") == 0) {
+            cfg.speed = atof(val);
+        } else if (strcmp(arg, "--rate") == 0) {
+            cfg.net.rate_kbps = atof(val);
+        } else if (strcmp(arg, "--latency") == 0) {
+            cfg.net.latency_ms = atof(val);
+        } else if (strcmp(arg, "--jitter") == 0) {
+            cfg.net.jitter_ms = atof(val);
+        } else if (strcmp(arg, "--loss") == 0) {
+            cfg.net.loss = atof(val);
+        } else if (strcmp(arg, "--reorder") == 0) {
+            cfg.net.reorder = atof(val);
+        } else if (strcmp(arg, "--notify-ms") == 0) {
+            cfg.pool.notify_interval_ms = atof(val);
+        } else if (strcmp(arg, "--clean") == 0) {
+            cfg.pool.clean_ratio = atof(val);
+        } else if (strcmp(arg, "--shares-per-s") == 0) {
+            cfg.asic.shares_per_s = atof(val);
+        } else if (strcmp(arg, "--outage") == 0) {
+            cfg.outage_s = atof(val);
+        } else if (strcmp(arg, "--min-deliv") == 0) {
+            cfg.min_deliv = atof(val);
+        } else if (strcmp(arg, "--skew") == 0) {
+            cfg.skew_ppm = atof(val);
+        } else if (strcmp(arg, "--seed") == 0) {
+            uint32_t seed = (uint32_t)strtoul(val, NULL, 0);
+            cfg.net.seed = seed;
+            cfg.pool.seed = seed * 3 + 1;
+            cfg.asic.seed = seed * 7 + 5;
+        } else if (strcmp(arg, "--master-lib") == 0) {
+            cfg.master_lib = val;
+        } else if (strcmp(arg, "--slave-lib") == 0) {
+            cfg.slave_lib = val;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    if (cfg.speed <= 0 || cfg.duration_s <= 0 || cfg.warmup_s < 0 || cfg.net.rate_kbps <= 0 ||
+        cfg.pool.notify_interval_ms <= 0 || cfg.outage_s < 0 || cfg.skew_ppm < 0 ||
+        cfg.outage_s >= cfg.duration_s * 2 / 3) {
+        usage();
+        return 2;
+    }
+
+    // One private copy of the slave library per slave
+    int max_slaves = 0;
+    for (int i = 0; i < cfg.size_count; i++) {
+        if (cfg.sizes[i] > max_slaves) {
+            max_slaves = cfg.sizes[i];
+        }
+    }
+    strcpy(cfg.slave_dir, "/tmp/cluster_bench.XXXXXX");
+    if (!mkdtemp(cfg.slave_dir)) {
+        perror("cluster_bench: mkdtemp");
+        return 1;
+    }
+    for (int node = 1; node <= max_slaves; node++) {
+        char path[128];
+        slave_lib_path(&cfg, node, path, sizeof(path));
+        if (copy_file(cfg.slave_lib, path) != 0) {
+            fprintf(stderr, "cluster_bench: cannot copy %s\n", cfg.slave_lib);
+            return 1;
+        }
+    }
+
+    print_header(&cfg);
+
+    int failures = 0;
+    for (int i = 0; i < cfg.size_count; i++) {
+        bench_result_t result;
+        if (run_size_isolated(&cfg, cfg.sizes[i], &result) != 0) {
+            printf("%6d   run failed\n", cfg.sizes[i]);
+            failures++;
+            continue;
+        }
+        print_row(&result);
+        if (cfg.skew_ppm > 0) {
+            print_clock_row(&result);
+        }
+        if (cfg.trace) {
+            print_trace_rows(&result);
+        }
+        if (cfg.config) {
+            print_config_row(&result);
+        }
+        if (cfg.check && !result_passes(&cfg, &result)) {
+            failures++;
+        }
+    }
+
+    for (int node = 1; node <= max_slaves; node++) {
+        char path[128];
+        slave_lib_path(&cfg, node, path, sizeof(path));
+        unlink(path);
+    }
+    rmdir(cfg.slave_dir);
+
+    printf("\nreach%%  : (job, slave) pairs whose work reached the slave's ASIC\n"
+           "back    : times a late work frame put a slave back on an older job\n"
+           "deliv%%  : shares submitted to the pool / shares found by ASICs\n"
+           "dedup   : duplicate shares dropped by the master before the pool\n"
+           "drop    : shares the master dropped as stale (old block or ntime)\n"
+           "cpu/job : master CPU time (all master tasks) per pool notify\n"
+           "air%%    : channel time used by all nodes\n");
+
+    return failures ? 1 : 0;
+}
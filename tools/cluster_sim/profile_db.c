@@ -0,0 +1,281 @@
+/**
+ * @file profile_db.c
+ * @brief Temperature-indexed profile database checks
+ *
+ * Drives cluster_profile_db.c the way cluster_autotune.c does: locks
+ * recorded per board, mode and ambient bucket, saved as an NVS blob, and
+ * looked up again when the room temperature changes.
+ *
+ * Checks:
+ *   - the blob round-trips every field, costs 28 bytes an entry, and
+ *     truncated, foreign or newer blobs are refused
+ *   - a lock replaces the one in its bucket, and a full database drops
+ *     the oldest
+ *   - boards match by MAC, and by chip and board version where known
+ *   - lookups interpolate between buckets with voltage rounded up and
+ *     frequency down, fall back to the coldest bucket, and refuse to
+ *     extrapolate far above the warmest
+ *   - on the sim_chip.h model, points interpolated from locks at 15, 25
+ *     and 35°C are stable at the temperatures in between and within 2% of
+ *     the best J/TH there, where reusing the 15°C lock at 30°C is not
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cluster_profile_db.h"
+#include "sim_chip.h"
+
+#define TEST_ERROR_MAX      1.0f
+#define TEST_TEMP_MAX       65.0f
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+static profile_device_t device(uint8_t id, uint16_t asic_id, const char *board)
+{
+    profile_device_t d = {
+        .mac = {0x24, 0x0a, 0xc4, 0x00, 0x00, id},
+        .asic_id = asic_id,
+    };
+    strncpy(d.board, board, sizeof(d.board) - 1);
+    return d;
+}
+
+// ============================================================================
+// Blob
+// ============================================================================
+
+static void check_blob(void)
+{
+    static profile_db_t db, copy;
+    static uint8_t blob[CLUSTER_PROFILE_DB_BLOB_MAX];
+
+    cluster_profile_db_init(&db, 5, 5, 5, 5);
+    profile_device_t a = device(1, 1370, "601");
+    profile_device_t b = device(2, 1368, "0.11");
+    cluster_profile_db_record(&db, &a, AUTOTUNE_MODE_EFFICIENCY, 24.0f, 525, 1150, 16.84f, 1197.0f, 1700000000u);
+    cluster_profile_db_record(&db, &b, AUTOTUNE_MODE_HASHRATE, -3.0f, 750, 1250, 19.5f, 1710.4f, 1700000123u);
+
+    int len = cluster_profile_db_encode(&db, blob, sizeof(blob));
+    CHECK(len == CLUSTER_PROFILE_DB_HEADER_SIZE + 2 * CLUSTER_PROFILE_DB_ENTRY_SIZE,
+          "two entries encoded in %d bytes", len);
+    CHECK(CLUSTER_PROFILE_DB_BLOB_MAX <= 1400, "full database is %d bytes", CLUSTER_PROFILE_DB_BLOB_MAX);
+    CHECK(cluster_profile_db_encode(&db, blob, len - 1) < 0, "encoded into a short buffer");
+
+    cluster_profile_db_init(&copy, 5, 5, 5, 5);
+    CHECK(cluster_profile_db_decode(&copy, blob, len) == ESP_OK && copy.count == 2, "blob not decoded");
+    const profile_entry_t *e = &copy.entries[0], *f = &copy.entries[1];
+    CHECK(cluster_profile_db_same_device(&e->device, &a) && strcmp(e->device.board, "601") == 0 &&
+          e->device.asic_id == 1370, "device lost in the blob");
+    CHECK(e->mode == AUTOTUNE_MODE_EFFICIENCY && e->temp_c == 25 && e->freq_mhz == 525 &&
+          e->voltage_mv == 1150 && fabsf(e->efficiency - 16.84f) < 0.006f && e->hashrate == 1197.0f &&
+          e->saved_at == 1700000000u, "entry changed in the blob");
+    CHECK(f->temp_c == -5 && strcmp(f->device.board, "0.11") == 0 && f->hashrate == 1710.0f &&
+          f->mode == AUTOTUNE_MODE_HASHRATE, "second entry changed in the blob");
+
+    CHECK(cluster_profile_db_decode(&copy, blob, len - 1) == ESP_ERR_INVALID_SIZE, "truncated blob accepted");
+    blob[1] = 2;
+    CHECK(cluster_profile_db_decode(&copy, blob, len) == ESP_ERR_INVALID_VERSION, "newer blob accepted");
+    blob[0] = '{';
+    CHECK(cluster_profile_db_decode(&copy, blob, len) == ESP_ERR_INVALID_ARG, "foreign blob accepted");
+    CHECK(copy.count == 2, "refused blob changed the database");
+}
+
+// ============================================================================
+// Records and devices
+// ============================================================================
+
+static void check_records(void)
+{
+    static profile_db_t db;
+    cluster_profile_db_init(&db, 5, 5, 5, 5);
+    profile_device_t a = device(1, 1370, "601");
+
+    int i = cluster_profile_db_record(&db, &a, AUTOTUNE_MODE_EFFICIENCY, 21.0f, 500, 1100, 0, 0, 1);
+    int j = cluster_profile_db_record(&db, &a, AUTOTUNE_MODE_EFFICIENCY, 19.0f, 525, 1100, 0, 0, 2);
+    CHECK(i == j && db.count == 1 && db.entries[0].freq_mhz == 525, "same bucket not replaced");
+    cluster_profile_db_record(&db, &a, AUTOTUNE_MODE_BALANCED, 20.0f, 600, 1150, 0, 0, 3);
+    cluster_profile_db_record(&db, &a, AUTOTUNE_MODE_EFFICIENCY, 30.0f, 500, 1125, 0, 0, 4);
+    CHECK(db.count == 3, "%d entries for three buckets/modes", db.count);
+    const profile_entry_t *latest = cluster_profile_db_latest(&db, &a);
+    CHECK(latest && latest->saved_at == 4, "latest lock not found");
+
+    // Full: the oldest goes
+    cluster_profile_db_init(&db, 5, 5, 5, 5);
+    for (int n = 0; n < CLUSTER_PROFILE_DB_MAX_ENTRIES; n++) {
+        profile_device_t d = device((uint8_t)n, 1370, "601");
+        cluster_profile_db_record(&db, &d, AUTOTUNE_MODE_EFFICIENCY, 25.0f, 500, 1100, 0, 0, 100 + (n * 7) % 50);
+    }
+    profile_device_t late = device(200, 1370, "601");
+    i = cluster_profile_db_record(&db, &late, AUTOTUNE_MODE_EFFICIENCY, 25.0f, 500, 1100, 0, 0, 1000);
+    profile_device_t oldest = device(0, 1370, "601");
+    profile_match_t m;
+    CHECK(db.count == CLUSTER_PROFILE_DB_MAX_ENTRIES && db.entries[i].saved_at == 1000 &&
+          cluster_profile_db_lookup(&db, &oldest, AUTOTUNE_MODE_EFFICIENCY, 25.0f, &m) == ESP_ERR_NOT_FOUND,
+          "full database did not drop the oldest");
+
+    // Devices: unknown details match, known ones must agree
+    profile_device_t bare = device(1, 0, "");
+    profile_device_t other_board = device(1, 1370, "204");
+    profile_device_t other_mac = device(9, 1370, "601");
+    CHECK(cluster_profile_db_same_device(&a, &bare), "unknown chip/board did not match");
+    CHECK(!cluster_profile_db_same_device(&a, &other_board), "different board matched");
+    CHECK(!cluster_profile_db_same_device(&a, &other_mac), "different MAC matched");
+
+    cluster_profile_db_init(&db, 5, 5, 5, 5);
+    cluster_profile_db_record(&db, &a, AUTOTUNE_MODE_EFFICIENCY, 25.0f, 500, 1100, 0, 0, 1);
+    cluster_profile_db_record(&db, &other_mac, AUTOTUNE_MODE_EFFICIENCY, 25.0f, 500, 1100, 0, 0, 1);
+    CHECK(cluster_profile_db_forget(&db, &a) == 1 && db.count == 1, "forget removed the wrong entries");
+    CHECK(cluster_profile_db_forget(&db, NULL) == 1 && db.count == 0, "forget all left entries");
+}
+
+static void check_lookup(void)
+{
+    static profile_db_t db;
+    cluster_profile_db_init(&db, 5, 5, 5, 5);
+    profile_device_t a = device(1, 1370, "601");
+    cluster_profile_db_record(&db, &a, AUTOTUNE_MODE_EFFICIENCY, 15.0f, 550, 1100, 0, 0, 1);
+    cluster_profile_db_record(&db, &a, AUTOTUNE_MODE_EFFICIENCY, 25.0f, 520, 1123, 0, 0, 2);
+
+    profile_match_t m;
+    CHECK(cluster_profile_db_lookup(&db, &a, AUTOTUNE_MODE_EFFICIENCY, 25.0f, &m) == ESP_OK &&
+          !m.interpolated && m.freq_mhz == 520 && m.voltage_mv == 1123, "exact bucket not returned as is");
+    CHECK(cluster_profile_db_lookup(&db, &a, AUTOTUNE_MODE_EFFICIENCY, 20.0f, &m) == ESP_OK &&
+          m.interpolated && m.lower_c == 15 && m.upper_c == 25, "no interpolation between buckets");
+    // Halfway: 535 MHz, 1111.5 mV -> 535, 1115
+    CHECK(m.freq_mhz == 535 && m.voltage_mv == 1115, "interpolated %d MHz, %d mV", m.freq_mhz, m.voltage_mv);
+    CHECK(cluster_profile_db_lookup(&db, &a, AUTOTUNE_MODE_EFFICIENCY, 18.0f, &m) == ESP_OK &&
+          m.freq_mhz == 540 && m.voltage_mv == 1110, "interpolated %d MHz, %d mV at 18°C", m.freq_mhz,
+          m.voltage_mv);
+
+    CHECK(cluster_profile_db_lookup(&db, &a, AUTOTUNE_MODE_EFFICIENCY, 2.0f, &m) == ESP_OK &&
+          m.freq_mhz == 550 && m.voltage_mv == 1100, "colder room did not use the coldest bucket");
+    CHECK(cluster_profile_db_lookup(&db, &a, AUTOTUNE_MODE_EFFICIENCY, 29.0f, &m) == ESP_OK &&
+          m.freq_mhz == 520, "slightly warmer room did not use the warmest bucket");
+    CHECK(cluster_profile_db_lookup(&db, &a, AUTOTUNE_MODE_EFFICIENCY, 31.0f, &m) == ESP_ERR_NOT_FOUND,
+          "extrapolated %.0f°C above the warmest bucket", 6.0f);
+    CHECK(cluster_profile_db_lookup(&db, &a, AUTOTUNE_MODE_HASHRATE, 25.0f, &m) == ESP_ERR_NOT_FOUND,
+          "profile of another mode returned");
+}
+
+// ============================================================================
+// Chip model
+// ============================================================================
+
+typedef struct {
+    uint16_t freq;
+    uint16_t voltage;
+    float    jth;
+    bool     stable;
+} point_t;
+
+static point_t evaluate(sim_chip_t *chip, float ambient, uint16_t freq, uint16_t voltage)
+{
+    chip->ambient = ambient;
+    float temp = sim_chip_settled_temp(chip, freq, voltage);
+    float hashrate = sim_chip_hashrate(chip, freq, voltage, temp);
+    return (point_t){
+        .freq = freq,
+        .voltage = voltage,
+        .jth = hashrate > 0 ? sim_chip_power(chip, freq, voltage, temp) * 1000.0f / hashrate : 1e9f,
+        .stable = sim_chip_error(chip, freq, voltage, temp) <= TEST_ERROR_MAX && temp <= TEST_TEMP_MAX,
+    };
+}
+
+// What a fine autotune would lock in efficiency mode
+static point_t best_point(sim_chip_t *chip, float ambient)
+{
+    point_t best = {.jth = 1e9f};
+    for (uint16_t f = 400; f <= 625; f += 5) {
+        for (uint16_t v = 1000; v <= 1175; v += 5) {
+            point_t p = evaluate(chip, ambient, f, v);
+            if (p.stable && p.jth < best.jth) {
+                best = p;
+            }
+        }
+    }
+    return best;
+}
+
+static void check_chip_model(void)
+{
+    static profile_db_t db;
+    static const float locks[] = {15.0f, 25.0f, 35.0f};
+    static const float rooms[] = {17.0f, 20.0f, 23.0f, 27.0f, 30.0f, 33.0f};
+    const int boards = 8;
+    int checked = 0, unstable = 0, stale_unstable = 0;
+    float worst = 0, sum_loss = 0;
+
+    cluster_profile_db_init(&db, 5, 5, 5, 5);
+    for (int b = 0; b < boards; b++) {
+        uint32_t seed = 100 + b;
+        sim_chip_t chip;
+        sim_chip_init(&chip, &seed);
+        profile_device_t dev = device((uint8_t)b, 1370, "601");
+
+        for (size_t i = 0; i < sizeof(locks) / sizeof(locks[0]); i++) {
+            point_t p = best_point(&chip, locks[i]);
+            cluster_profile_db_record(&db, &dev, AUTOTUNE_MODE_EFFICIENCY, locks[i], p.freq, p.voltage,
+                                      p.jth, 0, (uint32_t)i);
+        }
+
+        for (size_t i = 0; i < sizeof(rooms) / sizeof(rooms[0]); i++) {
+            profile_match_t m;
+            if (cluster_profile_db_lookup(&db, &dev, AUTOTUNE_MODE_EFFICIENCY, rooms[i], &m) != ESP_OK) {
+                CHECK(false, "board %d: no profile at %.0f°C", b, rooms[i]);
+                continue;
+            }
+            point_t best = best_point(&chip, rooms[i]);
+            point_t got = evaluate(&chip, rooms[i], m.freq_mhz, m.voltage_mv);
+            float loss = (got.jth - best.jth) * 100.0f / best.jth;
+            checked++;
+            unstable += !got.stable;
+            sum_loss += loss;
+            if (loss > worst) {
+                worst = loss;
+            }
+            CHECK(got.stable, "board %d at %.0f°C: %d MHz, %d mV unstable", b, rooms[i], m.freq_mhz,
+                  m.voltage_mv);
+            CHECK(loss < 2.0f, "board %d at %.0f°C: %.1f%% worse than the best point", b, rooms[i], loss);
+        }
+
+        // The lock of a cold morning, kept on a hot afternoon
+        point_t cold = best_point(&chip, 15.0f);
+        stale_unstable += !evaluate(&chip, 30.0f, cold.freq, cold.voltage).stable;
+    }
+
+    printf("  interpolated: %d points, %d unstable, %.2f%% mean / %.2f%% worst J/TH over the best; "
+           "15°C lock at 30°C unstable on %d of %d boards\n",
+           checked, unstable, sum_loss / checked, worst, stale_unstable, boards);
+    CHECK(stale_unstable > boards / 2, "a stale lock held on %d of %d boards - model too forgiving",
+          boards - stale_unstable, boards);
+}
+
+int main(void)
+{
+    printf("profile_db: %d entries max, %d-byte blob\n", CLUSTER_PROFILE_DB_MAX_ENTRIES,
+           CLUSTER_PROFILE_DB_BLOB_MAX);
+
+    check_blob();
+    check_records();
+    check_lookup();
+    check_chip_model();
+
+    printf("profile_db: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,189 @@
+/**
+ * @file proxy_cache.c
+ * @brief Slave HTTP response cache checks
+ *
+ * Drives cluster_proxy_cache.c the way cluster_proxy.c does: lookups
+ * before each proxied GET, stores after, invalidation on every write.
+ *
+ * Checks:
+ *   - a response is served until its TTL and fetched again after
+ *   - entries are keyed by slave and path, and a store replaces its key
+ *   - full by entries or by bytes, the least recently used goes, also
+ *     across the 32-bit millisecond wrap
+ *   - oversized bodies and long paths are not kept; invalidating a slave
+ *     drops only its entries
+ *   - four dashboard tabs polling eight slaves every second cost the
+ *     slaves one request per slave per TTL
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cluster_proxy_cache.h"
+
+#define TTL_MS      2000
+#define MAX_BYTES   4096
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+static bool cached(proxy_cache_t *cache, int8_t slave, const char *path, uint32_t now_ms,
+                   const char *expect)
+{
+    size_t len = 0;
+    char *body = cluster_proxy_cache_get(cache, slave, path, now_ms, &len);
+    bool ok = body && (!expect || (strcmp(body, expect) == 0 && len == strlen(expect)));
+    free(body);
+    return ok;
+}
+
+// ============================================================================
+// TTL and keys
+// ============================================================================
+
+static void test_ttl(void)
+{
+    proxy_cache_t cache;
+    cluster_proxy_cache_init(&cache, TTL_MS, MAX_BYTES);
+
+    CHECK(!cached(&cache, 0, "/api/system/info", 0, NULL), "empty cache hit");
+    CHECK(cluster_proxy_cache_put(&cache, 0, "/api/system/info", "{\"a\":1}", 7, 1000), "put refused");
+    CHECK(cached(&cache, 0, "/api/system/info", 1000, "{\"a\":1}"), "fresh entry missed");
+    CHECK(cached(&cache, 0, "/api/system/info", 1000 + TTL_MS - 1, "{\"a\":1}"), "entry missed before TTL");
+    CHECK(!cached(&cache, 0, "/api/system/info", 1000 + TTL_MS, NULL), "entry served at TTL");
+    CHECK(cache.bytes == 0, "expired entry still counted (%zu bytes)", cache.bytes);
+
+    // Keys: slave and path
+    cluster_proxy_cache_put(&cache, 0, "/a", "zero-a", 6, 5000);
+    cluster_proxy_cache_put(&cache, 1, "/a", "one-a", 5, 5000);
+    cluster_proxy_cache_put(&cache, 0, "/b", "zero-b", 6, 5000);
+    CHECK(cached(&cache, 0, "/a", 5001, "zero-a"), "slave 0 /a wrong");
+    CHECK(cached(&cache, 1, "/a", 5001, "one-a"), "slave 1 /a wrong");
+    CHECK(cached(&cache, 0, "/b", 5001, "zero-b"), "slave 0 /b wrong");
+    CHECK(!cached(&cache, 1, "/b", 5001, NULL), "slave 1 /b served another's");
+
+    // A store replaces its key and restarts the TTL
+    cluster_proxy_cache_put(&cache, 0, "/a", "zero-a2", 7, 6500);
+    CHECK(cache.bytes == 7 + 5 + 6, "bytes %zu after replace, expected 18", cache.bytes);
+    CHECK(cached(&cache, 0, "/a", 8000, "zero-a2"), "replaced entry wrong");
+
+    cluster_proxy_cache_invalidate(&cache, -1);
+    CHECK(cache.bytes == 0, "bytes %zu after clearing", cache.bytes);
+}
+
+// ============================================================================
+// Eviction
+// ============================================================================
+
+static void test_eviction(void)
+{
+    proxy_cache_t cache;
+    char path[16];
+
+    // By entries, across the millisecond wrap
+    cluster_proxy_cache_init(&cache, TTL_MS, MAX_BYTES);
+    uint32_t t0 = UINT32_MAX - 5;
+    for (int i = 0; i < CLUSTER_PROXY_CACHE_ENTRIES; i++) {
+        snprintf(path, sizeof(path), "/p%d", i);
+        cluster_proxy_cache_put(&cache, 0, path, "x", 1, t0 + i);
+    }
+    // Touch the first so the second is the oldest
+    CHECK(cached(&cache, 0, "/p0", t0 + 20, "x"), "first entry missed");
+    cluster_proxy_cache_put(&cache, 1, "/new", "y", 1, t0 + 21);
+    CHECK(cached(&cache, 0, "/p0", t0 + 22, "x"), "recently used entry evicted");
+    CHECK(!cached(&cache, 0, "/p1", t0 + 22, NULL), "least recently used entry kept");
+    CHECK(cached(&cache, 1, "/new", t0 + 22, "y"), "new entry missing");
+
+    // By bytes
+    cluster_proxy_cache_invalidate(&cache, -1);
+    cluster_proxy_cache_init(&cache, TTL_MS, 100);
+    char body[61];
+    memset(body, 'b', 60);
+    body[60] = '\0';
+    cluster_proxy_cache_put(&cache, 0, "/big", body, 40, 0);
+    cluster_proxy_cache_put(&cache, 1, "/big", body, 40, 1);
+    cluster_proxy_cache_put(&cache, 2, "/big", body, 40, 2);
+    CHECK(cache.bytes <= 100, "over budget: %zu bytes", cache.bytes);
+    CHECK(!cached(&cache, 0, "/big", 3, NULL), "oldest kept over the byte budget");
+    CHECK(cached(&cache, 2, "/big", 3, NULL), "newest missing");
+
+    // Not kept: over the whole budget, or a path that does not fit
+    cluster_proxy_cache_invalidate(&cache, -1);
+    cluster_proxy_cache_init(&cache, TTL_MS, 50);
+    CHECK(!cluster_proxy_cache_put(&cache, 3, "/huge", body, 60, 4), "body over the budget kept");
+    CHECK(!cluster_proxy_cache_put(&cache, 3, "/this/path/is/far/too/long/to/be/kept/in/the/cache/at/all",
+                                   "z", 1, 4), "long path kept");
+    CHECK(cache.bytes == 0, "refused entries counted (%zu bytes)", cache.bytes);
+
+    // Invalidation is per slave
+    cluster_proxy_cache_put(&cache, 0, "/a", "a", 1, 10);
+    cluster_proxy_cache_put(&cache, 1, "/a", "b", 1, 10);
+    cluster_proxy_cache_put(&cache, 1, "/b", "c", 1, 10);
+    cluster_proxy_cache_invalidate(&cache, 1);
+    CHECK(cached(&cache, 0, "/a", 11, "a"), "other slave's entry dropped");
+    CHECK(!cached(&cache, 1, "/a", 11, NULL) && !cached(&cache, 1, "/b", 11, NULL),
+          "invalidated slave still served");
+    CHECK(cache.bytes == 1, "bytes %zu after invalidation, expected 1", cache.bytes);
+    cluster_proxy_cache_invalidate(&cache, -1);
+}
+
+// ============================================================================
+// Dashboard load
+// ============================================================================
+
+static void test_dashboard(void)
+{
+    enum { SLAVES = 8, TABS = 4, SECONDS = 60 };
+    proxy_cache_t cache;
+    cluster_proxy_cache_init(&cache, TTL_MS, 32 * 1024);
+
+    char body[2500];
+    memset(body, '{', sizeof(body) - 1);
+    body[sizeof(body) - 1] = '\0';
+
+    int upstream = 0, served = 0;
+    for (int s = 0; s < SECONDS; s++) {
+        for (int tab = 0; tab < TABS; tab++) {
+            // Tabs poll at their own offsets within the second
+            uint32_t now_ms = s * 1000 + tab * 250;
+            for (int8_t slave = 0; slave < SLAVES; slave++) {
+                served++;
+                if (!cached(&cache, slave, "/api/system/info", now_ms, NULL)) {
+                    upstream++;
+                    cluster_proxy_cache_put(&cache, slave, "/api/system/info", body, sizeof(body) - 1, now_ms);
+                }
+            }
+        }
+    }
+
+    int expected = SLAVES * SECONDS * 1000 / TTL_MS;
+    printf("proxy_cache: %d tabs x %d slaves for %d s: %d requests to slaves for %d served (%.1f%% hits)\n",
+           TABS, SLAVES, SECONDS, upstream, served, 100.0 * cache.hits / (cache.hits + cache.misses));
+    CHECK(upstream <= expected + SLAVES, "%d requests reached slaves, expected about %d", upstream, expected);
+    CHECK(cache.bytes <= 32 * 1024, "over budget: %zu bytes", cache.bytes);
+    cluster_proxy_cache_invalidate(&cache, -1);
+}
+
+int main(void)
+{
+    test_ttl();
+    test_eviction();
+    test_dashboard();
+
+    printf("proxy_cache: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,752 @@
+/**
+ * @file relay_sim.c
+ * @brief In-process multi-node simulation of the relay topology
+ *
+ * Builds one master, a set of relays and a field of leaf slaves on Linux,
+ * all exchanging real cluster protocol messages (cluster_protocol.c) and
+ * driven by the real topology logic (cluster_topology.c). The radio is a
+ * per-pair reachability matrix with random frame loss.
+ *
+ * Checks:
+ *   - every leaf ends up under an uplink, no coordinator is over capacity,
+ *     relays only attach to the master
+ *   - leaves of a failed relay move to other coordinators
+ *   - every mining node gets a distinct (extranonce2, ntime) per job, and
+ *     keeps it when nodes roll ntime on their own during an uplink outage
+ *   - every encoded frame fits in one ESP-NOW payload (250 bytes)
+ *   - shares from behind a relay reach the master attributed to the
+ *     relay's slot with the child's ntime intact
+ *   - aggregated heartbeats add up to the whole cluster
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cluster.h"
+#include "cluster_protocol.h"
+#include "cluster_topology.h"
+
+// ============================================================================
+// Scenario
+// ============================================================================
+
+#define SIM_MASTER_SLOTS        16
+#define SIM_RELAYS              8
+#define SIM_LEAVES              56
+#define SIM_RELAY_CHILDREN      8
+#define SIM_NODES               (1 + SIM_RELAYS + SIM_LEAVES)
+
+#define SIM_TICK_MS             50
+#define SIM_BEACON_MS           1000
+#define SIM_HEARTBEAT_MS        3000
+#define SIM_LEAF_BOOT_MS        4000        // Leaves power up after relays
+#define SIM_FAIL_AT_MS          60000       // One relay dies here
+#define SIM_END_MS              120000
+#define SIM_LOSS_PERCENT        10
+#define SIM_JOBS                20
+
+#define ESPNOW_MAX_PAYLOAD      250
+
+enum { SIM_MASTER, SIM_RELAY, SIM_LEAF };
+
+typedef struct {
+    int         kind;
+    bool        alive;
+    int64_t     boot_ms;
+    bool        reach[SIM_NODES];       // Radio range (symmetric)
+
+    // As a member
+    cluster_uplink_t uplink_state;
+    int         uplink;                 // Node index of uplink, -1 if none
+    bool        registered;
+    uint16_t    addr;
+    int64_t     next_hb_ms;
+
+    // As a coordinator
+    int         capacity;
+    int         members[SIM_MASTER_SLOTS];
+    int64_t     member_seen[SIM_MASTER_SLOTS];
+    int64_t     next_beacon_ms;
+
+    // Heartbeat payload (this node only)
+    uint32_t    hashrate;
+    float       temp;
+    float       power;
+} sim_node_t;
+
+static sim_node_t g_nodes[SIM_NODES];
+static int64_t g_now_ms;
+static int g_failures;
+static size_t g_max_frame;
+
+// ============================================================================
+// Shim support
+// ============================================================================
+
+int64_t esp_timer_get_time(void)
+{
+    return g_now_ms * 1000;
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    return code == ESP_OK ? "ESP_OK" : "ESP_ERR";
+}
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static uint32_t g_rng = 0x12345678;
+
+static uint32_t sim_rand(void)
+{
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return g_rng >> 8;
+}
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+static bool radio_delivers(int from, int to)
+{
+    return g_nodes[from].alive && g_nodes[to].alive &&
+           g_nodes[from].reach[to] &&
+           (int)(sim_rand() % 100) >= SIM_LOSS_PERCENT;
+}
+
+static void note_frame(const char *frame, int len)
+{
+    CHECK(len > 0, "encode failed for frame");
+    if (len > 0 && (size_t)len > g_max_frame) {
+        g_max_frame = len;
+    }
+    CHECK(len <= ESPNOW_MAX_PAYLOAD, "frame of %d bytes exceeds ESP-NOW payload: %.40s", len, frame);
+}
+
+static const char *payload_of(const char *frame, char type[6])
+{
+    const char *payload = NULL;
+    if (cluster_protocol_parse_message(frame, type, &payload) != ESP_OK) {
+        return NULL;
+    }
+    return payload;
+}
+
+static bool is_coordinator_up(int n)
+{
+    sim_node_t *node = &g_nodes[n];
+    if (!node->alive || g_now_ms < node->boot_ms) {
+        return false;
+    }
+    // Relays advertise only once they hold a master slot
+    return node->kind == SIM_MASTER || (node->kind == SIM_RELAY && node->registered);
+}
+
+static int free_slots(int n)
+{
+    int free = 0;
+    for (int i = 0; i < g_nodes[n].capacity; i++) {
+        if (g_nodes[n].members[i] < 0) {
+            free++;
+        }
+    }
+    return free;
+}
+
+static uint16_t member_addr(int coord, int index)
+{
+    return g_nodes[coord].kind == SIM_MASTER
+           ? (uint16_t)index
+           : CLUSTER_NODE_ADDR(g_nodes[coord].addr, index);
+}
+
+// ============================================================================
+// Membership
+// ============================================================================
+
+static void coordinator_admit(int coord, int node)
+{
+    sim_node_t *c = &g_nodes[coord];
+    int index = -1;
+
+    for (int i = 0; i < c->capacity; i++) {
+        if (c->members[i] == node) {
+            index = i;
+            break;
+        }
+    }
+    for (int i = 0; index < 0 && i < c->capacity; i++) {
+        if (c->members[i] < 0) {
+            index = i;
+        }
+    }
+    if (index < 0) {
+        return;                         // Full: no ACK, node moves on after timeout
+    }
+
+    c->members[index] = node;
+    c->member_seen[index] = g_now_ms;
+
+    char ack[64];
+    int len = cluster_protocol_encode_ack(member_addr(coord, index), "sim", ack, sizeof(ack));
+    note_frame(ack, len);
+
+    if (!radio_delivers(coord, node)) {
+        return;
+    }
+
+    char type[6];
+    const char *payload = payload_of(ack, type);
+    uint16_t assigned = CLUSTER_NODE_ADDR_INVALID;
+    char status[32];
+    if (payload && cluster_protocol_decode_ack(payload, &assigned, status, sizeof(status)) == ESP_OK) {
+        sim_node_t *n = &g_nodes[node];
+        n->addr = assigned;
+        n->registered = true;
+        n->uplink_state.acked = true;
+        n->next_hb_ms = g_now_ms + SIM_HEARTBEAT_MS;
+    }
+}
+
+static void deliver_beacon(int coord, int node)
+{
+    char beacon[32];
+    int len = cluster_topology_encode_beacon(g_nodes[coord].kind == SIM_RELAY,
+                                             (uint8_t)free_slots(coord),
+                                             beacon, sizeof(beacon));
+    cluster_beacon_t parsed;
+    if (len < 0 || !cluster_topology_parse_beacon((const uint8_t *)beacon, len, &parsed)) {
+        CHECK(false, "beacon round trip failed");
+        return;
+    }
+
+    sim_node_t *n = &g_nodes[node];
+    bool from_uplink = n->uplink_state.joined && n->uplink == coord;
+
+    if (!cluster_topology_should_join(&n->uplink_state, &parsed, from_uplink,
+                                      n->kind == SIM_RELAY, g_now_ms)) {
+        return;
+    }
+
+    // REGISTER is unicast; a lost frame just means we try again next beacon
+    if (!radio_delivers(node, coord)) {
+        return;
+    }
+
+    if (n->uplink != coord) {
+        n->registered = false;
+        n->addr = CLUSTER_NODE_ADDR_INVALID;
+    }
+    n->uplink = coord;
+    cluster_topology_on_join(&n->uplink_state, parsed.is_relay, g_now_ms);
+    coordinator_admit(coord, node);
+}
+
+static void send_heartbeat(int node)
+{
+    sim_node_t *n = &g_nodes[node];
+    int coord = n->uplink;
+
+    cluster_heartbeat_data_t hb = {
+        .slave_id = n->addr,
+        .hashrate = n->hashrate,
+        .temp = n->temp,
+        .power = n->power,
+    };
+
+    char frame[160];
+    int len = cluster_protocol_encode_heartbeat_ex(&hb, frame, sizeof(frame));
+    note_frame(frame, len);
+
+    if (coord < 0 || !radio_delivers(node, coord)) {
+        return;
+    }
+
+    char type[6];
+    const char *payload = payload_of(frame, type);
+    cluster_heartbeat_data_t rx;
+    if (!payload || cluster_protocol_decode_heartbeat_ex(payload, &rx) != ESP_OK) {
+        CHECK(false, "heartbeat decode failed");
+        return;
+    }
+
+    sim_node_t *c = &g_nodes[coord];
+    int index = c->kind == SIM_MASTER ? rx.slave_id : CLUSTER_NODE_LOCAL(rx.slave_id);
+    if (index >= c->capacity) {
+        return;
+    }
+
+    // Expired but still following our beacons: recover (master and relay both do)
+    if (c->members[index] < 0) {
+        c->members[index] = node;
+    }
+    if (c->members[index] == node) {
+        c->member_seen[index] = g_now_ms;
+    }
+}
+
+static void expire_members(int coord)
+{
+    sim_node_t *c = &g_nodes[coord];
+    for (int i = 0; i < c->capacity; i++) {
+        if (c->members[i] >= 0 && (g_now_ms - c->member_seen[i]) > CLUSTER_TIMEOUT_MS) {
+            c->members[i] = -1;
+        }
+    }
+}
+
+static void run_until(int64_t end_ms)
+{
+    for (; g_now_ms < end_ms; g_now_ms += SIM_TICK_MS) {
+        for (int c = 0; c < SIM_NODES; c++) {
+            if (!is_coordinator_up(c)) {
+                continue;
+            }
+            expire_members(c);
+            if (g_now_ms >= g_nodes[c].next_beacon_ms) {
+                g_nodes[c].next_beacon_ms = g_now_ms + SIM_BEACON_MS + sim_rand() % 200;
+                for (int n = 1; n < SIM_NODES; n++) {
+                    if (n != c && g_now_ms >= g_nodes[n].boot_ms && radio_delivers(c, n)) {
+                        deliver_beacon(c, n);
+                    }
+                }
+            }
+        }
+
+        for (int n = 1; n < SIM_NODES; n++) {
+            sim_node_t *node = &g_nodes[n];
+            if (node->alive && node->registered && g_now_ms >= node->next_hb_ms) {
+                node->next_hb_ms = g_now_ms + SIM_HEARTBEAT_MS;
+                send_heartbeat(n);
+            }
+        }
+    }
+}
+
+// ============================================================================
+// Membership checks
+// ============================================================================
+
+static int member_index(int coord, int node)
+{
+    for (int i = 0; i < g_nodes[coord].capacity; i++) {
+        if (g_nodes[coord].members[i] == node) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Count attached nodes. A node that is not attached is "stranded" if every
+ * coordinator it can hear is full - a capacity limit, not a policy failure.
+ */
+static int count_attached(int *stranded)
+{
+    int attached = 0;
+    *stranded = 0;
+
+    for (int n = 1; n < SIM_NODES; n++) {
+        sim_node_t *node = &g_nodes[n];
+        if (!node->alive) {
+            continue;
+        }
+        if (node->kind == SIM_RELAY && node->uplink >= 0) {
+            CHECK(g_nodes[node->uplink].kind == SIM_MASTER, "relay %d attached to a relay", n);
+        }
+
+        if (node->registered && node->uplink >= 0 &&
+            g_nodes[node->uplink].alive && member_index(node->uplink, n) >= 0) {
+            attached++;
+            continue;
+        }
+
+        bool has_room = false;
+        for (int c = 0; c < SIM_NODES; c++) {
+            if (node->reach[c] && is_coordinator_up(c) && free_slots(c) > 0 &&
+                !(node->kind == SIM_RELAY && g_nodes[c].kind == SIM_RELAY)) {
+                has_room = true;
+            }
+        }
+        if (has_room) {
+            printf("  node %d unattached although an uplink in range has room\n", n);
+        } else {
+            (*stranded)++;
+        }
+    }
+    return attached;
+}
+
+static int count_alive(void)
+{
+    int alive = 0;
+    for (int n = 1; n < SIM_NODES; n++) {
+        alive += g_nodes[n].alive;
+    }
+    return alive;
+}
+
+// ============================================================================
+// Work, shares and heartbeats through the tree
+// ============================================================================
+
+typedef struct {
+    int         node;
+    uint8_t     en2[8];
+    uint32_t    ntime;
+} sim_assignment_t;
+
+static int run_job(uint32_t job_id, int *master_msgs, int *relay_msgs)
+{
+    sim_assignment_t assigned[SIM_NODES];
+    int n_assigned = 0;
+    sim_node_t *master = &g_nodes[0];
+    const uint32_t base_ntime = 0x66000000u + job_id * 30;
+
+    for (int slot = 0; slot < master->capacity; slot++) {
+        int node = master->members[slot];
+        if (node < 0 || !g_nodes[node].alive) {
+            continue;
+        }
+
+        // What the master builds for one slot: its own extranonce2
+        cluster_work_t work = {0};
+        work.target_slave_id = slot;
+        work.job_id = job_id;
+        work.version = 0x20000000;
+        work.version_mask = 0x1fffe000;
+        work.nbits = 0x17034219;
+        work.ntime = base_ntime;
+        work.nonce_start = 0;
+        work.nonce_end = 0xFFFFFFFF;
+        work.extranonce2_len = 8;
+        work.extranonce2[7] = (uint8_t)slot;
+        work.pool_diff = 65536;
+        work.block_height = 880000;
+        snprintf(work.scriptsig, sizeof(work.scriptsig), "ClusterAxe-sim-pool");
+        snprintf(work.network_diff_str, sizeof(work.network_diff_str), "110.45T");
+        memset(work.prev_block_hash, 0xAB, sizeof(work.prev_block_hash));
+        memset(work.merkle_root, 0xCD, sizeof(work.merkle_root));
+
+        char frame[300];
+        int len = cluster_protocol_encode_work(&work, frame, sizeof(frame));
+        note_frame(frame, len);
+        (*master_msgs)++;
+
+        char type[6];
+        cluster_work_t rx;
+        const char *payload = payload_of(frame, type);
+        if (!payload || cluster_protocol_decode_work(payload, &rx) != ESP_OK) {
+            CHECK(false, "work decode failed for slot %d", slot);
+            continue;
+        }
+
+        assigned[n_assigned].node = node;
+        memcpy(assigned[n_assigned].en2, rx.extranonce2, 8);
+        assigned[n_assigned].ntime = rx.ntime;
+        n_assigned++;
+
+        if (g_nodes[node].kind != SIM_RELAY) {
+            continue;
+        }
+
+        for (int i = 0; i < g_nodes[node].capacity; i++) {
+            int child = g_nodes[node].members[i];
+            if (child < 0 || !g_nodes[child].alive) {
+                continue;
+            }
+
+            cluster_work_t child_work, child_rx;
+            cluster_topology_derive_child_work(&rx, member_addr(node, i), &child_work);
+
+            len = cluster_protocol_encode_work(&child_work, frame, sizeof(frame));
+            note_frame(frame, len);
+            (*relay_msgs)++;
+
+            payload = payload_of(frame, type);
+            if (!payload || cluster_protocol_decode_work(payload, &child_rx) != ESP_OK) {
+                CHECK(false, "child work decode failed");
+                continue;
+            }
+            CHECK(child_rx.target_slave_id == g_nodes[child].addr,
+                  "child %d got work for 0x%04X, holds 0x%04X",
+                  child, child_rx.target_slave_id, g_nodes[child].addr);
+
+            assigned[n_assigned].node = child;
+            memcpy(assigned[n_assigned].en2, child_rx.extranonce2, 8);
+            assigned[n_assigned].ntime = child_rx.ntime;
+            n_assigned++;
+        }
+    }
+
+    // No two nodes may hash the same header space
+    for (int a = 0; a < n_assigned; a++) {
+        for (int b = a + 1; b < n_assigned; b++) {
+            CHECK(assigned[a].ntime != assigned[b].ntime ||
+                  memcmp(assigned[a].en2, assigned[b].en2, 8) != 0,
+                  "nodes %d and %d share (en2, ntime)", assigned[a].node, assigned[b].node);
+        }
+    }
+
+    // Nodes that lose their uplink roll ntime independently, at different
+    // times; rolled headers must still not meet
+    static const int64_t ages_ms[] = { 0, 8999, 9000, 31000, 61000, 120000 };
+    const int n_ages = sizeof(ages_ms) / sizeof(ages_ms[0]);
+    for (int a = 0; a < n_assigned; a++) {
+        for (int b = a + 1; b < n_assigned; b++) {
+            if (memcmp(assigned[a].en2, assigned[b].en2, 8) != 0) {
+                continue;
+            }
+            for (int i = 0; i < n_ages; i++) {
+                for (int j = 0; j < n_ages; j++) {
+                    uint32_t ta = cluster_topology_autonomous_ntime(assigned[a].ntime, ages_ms[i]);
+                    uint32_t tb = cluster_topology_autonomous_ntime(assigned[b].ntime, ages_ms[j]);
+                    CHECK(ta != tb, "nodes %d and %d meet at rolled ntime %lu",
+                          assigned[a].node, assigned[b].node, (unsigned long)ta);
+                }
+            }
+        }
+    }
+
+    // One share per node, routed upstream
+    for (int a = 0; a < n_assigned; a++) {
+        sim_node_t *node = &g_nodes[assigned[a].node];
+        cluster_share_t share = {
+            .job_id = job_id,
+            .nonce = sim_rand(),
+            .extranonce2_len = 8,
+            .ntime = assigned[a].ntime,
+            .version = 0x20000000,
+            .slave_id = node->addr,
+        };
+        memcpy(share.extranonce2, assigned[a].en2, 8);
+
+        char frame[160];
+        char type[6];
+        int len = cluster_protocol_encode_share(&share, frame, sizeof(frame));
+        note_frame(frame, len);
+
+        cluster_share_t rx;
+        const char *payload = payload_of(frame, type);
+        if (!payload || cluster_protocol_decode_share(payload, &rx) != ESP_OK) {
+            CHECK(false, "share decode failed");
+            continue;
+        }
+
+        int expected_slot = node->addr;
+        if (CLUSTER_NODE_IS_DOWNSTREAM(node->addr)) {
+            // Relay forwards the share unchanged
+            sim_node_t *relay = &g_nodes[node->uplink];
+            CHECK(CLUSTER_NODE_SLOT(rx.slave_id) == relay->addr,
+                  "relay 0x%04X would not own share from 0x%04X", relay->addr, rx.slave_id);
+            len = cluster_protocol_encode_share(&rx, frame, sizeof(frame));
+            note_frame(frame, len);
+            payload = payload_of(frame, type);
+            if (!payload || cluster_protocol_decode_share(payload, &rx) != ESP_OK) {
+                CHECK(false, "forwarded share decode failed");
+                continue;
+            }
+            expected_slot = relay->addr;
+        }
+
+        CHECK(CLUSTER_NODE_SLOT(rx.slave_id) == expected_slot,
+              "share from 0x%04X credited to slot %d, expected %d",
+              node->addr, CLUSTER_NODE_SLOT(rx.slave_id), expected_slot);
+        CHECK(rx.ntime == assigned[a].ntime && memcmp(rx.extranonce2, assigned[a].en2, 8) == 0,
+              "share from 0x%04X lost its header fields", node->addr);
+    }
+
+    return n_assigned;
+}
+
+static void check_heartbeats(void)
+{
+    sim_node_t *master = &g_nodes[0];
+    uint64_t expected_hashrate = 0;
+    uint64_t seen_hashrate = 0;
+    int expected_nodes = 0;
+    int seen_nodes = 0;
+
+    for (int slot = 0; slot < master->capacity; slot++) {
+        int node = master->members[slot];
+        if (node < 0 || !g_nodes[node].alive) {
+            continue;
+        }
+        sim_node_t *n = &g_nodes[node];
+
+        cluster_heartbeat_data_t hb = {
+            .slave_id = n->addr, .hashrate = n->hashrate, .temp = n->temp, .power = n->power,
+        };
+        expected_hashrate += n->hashrate;
+        expected_nodes++;
+
+        if (n->kind == SIM_RELAY) {
+            for (int i = 0; i < n->capacity; i++) {
+                int child = n->members[i];
+                if (child < 0 || !g_nodes[child].alive) {
+                    continue;
+                }
+                sim_node_t *c = &g_nodes[child];
+                cluster_heartbeat_data_t chb = {
+                    .slave_id = c->addr, .hashrate = c->hashrate, .temp = c->temp, .power = c->power,
+                };
+                char frame[160], type[6];
+                int len = cluster_protocol_encode_heartbeat_ex(&chb, frame, sizeof(frame));
+                note_frame(frame, len);
+                cluster_heartbeat_data_t rx;
+                const char *payload = payload_of(frame, type);
+                if (payload && cluster_protocol_decode_heartbeat_ex(payload, &rx) == ESP_OK) {
+                    cluster_topology_aggregate_heartbeat(&hb, &rx);
+                }
+                expected_hashrate += c->hashrate;
+                expected_nodes++;
+            }
+        }
+
+        char frame[160], type[6];
+        int len = cluster_protocol_encode_heartbeat_ex(&hb, frame, sizeof(frame));
+        note_frame(frame, len);
+        cluster_heartbeat_data_t rx;
+        const char *payload = payload_of(frame, type);
+        if (!payload || cluster_protocol_decode_heartbeat_ex(payload, &rx) != ESP_OK) {
+            CHECK(false, "heartbeat decode failed at master");
+            continue;
+        }
+        seen_hashrate += rx.hashrate;
+        seen_nodes += 1 + rx.nodes;
+    }
+
+    CHECK(seen_hashrate == expected_hashrate, "aggregated hashrate %llu != %llu",
+          (unsigned long long)seen_hashrate, (unsigned long long)expected_hashrate);
+    CHECK(seen_nodes == expected_nodes, "aggregated node count %d != %d", seen_nodes, expected_nodes);
+    printf("  heartbeats: %d nodes, %.2f TH/s reported through %d master slots\n",
+           seen_nodes, seen_hashrate / 100.0 / 1000.0, SIM_MASTER_SLOTS - free_slots(0));
+}
+
+// ============================================================================
+// Setup
+// ============================================================================
+
+static void link_nodes(int a, int b)
+{
+    g_nodes[a].reach[b] = true;
+    g_nodes[b].reach[a] = true;
+}
+
+static void setup(void)
+{
+    memset(g_nodes, 0, sizeof(g_nodes));
+
+    for (int n = 0; n < SIM_NODES; n++) {
+        sim_node_t *node = &g_nodes[n];
+        node->kind = n == 0 ? SIM_MASTER : (n <= SIM_RELAYS ? SIM_RELAY : SIM_LEAF);
+        node->alive = true;
+        node->uplink = -1;
+        node->addr = CLUSTER_NODE_ADDR_INVALID;
+        node->capacity = node->kind == SIM_MASTER ? SIM_MASTER_SLOTS
+                       : node->kind == SIM_RELAY ? SIM_RELAY_CHILDREN : 0;
+        for (int i = 0; i < SIM_MASTER_SLOTS; i++) {
+            node->members[i] = -1;
+        }
+        node->boot_ms = node->kind == SIM_LEAF ? SIM_LEAF_BOOT_MS + sim_rand() % 3000 : 0;
+        node->next_beacon_ms = sim_rand() % SIM_BEACON_MS;
+        node->hashrate = 90000 + sim_rand() % 30000;    // 0.9-1.2 TH/s
+        node->temp = 50.0f + (sim_rand() % 200) / 10.0f;
+        node->power = 15.0f + (sim_rand() % 50) / 10.0f;
+    }
+
+    // Relays are placed within range of the master; leaves are spread
+    // around the rack: about a quarter hear the master directly, every
+    // leaf hears three relays.
+    for (int r = 1; r <= SIM_RELAYS; r++) {
+        link_nodes(0, r);
+    }
+    for (int n = SIM_RELAYS + 1; n < SIM_NODES; n++) {
+        if (sim_rand() % 4 == 0) {
+            link_nodes(0, n);
+        }
+        int first = 1 + (n % SIM_RELAYS);
+        for (int k = 0; k < 3; k++) {
+            link_nodes(n, 1 + ((first - 1 + k) % SIM_RELAYS));
+        }
+    }
+}
+
+int main(void)
+{
+    setup();
+
+    printf("relay_sim: 1 master (%d slots), %d relays (%d children), %d leaves, %d%% frame loss\n",
+           SIM_MASTER_SLOTS, SIM_RELAYS, SIM_RELAY_CHILDREN, SIM_LEAVES, SIM_LOSS_PERCENT);
+
+    // Phase 1: formation
+    run_until(SIM_FAIL_AT_MS);
+    int stranded;
+    int attached = count_attached(&stranded);
+    printf("  formation: %d/%d nodes attached at t=%llds (master slots used %d)\n",
+           attached, count_alive(), (long long)(g_now_ms / 1000), SIM_MASTER_SLOTS - free_slots(0));
+    CHECK(attached == count_alive(), "not every node attached after formation");
+
+    for (int c = 0; c < SIM_NODES; c++) {
+        if (g_nodes[c].capacity) {
+            CHECK(free_slots(c) >= 0, "coordinator %d over capacity", c);
+        }
+    }
+
+    // Phase 2: work / share / heartbeat flow
+    int master_msgs = 0, relay_msgs = 0, mining = 0;
+    for (uint32_t job = 1; job <= SIM_JOBS; job++) {
+        mining = run_job(job, &master_msgs, &relay_msgs);
+    }
+    check_heartbeats();
+    printf("  work: %d mining nodes per job, master sends %.1f msgs/job (flat would be %d), "
+           "relays send %.1f msgs/job total\n",
+           mining, (double)master_msgs / SIM_JOBS, mining, (double)relay_msgs / SIM_JOBS);
+    printf("  largest frame: %zu bytes (limit %d)\n", g_max_frame, ESPNOW_MAX_PAYLOAD);
+    CHECK(mining == count_alive(), "only %d of %d nodes received work", mining, count_alive());
+
+    // Phase 3: the busiest relay fails; its children must re-home
+    int victim = 1;
+    int orphans = 0;
+    for (int r = 1; r <= SIM_RELAYS; r++) {
+        int children = g_nodes[r].capacity - free_slots(r);
+        if (children > orphans) {
+            orphans = children;
+            victim = r;
+        }
+    }
+    g_nodes[victim].alive = false;
+    run_until(SIM_END_MS);
+
+    attached = count_attached(&stranded);
+    printf("  failover: relay %d lost with %d children, %d/%d nodes attached at t=%llds "
+           "(%d stranded: every uplink in range full)\n",
+           victim, orphans, attached, count_alive(), (long long)(g_now_ms / 1000), stranded);
+    CHECK(attached + stranded == count_alive(), "children of failed relay not re-homed");
+
+    mining = run_job(SIM_JOBS + 1, &master_msgs, &relay_msgs);
+    CHECK(mining == attached, "only %d of %d attached nodes received work after failover",
+          mining, attached);
+    check_heartbeats();
+
+    if (g_failures) {
+        printf("relay_sim: %d check(s) FAILED\n", g_failures);
+        return 1;
+    }
+    printf("relay_sim: all checks passed\n");
+    return 0;
+}
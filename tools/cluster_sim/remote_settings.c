@@ -0,0 +1,287 @@
+/**
+ * @file remote_settings.c
+ * @brief Remote settings wire format, validation and ramp checks
+ *
+ * Checks:
+ *   - every value type packs and unpacks unchanged; truncated or unknown
+ *     records and more values than fit are refused
+ *   - a batch is refused whole at its first unknown, read-only, mistyped,
+ *     out-of-range or repeated setting, with that setting's index
+ *   - ramps raise voltage before frequency and lower it after, move one
+ *     step at a time and end on the target; any two points in range fit
+ *   - $CLGET, $CLSET and $CLSTR round-trip, and the largest batch fits an
+ *     ESP-NOW frame
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cluster.h"
+#include "cluster_protocol.h"
+#include "cluster_settings.h"
+#include "esp_timer.h"
+
+#define ESPNOW_FRAME    250
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+int64_t esp_timer_get_time(void)
+{
+    return 0;
+}
+
+static cluster_setting_value_t u32_value(uint8_t id, uint32_t v)
+{
+    cluster_setting_value_t value;
+    memset(&value, 0, sizeof(value));
+    value.setting_id = id;
+    value.data_type = CLUSTER_SETTING_TYPE_U32;
+    value.value.u32 = v;
+    return value;
+}
+
+// ============================================================================
+// Wire format
+// ============================================================================
+
+static void test_pack(void)
+{
+    cluster_setting_value_t in[6], out[6];
+    memset(in, 0, sizeof(in));
+    in[0] = u32_value(CLUSTER_SETTING_FREQUENCY, 575);
+    in[1].setting_id = CLUSTER_SETTING_RSSI;
+    in[1].data_type = CLUSTER_SETTING_TYPE_I32;
+    in[1].value.i32 = -67;
+    in[2].setting_id = CLUSTER_SETTING_CHIP_TEMP;
+    in[2].data_type = CLUSTER_SETTING_TYPE_FLOAT;
+    in[2].value.f32 = 58.25f;
+    in[3].setting_id = 0x7E;
+    in[3].data_type = CLUSTER_SETTING_TYPE_BOOL;
+    in[3].value.b = true;
+    in[4].setting_id = CLUSTER_SETTING_HOSTNAME;
+    in[4].data_type = CLUSTER_SETTING_TYPE_STRING;
+    strcpy(in[4].value.str, "bitaxe-7");
+    in[5].setting_id = CLUSTER_SETTING_FW_VERSION;
+    in[5].data_type = CLUSTER_SETTING_TYPE_NONE;
+
+    uint8_t buf[CLUSTER_SETTINGS_WIRE_MAX];
+    int len = cluster_settings_pack(in, 6, buf, sizeof(buf));
+    CHECK(len == 6 + 6 + 6 + 3 + 3 + 8 + 2, "packed %d bytes", len);
+
+    int count = cluster_settings_unpack(buf, len, out, 6);
+    CHECK(count == 6, "unpacked %d values", count);
+    CHECK(out[0].value.u32 == 575, "u32 %u", (unsigned)out[0].value.u32);
+    CHECK(out[1].value.i32 == -67, "i32 %d", (int)out[1].value.i32);
+    CHECK(out[2].value.f32 == 58.25f, "float %f", out[2].value.f32);
+    CHECK(out[3].value.b, "bool");
+    CHECK(strcmp(out[4].value.str, "bitaxe-7") == 0, "string '%s'", out[4].value.str);
+    CHECK(out[5].data_type == CLUSTER_SETTING_TYPE_NONE && out[5].setting_id == CLUSTER_SETTING_FW_VERSION,
+          "empty record");
+
+    // Every prefix that splits a record is refused
+    int boundaries[] = {6, 12, 18, 21, 32};
+    for (int cut = 1; cut < len; cut++) {
+        bool boundary = false;
+        for (size_t b = 0; b < sizeof(boundaries) / sizeof(boundaries[0]); b++) {
+            boundary |= boundaries[b] == cut;
+        }
+        int n = cluster_settings_unpack(buf, cut, out, 6);
+        CHECK(boundary ? n >= 0 : n == -1, "cut at %d unpacked %d", cut, n);
+    }
+
+    CHECK(cluster_settings_unpack(buf, len, out, 5) == -1, "more values than room accepted");
+    CHECK(cluster_settings_pack(in, 6, buf, len - 1) == -1, "packed into a short buffer");
+
+    buf[1] = 9;
+    CHECK(cluster_settings_unpack(buf, len, out, 6) == -1, "unknown type accepted");
+
+    memset(in[4].value.str, 'x', CLUSTER_SETTINGS_STR_MAX + 1);
+    in[4].value.str[CLUSTER_SETTINGS_STR_MAX + 1] = '\0';
+    CHECK(cluster_settings_pack(&in[4], 1, buf, sizeof(buf)) == -1, "over-long string packed");
+}
+
+// ============================================================================
+// Validation
+// ============================================================================
+
+static void test_validate(void)
+{
+    cluster_setting_value_t batch[4];
+    int bad = 0;
+
+    batch[0] = u32_value(CLUSTER_SETTING_FREQUENCY, 600);
+    batch[1] = u32_value(CLUSTER_SETTING_CORE_VOLTAGE, 1200);
+    batch[2] = u32_value(CLUSTER_SETTING_FAN_MODE, 1);
+    batch[3] = u32_value(CLUSTER_SETTING_FAN_SPEED, 80);
+    CHECK(cluster_settings_validate(batch, 4, &bad) == CLUSTER_RESP_OK && bad == -1,
+          "good batch refused at %d", bad);
+
+    struct {
+        cluster_setting_value_t     value;
+        cluster_response_status_t   expect;
+    } cases[] = {
+        { u32_value(0x99, 1),                            CLUSTER_RESP_INVALID_SETTING },
+        { u32_value(CLUSTER_SETTING_HASHRATE, 1),        CLUSTER_RESP_READ_ONLY },
+        { u32_value(CLUSTER_SETTING_FREQUENCY, 1500),    CLUSTER_RESP_INVALID_VALUE },
+        { u32_value(CLUSTER_SETTING_CORE_VOLTAGE, 700),  CLUSTER_RESP_INVALID_VALUE },
+        { u32_value(CLUSTER_SETTING_TARGET_TEMP, 90),    CLUSTER_RESP_INVALID_VALUE },
+        { u32_value(CLUSTER_SETTING_FREQUENCY, 625),     CLUSTER_RESP_INVALID_VALUE },  // repeated
+    };
+    cases[0].value.data_type = CLUSTER_SETTING_TYPE_U32;
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        batch[2] = cases[i].value;
+        cluster_response_status_t status = cluster_settings_validate(batch, 3, &bad);
+        CHECK(status == cases[i].expect && bad == 2, "case %zu: status %d at %d", i, status, bad);
+    }
+
+    batch[0].data_type = CLUSTER_SETTING_TYPE_FLOAT;
+    CHECK(cluster_settings_validate(batch, 2, &bad) == CLUSTER_RESP_INVALID_VALUE && bad == 0,
+          "mistyped setting accepted");
+}
+
+// ============================================================================
+// Ramps
+// ============================================================================
+
+static void check_ramp(uint16_t f0, uint16_t v0, uint16_t f1, uint16_t v1)
+{
+    cluster_settings_ramp_step_t steps[CLUSTER_SETTINGS_RAMP_MAX];
+    int n = cluster_settings_plan_ramp(f0, v0, f1, v1, 25, 25, steps, CLUSTER_SETTINGS_RAMP_MAX);
+    CHECK(n >= 0, "%u/%u -> %u/%u did not fit", f0, v0, f1, v1);
+    if (n <= 0) {
+        CHECK(n == 0 && f0 == f1 && v0 == v1, "no steps for a move");
+        return;
+    }
+
+    uint16_t top = v0 > v1 ? v0 : v1;
+    uint16_t f = f0, v = v0;
+    for (int i = 0; i < n; i++) {
+        int df = abs((int)steps[i].freq_mhz - f);
+        int dv = abs((int)steps[i].voltage_mv - v);
+        CHECK((df == 0) != (dv == 0) && df <= 25 && dv <= 25,
+              "step %d: %u/%u -> %u/%u", i, f, v, steps[i].freq_mhz, steps[i].voltage_mv);
+        if (df) {
+            CHECK(v == top, "frequency moved at %u mV, below %u mV", v, top);
+        }
+        f = steps[i].freq_mhz;
+        v = steps[i].voltage_mv;
+    }
+    CHECK(f == f1 && v == v1, "ended at %u/%u, not %u/%u", f, v, f1, v1);
+}
+
+static void test_ramp(void)
+{
+    check_ramp(400, 1100, 600, 1200);   // Up
+    check_ramp(600, 1200, 400, 1100);   // Down
+    check_ramp(500, 1100, 700, 1000);   // Faster at lower voltage
+    check_ramp(490, 1166, 510, 1166);   // Less than a step
+    check_ramp(525, 1150, 525, 1150);   // Already there
+    check_ramp(100, 800, 1200, 1400);   // Whole range
+    check_ramp(1200, 800, 100, 1400);
+
+    cluster_settings_ramp_step_t steps[4];
+    CHECK(cluster_settings_plan_ramp(400, 1100, 600, 1200, 25, 25, steps, 4) == -1,
+          "ramp overflowed its steps");
+}
+
+// ============================================================================
+// Sentences
+// ============================================================================
+
+static const char *payload_of(const char *sentence, const char *expect_type)
+{
+    char type[6];
+    const char *payload = NULL;
+    CHECK(cluster_protocol_verify_checksum(sentence), "bad checksum: %s", sentence);
+    CHECK(cluster_protocol_parse_message(sentence, type, &payload) == ESP_OK &&
+          strcmp(type, expect_type) == 0, "sentence type wrong: %s", sentence);
+    return payload ? payload : "";
+}
+
+static void test_sentences(void)
+{
+    char sentence[512];
+    uint16_t node = 0, req = 0;
+
+    // $CLGET
+    uint8_t ids[] = {CLUSTER_SETTING_FREQUENCY, CLUSTER_SETTING_CORE_VOLTAGE, CLUSTER_SETTING_HOSTNAME};
+    int len = cluster_protocol_encode_setting_get(3, 0xBEEF, ids, sizeof(ids), sentence, sizeof(sentence));
+    CHECK(len > 0 && len <= ESPNOW_FRAME, "CLGET is %d bytes", len);
+    uint8_t ids_out[CLUSTER_REMOTE_MAX_BATCH];
+    size_t count = 0;
+    CHECK(cluster_protocol_decode_setting_get(payload_of(sentence, BAP_MSG_SETTING_GET), &node, &req, ids_out, sizeof(ids_out), &count) == ESP_OK &&
+          node == 3 && req == 0xBEEF && count == sizeof(ids) && memcmp(ids, ids_out, count) == 0,
+          "CLGET round trip");
+
+    // $CLSET with the largest batch: six strings of the longest length
+    cluster_setting_value_t batch[CLUSTER_REMOTE_MAX_BATCH];
+    memset(batch, 0, sizeof(batch));
+    for (int i = 0; i < CLUSTER_REMOTE_MAX_BATCH; i++) {
+        batch[i].setting_id = (uint8_t)i;
+        batch[i].data_type = CLUSTER_SETTING_TYPE_STRING;
+        memset(batch[i].value.str, 'a' + i, 18);
+    }
+    uint8_t records[CLUSTER_SETTINGS_WIRE_MAX];
+    int records_len = cluster_settings_pack(batch, CLUSTER_REMOTE_MAX_BATCH, records, sizeof(records));
+    CHECK(records_len > 0, "largest batch did not pack");
+    if (records_len <= 0) {
+        return;
+    }
+    len = cluster_protocol_encode_setting_set(63, 0xFFFF, CLUSTER_REMOTE_FLAG_RAMP, records, records_len,
+                                              sentence, sizeof(sentence));
+    CHECK(len > 0 && len <= ESPNOW_FRAME, "CLSET of %d record bytes is %d bytes", records_len, len);
+
+    uint8_t flags = 0;
+    uint8_t records_out[CLUSTER_SETTINGS_WIRE_MAX];
+    size_t records_out_len = 0;
+    CHECK(cluster_protocol_decode_setting_set(payload_of(sentence, BAP_MSG_SETTING_SET), &node, &req, &flags, records_out,
+                                              sizeof(records_out), &records_out_len) == ESP_OK &&
+          node == 63 && req == 0xFFFF && flags == CLUSTER_REMOTE_FLAG_RAMP &&
+          records_out_len == (size_t)records_len && memcmp(records, records_out, records_len) == 0,
+          "CLSET round trip");
+
+    // $CLSTR with the full wire budget, and with no records
+    memset(records, 0x5A, sizeof(records));
+    len = cluster_protocol_encode_setting_reply(7, 42, CLUSTER_RESP_INVALID_VALUE, 1, records,
+                                                CLUSTER_SETTINGS_WIRE_MAX, sentence, sizeof(sentence));
+    CHECK(len > 0 && len <= ESPNOW_FRAME, "CLSTR of %d record bytes is %d bytes", CLUSTER_SETTINGS_WIRE_MAX, len);
+
+    uint8_t status = 0, index = 0;
+    len = cluster_protocol_encode_setting_reply(7, 42, CLUSTER_RESP_BUSY, CLUSTER_REMOTE_NO_INDEX, NULL, 0,
+                                                sentence, sizeof(sentence));
+    records_out_len = 99;
+    CHECK(len > 0 && cluster_protocol_decode_setting_reply(payload_of(sentence, BAP_MSG_SETTING_RSP), &node, &req, &status, &index, records_out,
+                                                           sizeof(records_out), &records_out_len) == ESP_OK &&
+          node == 7 && req == 42 && status == CLUSTER_RESP_BUSY && index == CLUSTER_REMOTE_NO_INDEX &&
+          records_out_len == 0,
+          "empty CLSTR round trip");
+
+    printf("remote_settings: largest CLSET %d record bytes\n", records_len);
+}
+
+int main(void)
+{
+    test_pack();
+    test_validate();
+    test_ramp();
+    test_sentences();
+
+    printf("remote_settings: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
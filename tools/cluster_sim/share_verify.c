@@ -0,0 +1,337 @@
+/**
+ * @file share_verify.c
+ * @brief Master share verification checks and throughput bench
+ *
+ * Drives the work index (cluster_index.c) and the header re-hash
+ * (cluster_verify.c) the way the master's send and submit paths do.
+ *
+ * Checks, on Bitcoin block 1 (a real header with a known nonce):
+ *   - work sent in stratum byte order re-hashes to the block's difficulty
+ *   - shares below the pool difficulty, with a wrong nonce, or with
+ *     version bits outside the mask are caught
+ *   - share versions are the rolled bits only, as slaves send them: they
+ *     are XORed onto the job's version before hashing
+ *   - shares are only matched to their own (job, pool, extranonce2)
+ *
+ * Bench: 8 to 64 slaves with four jobs in flight each. Every slave's
+ * assignment is indexed, then shares from random slaves and jobs are
+ * looked up and re-hashed; reports shares/s and the index miss rate, and
+ * checks that the index only starts missing once assignments outnumber
+ * CLUSTER_WORK_INDEX_SIZE.
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cluster.h"
+#include "cluster_index.h"
+#include "cluster_verify.h"
+#include "sim.h"
+
+#define BENCH_JOBS          4           // Jobs in flight per slave
+#define BENCH_SHARES        200000
+#define BENCH_FIRST_JOB     0x1000
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+static uint32_t g_rng = 0x13579BDF;
+
+static uint32_t sim_rand(void)
+{
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return g_rng >> 8;
+}
+
+static void hex_to_bytes(const char *hex, uint8_t *bytes, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        unsigned int byte;
+        sscanf(hex + i * 2, "%2x", &byte);
+        bytes[i] = (uint8_t)byte;
+    }
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// ============================================================================
+// Known header
+// ============================================================================
+
+// Block 1: hash 00000000839a8e6886ab5951d76f411475428afc90947ee320161bbf18eb6048
+#define BLOCK1_PREV     "6fe28c0ab6f1b372c1a6a246ae63f74f931e8365e15a089c68d6190000000000"
+#define BLOCK1_MERKLE   "982051fd1e4ba744bbbe680e1fee14677ba1a3c3540bf7b1cdb606e857233e0e"
+#define BLOCK1_NTIME    1231469665u
+#define BLOCK1_NBITS    0x1d00ffffu
+#define BLOCK1_NONCE    2573394689u
+#define BLOCK1_DIFF     1.945       // 0xffff / 0x839a
+
+static void block1_work(cluster_work_t *work, uint32_t pool_diff)
+{
+    memset(work, 0, sizeof(*work));
+    work->job_id = BENCH_FIRST_JOB;
+    work->pool_id = 0;
+    work->version = 1;
+    work->version_mask = 0x1fffe000;
+    work->nbits = BLOCK1_NBITS;
+    work->ntime = BLOCK1_NTIME;
+    work->pool_diff = pool_diff;
+    work->extranonce2_len = 4;
+    work->extranonce2[0] = 0x01;
+    work->extranonce2[3] = 0x2A;
+
+    // Header byte order above; the master holds it as stratum sends it
+    uint8_t prev[32];
+    hex_to_bytes(BLOCK1_PREV, prev, 32);
+    for (int i = 0; i < 32; i += 4) {
+        for (int b = 0; b < 4; b++) {
+            work->prev_block_hash[i + b] = prev[i + 3 - b];
+        }
+    }
+    hex_to_bytes(BLOCK1_MERKLE, work->merkle_root, 32);
+}
+
+static void block1_share(const cluster_work_t *work, cluster_share_t *share)
+{
+    memset(share, 0, sizeof(*share));
+    share->job_id = work->job_id;
+    share->pool_id = work->pool_id;
+    share->nonce = BLOCK1_NONCE;
+    share->ntime = BLOCK1_NTIME;
+    share->version = 0;
+    share->extranonce2_len = work->extranonce2_len;
+    memcpy(share->extranonce2, work->extranonce2, work->extranonce2_len);
+}
+
+static cluster_verify_result_t lookup_and_verify(const cluster_share_t *share, double *diff,
+                                                 bool *found)
+{
+    cluster_work_header_t header;
+    *found = cluster_work_index_get(share->job_id, share->pool_id, share->extranonce2,
+                                    share->extranonce2_len, &header);
+    return *found ? cluster_verify_share(&header, share, diff) : CLUSTER_VERIFY_OK;
+}
+
+static void check_known_header(void)
+{
+    cluster_work_t work;
+    cluster_work_header_t header;
+    cluster_share_t share;
+    double diff = 0;
+    bool found = false;
+
+    cluster_index_init();
+
+    block1_work(&work, 1);
+    cluster_verify_header_from_work(&work, &header);
+    cluster_work_index_put(&header);
+    block1_share(&work, &share);
+
+    cluster_verify_result_t result = lookup_and_verify(&share, &diff, &found);
+    CHECK(found, "block 1 assignment not found");
+    CHECK(result == CLUSTER_VERIFY_OK, "block 1 share: %s", cluster_verify_result_name(result));
+    CHECK(diff > BLOCK1_DIFF - 0.01 && diff < BLOCK1_DIFF + 0.01,
+          "block 1 difficulty %.4f, expected %.3f", diff, BLOCK1_DIFF);
+    printf("  block 1: difficulty %.4f\n", diff);
+
+    // Same header against a pool difficulty it does not reach
+    block1_work(&work, 2);
+    cluster_verify_header_from_work(&work, &header);
+    cluster_work_index_put(&header);
+    result = lookup_and_verify(&share, &diff, &found);
+    CHECK(found && result == CLUSTER_VERIFY_LOW_DIFF, "below pool difficulty: %s",
+          cluster_verify_result_name(result));
+
+    block1_work(&work, 1);
+    cluster_verify_header_from_work(&work, &header);
+    cluster_work_index_put(&header);
+
+    share.nonce = BLOCK1_NONCE + 1;
+    result = lookup_and_verify(&share, &diff, &found);
+    CHECK(result == CLUSTER_VERIFY_BAD_HASH, "wrong nonce: %s (diff %.4f)",
+          cluster_verify_result_name(result), diff);
+    share.nonce = BLOCK1_NONCE;
+
+    // Rolled inside the mask changes the header; outside it is refused unhashed
+    share.version = 0x00002000;
+    result = lookup_and_verify(&share, &diff, &found);
+    CHECK(result == CLUSTER_VERIFY_BAD_HASH, "rolled version: %s", cluster_verify_result_name(result));
+    share.version = 0x80000000;
+    result = lookup_and_verify(&share, &diff, &found);
+    CHECK(result == CLUSTER_VERIFY_BAD_VERSION && diff == 0, "version outside mask: %s",
+          cluster_verify_result_name(result));
+    share.version = 0;
+
+    // A job whose version has a maskable bit set: rolling it back off gives block 1
+    block1_work(&work, 1);
+    work.version |= 0x00002000;
+    cluster_verify_header_from_work(&work, &header);
+    cluster_work_index_put(&header);
+    result = lookup_and_verify(&share, &diff, &found);
+    CHECK(result == CLUSTER_VERIFY_BAD_HASH, "unrolled share on rolled job: %s",
+          cluster_verify_result_name(result));
+    share.version = 0x00002000;
+    result = lookup_and_verify(&share, &diff, &found);
+    CHECK(result == CLUSTER_VERIFY_OK, "rolled-back share: %s (diff %.4f)",
+          cluster_verify_result_name(result), diff);
+    share.version = 0;
+
+    // Another slave's extranonce2, another pool, another job
+    share.extranonce2[3] ^= 0xFF;
+    lookup_and_verify(&share, &diff, &found);
+    CHECK(!found, "share matched another extranonce2");
+    share.extranonce2[3] ^= 0xFF;
+
+    share.pool_id = 1;
+    lookup_and_verify(&share, &diff, &found);
+    CHECK(!found, "share matched another pool");
+    share.pool_id = 0;
+
+    share.job_id++;
+    lookup_and_verify(&share, &diff, &found);
+    CHECK(!found, "share matched another job");
+
+    cluster_index_stats_t stats;
+    cluster_index_get_stats(&stats);
+    CHECK(stats.work_entries == 1, "resent assignment not replaced (%u entries)", stats.work_entries);
+    CHECK(stats.work_misses == 3, "work misses %lu, expected 3", (unsigned long)stats.work_misses);
+
+    cluster_index_deinit();
+}
+
+// ============================================================================
+// Throughput
+// ============================================================================
+
+static void make_assignment(cluster_work_t *work, int slave, int job)
+{
+    memset(work, 0, sizeof(*work));
+    work->job_id = BENCH_FIRST_JOB + job;
+    work->pool_id = 0;
+    work->version = 0x20000000;
+    work->version_mask = 0x1fffe000;
+    work->nbits = 0x17034219;
+    work->ntime = 0x66000000 + job * 30;
+    work->pool_diff = 1024;
+    work->extranonce2_len = 8;
+    // As generate_extranonce2_for_slave(): slot + 1, then a timestamp
+    work->extranonce2[0] = (uint8_t)(slave + 1);
+    work->extranonce2[3] = (uint8_t)(job * 30);
+    for (int i = 0; i < 32; i++) {
+        work->prev_block_hash[i] = (uint8_t)(i * 7);
+        work->merkle_root[i] = (uint8_t)(slave * 31 + job * 17 + i);
+    }
+}
+
+static void bench(int slaves, int jobs)
+{
+    cluster_index_init();
+
+    // Work distribution: every slave gets every job
+    for (int job = 0; job < jobs; job++) {
+        for (int slave = 0; slave < slaves; slave++) {
+            cluster_work_t work;
+            cluster_work_header_t header;
+            make_assignment(&work, slave, job);
+            cluster_verify_header_from_work(&work, &header);
+            cluster_work_index_put(&header);
+        }
+    }
+
+    uint32_t found_count = 0;
+    uint32_t invalid = 0;
+    uint32_t misses_oldest = 0;
+
+    double start = now_s();
+    for (int i = 0; i < BENCH_SHARES; i++) {
+        int slave = sim_rand() % slaves;
+        int job = sim_rand() % jobs;
+
+        cluster_work_t work;
+        make_assignment(&work, slave, job);
+        cluster_share_t share = {
+            .job_id = work.job_id,
+            .pool_id = work.pool_id,
+            .nonce = sim_rand(),
+            .ntime = work.ntime,
+            .version = (sim_rand() << 13) & work.version_mask,
+            .slave_id = (uint16_t)slave,
+            .extranonce2_len = work.extranonce2_len,
+        };
+        memcpy(share.extranonce2, work.extranonce2, work.extranonce2_len);
+
+        double diff;
+        bool found;
+        cluster_verify_result_t result = lookup_and_verify(&share, &diff, &found);
+        if (found) {
+            found_count++;
+            invalid += (result != CLUSTER_VERIFY_OK);
+        } else if (job == 0) {
+            misses_oldest++;
+        }
+    }
+    double elapsed = now_s() - start;
+
+    cluster_index_stats_t stats;
+    cluster_index_get_stats(&stats);
+
+    int assignments = slaves * jobs;
+    uint32_t misses = BENCH_SHARES - found_count;
+    printf("  %2d slaves x %d jobs: %7.0f shares/s  %5.2f us/share  index %3u/%d  misses %5.1f%%  probe %u\n",
+           slaves, jobs, BENCH_SHARES / elapsed, elapsed * 1e6 / BENCH_SHARES,
+           stats.work_entries, CLUSTER_WORK_INDEX_SIZE, 100.0 * misses / BENCH_SHARES,
+           stats.max_probe);
+
+    // Random nonces: practically none reach difficulty 1024
+    CHECK(invalid == found_count, "%d slaves: %lu random shares verified ok",
+          slaves, (unsigned long)(found_count - invalid));
+
+    if (assignments <= CLUSTER_WORK_INDEX_SIZE) {
+        CHECK(misses == 0, "%d slaves: %lu misses with %d assignments indexed",
+              slaves, (unsigned long)misses, assignments);
+    } else {
+        // The ring evicts the oldest assignments first: only job 0 misses
+        CHECK(misses > 0 && misses == misses_oldest,
+              "%d slaves x %d jobs: %lu misses, %lu on the oldest job",
+              slaves, jobs, (unsigned long)misses, (unsigned long)misses_oldest);
+    }
+
+    cluster_index_deinit();
+}
+
+int main(void)
+{
+    sim_clock_init(1.0);
+
+    printf("share_verify: work index %d assignments\n", CLUSTER_WORK_INDEX_SIZE);
+    check_known_header();
+
+    printf("share_verify: lookup + re-hash, %d shares per run\n", BENCH_SHARES);
+    bench(8, BENCH_JOBS);
+    bench(16, BENCH_JOBS);
+    bench(32, BENCH_JOBS);
+    bench(64, BENCH_JOBS);
+    bench(64, BENCH_JOBS + 1);
+
+    printf("share_verify: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
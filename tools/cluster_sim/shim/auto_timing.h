@@ -0,0 +1,8 @@
+/**
+ * @file auto_timing.h
+ * @brief Host shim: ASIC job interval used by the master's work refresh
+ */
+#pragma once
+#include <stdint.h>
+
+uint16_t auto_timing_get_interval(void);
@@ -0,0 +1,18 @@
+/**
+ * @file esp_log.h
+ * @brief Host shim: ESP-IDF logging (silent unless SIM_VERBOSE is defined)
+ */
+#pragma once
+#include <stdio.h>
+
+#ifdef SIM_VERBOSE
+    #define SIM_LOG(level, tag, fmt, ...) printf(level " (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#else
+    #define SIM_LOG(level, tag, fmt, ...) do { (void)(tag); } while (0)
+#endif
+
+#define ESP_LOGE(tag, fmt, ...) SIM_LOG("E", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) SIM_LOG("W", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) SIM_LOG("I", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) SIM_LOG("D", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) SIM_LOG("V", tag, fmt, ##__VA_ARGS__)
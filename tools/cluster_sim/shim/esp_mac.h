@@ -0,0 +1,21 @@
+/**
+ * @file esp_mac.h
+ * @brief Host shim: MAC formatting helpers and esp_read_mac()
+ */
+#pragma once
+#include <stdint.h>
+
+#define MACSTR "%02x:%02x:%02x:%02x:%02x:%02x"
+#define MAC2STR(a) (a)[0], (a)[1], (a)[2], (a)[3], (a)[4], (a)[5]
+
+#include "esp_err.h"
+
+typedef enum {
+    ESP_MAC_WIFI_STA,
+    ESP_MAC_WIFI_SOFTAP,
+} esp_mac_type_t;
+
+/**
+ * @brief The calling node's MAC (the simulator assigns one per node)
+ */
+esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type);
@@ -0,0 +1,8 @@
+/**
+ * @file esp_random.h
+ * @brief Host shim: hardware RNG
+ */
+#pragma once
+#include <stdint.h>
+
+uint32_t esp_random(void);
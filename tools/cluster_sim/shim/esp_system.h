@@ -0,0 +1,8 @@
+/**
+ * @file esp_system.h
+ * @brief Host shim: system information
+ */
+#pragma once
+#include <stdint.h>
+
+uint32_t esp_get_free_heap_size(void);
@@ -0,0 +1,8 @@
+/**
+ * @file esp_timer.h
+ * @brief Host shim: microsecond clock (driven by the simulator)
+ */
+#pragma once
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
@@ -0,0 +1,25 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Host shim: FreeRTOS base types
+ *
+ * Types only. The pthread implementation of the task/queue/semaphore calls
+ * lives in tools/cluster_sim/sim_rtos.c (cluster_bench); relay_sim uses the
+ * types alone.
+ */
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef int         BaseType_t;
+typedef unsigned    UBaseType_t;
+typedef uint32_t    TickType_t;
+
+#define pdTRUE              1
+#define pdFALSE             0
+#define pdPASS              1
+#define pdFAIL              0
+#define errQUEUE_FULL       0
+#define portMAX_DELAY       0xFFFFFFFFu
+#define portTICK_PERIOD_MS  1
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
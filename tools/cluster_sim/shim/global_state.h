@@ -0,0 +1,16 @@
+/**
+ * @file global_state.h
+ * @brief Host shim: the parts of GlobalState the cluster core touches
+ */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    uint16_t current_interval_ms;
+    bool interval_changed;
+} AutoTimingModule;
+
+typedef struct {
+    AutoTimingModule AUTO_TIMING_MODULE;
+} GlobalState;
@@ -0,0 +1,6 @@
+/**
+ * @file nvs_flash.h
+ * @brief Host shim: NVS flash (see nvs.h)
+ */
+#pragma once
+#include "nvs.h"
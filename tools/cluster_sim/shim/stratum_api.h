@@ -0,0 +1,21 @@
+/**
+ * @file stratum_api.h
+ * @brief Host shim: mining.notify layout (components/stratum/include/stratum_api.h)
+ */
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct
+{
+    char *job_id;
+    char *prev_block_hash;
+    char *coinbase_1;
+    char *coinbase_2;
+    uint8_t *merkle_branches;
+    size_t n_merkle_branches;
+    uint32_t version;
+    uint32_t target;
+    uint32_t ntime;
+} mining_notify;
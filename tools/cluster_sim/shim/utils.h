@@ -0,0 +1,15 @@
+/**
+ * @file utils.h
+ * @brief Host shim: hashing helpers from components/stratum/include/utils.h
+ *
+ * Implemented in sim_utils.c without mbedtls.
+ */
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+void double_sha256_bin(const uint8_t *data, const size_t data_len, uint8_t dest[32]);
+
+void reverse_endianness_per_word(uint8_t data[32]);
+
+double le256todouble(const void *target);
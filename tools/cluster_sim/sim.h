@@ -0,0 +1,261 @@
+/**
+ * @file sim.h
+ * @brief Clusteraxe host simulator: harness interfaces
+ *
+ * The cluster core is loaded as shared objects (one master, one copy per
+ * slave) and runs unmodified on top of:
+ *   - sim_rtos.c:      FreeRTOS tasks/queues/semaphores on pthreads, with a
+ *                      scaled clock so a minute of cluster time runs faster
+ *   - sim_transport.c: the ESP-NOW transport backend over a shared simulated
+ *                      radio with latency, jitter, loss, reordering and airtime
+ *   - sim_pool.c:      scripted stand-in pool (notifies and share verdicts)
+ *   - sim_asic.c:      per-slave ASIC model and the integration getters
+ *
+ * Every simulated task belongs to a node (0 = master, 1..N = slaves). The
+ * node is inherited from the task that called xTaskCreate(), which is how
+ * the transport knows who is sending and how master CPU is accounted.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "cluster.h"
+#include "cluster_transport.h"
+
+#define SIM_MAX_SLAVES          64
+#define SIM_MAX_NODES           (1 + SIM_MAX_SLAVES)
+#define SIM_MASTER_NODE         0
+#define SIM_NO_NODE             (-1)
+
+// ============================================================================
+// Clock and tasks (sim_rtos.c)
+// ============================================================================
+
+/**
+ * @brief Start the simulated clock
+ * @param speed Simulated milliseconds per real millisecond
+ */
+void sim_clock_init(double speed);
+
+/**
+ * @brief Simulated time since sim_clock_init (us); also esp_timer_get_time()
+ */
+int64_t sim_now_us(void);
+
+/**
+ * @brief Simulated milliseconds per real millisecond
+ */
+double sim_clock_speed(void);
+
+/**
+ * @brief Give a node's esp_timer_get_time() an offset and a rate error
+ *
+ * Only esp_timer is skewed; FreeRTOS ticks and delays stay on the shared
+ * simulated clock. Set before the node's tasks start.
+ */
+void sim_clock_set_skew(int node, int64_t offset_us, double drift_ppm);
+
+/**
+ * @brief What a node's esp_timer reads at a simulated time
+ */
+int64_t sim_node_time_us(int node, int64_t sim_us);
+
+/**
+ * @brief Block the calling thread for a simulated duration
+ */
+void sim_sleep_us(int64_t us);
+
+/**
+ * @brief Node the calling thread acts for
+ */
+int sim_current_node(void);
+
+/**
+ * @brief Set the node for the calling thread (harness threads only)
+ */
+void sim_set_current_node(int node);
+
+/**
+ * @brief CPU time consumed so far by all tasks created for a node (s)
+ */
+double sim_node_cpu_seconds(int node);
+
+// ============================================================================
+// Radio (sim_transport.c)
+// ============================================================================
+
+typedef struct {
+    double      latency_ms;         // One-way delivery latency after airtime
+    double      jitter_ms;          // Uniform extra delay [0, jitter)
+    double      loss;               // Per-receiver frame loss probability
+    double      reorder;            // Probability a frame is held back
+    double      reorder_ms;         // Maximum hold-back for reordered frames
+    double      rate_kbps;          // Air rate (ESP-NOW default is 1 Mbps)
+    uint32_t    seed;
+} sim_net_config_t;
+
+typedef struct {
+    uint32_t    frames_sent;        // Unicast + broadcast transmissions
+    uint32_t    broadcasts;
+    uint32_t    frames_delivered;   // Per receiver
+    uint32_t    frames_lost;        // Per receiver
+    uint32_t    unicast_no_ack;     // Sender saw ESP_FAIL
+    uint32_t    send_timeouts;      // Sender saw ESP_ERR_TIMEOUT (busy air)
+    uint32_t    rx_overflows;       // Receiver RX queue full
+    uint64_t    air_us;             // Total airtime used
+    uint32_t    master_tx;          // Frames sent by the master
+} sim_net_stats_t;
+
+/**
+ * @brief Node entry point the radio delivers into (resolved from its library)
+ */
+typedef struct {
+    void (*receive)(const cluster_transport_ops_t *from, const uint8_t *src_mac,
+                    char *data, size_t len);
+} sim_node_rx_t;
+
+esp_err_t sim_transport_init(const sim_net_config_t *config, int node_count);
+
+/**
+ * @brief Create the node's RX queue and RX task; call in the node's context
+ */
+esp_err_t sim_transport_attach(int node, const sim_node_rx_t *rx);
+
+void sim_transport_node_mac(int node, uint8_t *mac);
+
+/**
+ * @brief Lose every frame on the channel while down is true
+ */
+void sim_transport_set_outage(bool down);
+
+void sim_transport_get_stats(sim_net_stats_t *stats);
+
+// ============================================================================
+// Pool (sim_pool.c)
+// ============================================================================
+
+typedef struct {
+    double      notify_interval_ms;
+    double      clean_ratio;        // Share of notifies that start a new block
+    double      rtt_ms;             // mining.submit -> result
+    int         jobs_kept;          // Older non-clean jobs are stale
+    uint32_t    pool_diff;
+    uint32_t    seed;
+} sim_pool_config_t;
+
+typedef struct {
+    char        job_id[16];
+    char        prev_block_hash[65];
+    uint32_t    version;
+    uint32_t    version_mask;
+    uint32_t    nbits;
+    uint32_t    ntime;
+    uint32_t    pool_diff;
+    uint8_t     extranonce2_len;
+    bool        clean_jobs;
+} sim_notify_t;
+
+typedef struct {
+    uint32_t    notifies;
+    uint32_t    submitted;          // mining.submit received
+    uint32_t    accepted;
+    uint32_t    stale;
+    uint32_t    duplicate;
+    uint32_t    rejected;
+} sim_pool_stats_t;
+
+/**
+ * @brief Master hooks the pool drives (resolved from the master library)
+ */
+typedef struct {
+    void (*on_notify)(const sim_notify_t *notify);
+    void (*on_result)(int message_id, bool accepted);
+} sim_pool_master_t;
+
+esp_err_t sim_pool_init(const sim_pool_config_t *config, const sim_pool_master_t *master);
+
+/**
+ * @brief Start the stratum stand-in tasks; call in the master's context
+ */
+esp_err_t sim_pool_start(void);
+
+/**
+ * @brief Stop emitting notifies (verdicts are still returned)
+ */
+void sim_pool_stop(void);
+
+/**
+ * @brief mining.submit from the master (called by the master glue)
+ */
+void sim_pool_submit(int message_id, const char *job_id, const char *extranonce2,
+                     uint32_t ntime, uint32_t nonce, uint32_t version, uint8_t slave_id);
+
+/**
+ * @brief Simulated time the pool announced a numeric job id (us), or -1
+ */
+int64_t sim_pool_job_time_us(uint32_t numeric_job_id);
+
+/**
+ * @brief Number of notifies sent at or after a simulated time
+ */
+uint32_t sim_pool_jobs_since(int64_t since_us);
+
+void sim_pool_get_stats(sim_pool_stats_t *stats);
+
+// ============================================================================
+// Slave ASIC model (sim_asic.c)
+// ============================================================================
+
+typedef struct {
+    double      shares_per_s;       // Per slave, simulated time
+    int64_t     record_after_us;    // Ignore latency of jobs notified before this
+    uint32_t    seed;
+} sim_asic_config_t;
+
+typedef struct {
+    uint32_t    shares_found;       // Reported to the slave's cluster core
+    uint32_t    work_deliveries;    // (slave, job) pairs that reached an ASIC
+    uint32_t    work_regressions;   // ASIC switched back to an older job
+    uint32_t    latency_count;
+    double     *latency_ms;         // notify -> cluster_submit_work_to_asic
+} sim_asic_stats_t;
+
+/**
+ * @brief Slave entry point the ASIC model reports shares to
+ */
+typedef void (*sim_share_found_fn)(uint32_t nonce, uint32_t job_id, uint32_t version,
+                                   uint32_t ntime, const char *extranonce2_hex);
+
+esp_err_t sim_asic_init(const sim_asic_config_t *config, int slave_count);
+
+void sim_asic_attach(int node, sim_share_found_fn on_share_found);
+
+/**
+ * @brief Start the share generator; shares are found on whatever work each ASIC holds
+ */
+esp_err_t sim_asic_start(void);
+
+/**
+ * @brief Stop finding shares (work keeps being accepted)
+ */
+void sim_asic_stop(void);
+
+void sim_asic_get_stats(sim_asic_stats_t *stats);
+
+typedef struct {
+    uint16_t    freq_mhz;
+    uint16_t    voltage_mv;
+    uint32_t    steps;              // Frequency/voltage changes applied
+    bool        ramp_violation;     // Frequency rose in a step that lowered voltage
+} sim_asic_settings_t;
+
+/**
+ * @brief A slave's frequency and core voltage, as remote settings left them
+ */
+void sim_asic_get_settings(int node, sim_asic_settings_t *settings);
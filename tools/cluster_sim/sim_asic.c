@@ -0,0 +1,426 @@
+/**
+ * @file sim_asic.c
+ * @brief Clusteraxe host simulator: slave ASIC model and board integration
+ *
+ * Stands in for the ESP-Miner side of cluster_integration.c:
+ *   - cluster_submit_work_to_asic() loads work into the calling slave's
+ *     ASIC and records notify -> ASIC latency the first time each job
+ *     reaches that slave.
+ *   - A share generator finds shares on whatever work each ASIC holds
+ *     (Poisson, shares_per_s per slave) and reports them through the
+ *     slave's cluster_slave_on_share_found(), like the ASIC result task.
+ *     Each share is mined: random version bits within the mask, then
+ *     nonces from a random point of the slave's range until the header,
+ *     built as test_nonce_value() does, reaches the pool difficulty
+ *     (scaled, see sim_utils.c). Only the rolled bits are reported.
+ *   - cluster_get_*() getters return fixed per-node board values, except
+ *     frequency and core voltage, which remote settings requests change
+ *     through cluster_set_asic_settings(); NVS, auto-timing and
+ *     GlobalState are inert.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "global_state.h"
+#include "nvs.h"
+#include "sim.h"
+#include "utils.h"
+
+#define SIM_ASIC_TICK_MS        20
+
+typedef struct {
+    pthread_mutex_t     lock;
+    bool                has_work;
+    cluster_work_t      work;
+    uint32_t            newest_job;         // Newest job loaded (pool ids only increase)
+    sim_share_found_fn  on_share_found;
+    char                hostname[32];
+    char                ip_addr[16];
+    uint16_t            freq_mhz;
+    uint16_t            voltage_mv;
+    uint32_t            settings_steps;     // cluster_set_asic_settings() calls
+    bool                ramp_violation;     // Frequency rose in a step that lowered voltage
+} sim_asic_t;
+
+static struct {
+    sim_asic_config_t   config;
+    int                 slave_count;
+    sim_asic_t          asics[SIM_MAX_NODES];
+    uint64_t            rng;
+
+    pthread_mutex_t     stats_lock;
+    sim_asic_stats_t    stats;
+    uint32_t            latency_cap;
+    pthread_t           generator;
+    volatile bool       stopped;
+} g_asic;
+
+static double rand_unit(void)
+{
+    g_asic.rng ^= g_asic.rng >> 12;
+    g_asic.rng ^= g_asic.rng << 25;
+    g_asic.rng ^= g_asic.rng >> 27;
+    return ((g_asic.rng * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static sim_asic_t *current_asic(void)
+{
+    int node = sim_current_node();
+    if (node < 0 || node > g_asic.slave_count) {
+        return NULL;
+    }
+    return &g_asic.asics[node];
+}
+
+static void record_latency(double ms)
+{
+    pthread_mutex_lock(&g_asic.stats_lock);
+    if (g_asic.stats.latency_count == g_asic.latency_cap) {
+        uint32_t cap = g_asic.latency_cap ? g_asic.latency_cap * 2 : 1024;
+        double *grown = realloc(g_asic.stats.latency_ms, cap * sizeof(double));
+        if (!grown) {
+            pthread_mutex_unlock(&g_asic.stats_lock);
+            return;
+        }
+        g_asic.stats.latency_ms = grown;
+        g_asic.latency_cap = cap;
+    }
+    g_asic.stats.latency_ms[g_asic.stats.latency_count++] = ms;
+    g_asic.stats.work_deliveries++;
+    pthread_mutex_unlock(&g_asic.stats_lock);
+}
+
+// ============================================================================
+// Share generator
+// ============================================================================
+
+// Difficulty 1 target, as in mining.c
+static const double truediffone = 26959535291011309493156476344723991336010898738574164086137773096960.0;
+
+static void put_le32(uint8_t *dest, uint32_t value)
+{
+    dest[0] = value & 0xFF;
+    dest[1] = (value >> 8) & 0xFF;
+    dest[2] = (value >> 16) & 0xFF;
+    dest[3] = (value >> 24) & 0xFF;
+}
+
+/**
+ * @brief Search a nonce that takes the work's header to its pool difficulty
+ *
+ * @param rolled  Version bits to roll (already within the mask)
+ * @return false if the whole nonce range fell short
+ */
+static bool mine_share(const cluster_work_t *work, uint32_t rolled, uint32_t start, uint32_t *nonce)
+{
+    uint8_t header[80];
+    put_le32(header, work->version ^ rolled);
+    memcpy(header + 4, work->prev_block_hash, 32);
+    reverse_endianness_per_word(header + 4);
+    memcpy(header + 36, work->merkle_root, 32);
+    put_le32(header + 68, work->ntime);
+    put_le32(header + 72, work->nbits);
+
+    uint32_t span = work->nonce_end - work->nonce_start;
+    for (uint32_t i = 0; i < span; i++) {
+        uint32_t candidate = work->nonce_start + (start + i) % span;
+        put_le32(header + 76, candidate);
+
+        uint8_t hash[32];
+        double_sha256_bin(header, sizeof(header), hash);
+        if (truediffone / le256todouble(hash) >= (double)work->pool_diff) {
+            *nonce = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void *generator_thread(void *arg)
+{
+    (void)arg;
+    double p = g_asic.config.shares_per_s * SIM_ASIC_TICK_MS / 1000.0;
+
+    while (!g_asic.stopped) {
+        sim_sleep_us(SIM_ASIC_TICK_MS * 1000);
+
+        for (int node = 1; node <= g_asic.slave_count; node++) {
+            sim_asic_t *asic = &g_asic.asics[node];
+
+            pthread_mutex_lock(&asic->lock);
+            if (!asic->has_work || !asic->on_share_found || rand_unit() >= p) {
+                pthread_mutex_unlock(&asic->lock);
+                continue;
+            }
+            cluster_work_t work = asic->work;
+            uint32_t span = work.nonce_end - work.nonce_start;
+            uint32_t start = (uint32_t)(rand_unit() * span);
+            uint32_t rolled = ((uint32_t)(rand_unit() * 65536) << 13) & work.version_mask;
+            pthread_mutex_unlock(&asic->lock);
+
+            uint32_t nonce;
+            if (!mine_share(&work, rolled, start, &nonce)) {
+                continue;
+            }
+
+            char en2_hex[17] = {0};
+            for (int i = 0; i < work.extranonce2_len && i < 8; i++) {
+                snprintf(en2_hex + i * 2, 3, "%02x", work.extranonce2[i]);
+            }
+
+            pthread_mutex_lock(&g_asic.stats_lock);
+            g_asic.stats.shares_found++;
+            pthread_mutex_unlock(&g_asic.stats_lock);
+
+            sim_set_current_node(node);
+            asic->on_share_found(nonce, work.job_id, rolled, work.ntime, en2_hex);
+            sim_set_current_node(SIM_NO_NODE);
+        }
+    }
+    return NULL;
+}
+
+// ============================================================================
+// API
+// ============================================================================
+
+esp_err_t sim_asic_init(const sim_asic_config_t *config, int slave_count)
+{
+    if (!config || slave_count < 0 || slave_count > SIM_MAX_SLAVES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(&g_asic, 0, sizeof(g_asic));
+    g_asic.config = *config;
+    g_asic.slave_count = slave_count;
+    g_asic.rng = config->seed ? config->seed : 0xDA942042E4DD58B5ULL;
+    pthread_mutex_init(&g_asic.stats_lock, NULL);
+
+    for (int node = 0; node <= slave_count; node++) {
+        sim_asic_t *asic = &g_asic.asics[node];
+        pthread_mutex_init(&asic->lock, NULL);
+        if (node == SIM_MASTER_NODE) {
+            snprintf(asic->hostname, sizeof(asic->hostname), "sim-master");
+        } else {
+            snprintf(asic->hostname, sizeof(asic->hostname), "sim-slave-%02d", node);
+        }
+        snprintf(asic->ip_addr, sizeof(asic->ip_addr), "10.0.0.%d", node + 1);
+        asic->freq_mhz = 525;
+        asic->voltage_mv = 1150;
+    }
+    return ESP_OK;
+}
+
+void sim_asic_attach(int node, sim_share_found_fn on_share_found)
+{
+    if (node > 0 && node <= g_asic.slave_count) {
+        g_asic.asics[node].on_share_found = on_share_found;
+    }
+}
+
+esp_err_t sim_asic_start(void)
+{
+    if (pthread_create(&g_asic.generator, NULL, generator_thread, NULL) != 0) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+void sim_asic_stop(void)
+{
+    g_asic.stopped = true;
+}
+
+void sim_asic_get_stats(sim_asic_stats_t *stats)
+{
+    pthread_mutex_lock(&g_asic.stats_lock);
+    *stats = g_asic.stats;
+    pthread_mutex_unlock(&g_asic.stats_lock);
+}
+
+void sim_asic_get_settings(int node, sim_asic_settings_t *settings)
+{
+    memset(settings, 0, sizeof(*settings));
+    if (node <= 0 || node > g_asic.slave_count) {
+        return;
+    }
+    sim_asic_t *asic = &g_asic.asics[node];
+    pthread_mutex_lock(&asic->lock);
+    settings->freq_mhz = asic->freq_mhz;
+    settings->voltage_mv = asic->voltage_mv;
+    settings->steps = asic->settings_steps;
+    settings->ramp_violation = asic->ramp_violation;
+    pthread_mutex_unlock(&asic->lock);
+}
+
+// ============================================================================
+// Integration layer (cluster_integration.c equivalents)
+// ============================================================================
+
+void cluster_submit_work_to_asic(const cluster_work_t *work)
+{
+    sim_asic_t *asic = current_asic();
+    if (!asic || !work) {
+        return;
+    }
+
+    pthread_mutex_lock(&asic->lock);
+    asic->work = *work;
+    asic->has_work = true;
+    bool first_for_job = (work->job_id > asic->newest_job);
+    bool regressed = (work->job_id < asic->newest_job);
+    if (first_for_job) {
+        asic->newest_job = work->job_id;
+    }
+    pthread_mutex_unlock(&asic->lock);
+
+    if (regressed) {
+        // A late (reordered or re-broadcast) frame replaced newer work
+        pthread_mutex_lock(&g_asic.stats_lock);
+        g_asic.stats.work_regressions++;
+        pthread_mutex_unlock(&g_asic.stats_lock);
+    } else if (first_for_job) {
+        int64_t notified_us = sim_pool_job_time_us(work->job_id);
+        if (notified_us >= g_asic.config.record_after_us) {
+            record_latency((sim_now_us() - notified_us) / 1000.0);
+        }
+    }
+}
+
+const char *cluster_get_hostname(void)
+{
+    sim_asic_t *asic = current_asic();
+    return asic ? asic->hostname : "sim-unknown";
+}
+
+const char *cluster_get_ip_addr(void)
+{
+    sim_asic_t *asic = current_asic();
+    return asic ? asic->ip_addr : "";
+}
+
+uint32_t cluster_get_asic_hashrate(void)
+{
+    return 120000;      // 1.2 TH/s in GH/s * 100
+}
+
+float cluster_get_chip_temp(void)
+{
+    return 55.0f;
+}
+
+uint16_t cluster_get_fan_rpm(void)
+{
+    return 3000;
+}
+
+uint16_t cluster_get_asic_frequency(void)
+{
+    sim_asic_t *asic = current_asic();
+    return asic ? asic->freq_mhz : 525;
+}
+
+uint16_t cluster_get_core_voltage(void)
+{
+    sim_asic_t *asic = current_asic();
+    return asic ? asic->voltage_mv : 1150;
+}
+
+void cluster_get_asic_settings(uint16_t *freq_mhz, uint16_t *voltage_mv)
+{
+    *freq_mhz = cluster_get_asic_frequency();
+    *voltage_mv = cluster_get_core_voltage();
+}
+
+esp_err_t cluster_set_asic_settings(uint16_t freq_mhz, uint16_t voltage_mv, bool persist)
+{
+    (void)persist;
+    sim_asic_t *asic = current_asic();
+    if (!asic) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    pthread_mutex_lock(&asic->lock);
+    // A ramp never moves both at once, least of all in opposite directions
+    if (freq_mhz > asic->freq_mhz && voltage_mv < asic->voltage_mv) {
+        asic->ramp_violation = true;
+    }
+    asic->freq_mhz = freq_mhz;
+    asic->voltage_mv = voltage_mv;
+    asic->settings_steps++;
+    pthread_mutex_unlock(&asic->lock);
+    return ESP_OK;
+}
+
+float cluster_get_power(void)
+{
+    return 18.5f;
+}
+
+float cluster_get_voltage_in(void)
+{
+    return 5.1f;
+}
+
+// ============================================================================
+// Board stubs
+// ============================================================================
+
+static GlobalState g_global_state = {
+    .AUTO_TIMING_MODULE = { .current_interval_ms = 700 },
+};
+
+GlobalState *cluster_get_global_state(void)
+{
+    return &g_global_state;
+}
+
+uint16_t auto_timing_get_interval(void)
+{
+    return 700;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char *key, uint8_t *out_value)
+{
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char *key, uint8_t value)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+}
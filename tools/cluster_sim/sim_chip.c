@@ -0,0 +1,89 @@
+/**
+ * @file sim_chip.c
+ * @brief Clusteraxe host simulator: parametric BM1370 board model
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "sim_chip.h"
+
+static float uniform(uint32_t *seed)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    return ((*seed >> 8) & 0xFFFF) / 65536.0f + 0.5f / 65536.0f;
+}
+
+float sim_chip_gauss(uint32_t *seed)
+{
+    float u1 = uniform(seed), u2 = uniform(seed);
+    return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+void sim_chip_init(sim_chip_t *c, uint32_t *seed)
+{
+    *c = (sim_chip_t){
+        .gh_per_mhz = 2.28f,
+        .k_dyn = 0.0200f * (1.0f + 0.04f * sim_chip_gauss(seed)),
+        .p_board = 1.5f,
+        .p_leak = 1.2f * (1.0f + 0.10f * sim_chip_gauss(seed)),
+        .leak_per_c = 0.02f,
+        .r_th = 1.25f * (1.0f + 0.05f * sim_chip_gauss(seed)),
+        .tau_s = 15.0f,
+        .ambient = 25.0f + 1.5f * sim_chip_gauss(seed),
+        .vmin_400 = 1040.0f + 20.0f * sim_chip_gauss(seed),
+        .vmin_per_mhz = 0.45f,
+        .vmin_per_c = 0.6f,
+        .err_width_mv = 5.0f,
+        .err_floor_pct = 0.15f,
+        .freq = 525,
+        .voltage = 1150,
+    };
+    c->temp = sim_chip_settled_temp(c, c->freq, c->voltage);
+}
+
+float sim_chip_vmin(const sim_chip_t *c, uint16_t freq, float temp)
+{
+    return c->vmin_400 + c->vmin_per_mhz * (freq - 400) + c->vmin_per_c * (temp - 50.0f);
+}
+
+float sim_chip_error(const sim_chip_t *c, uint16_t freq, uint16_t voltage, float temp)
+{
+    float x = (sim_chip_vmin(c, freq, temp) - voltage) / c->err_width_mv;
+    return c->err_floor_pct + 100.0f / (1.0f + expf(-x));
+}
+
+float sim_chip_power(const sim_chip_t *c, uint16_t freq, uint16_t voltage, float temp)
+{
+    float v = voltage / 1000.0f;
+    return c->p_board + c->p_leak * expf(c->leak_per_c * (temp - 25.0f)) + c->k_dyn * freq * v * v;
+}
+
+float sim_chip_hashrate(const sim_chip_t *c, uint16_t freq, uint16_t voltage, float temp)
+{
+    float err = sim_chip_error(c, freq, voltage, temp);
+    return freq * c->gh_per_mhz * (err < 100.0f ? 1.0f - err / 100.0f : 0);
+}
+
+float sim_chip_vin(float power)
+{
+    return 5.2f - 0.01f * power;
+}
+
+float sim_chip_settled_temp(const sim_chip_t *c, uint16_t freq, uint16_t voltage)
+{
+    float temp = c->ambient;
+    for (int i = 0; i < 50; i++) {
+        temp = c->ambient + c->r_th * sim_chip_power(c, freq, voltage, temp);
+    }
+    return temp;
+}
+
+void sim_chip_step(sim_chip_t *c, float dt_s)
+{
+    float target = c->ambient + c->r_th * sim_chip_power(c, c->freq, c->voltage, c->temp);
+    c->temp += (target - c->temp) * (1.0f - expf(-dt_s / c->tau_s));
+}
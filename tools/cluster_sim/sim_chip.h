@@ -0,0 +1,72 @@
+/**
+ * @file sim_chip.h
+ * @brief Clusteraxe host simulator: parametric BM1370 board model
+ *
+ * Hashrate, power and hardware error rate against frequency, voltage and
+ * temperature, for the autotune harnesses. Each board gets a few % of
+ * spread from the seed:
+ *
+ *   power     board + leakage(T) + k * f * V^2, leakage doubling every ~35°C
+ *   temp      first order towards ambient + R_th * power (tau 15 s)
+ *   vmin      rises with f and T, plus a silicon lottery offset
+ *   error     floor + logistic in (vmin - V): ~50% at vmin, <1% 25 mV above
+ *   hashrate  f * GH/MHz * (1 - error)
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    float       gh_per_mhz;
+    float       k_dyn;          // W per MHz*V^2
+    float       p_board;        // W, regulators and fan
+    float       p_leak;         // W at 25°C
+    float       leak_per_c;     // Exponential coefficient
+    float       r_th;           // °C/W
+    float       tau_s;
+    float       ambient;
+    float       vmin_400;       // mV at 400 MHz and 50°C
+    float       vmin_per_mhz;
+    float       vmin_per_c;
+    float       err_width_mv;
+    float       err_floor_pct;
+
+    uint16_t    freq;           // Applied now
+    uint16_t    voltage;
+    float       temp;
+} sim_chip_t;
+
+/**
+ * @brief A board with random spread, settled at 525 MHz / 1150 mV
+ */
+void sim_chip_init(sim_chip_t *chip, uint32_t *seed);
+
+float sim_chip_vmin(const sim_chip_t *chip, uint16_t freq, float temp);
+float sim_chip_error(const sim_chip_t *chip, uint16_t freq, uint16_t voltage, float temp);
+float sim_chip_power(const sim_chip_t *chip, uint16_t freq, uint16_t voltage, float temp);
+float sim_chip_hashrate(const sim_chip_t *chip, uint16_t freq, uint16_t voltage, float temp);
+
+/**
+ * @brief Input voltage of a PSU sagging with the board's draw
+ */
+float sim_chip_vin(float power);
+
+/**
+ * @brief Temperature the chip settles at on a point, at its current ambient
+ */
+float sim_chip_settled_temp(const sim_chip_t *chip, uint16_t freq, uint16_t voltage);
+
+/**
+ * @brief Advance the chip's temperature by dt_s on its applied settings
+ */
+void sim_chip_step(sim_chip_t *chip, float dt_s);
+
+/**
+ * @brief Standard normal deviate from an LCG seed
+ */
+float sim_chip_gauss(uint32_t *seed);
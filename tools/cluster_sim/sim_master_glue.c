@@ -0,0 +1,166 @@
+/**
+ * @file sim_master_glue.c
+ * @brief Clusteraxe host simulator: master-side integration layer
+ *
+ * Built into the master library in place of the master half of
+ * cluster_integration.c, which needs GlobalState, mining.h and the real
+ * stratum client. Keep these in step with cluster_integration.c:
+ *   - sim_master_on_notify():              cluster_master_on_mining_notify(),
+ *                                          including the new-block check
+ *                                          from store_notify_data()
+ *   - cluster_master_store_job_mapping():  unchanged
+ *   - stratum_submit_share_from_cluster(): same lookup and pending-share
+ *                                          bookkeeping, submits to sim_pool
+ *   - cluster_notify_share_result():       unchanged
+ *   - cluster_autotune_profile_slave_joined(): no-op (autotune is not
+ *                                          part of this library)
+ *
+ * Merkle roots are not computed (the stand-in pool has no coinbase); each
+ * slave gets a placeholder derived from its extranonce2. The simulated
+ * ASICs mine on that placeholder, so shares still re-hash on the master.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cluster.h"
+#include "cluster_index.h"
+#include "cluster_trace.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sim.h"
+
+static const char *TAG = "sim_master";
+
+static int g_send_uid = 1;
+static char g_prev_block_hash[65];
+
+void cluster_master_store_job_mapping(uint32_t numeric_id, const char *job_id_str,
+                                       const char *extranonce2, uint32_t ntime, uint32_t version,
+                                       uint8_t pool_id)
+{
+    cluster_job_mapping_t mapping = {
+        .numeric_id = numeric_id,
+        .pool_id = pool_id,
+        .ntime = ntime,
+        .version = version,
+    };
+    strncpy(mapping.job_id_str, job_id_str, sizeof(mapping.job_id_str) - 1);
+    strncpy(mapping.extranonce2_str, extranonce2, sizeof(mapping.extranonce2_str) - 1);
+    cluster_job_index_put(&mapping);
+}
+
+bool cluster_master_compute_merkle_root(const uint8_t *extranonce2, uint8_t extranonce2_len,
+                                         uint8_t *merkle_root_out, uint8_t pool_id)
+{
+    uint32_t h = 2166136261u ^ pool_id;
+    for (int i = 0; i < 32; i++) {
+        h = (h ^ (i < extranonce2_len ? extranonce2[i] : (uint8_t)i)) * 16777619u;
+        merkle_root_out[i] = (uint8_t)(h >> 24);
+    }
+    return true;
+}
+
+static void hex_to_bytes(const char *hex, uint8_t *bytes, size_t len)
+{
+    for (size_t i = 0; i < len && hex[i*2] && hex[i*2+1]; i++) {
+        char byte_str[3] = {hex[i*2], hex[i*2+1], '\0'};
+        bytes[i] = (uint8_t)strtol(byte_str, NULL, 16);
+    }
+}
+
+void sim_master_on_notify(const sim_notify_t *notify)
+{
+    if (!notify || !cluster_is_active()) {
+        return;
+    }
+
+    if (strncmp(g_prev_block_hash, notify->prev_block_hash, sizeof(g_prev_block_hash) - 1) != 0) {
+        strncpy(g_prev_block_hash, notify->prev_block_hash, sizeof(g_prev_block_hash) - 1);
+        cluster_job_index_new_block(0);
+    }
+
+    cluster_work_t work = {0};
+
+    work.job_id = strtoul(notify->job_id, NULL, 16);
+    if (work.job_id == 0) {
+        for (const char *p = notify->job_id; *p; p++) {
+            work.job_id = work.job_id * 31 + *p;
+        }
+    }
+
+    cluster_master_store_job_mapping(work.job_id, notify->job_id, "",
+                                     notify->ntime, notify->version, 0);
+    cluster_trace_record(CLUSTER_TRACE_NOTIFY, CLUSTER_TRACE_NODE_MASTER, work.job_id, 0);
+
+    hex_to_bytes(notify->prev_block_hash, work.prev_block_hash, 32);
+    work.version = notify->version;
+    work.version_mask = notify->version_mask;
+    work.nbits = notify->nbits;
+    work.ntime = notify->ntime;
+    work.pool_diff = notify->pool_diff;
+    work.pool_id = 0;
+    work.extranonce2_len = notify->extranonce2_len;
+    work.clean_jobs = false;
+    work.timestamp = esp_timer_get_time() / 1000;
+
+    cluster_master_distribute_work(&work);
+}
+
+void stratum_submit_share_from_cluster(uint32_t job_id, uint32_t nonce,
+                                        uint8_t *extranonce2, uint8_t en2_len,
+                                        uint32_t ntime, uint32_t version,
+                                        uint8_t slave_id, uint8_t pool_id)
+{
+    char job_id_str[32];
+    cluster_job_mapping_t mapping;
+    if (cluster_job_index_get(job_id, pool_id, &mapping, NULL)) {
+        strncpy(job_id_str, mapping.job_id_str, sizeof(job_id_str) - 1);
+        job_id_str[sizeof(job_id_str) - 1] = '\0';
+    } else {
+        snprintf(job_id_str, sizeof(job_id_str), "%08" PRIx32, job_id);
+        ESP_LOGE(TAG, "JOB MAPPING NOT FOUND! job_id=%08" PRIx32, job_id);
+    }
+
+    char extranonce2_str[en2_len * 2 + 1];
+    for (int i = 0; i < en2_len; i++) {
+        sprintf(extranonce2_str + i * 2, "%02x", extranonce2[i]);
+    }
+    extranonce2_str[en2_len * 2] = '\0';
+
+    int send_uid = g_send_uid++;
+    cluster_pending_share_put(send_uid, slave_id, pool_id, job_id, nonce);
+
+    sim_pool_submit(send_uid, job_id_str, extranonce2_str, ntime, nonce, version, slave_id);
+}
+
+void cluster_notify_share_result(int message_id, bool accepted)
+{
+    uint8_t slave_id;
+    uint8_t pool_id;
+    uint32_t job_id;
+    uint32_t nonce;
+    if (!cluster_pending_share_take(message_id, &slave_id, &pool_id, &job_id, &nonce)) {
+        return;
+    }
+
+    cluster_trace_record(accepted ? CLUSTER_TRACE_ACCEPTED : CLUSTER_TRACE_REJECTED,
+                         slave_id, job_id, nonce);
+
+    cluster_slave_t slave;
+    if (cluster_master_get_slave(slave_id, &slave) == ESP_OK) {
+        extern void cluster_master_update_slave_share_count(uint8_t slave_id, bool accepted, uint8_t pool_id);
+        cluster_master_update_slave_share_count(slave_id, accepted, pool_id);
+    }
+}
+
+// Autotune (profiles pushed to slaves on registration) is not simulated here
+void cluster_autotune_profile_slave_joined(uint8_t slave_id)
+{
+    (void)slave_id;
+}
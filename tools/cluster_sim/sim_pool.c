@@ -0,0 +1,291 @@
+/**
+ * @file sim_pool.c
+ * @brief Clusteraxe host simulator: scripted stand-in pool
+ *
+ * Plays the stratum side of the master:
+ *   - "stratum" task: emits a mining.notify every notify_interval_ms and
+ *     hands it to the master glue, which converts and distributes it the
+ *     way cluster_master_on_mining_notify() does. A clean_ratio share of
+ *     notifies start a new block.
+ *   - mining.submit: judged on arrival. Shares for an unknown job are
+ *     rejected, shares for a job from an older block (or older than the
+ *     last jobs_kept notifies) are stale, and repeats of an already seen
+ *     (job, extranonce2, ntime, nonce, version) are duplicates.
+ *   - "stratum_rx" task: returns each verdict rtt_ms later through the
+ *     master's cluster_notify_share_result().
+ *
+ * Both tasks are created in the master's context so their CPU time counts
+ * as master CPU, like the real stratum tasks.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "sim.h"
+
+#define SIM_POOL_JOB_HISTORY    256         // Notify times kept for latency lookups
+#define SIM_POOL_SEEN_BITS      16          // Duplicate filter: 64K share fingerprints
+#define SIM_POOL_RESULT_QUEUE   256
+#define SIM_POOL_FIRST_JOB      0x1000      // Non-zero so the master parses it as hex
+
+typedef struct {
+    uint32_t    numeric_id;
+    uint32_t    block;
+    int64_t     time_us;
+    bool        valid;
+} sim_pool_job_t;
+
+typedef struct {
+    int         message_id;
+    bool        accepted;
+    int64_t     at_us;
+} sim_pool_result_t;
+
+static struct {
+    sim_pool_config_t   config;
+    sim_pool_master_t   master;
+
+    pthread_mutex_t     lock;
+    sim_pool_job_t      jobs[SIM_POOL_JOB_HISTORY];
+    uint32_t            next_job;
+    uint32_t            block;
+    uint32_t            block_first_job;    // First job of the current block
+    uint64_t           *seen;               // Open-addressed share fingerprints
+    uint64_t            rng;
+
+    QueueHandle_t       results;
+    sim_pool_stats_t    stats;
+    volatile bool       stopped;
+} g_pool;
+
+static double rand_unit(void)
+{
+    g_pool.rng ^= g_pool.rng >> 12;
+    g_pool.rng ^= g_pool.rng << 25;
+    g_pool.rng ^= g_pool.rng >> 27;
+    return ((g_pool.rng * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Record a share fingerprint (caller holds the lock)
+ * @return true if it was already present
+ */
+static bool seen_check_and_record(uint64_t fingerprint)
+{
+    if (fingerprint == 0) {
+        fingerprint = 1;
+    }
+    size_t mask = ((size_t)1 << SIM_POOL_SEEN_BITS) - 1;
+    for (size_t i = fingerprint & mask, n = 0; n <= mask; i = (i + 1) & mask, n++) {
+        if (g_pool.seen[i] == fingerprint) {
+            return true;
+        }
+        if (g_pool.seen[i] == 0) {
+            g_pool.seen[i] = fingerprint;
+            return false;
+        }
+    }
+    return false;   // Table full: stop detecting rather than fail
+}
+
+// ============================================================================
+// Tasks
+// ============================================================================
+
+static void stratum_task(void *pvParameters)
+{
+    int64_t next_us = sim_now_us();
+
+    while (!g_pool.stopped) {
+        sim_notify_t notify = {0};
+        int64_t now_us = sim_now_us();
+
+        pthread_mutex_lock(&g_pool.lock);
+        uint32_t job = g_pool.next_job++;
+        bool clean = (job == SIM_POOL_FIRST_JOB) || rand_unit() < g_pool.config.clean_ratio;
+        if (clean) {
+            g_pool.block++;
+            g_pool.block_first_job = job;
+        }
+
+        sim_pool_job_t *slot = &g_pool.jobs[job % SIM_POOL_JOB_HISTORY];
+        slot->numeric_id = job;
+        slot->block = g_pool.block;
+        slot->time_us = now_us;
+        slot->valid = true;
+        g_pool.stats.notifies++;
+
+        snprintf(notify.job_id, sizeof(notify.job_id), "%lx", (unsigned long)job);
+        for (int i = 0; i < 64; i += 8) {
+            snprintf(notify.prev_block_hash + i, 9, "%08lx",
+                     (unsigned long)(g_pool.block * 2654435761u + i));
+        }
+        pthread_mutex_unlock(&g_pool.lock);
+
+        notify.version = 0x20000000;
+        notify.version_mask = 0x1fffe000;
+        notify.nbits = 0x17034219;
+        notify.ntime = 0x66000000 + (uint32_t)(now_us / 1000000);
+        notify.pool_diff = g_pool.config.pool_diff;
+        notify.extranonce2_len = 4;
+        notify.clean_jobs = clean;
+
+        g_pool.master.on_notify(&notify);
+
+        next_us += (int64_t)(g_pool.config.notify_interval_ms * 1000);
+        sim_sleep_us(next_us - sim_now_us());
+    }
+
+    vTaskDelete(NULL);
+}
+
+static void stratum_rx_task(void *pvParameters)
+{
+    sim_pool_result_t result;
+
+    while (1) {
+        if (xQueueReceive(g_pool.results, &result, portMAX_DELAY) == pdTRUE) {
+            sim_sleep_us(result.at_us - sim_now_us());
+            g_pool.master.on_result(result.message_id, result.accepted);
+        }
+    }
+}
+
+// ============================================================================
+// API
+// ============================================================================
+
+esp_err_t sim_pool_init(const sim_pool_config_t *config, const sim_pool_master_t *master)
+{
+    if (!config || !master || !master->on_notify || !master->on_result ||
+        config->notify_interval_ms <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(&g_pool, 0, sizeof(g_pool));
+    g_pool.config = *config;
+    g_pool.master = *master;
+    g_pool.next_job = SIM_POOL_FIRST_JOB;
+    g_pool.rng = config->seed ? config->seed : 0x853C49E6748FEA9BULL;
+    pthread_mutex_init(&g_pool.lock, NULL);
+
+    g_pool.seen = calloc((size_t)1 << SIM_POOL_SEEN_BITS, sizeof(uint64_t));
+    g_pool.results = xQueueCreate(SIM_POOL_RESULT_QUEUE, sizeof(sim_pool_result_t));
+    if (!g_pool.seen || !g_pool.results) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t sim_pool_start(void)
+{
+    if (xTaskCreate(stratum_task, "stratum", 8192, NULL, 5, NULL) != pdPASS ||
+        xTaskCreate(stratum_rx_task, "stratum_rx", 4096, NULL, 5, NULL) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void sim_pool_stop(void)
+{
+    g_pool.stopped = true;
+}
+
+void sim_pool_submit(int message_id, const char *job_id, const char *extranonce2,
+                     uint32_t ntime, uint32_t nonce, uint32_t version, uint8_t slave_id)
+{
+    (void)slave_id;
+
+    uint32_t job = (uint32_t)strtoul(job_id, NULL, 16);
+    bool accepted = false;
+
+    pthread_mutex_lock(&g_pool.lock);
+    g_pool.stats.submitted++;
+
+    sim_pool_job_t *entry = &g_pool.jobs[job % SIM_POOL_JOB_HISTORY];
+    bool known = job >= SIM_POOL_FIRST_JOB && job < g_pool.next_job;
+
+    if (!known) {
+        g_pool.stats.rejected++;
+    } else if (job < g_pool.block_first_job ||
+               g_pool.next_job - job > (uint32_t)g_pool.config.jobs_kept ||
+               !entry->valid || entry->numeric_id != job) {
+        g_pool.stats.stale++;
+    } else {
+        uint64_t fp = fnv1a(0xCBF29CE484222325ULL, &job, sizeof(job));
+        fp = fnv1a(fp, extranonce2, strlen(extranonce2));
+        fp = fnv1a(fp, &ntime, sizeof(ntime));
+        fp = fnv1a(fp, &nonce, sizeof(nonce));
+        fp = fnv1a(fp, &version, sizeof(version));
+        if (seen_check_and_record(fp)) {
+            g_pool.stats.duplicate++;
+        } else {
+            g_pool.stats.accepted++;
+            accepted = true;
+        }
+    }
+    pthread_mutex_unlock(&g_pool.lock);
+
+    sim_pool_result_t result = {
+        .message_id = message_id,
+        .accepted = accepted,
+        .at_us = sim_now_us() + (int64_t)(g_pool.config.rtt_ms * 1000),
+    };
+    xQueueSend(g_pool.results, &result, 0);
+}
+
+int64_t sim_pool_job_time_us(uint32_t numeric_job_id)
+{
+    int64_t time_us = -1;
+
+    pthread_mutex_lock(&g_pool.lock);
+    sim_pool_job_t *entry = &g_pool.jobs[numeric_job_id % SIM_POOL_JOB_HISTORY];
+    if (entry->valid && entry->numeric_id == numeric_job_id) {
+        time_us = entry->time_us;
+    }
+    pthread_mutex_unlock(&g_pool.lock);
+
+    return time_us;
+}
+
+uint32_t sim_pool_jobs_since(int64_t since_us)
+{
+    uint32_t count = 0;
+
+    pthread_mutex_lock(&g_pool.lock);
+    for (uint32_t job = g_pool.next_job; job-- > SIM_POOL_FIRST_JOB; ) {
+        sim_pool_job_t *entry = &g_pool.jobs[job % SIM_POOL_JOB_HISTORY];
+        if (!entry->valid || entry->numeric_id != job || entry->time_us < since_us) {
+            break;
+        }
+        count++;
+    }
+    pthread_mutex_unlock(&g_pool.lock);
+
+    return count;
+}
+
+void sim_pool_get_stats(sim_pool_stats_t *stats)
+{
+    pthread_mutex_lock(&g_pool.lock);
+    *stats = g_pool.stats;
+    pthread_mutex_unlock(&g_pool.lock);
+}
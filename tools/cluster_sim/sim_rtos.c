@@ -0,0 +1,549 @@
+/**
+ * @file sim_rtos.c
+ * @brief Clusteraxe host simulator: FreeRTOS on pthreads
+ *
+ * Implements the subset of FreeRTOS the cluster core uses (tasks, task
+ * notifications, queues, mutexes, binary semaphores, delays and the tick
+ * count) plus esp_timer_get_time(), esp_random() and
+ * esp_get_free_heap_size(). All timeouts and delays run on a simulated
+ * clock that advances `speed` times faster than the wall clock.
+ * esp_timer_get_time() can be given a per-node offset and rate error, like
+ * the independent crystals of real boards.
+ *
+ * Priorities and stack sizes are accepted and ignored; the host scheduler
+ * decides who runs. Each task remembers the node it was created for so
+ * per-node CPU time can be read back with sim_node_cpu_seconds().
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "esp_system.h"
+#include "sim.h"
+
+#define SIM_MAX_TASKS           1024
+#define SIM_TASK_STACK_BYTES    (256 * 1024)
+
+// ============================================================================
+// Clock
+// ============================================================================
+
+static struct timespec g_start;
+static double g_speed = 1.0;
+
+static int64_t real_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void sim_clock_init(double speed)
+{
+    g_speed = speed > 0 ? speed : 1.0;
+    clock_gettime(CLOCK_MONOTONIC, &g_start);
+}
+
+int64_t sim_now_us(void)
+{
+    int64_t start = (int64_t)g_start.tv_sec * 1000000000LL + g_start.tv_nsec;
+    return (int64_t)((real_ns() - start) / 1000 * g_speed);
+}
+
+double sim_clock_speed(void)
+{
+    return g_speed;
+}
+
+// Per-node clock error, as esp_timer sees it (see sim_clock_set_skew)
+static struct {
+    int64_t offset_us;
+    double  drift_ppm;
+} g_skew[SIM_MAX_NODES];
+
+void sim_clock_set_skew(int node, int64_t offset_us, double drift_ppm)
+{
+    if (node >= 0 && node < SIM_MAX_NODES) {
+        g_skew[node].offset_us = offset_us;
+        g_skew[node].drift_ppm = drift_ppm;
+    }
+}
+
+int64_t sim_node_time_us(int node, int64_t sim_us)
+{
+    if (node < 0 || node >= SIM_MAX_NODES) {
+        return sim_us;
+    }
+    return sim_us + g_skew[node].offset_us + (int64_t)(sim_us * g_skew[node].drift_ppm * 1e-6);
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return sim_node_time_us(sim_current_node(), sim_now_us());
+}
+
+void sim_sleep_us(int64_t us)
+{
+    if (us <= 0) {
+        return;
+    }
+    int64_t ns = (int64_t)(us * 1000 / g_speed);
+    struct timespec ts = { .tv_sec = ns / 1000000000LL, .tv_nsec = ns % 1000000000LL };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+/**
+ * @brief Absolute CLOCK_MONOTONIC deadline for a timeout in ticks (ms)
+ */
+static struct timespec deadline_after(TickType_t ticks)
+{
+    int64_t ns = real_ns() + (int64_t)(ticks * 1000000.0 / g_speed);
+    struct timespec ts = { .tv_sec = ns / 1000000000LL, .tv_nsec = ns % 1000000000LL };
+    return ts;
+}
+
+static void cond_init(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+/**
+ * @brief Wait on a condition with FreeRTOS timeout semantics
+ * @return false once the timeout has expired
+ */
+static bool cond_wait_ticks(pthread_cond_t *cond, pthread_mutex_t *lock,
+                            TickType_t ticks, const struct timespec *deadline)
+{
+    if (ticks == 0) {
+        return false;
+    }
+    if (ticks == portMAX_DELAY) {
+        pthread_cond_wait(cond, lock);
+        return true;
+    }
+    return pthread_cond_timedwait(cond, lock, deadline) != ETIMEDOUT;
+}
+
+// ============================================================================
+// Tasks
+// ============================================================================
+
+typedef struct {
+    pthread_t       thread;
+    clockid_t       cpu_clock;
+    bool            cpu_clock_valid;
+    int             node;
+    TaskFunction_t  fn;
+    void           *params;
+    char            name[16];
+
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    uint32_t        notify_value;
+} sim_task_t;
+
+static sim_task_t *g_tasks[SIM_MAX_TASKS];
+static int g_task_count = 0;
+static pthread_mutex_t g_tasks_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread sim_task_t *tl_task = NULL;
+static __thread int tl_node = SIM_NO_NODE;
+
+int sim_current_node(void)
+{
+    return tl_node;
+}
+
+void sim_set_current_node(int node)
+{
+    tl_node = node;
+}
+
+double sim_node_cpu_seconds(int node)
+{
+    double total = 0;
+
+    pthread_mutex_lock(&g_tasks_lock);
+    for (int i = 0; i < g_task_count; i++) {
+        sim_task_t *task = g_tasks[i];
+        struct timespec ts;
+        if (task->node == node && task->cpu_clock_valid &&
+            clock_gettime(task->cpu_clock, &ts) == 0) {
+            total += ts.tv_sec + ts.tv_nsec / 1e9;
+        }
+    }
+    pthread_mutex_unlock(&g_tasks_lock);
+
+    return total;
+}
+
+static void *task_entry(void *arg)
+{
+    sim_task_t *task = arg;
+
+    tl_task = task;
+    tl_node = task->node;
+
+    pthread_mutex_lock(&g_tasks_lock);
+    task->cpu_clock_valid = (pthread_getcpuclockid(pthread_self(), &task->cpu_clock) == 0);
+    pthread_mutex_unlock(&g_tasks_lock);
+
+    task->fn(task->params);
+
+    // FreeRTOS tasks must not return; treat it as self-deletion
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t task_fn, const char *name, uint32_t stack_depth,
+                       void *params, UBaseType_t priority, TaskHandle_t *created_task)
+{
+    (void)stack_depth;
+    (void)priority;
+
+    sim_task_t *task = calloc(1, sizeof(*task));
+    if (!task) {
+        return pdFAIL;
+    }
+    task->node = tl_node;
+    task->fn = task_fn;
+    task->params = params;
+    strncpy(task->name, name ? name : "", sizeof(task->name) - 1);
+    pthread_mutex_init(&task->lock, NULL);
+    cond_init(&task->cond);
+
+    pthread_mutex_lock(&g_tasks_lock);
+    if (g_task_count >= SIM_MAX_TASKS) {
+        pthread_mutex_unlock(&g_tasks_lock);
+        free(task);
+        return pdFAIL;
+    }
+    g_tasks[g_task_count++] = task;
+    pthread_mutex_unlock(&g_tasks_lock);
+
+    // Handle must be valid before the task can be notified
+    if (created_task) {
+        *created_task = task;
+    }
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, SIM_TASK_STACK_BYTES);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int err = pthread_create(&task->thread, &attr, task_entry, task);
+    pthread_attr_destroy(&attr);
+
+    if (err != 0) {
+        if (created_task) {
+            *created_task = NULL;
+        }
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t handle)
+{
+    sim_task_t *task = handle ? handle : tl_task;
+    if (!task) {
+        return;
+    }
+    if (task == tl_task) {
+        pthread_exit(NULL);
+    }
+    pthread_cancel(task->thread);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    sim_sleep_us((int64_t)ticks * 1000);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(sim_now_us() / 1000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return tl_task;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t handle)
+{
+    sim_task_t *task = handle;
+    if (!task) {
+        return pdFAIL;
+    }
+    pthread_mutex_lock(&task->lock);
+    task->notify_value++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait)
+{
+    sim_task_t *task = tl_task;
+    if (!task) {
+        vTaskDelay(ticks_to_wait == portMAX_DELAY ? 1000 : ticks_to_wait);
+        return 0;
+    }
+
+    struct timespec deadline = deadline_after(ticks_to_wait);
+    pthread_mutex_lock(&task->lock);
+    while (task->notify_value == 0) {
+        if (!cond_wait_ticks(&task->cond, &task->lock, ticks_to_wait, &deadline)) {
+            break;
+        }
+    }
+    uint32_t value = task->notify_value;
+    if (value > 0) {
+        task->notify_value = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return value;
+}
+
+// ============================================================================
+// Queues
+// ============================================================================
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t  not_empty;
+    pthread_cond_t  not_full;
+    uint8_t        *items;
+    size_t          item_size;
+    size_t          length;
+    size_t          head;
+    size_t          count;
+} sim_queue_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    sim_queue_t *queue = calloc(1, sizeof(*queue));
+    if (!queue) {
+        return NULL;
+    }
+    queue->items = calloc(length, item_size);
+    if (!queue->items) {
+        free(queue);
+        return NULL;
+    }
+    queue->item_size = item_size;
+    queue->length = length;
+    pthread_mutex_init(&queue->lock, NULL);
+    cond_init(&queue->not_empty);
+    cond_init(&queue->not_full);
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t handle)
+{
+    sim_queue_t *queue = handle;
+    if (!queue) {
+        return;
+    }
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_cond_destroy(&queue->not_full);
+    free(queue->items);
+    free(queue);
+}
+
+BaseType_t xQueueSend(QueueHandle_t handle, const void *item, TickType_t ticks_to_wait)
+{
+    sim_queue_t *queue = handle;
+    if (!queue) {
+        return errQUEUE_FULL;
+    }
+
+    struct timespec deadline = deadline_after(ticks_to_wait);
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == queue->length) {
+        if (!cond_wait_ticks(&queue->not_full, &queue->lock, ticks_to_wait, &deadline)) {
+            pthread_mutex_unlock(&queue->lock);
+            return errQUEUE_FULL;
+        }
+    }
+    size_t tail = (queue->head + queue->count) % queue->length;
+    memcpy(queue->items + tail * queue->item_size, item, queue->item_size);
+    queue->count++;
+    pthread_cond_signal(&queue->not_empty);
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t handle, void *item, TickType_t ticks_to_wait)
+{
+    sim_queue_t *queue = handle;
+    if (!queue) {
+        return pdFALSE;
+    }
+
+    struct timespec deadline = deadline_after(ticks_to_wait);
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0) {
+        if (!cond_wait_ticks(&queue->not_empty, &queue->lock, ticks_to_wait, &deadline)) {
+            pthread_mutex_unlock(&queue->lock);
+            return pdFALSE;
+        }
+    }
+    memcpy(item, queue->items + queue->head * queue->item_size, queue->item_size);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    pthread_cond_signal(&queue->not_full);
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t handle)
+{
+    sim_queue_t *queue = handle;
+    if (!queue) {
+        return 0;
+    }
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+// ============================================================================
+// Semaphores
+// ============================================================================
+
+// Mutexes are binary semaphores that start available (no priority inheritance)
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t  available;
+    unsigned        count;
+} sim_sem_t;
+
+static SemaphoreHandle_t sem_create(unsigned initial)
+{
+    sim_sem_t *sem = calloc(1, sizeof(*sem));
+    if (!sem) {
+        return NULL;
+    }
+    sem->count = initial;
+    pthread_mutex_init(&sem->lock, NULL);
+    cond_init(&sem->available);
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return sem_create(1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return sem_create(0);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t handle)
+{
+    sim_sem_t *sem = handle;
+    if (!sem) {
+        return;
+    }
+    pthread_mutex_destroy(&sem->lock);
+    pthread_cond_destroy(&sem->available);
+    free(sem);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t handle, TickType_t ticks_to_wait)
+{
+    sim_sem_t *sem = handle;
+    if (!sem) {
+        return pdFALSE;
+    }
+
+    struct timespec deadline = deadline_after(ticks_to_wait);
+    pthread_mutex_lock(&sem->lock);
+    while (sem->count == 0) {
+        if (!cond_wait_ticks(&sem->available, &sem->lock, ticks_to_wait, &deadline)) {
+            pthread_mutex_unlock(&sem->lock);
+            return pdFALSE;
+        }
+    }
+    sem->count--;
+    pthread_mutex_unlock(&sem->lock);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t handle)
+{
+    sim_sem_t *sem = handle;
+    if (!sem) {
+        return pdFALSE;
+    }
+
+    pthread_mutex_lock(&sem->lock);
+    if (sem->count > 0) {
+        pthread_mutex_unlock(&sem->lock);
+        return pdFALSE;
+    }
+    sem->count = 1;
+    pthread_cond_signal(&sem->available);
+    pthread_mutex_unlock(&sem->lock);
+    return pdTRUE;
+}
+
+// ============================================================================
+// ESP-IDF
+// ============================================================================
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+        case ESP_OK:                return "ESP_OK";
+        case ESP_FAIL:              return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:        return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:   return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:  return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:     return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:       return "ESP_ERR_TIMEOUT";
+        default:                    return "ESP_ERR_UNKNOWN";
+    }
+}
+
+uint32_t esp_random(void)
+{
+    static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    static uint64_t state = 0x853C49E6748FEA9BULL;
+
+    pthread_mutex_lock(&lock);
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    uint32_t value = (uint32_t)((state * 0x2545F4914F6CDD1DULL) >> 32);
+    pthread_mutex_unlock(&lock);
+    return value;
+}
+
+uint32_t esp_get_free_heap_size(void)
+{
+    // Roughly what a running board has left
+    return 150 * 1024;
+}
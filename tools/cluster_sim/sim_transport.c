@@ -0,0 +1,487 @@
+/**
+ * @file sim_transport.c
+ * @brief Clusteraxe host simulator: ESP-NOW radio model
+ *
+ * Provides the ESP-NOW transport backend (cluster_transport_espnow) the
+ * cluster core sends through, backed by one shared channel:
+ *   - Airtime: every frame occupies the channel for a PHY preamble plus its
+ *     bytes at the configured rate; unicast adds the MAC ACK. Frames queue
+ *     behind each other, so a busy master slows everyone down.
+ *   - The sender blocks until its frame is on the air, like the real send
+ *     path waiting for the send callback, and gets ESP_ERR_TIMEOUT if that
+ *     takes longer than 50 ms.
+ *   - Each receiver independently loses a frame with probability `loss`.
+ *     Unicast also loses the ACK with the same probability, so the sender
+ *     can see ESP_FAIL for a frame that did arrive (duplicates upstream).
+ *   - sim_transport_set_outage() loses every frame until it is cleared,
+ *     like the channel going away for the whole rack.
+ *   - Delivery happens `latency` (+ jitter) after the frame leaves the air;
+ *     a fraction of frames is held back up to `reorder_ms` to reorder them.
+ *   - Each node has the same 16-entry RX queue as cluster_espnow.c, and the
+ *     RX task hands frames to that node's cluster_transport_receive() like
+ *     espnow_rx_task() does.
+ *
+ * Discovery beacons come from the real discovery task in
+ * cluster_transport.c, so slaves join and register exactly as on hardware.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "cluster_transport.h"
+#include "sim.h"
+
+static const char *TAG = "sim_radio";
+
+#define SIM_FRAME_MAX           250     // ESPNOW_MAX_DATA_LEN
+#define SIM_RX_QUEUE_SIZE       16      // ESPNOW_QUEUE_SIZE
+#define SIM_PREAMBLE_US         192     // Long preamble at 1 Mbps
+#define SIM_MAC_HEADER_BYTES    43      // 802.11 action frame + ESP-NOW vendor IE
+#define SIM_ACK_US              304     // SIFS + ACK at basic rate
+#define SIM_SEND_TIMEOUT_MS     50      // cluster_espnow_send() callback wait
+
+static const uint8_t BROADCAST_MAC[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+typedef struct {
+    uint8_t src_mac[6];
+    uint8_t data[SIM_FRAME_MAX + 1];
+    size_t  len;
+} sim_rx_event_t;
+
+typedef struct {
+    int64_t         at_us;
+    uint64_t        seq;                // Keeps equal-time frames in send order
+    int             dst;
+    sim_rx_event_t  evt;
+} sim_frame_t;
+
+typedef struct {
+    bool                attached;
+    uint8_t             mac[6];
+    sim_node_rx_t       rx;
+    QueueHandle_t       rx_queue;
+    SemaphoreHandle_t   send_mutex;
+} sim_radio_node_t;
+
+static struct {
+    sim_net_config_t    config;
+    int                 node_count;
+    sim_radio_node_t    nodes[SIM_MAX_NODES];
+
+    pthread_mutex_t     lock;
+    pthread_cond_t      wake;
+    int64_t             air_free_us;
+    uint64_t            rng;
+    uint64_t            seq;
+
+    // Pending deliveries (binary min-heap on at_us, seq)
+    sim_frame_t       **heap;
+    size_t              heap_len;
+    size_t              heap_cap;
+
+    sim_net_stats_t     stats;
+    pthread_t           scheduler;
+    bool                outage;
+} g_net;
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+/**
+ * @brief Uniform [0, 1) from a xorshift64* generator (caller holds the lock)
+ */
+static double rand_unit(void)
+{
+    g_net.rng ^= g_net.rng >> 12;
+    g_net.rng ^= g_net.rng << 25;
+    g_net.rng ^= g_net.rng >> 27;
+    return ((g_net.rng * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Decide whether one receiver misses a frame (caller holds the lock)
+ */
+static bool frame_lost(void)
+{
+    return g_net.outage || rand_unit() < g_net.config.loss;
+}
+
+static int node_by_mac(const uint8_t *mac)
+{
+    for (int i = 0; i < g_net.node_count; i++) {
+        if (g_net.nodes[i].attached && memcmp(g_net.nodes[i].mac, mac, 6) == 0) {
+            return i;
+        }
+    }
+    return SIM_NO_NODE;
+}
+
+static int64_t airtime_us(size_t len, bool unicast)
+{
+    int64_t us = SIM_PREAMBLE_US +
+                 (int64_t)((len + SIM_MAC_HEADER_BYTES) * 8 * 1000.0 / g_net.config.rate_kbps);
+    return unicast ? us + SIM_ACK_US : us;
+}
+
+static bool frame_before(const sim_frame_t *a, const sim_frame_t *b)
+{
+    return a->at_us < b->at_us || (a->at_us == b->at_us && a->seq < b->seq);
+}
+
+static void heap_push(sim_frame_t *frame)
+{
+    if (g_net.heap_len == g_net.heap_cap) {
+        size_t cap = g_net.heap_cap ? g_net.heap_cap * 2 : 256;
+        sim_frame_t **heap = realloc(g_net.heap, cap * sizeof(*heap));
+        if (!heap) {
+            free(frame);
+            return;
+        }
+        g_net.heap = heap;
+        g_net.heap_cap = cap;
+    }
+
+    size_t i = g_net.heap_len++;
+    g_net.heap[i] = frame;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!frame_before(g_net.heap[i], g_net.heap[parent])) {
+            break;
+        }
+        sim_frame_t *tmp = g_net.heap[i];
+        g_net.heap[i] = g_net.heap[parent];
+        g_net.heap[parent] = tmp;
+        i = parent;
+    }
+}
+
+static sim_frame_t *heap_pop(void)
+{
+    sim_frame_t *top = g_net.heap[0];
+    g_net.heap[0] = g_net.heap[--g_net.heap_len];
+
+    size_t i = 0;
+    for (;;) {
+        size_t left = 2 * i + 1, right = left + 1, min = i;
+        if (left < g_net.heap_len && frame_before(g_net.heap[left], g_net.heap[min])) {
+            min = left;
+        }
+        if (right < g_net.heap_len && frame_before(g_net.heap[right], g_net.heap[min])) {
+            min = right;
+        }
+        if (min == i) {
+            break;
+        }
+        sim_frame_t *tmp = g_net.heap[i];
+        g_net.heap[i] = g_net.heap[min];
+        g_net.heap[min] = tmp;
+        i = min;
+    }
+    return top;
+}
+
+/**
+ * @brief Schedule one copy of a frame for a receiver (caller holds the lock)
+ */
+static void schedule_delivery(int dst, int src, const char *data, size_t len, int64_t off_air_us)
+{
+    double delay_ms = g_net.config.latency_ms + rand_unit() * g_net.config.jitter_ms;
+    if (rand_unit() < g_net.config.reorder) {
+        delay_ms += rand_unit() * g_net.config.reorder_ms;
+    }
+
+    sim_frame_t *frame = malloc(sizeof(*frame));
+    if (!frame) {
+        return;
+    }
+    frame->at_us = off_air_us + (int64_t)(delay_ms * 1000);
+    frame->seq = g_net.seq++;
+    frame->dst = dst;
+    memcpy(frame->evt.src_mac, g_net.nodes[src].mac, 6);
+    memcpy(frame->evt.data, data, len);
+    frame->evt.len = len;
+    heap_push(frame);
+}
+
+// ============================================================================
+// Delivery
+// ============================================================================
+
+/**
+ * @brief Harness thread: move frames into RX queues when they arrive
+ */
+static void *scheduler_thread(void *arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&g_net.lock);
+    for (;;) {
+        if (g_net.heap_len == 0) {
+            pthread_cond_wait(&g_net.wake, &g_net.lock);
+            continue;
+        }
+
+        int64_t wait_us = g_net.heap[0]->at_us - sim_now_us();
+        if (wait_us > 0) {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            int64_t ns = ts.tv_nsec + (int64_t)(wait_us * 1000 / sim_clock_speed());
+            ts.tv_sec += ns / 1000000000LL;
+            ts.tv_nsec = ns % 1000000000LL;
+            pthread_cond_timedwait(&g_net.wake, &g_net.lock, &ts);
+            continue;
+        }
+
+        sim_frame_t *frame = heap_pop();
+        sim_radio_node_t *node = &g_net.nodes[frame->dst];
+        if (xQueueSend(node->rx_queue, &frame->evt, 0) == pdTRUE) {
+            g_net.stats.frames_delivered++;
+        } else {
+            g_net.stats.rx_overflows++;
+        }
+        free(frame);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Node task: same as espnow_rx_task()
+ */
+static void rx_task(void *pvParameters)
+{
+    sim_radio_node_t *node = pvParameters;
+    sim_rx_event_t evt;
+
+    while (1) {
+        if (xQueueReceive(node->rx_queue, &evt, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        node->rx.receive(&cluster_transport_espnow, evt.src_mac, (char *)evt.data, evt.len);
+    }
+}
+
+// ============================================================================
+// Setup
+// ============================================================================
+
+esp_err_t sim_transport_init(const sim_net_config_t *config, int node_count)
+{
+    if (!config || node_count <= 0 || node_count > SIM_MAX_NODES || config->rate_kbps <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(&g_net, 0, sizeof(g_net));
+    g_net.config = *config;
+    g_net.node_count = node_count;
+    g_net.rng = config->seed ? config->seed : 0x9E3779B97F4A7C15ULL;
+    pthread_mutex_init(&g_net.lock, NULL);
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_net.wake, &attr);
+    pthread_condattr_destroy(&attr);
+
+    for (int i = 0; i < node_count; i++) {
+        uint8_t mac[6] = {0x02, 0xC1, 0xA5, 0x00, (uint8_t)(i >> 8), (uint8_t)i};
+        memcpy(g_net.nodes[i].mac, mac, 6);
+    }
+
+    if (pthread_create(&g_net.scheduler, NULL, scheduler_thread, NULL) != 0) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t sim_transport_attach(int node_id, const sim_node_rx_t *rx)
+{
+    if (node_id < 0 || node_id >= g_net.node_count || !rx || !rx->receive) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    sim_radio_node_t *node = &g_net.nodes[node_id];
+    node->rx = *rx;
+    node->rx_queue = xQueueCreate(SIM_RX_QUEUE_SIZE, sizeof(sim_rx_event_t));
+    node->send_mutex = xSemaphoreCreateMutex();
+    if (!node->rx_queue || !node->send_mutex) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(rx_task, "espnow_rx", 4096, node, 5, NULL) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    pthread_mutex_lock(&g_net.lock);
+    node->attached = true;
+    pthread_mutex_unlock(&g_net.lock);
+    return ESP_OK;
+}
+
+void sim_transport_node_mac(int node, uint8_t *mac)
+{
+    if (node >= 0 && node < g_net.node_count && mac) {
+        memcpy(mac, g_net.nodes[node].mac, 6);
+    }
+}
+
+void sim_transport_set_outage(bool down)
+{
+    pthread_mutex_lock(&g_net.lock);
+    g_net.outage = down;
+    pthread_mutex_unlock(&g_net.lock);
+}
+
+void sim_transport_get_stats(sim_net_stats_t *stats)
+{
+    pthread_mutex_lock(&g_net.lock);
+    *stats = g_net.stats;
+    pthread_mutex_unlock(&g_net.lock);
+}
+
+// ============================================================================
+// Transport backend (as used by cluster_transport.c)
+// ============================================================================
+
+esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type)
+{
+    (void)type;
+    int self = sim_current_node();
+    if (!mac || self < 0 || self >= g_net.node_count) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    memcpy(mac, g_net.nodes[self].mac, 6);
+    return ESP_OK;
+}
+
+static esp_err_t sim_espnow_send(const uint8_t *dest_mac, const char *data, size_t len)
+{
+    int self = sim_current_node();
+    if (self < 0 || self >= g_net.node_count || !g_net.nodes[self].attached) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!data || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len > SIM_FRAME_MAX) {
+        ESP_LOGE(TAG, "Message too large for ESP-NOW: %d bytes", (int)len);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    sim_radio_node_t *node = &g_net.nodes[self];
+    if (xSemaphoreTake(node->send_mutex, pdMS_TO_TICKS(SIM_SEND_TIMEOUT_MS)) != pdTRUE) {
+        pthread_mutex_lock(&g_net.lock);
+        g_net.stats.send_timeouts++;
+        pthread_mutex_unlock(&g_net.lock);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    bool broadcast = !dest_mac || memcmp(dest_mac, BROADCAST_MAC, 6) == 0;
+
+    pthread_mutex_lock(&g_net.lock);
+
+    // Queue behind whatever is already on the air
+    int64_t now = sim_now_us();
+    int64_t start = now > g_net.air_free_us ? now : g_net.air_free_us;
+    int64_t air = airtime_us(len, !broadcast);
+    int64_t off_air = start + air;
+    g_net.air_free_us = off_air;
+
+    g_net.stats.frames_sent++;
+    g_net.stats.air_us += air;
+    if (broadcast) {
+        g_net.stats.broadcasts++;
+    }
+    if (self == SIM_MASTER_NODE) {
+        g_net.stats.master_tx++;
+    }
+
+    bool acked = false;
+    if (broadcast) {
+        for (int i = 0; i < g_net.node_count; i++) {
+            if (i == self || !g_net.nodes[i].attached) {
+                continue;
+            }
+            if (frame_lost()) {
+                g_net.stats.frames_lost++;
+                continue;
+            }
+            schedule_delivery(i, self, data, len, off_air);
+        }
+    } else {
+        int dst = node_by_mac(dest_mac);
+        if (dst != SIM_NO_NODE && dst != self) {
+            if (frame_lost()) {
+                g_net.stats.frames_lost++;
+            } else {
+                schedule_delivery(dst, self, data, len, off_air);
+                acked = !frame_lost();
+            }
+        }
+        if (!acked) {
+            g_net.stats.unicast_no_ack++;
+        }
+    }
+
+    pthread_cond_signal(&g_net.wake);
+    pthread_mutex_unlock(&g_net.lock);
+
+    // Wait for the send callback
+    int64_t wait_us = off_air - now;
+    if (wait_us > SIM_SEND_TIMEOUT_MS * 1000) {
+        sim_sleep_us(SIM_SEND_TIMEOUT_MS * 1000);
+        pthread_mutex_lock(&g_net.lock);
+        g_net.stats.send_timeouts++;
+        pthread_mutex_unlock(&g_net.lock);
+        xSemaphoreGive(node->send_mutex);
+        return ESP_ERR_TIMEOUT;
+    }
+    sim_sleep_us(wait_us);
+    xSemaphoreGive(node->send_mutex);
+
+    return (broadcast || acked) ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t sim_espnow_broadcast(const char *data, size_t len)
+{
+    return sim_espnow_send(NULL, data, len);
+}
+
+static esp_err_t sim_espnow_init(void)
+{
+    return ESP_OK;
+}
+
+static void sim_espnow_deinit(void)
+{
+}
+
+static bool sim_espnow_is_ready(void)
+{
+    int self = sim_current_node();
+    return self >= 0 && self < g_net.node_count && g_net.nodes[self].attached;
+}
+
+const cluster_transport_ops_t cluster_transport_espnow = {
+    .type = CLUSTER_TRANSPORT_ESPNOW,
+    .name = "espnow",
+    .max_msg_size = SIM_FRAME_MAX,
+    .work_sends = 3,
+    .discovery = true,
+    .init = sim_espnow_init,
+    .deinit = sim_espnow_deinit,
+    .is_ready = sim_espnow_is_ready,
+    .send = sim_espnow_send,
+    .broadcast = sim_espnow_broadcast,
+};
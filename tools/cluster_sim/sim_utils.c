@@ -0,0 +1,133 @@
+/**
+ * @file sim_utils.c
+ * @brief Clusteraxe host simulator: stratum hashing helpers
+ *
+ * Host versions of the components/stratum utils.c functions the cluster
+ * core uses (shim/utils.h). SHA-256 is a plain FIPS 180-4 implementation
+ * standing in for mbedtls; le256todouble() matches utils.c.
+ *
+ * A host core hashes a few million headers a second, not a TH/s, so the
+ * cluster bench builds this with SIM_DIFF_SHIFT: le256todouble() then
+ * reads every hash as 2^SIM_DIFF_SHIFT times harder, for the master's
+ * share verification and the simulated ASICs alike.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <math.h>
+#include <string.h>
+#include "utils.h"
+
+#ifndef SIM_DIFF_SHIFT
+    #define SIM_DIFF_SHIFT      0
+#endif
+
+// ============================================================================
+// SHA-256
+// ============================================================================
+
+static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+#define ROR(x, n)   (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha256_block(uint32_t state[8], const uint8_t block[64])
+{
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 |
+               (uint32_t)block[i * 4 + 2] << 8 | block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = ROR(w[i - 15], 7) ^ ROR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ROR(w[i - 2], 17) ^ ROR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = h + (ROR(e, 6) ^ ROR(e, 11) ^ ROR(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+        uint32_t t2 = (ROR(a, 2) ^ ROR(a, 13) ^ ROR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+static void sha256(const uint8_t *data, size_t len, uint8_t out[32])
+{
+    uint32_t state[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+
+    size_t pos = 0;
+    for (; pos + 64 <= len; pos += 64) {
+        sha256_block(state, data + pos);
+    }
+
+    uint8_t tail[128] = {0};
+    size_t rest = len - pos;
+    memcpy(tail, data + pos, rest);
+    tail[rest] = 0x80;
+    size_t tail_len = rest + 9 <= 64 ? 64 : 128;
+    uint64_t bits = (uint64_t)len * 8;
+    for (int i = 0; i < 8; i++) {
+        tail[tail_len - 1 - i] = (uint8_t)(bits >> (i * 8));
+    }
+    for (size_t off = 0; off < tail_len; off += 64) {
+        sha256_block(state, tail + off);
+    }
+
+    for (int i = 0; i < 8; i++) {
+        out[i * 4]     = state[i] >> 24;
+        out[i * 4 + 1] = state[i] >> 16;
+        out[i * 4 + 2] = state[i] >> 8;
+        out[i * 4 + 3] = state[i];
+    }
+}
+
+void double_sha256_bin(const uint8_t *data, const size_t data_len, uint8_t dest[32])
+{
+    uint8_t first[32];
+    sha256(data, data_len, first);
+    sha256(first, sizeof(first), dest);
+}
+
+// ============================================================================
+// Byte order and difficulty
+// ============================================================================
+
+void reverse_endianness_per_word(uint8_t data[32])
+{
+    for (int i = 0; i < 32; i += 4) {
+        uint8_t b0 = data[i], b1 = data[i + 1];
+        data[i] = data[i + 3];
+        data[i + 1] = data[i + 2];
+        data[i + 2] = b1;
+        data[i + 3] = b0;
+    }
+}
+
+static const double bits192 = 6277101735386680763835789423207666416102355444464034512896.0;
+static const double bits128 = 340282366920938463463374607431768211456.0;
+static const double bits64 = 18446744073709551616.0;
+
+double le256todouble(const void *target)
+{
+    uint64_t w[4];
+    memcpy(w, target, sizeof(w));
+    return ldexp(w[3] * bits192 + w[2] * bits128 + w[1] * bits64 + w[0], -SIM_DIFF_SHIFT);
+}
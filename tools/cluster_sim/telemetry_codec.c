@@ -0,0 +1,336 @@
+/**
+ * @file telemetry_codec.c
+ * @brief Binary delta telemetry codec checks
+ *
+ * Drives cluster_telemetry.c and the $CLTLM / $CLTAK sentences from
+ * cluster_protocol.c the way a slave and its master do, over a lossy link.
+ *
+ * Checks:
+ *   - keyframes and deltas round-trip through the sentence exactly
+ *   - a delta carries only the fields that changed since the acked frame
+ *   - lost acks keep deltas decodable; the sender falls back to a keyframe
+ *     before it runs out of history
+ *   - a delta against a reference the receiver lacks is NAKed, and the
+ *     next frame is a keyframe that resynchronizes
+ *   - malformed frames are rejected
+ *   - a steady-state stream of telemetry is a fraction of the bytes of
+ *     text heartbeats at the same rate
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cluster.h"
+#include "cluster_protocol.h"
+#include "cluster_telemetry.h"
+
+#define TEST_NODE           3
+#define TEST_FRAMES         600         // Ten minutes at 1 s
+#define TEST_ACK_EVERY      3           // Master acks once per 3 s heartbeat
+#define TEST_LOSS_PERCENT   10
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+int64_t esp_timer_get_time(void)
+{
+    return 0;
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    return code == ESP_OK ? "ESP_OK" : "ESP_ERR";
+}
+
+static uint32_t g_rng = 0x2468ACE1;
+
+static uint32_t sim_rand(void)
+{
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return g_rng >> 8;
+}
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static void sample_board(int t, cluster_heartbeat_data_t *hb, cluster_board_telemetry_t *board)
+{
+    memset(hb, 0, sizeof(*hb));
+    hb->slave_id = TEST_NODE;
+    hb->hashrate = 120000 + (sim_rand() % 3) * 100;     // GH/s * 100, jitters
+    hb->temp = 55.0f + (t / 60) * 0.1f;
+    hb->fan_rpm = 3000;
+    hb->shares = (uint32_t)(t / 20);
+    hb->frequency = 525;
+    hb->core_voltage = 1150;
+    hb->power = 18.5f;
+    hb->voltage_in = 5.1f;
+
+    memset(board, 0, sizeof(*board));
+    board->chip_temp2 = 53.5f;
+    board->vr_temp = 61.0f + (t / 90) * 0.5f;
+    board->fan2_rpm = 2990;
+    board->error_percent = 0.25f;
+    board->asic_count = 2;
+    board->asic_hashrate[0] = 600.0f;
+    board->asic_hashrate[1] = 600.0f + (t % 7 == 0 ? 1 : 0);
+    board->asic_error[0] = 0.2f;
+    board->asic_error[1] = 0.3f;
+}
+
+/**
+ * @brief Encode a sample into a $CLTLM sentence and parse it back to a frame
+ */
+static int send_frame(cluster_telemetry_tx_t *tx, const cluster_telemetry_t *sample,
+                      bool force_key, uint8_t *frame, size_t *frame_len, int *sentence_len)
+{
+    uint8_t raw[CLUSTER_TLM_MAX_FRAME];
+    int raw_len = cluster_telemetry_encode(tx, sample, force_key, raw, sizeof(raw));
+    CHECK(raw_len > 0, "telemetry encode failed");
+    if (raw_len <= 0) {
+        return -1;
+    }
+
+    char msg[CLUSTER_MSG_MAX_LEN];
+    int len = cluster_protocol_encode_telemetry(TEST_NODE, raw, raw_len, NULL, msg, sizeof(msg));
+    CHECK(len > 0, "sentence encode failed");
+    CHECK(cluster_protocol_verify_checksum(msg), "bad checksum: %s", msg);
+    *sentence_len = len;
+
+    char type[6];
+    const char *payload;
+    CHECK(cluster_protocol_parse_message(msg, type, &payload) == ESP_OK &&
+          strcmp(type, BAP_MSG_TELEMETRY) == 0, "sentence type wrong: %s", msg);
+
+    uint16_t node = 0;
+    CHECK(cluster_protocol_decode_telemetry(payload, &node, frame, CLUSTER_TLM_MAX_FRAME,
+                                            frame_len, NULL) == ESP_OK, "sentence decode failed");
+    CHECK(node == TEST_NODE, "node %u", node);
+    CHECK(*frame_len == (size_t)raw_len && memcmp(frame, raw, raw_len) == 0,
+          "frame changed in transit");
+    return raw_len;
+}
+
+static void ack_roundtrip(cluster_telemetry_tx_t *tx, uint8_t seq, bool ok)
+{
+    char msg[48];
+    int len = cluster_protocol_encode_telemetry_ack(TEST_NODE, seq, ok, 0, msg, sizeof(msg));
+    CHECK(len > 0, "ack encode failed");
+
+    char type[6];
+    const char *payload;
+    uint16_t node = 0;
+    uint8_t got_seq = 0;
+    bool got_ok = !ok;
+    CHECK(cluster_protocol_parse_message(msg, type, &payload) == ESP_OK &&
+          cluster_protocol_decode_telemetry_ack(payload, &node, &got_seq, &got_ok, NULL) == ESP_OK,
+          "ack decode failed: %s", msg);
+    CHECK(node == TEST_NODE && got_seq == seq && got_ok == ok, "ack fields differ: %s", msg);
+
+    cluster_telemetry_tx_on_ack(tx, got_seq, got_ok);
+}
+
+// ============================================================================
+// Checks
+// ============================================================================
+
+static void check_deltas(void)
+{
+    cluster_telemetry_tx_t tx = {0};
+    cluster_telemetry_rx_t rx;
+    cluster_telemetry_tx_reset(&tx, 30);
+    cluster_telemetry_rx_reset(&rx);
+
+    cluster_heartbeat_data_t hb;
+    cluster_board_telemetry_t board;
+    sample_board(0, &hb, &board);
+    cluster_telemetry_t a;
+    cluster_telemetry_build(&a, &hb, &board, 0);
+
+    uint8_t frame[CLUSTER_TLM_MAX_FRAME];
+    size_t frame_len;
+    int sentence;
+    uint8_t seq;
+    bool key;
+
+    int key_len = send_frame(&tx, &a, false, frame, &frame_len, &sentence);
+    CHECK(cluster_telemetry_decode(&rx, frame, frame_len, &seq, &key) == ESP_OK && key,
+          "first frame is not a decodable keyframe");
+    CHECK(memcmp(&rx.current, &a, sizeof(a)) == 0, "keyframe round trip differs");
+
+    cluster_heartbeat_data_t back;
+    cluster_telemetry_to_heartbeat(&rx.current, TEST_NODE, &back);
+    CHECK(back.hashrate == hb.hashrate && back.frequency == hb.frequency &&
+          back.core_voltage == hb.core_voltage && back.fan_rpm == hb.fan_rpm,
+          "heartbeat view differs");
+
+    CHECK(cluster_telemetry_rx_ack_due(&rx, key, 0, 3000), "keyframe not acked");
+    ack_roundtrip(&tx, seq, true);
+
+    // Unchanged sample: header, ref and an empty mask
+    int len = send_frame(&tx, &a, false, frame, &frame_len, &sentence);
+    CHECK(len == 4, "unchanged delta is %d bytes", len);
+    CHECK(cluster_telemetry_decode(&rx, frame, frame_len, &seq, &key) == ESP_OK && !key,
+          "unchanged delta not decoded");
+    CHECK(memcmp(&rx.current, &a, sizeof(a)) == 0, "unchanged delta differs");
+    CHECK(!cluster_telemetry_rx_ack_due(&rx, key, 1000, 3000), "delta acked before interval");
+
+    // Two fields change: only they are sent
+    cluster_telemetry_t b = a;
+    b.v[CLUSTER_TLM_VR_TEMP] += 5;
+    b.v[CLUSTER_TLM_ASIC_HASHRATE + 1] -= 3;
+    len = send_frame(&tx, &b, false, frame, &frame_len, &sentence);
+    CHECK(cluster_telemetry_decode(&rx, frame, frame_len, &seq, &key) == ESP_OK,
+          "two-field delta not decoded");
+    CHECK(memcmp(&rx.current, &b, sizeof(b)) == 0, "two-field delta differs");
+    CHECK(len == 3 + 3 + 1 + 1, "two-field delta is %d bytes (keyframe %d)", len, key_len);
+}
+
+static void check_nak(void)
+{
+    cluster_telemetry_tx_t tx = {0};
+    cluster_telemetry_rx_t rx;
+    cluster_telemetry_tx_reset(&tx, 30);
+    cluster_telemetry_rx_reset(&rx);
+
+    cluster_heartbeat_data_t hb;
+    cluster_board_telemetry_t board;
+    sample_board(0, &hb, &board);
+    cluster_telemetry_t a;
+    cluster_telemetry_build(&a, &hb, &board, 1);
+
+    uint8_t frame[CLUSTER_TLM_MAX_FRAME];
+    size_t frame_len;
+    int sentence;
+    uint8_t seq;
+    bool key;
+
+    send_frame(&tx, &a, false, frame, &frame_len, &sentence);
+    cluster_telemetry_decode(&rx, frame, frame_len, &seq, &key);
+    cluster_telemetry_rx_ack_due(&rx, key, 0, 3000);
+    ack_roundtrip(&tx, seq, true);
+
+    // Receiver restarts (master reboot): the sender's reference is gone
+    cluster_telemetry_rx_reset(&rx);
+    send_frame(&tx, &a, false, frame, &frame_len, &sentence);
+    CHECK(cluster_telemetry_decode(&rx, frame, frame_len, &seq, &key) == ESP_ERR_NOT_FOUND,
+          "delta against unknown reference not detected");
+    ack_roundtrip(&tx, seq, false);
+
+    send_frame(&tx, &a, false, frame, &frame_len, &sentence);
+    CHECK(cluster_telemetry_decode(&rx, frame, frame_len, &seq, &key) == ESP_OK && key,
+          "NAK did not produce a keyframe");
+    CHECK(memcmp(&rx.current, &a, sizeof(a)) == 0, "resync keyframe differs");
+
+    // Malformed input
+    uint8_t bad[CLUSTER_TLM_MAX_FRAME];
+    memcpy(bad, frame, frame_len);
+    bad[0] = (uint8_t)((CLUSTER_TLM_VERSION + 1) << 4) | CLUSTER_TLM_FLAG_KEY;
+    CHECK(cluster_telemetry_decode(&rx, bad, frame_len, &seq, &key) == ESP_ERR_INVALID_VERSION,
+          "unknown version accepted");
+    CHECK(cluster_telemetry_decode(&rx, frame, frame_len - 1, &seq, &key) == ESP_ERR_INVALID_SIZE,
+          "truncated frame accepted");
+    CHECK(cluster_protocol_decode_telemetry("3,AB!C", NULL, bad, sizeof(bad), &frame_len, NULL) != ESP_OK,
+          "bad base64 accepted");
+}
+
+/**
+ * @brief Stream over a lossy link and compare bytes with text heartbeats
+ */
+static void check_stream(void)
+{
+    cluster_telemetry_tx_t tx = {0};
+    cluster_telemetry_rx_t rx;
+    cluster_telemetry_tx_reset(&tx, CLUSTER_TELEMETRY_KEYFRAME);
+    cluster_telemetry_rx_reset(&rx);
+
+    long tlm_bytes = 0, text_bytes = 0;
+    int frames = 0, delivered = 0, keyframes = 0, naks = 0, mismatches = 0;
+
+    for (int t = 0; t < TEST_FRAMES; t++) {
+        cluster_heartbeat_data_t hb;
+        cluster_board_telemetry_t board;
+        sample_board(t, &hb, &board);
+        cluster_telemetry_t sample;
+        cluster_telemetry_build(&sample, &hb, &board, 0);
+
+        // Text heartbeat at the same rate, for comparison
+        char text[CLUSTER_MSG_MAX_LEN];
+        text_bytes += cluster_protocol_encode_heartbeat_ex(&hb, text, sizeof(text));
+
+        uint8_t frame[CLUSTER_TLM_MAX_FRAME];
+        size_t frame_len;
+        int sentence = 0;
+        send_frame(&tx, &sample, false, frame, &frame_len, &sentence);
+        tlm_bytes += sentence;
+        frames++;
+
+        if (sim_rand() % 100 < TEST_LOSS_PERCENT) {
+            continue;
+        }
+        delivered++;
+
+        uint8_t seq;
+        bool key;
+        esp_err_t ret = cluster_telemetry_decode(&rx, frame, frame_len, &seq, &key);
+        if (ret == ESP_ERR_NOT_FOUND) {
+            naks++;
+            if (sim_rand() % 100 >= TEST_LOSS_PERCENT) {
+                ack_roundtrip(&tx, seq, false);
+            }
+            continue;
+        }
+        CHECK(ret == ESP_OK, "frame %d not decoded", t);
+        if (ret != ESP_OK) {
+            continue;
+        }
+        keyframes += key;
+        mismatches += memcmp(&rx.current, &sample, sizeof(sample)) != 0;
+
+        if (cluster_telemetry_rx_ack_due(&rx, key, (int64_t)t * 1000, TEST_ACK_EVERY * 1000) &&
+            sim_rand() % 100 >= TEST_LOSS_PERCENT) {
+            ack_roundtrip(&tx, seq, true);
+        }
+    }
+
+    double ratio = (double)tlm_bytes / text_bytes;
+    printf("  stream: %d frames, %d delivered, %d keyframes, %d NAKs, %.1f bytes/frame "
+           "vs %.1f text (%.0f%%)\n",
+           frames, delivered, keyframes, naks, (double)tlm_bytes / frames,
+           (double)text_bytes / frames, ratio * 100);
+
+    CHECK(mismatches == 0, "%d decoded frames differ from what was sent", mismatches);
+    CHECK(delivered - naks > delivered * 9 / 10, "too many undecodable frames: %d", naks);
+    CHECK(ratio < 0.5, "telemetry is %.0f%% of text heartbeat bytes", ratio * 100);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(void)
+{
+    printf("telemetry_codec: %d fields, max frame %d bytes\n",
+           CLUSTER_TLM_FIELD_COUNT, CLUSTER_TLM_MAX_FRAME);
+
+    check_deltas();
+    check_nak();
+    check_stream();
+
+    printf("telemetry_codec: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
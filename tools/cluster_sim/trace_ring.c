@@ -0,0 +1,386 @@
+/**
+ * @file trace_ring.c
+ * @brief Job/share trace ring, $CLTRC and latency summary checks
+ *
+ * Drives cluster_trace.c the way the firmware does: tasks recording from
+ * several threads at once, the slave's uploader reading behind them with
+ * a cursor, and the master summarizing what it holds.
+ *
+ * Checks:
+ *   - records survive packing and the $CLTRC sentence, a full upload fits
+ *     an ESP-NOW frame, and malformed records are refused
+ *   - a reader behind the writers gets every record intact or counts it
+ *     lost, never a torn one, with four threads writing flat out
+ *   - a reader that falls a ring behind is told how many it missed
+ *   - latencies pair each stage with the right job, slave and nonce, use
+ *     either pool answer, skip rebroadcast work and leave out unsynced
+ *     slave records
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cluster.h"
+#include "cluster_protocol.h"
+#include "cluster_trace.h"
+
+#define TEST_WRITERS        4
+#define TEST_PER_WRITER     200000
+#define ESPNOW_MAX_PAYLOAD  250
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+static _Atomic int64_t g_now_us;
+
+int64_t esp_timer_get_time(void)
+{
+    return atomic_fetch_add(&g_now_us, 1);
+}
+
+// ============================================================================
+// Wire format
+// ============================================================================
+
+static void check_wire(void)
+{
+    cluster_trace_record_t recs[CLUSTER_TRACE_UPLOAD_RECORDS];
+    for (int i = 0; i < CLUSTER_TRACE_UPLOAD_RECORDS; i++) {
+        recs[i] = (cluster_trace_record_t){
+            .ts_us = 31536000123456LL + i * 977,   // A year of uptime
+            .job_id = 0xDEADBEEF - i,
+            .aux = 0xFFFFFFFFu - i * 0x01010101u,
+            .node = i == 0 ? 0x0203 : (uint16_t)i,
+            .stage = (uint8_t)(CLUSTER_TRACE_NOTIFY + i % (CLUSTER_TRACE_STAGE_COUNT - 1)),
+        };
+    }
+
+    uint8_t packed[CLUSTER_TRACE_UPLOAD_RECORDS * CLUSTER_TRACE_WIRE_SIZE];
+    int packed_len = cluster_trace_pack(recs, CLUSTER_TRACE_UPLOAD_RECORDS, packed, sizeof(packed));
+    CHECK(packed_len == (int)sizeof(packed), "packed %d bytes", packed_len);
+    CHECK(cluster_trace_pack(recs, CLUSTER_TRACE_UPLOAD_RECORDS, packed, sizeof(packed) - 1) < 0,
+          "pack overran its buffer");
+
+    // Worst case for the text fields, as the slave's 250-byte payload
+    char msg[ESPNOW_MAX_PAYLOAD];
+    int len = cluster_protocol_encode_trace(0xFFFF, 0xFFFFFFFFu, packed, packed_len, msg, sizeof(msg));
+    CHECK(len > 0 && len <= ESPNOW_MAX_PAYLOAD, "full $CLTRC is %d bytes", len);
+    printf("  $CLTRC with %d records: %d bytes\n", CLUSTER_TRACE_UPLOAD_RECORDS, len);
+
+    char type[6];
+    const char *payload = NULL;
+    CHECK(cluster_protocol_verify_checksum(msg), "bad checksum: %s", msg);
+    CHECK(cluster_protocol_parse_message(msg, type, &payload) == ESP_OK &&
+          strcmp(type, BAP_MSG_TRACE) == 0, "sentence type wrong: %s", msg);
+
+    uint16_t node = 0;
+    uint32_t lost = 0;
+    uint8_t got[sizeof(packed)];
+    size_t got_len = 0;
+    CHECK(cluster_protocol_decode_trace(payload, &node, &lost, got, sizeof(got), &got_len) == ESP_OK &&
+          node == 0xFFFF && lost == 0xFFFFFFFFu && got_len == sizeof(packed),
+          "$CLTRC fields differ: %s", msg);
+    CHECK(cluster_protocol_decode_trace(payload, &node, &lost, got, sizeof(got) - 1, &got_len) != ESP_OK,
+          "decode overran its buffer");
+
+    cluster_trace_record_t back[CLUSTER_TRACE_UPLOAD_RECORDS];
+    int count = cluster_trace_unpack(got, sizeof(packed), back, CLUSTER_TRACE_UPLOAD_RECORDS);
+    CHECK(count == CLUSTER_TRACE_UPLOAD_RECORDS, "unpacked %d records", count);
+    for (int i = 0; i < count; i++) {
+        CHECK(memcmp(&back[i], &recs[i], sizeof(recs[i])) == 0, "record %d differs", i);
+    }
+
+    // Truncated, oversized and unknown-stage uploads
+    CHECK(cluster_trace_unpack(got, sizeof(packed) - 1, back, CLUSTER_TRACE_UPLOAD_RECORDS) < 0,
+          "partial record accepted");
+    CHECK(cluster_trace_unpack(got, sizeof(packed), back, CLUSTER_TRACE_UPLOAD_RECORDS - 1) < 0,
+          "too many records accepted");
+    got[18] = CLUSTER_TRACE_STAGE_COUNT;
+    CHECK(cluster_trace_unpack(got, sizeof(packed), back, CLUSTER_TRACE_UPLOAD_RECORDS) < 0,
+          "unknown stage accepted");
+}
+
+// ============================================================================
+// Ring
+// ============================================================================
+
+// Every field derives from (writer, seq) so a torn record is detectable
+static uint32_t job_of(int writer, uint32_t seq)
+{
+    return (uint32_t)writer << 24 | seq;
+}
+
+static uint32_t aux_of(uint32_t job)
+{
+    return job * 2654435761u;
+}
+
+typedef struct {
+    atomic_bool done;           // Set once every writer has returned
+    uint64_t    read;
+    uint64_t    lost;
+    uint64_t    torn;
+    uint64_t    regress;
+} reader_state_t;
+
+static void *writer_thread(void *arg)
+{
+    int writer = (int)(intptr_t)arg;
+    for (uint32_t seq = 0; seq < TEST_PER_WRITER; seq++) {
+        uint32_t job = job_of(writer, seq);
+        cluster_trace_record(CLUSTER_TRACE_SHARE_FOUND, (uint16_t)(job ^ (job >> 16)), job, aux_of(job));
+        if ((seq & 63) == 63) {
+            sched_yield();      // Let the reader overlap the writers
+        }
+    }
+    return NULL;
+}
+
+// Reads behind the writers like the slave's uploader, then drains the rest
+static void *reader_thread(void *arg)
+{
+    reader_state_t *st = arg;
+    uint32_t cursor = 0;
+    uint32_t last_seq[TEST_WRITERS];
+    memset(last_seq, 0xFF, sizeof(last_seq));
+
+    for (;;) {
+        bool done = atomic_load(&st->done);
+
+        cluster_trace_record_t batch[CLUSTER_TRACE_UPLOAD_RECORDS];
+        uint32_t batch_lost = 0;
+        size_t n = cluster_trace_read(&cursor, batch, CLUSTER_TRACE_UPLOAD_RECORDS, &batch_lost);
+        st->lost += batch_lost;
+        st->read += n;
+
+        for (size_t i = 0; i < n; i++) {
+            const cluster_trace_record_t *r = &batch[i];
+            uint32_t writer = r->job_id >> 24;
+            uint32_t seq = r->job_id & 0xFFFFFF;
+            if (writer >= TEST_WRITERS || r->aux != aux_of(r->job_id) ||
+                r->node != (uint16_t)(r->job_id ^ (r->job_id >> 16)) ||
+                r->stage != CLUSTER_TRACE_SHARE_FOUND) {
+                st->torn++;
+                continue;
+            }
+            // Each writer's records come out in the order it wrote them
+            if (last_seq[writer] != 0xFFFFFFFFu && seq <= last_seq[writer]) {
+                st->regress++;
+            }
+            last_seq[writer] = seq;
+        }
+
+        if (done && n == 0 && batch_lost == 0) {
+            return NULL;
+        }
+    }
+}
+
+static void check_concurrent(void)
+{
+    cluster_trace_reset();
+
+    reader_state_t st = {0};
+    pthread_t reader;
+    pthread_t writers[TEST_WRITERS];
+    pthread_create(&reader, NULL, reader_thread, &st);
+    for (int i = 0; i < TEST_WRITERS; i++) {
+        pthread_create(&writers[i], NULL, writer_thread, (void *)(intptr_t)i);
+    }
+    for (int i = 0; i < TEST_WRITERS; i++) {
+        pthread_join(writers[i], NULL);
+    }
+    atomic_store(&st.done, true);
+    pthread_join(reader, NULL);
+
+    uint64_t total = (uint64_t)TEST_WRITERS * TEST_PER_WRITER;
+    printf("  %d writers x %d records into %d slots: read %llu, lost %llu, torn %llu\n",
+           TEST_WRITERS, TEST_PER_WRITER, CLUSTER_TRACE_SIZE,
+           (unsigned long long)st.read, (unsigned long long)st.lost, (unsigned long long)st.torn);
+
+    CHECK(cluster_trace_count() == total, "ring counted %lu records, wrote %llu",
+          (unsigned long)cluster_trace_count(), (unsigned long long)total);
+    CHECK(st.torn == 0, "%llu torn records", (unsigned long long)st.torn);
+    CHECK(st.regress == 0, "%llu records out of order", (unsigned long long)st.regress);
+    CHECK(st.read + st.lost == total, "read %llu + lost %llu != written %llu",
+          (unsigned long long)st.read, (unsigned long long)st.lost, (unsigned long long)total);
+    CHECK(st.read > 0, "reader got nothing");
+}
+
+static void check_overrun(void)
+{
+    cluster_trace_reset();
+
+    uint32_t cursor = 0;
+    cluster_trace_record_t out[CLUSTER_TRACE_SIZE];
+    uint32_t lost = 0;
+
+    for (int i = 0; i < 10; i++) {
+        cluster_trace_record(CLUSTER_TRACE_NOTIFY, CLUSTER_TRACE_NODE_MASTER, i, 0);
+    }
+    size_t n = cluster_trace_read(&cursor, out, 4, &lost);
+    CHECK(n == 4 && lost == 0 && cursor == 4 && out[0].job_id == 0 && out[3].job_id == 3,
+          "partial read: %zu records, cursor %lu", n, (unsigned long)cursor);
+
+    // Writers lap the reader by 100
+    for (int i = 10; i < 4 + CLUSTER_TRACE_SIZE + 100; i++) {
+        cluster_trace_record(CLUSTER_TRACE_NOTIFY, CLUSTER_TRACE_NODE_MASTER, i, 0);
+    }
+    n = cluster_trace_read(&cursor, out, CLUSTER_TRACE_SIZE, &lost);
+    CHECK(lost == 100, "lapped reader lost %lu, expected 100", (unsigned long)lost);
+    CHECK(n == CLUSTER_TRACE_SIZE && out[0].job_id == 104 &&
+          out[n - 1].job_id == 103 + CLUSTER_TRACE_SIZE, "lapped reader got %zu from job %lu",
+          n, (unsigned long)out[0].job_id);
+
+    // A fresh reader sees the whole ring; reset restarts it
+    uint32_t fresh = 0;
+    n = cluster_trace_read(&fresh, out, CLUSTER_TRACE_SIZE, &lost);
+    CHECK(n == CLUSTER_TRACE_SIZE, "fresh reader got %zu", n);
+    cluster_trace_reset();
+    cluster_trace_record(CLUSTER_TRACE_NOTIFY, CLUSTER_TRACE_NODE_MASTER, 7, 0);
+    n = cluster_trace_read(&cursor, out, CLUSTER_TRACE_SIZE, &lost);
+    CHECK(n == 1 && out[0].job_id == 7 && lost == 0, "reader after reset got %zu", n);
+
+    cluster_trace_add_lost(5);
+    cluster_trace_add_lost(3);
+    CHECK(cluster_trace_lost() == 8, "upload losses %lu", (unsigned long)cluster_trace_lost());
+}
+
+// ============================================================================
+// Summary
+// ============================================================================
+
+static cluster_trace_record_t g_recs[256];
+static size_t g_count;
+
+static void add(uint8_t stage, uint16_t node, uint32_t job, uint32_t aux, int64_t ms, uint8_t flags)
+{
+    g_recs[g_count++] = (cluster_trace_record_t){
+        .ts_us = ms * 1000, .job_id = job, .aux = aux, .node = node, .stage = stage, .flags = flags,
+    };
+}
+
+static const cluster_trace_span_t *span(const cluster_trace_span_t *spans, const char *name)
+{
+    for (int i = 0; i < CLUSTER_TRACE_SPAN_COUNT; i++) {
+        if (strcmp(spans[i].name, name) == 0) {
+            return &spans[i];
+        }
+    }
+    printf("FAIL: no span %s\n", name);
+    g_failures++;
+    return &spans[0];
+}
+
+static void check_summary(void)
+{
+    g_count = 0;
+    const uint16_t master = CLUSTER_TRACE_NODE_MASTER;
+
+    // Two jobs, two slaves; slave records arrive late, as uploads do
+    add(CLUSTER_TRACE_NOTIFY,      master, 1, 0, 1000, 0);
+    add(CLUSTER_TRACE_DISTRIBUTE,  0,      1, 0, 1001, 0);
+    add(CLUSTER_TRACE_DISTRIBUTE,  1,      1, 0, 1003, 0);
+    add(CLUSTER_TRACE_NOTIFY,      master, 2, 0, 2000, 0);
+    add(CLUSTER_TRACE_DISTRIBUTE,  0,      2, 0, 2001, 0);
+    add(CLUSTER_TRACE_DISTRIBUTE,  1,      2, 0, 2002, 0);
+    add(CLUSTER_TRACE_DISTRIBUTE,  0,      1, 0, 1700, 0);     // Rebroadcast
+    add(CLUSTER_TRACE_SHARE_RX,    0,      1, 0xA, 1510, 0);
+    add(CLUSTER_TRACE_SUBMIT,      0,      1, 0xA, 1511, 0);
+    add(CLUSTER_TRACE_ACCEPTED,    0,      1, 0xA, 1551, 0);
+    add(CLUSTER_TRACE_SHARE_RX,    1,      1, 0xB, 2010, 0);
+    add(CLUSTER_TRACE_DROP_STALE,  1,      1, 0xB, 2011, 0);
+    add(CLUSTER_TRACE_SHARE_RX,    1,      2, 0xC, 2600, 0);
+    add(CLUSTER_TRACE_SUBMIT,      1,      2, 0xC, 2602, 0);
+    add(CLUSTER_TRACE_REJECTED,    1,      2, 0xC, 2682, 0);
+
+    // Slave 0 (synced)
+    add(CLUSTER_TRACE_WORK_RX,     0,      1, 0, 1004, 0);
+    add(CLUSTER_TRACE_ASIC,        0,      1, 0, 1005, 0);
+    add(CLUSTER_TRACE_SHARE_FOUND, 0,      1, 0xA, 1500, 0);
+    add(CLUSTER_TRACE_SHARE_TX,    0,      1, 0xA, 1502, 0);
+    add(CLUSTER_TRACE_WORK_RX,     0,      2, 0, 2003, 0);
+    add(CLUSTER_TRACE_ASIC,        0,      2, 0, 2010, 0);
+
+    // Slave 1: its first records are from before its clock was mapped
+    add(CLUSTER_TRACE_WORK_RX,     1,      1, 0, 99999, CLUSTER_TRACE_F_UNSYNCED);
+    add(CLUSTER_TRACE_SHARE_FOUND, 1,      1, 0xB, 99999, CLUSTER_TRACE_F_UNSYNCED);
+    add(CLUSTER_TRACE_WORK_RX,     1,      2, 0, 2004, 0);
+    add(CLUSTER_TRACE_ASIC,        1,      2, 0, 2006, 0);
+    add(CLUSTER_TRACE_SHARE_FOUND, 1,      2, 0xC, 2590, 0);
+    add(CLUSTER_TRACE_SHARE_TX,    1,      2, 0xC, 2599, 0);
+
+    cluster_trace_span_t spans[CLUSTER_TRACE_SPAN_COUNT];
+    cluster_trace_summarize(g_recs, g_count, spans);
+
+    for (int i = 0; i < CLUSTER_TRACE_SPAN_COUNT; i++) {
+        printf("  %-16s %-12s -> %-12s n=%u p50 %6.1f ms p90 %6.1f ms max %6.1f ms\n",
+               spans[i].name, cluster_trace_stage_name(spans[i].from),
+               cluster_trace_stage_name(spans[i].to), spans[i].count,
+               spans[i].p50_us / 1000.0, spans[i].p90_us / 1000.0, spans[i].max_us / 1000.0);
+    }
+
+    const cluster_trace_span_t *s;
+    // Rebroadcasts are not dispatches
+    s = span(spans, "dispatch");
+    CHECK(s->count == 4 && s->p50_us == 1000 && s->max_us == 3000, "dispatch: n=%u p50 %ld max %ld",
+          s->count, (long)s->p50_us, (long)s->max_us);
+
+    // Paired by job and slave, not just job; the unsynced WORK_RX is left out
+    s = span(spans, "downlink");
+    CHECK(s->count == 3 && s->max_us == 3000, "downlink: n=%u max %ld", s->count, (long)s->max_us);
+    s = span(spans, "asic_feed");
+    CHECK(s->count == 3 && s->max_us == 7000, "asic_feed: n=%u max %ld", s->count, (long)s->max_us);
+
+    s = span(spans, "job_age");
+    CHECK(s->count == 2 && s->p50_us == 500000 && s->max_us == 590000, "job_age: n=%u p50 %ld max %ld",
+          s->count, (long)s->p50_us, (long)s->max_us);
+
+    // Paired by nonce
+    s = span(spans, "uplink");
+    CHECK(s->count == 2 && s->p50_us == 1000 && s->max_us == 8000, "uplink: n=%u p50 %ld max %ld",
+          s->count, (long)s->p50_us, (long)s->max_us);
+
+    // Either answer ends the pool span
+    s = span(spans, "pool");
+    CHECK(s->count == 2 && s->p50_us == 40000 && s->max_us == 80000, "pool: n=%u p50 %ld max %ld",
+          s->count, (long)s->p50_us, (long)s->max_us);
+
+    // The stale share's job was a second old when it was dropped
+    s = span(spans, "stale_age");
+    CHECK(s->count == 1 && s->max_us == 1011000, "stale_age: n=%u max %ld", s->count, (long)s->max_us);
+
+    cluster_trace_summarize(NULL, 0, spans);
+    CHECK(spans[0].count == 0 && spans[0].name != NULL, "empty summary");
+}
+
+int main(void)
+{
+    printf("trace_ring: %d slots, %d-byte records on the wire\n",
+           CLUSTER_TRACE_SIZE, CLUSTER_TRACE_WIRE_SIZE);
+
+    check_wire();
+    check_overrun();
+    check_concurrent();
+    check_summary();
+
+    printf("trace_ring: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,270 @@
+/**
+ * @file udp_loopback.c
+ * @brief LAN UDP transport over the Linux loopback interface
+ *
+ * Runs the real cluster_udp.c in two processes, a master and a slave, on
+ * 127.0.0.1 with a multicast group, standing in for the cluster core with
+ * a stub cluster_transport_receive().
+ *
+ * Checks:
+ *   - frame header encode/decode, oversize and foreign datagrams
+ *   - multicast from the master reaches the slave, and the master never
+ *     hears its own multicast (dropped by MAC)
+ *   - the slave can unicast to the master once it has heard from it, and
+ *     not before (ESP_ERR_NOT_FOUND)
+ *   - a message larger than an ESP-NOW frame arrives intact
+ *   - the master unicasts back to the address it learned from the slave
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "esp_mac.h"
+#include "cluster_transport.h"
+#include "cluster_udp.h"
+#include "sim.h"
+
+#define TEST_GROUP              "239.255.67.88"
+#define TEST_IFACE              "127.0.0.1"
+#define TEST_TIMEOUT_S          10
+#define TEST_BIG_LEN            1000        // > 250-byte ESP-NOW frame
+#define TEST_RETRY_MS           100
+
+static const uint8_t MASTER_MAC[6] = {0x02, 0xC1, 0xA5, 0x00, 0x00, 0x00};
+static const uint8_t SLAVE_MAC[6]  = {0x02, 0xC1, 0xA5, 0x00, 0x00, 0x01};
+static const uint8_t OTHER_MAC[6]  = {0x02, 0xC1, 0xA5, 0x00, 0x00, 0x7F};
+
+typedef struct {
+    uint8_t src_mac[6];
+    size_t  len;
+    char    data[CLUSTER_UDP_MAX_MSG + 1];
+} rx_msg_t;
+
+static const uint8_t *g_self_mac;
+static QueueHandle_t g_rx_queue;
+static int g_failures;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+        fprintf(stderr, __VA_ARGS__); \
+        fprintf(stderr, "\n"); \
+        g_failures++; \
+    } \
+} while (0)
+
+// ============================================================================
+// Stand-ins for the cluster core
+// ============================================================================
+
+esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type)
+{
+    (void)type;
+    memcpy(mac, g_self_mac, 6);
+    return ESP_OK;
+}
+
+void cluster_transport_receive(const cluster_transport_ops_t *from,
+                               const uint8_t *src_mac,
+                               char *data, size_t len)
+{
+    rx_msg_t msg = { .len = len };
+    if (from != &cluster_transport_udp || len > CLUSTER_UDP_MAX_MSG) {
+        g_failures++;
+        return;
+    }
+    memcpy(msg.src_mac, src_mac, 6);
+    memcpy(msg.data, data, len);
+    msg.data[len] = '\0';
+    xQueueSend(g_rx_queue, &msg, 0);
+}
+
+static bool wait_message(const char *prefix, rx_msg_t *msg, int timeout_ms)
+{
+    int64_t deadline = sim_now_us() + (int64_t)timeout_ms * 1000;
+    while (sim_now_us() < deadline) {
+        if (xQueueReceive(g_rx_queue, msg, pdMS_TO_TICKS(10)) == pdTRUE &&
+            strncmp(msg->data, prefix, strlen(prefix)) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void start_node(const uint8_t *mac, uint16_t port)
+{
+    g_self_mac = mac;
+    g_rx_queue = xQueueCreate(32, sizeof(rx_msg_t));
+
+    cluster_udp_config_t config = { .port = port };
+    strcpy(config.group, TEST_GROUP);
+    strcpy(config.iface, TEST_IFACE);
+    if (cluster_udp_configure(&config) != ESP_OK || cluster_udp_init() != ESP_OK) {
+        fprintf(stderr, "FAIL: UDP transport did not start on port %u\n", port);
+        exit(1);
+    }
+}
+
+// ============================================================================
+// Nodes
+// ============================================================================
+
+static int run_master(uint16_t port)
+{
+    start_node(MASTER_MAC, port);
+
+    CHECK(cluster_udp_send(SLAVE_MAC, "$CLACK,0*00\r\n", 13) == ESP_ERR_NOT_FOUND,
+          "unicast to an unknown slave should fail");
+
+    // Announce work until the slave answers with a share
+    const char *work = "$CLWRK,1*00\r\n";
+    rx_msg_t msg;
+    bool got_share = false;
+    for (int i = 0; i < TEST_TIMEOUT_S * 1000 / TEST_RETRY_MS && !got_share; i++) {
+        cluster_udp_broadcast(work, strlen(work));
+        got_share = wait_message("$CLSHR", &msg, TEST_RETRY_MS);
+    }
+    CHECK(got_share, "no share from slave");
+    CHECK(memcmp(msg.src_mac, SLAVE_MAC, 6) == 0, "share has wrong source MAC");
+
+    CHECK(wait_message("$CLBIG", &msg, 2000), "no large message from slave");
+    CHECK(msg.len == TEST_BIG_LEN, "large message truncated: %zu", msg.len);
+
+    // Reply to the address learned from the share
+    const char *ack = "$CLACK,1*00\r\n";
+    for (int i = 0; i < 5; i++) {
+        CHECK(cluster_udp_send(SLAVE_MAC, ack, strlen(ack)) == ESP_OK, "ACK send failed");
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+
+    // Our own multicast is looped back to us and must be filtered
+    while (xQueueReceive(g_rx_queue, &msg, 0) == pdTRUE) {
+        CHECK(strncmp(msg.data, "$CLWRK", 6) != 0, "master received its own multicast");
+    }
+
+    cluster_udp_deinit();
+    return g_failures ? 1 : 0;
+}
+
+static int run_slave(uint16_t port)
+{
+    start_node(SLAVE_MAC, port);
+
+    CHECK(cluster_udp_send(MASTER_MAC, "$CLSHR,1*00\r\n", 13) == ESP_ERR_NOT_FOUND,
+          "unicast before hearing the master should fail");
+
+    rx_msg_t msg;
+    CHECK(wait_message("$CLWRK", &msg, TEST_TIMEOUT_S * 1000), "no multicast work from master");
+    CHECK(memcmp(msg.src_mac, MASTER_MAC, 6) == 0, "work has wrong source MAC");
+
+    char big[TEST_BIG_LEN];
+    memset(big, 'x', sizeof(big));
+    memcpy(big, "$CLBIG,", 7);
+    big[sizeof(big) - 2] = '\r';
+    big[sizeof(big) - 1] = '\n';
+
+    const char *share = "$CLSHR,1*00\r\n";
+    bool acked = false;
+    for (int i = 0; i < TEST_TIMEOUT_S * 1000 / TEST_RETRY_MS && !acked; i++) {
+        CHECK(cluster_udp_send(MASTER_MAC, share, strlen(share)) == ESP_OK, "share send failed");
+        CHECK(cluster_udp_send(MASTER_MAC, big, sizeof(big)) == ESP_OK, "large send failed");
+        acked = wait_message("$CLACK", &msg, TEST_RETRY_MS);
+    }
+    CHECK(acked, "no ACK from master");
+    CHECK(memcmp(msg.src_mac, MASTER_MAC, 6) == 0, "ACK has wrong source MAC");
+
+    cluster_udp_deinit();
+    return g_failures ? 1 : 0;
+}
+
+// ============================================================================
+// In-process checks
+// ============================================================================
+
+static void check_framing(void)
+{
+    uint8_t frame[CLUSTER_UDP_HEADER_LEN + CLUSTER_UDP_MAX_MSG];
+    const char *msg = "$CLHBT,3,100*00\r\n";
+
+    int len = cluster_udp_encode_frame(SLAVE_MAC, msg, strlen(msg), frame, sizeof(frame));
+    CHECK(len == (int)(CLUSTER_UDP_HEADER_LEN + strlen(msg)), "encoded length %d", len);
+
+    uint8_t mac[6];
+    int offset = cluster_udp_decode_frame(frame, len, mac);
+    CHECK(offset == CLUSTER_UDP_HEADER_LEN, "decode offset %d", offset);
+    CHECK(memcmp(mac, SLAVE_MAC, 6) == 0, "decoded MAC differs");
+    CHECK(offset > 0 && memcmp(frame + offset, msg, strlen(msg)) == 0, "payload differs");
+
+    char oversize[CLUSTER_UDP_MAX_MSG + 1];
+    memset(oversize, 'x', sizeof(oversize));
+    CHECK(cluster_udp_encode_frame(SLAVE_MAC, oversize, sizeof(oversize), frame, sizeof(frame)) < 0,
+          "oversize message encoded");
+    CHECK(cluster_udp_encode_frame(SLAVE_MAC, msg, strlen(msg), frame, 12) < 0,
+          "frame buffer overflow not detected");
+
+    frame[1] = 'Y';
+    CHECK(cluster_udp_decode_frame(frame, len, mac) < 0, "bad magic accepted");
+    frame[1] = CLUSTER_UDP_MAGIC_1;
+    frame[2] = CLUSTER_UDP_VERSION + 1;
+    CHECK(cluster_udp_decode_frame(frame, len, mac) < 0, "unknown version accepted");
+    CHECK(cluster_udp_decode_frame(frame, CLUSTER_UDP_HEADER_LEN, mac) < 0, "empty frame accepted");
+
+    CHECK(cluster_udp_send(OTHER_MAC, msg, strlen(msg)) == ESP_ERR_INVALID_STATE,
+          "send before init should fail");
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(void)
+{
+    sim_clock_init(1.0);
+
+    check_framing();
+    if (g_failures) {
+        return 1;
+    }
+
+    // Per-run port so parallel test runs don't hear each other
+    uint16_t port = (uint16_t)(CONFIG_CLUSTER_UDP_PORT + 1 + getpid() % 10000);
+
+    pid_t pids[2];
+    for (int i = 0; i < 2; i++) {
+        pids[i] = fork();
+        if (pids[i] < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pids[i] == 0) {
+            alarm(TEST_TIMEOUT_S * 2);
+            sim_clock_init(1.0);
+            _exit(i == 0 ? run_master(port) : run_slave(port));
+        }
+    }
+
+    int failed = 0;
+    for (int i = 0; i < 2; i++) {
+        int status = 0;
+        waitpid(pids[i], &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "%s process failed (status 0x%x)\n", i == 0 ? "master" : "slave", status);
+            failed = 1;
+        }
+    }
+
+    printf("udp_loopback: %s (port %u)\n", failed ? "FAILED" : "ok", port);
+    return failed;
+}
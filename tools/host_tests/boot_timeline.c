@@ -0,0 +1,203 @@
+/**
+ * @file boot_timeline.c
+ * @brief Startup timeline checks: overlap accounting, milestones, concurrent tasks
+ *
+ * Records phases into main/boot_timeline.c the way app_main and the ASIC
+ * init task do, then checks what /api/system/boot would report.
+ *
+ * Checks:
+ *   - back-to-back phases: elapsed time equals the sum of the durations
+ *   - overlapping and nested phases are counted once in the elapsed time
+ *     but fully in the serial sum
+ *   - running phases and milestones are left out of both
+ *   - a phase that ends within the clock's resolution still counts as ended
+ *   - a full timeline drops further phases, and ending a dropped one is
+ *     harmless
+ *   - tasks recording at the same time each get their own slot
+ *
+ * Then prints the startup before and after ASIC init was moved off the
+ * main task, with typical phase lengths.
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "boot_timeline.h"
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+static void phase(boot_timeline_t *tl, const char *name, int64_t start_ms, int64_t end_ms)
+{
+    int id = boot_timeline_begin(tl, name, start_ms * 1000);
+    boot_timeline_end(tl, id, end_ms * 1000);
+}
+
+static void test_serial(void)
+{
+    boot_timeline_t tl;
+    memset(&tl, 0, sizeof(tl));
+    phase(&tl, "log", 300, 310);
+    phase(&tl, "i2c", 310, 420);
+    phase(&tl, "nvs", 420, 500);
+
+    boot_timeline_summary_t s;
+    boot_timeline_summarize(&tl, &s);
+    CHECK(s.elapsed_us == 200000 && s.serial_us == 200000, "serial: elapsed %lld, serial %lld",
+          (long long) s.elapsed_us, (long long) s.serial_us);
+    CHECK(boot_timeline_count(&tl) == 3, "%u phases", boot_timeline_count(&tl));
+}
+
+static void test_overlap(void)
+{
+    boot_timeline_t tl;
+    memset(&tl, 0, sizeof(tl));
+    phase(&tl, "peripherals", 1000, 1500);
+    phase(&tl, "asic init", 1500, 5500);
+    phase(&tl, "wifi connect", 1600, 4000);
+    phase(&tl, "cluster", 4000, 4200);
+    // Gap between 5500 and 6000 is not counted
+    phase(&tl, "late", 6000, 6100);
+    boot_timeline_mark(&tl, "first job", 4800 * 1000);
+    int running = boot_timeline_begin(&tl, "still going", 6000 * 1000);
+    (void) running;
+
+    boot_timeline_summary_t s;
+    boot_timeline_summarize(&tl, &s);
+    CHECK(s.elapsed_us == 4600000, "overlap: elapsed %lld", (long long) s.elapsed_us);
+    CHECK(s.serial_us == 7200000, "overlap: serial %lld", (long long) s.serial_us);
+    CHECK(s.running == 1, "%u running", s.running);
+
+    const boot_phase_t *mark = &tl.phases[5];
+    CHECK(mark->milestone && mark->start_us == mark->end_us && strcmp(mark->name, "first job") == 0,
+          "milestone not recorded");
+
+    // Too quick for the clock
+    boot_timeline_t quick;
+    memset(&quick, 0, sizeof(quick));
+    int id = boot_timeline_begin(&quick, "self test", 2000);
+    boot_timeline_end(&quick, id, 2000);
+    boot_timeline_summarize(&quick, &s);
+    CHECK(s.running == 0 && quick.phases[id].end_us != 0, "zero-length phase still running");
+}
+
+static void test_full(void)
+{
+    boot_timeline_t tl;
+    memset(&tl, 0, sizeof(tl));
+    for (int i = 0; i < BOOT_TIMELINE_MAX_PHASES; i++) {
+        CHECK(boot_timeline_begin(&tl, "phase", i) == i, "phase %d not given slot %d", i, i);
+    }
+    int id = boot_timeline_begin(&tl, "one too many", 100);
+    CHECK(id == -1, "full timeline gave slot %d", id);
+    boot_timeline_end(&tl, id, 200);
+    boot_timeline_mark(&tl, "first share", 300);
+    CHECK(boot_timeline_count(&tl) == BOOT_TIMELINE_MAX_PHASES, "%u phases", boot_timeline_count(&tl));
+}
+
+#define THREADS             4
+#define PHASES_PER_THREAD   10
+
+static boot_timeline_t g_shared;
+
+static void *record_phases(void *arg)
+{
+    int64_t base = (intptr_t) arg * 1000;
+    for (int i = 0; i < PHASES_PER_THREAD; i++) {
+        int id = boot_timeline_begin(&g_shared, "task", base + i);
+        boot_timeline_end(&g_shared, id, base + i + 1);
+    }
+    return NULL;
+}
+
+static void test_concurrent(void)
+{
+    memset(&g_shared, 0, sizeof(g_shared));
+    pthread_t threads[THREADS];
+    for (intptr_t t = 0; t < THREADS; t++) {
+        pthread_create(&threads[t], NULL, record_phases, (void *) t);
+    }
+    for (int t = 0; t < THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    // 40 attempts, 32 slots: every slot filled once and ended
+    CHECK(boot_timeline_count(&g_shared) == BOOT_TIMELINE_MAX_PHASES, "%u phases", boot_timeline_count(&g_shared));
+    int per_thread[THREADS] = { 0 };
+    for (int i = 0; i < BOOT_TIMELINE_MAX_PHASES; i++) {
+        const boot_phase_t *p = &g_shared.phases[i];
+        CHECK(p->name != NULL && p->end_us == p->start_us + 1, "slot %d: end %lld start %lld", i,
+              (long long) p->end_us, (long long) p->start_us);
+        per_thread[p->start_us / 1000]++;
+    }
+    int total = 0;
+    for (int t = 0; t < THREADS; t++) {
+        total += per_thread[t];
+    }
+    CHECK(total == BOOT_TIMELINE_MAX_PHASES, "%d phases attributed", total);
+}
+
+/**
+ * @brief Typical startup, milliseconds: ASIC init after WiFi and cluster vs. alongside them
+ */
+static void print_startup(void)
+{
+    enum { SETUP = 900, WIFI = 3200, CLUSTER = 300, ASIC = 4500, POOL = 700 };
+
+    boot_timeline_t before, after;
+    memset(&before, 0, sizeof(before));
+    memset(&after, 0, sizeof(after));
+
+    int t = 0;
+    phase(&before, "setup", t, t + SETUP);                          t += SETUP;
+    phase(&before, "wifi connect", t, t + WIFI);                    t += WIFI;
+    phase(&before, "cluster", t, t + CLUSTER);                      t += CLUSTER;
+    phase(&before, "asic init", t, t + ASIC);                       t += ASIC;
+    phase(&before, "pool connect", t, t + POOL);                    t += POOL;
+    int before_ready = t;
+
+    t = 0;
+    phase(&after, "setup", t, t + SETUP);                           t += SETUP;
+    phase(&after, "asic init", t, t + ASIC);
+    phase(&after, "wifi connect", t, t + WIFI);                     t += WIFI;
+    phase(&after, "cluster", t, t + CLUSTER);                       t += CLUSTER;
+    phase(&after, "pool connect", t, t + POOL);                     t += POOL;
+    int after_ready = (SETUP + ASIC > t) ? SETUP + ASIC : t;
+
+    boot_timeline_summary_t sb, sa;
+    boot_timeline_summarize(&before, &sb);
+    boot_timeline_summarize(&after, &sa);
+    printf("serial startup:   hashing at %5d ms (elapsed %lld ms, serial %lld ms)\n",
+           before_ready, (long long) sb.elapsed_us / 1000, (long long) sb.serial_us / 1000);
+    printf("parallel startup: hashing at %5d ms (elapsed %lld ms, serial %lld ms)\n",
+           after_ready, (long long) sa.elapsed_us / 1000, (long long) sa.serial_us / 1000);
+    CHECK(sa.serial_us == sb.serial_us, "same phases, different serial sums");
+    CHECK(sa.elapsed_us == (int64_t) after_ready * 1000, "parallel elapsed %lld, hashing at %d",
+          (long long) sa.elapsed_us, after_ready);
+}
+
+int main(void)
+{
+    test_serial();
+    test_overlap();
+    test_full();
+    test_concurrent();
+    print_startup();
+
+    printf("boot_timeline: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
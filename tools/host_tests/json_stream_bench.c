@@ -0,0 +1,750 @@
+/**
+ * @file json_stream_bench.c
+ * @brief Streaming JSON writer checks and heap/time against a cJSON tree
+ *
+ * Checks main/http_server/json_stream.c, which /api/system/info and
+ * /api/cluster/status now write through:
+ *   - numbers, floats, strings and layout come out as cJSON_Print /
+ *     cJSON_PrintUnformatted print them
+ *   - any chunk size gives the same bytes, every chunk but the last full
+ *   - misuse and a failed flush stop the stream and are reported
+ *
+ * Then writes a cluster status document (master and eight slaves with
+ * telemetry) both ways and prints one row each: µs per response, heap
+ * allocations and bytes per response, and peak heap while responding.
+ *
+ * cJSON itself is not available on the host, so the tree row is a model
+ * of what HTTP_send_json did: one node per item, the key and string
+ * values copied, then the whole tree printed into one heap string sized
+ * by the adaptive prebuffer. Heap bytes are counted at the ESP32 sizes
+ * (a 40 byte cJSON node, strings with their terminator); the time is the
+ * host's, with real allocations.
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "json_stream.h"
+
+#define SINK_MAX            16384
+#define CHUNK_SIZE          1024        // JSON_CHUNK_SIZE in http_server.c
+#define BENCH_SLAVES        8
+#define BENCH_ITERATIONS    2000
+#define CJSON_NODE_BYTES    40          // sizeof(cJSON) on the ESP32
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+// ============================================================================
+// Sink
+// ============================================================================
+
+typedef struct {
+    char    data[SINK_MAX + 1];
+    size_t  len;
+    int     flushes;
+    size_t  short_flushes;      // Flushes smaller than the buffer
+    size_t  cap;
+    int     fail_at;            // Flush number that fails, 0 = never
+} sink_t;
+
+static esp_err_t sink_flush(void *ctx, const char *data, size_t len)
+{
+    sink_t *sink = ctx;
+    sink->flushes++;
+    if (sink->fail_at && sink->flushes == sink->fail_at) {
+        return ESP_FAIL;
+    }
+    if (len < sink->cap) {
+        sink->short_flushes++;
+    }
+    if (len == 0 || sink->len + len > SINK_MAX) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(sink->data + sink->len, data, len);
+    sink->len += len;
+    sink->data[sink->len] = '\0';
+    return ESP_OK;
+}
+
+static void sink_start(sink_t *sink, json_stream_t *js, char *buf, size_t cap, bool format)
+{
+    memset(sink, 0, sizeof(*sink));
+    sink->cap = cap;
+    json_stream_init(js, buf, cap, format, sink_flush, sink);
+}
+
+static const char *number_text(double value)
+{
+    static sink_t sink;
+    char buf[64];
+    json_stream_t js;
+    sink_start(&sink, &js, buf, sizeof(buf), false);
+    json_stream_number(&js, NULL, value);
+    json_stream_finish(&js);
+    return sink.data;
+}
+
+static const char *float_text(float value)
+{
+    static sink_t sink;
+    char buf[64];
+    json_stream_t js;
+    sink_start(&sink, &js, buf, sizeof(buf), false);
+    json_stream_float(&js, NULL, value);
+    json_stream_finish(&js);
+    return sink.data;
+}
+
+// ============================================================================
+// cJSON Formatting
+// ============================================================================
+
+static void test_numbers(void)
+{
+    static const struct {
+        double      value;
+        const char  *text;
+    } cases[] = {
+        { 0, "0" },
+        { -7, "-7" },
+        { 1.5, "1.5" },
+        { 0.1, "0.1" },
+        { 1.0 / 3.0, "0.33333333333333331" },      // %1.15g does not read back
+        { 2147483647.0, "2147483647" },
+        { -2147483648.0, "-2147483648" },
+        { 3000000000.0, "3000000000" },             // Past int: %g, still integral
+        { 18446744073709551615.0, "1.8446744073709552e+19" },
+        { 1e300, "1e+300" },
+        { -0.000125, "-0.000125" },
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const char *got = number_text(cases[i].value);
+        CHECK(strcmp(got, cases[i].text) == 0, "number %.17g printed %s, cJSON prints %s",
+              cases[i].value, got, cases[i].text);
+    }
+    CHECK(strcmp(number_text(NAN), "null") == 0, "NaN is not null");
+    CHECK(strcmp(number_text(INFINITY), "null") == 0, "infinity is not null");
+
+    // cJSON_AddFloatToObject rounds to 7 places before printing
+    CHECK(strcmp(float_text(0.1f), "0.1") == 0, "0.1f printed %s", float_text(0.1f));
+    CHECK(strcmp(float_text(1234.5678f), "1234.567749") == 0, "1234.5678f printed %s",
+          float_text(1234.5678f));
+    CHECK(strcmp(float_text(0.00000004f), "0") == 0, "4e-8f printed %s", float_text(0.00000004f));
+    CHECK(strcmp(float_text(-61.25f), "-61.25") == 0, "-61.25f printed %s", float_text(-61.25f));
+}
+
+static void test_strings(void)
+{
+    sink_t sink;
+    char buf[64];
+    json_stream_t js;
+
+    sink_start(&sink, &js, buf, sizeof(buf), false);
+    json_stream_begin_object(&js, NULL);
+    json_stream_string(&js, "a\"b", "q\"b\\s/\n\t\r\b\f\x01\x1f caf\xc3\xa9");
+    json_stream_string(&js, "empty", "");
+    json_stream_string(&js, "missing", NULL);
+    json_stream_end_object(&js);
+    CHECK(json_stream_finish(&js) == ESP_OK, "string document failed");
+    CHECK(strcmp(sink.data,
+                 "{\"a\\\"b\":\"q\\\"b\\\\s/\\n\\t\\r\\b\\f\\u0001\\u001f caf\xc3\xa9\",\"empty\":\"\"}") == 0,
+          "strings printed %s", sink.data);
+}
+
+static void write_layout(json_stream_t *js)
+{
+    json_stream_begin_object(js, NULL);
+    json_stream_number(js, "a", 1);
+    json_stream_begin_array(js, "b");
+    json_stream_number(js, NULL, 1);
+    json_stream_number(js, NULL, 2);
+    json_stream_end_array(js);
+    json_stream_begin_object(js, "c");
+    json_stream_end_object(js);
+    json_stream_begin_array(js, "d");
+    json_stream_end_array(js);
+    json_stream_begin_object(js, "e");
+    json_stream_bool(js, "f", true);
+    json_stream_null(js, "g");
+    json_stream_end_object(js);
+    json_stream_begin_array(js, "h");
+    json_stream_begin_object(js, NULL);
+    json_stream_string(js, "i", "x");
+    json_stream_end_object(js);
+    json_stream_end_array(js);
+    json_stream_end_object(js);
+}
+
+static void test_layout(void)
+{
+    sink_t sink;
+    char buf[64];
+    json_stream_t js;
+
+    // cJSON_Print: members on their own lines, arrays on one, ", " between
+    sink_start(&sink, &js, buf, sizeof(buf), true);
+    write_layout(&js);
+    CHECK(json_stream_finish(&js) == ESP_OK, "formatted document failed");
+    CHECK(strcmp(sink.data,
+                 "{\n"
+                 "\t\"a\":\t1,\n"
+                 "\t\"b\":\t[1, 2],\n"
+                 "\t\"c\":\t{\n"
+                 "\t},\n"
+                 "\t\"d\":\t[],\n"
+                 "\t\"e\":\t{\n"
+                 "\t\t\"f\":\ttrue,\n"
+                 "\t\t\"g\":\tnull\n"
+                 "\t},\n"
+                 "\t\"h\":\t[{\n"
+                 "\t\t\t\"i\":\t\"x\"\n"
+                 "\t\t}]\n"
+                 "}") == 0,
+          "formatted layout:\n%s", sink.data);
+
+    sink_start(&sink, &js, buf, sizeof(buf), false);
+    write_layout(&js);
+    CHECK(json_stream_finish(&js) == ESP_OK, "compact document failed");
+    CHECK(strcmp(sink.data,
+                 "{\"a\":1,\"b\":[1,2],\"c\":{},\"d\":[],\"e\":{\"f\":true,\"g\":null},"
+                 "\"h\":[{\"i\":\"x\"}]}") == 0,
+          "compact layout: %s", sink.data);
+}
+
+static void test_errors(void)
+{
+    sink_t sink;
+    char buf[16];
+    json_stream_t js;
+
+    sink_start(&sink, &js, buf, sizeof(buf), false);
+    json_stream_begin_object(&js, NULL);
+    json_stream_end_array(&js);
+    CHECK(json_stream_finish(&js) == ESP_ERR_INVALID_STATE, "mismatched close accepted");
+
+    sink_start(&sink, &js, buf, sizeof(buf), false);
+    json_stream_begin_object(&js, NULL);
+    json_stream_number(&js, "open", 1);
+    CHECK(json_stream_finish(&js) == ESP_ERR_INVALID_STATE, "unclosed object accepted");
+
+    sink_start(&sink, &js, buf, sizeof(buf), false);
+    json_stream_begin_object(&js, NULL);
+    json_stream_number(&js, NULL, 1);
+    json_stream_end_object(&js);
+    CHECK(json_stream_finish(&js) == ESP_ERR_INVALID_ARG, "member without a key accepted");
+
+    sink_start(&sink, &js, buf, sizeof(buf), false);
+    CHECK(json_stream_finish(&js) == ESP_ERR_INVALID_STATE, "empty document accepted");
+
+    sink_start(&sink, &js, buf, sizeof(buf), false);
+    json_stream_number(&js, NULL, 1);
+    json_stream_number(&js, NULL, 2);
+    CHECK(json_stream_finish(&js) == ESP_ERR_INVALID_STATE, "two root values accepted");
+
+    sink_start(&sink, &js, buf, sizeof(buf), false);
+    for (int i = 0; i < JSON_STREAM_MAX_DEPTH; i++) {
+        json_stream_begin_array(&js, NULL);
+    }
+    CHECK(js.err == ESP_ERR_INVALID_STATE, "nesting past JSON_STREAM_MAX_DEPTH accepted");
+
+    // Client gone: the second chunk fails, nothing more is sent
+    sink_start(&sink, &js, buf, sizeof(buf), false);
+    sink.fail_at = 2;
+    json_stream_begin_array(&js, NULL);
+    for (int i = 0; i < 100; i++) {
+        json_stream_string(&js, NULL, "0123456789");
+    }
+    json_stream_end_array(&js);
+    CHECK(json_stream_finish(&js) == ESP_FAIL, "failed flush not reported");
+    CHECK(sink.flushes == 2 && sink.len == sizeof(buf),
+          "stream went on after a failed flush: %d flushes, %zu bytes kept", sink.flushes, sink.len);
+}
+
+// ============================================================================
+// Cluster Status Document
+// ============================================================================
+
+/**
+ * @brief Where the document goes: straight to a stream, or into a tree
+ */
+typedef struct emitter {
+    void (*begin)(struct emitter *e, const char *key, bool array);
+    void (*end)(struct emitter *e);
+    void (*number)(struct emitter *e, const char *key, double value);
+    void (*string)(struct emitter *e, const char *key, const char *value);
+    void (*boolean)(struct emitter *e, const char *key, bool value);
+} emitter_t;
+
+static double round_float(float value)
+{
+    return round((double)value * 10000000.0) / 10000000.0;
+}
+
+/**
+ * @brief Fields and nesting of GET_cluster_status on a master
+ */
+static void emit_cluster_status(emitter_t *e, int slaves)
+{
+    e->begin(e, NULL, false);
+    e->boolean(e, "enabled", true);
+    e->number(e, "mode", 1);
+    e->string(e, "modeString", "master");
+    e->number(e, "activeSlaves", slaves);
+    e->number(e, "totalHashrate", 1923456);
+    e->number(e, "totalShares", 48213);
+    e->number(e, "totalSharesAccepted", 48102);
+    e->number(e, "totalSharesRejected", 111);
+    e->number(e, "totalSharesInvalid", 3);
+    e->number(e, "totalSharesUnverified", 0);
+    e->number(e, "primarySharesAccepted", 30110);
+    e->number(e, "primarySharesRejected", 70);
+    e->number(e, "secondarySharesAccepted", 17992);
+    e->number(e, "secondarySharesRejected", 41);
+    e->number(e, "totalPower", round_float(171.38f));
+    e->number(e, "totalEfficiency", round_float(8.91f));
+
+    e->begin(e, "transport", false);
+    e->string(e, "type", "espnow");
+    e->number(e, "channel", 1);
+    e->boolean(e, "encrypted", false);
+    e->boolean(e, "discoveryActive", true);
+    e->number(e, "peerCount", slaves);
+    e->begin(e, "active", true);
+    e->string(e, NULL, "espnow");
+    e->string(e, NULL, "udp");
+    e->end(e);
+    e->end(e);
+
+    e->number(e, "currentTime", 86400123);
+
+    e->begin(e, "slaves", true);
+    for (int i = 0; i < slaves; i++) {
+        char hostname[32];
+        char ip[20];
+        snprintf(hostname, sizeof(hostname), "bitaxe-gamma-%02d", i + 1);
+        snprintf(ip, sizeof(ip), "192.168.1.%d", 101 + i);
+
+        e->begin(e, NULL, false);
+        e->number(e, "slot", i);
+        e->number(e, "slaveId", i + 1);
+        e->string(e, "hostname", hostname);
+        e->string(e, "ipAddr", ip);
+        e->number(e, "state", 3);
+        e->number(e, "hashrate", 120345 + i * 1117);
+        e->number(e, "temperature", round_float(58.4f + i * 0.37f));
+        e->number(e, "fanRpm", 4210 + i * 13);
+        e->number(e, "sharesSubmitted", 6012 + i);
+        e->number(e, "sharesAccepted", 5998 + i);
+        e->number(e, "sharesInvalid", i % 3);
+        e->number(e, "invalidRate", round_float(100.0f * (i % 3) / (6012 + i)));
+        e->number(e, "lastSeen", 86399876 - i * 41);
+        e->number(e, "frequency", 525 + 25 * (i % 4));
+        e->number(e, "coreVoltage", 1150 + 25 * (i % 3));
+        e->number(e, "power", round_float(18.73f + i * 0.41f));
+        e->number(e, "voltageIn", round_float(5.08f - i * 0.01f));
+        e->number(e, "downstream", 0);
+        e->boolean(e, "telemetry", true);
+        e->number(e, "temperature2", round_float(55.1f + i * 0.23f));
+        e->number(e, "vrTemp", round_float(61.9f + i * 0.11f));
+        e->number(e, "fan2Rpm", 0);
+        e->number(e, "errorPercentage", round_float(0.42f + i * 0.03f));
+        e->number(e, "asicQueue", 4);
+        e->number(e, "shareQueue", 0);
+        e->begin(e, "asics", true);
+        for (int a = 0; a < 1 + i % 4; a++) {
+            e->begin(e, NULL, false);
+            e->number(e, "hashrate", round_float(1203.45f / (1 + i % 4) + a));
+            e->number(e, "errorPercentage", round_float(0.4f + a * 0.05f));
+            e->end(e);
+        }
+        e->end(e);
+        e->begin(e, "clock", false);
+        e->boolean(e, "synced", true);
+        e->number(e, "offsetUs", -1234 + i * 97);
+        e->number(e, "driftPpm", round_float((i * 311 - 900) / 1000.0f));
+        e->number(e, "delayUs", 850 + i * 12);
+        e->end(e);
+        e->end(e);
+    }
+    e->end(e);
+    e->end(e);
+}
+
+// Stream: every call goes straight to the writer
+
+typedef struct {
+    emitter_t       base;
+    json_stream_t   *js;
+} stream_emitter_t;
+
+static void s_begin(emitter_t *e, const char *key, bool array)
+{
+    json_stream_t *js = ((stream_emitter_t *)e)->js;
+    if (array) {
+        json_stream_begin_array(js, key);
+    } else {
+        json_stream_begin_object(js, key);
+    }
+}
+
+static void s_end(emitter_t *e)
+{
+    json_stream_t *js = ((stream_emitter_t *)e)->js;
+    // The writer knows what is open; the emitter does not
+    if (js->in_array & (1u << js->depth)) {
+        json_stream_end_array(js);
+    } else {
+        json_stream_end_object(js);
+    }
+}
+
+static void s_number(emitter_t *e, const char *key, double value)
+{
+    json_stream_number(((stream_emitter_t *)e)->js, key, value);
+}
+
+static void s_string(emitter_t *e, const char *key, const char *value)
+{
+    json_stream_string(((stream_emitter_t *)e)->js, key, value);
+}
+
+static void s_boolean(emitter_t *e, const char *key, bool value)
+{
+    json_stream_bool(((stream_emitter_t *)e)->js, key, value);
+}
+
+static stream_emitter_t stream_emitter(json_stream_t *js)
+{
+    stream_emitter_t e = {
+        .base = { s_begin, s_end, s_number, s_string, s_boolean },
+        .js = js,
+    };
+    return e;
+}
+
+// Tree: cJSON_Add*ToObject, then cJSON_PrintBuffered
+
+typedef enum { N_OBJECT, N_ARRAY, N_NUMBER, N_STRING, N_BOOL } node_type_t;
+
+typedef struct node {
+    struct node *next;
+    struct node *child;
+    struct node *last;
+    node_type_t type;
+    char        *key;
+    char        *str;
+    double      num;
+    bool        b;
+} node_t;
+
+typedef struct {
+    size_t  allocs;
+    size_t  bytes;          // At ESP32 sizes
+    size_t  live;
+    size_t  peak;
+} heap_count_t;
+
+typedef struct {
+    emitter_t       base;
+    heap_count_t    *heap;
+    node_t          *root;
+    node_t          *stack[JSON_STREAM_MAX_DEPTH];
+    int             depth;
+} tree_emitter_t;
+
+static void heap_add(heap_count_t *heap, size_t bytes)
+{
+    heap->allocs++;
+    heap->bytes += bytes;
+    heap->live += bytes;
+    if (heap->live > heap->peak) {
+        heap->peak = heap->live;
+    }
+}
+
+static char *tree_strdup(heap_count_t *heap, const char *s)
+{
+    size_t len = strlen(s) + 1;
+    char *copy = malloc(len);
+    memcpy(copy, s, len);
+    heap_add(heap, len);
+    return copy;
+}
+
+static node_t *t_add(emitter_t *e, const char *key, node_type_t type)
+{
+    tree_emitter_t *t = (tree_emitter_t *)e;
+    node_t *n = calloc(1, sizeof(*n));
+    heap_add(t->heap, CJSON_NODE_BYTES);
+    n->type = type;
+    if (t->depth == 0) {
+        t->root = n;
+        return n;
+    }
+    node_t *parent = t->stack[t->depth - 1];
+    if (parent->type == N_OBJECT) {
+        n->key = tree_strdup(t->heap, key);
+    }
+    if (parent->last) {
+        parent->last->next = n;
+    } else {
+        parent->child = n;
+    }
+    parent->last = n;
+    return n;
+}
+
+static void t_begin(emitter_t *e, const char *key, bool array)
+{
+    tree_emitter_t *t = (tree_emitter_t *)e;
+    node_t *n = t_add(e, key, array ? N_ARRAY : N_OBJECT);
+    t->stack[t->depth++] = n;
+}
+
+static void t_end(emitter_t *e)
+{
+    ((tree_emitter_t *)e)->depth--;
+}
+
+static void t_number(emitter_t *e, const char *key, double value)
+{
+    t_add(e, key, N_NUMBER)->num = value;
+}
+
+static void t_string(emitter_t *e, const char *key, const char *value)
+{
+    tree_emitter_t *t = (tree_emitter_t *)e;
+    t_add(e, key, N_STRING)->str = tree_strdup(t->heap, value);
+}
+
+static void t_boolean(emitter_t *e, const char *key, bool value)
+{
+    t_add(e, key, N_BOOL)->b = value;
+}
+
+static void print_node(json_stream_t *js, const node_t *n)
+{
+    switch (n->type) {
+        case N_OBJECT:
+        case N_ARRAY:
+            if (n->type == N_ARRAY) {
+                json_stream_begin_array(js, n->key);
+            } else {
+                json_stream_begin_object(js, n->key);
+            }
+            for (const node_t *c = n->child; c; c = c->next) {
+                print_node(js, c);
+            }
+            if (n->type == N_ARRAY) {
+                json_stream_end_array(js);
+            } else {
+                json_stream_end_object(js);
+            }
+            break;
+        case N_NUMBER:
+            json_stream_number(js, n->key, n->num);
+            break;
+        case N_STRING:
+            json_stream_string(js, n->key, n->str);
+            break;
+        case N_BOOL:
+            json_stream_bool(js, n->key, n->b);
+            break;
+    }
+}
+
+static void free_node(node_t *n)
+{
+    while (n) {
+        node_t *next = n->next;
+        free_node(n->child);
+        free(n->key);
+        free(n->str);
+        free(n);
+        n = next;
+    }
+}
+
+/**
+ * @brief cJSON_PrintBuffered's output: one string, doubled when it fills
+ */
+typedef struct {
+    heap_count_t    *heap;
+    char            *data;
+    size_t          len;
+    size_t          size;
+} print_buffer_t;
+
+static esp_err_t print_flush(void *ctx, const char *data, size_t len)
+{
+    print_buffer_t *out = ctx;
+    if (out->len + len + 1 > out->size) {
+        size_t size = out->size;
+        while (out->len + len + 1 > size) {
+            size *= 2;
+        }
+        // realloc: the old buffer stays live until the copy is made
+        heap_add(out->heap, size);
+        out->data = realloc(out->data, size);
+        out->heap->live -= out->size;
+        out->size = size;
+    }
+    memcpy(out->data + out->len, data, len);
+    out->len += len;
+    out->data[out->len] = '\0';
+    return ESP_OK;
+}
+
+/**
+ * @brief One response the old way
+ *
+ * @param prebuffer_len In/out: HTTP_send_json's adaptive first guess
+ * @return Bytes of JSON
+ */
+static size_t respond_tree(int slaves, int *prebuffer_len, heap_count_t *heap, char *copy)
+{
+    tree_emitter_t t = {
+        .base = { t_begin, t_end, t_number, t_string, t_boolean },
+        .heap = heap,
+    };
+    emit_cluster_status(&t.base, slaves);
+
+    print_buffer_t out = { .heap = heap, .size = (size_t)*prebuffer_len };
+    out.data = malloc(out.size);
+    heap_add(heap, out.size);
+
+    // Printing a tree needs no scratch of its own: write straight through
+    char scratch[64];
+    json_stream_t js;
+    json_stream_init(&js, scratch, sizeof(scratch), true, print_flush, &out);
+    print_node(&js, t.root);
+    json_stream_finish(&js);
+
+    size_t len = out.len;
+    if (copy) {
+        memcpy(copy, out.data, len + 1);
+    }
+    if ((int)len > *prebuffer_len) {
+        *prebuffer_len = len * 1.2;
+    }
+    free(out.data);
+    free_node(t.root);
+    heap->live = 0;
+    return len;
+}
+
+static esp_err_t discard_flush(void *ctx, const char *data, size_t len)
+{
+    (void)data;
+    *(size_t *)ctx += len;
+    return ESP_OK;
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// ============================================================================
+// Chunking and Benchmark
+// ============================================================================
+
+static void test_chunks(const char *expect, size_t expect_len)
+{
+    static sink_t sink;
+    char buf[CHUNK_SIZE];
+    json_stream_t js;
+
+    for (size_t cap = 1; cap <= 300; cap++) {
+        sink_start(&sink, &js, buf, cap, true);
+        stream_emitter_t e = stream_emitter(&js);
+        emit_cluster_status(&e.base, BENCH_SLAVES);
+        CHECK(json_stream_finish(&js) == ESP_OK, "chunk size %zu failed", cap);
+        CHECK(sink.len == expect_len && memcmp(sink.data, expect, expect_len) == 0,
+              "chunk size %zu changed the document", cap);
+        CHECK(sink.short_flushes <= 1, "chunk size %zu: %zu short chunks", cap, sink.short_flushes);
+        CHECK(js.total == expect_len, "chunk size %zu counted %zu bytes", cap, js.total);
+    }
+}
+
+static void bench(void)
+{
+    static char tree_doc[SINK_MAX + 1];
+    static sink_t sink;
+    char chunk[CHUNK_SIZE];
+    json_stream_t js;
+    heap_count_t heap = {0};
+    int prebuffer_len = 512;        // cluster_prebuffer_len
+
+    // Same document both ways
+    size_t tree_len = respond_tree(BENCH_SLAVES, &prebuffer_len, &heap, tree_doc);
+    sink_start(&sink, &js, chunk, sizeof(chunk), true);
+    stream_emitter_t e = stream_emitter(&js);
+    emit_cluster_status(&e.base, BENCH_SLAVES);
+    CHECK(json_stream_finish(&js) == ESP_OK, "streamed status failed");
+    CHECK(sink.len == tree_len && strcmp(sink.data, tree_doc) == 0,
+          "streamed status differs from the tree's");
+
+    test_chunks(tree_doc, tree_len);
+
+    // Tree, steady state: the prebuffer has adapted after the first response
+    memset(&heap, 0, sizeof(heap));
+    double t0 = now_us();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        respond_tree(BENCH_SLAVES, &prebuffer_len, &heap, NULL);
+    }
+    double tree_us = (now_us() - t0) / BENCH_ITERATIONS;
+
+    size_t sent = 0;
+    t0 = now_us();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        json_stream_init(&js, chunk, sizeof(chunk), true, discard_flush, &sent);
+        stream_emitter_t s = stream_emitter(&js);
+        emit_cluster_status(&s.base, BENCH_SLAVES);
+        json_stream_finish(&js);
+    }
+    double stream_us = (now_us() - t0) / BENCH_ITERATIONS;
+    CHECK(sent == tree_len * BENCH_ITERATIONS, "streamed %zu bytes, expected %zu",
+          sent, tree_len * BENCH_ITERATIONS);
+
+    printf("cluster status: master + %d slaves, %zu bytes, %d responses\n",
+           BENCH_SLAVES, tree_len, BENCH_ITERATIONS);
+    printf("  %-18s %10s %10s %12s %12s\n", "", "us/resp", "allocs", "heap bytes", "peak heap");
+    printf("  %-18s %10.1f %10zu %12zu %12zu\n", "cJSON tree (model)", tree_us,
+           heap.allocs / BENCH_ITERATIONS, heap.bytes / BENCH_ITERATIONS, heap.peak);
+    printf("  %-18s %10.1f %10d %12d %12d  (+%d B stack)\n", "json_stream", stream_us,
+           0, 0, 0, CHUNK_SIZE);
+
+    CHECK(heap.peak > CHUNK_SIZE, "tree peak %zu not above one chunk", heap.peak);
+}
+
+int main(void)
+{
+    test_numbers();
+    test_strings();
+    test_layout();
+    test_errors();
+    bench();
+
+    printf("json_stream_bench: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,379 @@
+/**
+ * @file log_ring.c
+ * @brief Binary log ring checks: deferred formatting, laps and concurrent writers
+ *
+ * Drives main/log_ring.c the way the firmware does: ESP_LOGx formats with
+ * their colour, timestamp and tag, strings from flash and from RAM, and
+ * several tasks logging at once while the console task reads behind them.
+ *
+ * Checks:
+ *   - every supported conversion formats on read exactly as vsnprintf
+ *     would have when the line was logged, including '*' widths and RAM
+ *     strings that change after logging
+ *   - formats not in flash, unknown conversions and arguments that do not
+ *     fit are kept as text, cut to the slot
+ *   - the level letter is found behind the colour
+ *   - with the device's predicate, where the flash data window also maps
+ *     the PSRAM heap, a heap string freed before the line is read still
+ *     comes out as it was logged
+ *   - a reader lapped by the writers is told how many lines it missed and
+ *     goes on from the oldest line held
+ *   - with four threads logging flat out, a reader gets every line whole
+ *     or counts it lost, never a torn one
+ *
+ * Then prints the cost of logging a line against formatting and
+ * allocating it as log_to_queue() did.
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "log_ring.h"
+
+#define TEST_WRITERS        4
+#define TEST_PER_WRITER     200000
+#define TEST_SLOTS          1024
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+// Strings built at run time live here; everything else stands in for flash
+static char g_ram[4096];
+
+static bool host_static(const void *ptr)
+{
+    return !((const char *) ptr >= g_ram && (const char *) ptr < g_ram + sizeof(g_ram));
+}
+
+// The device's predicate: the flash data window also covers PSRAM, so
+// being in it is not enough. Here everything stands in for that window
+// and the heap block is the PSRAM part of it.
+static const char *g_heap;
+static size_t g_heap_size;
+
+static bool device_static(const void *ptr)
+{
+    bool in_drom = true;
+    bool external = (const char *) ptr >= g_heap && (const char *) ptr < g_heap + g_heap_size;
+    return in_drom && !external;
+}
+
+static log_slot_t g_slots[TEST_SLOTS];
+static log_ring_t g_ring;
+
+static void log_line(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    log_ring_vwrite(&g_ring, log_ring_level(format), format, args);
+    va_end(args);
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * @brief Log a line, read it back and compare with what vsnprintf makes of it now
+ */
+static void round_trip(const char *format, ...)
+{
+    char expected[LOG_RING_LINE_SIZE];
+    va_list args;
+    va_start(args, format);
+    va_list copy;
+    va_copy(copy, args);
+    vsnprintf(expected, sizeof(expected) - 1, format, copy);
+    va_end(copy);
+    size_t len = strlen(expected);
+    if (len == 0 || expected[len - 1] != '\n') {
+        strcpy(&expected[len], "\n");
+    }
+
+    uint32_t cursor = log_ring_head(&g_ring);
+    log_ring_vwrite(&g_ring, 0, format, args);
+    va_end(args);
+
+    // Whatever the caller's buffers hold by the time the line is read must not matter
+    char saved[64];
+    memcpy(saved, g_ram, sizeof(saved));
+    memset(g_ram, 'X', sizeof(saved));
+
+    log_record_t record;
+    uint32_t lost = 0;
+    char line[LOG_RING_LINE_SIZE];
+    CHECK(log_ring_read(&g_ring, &cursor, &record, &lost), "nothing to read for \"%s\"", format);
+    log_ring_format(&record, line, sizeof(line));
+    CHECK(!(record.flags & LOG_RING_TEXT), "\"%s\" kept as text", format);
+    CHECK(strcmp(line, expected) == 0, "\"%s\": got \"%s\", expected \"%s\"", format, line, expected);
+    memcpy(g_ram, saved, sizeof(saved));
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+static void test_formats(void)
+{
+    log_ring_init(&g_ring, g_slots, TEST_SLOTS, host_static);
+
+    strcpy(g_ram, "ram-string");
+    const char *ram = g_ram;
+
+    round_trip("\033[0;32mI (%lu) %s: Added WebSocket client, fd: %d, slot: %d\033[0m\n",
+               123456UL, "websocket", 54, 3);
+    round_trip("\033[0;33mW (%lu) %s: Share rejected: %s (diff %.2f)\033[0m\n", 99UL, "stratum", ram, 1234.5678);
+    round_trip("plain %d %i %u %o %x %X %c %%", -7, 42, 3000000000u, 8, 0xbeef, 0xBEEF, 'q');
+    round_trip("widths [%5d] [%-5d] [%05d] [%+d] [% d] [%#x]", 42, 42, 42, 42, 42, 255);
+    round_trip("stars [%*d] [%-*d] [%.*f] [%*.*f] [%.*s]", 6, 42, 6, 42, 3, 3.14159, 9, 2, 2.71828, 3, ram);
+    round_trip("sizes %hhd %hd %ld %lld %zu %jd %td", 300, 70000, -5L, 1LL << 40, (size_t) 77, (intmax_t) -9, (ptrdiff_t) 12);
+    round_trip("floats %f %e %g %E %G %a %8.3f", 1.5, 12345.678, 0.0001, 2.5e-10, 1e20, 1.0, -3.14159);
+    round_trip("pointer %p and null %s", (void *) &g_ring, (char *) NULL);
+    round_trip("strings [%s] [%10s] [%-10s] [%.4s]", "flash", ram, "abc", ram);
+    round_trip("hex dump %02x%02x%02x%02x%02x%02x%02x%02x", 0xde, 0xad, 0xbe, 0xef, 0x01, 0x02, 0x03, 0x04);
+    round_trip("no newline, one is added");
+    round_trip("");
+
+    // Non-flash format, unknown conversion, too many arguments
+    uint32_t cursor = log_ring_head(&g_ring);
+    strcpy(g_ram + 100, "I (%d) built at run time\n");
+    log_line(g_ram + 100, 5);
+    log_line("long double %Lf", (long double) 1.25);
+    char big[200];
+    memset(big, 'b', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+    strcpy(g_ram + 200, big);
+    log_line("too much %s", g_ram + 200);
+
+    log_record_t record;
+    uint32_t lost = 0;
+    char line[LOG_RING_LINE_SIZE];
+    CHECK(log_ring_read(&g_ring, &cursor, &record, &lost) && (record.flags & LOG_RING_TEXT), "RAM format not text");
+    log_ring_format(&record, line, sizeof(line));
+    CHECK(strcmp(line, "I (5) built at run time\n") == 0, "RAM format: %s", line);
+    CHECK(log_ring_read(&g_ring, &cursor, &record, &lost) && (record.flags & LOG_RING_TEXT), "%%Lf not text");
+    log_ring_format(&record, line, sizeof(line));
+    CHECK(strcmp(line, "long double 1.250000\n") == 0, "%%Lf: %s", line);
+    CHECK(log_ring_read(&g_ring, &cursor, &record, &lost) && (record.flags & LOG_RING_TEXT), "overflow not text");
+    log_ring_format(&record, line, sizeof(line));
+    CHECK(strlen(line) == LOG_RING_ARGS_SIZE && strncmp(line, "too much bbb", 12) == 0, "overflow: %zu \"%s\"",
+          strlen(line), line);
+    CHECK(!log_ring_read(&g_ring, &cursor, &record, &lost) && lost == 0, "extra line read");
+
+    // A short output buffer still ends in a newline
+    log_line("\033[0;31mE (%lu) %s: %s\033[0m\n", 1UL, "tag", "a fairly long message for a tiny buffer");
+    CHECK(log_ring_read(&g_ring, &cursor, &record, &lost), "no line to cut");
+    size_t len = log_ring_format(&record, line, 16);
+    CHECK(len == 15 && line[14] == '\n' && line[15] == '\0', "cut line: %zu", len);
+}
+
+static void test_levels(void)
+{
+    CHECK(log_ring_level("\033[0;31mE (%lu) %s: x\033[0m\n") == 'E', "error level");
+    CHECK(log_ring_level("\033[0;33mW (%lu) %s: x\033[0m\n") == 'W', "warning level");
+    CHECK(log_ring_level("I (%lu) %s: x\n") == 'I', "uncoloured info level");
+    CHECK(log_ring_level("D (%lu) %s: x\n") == 'D', "debug level");
+    CHECK(log_ring_level("Interesting") == 0, "word taken for a level");
+    CHECK(log_ring_level("") == 0 && log_ring_level(NULL) == 0, "empty format level");
+}
+
+static void test_heap_strings(void)
+{
+    log_ring_init(&g_ring, g_slots, TEST_SLOTS, device_static);
+
+    char *host = malloc(32);
+    strcpy(host, "pool.example.com");
+    g_heap = host;
+    g_heap_size = 32;
+
+    uint32_t cursor = log_ring_head(&g_ring);
+    log_line("\033[0;32mI (%lu) %s: Connecting to %s\033[0m\n", 42UL, "stratum", host);
+
+    // The stratum task frees the string and the heap reuses the block
+    memset(host, 'X', 31);
+    free(host);
+    g_heap = NULL;
+    g_heap_size = 0;
+
+    log_record_t record;
+    uint32_t lost = 0;
+    char line[LOG_RING_LINE_SIZE];
+    CHECK(log_ring_read(&g_ring, &cursor, &record, &lost), "heap string line not read");
+    log_ring_format(&record, line, sizeof(line));
+    CHECK(strcmp(line, "\033[0;32mI (42) stratum: Connecting to pool.example.com\033[0m\n") == 0,
+          "heap string after free: \"%s\"", line);
+}
+
+static void test_lap(void)
+{
+    log_ring_init(&g_ring, g_slots, TEST_SLOTS, host_static);
+    uint32_t cursor = log_ring_oldest(&g_ring);
+
+    for (int i = 0; i < 3 * TEST_SLOTS + 10; i++) {
+        log_line("line %d", i);
+    }
+
+    log_record_t record;
+    uint32_t lost = 0;
+    char line[64];
+    CHECK(log_ring_read(&g_ring, &cursor, &record, &lost), "lapped reader got nothing");
+    log_ring_format(&record, line, sizeof(line));
+    CHECK(lost == 2 * TEST_SLOTS + 10, "lapped reader lost %u", lost);
+    CHECK(strcmp(line, "line 2058\n") == 0, "lapped reader resumed at %s", line);
+
+    int count = 1;
+    while (log_ring_read(&g_ring, &cursor, &record, &lost)) {
+        count++;
+    }
+    CHECK(count == TEST_SLOTS, "read %d of the %d lines held", count, TEST_SLOTS);
+    CHECK(log_ring_oldest(&g_ring) == 2 * TEST_SLOTS + 10, "oldest %u", log_ring_oldest(&g_ring));
+}
+
+// ============================================================================
+// Concurrent writers
+// ============================================================================
+
+static atomic_int g_writers_done;
+
+static void *writer(void *arg)
+{
+    int id = (int) (intptr_t) arg;
+    for (int i = 0; i < TEST_PER_WRITER; i++) {
+        log_line("\033[0;32mI (%lu) %s: writer %d line %d check %d\033[0m\n",
+                 (unsigned long) i, "writer", id, i, id * 7 + i);
+    }
+    atomic_fetch_add(&g_writers_done, 1);
+    return NULL;
+}
+
+static void test_concurrent(void)
+{
+    log_ring_init(&g_ring, g_slots, TEST_SLOTS, host_static);
+    atomic_store(&g_writers_done, 0);
+
+    pthread_t threads[TEST_WRITERS];
+    for (int t = 0; t < TEST_WRITERS; t++) {
+        pthread_create(&threads[t], NULL, writer, (void *) (intptr_t) t);
+    }
+
+    uint32_t cursor = 0;
+    uint32_t lost = 0;
+    uint32_t read = 0;
+    uint32_t torn = 0;
+    int last[TEST_WRITERS];
+    for (int t = 0; t < TEST_WRITERS; t++) {
+        last[t] = -1;
+    }
+
+    log_record_t record;
+    char line[LOG_RING_LINE_SIZE];
+    for (;;) {
+        bool done = atomic_load(&g_writers_done) == TEST_WRITERS;
+        bool got = false;
+        while (log_ring_read(&g_ring, &cursor, &record, &lost)) {
+            got = true;
+            log_ring_format(&record, line, sizeof(line));
+            unsigned long stamp;
+            int id, i, check;
+            if (sscanf(line, "\033[0;32mI (%lu) writer: writer %d line %d check %d", &stamp, &id, &i, &check) != 4 ||
+                id < 0 || id >= TEST_WRITERS || (int) stamp != i || check != id * 7 + i || i <= last[id]) {
+                torn++;
+                continue;
+            }
+            last[id] = i;
+            read++;
+        }
+        if (done && !got) {
+            break;
+        }
+    }
+    for (int t = 0; t < TEST_WRITERS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    uint32_t total = TEST_WRITERS * TEST_PER_WRITER;
+    printf("%d writers, %u lines: %u read, %u lost, %u torn\n", TEST_WRITERS, total, read, lost, torn);
+    CHECK(torn == 0, "%u torn lines", torn);
+    CHECK(read + lost == total, "read %u + lost %u != %u", read, lost, total);
+    CHECK(read > 0, "reader got nothing");
+}
+
+// ============================================================================
+// Cost
+// ============================================================================
+
+// What log_to_queue() did for each line, less the UART and queue
+static int format_and_allocate(const char *format, ...)
+{
+    va_list args, copy;
+    va_start(args, format);
+    va_copy(copy, args);
+    int needed = vsnprintf(NULL, 0, format, copy) + 2;
+    va_end(copy);
+    char *buf = calloc(needed, 1);
+    vsnprintf(buf, needed, format, args);
+    va_end(args);
+    int c = buf[0];
+    free(buf);
+    return c;
+}
+
+static void print_cost(void)
+{
+    enum { LINES = 500000 };
+    static const char *fmt = "\033[0;32mI (%lu) %s: Nonce difficulty %.2f of %lu, job %s ver %08lx\033[0m\n";
+    volatile int sink = 0;
+
+    log_ring_init(&g_ring, g_slots, TEST_SLOTS, host_static);
+    double start = now_ns();
+    for (int i = 0; i < LINES; i++) {
+        log_line(fmt, (unsigned long) i, "asic_result", 1234.5678 + i, 4096UL, "1a2b", 0x20000000UL);
+    }
+    double ring_ns = (now_ns() - start) / LINES;
+
+    start = now_ns();
+    for (int i = 0; i < LINES; i++) {
+        sink += format_and_allocate(fmt, (unsigned long) i, "asic_result", 1234.5678 + i, 4096UL, "1a2b", 0x20000000UL);
+    }
+    double old_ns = (now_ns() - start) / LINES;
+    (void) sink;
+
+    printf("logging a result line: %.0f ns into the ring, %.0f ns formatted and allocated (%.1fx)\n",
+           ring_ns, old_ns, old_ns / ring_ns);
+    printf("%u lines in %zu KB of slots; formatted text would average %zu bytes a line\n",
+           TEST_SLOTS, sizeof(g_slots) / 1024, strlen("I (123456) asic_result: Nonce difficulty 1234.57 of 4096, job 1a2b ver 20000000\n"));
+}
+
+int main(void)
+{
+    test_levels();
+    test_formats();
+    test_heap_strings();
+    test_lap();
+    test_concurrent();
+    print_cost();
+
+    printf("log_ring: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
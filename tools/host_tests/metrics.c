@@ -0,0 +1,325 @@
+/**
+ * @file metrics.c
+ * @brief /metrics registry checks: exposition text, families, histograms
+ *
+ * Drives main/http_server/metrics.c the way GET_metrics does: tasks
+ * register the variables they keep, then a scrape renders them into a
+ * fixed chunk buffer that is flushed as it fills.
+ *
+ * Checks:
+ *   - the rendered text is exactly the Prometheus exposition format, and
+ *     values are read from the registered variables at scrape time
+ *   - series of one family registered apart are rendered under a single
+ *     # HELP / # TYPE header
+ *   - histogram buckets are cumulative and end in le="+Inf", _sum, _count
+ *   - registering the same name and labels again moves the series to the
+ *     new variable; the same name with another type is refused
+ *   - label values are escaped; NaN and infinities are spelled out
+ *   - a 7-byte chunk buffer produces the same bytes as a large one, and a
+ *     failing flush stops the scrape
+ *   - collector output follows the registered series
+ *   - a flush or a collector can register metrics without deadlocking the
+ *     scrape; the new series show up in the next one
+ *
+ * Then prints the size and cost of a scrape of a fully populated device.
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "metrics.h"
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+// Collects flushed chunks, as httpd_resp_send_chunk would send them
+typedef struct {
+    char    text[16384];
+    size_t  len;
+    int     flushes;
+    int     fail_after;     // Flushes to accept before failing, 0 for never
+} sink_t;
+
+static esp_err_t sink_flush(void *ctx, const char *data, size_t len)
+{
+    sink_t *sink = ctx;
+    if (sink->fail_after && sink->flushes == sink->fail_after) {
+        return ESP_FAIL;
+    }
+    sink->flushes++;
+    if (sink->len + len < sizeof(sink->text)) {
+        memcpy(&sink->text[sink->len], data, len);
+        sink->len += len;
+        sink->text[sink->len] = '\0';
+    }
+    return ESP_OK;
+}
+
+static esp_err_t scrape(sink_t *sink, size_t chunk_size)
+{
+    char chunk[4096];
+    metrics_writer_t w;
+    memset(sink, 0, offsetof(sink_t, fail_after));
+    metrics_writer_init(&w, chunk, chunk_size, sink_flush, sink);
+    esp_err_t err = metrics_render(&w);
+    CHECK(err != ESP_OK || w.total == sink->len, "writer counted %zu bytes, sink got %zu", w.total, sink->len);
+    return err;
+}
+
+static void test_exposition(void)
+{
+    metrics_reset();
+
+    float power = 18.5f;
+    uint64_t accepted = 1234;
+    uint64_t rejected = 5;
+    uint16_t fan = 4200;
+    bool fallback = false;
+    int32_t height = -1;
+
+    CHECK(metrics_register("bitaxe_power_watts", METRICS_GAUGE, "Power draw", NULL, METRICS_FLOAT, &power) == ESP_OK,
+          "register gauge");
+    CHECK(metrics_register("bitaxe_shares_total", METRICS_COUNTER, "Shares", "result=\"accepted\"",
+                           METRICS_U64, &accepted) == ESP_OK, "register counter");
+    CHECK(metrics_register("bitaxe_fan_rpm", METRICS_GAUGE, "Fan", "fan=\"1\"", METRICS_U16, &fan) == ESP_OK,
+          "register fan");
+    // Registered after another family: must still land under bitaxe_shares_total
+    CHECK(metrics_register("bitaxe_shares_total", METRICS_COUNTER, "Shares", "result=\"rejected\"",
+                           METRICS_U64, &rejected) == ESP_OK, "register second series");
+    CHECK(metrics_register("bitaxe_using_fallback", METRICS_GAUGE, NULL, NULL, METRICS_BOOL, &fallback) == ESP_OK,
+          "register bool");
+    CHECK(metrics_register("bitaxe_block_height", METRICS_GAUGE, "Height", NULL, METRICS_I32, &height) == ESP_OK,
+          "register i32");
+
+    // Values are read when scraped, not when registered
+    power = 19.25f;
+    accepted++;
+    fallback = true;
+
+    sink_t sink = {0};
+    CHECK(scrape(&sink, 4096) == ESP_OK, "scrape");
+    const char *expected =
+        "# HELP bitaxe_power_watts Power draw\n"
+        "# TYPE bitaxe_power_watts gauge\n"
+        "bitaxe_power_watts 19.25\n"
+        "# HELP bitaxe_shares_total Shares\n"
+        "# TYPE bitaxe_shares_total counter\n"
+        "bitaxe_shares_total{result=\"accepted\"} 1235\n"
+        "bitaxe_shares_total{result=\"rejected\"} 5\n"
+        "# HELP bitaxe_fan_rpm Fan\n"
+        "# TYPE bitaxe_fan_rpm gauge\n"
+        "bitaxe_fan_rpm{fan=\"1\"} 4200\n"
+        "# TYPE bitaxe_using_fallback gauge\n"
+        "bitaxe_using_fallback 1\n"
+        "# HELP bitaxe_block_height Height\n"
+        "# TYPE bitaxe_block_height gauge\n"
+        "bitaxe_block_height -1\n";
+    CHECK(strcmp(sink.text, expected) == 0, "exposition text:\n%s", sink.text);
+
+    // Same name and labels again: the series follows the new variable
+    float other_power = 3.0f;
+    CHECK(metrics_register("bitaxe_power_watts", METRICS_GAUGE, "Power draw", NULL, METRICS_FLOAT,
+                           &other_power) == ESP_OK, "re-register");
+    // Same name as a gauge: refused, nothing changes
+    CHECK(metrics_register("bitaxe_fan_rpm", METRICS_COUNTER, "Fan", "fan=\"2\"", METRICS_U16, &fan)
+          == ESP_ERR_INVALID_ARG, "type mismatch accepted");
+    CHECK(scrape(&sink, 4096) == ESP_OK, "scrape");
+    CHECK(strstr(sink.text, "bitaxe_power_watts 3\n") != NULL, "re-registered value not used");
+    CHECK(strstr(sink.text, "bitaxe_power_watts 19.25") == NULL, "old variable still read");
+    CHECK(strstr(sink.text, "fan=\"2\"") == NULL, "refused series rendered");
+
+    // Every byte the same, whatever the chunk size; flush failure stops the scrape
+    char full[sizeof(sink.text)];
+    strcpy(full, sink.text);
+    CHECK(scrape(&sink, 7) == ESP_OK, "scrape in 7-byte chunks");
+    CHECK(strcmp(sink.text, full) == 0, "7-byte chunks changed the output");
+    CHECK(sink.flushes == (int) ((strlen(full) + 6) / 7), "%d flushes of 7 bytes for %zu bytes",
+          sink.flushes, strlen(full));
+    sink.fail_after = 2;
+    CHECK(scrape(&sink, 7) == ESP_FAIL, "flush error not returned");
+    CHECK(sink.flushes == 2, "scrape went on after a failed flush (%d flushes)", sink.flushes);
+}
+
+static void test_histogram(void)
+{
+    metrics_reset();
+
+    static const double bounds[] = { 10, 50, 100 };
+    metrics_histogram_t h;
+    metrics_histogram_init(&h, bounds, 3);
+    CHECK(metrics_register_histogram("bitaxe_response_ms", "Response time", "pool=\"primary\"", &h) == ESP_OK,
+          "register histogram");
+    CHECK(metrics_register("bitaxe_response_ms", METRICS_GAUGE, NULL, NULL, METRICS_FLOAT, &bounds)
+          == ESP_ERR_INVALID_ARG, "gauge took a histogram's name");
+
+    const double observed[] = { 5, 10, 20, 60, 70, 500 };
+    for (size_t i = 0; i < sizeof(observed) / sizeof(observed[0]); i++) {
+        metrics_observe(&h, observed[i]);
+    }
+
+    sink_t sink = {0};
+    CHECK(scrape(&sink, 4096) == ESP_OK, "scrape");
+    const char *expected =
+        "# HELP bitaxe_response_ms Response time\n"
+        "# TYPE bitaxe_response_ms histogram\n"
+        "bitaxe_response_ms_bucket{pool=\"primary\",le=\"10\"} 2\n"
+        "bitaxe_response_ms_bucket{pool=\"primary\",le=\"50\"} 3\n"
+        "bitaxe_response_ms_bucket{pool=\"primary\",le=\"100\"} 5\n"
+        "bitaxe_response_ms_bucket{pool=\"primary\",le=\"+Inf\"} 6\n"
+        "bitaxe_response_ms_sum{pool=\"primary\"} 665\n"
+        "bitaxe_response_ms_count{pool=\"primary\"} 6\n";
+    CHECK(strcmp(sink.text, expected) == 0, "histogram text:\n%s", sink.text);
+}
+
+static void collect_test(metrics_writer_t *w, void *ctx)
+{
+    const char *hostname = ctx;
+    char escaped[64];
+    char labels[96];
+    metrics_escape_label(escaped, sizeof(escaped), hostname);
+    snprintf(labels, sizeof(labels), "hostname=\"%s\"", escaped);
+    metrics_write_family(w, "bitaxe_cluster_slave_temperature_celsius", METRICS_GAUGE, "Slave temperature");
+    metrics_write_sample(w, "bitaxe_cluster_slave_temperature_celsius", labels, NAN);
+    metrics_write_sample(w, "bitaxe_cluster_slave_temperature_celsius", NULL, INFINITY);
+    metrics_write_sample(w, "bitaxe_cluster_slave_temperature_celsius", NULL, -INFINITY);
+}
+
+static void test_collectors(void)
+{
+    metrics_reset();
+
+    uint32_t invalid = 7;
+    CHECK(metrics_register("bitaxe_invalid_total", METRICS_COUNTER, "Invalid", NULL, METRICS_U32, &invalid) == ESP_OK,
+          "register");
+    CHECK(metrics_register_collector(collect_test, "a\"b\\c\nd") == ESP_OK, "register collector");
+
+    sink_t sink = {0};
+    CHECK(scrape(&sink, 4096) == ESP_OK, "scrape");
+    const char *expected =
+        "# HELP bitaxe_invalid_total Invalid\n"
+        "# TYPE bitaxe_invalid_total counter\n"
+        "bitaxe_invalid_total 7\n"
+        "# HELP bitaxe_cluster_slave_temperature_celsius Slave temperature\n"
+        "# TYPE bitaxe_cluster_slave_temperature_celsius gauge\n"
+        "bitaxe_cluster_slave_temperature_celsius{hostname=\"a\\\"b\\\\c\\nd\"} NaN\n"
+        "bitaxe_cluster_slave_temperature_celsius +Inf\n"
+        "bitaxe_cluster_slave_temperature_celsius -Inf\n";
+    CHECK(strcmp(sink.text, expected) == 0, "collector text:\n%s", sink.text);
+
+    // Escaping never overruns, and stops before a split escape
+    char small[4];
+    CHECK(metrics_escape_label(small, sizeof(small), "ab\"") == 2 && strcmp(small, "ab") == 0,
+          "escape truncation: %s", small);
+}
+
+static uint32_t g_late_value = 5;
+
+// A task starting up while a slow client is being sent the scrape
+static esp_err_t register_on_flush(void *ctx, const char *data, size_t len)
+{
+    metrics_register("bitaxe_late_total", METRICS_COUNTER, "Late", NULL, METRICS_U32, &g_late_value);
+    return sink_flush(ctx, data, len);
+}
+
+static void collect_registering(metrics_writer_t *w, void *ctx)
+{
+    (void) w;
+    metrics_register("bitaxe_collected_total", METRICS_COUNTER, "Collected", NULL, METRICS_U32, ctx);
+}
+
+static void test_register_during_scrape(void)
+{
+    metrics_reset();
+
+    uint32_t first = 1, collected = 2;
+    metrics_register("bitaxe_first_total", METRICS_COUNTER, "First", NULL, METRICS_U32, &first);
+    metrics_register_collector(collect_registering, &collected);
+
+    static sink_t sink;
+    char chunk[8];
+    metrics_writer_t w;
+    memset(&sink, 0, sizeof(sink));
+    metrics_writer_init(&w, chunk, sizeof(chunk), register_on_flush, &sink);
+    CHECK(metrics_render(&w) == ESP_OK, "scrape with registering flush");
+    CHECK(strcmp(sink.text, "# HELP bitaxe_first_total First\n# TYPE bitaxe_first_total counter\nbitaxe_first_total 1\n") == 0,
+          "series registered during the scrape were rendered:\n%s", sink.text);
+
+    CHECK(scrape(&sink, 4096) == ESP_OK, "next scrape");
+    CHECK(strstr(sink.text, "bitaxe_late_total 5\n") != NULL && strstr(sink.text, "bitaxe_collected_total 2\n") != NULL,
+          "series registered during the last scrape missing:\n%s", sink.text);
+}
+
+static void print_scrape_cost(void)
+{
+    metrics_reset();
+
+    // Roughly what a device registers: about 40 series and two histograms
+    static float gauges[32];
+    static uint64_t counters[8];
+    static const char *gauge_names[] = {
+        "bitaxe_power_watts", "bitaxe_input_voltage_millivolts", "bitaxe_asic_temperature_celsius",
+        "bitaxe_fan_rpm", "bitaxe_hashrate_ghs", "bitaxe_asic_hashrate_ghs", "bitaxe_asic_error_hashrate_ghs",
+        "bitaxe_asic_frequency_mhz",
+    };
+    char labels[32];
+    for (int i = 0; i < 32; i++) {
+        gauges[i] = 1000.0f * rand() / RAND_MAX;
+        snprintf(labels, sizeof(labels), "n=\"%d\"", i % 4);
+        metrics_register(gauge_names[i / 4], METRICS_GAUGE, "Gauge", labels, METRICS_FLOAT, &gauges[i]);
+    }
+    for (int i = 0; i < 8; i++) {
+        counters[i] = rand();
+        snprintf(labels, sizeof(labels), "result=\"%d\"", i);
+        metrics_register("bitaxe_shares_total", METRICS_COUNTER, "Shares", labels, METRICS_U64, &counters[i]);
+    }
+    static const double bounds[] = { 10, 25, 50, 100, 250, 500, 1000, 2500, 5000 };
+    static metrics_histogram_t h[2];
+    metrics_histogram_init(&h[0], bounds, 9);
+    metrics_histogram_init(&h[1], bounds, 9);
+    metrics_register_histogram("bitaxe_stratum_response_ms", "Response", NULL, &h[0]);
+    metrics_register_histogram("bitaxe_asic_nonce_difficulty", "Difficulty", NULL, &h[1]);
+    for (int i = 0; i < 1000; i++) {
+        metrics_observe(&h[i & 1], rand() % 6000);
+    }
+
+    static sink_t sink;
+    const int rounds = 2000;
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < rounds; i++) {
+        scrape(&sink, 1024);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double us = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / 1000.0 / rounds;
+    printf("scrape of 40 series and 2 histograms: %zu bytes in %d chunks, %.1f us on the host\n",
+           sink.len, sink.flushes, us);
+}
+
+int main(void)
+{
+    test_exposition();
+    test_histogram();
+    test_collectors();
+    test_register_during_scrape();
+    print_scrape_cost();
+
+    printf("metrics: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,212 @@
+/**
+ * @file nvs_writeback.c
+ * @brief Settings write-back checks: coalescing, critical keys, accounting
+ *
+ * Drives main/nvs_writeback.c the way nvs_task does: every update is
+ * marked, then the dirty keys are written and committed once they are
+ * due, and the task sleeps for nvs_writeback_wait_ms() in between.
+ *
+ * Checks:
+ *   - with a zero window every update is its own write and commit, as
+ *     before write-back
+ *   - updates to one key inside the window reach flash once, and the
+ *     window runs from the first of them, so a steady stream still
+ *     commits every window
+ *   - a critical key is due at once and takes every other dirty key with
+ *     it in the same commit
+ *   - keys come out once each, in order, up to the last supported key
+ *   - the wait is right across the 32-bit millisecond wrap
+ *
+ * Then prints requested updates against flash writes and commits for an
+ * autotune sweep with best-difficulty updates and an overheat event.
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nvs_writeback.h"
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+enum { KEY_FREQUENCY = 18, KEY_VOLTAGE = 19, KEY_FAN = 37, KEY_AUTO_FAN = 36, KEY_OVERHEAT = 40, KEY_BEST_DIFF = 42 };
+
+// What nvs_config_write_dirty() does; returns the number of keys written
+static int flush(nvs_writeback_t *wb, uint32_t now_ms)
+{
+    if (!nvs_writeback_due(wb, now_ms)) {
+        return 0;
+    }
+    int written = 0;
+    uint16_t key;
+    while (nvs_writeback_take(wb, &key)) {
+        written++;
+    }
+    if (written > 0) {
+        nvs_writeback_committed(wb);
+    }
+    return written;
+}
+
+static void test_write_through(void)
+{
+    nvs_writeback_t wb;
+    nvs_writeback_init(&wb, 0);
+    CHECK(nvs_writeback_wait_ms(&wb, 0) == UINT32_MAX, "idle wait %u", nvs_writeback_wait_ms(&wb, 0));
+    for (int i = 0; i < 10; i++) {
+        nvs_writeback_mark(&wb, KEY_BEST_DIFF, false, i);
+        CHECK(flush(&wb, i) == 1, "window 0: update %d not written at once", i);
+    }
+    CHECK(wb.requested == 10 && wb.flash_writes == 10 && wb.commits == 10 && wb.coalesced == 0,
+          "window 0: %u requested, %u written, %u commits", wb.requested, wb.flash_writes, wb.commits);
+}
+
+static void test_coalescing(void)
+{
+    nvs_writeback_t wb;
+    nvs_writeback_init(&wb, 10000);
+
+    nvs_writeback_mark(&wb, KEY_FREQUENCY, false, 1000);
+    CHECK(nvs_writeback_wait_ms(&wb, 1000) == 10000, "wait %u", nvs_writeback_wait_ms(&wb, 1000));
+    nvs_writeback_mark(&wb, KEY_VOLTAGE, false, 4000);
+    nvs_writeback_mark(&wb, KEY_FREQUENCY, false, 7000);
+    // The window runs from the first update, not the latest
+    CHECK(nvs_writeback_wait_ms(&wb, 7000) == 4000, "wait %u after later updates", nvs_writeback_wait_ms(&wb, 7000));
+    CHECK(flush(&wb, 10999) == 0, "written before the window ended");
+    CHECK(flush(&wb, 11000) == 2, "two keys not written together");
+    CHECK(wb.requested == 3 && wb.coalesced == 1 && wb.flash_writes == 2 && wb.commits == 1,
+          "%u requested, %u coalesced, %u written, %u commits", wb.requested, wb.coalesced, wb.flash_writes, wb.commits);
+    CHECK(nvs_writeback_wait_ms(&wb, 11000) == UINT32_MAX, "still waiting after the flush");
+
+    // A key set every second for a minute commits once per window, not once
+    nvs_writeback_init(&wb, 10000);
+    int commits = 0;
+    for (uint32_t t = 0; t < 60000; t += 1000) {
+        nvs_writeback_mark(&wb, KEY_BEST_DIFF, false, t);
+        commits += flush(&wb, t) > 0;
+    }
+    CHECK(commits == 5, "%d commits for a minute of steady updates", commits);
+}
+
+static void test_critical(void)
+{
+    nvs_writeback_t wb;
+    nvs_writeback_init(&wb, 10000);
+
+    // The overheat path: fan keys, then the critical mode flag
+    nvs_writeback_mark(&wb, KEY_AUTO_FAN, false, 0);
+    nvs_writeback_mark(&wb, KEY_FAN, false, 0);
+    CHECK(!nvs_writeback_due(&wb, 0), "non-critical keys due at once");
+    nvs_writeback_mark(&wb, KEY_OVERHEAT, true, 0);
+    CHECK(nvs_writeback_due(&wb, 0), "critical key not due at once");
+
+    uint16_t keys[4];
+    int n = 0;
+    while (n < 4 && nvs_writeback_take(&wb, &keys[n])) {
+        n++;
+    }
+    nvs_writeback_committed(&wb);
+    CHECK(n == 3 && keys[0] == KEY_AUTO_FAN && keys[1] == KEY_FAN && keys[2] == KEY_OVERHEAT,
+          "critical flush took %d keys", n);
+    CHECK(wb.commits == 1, "%u commits for one critical flush", wb.commits);
+
+    // Critical is cleared with the batch
+    nvs_writeback_mark(&wb, KEY_FREQUENCY, false, 100);
+    CHECK(!nvs_writeback_due(&wb, 100), "critical outlived its batch");
+
+    // Every key comes out once, last supported key included; others are ignored
+    nvs_writeback_init(&wb, 10000);
+    for (int key = NVS_WRITEBACK_MAX_KEYS; key >= 0; key--) {
+        nvs_writeback_mark(&wb, key, false, 0);
+    }
+    CHECK(wb.dirty_count == NVS_WRITEBACK_MAX_KEYS, "%u dirty keys", wb.dirty_count);
+    int expected = 0;
+    uint16_t key;
+    while (nvs_writeback_take(&wb, &key)) {
+        CHECK(key == expected, "took key %u, expected %d", key, expected);
+        expected++;
+    }
+    CHECK(expected == NVS_WRITEBACK_MAX_KEYS, "took %d keys", expected);
+
+    // Millisecond counter wrap
+    nvs_writeback_init(&wb, 10000);
+    nvs_writeback_mark(&wb, KEY_VOLTAGE, false, UINT32_MAX - 999);
+    CHECK(nvs_writeback_wait_ms(&wb, 3000) == 6000, "wait across the wrap %u", nvs_writeback_wait_ms(&wb, 3000));
+    CHECK(flush(&wb, 9000) == 1, "not due after the wrap");
+}
+
+// One queued update as nvs_task handles it: apply, then write if due
+static void update(nvs_writeback_t *wb, uint16_t key, bool critical, uint32_t now_ms)
+{
+    nvs_writeback_mark(wb, key, critical, now_ms);
+    flush(wb, now_ms);
+}
+
+/**
+ * @brief Twenty minutes of an autotune sweep, with best-difficulty updates and one overheat
+ */
+static void run_session(uint32_t window_ms, nvs_writeback_t *wb)
+{
+    nvs_writeback_init(wb, window_ms);
+    srand(1);
+    for (uint32_t t = 0; t < 20 * 60 * 1000; t += 100) {
+        // Autotune steps every 3 s: frequency and voltage
+        if (t % 3000 == 0) {
+            update(wb, KEY_FREQUENCY, false, t);
+            update(wb, KEY_VOLTAGE, false, t);
+        }
+        // A new session best now and then, more often early on
+        if (rand() % (50 + t / 2000) == 0) {
+            update(wb, KEY_BEST_DIFF, false, t);
+        }
+        if (t == 600000) {
+            update(wb, KEY_AUTO_FAN, false, t);
+            update(wb, KEY_FAN, false, t);
+            update(wb, KEY_OVERHEAT, true, t);
+        }
+        // The task's timed wake-up
+        flush(wb, t);
+    }
+}
+
+static void print_sessions(void)
+{
+    const uint32_t windows[] = { 0, 2000, 10000, 30000 };
+    for (size_t i = 0; i < sizeof(windows) / sizeof(windows[0]); i++) {
+        nvs_writeback_t wb;
+        run_session(windows[i], &wb);
+        printf("window %5u ms: %4u updates -> %4u flash writes, %4u commits\n",
+               windows[i], wb.requested, wb.flash_writes, wb.commits);
+        if (windows[i] == 0) {
+            CHECK(wb.commits == wb.requested, "write-through session committed %u of %u", wb.commits, wb.requested);
+        } else {
+            CHECK(wb.commits <= 20 * 60 * 1000 / windows[i] + 2, "%u commits with a %u ms window",
+                  wb.commits, windows[i]);
+        }
+    }
+}
+
+int main(void)
+{
+    test_write_through();
+    test_coalescing();
+    test_critical();
+    print_sessions();
+
+    printf("nvs_writeback: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file pll_tables.c
+ * @brief PLL table checks, and the generator for components/asic/pll_tables.c
+ *
+ * Run with --generate to print pll_tables.c from the current
+ * pll_get_parameters(); redirect it over components/asic/pll_tables.c
+ * whenever the solver or a family's fb_divider range changes.
+ *
+ * Checks:
+ *   - every table entry is exactly what pll_get_parameters() returns for
+ *     that ramp point and fb_divider range
+ *   - pll_lookup_parameters() matches the solver on and off the ramp
+ *     points, and outside the table
+ *   - no ramp step changes the actual frequency by more than the family's
+ *     limit (the PLL cannot always land on the ramp point, so a 6.25 MHz
+ *     step can move the output further)
+ *
+ * Then prints the time a 50 -> 600 MHz ramp spends in the solver against
+ * the table.
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "pll.h"
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+typedef struct {
+    const char *name;
+    const char *table_name;
+    const pll_table_t *table;
+    float max_step_mhz;         // Largest output change of one ramp step
+} family_t;
+
+static const family_t FAMILIES[] = {
+    { "BM1397", "PLL_TABLE_BM1397", &PLL_TABLE_BM1397, 6.25f },
+    { "BM1366", "PLL_TABLE_BM1366", &PLL_TABLE_BM1366, 7.5f },
+    { "BM1370", "PLL_TABLE_BM1370", &PLL_TABLE_BM1370, 7.5f },
+};
+
+#define FAMILY_COUNT (sizeof(FAMILIES) / sizeof(FAMILIES[0]))
+
+static pll_setting_t solve(float target, const pll_table_t *table)
+{
+    pll_setting_t s;
+    pll_get_parameters(target, table->fb_divider_min, table->fb_divider_max,
+                       &s.fb_divider, &s.refdiv, &s.postdiv1, &s.postdiv2, &s.frequency);
+    return s;
+}
+
+static pll_setting_t lookup(float target, const pll_table_t *table)
+{
+    pll_setting_t s;
+    pll_lookup_parameters(table, target, &s.fb_divider, &s.refdiv, &s.postdiv1, &s.postdiv2, &s.frequency);
+    return s;
+}
+
+static bool same(const pll_setting_t *a, const pll_setting_t *b)
+{
+    return memcmp(&a->frequency, &b->frequency, sizeof(float)) == 0 &&
+           a->fb_divider == b->fb_divider && a->refdiv == b->refdiv &&
+           a->postdiv1 == b->postdiv1 && a->postdiv2 == b->postdiv2;
+}
+
+static void generate(void)
+{
+    printf("// Generated by tools/host_tests/pll_tables.c --generate; do not edit.\n");
+    printf("// pll_get_parameters() for every frequency ramp point, per fb_divider range.\n");
+    printf("// The pll_tables host test fails when this no longer matches the solver.\n\n");
+    printf("#include \"pll.h\"\n");
+
+    for (size_t f = 0; f < FAMILY_COUNT; f++) {
+        const pll_table_t *table = FAMILIES[f].table;
+        printf("\nstatic const pll_setting_t %s_SETTINGS[PLL_TABLE_ENTRIES] = {\n", FAMILIES[f].name);
+        for (int step = PLL_TABLE_FIRST; step <= PLL_TABLE_LAST; step++) {
+            float target = step * (float) PLL_TABLE_STEP_MHZ;
+            pll_setting_t s = solve(target, table);
+            printf("    { %.9g, %u, %u, %u, %u }, // %g MHz\n",
+                   s.frequency, s.fb_divider, s.refdiv, s.postdiv1, s.postdiv2, target);
+        }
+        printf("};\n\n");
+        printf("const pll_table_t %s = {\n", FAMILIES[f].table_name);
+        printf("    .fb_divider_min = %u,\n", table->fb_divider_min);
+        printf("    .fb_divider_max = %u,\n", table->fb_divider_max);
+        printf("    .settings = %s_SETTINGS,\n", FAMILIES[f].name);
+        printf("};\n");
+    }
+}
+
+static void test_tables(void)
+{
+    for (size_t f = 0; f < FAMILY_COUNT; f++) {
+        const pll_table_t *table = FAMILIES[f].table;
+        int mismatches = 0;
+        for (int step = PLL_TABLE_FIRST; step <= PLL_TABLE_LAST; step++) {
+            float target = step * (float) PLL_TABLE_STEP_MHZ;
+            pll_setting_t expected = solve(target, table);
+            const pll_setting_t *entry = &table->settings[step - PLL_TABLE_FIRST];
+            pll_setting_t found = lookup(target, table);
+            if (!same(entry, &expected) || !same(&found, &expected)) {
+                if (mismatches++ == 0) {
+                    printf("FAIL: %s %g MHz: table %g (%u/%u/%u/%u), solver %g (%u/%u/%u/%u)\n",
+                           FAMILIES[f].name, target, entry->frequency, entry->fb_divider, entry->refdiv,
+                           entry->postdiv1, entry->postdiv2, expected.frequency, expected.fb_divider,
+                           expected.refdiv, expected.postdiv1, expected.postdiv2);
+                }
+            }
+        }
+        CHECK(mismatches == 0, "%s: %d entries differ from the solver; regenerate with --generate",
+              FAMILIES[f].name, mismatches);
+
+        // Off the ramp points and outside the table: the solver answers
+        const float others[] = { 487.3f, 490.0f, 525.0f, 43.75f, 1206.25f, 1500.0f, 10.0f };
+        for (size_t i = 0; i < sizeof(others) / sizeof(others[0]); i++) {
+            pll_setting_t expected = solve(others[i], table);
+            pll_setting_t found = lookup(others[i], table);
+            CHECK(same(&found, &expected), "%s %g MHz: lookup %g, solver %g", FAMILIES[f].name, others[i],
+                  found.frequency, expected.frequency);
+        }
+    }
+}
+
+static void test_step_sizes(void)
+{
+    for (size_t f = 0; f < FAMILY_COUNT; f++) {
+        const pll_setting_t *settings = FAMILIES[f].table->settings;
+        float largest = 0;
+        for (int i = 1; i < PLL_TABLE_ENTRIES; i++) {
+            if (settings[i - 1].frequency == 0) {
+                continue;       // Below the family's range, nothing was set
+            }
+            float change = settings[i].frequency - settings[i - 1].frequency;
+            CHECK(change > 0, "%s: ramp step to %g MHz does not raise the frequency", FAMILIES[f].name,
+                  (PLL_TABLE_FIRST + i) * PLL_TABLE_STEP_MHZ);
+            if (change > largest) {
+                largest = change;
+            }
+        }
+        CHECK(largest <= FAMILIES[f].max_step_mhz, "%s: a ramp step moves the output %g MHz, limit %g",
+              FAMILIES[f].name, largest, FAMILIES[f].max_step_mhz);
+    }
+}
+
+static double ramp_ns(bool table)
+{
+    struct timespec t0, t1;
+    volatile float sink = 0;
+    const int rounds = 200;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int r = 0; r < rounds; r++) {
+        for (int step = PLL_TABLE_FIRST; step <= 96; step++) {
+            float target = step * (float) PLL_TABLE_STEP_MHZ;
+            pll_setting_t s = table ? lookup(target, &PLL_TABLE_BM1370) : solve(target, &PLL_TABLE_BM1370);
+            sink += s.frequency;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    (void) sink;
+    return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / rounds;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "--generate") == 0) {
+        generate();
+        return 0;
+    }
+
+    test_tables();
+    test_step_sizes();
+
+    printf("50 -> 600 MHz ramp, PLL parameters: solver %.0f ns, table %.0f ns\n", ramp_ns(false), ramp_ns(true));
+
+    printf("pll_tables: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,184 @@
+/**
+ * @file static_assets.c
+ * @brief Web UI asset index checks: manifest, lookup, ETags, cache policy
+ *
+ * Feeds main/http_server/static_assets.c manifests in the format
+ * axe-os/generate-manifest.js writes, then asks it what
+ * rest_common_get_handler asks on every request.
+ *
+ * Checks:
+ *   - a manifest with comments and CRLF line ends loads every asset with
+ *     its type, size, flags and quoted ETag; a malformed line is refused
+ *   - lookups ignore the query string, map directories to index.html and
+ *     miss on paths that are not in the manifest
+ *   - the file to open is the decoded path, with .gz when stored gzipped
+ *   - If-None-Match: single tags, lists, weak tags and * match; other
+ *     tags, prefixes and unterminated tags do not
+ *   - hashed bundles are immutable, everything else is revalidated
+ *   - a 500-file manifest finds every file
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "static_assets.h"
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+static const char *g_manifest =
+    "# ClusterAxe UI assets: etag size flags mime path\r\n"
+    "ec4d2c6f7706d383 1523 g text/html /index.html\r\n"
+    "b13627bbeee31ae6 284113 gi application/javascript /main.0123456789abcdef.js\r\n"
+    "cf945b5236e101db 18032 i font/woff2 /roboto.0123456789abcdef0123.woff2\r\n"
+    "092fcfbbcfca3b5b 90211 - application/pdf /assets/Angel%20Wish%20License.pdf\r\n"
+    "73324e1ab1db72ee 17 - text/plain /version.txt\r\n"
+    "1111111111111111 40 g text/html /setup/index.html\r\n";
+
+static static_assets_t load(const char *text, esp_err_t *err)
+{
+    static_assets_t index;
+    *err = static_assets_load(&index, strdup(text));
+    return index;
+}
+
+static void test_load(void)
+{
+    esp_err_t err;
+    static_assets_t index = load(g_manifest, &err);
+    CHECK(err == ESP_OK, "load failed: 0x%x", err);
+    CHECK(index.count == 6, "%u assets, expected 6", index.count);
+
+    static_asset_t *html = static_assets_find(&index, "/index.html");
+    CHECK(html != NULL, "index.html not found");
+    if (html != NULL) {
+        CHECK(strcmp(html->mime, "text/html") == 0, "index.html type %s", html->mime);
+        CHECK(strcmp(html->etag, "\"ec4d2c6f7706d383\"") == 0, "index.html etag %s", html->etag);
+        CHECK(html->size == 1523, "index.html size %u", html->size);
+        CHECK(html->flags == STATIC_ASSET_GZIP, "index.html flags %u", html->flags);
+        CHECK(html->data == NULL, "index.html already has data");
+    }
+
+    static_asset_t *js = static_assets_find(&index, "/main.0123456789abcdef.js?v=2");
+    CHECK(js != NULL && js->flags == (STATIC_ASSET_GZIP | STATIC_ASSET_IMMUTABLE), "hashed bundle with query");
+    CHECK(static_assets_find(&index, "/") == html, "/ is not index.html");
+    CHECK(static_assets_find(&index, "/?x=1") == html, "/?x=1 is not index.html");
+    static_asset_t *setup = static_assets_find(&index, "/setup/");
+    CHECK(setup != NULL && setup->size == 40, "/setup/ is not /setup/index.html");
+    CHECK(static_assets_find(&index, "/index.htm") == NULL, "prefix of a path found");
+    CHECK(static_assets_find(&index, "/index.html.gz") == NULL, "stored name found");
+    CHECK(static_assets_find(&index, "/dashboard") == NULL, "client route found");
+    CHECK(static_assets_find(&index, "") == NULL, "empty path found");
+
+    // Paths as stored, decoded, with .gz when compressed
+    char path[64];
+    static_asset_t *pdf = static_assets_find(&index, "/assets/Angel%20Wish%20License.pdf");
+    CHECK(pdf != NULL && static_assets_file_path(pdf, "", path, sizeof(path)) &&
+          strcmp(path, "/assets/Angel Wish License.pdf") == 0, "pdf path %s", path);
+    CHECK(js != NULL && static_assets_file_path(js, "/www", path, sizeof(path)) &&
+          strcmp(path, "/www/main.0123456789abcdef.js.gz") == 0, "js path %s", path);
+    CHECK(js != NULL && !static_assets_file_path(js, "", path, 24), "path overran a short buffer");
+
+    // Cache policy
+    CHECK(strcmp(static_assets_cache_control(html), "no-cache") == 0, "index.html cached without asking");
+    CHECK(js != NULL && strstr(static_assets_cache_control(js), "immutable") != NULL, "bundle not immutable");
+    static_asset_t *version = static_assets_find(&index, "/version.txt");
+    CHECK(version != NULL && strcmp(static_assets_cache_control(version), "no-cache") == 0,
+          "unhashed file cached without asking");
+
+    static_assets_free(&index);
+    CHECK(static_assets_find(&index, "/index.html") == NULL, "lookup after free");
+
+    const char *bad[] = {
+        "ec4d2c6f7706d383 1523 g text/html\n",
+        "ec4d2c6f7706d383 15x3 g text/html /index.html\n",
+        "ec4d2c6f7706d383 1523 g text/html index.html\n",
+        "0123456789abcdef0123456789abcdef 1 - text/plain /long-etag\n",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        index = load(bad[i], &err);
+        CHECK(err == ESP_ERR_INVALID_ARG, "malformed line %zu loaded", i);
+        CHECK(index.count == 0 && index.table == NULL, "malformed manifest %zu left an index", i);
+    }
+
+    index = load("# empty\n", &err);
+    CHECK(err == ESP_OK && index.count == 0, "empty manifest");
+    CHECK(static_assets_find(&index, "/index.html") == NULL, "found in an empty manifest");
+    static_assets_free(&index);
+}
+
+static void test_etags(void)
+{
+    const char *etag = "\"ec4d2c6f7706d383\"";
+    const struct {
+        const char *header;
+        bool match;
+    } cases[] = {
+        { "\"ec4d2c6f7706d383\"", true },
+        { "W/\"ec4d2c6f7706d383\"", true },
+        { "\"aaaa\", \"ec4d2c6f7706d383\"", true },
+        { "\"aaaa\",W/\"ec4d2c6f7706d383\"", true },
+        { "*", true },
+        { "\"aaaa\"", false },
+        { "\"ec4d2c6f7706d38\"", false },
+        { "\"ec4d2c6f7706d3833\"", false },
+        { "ec4d2c6f7706d383", false },
+        { "\"ec4d2c6f7706d383", false },
+        { "", false },
+        { "junk, \"ec4d2c6f7706d383\"", true },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        CHECK(static_assets_etag_matches(cases[i].header, etag) == cases[i].match,
+              "If-None-Match: %s should %smatch", cases[i].header, cases[i].match ? "" : "not ");
+    }
+    CHECK(!static_assets_etag_matches(NULL, etag), "no header matched");
+}
+
+static void test_many(void)
+{
+    const int files = 500;
+    size_t cap = files * 80;
+    char *text = malloc(cap);
+    size_t len = 0;
+    for (int i = 0; i < files; i++) {
+        len += snprintf(&text[len], cap - len, "%016x %d g application/javascript /%d.%016x.js\n", i, i, i, i * 7919);
+    }
+    static_assets_t index;
+    CHECK(static_assets_load(&index, text) == ESP_OK, "large manifest");
+    CHECK(index.count == files, "%u of %d assets", index.count, files);
+    CHECK(index.table_size >= 2 * files, "table of %u for %d files", index.table_size, files);
+
+    int found = 0;
+    char uri[64];
+    for (int i = 0; i < files; i++) {
+        snprintf(uri, sizeof(uri), "/%d.%016x.js", i, i * 7919);
+        static_asset_t *asset = static_assets_find(&index, uri);
+        found += (asset != NULL && asset->size == (uint32_t) i);
+    }
+    CHECK(found == files, "found %d of %d", found, files);
+    static_assets_free(&index);
+}
+
+int main(void)
+{
+    test_load();
+    test_etags();
+    test_many();
+
+    printf("static_assets: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
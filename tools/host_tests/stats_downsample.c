@@ -0,0 +1,257 @@
+/**
+ * @file stats_downsample.c
+ * @brief Statistics chart downsampling checks and response sizes
+ *
+ * Drives main/tasks/statistics_downsample.c the way GET_system_statistics
+ * does: the timestamps and the first selected column of a full 720-row
+ * buffer in, row indices out.
+ *
+ * Checks:
+ *   - every row is kept when points is 0 or not below the row count
+ *   - LTTB returns exactly points rows, in order, first and last included,
+ *     and keeps a one-row spike; it also survives the millisecond wrap
+ *   - LTTB follows a noisy curve better than taking every n-th row
+ *   - min/max keeps the highest and the lowest row of every bucket
+ *
+ * Then prints the size of the home chart's request (hashrate, power and
+ * one more column) as rows JSON, downsampled rows JSON and ?format=bin.
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "statistics_downsample.h"
+#include "json_stream.h"
+
+#define ROWS            720         // STATISTICS_MAX_DATA_COUNT
+#define CHART_POINTS    240         // What AxeOS asks for
+#define CHART_COLUMNS   3
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+static uint32_t g_x[ROWS];
+static float g_y[ROWS];
+static uint16_t g_picks[ROWS];
+
+// Hashrate-like: around 1200 GH/s, a slow swing and noise, one row every 5 s
+static void fill(uint32_t start_ms)
+{
+    srand(42);
+    for (int i = 0; i < ROWS; i++) {
+        g_x[i] = start_ms + (uint32_t)i * 5000;
+        g_y[i] = 1200.0f + 80.0f * sinf(i / 60.0f) + (rand() % 2001 - 1000) / 50.0f;
+    }
+}
+
+static bool in_order(const uint16_t *picks, uint16_t n)
+{
+    for (uint16_t i = 1; i < n; i++) {
+        if (picks[i] <= picks[i - 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool picked(const uint16_t *picks, uint16_t n, uint16_t row)
+{
+    for (uint16_t i = 0; i < n; i++) {
+        if (picks[i] == row) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Mean distance between the curve and the lines through the picks
+ */
+static double chart_error(const uint16_t *picks, uint16_t n)
+{
+    double sum = 0;
+    for (uint16_t k = 0; k + 1 < n; k++) {
+        uint16_t a = picks[k];
+        uint16_t b = picks[k + 1];
+        for (uint16_t i = a; i < b; i++) {
+            double t = (double)(i - a) / (b - a);
+            sum += fabs(g_y[i] - (g_y[a] + t * (g_y[b] - g_y[a])));
+        }
+    }
+    return sum / ROWS;
+}
+
+// ============================================================================
+// Downsampling
+// ============================================================================
+
+static void test_keep_all(void)
+{
+    fill(0);
+    CHECK(statistics_downsample(STATS_DOWNSAMPLE_LTTB, g_x, g_y, ROWS, 0, g_picks) == ROWS,
+          "points 0 dropped rows");
+    CHECK(statistics_downsample(STATS_DOWNSAMPLE_MINMAX, g_x, g_y, 100, 100, g_picks) == 100,
+          "points = rows dropped rows");
+    CHECK(g_picks[0] == 0 && g_picks[99] == 99 && in_order(g_picks, 100), "kept rows out of order");
+    CHECK(statistics_downsample(STATS_DOWNSAMPLE_LTTB, g_x, g_y, 0, 10, g_picks) == 0,
+          "rows from an empty buffer");
+}
+
+static void test_lttb(void)
+{
+    static const uint32_t starts[] = { 0, UINT32_MAX - 1000000 };    // Second one wraps
+
+    for (size_t s = 0; s < sizeof(starts) / sizeof(starts[0]); s++) {
+        fill(starts[s]);
+        g_y[333] = 5000.0f;
+
+        for (uint16_t points = 3; points <= 400; points += 397 / 9) {
+            uint16_t n = statistics_downsample(STATS_DOWNSAMPLE_LTTB, g_x, g_y, ROWS, points, g_picks);
+            CHECK(n == points, "LTTB to %u points gave %u", points, n);
+            CHECK(g_picks[0] == 0 && g_picks[n - 1] == ROWS - 1, "LTTB to %u points lost an end", points);
+            CHECK(in_order(g_picks, n), "LTTB to %u points out of order", points);
+            CHECK(picked(g_picks, n, 333), "LTTB to %u points (start %u) lost the spike", points, starts[s]);
+        }
+    }
+
+    uint16_t n = statistics_downsample(STATS_DOWNSAMPLE_LTTB, g_x, g_y, ROWS, 2, g_picks);
+    CHECK(n == 2 && g_picks[0] == 0 && g_picks[1] == ROWS - 1, "LTTB to 2 points is not the ends");
+    n = statistics_downsample(STATS_DOWNSAMPLE_LTTB, g_x, g_y, ROWS, 1, g_picks);
+    CHECK(n == 1 && g_picks[0] == 0, "LTTB to 1 point is not the first row");
+}
+
+static void test_lttb_shape(void)
+{
+    fill(0);
+    uint16_t n = statistics_downsample(STATS_DOWNSAMPLE_LTTB, g_x, g_y, ROWS, CHART_POINTS, g_picks);
+    double lttb_error = chart_error(g_picks, n);
+
+    // Every third row, and the last
+    uint16_t stride[ROWS];
+    uint16_t m = 0;
+    for (uint16_t i = 0; i < ROWS; i += ROWS / CHART_POINTS) {
+        stride[m++] = i;
+    }
+    if (stride[m - 1] != ROWS - 1) {
+        stride[m++] = ROWS - 1;
+    }
+    double stride_error = chart_error(stride, m);
+
+    printf("chart error at %d of %d rows: LTTB %.2f GH/s, every %d-th row %.2f GH/s\n",
+           CHART_POINTS, ROWS, lttb_error, ROWS / CHART_POINTS, stride_error);
+    CHECK(lttb_error < stride_error, "LTTB follows the curve worse than a stride");
+}
+
+static void test_min_max(void)
+{
+    fill(0);
+    g_y[100] = 9000.0f;
+    g_y[101] = -9000.0f;
+    g_y[600] = 0.0f;
+
+    for (uint16_t points = 2; points <= 400; points += 398 / 9) {
+        uint16_t n = statistics_downsample(STATS_DOWNSAMPLE_MINMAX, g_x, g_y, ROWS, points, g_picks);
+        CHECK(n <= points && n >= points / 2, "min/max to %u points gave %u", points, n);
+        CHECK(in_order(g_picks, n), "min/max to %u points out of order", points);
+        CHECK(picked(g_picks, n, 100) && picked(g_picks, n, 101), "min/max to %u points lost an extreme", points);
+        // The dip is the lowest of its own bucket once there are two
+        CHECK(points < 4 || picked(g_picks, n, 600), "min/max to %u points lost the dip", points);
+    }
+
+    // A flat bucket gives one row, not two
+    for (int i = 0; i < ROWS; i++) {
+        g_y[i] = 7.0f;
+    }
+    uint16_t n = statistics_downsample(STATS_DOWNSAMPLE_MINMAX, g_x, g_y, ROWS, 20, g_picks);
+    CHECK(n == 10, "flat min/max to 20 points gave %u rows", n);
+}
+
+// ============================================================================
+// Response Sizes
+// ============================================================================
+
+static esp_err_t count_flush(void *ctx, const char *data, size_t len)
+{
+    (void)data;
+    *(size_t *)ctx += len;
+    return ESP_OK;
+}
+
+/**
+ * @brief Bytes of the rows JSON for these picks, as GET_system_statistics writes it
+ */
+static size_t rows_json_size(const uint16_t *picks, uint16_t n)
+{
+    char chunk[1024];
+    size_t size = 0;
+    json_stream_t js;
+    json_stream_init(&js, chunk, sizeof(chunk), true, count_flush, &size);
+
+    json_stream_begin_object(&js, NULL);
+    json_stream_number(&js, "currentTimestamp", g_x[ROWS - 1] + 1200);
+    json_stream_begin_array(&js, "labels");
+    json_stream_string(&js, NULL, "hashrate");
+    json_stream_string(&js, NULL, "power");
+    json_stream_string(&js, NULL, "asicTemp");
+    json_stream_string(&js, NULL, "timestamp");
+    json_stream_end_array(&js);
+    json_stream_begin_array(&js, "statistics");
+    for (uint16_t i = 0; i < n; i++) {
+        uint16_t r = picks[i];
+        json_stream_begin_array(&js, NULL);
+        json_stream_float(&js, NULL, g_y[r]);
+        json_stream_float(&js, NULL, 18.0f + g_y[r] / 400.0f);
+        json_stream_float(&js, NULL, 58.0f + (r % 17) / 8.0f);
+        json_stream_number(&js, NULL, g_x[r]);
+        json_stream_end_array(&js);
+    }
+    json_stream_end_array(&js);
+    json_stream_end_object(&js);
+    json_stream_finish(&js);
+    return size;
+}
+
+static void test_sizes(void)
+{
+    fill(3600000);
+    uint16_t all = statistics_downsample(STATS_DOWNSAMPLE_LTTB, g_x, g_y, ROWS, 0, g_picks);
+    size_t full = rows_json_size(g_picks, all);
+    uint16_t n = statistics_downsample(STATS_DOWNSAMPLE_LTTB, g_x, g_y, ROWS, CHART_POINTS, g_picks);
+    size_t reduced = rows_json_size(g_picks, n);
+    size_t bin = 8 + (size_t)n * (CHART_COLUMNS + 1) * 4;
+
+    printf("home chart, %d columns + timestamp:\n", CHART_COLUMNS);
+    printf("  rows JSON, %3d rows            %6zu bytes\n", ROWS, full);
+    printf("  rows JSON, points=%d          %6zu bytes\n", CHART_POINTS, reduced);
+    printf("  format=bin, points=%d         %6zu bytes\n", CHART_POINTS, bin);
+
+    CHECK(reduced * 2 < full, "downsampled JSON %zu not under half of %zu", reduced, full);
+    CHECK(bin * 2 < reduced, "binary %zu not under half of JSON %zu", bin, reduced);
+}
+
+int main(void)
+{
+    test_keep_all();
+    test_lttb();
+    test_lttb_shape();
+    test_min_max();
+    test_sizes();
+
+    printf("stats_downsample: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
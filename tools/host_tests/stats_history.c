@@ -0,0 +1,485 @@
+/**
+ * @file stats_history.c
+ * @brief Long-term statistics history checks against an emulated flash
+ *
+ * Drives main/tasks/statistics_history.c on a RAM copy of the "stats"
+ * partition that behaves like NOR flash: erase sets a sector to 0xFF and
+ * a write can only clear bits.
+ *
+ * Checks:
+ *   - an unformatted partition mounts empty, and a too small one is refused
+ *   - 1 minute, 15 minute and 1 hour rollups match the raw samples
+ *     (sample-weighted means, min of mins, max of maxes)
+ *   - rings wrap: the newest capacity records are kept, in order, and every
+ *     sector is erased as often as the others
+ *   - a reboot in the middle of every period gives the same records as
+ *     running straight through
+ *   - a write cut short by a power loss is skipped and not overwritten
+ *   - range queries return exactly the records in range, and read only a
+ *     few sectors for a short range at the end of a full ring
+ *   - the level picked for a chart is the finest that reaches back far
+ *     enough in few enough points
+ *
+ * Then prints what the 768 KB partition keeps at each resolution.
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "statistics_history.h"
+
+#define PARTITION_SIZE  (768 * 1024)    // partitions.csv
+#define SMALL_SIZE      STATS_HISTORY_MIN_SIZE
+#define START_TIME      1759996800u     // On a whole hour
+#define SECTORS         (PARTITION_SIZE / STATS_HISTORY_SECTOR_SIZE)
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+// ============================================================================
+// Emulated Flash
+// ============================================================================
+
+typedef struct
+{
+    uint8_t data[PARTITION_SIZE];
+    uint32_t size;
+    uint32_t eraseCount[SECTORS];
+    size_t bytesRead;
+    int tearAfter;              // Writes left before one is cut short, -1 = never
+} Flash;
+
+static esp_err_t flash_read(void *ctx, uint32_t offset, void *buf, size_t len)
+{
+    Flash *flash = (Flash *)ctx;
+    if (offset + len > flash->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(buf, &flash->data[offset], len);
+    flash->bytesRead += len;
+    return ESP_OK;
+}
+
+static esp_err_t flash_write(void *ctx, uint32_t offset, const void *buf, size_t len)
+{
+    Flash *flash = (Flash *)ctx;
+    if (offset + len > flash->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // A torn write gets only its first few bytes out
+    size_t written = len;
+    if (flash->tearAfter == 0) {
+        written = len / 3;
+    }
+    if (flash->tearAfter >= 0) {
+        flash->tearAfter--;
+    }
+    const uint8_t *src = (const uint8_t *)buf;
+    for (size_t i = 0; i < written; i++) {
+        flash->data[offset + i] &= src[i];
+    }
+    return (written == len) ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t flash_erase(void *ctx, uint32_t offset, size_t len)
+{
+    Flash *flash = (Flash *)ctx;
+    if (offset % STATS_HISTORY_SECTOR_SIZE || len % STATS_HISTORY_SECTOR_SIZE || offset + len > flash->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(&flash->data[offset], 0xFF, len);
+    for (size_t s = 0; s < len / STATS_HISTORY_SECTOR_SIZE; s++) {
+        flash->eraseCount[offset / STATS_HISTORY_SECTOR_SIZE + s]++;
+    }
+    return ESP_OK;
+}
+
+static void flash_init(Flash *flash, uint32_t size)
+{
+    memset(flash, 0, sizeof(*flash));
+    memset(flash->data, 0xFF, sizeof(flash->data));
+    flash->size = size;
+    flash->tearAfter = -1;
+}
+
+static StatsHistoryFlash flash_ops(Flash *flash)
+{
+    StatsHistoryFlash ops = {
+        .read = flash_read,
+        .write = flash_write,
+        .erase = flash_erase,
+        .ctx = flash,
+    };
+    return ops;
+}
+
+static esp_err_t mount(StatsHistory *history, Flash *flash)
+{
+    StatsHistoryFlash ops = flash_ops(flash);
+    return statistics_history_mount(history, &ops, flash->size);
+}
+
+// ============================================================================
+// Samples and Queries
+// ============================================================================
+
+// Sample i is taken at START_TIME + 5 i, with values that change every sample
+static StatsHistoryRecord sample(uint32_t i)
+{
+    StatsHistoryRecord s = {
+        .time = START_TIME + i * 5,
+        .hashrate = 1100.0f + (float)((i * 7919) % 200),
+        .power = 18.0f + (float)(i % 11) / 4.0f,
+        .chipTemperature = 55.0f + (float)(i % 13),
+        .errorPercentage = (float)(i % 5) / 10.0f,
+    };
+    return s;
+}
+
+static void add_samples(StatsHistory *history, uint32_t first, uint32_t count)
+{
+    for (uint32_t i = first; i < first + count; i++) {
+        StatsHistoryRecord s = sample(i);
+        esp_err_t err = statistics_history_add(history, &s);
+        if (err != ESP_OK) {
+            CHECK(false, "adding sample %u failed: 0x%x", i, err);
+            return;
+        }
+    }
+}
+
+typedef struct
+{
+    StatsHistoryRecord records[16384];
+    uint32_t count;
+    uint32_t limit;             // Stop after this many, 0 = all
+} Collected;
+
+static bool collect(void *ctx, const StatsHistoryRecord *record)
+{
+    Collected *c = (Collected *)ctx;
+    if (c->count < sizeof(c->records) / sizeof(c->records[0])) {
+        c->records[c->count] = *record;
+    }
+    c->count++;
+    return c->limit == 0 || c->count < c->limit;
+}
+
+static Collected g_got;
+static Collected g_want;
+
+static void query(const StatsHistory *history, StatsHistoryLevel level, uint32_t from, uint32_t to, Collected *c)
+{
+    memset(c, 0, sizeof(*c));
+    CHECK(statistics_history_query(history, level, from, to, collect, c) == ESP_OK, "query of level %d failed", level);
+}
+
+static bool in_order(const Collected *c)
+{
+    for (uint32_t i = 1; i < c->count; i++) {
+        if (c->records[i].time <= c->records[i - 1].time) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool same_records(const Collected *a, const Collected *b)
+{
+    if (a->count != b->count) {
+        return false;
+    }
+    for (uint32_t i = 0; i < a->count; i++) {
+        const StatsHistoryRecord *x = &a->records[i];
+        const StatsHistoryRecord *y = &b->records[i];
+        if (x->time != y->time || x->samples != y->samples || fabsf(x->hashrate - y->hashrate) > 0.01f ||
+            x->hashrateMin != y->hashrateMin || x->hashrateMax != y->hashrateMax ||
+            fabsf(x->power - y->power) > 0.001f || fabsf(x->chipTemperature - y->chipTemperature) > 0.001f ||
+            fabsf(x->errorPercentage - y->errorPercentage) > 0.001f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static Flash g_flash;
+static Flash g_reference;
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+static void test_mount(void)
+{
+    StatsHistory history;
+
+    flash_init(&g_flash, PARTITION_SIZE);
+    CHECK(mount(&history, &g_flash) == ESP_OK, "blank partition did not mount");
+    query(&history, STATS_HISTORY_RAW, 0, UINT32_MAX, &g_got);
+    CHECK(g_got.count == 0, "blank partition has %u records", g_got.count);
+
+    flash_init(&g_flash, SMALL_SIZE - STATS_HISTORY_SECTOR_SIZE);
+    CHECK(mount(&history, &g_flash) == ESP_ERR_INVALID_SIZE, "too small a partition mounted");
+
+    flash_init(&g_flash, PARTITION_SIZE);
+    mount(&history, &g_flash);
+    StatsHistoryRecord early = sample(0);
+    early.time = 86400;
+    CHECK(statistics_history_add(&history, &early) == ESP_ERR_INVALID_ARG, "sample from an unset clock recorded");
+    CHECK(g_flash.eraseCount[0] == 0, "unset clock sample touched the flash");
+}
+
+static void test_rollups(void)
+{
+    StatsHistory history;
+    const uint32_t count = 2 * 720 + 100;           // Two hours and a bit
+
+    flash_init(&g_flash, PARTITION_SIZE);
+    mount(&history, &g_flash);
+    add_samples(&history, 0, count);
+
+    query(&history, STATS_HISTORY_RAW, 0, UINT32_MAX, &g_got);
+    CHECK(g_got.count == count && in_order(&g_got), "raw: %u records for %u samples", g_got.count, count);
+
+    for (StatsHistoryLevel level = STATS_HISTORY_1M; level < STATS_HISTORY_LEVELS; level++) {
+        const uint32_t period = statistics_history_period(level);
+        const uint32_t perRecord = period / 5;
+        const uint32_t complete = count / perRecord;    // The period in progress is not written yet
+
+        query(&history, level, 0, UINT32_MAX, &g_got);
+        CHECK(g_got.count == complete, "level %d: %u records, want %u", level, g_got.count, complete);
+
+        for (uint32_t r = 0; r < g_got.count && r < complete; r++) {
+            double hashrate = 0, power = 0, temp = 0, error = 0;
+            float lo = INFINITY, hi = -INFINITY;
+            for (uint32_t i = r * perRecord; i < (r + 1) * perRecord; i++) {
+                StatsHistoryRecord s = sample(i);
+                hashrate += s.hashrate;
+                power += s.power;
+                temp += s.chipTemperature;
+                error += s.errorPercentage;
+                lo = fminf(lo, s.hashrate);
+                hi = fmaxf(hi, s.hashrate);
+            }
+            const StatsHistoryRecord *got = &g_got.records[r];
+            CHECK(got->time == START_TIME + r * period, "level %d record %u at %u", level, r, got->time);
+            CHECK(got->samples == perRecord, "level %d record %u has %u samples", level, r, got->samples);
+            CHECK(fabs(got->hashrate - hashrate / perRecord) < 0.01 && fabs(got->power - power / perRecord) < 0.001 &&
+                  fabs(got->chipTemperature - temp / perRecord) < 0.001 &&
+                  fabs(got->errorPercentage - error / perRecord) < 0.001,
+                  "level %d record %u means are off", level, r);
+            CHECK(got->hashrateMin == lo && got->hashrateMax == hi, "level %d record %u min/max are off", level, r);
+        }
+    }
+
+    // A gap skips periods rather than filling them
+    add_samples(&history, 4 * 720, 1);
+    query(&history, STATS_HISTORY_1H, 0, UINT32_MAX, &g_got);
+    CHECK(g_got.count == 3 && g_got.records[2].time == START_TIME + 2 * 3600 && g_got.records[2].samples == 100,
+          "partial hour before a gap: %u records", g_got.count);
+}
+
+static void test_wrap(void)
+{
+    StatsHistory history;
+
+    flash_init(&g_flash, SMALL_SIZE);
+    mount(&history, &g_flash);
+    const uint32_t capacity = statistics_history_capacity(&history, STATS_HISTORY_RAW);
+    const uint32_t count = capacity * 9 + 37;
+    add_samples(&history, 0, count);
+
+    query(&history, STATS_HISTORY_RAW, 0, UINT32_MAX, &g_got);
+    CHECK(g_got.count >= capacity && g_got.count <= capacity + STATS_HISTORY_SLOTS, "wrapped ring has %u records",
+          g_got.count);
+    CHECK(in_order(&g_got), "wrapped ring out of order");
+    CHECK(g_got.count > 0 && g_got.records[g_got.count - 1].time == sample(count - 1).time,
+          "wrapped ring lost the newest sample");
+    CHECK(g_got.count > 0 && g_got.records[0].time == sample(count - g_got.count).time,
+          "wrapped ring has a hole");
+
+    // Raw ring is the first half of the sectors: all erased as often, give or take one
+    const uint16_t sectors = history.rings[STATS_HISTORY_RAW].sectors;
+    uint32_t lo = UINT32_MAX, hi = 0;
+    for (uint16_t s = 0; s < sectors; s++) {
+        lo = g_flash.eraseCount[s] < lo ? g_flash.eraseCount[s] : lo;
+        hi = g_flash.eraseCount[s] > hi ? g_flash.eraseCount[s] : hi;
+    }
+    CHECK(hi - lo <= 1 && lo >= 7, "raw sector erases range %u..%u", lo, hi);
+
+    // And it survives a remount
+    StatsHistory again;
+    mount(&again, &g_flash);
+    query(&again, STATS_HISTORY_RAW, 0, UINT32_MAX, &g_want);
+    CHECK(same_records(&g_got, &g_want), "wrapped ring reads differently after a remount");
+    CHECK(again.rings[STATS_HISTORY_RAW].head == history.rings[STATS_HISTORY_RAW].head &&
+          again.rings[STATS_HISTORY_RAW].slot == history.rings[STATS_HISTORY_RAW].slot,
+          "remount found the head at %u/%u, not %u/%u", again.rings[0].head, again.rings[0].slot,
+          history.rings[0].head, history.rings[0].slot);
+}
+
+static void test_reboot(void)
+{
+    StatsHistory history;
+    const uint32_t count = 3 * 720 + 11;
+
+    // Straight through
+    flash_init(&g_reference, PARTITION_SIZE);
+    mount(&history, &g_reference);
+    add_samples(&history, 0, count);
+
+    // Rebooting every 97 samples: mid-minute, mid-quarter and mid-hour
+    flash_init(&g_flash, PARTITION_SIZE);
+    for (uint32_t first = 0; first < count; first += 97) {
+        StatsHistory rebooted;
+        CHECK(mount(&rebooted, &g_flash) == ESP_OK, "remount at sample %u failed", first);
+        add_samples(&rebooted, first, (count - first < 97) ? count - first : 97);
+    }
+
+    for (StatsHistoryLevel level = STATS_HISTORY_RAW; level < STATS_HISTORY_LEVELS; level++) {
+        query(&history, level, 0, UINT32_MAX, &g_want);
+        StatsHistory rebooted;
+        mount(&rebooted, &g_flash);
+        query(&rebooted, level, 0, UINT32_MAX, &g_got);
+        CHECK(same_records(&g_got, &g_want), "level %d after reboots: %u records, want %u", level, g_got.count,
+              g_want.count);
+    }
+}
+
+static void test_torn_write(void)
+{
+    StatsHistory history;
+
+    flash_init(&g_flash, PARTITION_SIZE);
+    mount(&history, &g_flash);
+    add_samples(&history, 0, 50);
+
+    // Power goes mid-write: the raw record is cut short and nothing after it happens
+    g_flash.tearAfter = 0;
+    StatsHistoryRecord s = sample(50);
+    CHECK(statistics_history_add(&history, &s) != ESP_OK, "torn write reported success");
+
+    StatsHistory rebooted;
+    mount(&rebooted, &g_flash);
+    query(&rebooted, STATS_HISTORY_RAW, 0, UINT32_MAX, &g_got);
+    CHECK(g_got.count == 50 && in_order(&g_got), "torn record read back: %u records", g_got.count);
+
+    // The next sample goes after the torn slot, not over it
+    CHECK(rebooted.rings[STATS_HISTORY_RAW].slot == 52, "writing resumes at slot %u",
+          rebooted.rings[STATS_HISTORY_RAW].slot);
+    add_samples(&rebooted, 51, 30);
+    query(&rebooted, STATS_HISTORY_RAW, 0, UINT32_MAX, &g_got);
+    CHECK(g_got.count == 80 && g_got.records[50].time == sample(51).time, "after the torn record: %u records",
+          g_got.count);
+}
+
+static void test_range(void)
+{
+    StatsHistory history;
+
+    flash_init(&g_flash, PARTITION_SIZE);
+    mount(&history, &g_flash);
+    const uint32_t capacity = statistics_history_capacity(&history, STATS_HISTORY_RAW);
+    const uint32_t count = capacity + 2000;
+    add_samples(&history, 0, count);
+
+    // Middle of the ring, bounds inclusive
+    const uint32_t from = sample(count - 5000).time;
+    const uint32_t to = sample(count - 4001).time;
+    query(&history, STATS_HISTORY_RAW, from, to, &g_got);
+    CHECK(g_got.count == 1000 && g_got.records[0].time == from && g_got.records[999].time == to,
+          "range query: %u records", g_got.count);
+
+    // The last ten minutes of a full ring reads a handful of sectors, not all of them
+    g_flash.bytesRead = 0;
+    query(&history, STATS_HISTORY_RAW, sample(count - 120).time, UINT32_MAX, &g_got);
+    const uint32_t ringBytes = history.rings[STATS_HISTORY_RAW].sectors * STATS_HISTORY_SECTOR_SIZE;
+    printf("last 10 minutes of a full raw ring: %u records, %zu of %u bytes read\n", g_got.count,
+           g_flash.bytesRead, ringBytes);
+    CHECK(g_got.count == 120, "last 10 minutes: %u records", g_got.count);
+    CHECK(g_flash.bytesRead < 3 * STATS_HISTORY_SECTOR_SIZE + history.rings[0].sectors * 64,
+          "last 10 minutes read %zu bytes", g_flash.bytesRead);
+
+    // The callback can stop early
+    memset(&g_got, 0, sizeof(g_got));
+    g_got.limit = 10;
+    statistics_history_query(&history, STATS_HISTORY_RAW, 0, UINT32_MAX, collect, &g_got);
+    CHECK(g_got.count == 10, "stopped query went on to %u records", g_got.count);
+
+    CHECK(statistics_history_query(&history, STATS_HISTORY_RAW, 10, 5, collect, &g_got) == ESP_ERR_INVALID_ARG,
+          "backwards range accepted");
+}
+
+static void test_pick_level(void)
+{
+    StatsHistory history;
+
+    flash_init(&g_flash, PARTITION_SIZE);
+    mount(&history, &g_flash);
+    const uint32_t now = START_TIME + 200 * 86400;
+
+    CHECK(statistics_history_pick_level(&history, now - 3600, now, 1000, now) == STATS_HISTORY_RAW,
+          "last hour in 1000 points is not raw");
+    CHECK(statistics_history_pick_level(&history, now - 86400, now, 2000, now) == STATS_HISTORY_1M,
+          "last day in 2000 points is not 1 minute");
+    CHECK(statistics_history_pick_level(&history, now - 86400, now, 20000, now) == STATS_HISTORY_1M,
+          "last day reached back past the raw ring");
+    CHECK(statistics_history_pick_level(&history, now - 14 * 86400, now, 2000, now) == STATS_HISTORY_15M,
+          "last two weeks in 2000 points is not 15 minutes");
+    CHECK(statistics_history_pick_level(&history, now - 90 * 86400, now, 100000, now) == STATS_HISTORY_1H,
+          "last 90 days is not hourly");
+    CHECK(statistics_history_pick_level(&history, now - 3600, now, 1, now) == STATS_HISTORY_1H,
+          "one point is not the coarsest");
+}
+
+static void print_retention(void)
+{
+    StatsHistory history;
+    static const char *names[] = { "5 s", "1 min", "15 min", "1 h" };
+
+    flash_init(&g_flash, PARTITION_SIZE);
+    mount(&history, &g_flash);
+    printf("%u KB partition keeps at least:\n", PARTITION_SIZE / 1024);
+    for (StatsHistoryLevel level = STATS_HISTORY_RAW; level < STATS_HISTORY_LEVELS; level++) {
+        const uint32_t records = statistics_history_capacity(&history, level);
+        const double days = (double)records * statistics_history_period(level) / 86400.0;
+        printf("  %-6s %3u sectors %6u records  %6.1f days\n", names[level], history.rings[level].sectors, records, days);
+        if (level == STATS_HISTORY_15M) {
+            CHECK(days >= 28, "15 minute history is only %.1f days", days);
+        }
+    }
+
+    // A day of samples: raw writes plus rollups, and how often a raw sector is erased
+    add_samples(&history, 0, 17280);
+    printf("one day: %u records written, %u sectors erased\n", history.writes, history.erases);
+}
+
+int main(void)
+{
+    test_mount();
+    test_rollups();
+    test_wrap();
+    test_reboot();
+    test_torn_write();
+    test_range();
+    test_pick_level();
+    print_retention();
+
+    printf("stats_history: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,340 @@
+/**
+ * @file ws_topics.c
+ * @brief Websocket metric topic checks: deltas, rates and shared messages
+ *
+ * Drives main/http_server/ws_topics.c the way websocket_task does: one
+ * ws_topics_tick() every WS_TOPICS_TICK_MS, values set, then a message per
+ * due client and topic.
+ *
+ * Checks:
+ *   - topic names and rate rounding; new clients get log lines only
+ *   - the first message is full, then only changed fields are sent, and
+ *     nothing at all when nothing changed; noise below the sent precision
+ *     is not a change
+ *   - a slower client gets one message per period with the latest value
+ *     of everything that changed since its last one
+ *   - ten clients at two rates cost one serialization per topic per rate,
+ *     not one per client, and same-rate clients get the same bytes
+ *   - slave rows: a new row comes whole with its hostname, a gone row is
+ *     null, and a row only appears in a delta when it changed
+ *
+ * Then prints what a dashboard client receives per minute.
+ *
+ * Exit status is non-zero if any check fails.
+ *
+ * @author Clusteraxe Project
+ * @license GPL-3.0
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ws_topics.h"
+
+static int g_failures;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            printf("FAIL: " __VA_ARGS__);                       \
+            printf("\n");                                       \
+            g_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+static ws_topics_t g_topics;
+
+/**
+ * @brief Message for a client as websocket_task builds it, NULL if none is due
+ */
+static const char *deliver(ws_subscription_t *sub, ws_topic_id_t topic, uint32_t tick)
+{
+    if (!ws_subscription_due(sub, topic, tick)) {
+        return NULL;
+    }
+    size_t len = 0;
+    const char *msg = ws_topics_message(&g_topics, topic, sub->sent[topic], &len);
+    sub->sent[topic] = tick;
+    CHECK(msg == NULL || strlen(msg) == len, "message length %zu is not its string length", len);
+    return msg;
+}
+
+static bool has(const char *msg, const char *part)
+{
+    return msg != NULL && strstr(msg, part) != NULL;
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+static void test_subscription(void)
+{
+    ws_subscription_t sub;
+    ws_subscription_init(&sub);
+
+    CHECK(sub.topics == (1u << WS_TOPIC_LOGS), "new client topics 0x%x", sub.topics);
+    CHECK(ws_subscription_rate(&sub) == WS_TOPICS_DEFAULT_RATE, "default rate %u", ws_subscription_rate(&sub));
+    CHECK(ws_topics_find("power") == WS_TOPIC_POWER && ws_topics_find("slaves") == WS_TOPIC_SLAVES,
+          "topic lookup");
+    CHECK(ws_topics_find("nope") == WS_TOPIC_COUNT && ws_topics_find(NULL) == WS_TOPIC_COUNT, "unknown topic found");
+    CHECK(!ws_subscription_due(&sub, WS_TOPIC_LOGS, 4), "logs are not a metric topic");
+
+    ws_subscription_set_rate(&sub, 600);
+    CHECK(ws_subscription_rate(&sub) == 750, "600 ms rounded to %u", ws_subscription_rate(&sub));
+    ws_subscription_set_rate(&sub, 1);
+    CHECK(ws_subscription_rate(&sub) == WS_TOPICS_TICK_MS, "1 ms rounded to %u", ws_subscription_rate(&sub));
+    ws_subscription_set_rate(&sub, 10000000);
+    CHECK(ws_subscription_rate(&sub) == WS_TOPICS_MAX_RATE, "huge rate kept at %u", ws_subscription_rate(&sub));
+}
+
+static void test_deltas(void)
+{
+    ws_topics_init(&g_topics);
+    ws_subscription_t sub;
+    ws_subscription_init(&sub);
+    ws_subscription_set_rate(&sub, WS_TOPICS_TICK_MS);
+    ws_subscription_add(&sub, WS_TOPIC_POWER);
+
+    uint32_t tick = ws_topics_tick(&g_topics);
+    ws_topics_set(&g_topics, WS_TOPIC_POWER, 0, WS_POWER_POWER, 18.4213);
+    ws_topics_set(&g_topics, WS_TOPIC_POWER, 0, WS_POWER_CHIP_TEMP, 61.54);
+    const char *msg = deliver(&sub, WS_TOPIC_POWER, tick);
+    CHECK(msg && strcmp(msg, "{\"topic\":\"power\",\"tick\":1,\"full\":true,\"data\":{\"power\":18.42,\"temp\":61.5}}") == 0,
+          "full message: %s", msg ? msg : "(none)");
+
+    // Noise below the precision sent
+    tick = ws_topics_tick(&g_topics);
+    ws_topics_set(&g_topics, WS_TOPIC_POWER, 0, WS_POWER_POWER, 18.4189);
+    ws_topics_set(&g_topics, WS_TOPIC_POWER, 0, WS_POWER_CHIP_TEMP, 61.51);
+    msg = deliver(&sub, WS_TOPIC_POWER, tick);
+    CHECK(msg == NULL, "unchanged values sent: %s", msg);
+
+    tick = ws_topics_tick(&g_topics);
+    ws_topics_set(&g_topics, WS_TOPIC_POWER, 0, WS_POWER_POWER, 18.4189);
+    ws_topics_set(&g_topics, WS_TOPIC_POWER, 0, WS_POWER_CHIP_TEMP, 62.0);
+    msg = deliver(&sub, WS_TOPIC_POWER, tick);
+    CHECK(msg && strcmp(msg, "{\"topic\":\"power\",\"tick\":3,\"full\":false,\"data\":{\"temp\":62}}") == 0,
+          "delta message: %s", msg ? msg : "(none)");
+
+    // Subscribing again starts with a full message
+    ws_subscription_remove(&sub, WS_TOPIC_POWER);
+    tick = ws_topics_tick(&g_topics);
+    CHECK(deliver(&sub, WS_TOPIC_POWER, tick) == NULL, "unsubscribed topic sent");
+    ws_subscription_add(&sub, WS_TOPIC_POWER);
+    tick = ws_topics_tick(&g_topics);
+    msg = deliver(&sub, WS_TOPIC_POWER, tick);
+    CHECK(has(msg, "\"full\":true") && has(msg, "\"power\":18.42") && has(msg, "\"temp\":62"),
+          "resubscribe: %s", msg ? msg : "(none)");
+
+    ws_topics_deinit(&g_topics);
+}
+
+static void test_rate(void)
+{
+    ws_topics_init(&g_topics);
+    ws_subscription_t fast, slow;
+    ws_subscription_init(&fast);
+    ws_subscription_init(&slow);
+    ws_subscription_set_rate(&fast, WS_TOPICS_TICK_MS);
+    ws_subscription_set_rate(&slow, 4 * WS_TOPICS_TICK_MS);
+    ws_subscription_add(&fast, WS_TOPIC_HASHRATE);
+    ws_subscription_add(&slow, WS_TOPIC_HASHRATE);
+
+    int fast_count = 0, slow_count = 0;
+    for (int i = 0; i < 40; i++) {
+        uint32_t tick = ws_topics_tick(&g_topics);
+        ws_topics_set(&g_topics, WS_TOPIC_HASHRATE, 0, WS_HASHRATE_CURRENT, 1000 + i);
+        // The 1 minute average only moves now and then
+        ws_topics_set(&g_topics, WS_TOPIC_HASHRATE, 0, WS_HASHRATE_1M, 1000 + (i / 10) * 10);
+
+        fast_count += deliver(&fast, WS_TOPIC_HASHRATE, tick) != NULL;
+        const char *msg = deliver(&slow, WS_TOPIC_HASHRATE, tick);
+        if (msg != NULL) {
+            slow_count++;
+            char latest[32];
+            snprintf(latest, sizeof(latest), "\"hashRate\":%d", 1000 + i);
+            CHECK(has(msg, latest), "slow client at tick %u missed the latest value: %s", tick, msg);
+            bool moved = (i >= 4) && ((i / 10) != ((i - 4) / 10));
+            CHECK(i < 4 || moved == has(msg, "hashRate_1m"), "slow client at tick %u: 1m average %s: %s", tick,
+                  moved ? "missing" : "repeated", msg);
+        }
+    }
+    CHECK(fast_count == 40, "fast client got %d messages for 40 ticks", fast_count);
+    CHECK(slow_count == 1 + 40 / 4, "slow client got %d messages for 40 ticks", slow_count);
+
+    ws_topics_deinit(&g_topics);
+}
+
+static void test_shared(void)
+{
+    enum { CLIENTS = 10, TICKS = 400 };
+    ws_topics_init(&g_topics);
+    ws_subscription_t subs[CLIENTS];
+    for (int c = 0; c < CLIENTS; c++) {
+        ws_subscription_init(&subs[c]);
+        ws_subscription_set_rate(&subs[c], c < 7 ? 1000 : 250);
+        ws_subscription_add(&subs[c], WS_TOPIC_HASHRATE);
+        ws_subscription_add(&subs[c], WS_TOPIC_POWER);
+    }
+
+    uint32_t sent = 0;
+    uint32_t before = g_topics.serializations;
+    uint32_t worst = 0;
+    srand(7);
+    for (int i = 0; i < TICKS; i++) {
+        // Clients join over the first few ticks, out of step
+        uint32_t tick = ws_topics_tick(&g_topics);
+        uint32_t tick_start = g_topics.serializations;
+        ws_topics_set(&g_topics, WS_TOPIC_HASHRATE, 0, WS_HASHRATE_CURRENT, 1200 + rand() % 50);
+        ws_topics_set(&g_topics, WS_TOPIC_POWER, 0, WS_POWER_POWER, 18 + (rand() % 100) / 10.0);
+
+        const char *first_1000 = NULL;
+        for (int c = 0; c < CLIENTS && c <= i; c++) {
+            for (ws_topic_id_t topic = WS_TOPIC_HASHRATE; topic <= WS_TOPIC_POWER; topic++) {
+                const char *msg = deliver(&subs[c], topic, tick);
+                if (msg == NULL) {
+                    continue;
+                }
+                sent++;
+                if (i >= CLIENTS && c < 7 && topic == WS_TOPIC_HASHRATE) {
+                    if (first_1000 == NULL) {
+                        first_1000 = msg;
+                    }
+                    CHECK(msg == first_1000, "same-rate clients got different messages at tick %u", tick);
+                }
+            }
+        }
+        uint32_t built = g_topics.serializations - tick_start;
+        if (i >= CLIENTS && built > worst) {
+            worst = built;
+        }
+    }
+    uint32_t built = g_topics.serializations - before;
+    printf("%d clients at 1 s and 250 ms, %d ticks: %u messages sent, %u serialized, at most %u in a tick\n",
+           CLIENTS, TICKS, sent, built, worst);
+    CHECK(worst <= 2 * 2, "a tick serialized %u messages for 2 topics at 2 rates", worst);
+    CHECK(built * 3 < sent, "%u serializations for %u messages", built, sent);
+
+    ws_topics_deinit(&g_topics);
+}
+
+static void test_slaves(void)
+{
+    ws_topics_init(&g_topics);
+    ws_subscription_t sub;
+    ws_subscription_init(&sub);
+    ws_subscription_set_rate(&sub, WS_TOPICS_TICK_MS);
+    ws_subscription_add(&sub, WS_TOPIC_SLAVES);
+
+    uint32_t tick = ws_topics_tick(&g_topics);
+    ws_topics_rows_begin(&g_topics, WS_TOPIC_SLAVES);
+    int row = ws_topics_row(&g_topics, WS_TOPIC_SLAVES, 2);
+    ws_topics_set_label(&g_topics, WS_TOPIC_SLAVES, row, "bitaxe-2");
+    ws_topics_set(&g_topics, WS_TOPIC_SLAVES, row, WS_SLAVE_HASHRATE, 120000);
+    row = ws_topics_row(&g_topics, WS_TOPIC_SLAVES, 5);
+    ws_topics_set_label(&g_topics, WS_TOPIC_SLAVES, row, "bitaxe-5");
+    ws_topics_set(&g_topics, WS_TOPIC_SLAVES, row, WS_SLAVE_HASHRATE, 98000);
+    ws_topics_rows_end(&g_topics, WS_TOPIC_SLAVES);
+    const char *msg = deliver(&sub, WS_TOPIC_SLAVES, tick);
+    CHECK(msg && strcmp(msg, "{\"topic\":\"slaves\",\"tick\":1,\"full\":true,\"data\":{"
+                             "\"2\":{\"hostname\":\"bitaxe-2\",\"hashrate\":120000},"
+                             "\"5\":{\"hostname\":\"bitaxe-5\",\"hashrate\":98000}}}") == 0,
+          "slaves full: %s", msg ? msg : "(none)");
+
+    // Slave 5 changes, 2 does not, 7 joins
+    tick = ws_topics_tick(&g_topics);
+    ws_topics_rows_begin(&g_topics, WS_TOPIC_SLAVES);
+    row = ws_topics_row(&g_topics, WS_TOPIC_SLAVES, 2);
+    ws_topics_set(&g_topics, WS_TOPIC_SLAVES, row, WS_SLAVE_HASHRATE, 120000);
+    row = ws_topics_row(&g_topics, WS_TOPIC_SLAVES, 5);
+    ws_topics_set(&g_topics, WS_TOPIC_SLAVES, row, WS_SLAVE_HASHRATE, 99000);
+    row = ws_topics_row(&g_topics, WS_TOPIC_SLAVES, 7);
+    ws_topics_set_label(&g_topics, WS_TOPIC_SLAVES, row, "bitaxe-7");
+    ws_topics_set(&g_topics, WS_TOPIC_SLAVES, row, WS_SLAVE_STATE, 2);
+    ws_topics_rows_end(&g_topics, WS_TOPIC_SLAVES);
+    msg = deliver(&sub, WS_TOPIC_SLAVES, tick);
+    CHECK(msg && strcmp(msg, "{\"topic\":\"slaves\",\"tick\":2,\"full\":false,\"data\":{"
+                             "\"5\":{\"hashrate\":99000},"
+                             "\"7\":{\"hostname\":\"bitaxe-7\",\"state\":2}}}") == 0,
+          "slaves delta: %s", msg ? msg : "(none)");
+
+    // Slave 2 goes
+    tick = ws_topics_tick(&g_topics);
+    ws_topics_rows_begin(&g_topics, WS_TOPIC_SLAVES);
+    ws_topics_row(&g_topics, WS_TOPIC_SLAVES, 5);
+    ws_topics_row(&g_topics, WS_TOPIC_SLAVES, 7);
+    ws_topics_rows_end(&g_topics, WS_TOPIC_SLAVES);
+    msg = deliver(&sub, WS_TOPIC_SLAVES, tick);
+    CHECK(msg && strcmp(msg, "{\"topic\":\"slaves\",\"tick\":3,\"full\":false,\"data\":{\"2\":null}}") == 0,
+          "slave removed: %s", msg ? msg : "(none)");
+
+    // A new client's full message leaves the gone slave out
+    ws_subscription_t late;
+    ws_subscription_init(&late);
+    ws_subscription_add(&late, WS_TOPIC_SLAVES);
+    tick = ws_topics_tick(&g_topics);
+    msg = deliver(&late, WS_TOPIC_SLAVES, tick);
+    CHECK(has(msg, "\"5\":") && has(msg, "\"7\":") && !has(msg, "\"2\":"), "late full: %s", msg ? msg : "(none)");
+
+    // Every row taken: an extra slave is not tracked rather than overwriting one
+    ws_topics_rows_begin(&g_topics, WS_TOPIC_SLAVES);
+    int last = 0;
+    for (int id = 0; id <= WS_TOPIC_MAX_ROWS; id++) {
+        last = ws_topics_row(&g_topics, WS_TOPIC_SLAVES, 100 + id);
+    }
+    CHECK(last == -1, "row %d given past WS_TOPIC_MAX_ROWS", last);
+
+    ws_topics_deinit(&g_topics);
+}
+
+static void print_dashboard(void)
+{
+    ws_topics_init(&g_topics);
+    ws_subscription_t sub;
+    ws_subscription_init(&sub);
+    ws_subscription_remove(&sub, WS_TOPIC_LOGS);
+    ws_subscription_add(&sub, WS_TOPIC_HASHRATE);
+    ws_subscription_add(&sub, WS_TOPIC_POWER);
+    ws_subscription_add(&sub, WS_TOPIC_SHARES);
+
+    size_t bytes = 0;
+    int messages = 0;
+    srand(11);
+    for (int i = 0; i < 60000 / WS_TOPICS_TICK_MS; i++) {
+        uint32_t tick = ws_topics_tick(&g_topics);
+        ws_topics_set(&g_topics, WS_TOPIC_HASHRATE, 0, WS_HASHRATE_CURRENT, 1200 + (rand() % 1000) / 10.0);
+        ws_topics_set(&g_topics, WS_TOPIC_HASHRATE, 0, WS_HASHRATE_1M, 1230 + (i / 20));
+        ws_topics_set(&g_topics, WS_TOPIC_HASHRATE, 0, WS_HASHRATE_10M, 1231);
+        ws_topics_set(&g_topics, WS_TOPIC_HASHRATE, 0, WS_HASHRATE_1H, 1229);
+        ws_topics_set(&g_topics, WS_TOPIC_POWER, 0, WS_POWER_POWER, 18 + (rand() % 100) / 100.0);
+        ws_topics_set(&g_topics, WS_TOPIC_POWER, 0, WS_POWER_CHIP_TEMP, 61 + (i / 40) / 10.0);
+        ws_topics_set(&g_topics, WS_TOPIC_POWER, 0, WS_POWER_FAN_RPM, 4200);
+        ws_topics_set(&g_topics, WS_TOPIC_SHARES, 0, WS_SHARES_ACCEPTED, 3000 + i / 30);
+        for (ws_topic_id_t topic = WS_TOPIC_HASHRATE; topic <= WS_TOPIC_SHARES; topic++) {
+            const char *msg = deliver(&sub, topic, tick);
+            if (msg != NULL) {
+                bytes += strlen(msg);
+                messages++;
+            }
+        }
+    }
+    printf("dashboard, 3 topics at 1 s for a minute: %d messages, %zu bytes\n", messages, bytes);
+
+    ws_topics_deinit(&g_topics);
+}
+
+int main(void)
+{
+    test_subscription();
+    test_deltas();
+    test_rate();
+    test_shared();
+    test_slaves();
+    print_dashboard();
+
+    printf("ws_topics: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}